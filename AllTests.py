@@ -318,6 +318,7 @@ class TestCase(object):
 
 gAllTests = [ TestCase('TestBuffer', [], True)
              ,TestCase('TestStream', [], True)
+             ,TestCase('TestHttp', [], True)
              ,TestCase('TestThread', ['--full'], False)
              ,TestCase('TestFunctorGeneric', [], True)
              ,TestCase('TestFifo', [], True)
@@ -348,6 +349,7 @@ gAllTests = [ TestCase('TestBuffer', [], True)
              #,TestCase('TestCpDeviceDvStd', [], True)
              #,TestCase('TestCpDeviceDvC', [], True)
              ,TestCase('TestDvLpec', [], True)
+             ,TestCase('TestDvWebSocket', ['-l'], True)
              ,TestCase('TestProxyCs', [], False, False)
              ,TestCase('TestDvDeviceCs', [], True, False)
              ,TestCase('TestCpDeviceDvCs', [], True, False)
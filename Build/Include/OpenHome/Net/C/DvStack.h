@@ -0,0 +1,13 @@
+#ifndef HEADER_OHNET_DEVICE_C
+#define HEADER_OHNET_DEVICE_C
+
+#include <OpenHome/OsTypes.h>
+#include <OpenHome/Defines.h>
+#include <OpenHome/MimeTypes.h>
+#include <OpenHome/Net/C/OhNet.h>
+#include <OpenHome/Net/C/Service.h>
+#include <OpenHome/Net/C/DvDevice.h>
+#include <OpenHome/Net/C/DvProvider.h>
+#include <OpenHome/Net/C/DvServerUpnp.h>
+
+#endif // HEADER_OHNET_DEVICE_C
@@ -0,0 +1,19 @@
+#ifndef HEADER_OHNET_DEVICE_CORE
+#define HEADER_OHNET_DEVICE_CORE
+
+#include <OpenHome/OsTypes.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Defines.h>
+#include <OpenHome/MimeTypes.h>
+#include <OpenHome/Functor.h>
+#include <OpenHome/Exception.h>
+#include <OpenHome/FunctorMsg.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Core/DvProvider.h>
+#include <OpenHome/Net/Core/DvResourceWriter.h>
+#include <OpenHome/Net/Core/DvServerUpnp.h>
+#include <OpenHome/Net/Core/DvInvocationResponse.h>
+#include <OpenHome/Net/Core/DvDevice.h>
+
+#endif // HEADER_OHNET_DEVICE_CORE
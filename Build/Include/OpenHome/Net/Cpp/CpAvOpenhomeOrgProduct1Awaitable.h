@@ -0,0 +1,293 @@
+#ifndef HEADER_AVOPENHOMEORGPRODUCT1AWAITABLE
+#define HEADER_AVOPENHOMEORGPRODUCT1AWAITABLE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpAvOpenhomeOrgProduct1.h>
+
+#include <string>
+
+namespace OpenHome {
+namespace Net {
+
+class CpDeviceCpp;
+class CpExecutor;
+
+/**
+ * Proxy for av.openhome.org:Product:1 whose actions can be co_await-ed
+ *
+ * Header only; requires a C++20 compiler.
+ * @ingroup Proxies
+ */
+class CpProxyAvOpenhomeOrgProduct1Awaitable : public CpProxyAvOpenhomeOrgProduct1Cpp
+{
+public:
+    /**
+     * Output arguments from Manufacturer
+     */
+    struct ManufacturerResult
+    {
+        std::string iName;
+        std::string iInfo;
+        std::string iUrl;
+        std::string iImageUri;
+    };
+    /**
+     * Output arguments from Model
+     */
+    struct ModelResult
+    {
+        std::string iName;
+        std::string iInfo;
+        std::string iUrl;
+        std::string iImageUri;
+    };
+    /**
+     * Output arguments from Product
+     */
+    struct ProductResult
+    {
+        std::string iRoom;
+        std::string iName;
+        std::string iInfo;
+        std::string iUrl;
+        std::string iImageUri;
+    };
+    /**
+     * Output arguments from Source
+     */
+    struct SourceResult
+    {
+        std::string iSystemName;
+        std::string iType;
+        std::string iName;
+        bool iVisible;
+    };
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in]  aDevice     The device to use
+     * @param[in]  aExecutor   Coroutines awaiting actions are resumed on this executor's thread
+     */
+    CpProxyAvOpenhomeOrgProduct1Awaitable(CpDeviceCpp& aDevice, CpExecutor& aExecutor)
+        : CpProxyAvOpenhomeOrgProduct1Cpp(aDevice)
+        , iExecutor(aExecutor)
+    {
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding a ManufacturerResult
+     */
+    CpActionAwaiter<ManufacturerResult> CoManufacturer()
+    {
+        return CpActionAwaiter<ManufacturerResult>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginManufacturer(aFunctor); },
+            [this](IAsync& aAsync) { ManufacturerResult result; EndManufacturer(aAsync, result.iName, result.iInfo, result.iUrl, result.iImageUri); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding a ModelResult
+     */
+    CpActionAwaiter<ModelResult> CoModel()
+    {
+        return CpActionAwaiter<ModelResult>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginModel(aFunctor); },
+            [this](IAsync& aAsync) { ModelResult result; EndModel(aAsync, result.iName, result.iInfo, result.iUrl, result.iImageUri); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding a ProductResult
+     */
+    CpActionAwaiter<ProductResult> CoProduct()
+    {
+        return CpActionAwaiter<ProductResult>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginProduct(aFunctor); },
+            [this](IAsync& aAsync) { ProductResult result; EndProduct(aAsync, result.iRoom, result.iName, result.iInfo, result.iUrl, result.iImageUri); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<bool> CoStandby()
+    {
+        return CpActionAwaiter<bool>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginStandby(aFunctor); },
+            [this](IAsync& aAsync) { bool result; EndStandby(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     */
+    CpActionAwaiter<void> CoSetStandby(bool aValue)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginSetStandby(aValue, aFunctor); },
+            [this](IAsync& aAsync) { EndSetStandby(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<uint32_t> CoSourceCount()
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginSourceCount(aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndSourceCount(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoSourceXml()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginSourceXml(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndSourceXml(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<uint32_t> CoSourceIndex()
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginSourceIndex(aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndSourceIndex(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     */
+    CpActionAwaiter<void> CoSetSourceIndex(uint32_t aValue)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginSetSourceIndex(aValue, aFunctor); },
+            [this](IAsync& aAsync) { EndSetSourceIndex(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     */
+    CpActionAwaiter<void> CoSetSourceIndexByName(const std::string& aValue)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginSetSourceIndexByName(aValue, aFunctor); },
+            [this](IAsync& aAsync) { EndSetSourceIndexByName(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aIndex
+     *
+     * @return  Awaitable yielding a SourceResult
+     */
+    CpActionAwaiter<SourceResult> CoSource(uint32_t aIndex)
+    {
+        return CpActionAwaiter<SourceResult>(iExecutor,
+            [this, aIndex](FunctorAsync& aFunctor) { BeginSource(aIndex, aFunctor); },
+            [this](IAsync& aAsync) { SourceResult result; EndSource(aAsync, result.iSystemName, result.iType, result.iName, result.iVisible); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoAttributes()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginAttributes(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndAttributes(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<uint32_t> CoSourceXmlChangeCount()
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginSourceXmlChangeCount(aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndSourceXmlChangeCount(aAsync, result); return result; });
+    }
+private:
+    CpExecutor& iExecutor;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_AVOPENHOMEORGPRODUCT1AWAITABLE
+
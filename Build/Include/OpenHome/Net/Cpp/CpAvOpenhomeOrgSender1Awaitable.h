@@ -0,0 +1,126 @@
+#ifndef HEADER_AVOPENHOMEORGSENDER1AWAITABLE
+#define HEADER_AVOPENHOMEORGSENDER1AWAITABLE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpAvOpenhomeOrgSender1.h>
+
+#include <string>
+
+namespace OpenHome {
+namespace Net {
+
+class CpDeviceCpp;
+class CpExecutor;
+
+/**
+ * Proxy for av.openhome.org:Sender:1 whose actions can be co_await-ed
+ *
+ * Header only; requires a C++20 compiler.
+ * @ingroup Proxies
+ */
+class CpProxyAvOpenhomeOrgSender1Awaitable : public CpProxyAvOpenhomeOrgSender1Cpp
+{
+public:
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in]  aDevice     The device to use
+     * @param[in]  aExecutor   Coroutines awaiting actions are resumed on this executor's thread
+     */
+    CpProxyAvOpenhomeOrgSender1Awaitable(CpDeviceCpp& aDevice, CpExecutor& aExecutor)
+        : CpProxyAvOpenhomeOrgSender1Cpp(aDevice)
+        , iExecutor(aExecutor)
+    {
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoPresentationUrl()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginPresentationUrl(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndPresentationUrl(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoMetadata()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginMetadata(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndMetadata(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<bool> CoAudio()
+    {
+        return CpActionAwaiter<bool>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginAudio(aFunctor); },
+            [this](IAsync& aAsync) { bool result; EndAudio(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoStatus()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginStatus(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndStatus(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the Value output argument
+     */
+    CpActionAwaiter<std::string> CoAttributes()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginAttributes(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndAttributes(aAsync, result); return result; });
+    }
+private:
+    CpExecutor& iExecutor;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_AVOPENHOMEORGSENDER1AWAITABLE
+
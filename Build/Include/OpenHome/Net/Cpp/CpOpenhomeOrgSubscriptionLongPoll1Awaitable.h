@@ -0,0 +1,124 @@
+#ifndef HEADER_OPENHOMEORGSUBSCRIPTIONLONGPOLL1AWAITABLE
+#define HEADER_OPENHOMEORGSUBSCRIPTIONLONGPOLL1AWAITABLE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpOpenhomeOrgSubscriptionLongPoll1.h>
+
+#include <string>
+
+namespace OpenHome {
+namespace Net {
+
+class CpDeviceCpp;
+class CpExecutor;
+
+/**
+ * Proxy for openhome.org:SubscriptionLongPoll:1 whose actions can be co_await-ed
+ *
+ * Header only; requires a C++20 compiler.
+ * @ingroup Proxies
+ */
+class CpProxyOpenhomeOrgSubscriptionLongPoll1Awaitable : public CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp
+{
+public:
+    /**
+     * Output arguments from Subscribe
+     */
+    struct SubscribeResult
+    {
+        std::string iSid;
+        uint32_t iDuration;
+    };
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in]  aDevice     The device to use
+     * @param[in]  aExecutor   Coroutines awaiting actions are resumed on this executor's thread
+     */
+    CpProxyOpenhomeOrgSubscriptionLongPoll1Awaitable(CpDeviceCpp& aDevice, CpExecutor& aExecutor)
+        : CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp(aDevice)
+        , iExecutor(aExecutor)
+    {
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aClientId
+     * @param[in]  aUdn
+     * @param[in]  aService
+     * @param[in]  aRequestedDuration
+     *
+     * @return  Awaitable yielding a SubscribeResult
+     */
+    CpActionAwaiter<SubscribeResult> CoSubscribe(const std::string& aClientId, const std::string& aUdn, const std::string& aService, uint32_t aRequestedDuration)
+    {
+        return CpActionAwaiter<SubscribeResult>(iExecutor,
+            [this, aClientId, aUdn, aService, aRequestedDuration](FunctorAsync& aFunctor) { BeginSubscribe(aClientId, aUdn, aService, aRequestedDuration, aFunctor); },
+            [this](IAsync& aAsync) { SubscribeResult result; EndSubscribe(aAsync, result.iSid, result.iDuration); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aSid
+     */
+    CpActionAwaiter<void> CoUnsubscribe(const std::string& aSid)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aSid](FunctorAsync& aFunctor) { BeginUnsubscribe(aSid, aFunctor); },
+            [this](IAsync& aAsync) { EndUnsubscribe(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aSid
+     * @param[in]  aRequestedDuration
+     *
+     * @return  Awaitable yielding the Duration output argument
+     */
+    CpActionAwaiter<uint32_t> CoRenew(const std::string& aSid, uint32_t aRequestedDuration)
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this, aSid, aRequestedDuration](FunctorAsync& aFunctor) { BeginRenew(aSid, aRequestedDuration, aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndRenew(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aClientId
+     *
+     * @return  Awaitable yielding the Updates output argument
+     */
+    CpActionAwaiter<std::string> CoGetPropertyUpdates(const std::string& aClientId)
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this, aClientId](FunctorAsync& aFunctor) { BeginGetPropertyUpdates(aClientId, aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndGetPropertyUpdates(aAsync, result); return result; });
+    }
+private:
+    CpExecutor& iExecutor;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_OPENHOMEORGSUBSCRIPTIONLONGPOLL1AWAITABLE
+
@@ -0,0 +1,417 @@
+#ifndef HEADER_OPENHOMEORGTESTBASIC1AWAITABLE
+#define HEADER_OPENHOMEORGTESTBASIC1AWAITABLE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpOpenhomeOrgTestBasic1.h>
+
+#include <string>
+
+namespace OpenHome {
+namespace Net {
+
+class CpDeviceCpp;
+class CpExecutor;
+
+/**
+ * Proxy for openhome.org:TestBasic:1 whose actions can be co_await-ed
+ *
+ * Header only; requires a C++20 compiler.
+ * @ingroup Proxies
+ */
+class CpProxyOpenhomeOrgTestBasic1Awaitable : public CpProxyOpenhomeOrgTestBasic1Cpp
+{
+public:
+    /**
+     * Output arguments from GetMultiple
+     */
+    struct GetMultipleResult
+    {
+        uint32_t iValueUint;
+        int32_t iValueInt;
+        bool iValueBool;
+    };
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in]  aDevice     The device to use
+     * @param[in]  aExecutor   Coroutines awaiting actions are resumed on this executor's thread
+     */
+    CpProxyOpenhomeOrgTestBasic1Awaitable(CpDeviceCpp& aDevice, CpExecutor& aExecutor)
+        : CpProxyOpenhomeOrgTestBasic1Cpp(aDevice)
+        , iExecutor(aExecutor)
+    {
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<uint32_t> CoIncrement(uint32_t aValue)
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginIncrement(aValue, aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndIncrement(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<uint32_t> CoEchoAllowedRangeUint(uint32_t aValue)
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginEchoAllowedRangeUint(aValue, aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndEchoAllowedRangeUint(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<int32_t> CoDecrement(int32_t aValue)
+    {
+        return CpActionAwaiter<int32_t>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginDecrement(aValue, aFunctor); },
+            [this](IAsync& aAsync) { int32_t result; EndDecrement(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<bool> CoToggle(bool aValue)
+    {
+        return CpActionAwaiter<bool>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginToggle(aValue, aFunctor); },
+            [this](IAsync& aAsync) { bool result; EndToggle(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<std::string> CoEchoString(const std::string& aValue)
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginEchoString(aValue, aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndEchoString(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<std::string> CoEchoAllowedValueString(const std::string& aValue)
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginEchoAllowedValueString(aValue, aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndEchoAllowedValueString(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValue
+     *
+     * @return  Awaitable yielding the Result output argument
+     */
+    CpActionAwaiter<std::string> CoEchoBinary(const std::string& aValue)
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this, aValue](FunctorAsync& aFunctor) { BeginEchoBinary(aValue, aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndEchoBinary(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueUint
+     */
+    CpActionAwaiter<void> CoSetUint(uint32_t aValueUint)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueUint](FunctorAsync& aFunctor) { BeginSetUint(aValueUint, aFunctor); },
+            [this](IAsync& aAsync) { EndSetUint(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ValueUint output argument
+     */
+    CpActionAwaiter<uint32_t> CoGetUint()
+    {
+        return CpActionAwaiter<uint32_t>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetUint(aFunctor); },
+            [this](IAsync& aAsync) { uint32_t result; EndGetUint(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueInt
+     */
+    CpActionAwaiter<void> CoSetInt(int32_t aValueInt)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueInt](FunctorAsync& aFunctor) { BeginSetInt(aValueInt, aFunctor); },
+            [this](IAsync& aAsync) { EndSetInt(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ValueInt output argument
+     */
+    CpActionAwaiter<int32_t> CoGetInt()
+    {
+        return CpActionAwaiter<int32_t>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetInt(aFunctor); },
+            [this](IAsync& aAsync) { int32_t result; EndGetInt(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueBool
+     */
+    CpActionAwaiter<void> CoSetBool(bool aValueBool)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueBool](FunctorAsync& aFunctor) { BeginSetBool(aValueBool, aFunctor); },
+            [this](IAsync& aAsync) { EndSetBool(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ValueBool output argument
+     */
+    CpActionAwaiter<bool> CoGetBool()
+    {
+        return CpActionAwaiter<bool>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetBool(aFunctor); },
+            [this](IAsync& aAsync) { bool result; EndGetBool(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueUint
+     * @param[in]  aValueInt
+     * @param[in]  aValueBool
+     */
+    CpActionAwaiter<void> CoSetMultiple(uint32_t aValueUint, int32_t aValueInt, bool aValueBool)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueUint, aValueInt, aValueBool](FunctorAsync& aFunctor) { BeginSetMultiple(aValueUint, aValueInt, aValueBool, aFunctor); },
+            [this](IAsync& aAsync) { EndSetMultiple(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding a GetMultipleResult
+     */
+    CpActionAwaiter<GetMultipleResult> CoGetMultiple()
+    {
+        return CpActionAwaiter<GetMultipleResult>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetMultiple(aFunctor); },
+            [this](IAsync& aAsync) { GetMultipleResult result; EndGetMultiple(aAsync, result.iValueUint, result.iValueInt, result.iValueBool); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueStr
+     */
+    CpActionAwaiter<void> CoSetString(const std::string& aValueStr)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueStr](FunctorAsync& aFunctor) { BeginSetString(aValueStr, aFunctor); },
+            [this](IAsync& aAsync) { EndSetString(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ValueStr output argument
+     */
+    CpActionAwaiter<std::string> CoGetString()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetString(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndGetString(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aValueBin
+     */
+    CpActionAwaiter<void> CoSetBinary(const std::string& aValueBin)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aValueBin](FunctorAsync& aFunctor) { BeginSetBinary(aValueBin, aFunctor); },
+            [this](IAsync& aAsync) { EndSetBinary(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ValueBin output argument
+     */
+    CpActionAwaiter<std::string> CoGetBinary()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetBinary(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndGetBinary(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     */
+    CpActionAwaiter<void> CoToggleBool()
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginToggleBool(aFunctor); },
+            [this](IAsync& aAsync) { EndToggleBool(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     */
+    CpActionAwaiter<void> CoReportError()
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginReportError(aFunctor); },
+            [this](IAsync& aAsync) { EndReportError(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aData
+     * @param[in]  aFileFullName
+     */
+    CpActionAwaiter<void> CoWriteFile(const std::string& aData, const std::string& aFileFullName)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aData, aFileFullName](FunctorAsync& aFunctor) { BeginWriteFile(aData, aFileFullName, aFunctor); },
+            [this](IAsync& aAsync) { EndWriteFile(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     */
+    CpActionAwaiter<void> CoShutdown()
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginShutdown(aFunctor); },
+            [this](IAsync& aAsync) { EndShutdown(aAsync); });
+    }
+private:
+    CpExecutor& iExecutor;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_OPENHOMEORGTESTBASIC1AWAITABLE
+
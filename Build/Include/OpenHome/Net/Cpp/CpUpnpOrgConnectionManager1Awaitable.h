@@ -0,0 +1,160 @@
+#ifndef HEADER_UPNPORGCONNECTIONMANAGER1AWAITABLE
+#define HEADER_UPNPORGCONNECTIONMANAGER1AWAITABLE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpUpnpOrgConnectionManager1.h>
+
+#include <string>
+
+namespace OpenHome {
+namespace Net {
+
+class CpDeviceCpp;
+class CpExecutor;
+
+/**
+ * Proxy for upnp.org:ConnectionManager:1 whose actions can be co_await-ed
+ *
+ * Header only; requires a C++20 compiler.
+ * @ingroup Proxies
+ */
+class CpProxyUpnpOrgConnectionManager1Awaitable : public CpProxyUpnpOrgConnectionManager1Cpp
+{
+public:
+    /**
+     * Output arguments from GetProtocolInfo
+     */
+    struct GetProtocolInfoResult
+    {
+        std::string iSource;
+        std::string iSink;
+    };
+    /**
+     * Output arguments from PrepareForConnection
+     */
+    struct PrepareForConnectionResult
+    {
+        int32_t iConnectionID;
+        int32_t iAVTransportID;
+        int32_t iRcsID;
+    };
+    /**
+     * Output arguments from GetCurrentConnectionInfo
+     */
+    struct GetCurrentConnectionInfoResult
+    {
+        int32_t iRcsID;
+        int32_t iAVTransportID;
+        std::string iProtocolInfo;
+        std::string iPeerConnectionManager;
+        int32_t iPeerConnectionID;
+        std::string iDirection;
+        std::string iStatus;
+    };
+public:
+    /**
+     * Constructor.
+     *
+     * @param[in]  aDevice     The device to use
+     * @param[in]  aExecutor   Coroutines awaiting actions are resumed on this executor's thread
+     */
+    CpProxyUpnpOrgConnectionManager1Awaitable(CpDeviceCpp& aDevice, CpExecutor& aExecutor)
+        : CpProxyUpnpOrgConnectionManager1Cpp(aDevice)
+        , iExecutor(aExecutor)
+    {
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding a GetProtocolInfoResult
+     */
+    CpActionAwaiter<GetProtocolInfoResult> CoGetProtocolInfo()
+    {
+        return CpActionAwaiter<GetProtocolInfoResult>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetProtocolInfo(aFunctor); },
+            [this](IAsync& aAsync) { GetProtocolInfoResult result; EndGetProtocolInfo(aAsync, result.iSource, result.iSink); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aRemoteProtocolInfo
+     * @param[in]  aPeerConnectionManager
+     * @param[in]  aPeerConnectionID
+     * @param[in]  aDirection
+     *
+     * @return  Awaitable yielding a PrepareForConnectionResult
+     */
+    CpActionAwaiter<PrepareForConnectionResult> CoPrepareForConnection(const std::string& aRemoteProtocolInfo, const std::string& aPeerConnectionManager, int32_t aPeerConnectionID, const std::string& aDirection)
+    {
+        return CpActionAwaiter<PrepareForConnectionResult>(iExecutor,
+            [this, aRemoteProtocolInfo, aPeerConnectionManager, aPeerConnectionID, aDirection](FunctorAsync& aFunctor) { BeginPrepareForConnection(aRemoteProtocolInfo, aPeerConnectionManager, aPeerConnectionID, aDirection, aFunctor); },
+            [this](IAsync& aAsync) { PrepareForConnectionResult result; EndPrepareForConnection(aAsync, result.iConnectionID, result.iAVTransportID, result.iRcsID); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aConnectionID
+     */
+    CpActionAwaiter<void> CoConnectionComplete(int32_t aConnectionID)
+    {
+        return CpActionAwaiter<void>(iExecutor,
+            [this, aConnectionID](FunctorAsync& aFunctor) { BeginConnectionComplete(aConnectionID, aFunctor); },
+            [this](IAsync& aAsync) { EndConnectionComplete(aAsync); });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     *
+     * @return  Awaitable yielding the ConnectionIDs output argument
+     */
+    CpActionAwaiter<std::string> CoGetCurrentConnectionIDs()
+    {
+        return CpActionAwaiter<std::string>(iExecutor,
+            [this](FunctorAsync& aFunctor) { BeginGetCurrentConnectionIDs(aFunctor); },
+            [this](IAsync& aAsync) { std::string result; EndGetCurrentConnectionIDs(aAsync, result); return result; });
+    }
+
+    /**
+     * Invoke the action asynchronously.
+     * co_await the returned object to suspend until the action completes.  The
+     * awaiting coroutine is then resumed on the executor passed to the constructor.
+     * co_await throws ProxyError if the action failed.
+     *
+     * @param[in]  aConnectionID
+     *
+     * @return  Awaitable yielding a GetCurrentConnectionInfoResult
+     */
+    CpActionAwaiter<GetCurrentConnectionInfoResult> CoGetCurrentConnectionInfo(int32_t aConnectionID)
+    {
+        return CpActionAwaiter<GetCurrentConnectionInfoResult>(iExecutor,
+            [this, aConnectionID](FunctorAsync& aFunctor) { BeginGetCurrentConnectionInfo(aConnectionID, aFunctor); },
+            [this](IAsync& aAsync) { GetCurrentConnectionInfoResult result; EndGetCurrentConnectionInfo(aAsync, result.iRcsID, result.iAVTransportID, result.iProtocolInfo, result.iPeerConnectionManager, result.iPeerConnectionID, result.iDirection, result.iStatus); return result; });
+    }
+private:
+    CpExecutor& iExecutor;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_UPNPORGCONNECTIONMANAGER1AWAITABLE
+
@@ -0,0 +1,472 @@
+/**
+ * List(s) of UPnP devices suitable for use in control points
+ *
+ * Cp prefixes show that classes are intended for use in control points
+ * Route inside a name implies that a class requires one instance per network interface
+ */
+
+#ifndef HEADER_CPIDEVICEUPNP
+#define HEADER_CPIDEVICEUPNP
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Net/Private/Discovery.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Net/Private/CpiDevice.h>
+#include <OpenHome/Net/Private/CpiService.h>
+#include <OpenHome/Net/Private/DeviceXml.h>
+#include <OpenHome/Net/Private/XmlFetcher.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <map>
+#include <vector>
+
+namespace OpenHome {
+namespace Net {
+
+class CpiDeviceListUpnp;
+class CpStack;
+class InvocationConnectionCache;
+
+/**
+ * Ref-counted device description document
+ *
+ * Shared by all CpiDeviceUpnp instances (across all device lists) for the same udn.
+ * Immutable once constructed.
+ */
+class CpiDeviceDescription : private INonCopyable
+{
+public:
+    CpiDeviceDescription(Brh& aXml); // takes ownership of aXml's buffer.  Throws XmlError, leaving aXml unchanged
+    void AddRef();
+    void RemoveRef();
+    TBool IsShared() const;
+    const Brx& Xml() const;
+    DeviceXmlDocument& Document();
+private:
+    ~CpiDeviceDescription();
+private:
+    mutable Mutex iLock;
+    TUint iRefCount;
+    Brh iXml;
+    DeviceXmlDocument* iDocument;
+};
+
+class ICpiDeviceDescriptionObserver
+{
+public:
+    /**
+     * Called when a fetch started by another device completes.
+     * aDescription is NULL if the fetch failed, otherwise has already been ref'd for the observer.
+     */
+    virtual void DescriptionFetched(CpiDeviceDescription* aDescription) = 0;
+    virtual ~ICpiDeviceDescriptionObserver() {}
+};
+
+/**
+ * Stack-wide cache of device descriptions, keyed by udn
+ *
+ * Entries are only reused for the same LOCATION and CONFIGID.UPNP.ORG.  Devices which
+ * don't report a config id only share descriptions which are currently in use (or
+ * being fetched) by another device list.  Concurrent requests for the same description
+ * are coalesced into a single fetch.
+ *
+ * If InitialisationParams::SetCpUpnpDeviceCache() was called, descriptions are also saved
+ * on destruction and restored on construction so that device lists can report
+ * previously seen devices before they're re-discovered.
+ */
+class CpiDeviceDescriptionCache : private IInfoProvider, private INonCopyable
+{
+    static const Brn kQueryDescriptions;
+    static const TUint kMaxEntries = 64;
+    static const Brn kFileMagic;
+    static const TUint kFileVersion = 1;
+    static const Brn kTempSuffix;
+public:
+    class RestoredDevice
+    {
+    public:
+        Brn iUdn;
+        Brn iLocation;
+        TUint iConfigId;
+        CpiDeviceDescription* iDescription; // ref'd for the caller
+    };
+public:
+    CpiDeviceDescriptionCache(Environment& aEnv);
+    ~CpiDeviceDescriptionCache();
+    /**
+     * Retrieve devices restored from file that were last seen on aInterface.
+     * Buffers in aDevices remain valid for the lifetime of the cache.
+     */
+    void GetRestored(const TIpAddress& aInterface, std::vector<RestoredDevice>& aDevices);
+    /**
+     * Note that a device is still present (e.g. an alive message was received) so
+     * its description doesn't age out of the saved cache.
+     * aConfirmsRestored indicates that this is the first sighting of a restored device.
+     */
+    void DeviceSeen(const Brx& aUdn, TBool aConfirmsRestored);
+    /**
+     * Returns a ref'd description if a valid one is cached.
+     * Otherwise returns NULL and sets aFetch.  If aFetch is true, the caller should fetch the
+     * description then report the result via Store() or FetchFailed().  If aFetch is false,
+     * another fetch is already in progress and aObserver will be notified when it completes.
+     */
+    CpiDeviceDescription* Claim(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface,
+                                ICpiDeviceDescriptionObserver& aObserver, TBool& aFetch);
+    /**
+     * Returns a ref'd description for aXml, notifying any other devices waiting on it.
+     * Throws XmlError (after notifying waiters of failure) if aXml is invalid.
+     */
+    CpiDeviceDescription* Store(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, Brh& aXml);
+    void FetchFailed(const Brx& aUdn, const Brx& aLocation, TUint aConfigId);
+    /**
+     * Returns true if aObserver was waiting for a fetch and will no longer be notified.
+     */
+    TBool CancelWait(const Brx& aUdn, ICpiDeviceDescriptionObserver& aObserver);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    class Entry : private INonCopyable
+    {
+    public:
+        Entry(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface);
+        ~Entry();
+        TBool Matches(const Brx& aLocation, TUint aConfigId) const;
+        TBool Reusable() const;
+    public:
+        Brh iUdn;
+        Brh iLocation;
+        TUint iConfigId;
+        TIpAddress iInterface;
+        TUint64 iSeenSecs;
+        CpiDeviceDescription* iDescription; // NULL while fetch is in progress
+        std::vector<ICpiDeviceDescriptionObserver*> iWaiters;
+    };
+    typedef std::map<Brn,Entry*,BufferCmp> Map;
+    typedef std::vector<ICpiDeviceDescriptionObserver*> Waiters;
+private:
+    Map::iterator FindPendingLocked(const Brx& aUdn, const Brx& aLocation, TUint aConfigId);
+    void EraseLocked(Map::iterator aIt);
+    void PruneLocked();
+    static void Notify(Waiters& aWaiters, CpiDeviceDescription* aDescription);
+    void Load();
+    void Save();
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    Map iMap;
+    std::vector<Entry*> iRestored;
+    Brhz iPath;
+    TUint64 iMaxAgeSecs;
+    TUint iHits;
+    TUint iMisses;
+    TUint iCoalesced;
+    TUint iInvalidated;
+    TUint iFetchErrors;
+    TUint iRestoredSeen;
+};
+
+/**
+ * UPnP-specific device
+ *
+ * Can be created in response to either a msearch request or a multicast alive
+ * notification.  Uses a timer to remove itself from ots owning list if no
+ * subsequent alive message is received within a specified maxage.
+ * Can also be restored from a previous run, in which case the device is tentative
+ * (and has no maxage timeout) until an alive message is received.
+ */
+class CpiDeviceUpnp : private ICpiProtocol, private ICpiDeviceObserver, private ICpiDeviceDescriptionObserver
+{
+    // renewals for a device are sent back to back (see CpiRenewalScheduler) so only need a short idle timeout
+    static const TUint kRenewConnectionIdleTimeoutMs = 5 * 1000;
+public:
+    CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, TUint aConfigId, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
+    CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
+    CpiDeviceUpnp(CpStack& aCpStack, const CpiDeviceDescriptionCache::RestoredDevice& aRestored, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
+    const Brx& Udn() const;
+    const Brx& Location() const;
+    TUint MaxAgeSeconds() const;
+    TUint ConfigId() const;
+    TBool IsTentative() const;
+    CpiDevice& Device();
+    TBool Ready() const;
+
+    /**
+     * Called to reset the maxage timeout each time an alive message is received.
+     * A device should be considered alive while at least one of its services hasn't
+     * expired so the underlying timer is only updated if the new max age is later
+     * than the current one.
+     */
+    void UpdateMaxAge(TUint aSeconds);
+
+    void FetchXml();
+    void InterruptXmlFetch();
+    void CheckStillAvailable(CpiDeviceUpnp* aNewDevice);
+    void CheckStillAvailable();
+    /**
+     * Check a device restored from a previous run is still contactable at its last
+     * known location.  It is removed if not, or if it hasn't announced itself within
+     * aConfirmMs.
+     */
+    void CheckRestored(TUint aConfirmMs);
+private: // ICpiProtocol
+    TBool GetAttribute(const char* aKey, Brh& aValue) const;
+    void InvokeAction(Invocation& aInvocation);
+    TUint Subscribe(CpiSubscription& aSubscription, const Uri& aSubscriber);
+    TUint Renew(CpiSubscription& aSubscription);
+    void Unsubscribe(CpiSubscription& aSubscription, const Brx& aSid);
+    TBool OrphanSubscriptionsOnSubnetChange() const;
+    void NotifyRemovedBeforeReady();
+    TUint Version(const TChar* aDomain, const TChar* aName, TUint aProxyVersion) const;
+private: // ICpiDeviceObserver
+    void Release();
+private: // ICpiDeviceDescriptionObserver
+    void DescriptionFetched(CpiDeviceDescription* aDescription);
+private:
+    ~CpiDeviceUpnp();
+    const Brx& Xml() const;
+    void ClaimDescription();
+    void DescriptionAvailable(CpiDeviceDescription* aDescription);
+    void TimerExpired();
+    void GetServiceUri(Uri& aUri, const TChar* aType, const ServiceType& aServiceType);
+    void XmlFetchReadUdnCompleted(IAsync& aAsync);
+    void XmlFetchCompleted(IAsync& aAsync);
+    void XmlCheckLocationCompleted(IAsync& aAsync);
+    void XmlCheckRefreshCompleted(IAsync& aAsync);
+    static TBool UdnMatches(const Brx& aFound, const Brx& aTarget);
+private:
+    class Invocable : public IInvocable, private INonCopyable
+    {
+    public:
+        Invocable(CpiDeviceUpnp& aDevice);
+        virtual void InvokeAction(Invocation& aInvocation);
+    private:
+        CpiDeviceUpnp& iDevice;
+    };
+private:
+    CpStack& iCpStack;
+    CpiDevice* iDevice;
+    mutable Mutex iLock;
+    Brhz iLocation;
+    XmlFetch* iXmlFetch;
+    CpiDeviceDescription* iDescription;
+    DeviceXml* iDeviceXml;
+    TUint iConfigId;
+    TIpAddress iInterface;
+    TBool iAwaitingDescription;
+    TBool iTentative;
+    Timer* iTimer;
+    TUint iExpiryTime;
+    TUint iMaxAgeSeconds;
+    IDeviceRemover& iDeviceList;
+    CpiDeviceListUpnp* iList;
+    Invocable* iInvocable;
+    InvocationConnectionCache* iConnectionCache;
+    InvocationConnectionCache* iRenewConnectionCache;
+    Semaphore iSemReady;
+    TBool iRemoved;
+    TBool iHostUdpIsLowQuality;
+    CpiDeviceUpnp* iNewLocation;
+    XmlFetch* iXmlCheckLocation;
+    XmlFetch* iXmlCheckRefresh;
+    friend class Invocable;
+};
+
+/**
+ * UPnP-specific list of devices for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnp : public CpiDeviceList, public ISsdpNotifyHandler, private IResumeObserver
+{
+public:
+    void XmlFetchCompleted(CpiDeviceUpnp& aDevice, TBool aError);
+    void DeviceLocationChanged(CpiDeviceUpnp* aOriginal, CpiDeviceUpnp* aNew);
+    void TryAdd(const Brx& aLocation);
+    TIpAddress Interface() const;
+protected:
+    /**
+     * aNotifyTarget, aNotifyUuidOrDomain and aNotifyType select the multicast notifications
+     * passed to this list.  See SsdpListenerMulticast::AddNotifyHandler.
+     */
+    CpiDeviceListUpnp(CpStack& aCpStack, ESsdpTarget aNotifyTarget, const Brx& aNotifyUuidOrDomain, const Brx& aNotifyType,
+                      FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnp();
+
+    void StopListeners();
+
+    void Add(CpiDeviceUpnp* aDevice);
+    /**
+     * Checks to see if a device is already in the list and updates its maxage
+     * timeout if it is.
+     * Returns true if an existing device was found.  Returning false implies
+     * that this is a new device which should be added to the list.
+     * false will always be returned while a list is being refreshed.
+     */
+    TBool Update(const Brx& aUdn, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void DoStart();
+    /**
+     * Returns true if a device restored from a previous run belongs in this list.
+     */
+    virtual TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot) = 0;
+    void DoRefresh();
+protected: // from CpiDeviceList
+    void Start();
+    void Refresh();
+    TBool IsDeviceReady(CpiDevice& aDevice);
+    TBool IsLocationReachable(const Brx& aLocation) const;
+protected: // from ISsdpNotifyHandler
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyRootByeBye(const Brx& aUuid);
+    void SsdpNotifyUuidByeBye(const Brx& aUuid);
+    void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
+    void SsdpNotifyServiceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
+private: // IResumeObserver
+    void NotifyResumed();
+private:
+    void RefreshTimerComplete();
+    void ResumedTimerComplete();
+    void RepeatMsearchTimerComplete();
+    void CurrentNetworkAdapterChanged();
+    void SubnetListChanged();
+    void HandleInterfaceChange();
+    void RemoveAll();
+    void AddRestoredDevices();
+    void AddNotifyHandler();
+protected:
+    SsdpListenerUnicast* iUnicastListener;
+    Mutex iSsdpLock;
+private:
+    static const TUint kMaxMsearchRetryForNewAdapterSecs = 60;
+    static const TUint kResumeDelayMs = 2 * 1000;
+    static const TUint kRefreshRetries = 4;
+    Environment& iEnv;
+    TIpAddress iInterface;
+    SsdpListenerMulticast* iMulticastListener;
+    const ESsdpTarget iNotifyTarget;
+    Brh iNotifyUuidOrDomain;
+    Brh iNotifyType;
+    TInt iNotifyHandlerId;
+    TUint iInterfaceChangeListenerId;
+    TUint iSubnetListChangeListenerId;
+    TBool iStarted;
+    TBool iNoRemovalsFromRefresh;
+    Timer* iRefreshTimer;
+    Timer* iResumedTimer;
+    Timer* iRepeatMsearchTimer;
+    TUint iRefreshRepeatCount;
+    TUint iRepeatMsearchMs;
+};
+
+/**
+ * List of all UPnP devices for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnpAll : public CpiDeviceListUpnp
+{
+public:
+    CpiDeviceListUpnpAll(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnpAll();
+    void Start();
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
+private:
+    void SsdpNotification(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+};
+
+/**
+ * List of all root UPnP devices for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnpRoot : public CpiDeviceListUpnp
+{
+public:
+    CpiDeviceListUpnpRoot(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnpRoot();
+    void Start();
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
+};
+
+/**
+ * List of all UPnP devices with a given uuid (udn) for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnpUuid : public CpiDeviceListUpnp
+{
+public:
+    CpiDeviceListUpnpUuid(CpStack& aCpStack, const Brx& aUuid, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnpUuid();
+    void Start();
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
+private:
+    Brh iUuid;
+};
+
+/**
+ * List of all UPnP devices of a given device type for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnpDeviceType : public CpiDeviceListUpnp
+{
+public:
+    CpiDeviceListUpnpDeviceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aDeviceType,
+                                TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnpDeviceType();
+    void Start();
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
+private:
+    Brh iDomainName;
+    Brh iDeviceType;
+    TUint iVersion;
+};
+
+/**
+ * List of all UPnP devices of a given service type for a single network interface.
+ *
+ * This class is not intended for use outside this module.
+ */
+class CpiDeviceListUpnpServiceType : public CpiDeviceListUpnp
+{
+public:
+    CpiDeviceListUpnpServiceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aServiceType,
+                                 TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    ~CpiDeviceListUpnpServiceType();
+    void Start();
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
+private:
+    Brh iDomainName;
+    Brh iServiceType;
+    TUint iVersion;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_CPIDEVICEUPNP
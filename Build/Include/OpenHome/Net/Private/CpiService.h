@@ -0,0 +1,695 @@
+/**
+ * Control Point representation and invocation of services
+ *
+ * This module is independent of the protocol being used.
+ * It assumes that each service comprises a number of actions, each of which has 0..n
+ * input and output parameters.  A particular invocation of an action creates an argument
+ * per parameter.
+ */
+
+#ifndef HEADER_CPISERVICE
+#define HEADER_CPISERVICE
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Net/Private/Service.h>
+#include <OpenHome/Net/Private/CpiDevice.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Functor.h>
+#include <OpenHome/Net/Private/AsyncPrivate.h>
+#include <OpenHome/Net/Private/Error.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Private/CpiStack.h>
+
+#include <vector>
+#include <map>
+#include <list>
+
+namespace OpenHome {
+class Socket;
+namespace Net {
+
+class Invocation;
+class CpiSubscription;
+class IInvocable;
+class IEventProcessor;
+
+/**
+ * Service.  Specific to a single device.
+ *
+ * A service does not claim a reference to a device.  It is assumed that the owner
+ * of the service will also own a device reference and will ensure that the service
+ * is destroyed before the device reference is released.
+ */
+class DllExportClass CpiService : public OpenHome::Net::Service, private IStackObject
+{
+public:
+    DllExport CpiService(const TChar* aDomain, const TChar* aName, TUint aVersion, CpiDevice& aDevice);
+
+    /**
+     * Destructor.  Will block until any pending invocations complete.
+     * Any pending invocations are likely to complete with errors.
+     */
+    DllExport ~CpiService();
+    
+    // !!!! Refresh (refresh iSubscription)
+
+    /**
+     * Returns an invocation instance, setup for this service and the specific
+     * action/observer/data.
+     *
+     * The stack uses a fixed pool of invocations.  If no invocation is available,
+     * this function will block until one becomes available.
+     *
+     * The callback will run when the invocation completes.  The invocation will
+     * be cleared when the callback returns so any output arguments of interest
+     * may need to be copied/transferred.  Once Invoke() is called on the invocation
+     * the callback is guaranteed to be called.
+     */
+    DllExport OpenHome::Net::Invocation* Invocation(const Action& aAction, FunctorAsync& aFunctor);
+
+    /**
+     * Subscribe to updates on properties for this Service
+     * Callbacks for changes in a given Property are set on the Property.
+     * [see AddProperty()]
+     * Note that subscription is asynchronous.  There is no formal notification that
+     * it has completed but clients can infer this by setting a callback using
+     * CpProxy::SetPropertyChanged().  The next callback after a call to Subscribe()
+     * implies that a subscription has completed
+     * It is safe to delete a Service while a subscription is in progress.
+     * Returns true if a subscription request was queued or false if it couldn't be queued.
+     */
+    TBool Subscribe(IEventProcessor& aEventProcessor);
+
+    /**
+     * Unsubscribe to updates on properties for this Service
+     * Callbacks on properties will no longer run.
+     * Note that unsubscription is asynchronous so it is possible that update
+     * callbacks will continue to be received for a brief period after calling
+     * this.
+     * It is safe to delete a Service when an unsubscription is in progress.
+     */
+    void Unsubscribe();
+
+    /**
+     * Used by Invocation.  Not intended for use by other classes.
+     */
+    void InvocationCompleted();
+
+    /**
+     * Query whether invocations of actions on this service should be interrupted.
+     *
+     * If this returns true, invocations will probably complete quickly but with an error.
+     */
+    TBool Interrupt() const;
+
+    /**
+     * Return the device this service operates on.
+     */
+    CpiDevice& Device();
+
+    /**
+     * Query the version of the service.
+     */
+    TUint Version() const;
+private:
+    void Renew();
+private: // from IStackObject
+    void ListObjectDetails() const;
+private:
+    CpiDevice& iDevice;
+    OpenHome::Mutex iLock;
+    TUint iPendingInvocations;
+    Semaphore iShutdownSignal;
+    TBool iInterrupt;
+    CpiSubscription* iSubscription;
+};
+
+/**
+ * Used by a device to write input arguments in the form expected by the
+ * protocol being used
+ */
+class IInputArgumentProcessor
+{
+public:
+    virtual void ProcessString(const Brx& aVal) = 0;
+    virtual void ProcessInt(TInt aVal) = 0;
+    virtual void ProcessUint(TUint aVal) = 0;
+    virtual void ProcessBool(TBool aVal) = 0;
+    virtual void ProcessBinary(const Brx& aVal) = 0;
+};
+
+template <class T> class ArgumentSlab;
+
+/**
+ * (Action) Argument
+ *
+ * One Argument will be created per [in/out]put Parameter for the Action
+ * Input parameters should construct arguments using the (Parameter, Val) constructor.
+ * Output parameters should construct arguments using only the parameter and should
+ * read the value when the invocation completes.
+ *
+ * Invocation also keeps a pool of recycled arguments (see Invocation::AddInputUint() etc.).
+ * These are created using the default constructor and have their Parameter set on each use.
+ */
+class Argument : public INonCopyable
+{
+    friend class Invocation;
+public:
+    virtual ~Argument();
+    virtual void ProcessInput(IInputArgumentProcessor& aProcessor) = 0;
+    virtual void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer) = 0;
+    const OpenHome::Net::Parameter& Parameter() const;
+protected:
+    Argument();
+    Argument(const OpenHome::Net::Parameter& aParameter);
+    void ValidationFailed(const OpenHome::Net::Parameter& aParameter);
+protected:
+    const OpenHome::Net::Parameter* iParameter;
+private:
+    TBool iRecycled;
+};
+
+/**
+ * String argument.  Output buffers will be nul terminated.
+ */
+class DllExportClass ArgumentString : public Argument
+{
+public:
+    DllExport ArgumentString(const OpenHome::Net::Parameter& aParameter); // for output params
+    DllExport ArgumentString(const OpenHome::Net::Parameter& aParameter, const Brx& aValue); // for input params
+    DllExport ~ArgumentString();
+    DllExport const Brx& Value() const;
+    DllExport void TransferTo(Brh& aBrh);
+    void ProcessInput(IInputArgumentProcessor& aProcessor);
+    void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentString>;
+    friend class Invocation;
+    ArgumentString();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
+private:
+    Brhz iValue;
+    Bwh iInputValue; // reused by recycled input arguments
+    TBool iInput;
+};
+
+/**
+ * Integer argument
+ */
+class DllExportClass ArgumentInt : public Argument
+{
+public:
+    DllExport ArgumentInt(const OpenHome::Net::Parameter& aParameter);
+    DllExport ArgumentInt(const OpenHome::Net::Parameter& aParameter, TInt aValue);
+    DllExport ~ArgumentInt();
+    DllExport TInt Value() const;
+    void ProcessInput(IInputArgumentProcessor& aProcessor);
+    void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentInt>;
+    friend class Invocation;
+    ArgumentInt();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TInt aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
+private:
+    TInt iValue;
+};
+
+/**
+ * Unsigned integer argument
+ */
+class DllExportClass ArgumentUint : public Argument
+{
+public:
+    DllExport ArgumentUint(const OpenHome::Net::Parameter& aParameter);
+    DllExport ArgumentUint(const OpenHome::Net::Parameter& aParameter, TUint aValue);
+    DllExport ~ArgumentUint();
+    DllExport TUint Value() const;
+    void ProcessInput(IInputArgumentProcessor& aProcessor);
+    void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentUint>;
+    friend class Invocation;
+    ArgumentUint();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TUint aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
+private:
+    TUint iValue;
+};
+
+/**
+ * Boolean arguments
+ */
+class DllExportClass ArgumentBool : public Argument
+{
+public:
+    DllExport ArgumentBool(const OpenHome::Net::Parameter& aParameter);
+    DllExport ArgumentBool(const OpenHome::Net::Parameter& aParameter, TBool aValue);
+    DllExport ~ArgumentBool();
+    DllExport TBool Value() const;
+    void ProcessInput(IInputArgumentProcessor& aProcessor);
+    void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentBool>;
+    friend class Invocation;
+    ArgumentBool();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TBool aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
+private:
+    TBool iValue;
+};
+
+/**
+ * Binary argument.  Similar to ArgumentString but output will not be nul terminated
+ */
+class DllExportClass ArgumentBinary : public Argument
+{
+public:
+    DllExport ArgumentBinary(const OpenHome::Net::Parameter& aParameter);
+    DllExport ArgumentBinary(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    DllExport ~ArgumentBinary();
+    DllExport const Brx& Value() const;
+    DllExport void TransferTo(Brh& aBrh);
+    void ProcessInput(IInputArgumentProcessor& aProcessor);
+    void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentBinary>;
+    friend class Invocation;
+    ArgumentBinary();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
+private:
+    Brh iValue;
+    Bwh iInputValue; // reused by recycled input arguments
+    TBool iInput;
+};
+
+/**
+ * Pool of recycled arguments of a single type.
+ *
+ * Each Invocation owns one of these per argument type.  Arguments are never deleted
+ * while the Invocation exists; Reset() makes all of them available for reuse.
+ *
+ * Intended for internal use only
+ */
+template <class T> class ArgumentSlab : public INonCopyable
+{
+public:
+    ArgumentSlab() : iUsed(0) {}
+    ~ArgumentSlab()
+    {
+        for (TUint i=0; i<iArguments.size(); i++) {
+            delete iArguments[i];
+        }
+    }
+    void Reserve(TUint aCount)
+    {
+        while (iArguments.size() < aCount) {
+            iArguments.push_back(new T());
+        }
+    }
+    T& Next()
+    {
+        Reserve(iUsed + 1);
+        return *iArguments[iUsed++];
+    }
+    void Reset() { iUsed = 0; }
+private:
+    std::vector<T*> iArguments;
+    TUint iUsed;
+};
+
+/**
+ * Callback used to interrupt an active operation
+ * CpDevices should implement this interface.
+ */
+class IInterruptHandler
+{
+public:
+    /**
+     * Signal that the operation should be interrupted.
+     * This function does not need to wait until the operation stops.
+     */
+    virtual void Interrupt() = 0;
+};
+
+/**
+ * Completes an invocation which released its invoker thread using Invocation::Suspend()
+ *
+ * Intended for internal use only
+ */
+class IInvocationContinuation
+{
+public:
+    /**
+     * Called on an invoker thread once the suspended socket is readable or, if aTimedOut
+     * is true, once the timeout passed to Suspend() has elapsed.
+     * May throw the same exceptions as IInvocable::InvokeAction() or call Suspend() again.
+     */
+    virtual void Continue(TBool aTimedOut) = 0;
+    virtual ~IInvocationContinuation() {}
+};
+
+/**
+ * Used to invoke an Action with particular Arguments on a Service
+ *
+ * Control point side clients must not create new Invocation instances or delete instances
+ * returned by Service::GetInvocation() or passed to their invocation completed callback.
+ *
+ * Normal use will be
+ * - create (possibly allocating) any data required in the callback
+ * - use Service::GetInvocation() to retrieve a pointer from an existing pool
+ *      the invocation will have Service and Action name set automatically
+ *      the invocation will have the client-specified callback and data set automatically
+ * - create one Argument-derived class for each InputParameter on the action
+ *      these arguments must have their values set (i.e. use the c'tor taking two params)
+ * - call AddInput() for each of these arguments
+ * - create one Argument-derived class for each OutputParameter on the action
+ *      these arguments should not have their values set (i.e. use the c'tor taking one param)
+ * - call AddOutput() for each of these arguments
+ *      alternatively, use AddInputUint(), AddOutputUint() etc. to use argument
+ *      storage which is owned by the invocation and recycled between uses
+ * - call IInvocable::QueueInvocation()
+ * ....
+ * - The invocation completed callback will run.  Invocation::Error() will be
+ *      true if the invocation failed.  If no error occurred, each member of
+ *      OutputArguments() will be set.
+ */
+class DllExportClass Invocation : public Async
+{
+public:
+    /**
+     * Intended for internal use only
+     */
+    void SignalCompleted();
+
+    /**
+     * Returns true if the invocation failed; false if it successed
+     *
+     * The Completed() callback will still be called if an invocation fails.  It should
+     * not attempt to access OutputArguments() if it failed but must free any user data.
+     */
+    DllExport TBool Error() const;
+
+    /**
+     * Returns true if the invocation failed; false if it successed
+     *
+     * The Completed() callback will still be called if an invocation fails.  It should
+     * not attempt to access OutputArguments() if it failed but must free any user data.
+     *
+     * All args are output only and will only be set if the function returns true.
+     */
+    DllExport TBool Error(Error::ELevel& aLevel, TUint& aCode, const TChar*& aDescription) const;
+
+    /**
+     * Intended for internal use only
+     */
+    TBool Interrupt() const;
+
+    /**
+     * Intended for internal use only
+     */
+    void Set(CpiService& aService, const OpenHome::Net::Action& aAction, CpiDevice& aDevice, FunctorAsync& aFunctor);
+
+    /**
+     * Add an input argument, passing ownership of aArgument
+     *
+     * aArgument should have a value set (i.e. used the c'tor taking two params)
+     */
+    DllExport void AddInput(Argument* aArgument);
+
+    /**
+     * Add an output argument, passing ownership of aArgument
+     *
+     * aArgument should not have a value set (i.e. used the c'tor taking one param)
+     */
+    DllExport void AddOutput(Argument* aArgument);
+
+    /**
+     * Add an input argument, using storage owned by this invocation
+     *
+     * Argument objects and their buffers are recycled when the invocation is returned
+     * to its pool so, unlike AddInput(), these don't allocate once the invocation has
+     * been used for an action with a similar signature.
+     */
+    DllExport void AddInputString(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    DllExport void AddInputInt(const OpenHome::Net::Parameter& aParameter, TInt aValue);
+    DllExport void AddInputUint(const OpenHome::Net::Parameter& aParameter, TUint aValue);
+    DllExport void AddInputBool(const OpenHome::Net::Parameter& aParameter, TBool aValue);
+    DllExport void AddInputBinary(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+
+    /**
+     * Add an output argument, using storage owned by this invocation
+     *
+     * As with AddInputString() etc., these avoid allocating Argument objects.
+     */
+    DllExport void AddOutputString(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputInt(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputUint(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputBool(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputBinary(const OpenHome::Net::Parameter& aParameter);
+
+    /**
+     * Set error details on this invocation.
+     *
+     * The Completed() callback will assume that the invocation failed.
+     * Intended for use by CpiDevice-derived classes.
+     */
+    void SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription);
+
+    /**
+     * Set the handler for interrupting this invocation
+     */
+    void SetInterruptHandler(IInterruptHandler* aHandler);
+
+    /**
+     * Signal that this invocation should be interrupted if its Action is a member of aService
+     * Returns true if the invocation was interrupted.
+     * Intended for internal use only
+     */
+    TBool Interrupt(const Service& aService);
+
+    /**
+     * Release the invoker thread until aSocket is readable or aTimeoutMs has elapsed
+     *
+     * aContinuation is then run on an invoker thread to complete the invocation.  This
+     * must be the last thing IInvocable::InvokeAction() or IInvocationContinuation::Continue()
+     * does.  Passes ownership of aContinuation; it is deleted once the invocation completes.
+     * Intended for use by CpiDevice-derived classes.
+     */
+    void Suspend(Socket& aSocket, TUint aTimeoutMs, IInvocationContinuation& aContinuation);
+
+    /**
+     * Returns true if Suspend() has been called and the invocation hasn't yet continued
+     */
+    TBool Suspended() const;
+
+    const OpenHome::Net::ServiceType& ServiceType() const;
+    DllExport const OpenHome::Net::Action& Action() const;
+    CpiDevice& Device();
+
+    /**
+     * Log details of this invocation + error status
+     */
+    void Output(IAsyncOutput& aConsole);
+
+    typedef std::vector<Argument*> VectorArguments;
+    /**
+     * Return a vector of input arguments (one per input parameter for the Action)
+     *
+     * This can be called by any client but is assumed to be of interest to devices only
+     */
+    const VectorArguments& InputArguments() const;
+
+    /**
+     * Return a vector of output arguments (one per output parameter for the Action)
+     *
+     * This is assumed to be of interest to the device and the Completed() callback
+     */
+    DllExport VectorArguments& OutputArguments();
+
+    void SetInvoker(IInvocable& aInvocable);
+    IInvocable& Invoker();
+    const Brx& Udn() const;
+private:
+    Invocation(CpStack& aCpStack, Fifo<OpenHome::Net::Invocation*>& aFree);
+    Invocation& operator=(const Invocation& aInvocation);
+    ~Invocation();
+    void Clear();
+    TBool Continue();
+    void ReserveArguments(const OpenHome::Net::Action& aAction);
+    static OpenHome::Net::Parameter::EType ArgumentType(const OpenHome::Net::Parameter& aParameter);
+    static void OutputArgument(IAsyncOutput& aConsole, const TChar* aKey, const Argument& aArgument);
+    virtual TUint Type() const;
+private:
+    CpStack& iCpStack;
+    OpenHome::Mutex iLock;
+    Fifo<OpenHome::Net::Invocation*>& iFree;
+    CpiService* iService;
+    const OpenHome::Net::Action* iAction;
+    CpiDevice* iDevice;
+    FunctorAsync iFunctor;
+    TUint iSequenceNumber;
+    OpenHome::Net::Error iError;
+    TBool iCompleted;
+    VectorArguments iInput;
+    VectorArguments iOutput;
+    ArgumentSlab<ArgumentString> iStrings;
+    ArgumentSlab<ArgumentInt> iInts;
+    ArgumentSlab<ArgumentUint> iUints;
+    ArgumentSlab<ArgumentBool> iBools;
+    ArgumentSlab<ArgumentBinary> iBinaries;
+    IInterruptHandler* iInterruptHandler;
+    IInvocable* iInvoker;
+    IInvocationContinuation* iContinuation;
+    Socket* iSuspendSocket;
+    TUint iSuspendTimeoutMs;
+    TBool iTimedOut;
+private:
+    friend class InvocationManager;
+    friend class InvocationPoller;
+    friend class Invoker;
+};
+
+class InvocationManager;
+
+/**
+ * Dedicated thread which processes action invocations
+ *
+ * Intended for internal use only
+ */
+class Invoker : public Thread
+{
+public:
+    Invoker(const TChar* aName, InvocationManager& aManager);
+    ~Invoker();
+
+    /**
+     * Signal that aInvocation should be invoked
+     */
+    void Invoke(Invocation* aInvocation);
+    
+    /**
+     * Interrupt any current invocation if its action is a member of aService
+     */
+    void Interrupt(const Service& aService);
+
+    /**
+     * Run aInvocation on the calling thread, setting its error if it fails
+     *
+     * If aCanSuspend is false, this waits for the response to any suspended invocation.
+     * Returns true if aInvocation was suspended (so shouldn't be completed yet).
+     */
+    static TBool InvokeAction(Invocation& aInvocation, TBool aCanSuspend);
+private:
+    static void SetError(Invocation& aInvocation, Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr);
+    void Run();
+private:
+    InvocationManager& iManager;
+    Invocation* iInvocation;
+    OpenHome::Mutex iLock;
+};
+
+/**
+ * Dedicated thread which watches the sockets of suspended invocations
+ *
+ * Invocations are passed back to the InvocationManager once their socket is readable
+ * or their timeout elapses.  Intended for internal use only
+ */
+class InvocationPoller : public Thread
+{
+public:
+    InvocationPoller(Environment& aEnv, InvocationManager& aManager);
+    ~InvocationPoller();
+    /**
+     * Returns false if this platform can't poll many sockets
+     */
+    TBool Enabled() const;
+    /**
+     * Watch the socket passed to aInvocation.Suspend()
+     */
+    void Park(OpenHome::Net::Invocation& aInvocation);
+    /**
+     * Interrupt and resume any parked invocations whose action is a member of aService
+     */
+    void Interrupt(const Service& aService);
+private:
+    void Run();
+private:
+    class ParkedInvocation
+    {
+    public:
+        ParkedInvocation(TUint aId, OpenHome::Net::Invocation& aInvocation, TUint aExpiryMs);
+    public:
+        TUint iId;
+        OpenHome::Net::Invocation* iInvocation;
+        TUint iExpiryMs;
+    };
+    typedef std::list<ParkedInvocation> ParkedList;
+    static const TUint kMaxPollIds = 64;
+private:
+    Environment& iEnv;
+    InvocationManager& iManager;
+    OpenHome::Mutex iLock;
+    THandle iPoller;
+    TUint iNextId;
+    ParkedList iParked;             // earliest expiry first
+    std::map<TUint, ParkedList::iterator> iParkedById;
+    TBool iStopping;
+};
+
+/**
+ * Singleton which manages the pools of Invocation and Invoker instances
+ */
+class InvocationManager : public Thread
+{
+    friend class CpiService;
+    friend class Invoker;
+    friend class InvocationPoller;
+public:
+    InvocationManager(CpStack& aCpStack);
+    ~InvocationManager();
+    void Invoke(OpenHome::Net::Invocation* aInvocation);
+    void Interrupt(const Service& aService);
+private:
+    OpenHome::Net::Invocation* Invocation();
+    void InvokeOnCallerThread(OpenHome::Net::Invocation& aInvocation);
+    TBool CanSuspend() const;
+    void InvokerFree(Invoker& aInvoker, CpiDevice* aDevice, OpenHome::Net::Invocation* aSuspended);
+    void Resume(OpenHome::Net::Invocation& aInvocation, TBool aTimedOut);
+    void QueueLocked(OpenHome::Net::Invocation& aInvocation, TBool aFront);
+    OpenHome::Net::Invocation* NextLocked();
+    void Run();
+private:
+    class DeviceInvocations
+    {
+    public:
+        DeviceInvocations();
+    public:
+        std::list<OpenHome::Net::Invocation*> iWaiting;
+        TUint iActive;              // number of invokers in use
+    };
+private:
+    CpStack& iCpStack;
+    OpenHome::Mutex iLock;
+    Fifo<OpenHome::Net::Invocation*> iFreeInvocations;
+    Fifo<OpenHome::Net::Invocation*> iWaitingInvocations;
+    OpenHome::Mutex iLockQueues;
+    std::vector<Invoker*> iFreeInvokers;
+    std::map<CpiDevice*, DeviceInvocations> iDevices;
+    std::list<CpiDevice*> iReadyDevices; // devices with waiting invocations, in round robin order
+    std::vector<OpenHome::Net::Invocation*> iCallerThreadInvocations;
+    TUint iMaxInvokersPerDevice;
+    Invoker** iInvokers;
+    InvocationPoller* iPoller;
+    TBool iActive;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_CPISERVICE
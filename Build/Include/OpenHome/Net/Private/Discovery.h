@@ -0,0 +1,236 @@
+#ifndef HEADER_SSDP_DISCOVERY
+#define HEADER_SSDP_DISCOVERY
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Net/Private/Ssdp.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Network.h>
+
+#include <vector>
+#include <map>
+
+namespace OpenHome {
+class Environment;
+namespace Net {
+
+
+// INotifyHandler - called by MulticastListener on receiving an alive or byebye notification
+class ISsdpNotifyHandler
+{
+public:
+    // aConfigId is Ssdp::kConfigIdUnknown for devices which don't report CONFIGID.UPNP.ORG
+    virtual void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyRootByeBye(const Brx& aUuid) = 0;
+    virtual void SsdpNotifyUuidByeBye(const Brx& aUuid) = 0;
+    virtual void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion) = 0;
+    virtual void SsdpNotifyServiceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion) = 0;
+    virtual ~ISsdpNotifyHandler() {}
+};
+
+// IMsearchHandler - called by MulticastListener on receiving an m-search request
+class ISsdpMsearchHandler
+{
+public:
+    virtual void SsdpSearchAll(const Endpoint& aEndpoint, TUint aMx) = 0;
+    virtual void SsdpSearchRoot(const Endpoint& aEndpoint, TUint aMx) = 0;
+    virtual void SsdpSearchUuid(const Endpoint& aEndpoint, TUint aMx, const Brx& aUuid) = 0;
+    virtual void SsdpSearchDeviceType(const Endpoint& aEndpoint, TUint aMx, const Brx& aDomain, const Brx& aType, TUint aVersion) = 0;
+    virtual void SsdpSearchServiceType(const Endpoint& aEndpoint, TUint aMx, const Brx& aDomain, const Brx& aType, TUint aVersion) = 0;
+    virtual ~ISsdpMsearchHandler() {}
+};
+
+// SsdpListener - base class for ListenerMulticast and ListenerUnicast
+class SsdpListener : public Thread
+{
+    static const TUint kPriority = kPriorityNormal;
+public:
+    TUint MessagesReceived() const;
+    TUint MessagesMalformed() const; // dropped as they couldn't be parsed
+    TUint MessagesRejected() const;  // dropped before any handler was called (missing, inconsistent or unwanted headers)
+protected:
+    static const TUint kMaxBufferBytes = 1024;
+    static const TUint kReceiveSlots = 16;
+protected:
+    SsdpListener(const TChar* aName);
+    void CountReceived();
+    void CountMalformed();
+    void CountRejected();
+protected:
+    SsdpMessageParser iParser;
+    SsdpHeaderCacheControl iHeaderCacheControl;
+    HttpHeaderLocation iHeaderLocation;
+    SsdpHeaderServer iHeaderServer;
+    SsdpHeaderSt iHeaderSt;
+    SsdpHeaderUsn iHeaderUsn;
+    SsdpHeaderConfigId iHeaderConfigId;
+private:
+    mutable OpenHome::Mutex iCountLock;
+    TUint iReceived;
+    TUint iMalformed;
+    TUint iRejected;
+};
+
+// SsdpListenerMulticast - listens to the multicast udp endpoint
+//                       - processes received messages and passes them on to either an IMsearchHandler or an INotifyHandler
+class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
+{
+    static const TUint kMaxMxSecs = 5; // UPnP 1.0 allows [1..120]; 1.1 reduced this to a more sensible [1..5]
+    static const TUint kRecvBufBytes = 32 * 1024;
+    enum ENotification
+    {
+        eNotifyInvalid
+       ,eNotifyRootAlive
+       ,eNotifyUuidAlive
+       ,eNotifyDeviceTypeAlive
+       ,eNotifyServiceTypeAlive
+       ,eNotifyRootByeBye
+       ,eNotifyUuidByeBye
+       ,eNotifyDeviceTypeByeBye
+       ,eNotifyServiceTypeByeBye
+    };
+    class Handler
+    {
+    public:
+        TInt Id() const { return iId; }
+        OpenHome::Mutex& Mutex() { return iLock; }
+        void Lock() { iLock.Wait(); }
+        void Unlock() { iLock.Signal(); }
+        void Disable() { iDead = true; }
+        TBool IsDisabled() const { return iDead; }
+    protected:
+        Handler(TInt aId) : iDead(false), iId(aId), iLock("SSDM") {}
+    private:
+        TBool iDead;
+        TInt iId;
+        OpenHome::Mutex iLock;
+    };
+    class NotifyHandler : public Handler
+    {
+    public:
+        NotifyHandler(ISsdpNotifyHandler* aHandler, TInt aId, ESsdpTarget aTarget, const Brx& aKey)
+            : SsdpListenerMulticast::Handler(aId), iHandler(aHandler), iTarget(aTarget), iKey(aKey) {}
+        ISsdpNotifyHandler* Handler() { return iHandler; }
+        ESsdpTarget Target() const { return iTarget; }
+        const Brx& Key() const { return iKey; }
+    private:
+        ISsdpNotifyHandler* iHandler;
+        ESsdpTarget iTarget;
+        Brh iKey;
+    };
+    class MsearchHandler : public Handler
+    {
+    public:
+        MsearchHandler(ISsdpMsearchHandler* aHandler, TInt aId) : SsdpListenerMulticast::Handler(aId), iHandler(aHandler) {}
+        ISsdpMsearchHandler* Handler() { return iHandler; }
+    private:
+        ISsdpMsearchHandler* iHandler;
+    };
+    typedef std::vector<NotifyHandler*> VectorNotifyHandler;
+    typedef std::vector<MsearchHandler*> VectorMsearchHandler;
+    typedef std::map<Brn, VectorNotifyHandler, BufferCmp> NotifyIndex; // keys point into the first handler's Key()
+    static const TUint kMaxTypeKeyBytes = 129; // domain:type, as limited by SsdpHeaderNt
+public:
+    SsdpListenerMulticast(Environment& aEnv, const TIpAddress& aInterface);
+    virtual ~SsdpListenerMulticast();
+    /**
+     * aTarget restricts the notifications passed to aNotifyHandler:
+     *   eSsdpAll         - every notification
+     *   eSsdpRoot        - root device notifications
+     *   eSsdpUuid        - uuid notifications for device aUuidOrDomain
+     *   eSsdpDeviceType  - notifications for device type aType (any version) in domain aUuidOrDomain
+     *   eSsdpServiceType - notifications for service type aType (any version) in domain aUuidOrDomain
+     * Handlers are indexed by target so each notification is only passed to the handlers it matches.
+     */
+    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler, ESsdpTarget aTarget = eSsdpAll,
+                          const Brx& aUuidOrDomain = Brx::Empty(), const Brx& aType = Brx::Empty());
+    TInt AddMsearchHandler(ISsdpMsearchHandler* aMsearchHandler);
+    void RemoveNotifyHandler(TInt aHandlerId);
+    void RemoveMsearchHandler(TInt aHandlerId);
+    const TIpAddress& Interface() const;
+private:
+    void Run();
+    void Terminated();
+    void Process(const Brx& aMessage);
+    ENotification NotifyType() const;
+    TUint MsearchMx() const;
+    void Notify(NotifyHandler& aHandler, ENotification aType);
+    void Notify(ISsdpNotifyHandler& aNotifyHandler, ENotification aType);
+    void Msearch(MsearchHandler& aHandler, TUint aMx);
+    void Msearch(ISsdpMsearchHandler& aMsearchHandler, TUint aMx);
+    void NotifyHandlers(ENotification aType, VectorNotifyHandler& aHandlers) const;
+    static void AppendIndexed(const NotifyIndex& aIndex, const Brx& aKey, VectorNotifyHandler& aHandlers);
+    static void RemoveIndexed(NotifyIndex& aIndex, NotifyHandler* aHandler);
+    static void TypeKey(const Brx& aDomain, const Brx& aType, Bwx& aKey);
+    void DeleteDisabled();
+    void EraseDisabled(VectorMsearchHandler& aVector);
+    void DnsChanged();
+private: // from IResumeObserver
+    void NotifyResumed();
+private:
+    Environment& iEnv;
+    VectorNotifyHandler iNotifyHandlers;         // every registered handler
+    VectorNotifyHandler iNotifyHandlersAll;      // handlers for eSsdpAll
+    VectorNotifyHandler iNotifyHandlersRoot;     // handlers for eSsdpRoot
+    NotifyIndex iNotifyHandlersUuid;             // handlers for eSsdpUuid, indexed by uuid
+    NotifyIndex iNotifyHandlersDeviceType;       // handlers for eSsdpDeviceType, indexed by domain:type
+    NotifyIndex iNotifyHandlersServiceType;      // handlers for eSsdpServiceType, indexed by domain:type
+    VectorNotifyHandler iNotifyHandlersDisabled; // removed but possibly still referenced by Run()
+    VectorMsearchHandler iMsearchHandlers;
+    OpenHome::Mutex iLock;
+    TInt iNextHandlerId;
+    TIpAddress iInterface;
+    SocketUdpMulticast iSocket;
+    UdpBatchReader iReader;
+    SsdpHeaderHost iHeaderHost;
+    SsdpHeaderMan iHeaderMan;
+    SsdpHeaderMx iHeaderMx;
+    SsdpHeaderNt iHeaderNt;
+    SsdpHeaderNts iHeaderNts;
+    TUint iDnsChangeListenerId;
+    TBool iExiting;
+    TBool iRecreateSocket;
+};
+
+// SsdpListenerUnicast - sends out an msearch request and listens to the unicast responses
+//                     - processes received messages and passes them on an INotifyHandler
+class SsdpListenerUnicast : public SsdpListener, private IResumeObserver
+{
+    static const TUint kRecvBufBytes = 64 * 1024;
+public:
+    SsdpListenerUnicast(Environment& aEnv, ISsdpNotifyHandler& aNotifyHandler, const TIpAddress& aInterface);
+    ~SsdpListenerUnicast();
+    void MsearchRoot();
+    void MsearchUuid(const Brx& aUuid);
+    void MsearchDeviceType(const Brx& aDomain, const Brx& aType, TUint aVersion);
+    void MsearchServiceType(const Brx& aDomain, const Brx& aType, TUint aVersion);
+    void MsearchAll();
+private: // from IResumeObserver
+    void NotifyResumed();
+private:
+    TUint MsearchDurationSeconds() const;
+    void Run();
+    void Process(const Brx& aMessage);
+private:
+    Environment& iEnv;
+    ISsdpNotifyHandler& iNotifyHandler;
+    TIpAddress iInterface;
+    SocketUdp iSocket;
+    UdpWriter iSocketWriter;
+    UdpBatchReader iReader;
+    Sws<kMaxBufferBytes> iWriteBuffer;
+    SsdpWriterMsearchRequest iWriter;
+    Mutex iWriterLock;
+    SsdpHeaderExt iHeaderExt;
+    TBool iExiting;
+    TBool iRecreateSocket;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_SSDP_DISCOVERY
@@ -0,0 +1,451 @@
+#ifndef HEADER_DVI_SERVER_WEBSOCKET
+#define HEADER_DVI_SERVER_WEBSOCKET
+
+#include <OpenHome/Net/Private/DviServer.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Net/Private/Service.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Exception.h>
+#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Net/Private/DviSubscription.h>
+#include <OpenHome/Net/Private/DviService.h>
+
+#include <map>
+
+EXCEPTION(WebSocketError)
+
+struct z_stream_s;
+
+namespace OpenHome {
+namespace Net {
+
+class WebSocket
+{
+public:
+    static const Brn kHeaderProtocol;
+    static const Brn kHeaderOrigin;
+    static const Brn kHeaderResponseOrigin;
+    static const Brn kHeaderLocation;
+    static const Brn kHeaderKey;
+    static const Brn kHeaderVersion;
+    static const Brn kHeaderExtensions;
+    static const Brn kUpgradeWebSocket;
+    static const Brn kTagRoot;
+    static const Brn kTagMethod;
+    static const Brn kTagUdn;
+    static const Brn kTagService;
+    static const Brn kTagSid;
+    static const Brn kTagNt;
+    static const Brn kTagTimeout;
+    static const Brn kTagNts;
+    static const Brn kTagSubscription;
+    static const Brn kTagSeq;
+    static const Brn kTagClientId;
+    static const Brn kTagId;
+    static const Brn kTagAction;
+    static const Brn kTagArgs;
+    static const Brn kTagCode;
+    static const Brn kTagDescription;
+    static const Brn kMethodSubscribe;
+    static const Brn kMethodUnsubscribe;
+    static const Brn kMethodRenew;
+    static const Brn kMethodSubscriptionSid;
+    static const Brn kMethodSubscriptionRenewed;
+    static const Brn kMethodGetPropertyUpdates;
+    static const Brn kMethodPropertyUpdate;
+    static const Brn kMethodInvoke;
+    static const Brn kMethodInvokeCompleted;
+    static const Brn kMethodInvokeFailed;
+    static const Brn kValueProtocol;
+    static const Brn kValueNt;
+    static const Brn kValuePropChange;
+    static const Brn kValuePermessageDeflate;
+    static const Brn kParamServerNoContextTakeover;
+    static const Brn kParamClientNoContextTakeover;
+    static const Brn kParamServerMaxWindowBits;
+    static const Brn kParamClientMaxWindowBits;
+};
+
+class HttpHeaderUpgrade : public HttpHeader
+{
+public:
+    Brn Upgrade() const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brh iUpgrade;
+};
+
+class WsHeaderKey : public HttpHeader
+{
+public:
+    TUint Key() const;
+protected:
+    WsHeaderKey(const TChar* aHeader);
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brh iHeader;
+    Brh iKey;
+};
+
+class WsHeaderKey1 : public WsHeaderKey
+{
+public:
+    WsHeaderKey1();
+};
+
+class WsHeaderKey2 : public WsHeaderKey
+{
+public:
+    WsHeaderKey2();
+};
+
+class WsHeaderProtocol : public HttpHeader
+{
+public:
+    const Brx& Protocol() const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brh iProtocol;
+};
+
+class WsHeaderOrigin : public HttpHeader
+{
+public:
+    const Brx& Origin() const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brh iOrigin;
+};
+
+class WsHeaderKey80 : public HttpHeader
+{
+public:
+    const Brx& Key() const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brh iKey;
+};
+
+class WsHeaderVersion : public HttpHeader
+{
+public:
+    TUint Version() const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    TUint iVersion;;
+};
+
+/**
+ * Sec-WebSocket-Extensions request header.
+ * Selects the first permessage-deflate (RFC 7692) offer whose parameters we understand.
+ */
+class WsHeaderExtensions : public HttpHeader
+{
+public:
+    WsHeaderExtensions();
+    TBool PermessageDeflate() const;
+    TBool ServerNoContextTakeover() const;
+    TBool ClientNoContextTakeover() const;
+    TUint ServerMaxWindowBits() const; // 0 if not requested
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+    void Reset();
+    TBool ProcessOffer(const Brx& aOffer);
+private:
+    TBool iPermessageDeflate;
+    TBool iServerNoContextTakeover;
+    TBool iClientNoContextTakeover;
+    TUint iServerMaxWindowBits;
+};
+
+/**
+ * permessage-deflate compression state for a single WebSocket session.
+ * Only functional when built with zlib (DEFINE_ZLIB); Supported() reports this.
+ */
+class WsDeflate : private INonCopyable
+{
+public:
+    static const TUint kMaxWindowBits = 15;
+    static TBool Supported();
+    WsDeflate(Environment& aEnv, TUint aServerMaxWindowBits, TBool aServerContextTakeover, TBool aClientContextTakeover);
+    ~WsDeflate();
+    void Compress(const Brx& aData, Bwh& aCompressed);
+    TBool Decompress(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes); // false if corrupt or larger than aMaxBytes
+    TUint MessagesCompressed() const;
+    TUint MessagesDecompressed() const;
+    TUint64 BytesUncompressed() const;
+    TUint64 BytesCompressed() const;
+    TUint64 TimeUs() const;
+private:
+    TBool Inflate(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes);
+private:
+    Environment& iEnv;
+    TBool iServerContextTakeover;
+    TBool iClientContextTakeover;
+    z_stream_s* iDeflate;
+    z_stream_s* iInflate;
+    TUint iMessagesCompressed;
+    TUint iMessagesDecompressed;
+    TUint64 iBytesUncompressed;
+    TUint64 iBytesCompressed;
+    TUint64 iTimeUs;
+};
+
+class DviSessionWebSocket;
+
+class PropertyWriterWs : public PropertyWriter
+{
+public:
+    static PropertyWriterWs* Create(DviSessionWebSocket& aSession, const Brx& aSid, TUint aSequenceNumber);
+private:
+    PropertyWriterWs(DviSessionWebSocket& aSession);
+    void WriteHeaders(const Brx& aSid, TUint aSequenceNumber);
+private: // IPropertyWriter
+    ~PropertyWriterWs();
+    void PropertyWriteEnd();
+private:
+    static const TUint kWriteBufGranularity = 1024;
+    DviSessionWebSocket& iSession;
+    WriterBwh iWriter;
+};
+
+class WsProtocol : private INonCopyable
+{
+public:
+    virtual ~WsProtocol();
+    virtual void Read(Brn& aData, TBool& aClosed) = 0;
+    virtual void Write(const Brx& aData) = 0;
+    virtual void Close() = 0;
+protected:
+    WsProtocol(ReaderUntil& aReaderUntil, Swx& aWriteBuffer);
+protected:
+    ReaderUntil& iReaderUntil;
+    Swx& iWriteBuffer;
+};
+
+class WsProtocol76 : public WsProtocol
+{
+public:
+    WsProtocol76(ReaderUntil& aReaderUntil, Swx& aWriteBuffer);
+private:
+    void Read(Brn& aData, TBool& aClosed);
+    void Write(const Brx& aData);
+    void Close();
+private:
+    static const TByte kFrameMsgStart = (TByte)'\0';
+    static const TByte kMsgEnd = (TByte)'\xff';
+    static const TByte kFrameCloseStart = (TByte)'\xff';
+    static const TByte kMsgCloseEnd = (TByte)'\0';
+};
+
+class WsProtocol80 : public WsProtocol
+{
+    static const TUint kMaxMessageBytes = 64*1024;
+public:
+    WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer, WsDeflate* aDeflate);
+    /**
+     * Unmask (or mask) aBytes of client frame payload in place.
+     * aMaskOffset is the index into the 4 byte aMask of aData[0].
+     */
+    static void Unmask(TByte* aData, TUint aBytes, const TByte* aMask, TUint aMaskOffset);
+private:
+    void Read(Brn& aData, TBool& aClosed);
+    void Write(const Brx& aData);
+    void Close();
+private:
+    enum WsOpcode
+    {
+        eContinuation = 0x0
+       ,eText = 0x1
+       ,eBinary = 0x2
+       ,eClose = 0x8
+       ,ePing = 0x9
+       ,ePong = 0xA
+    };
+    static const TUint16 kCloseNormal          = 1000;
+    static const TUint16 kCloseProtocolError   = 1002;
+    static const TUint16 kCloseUnsupportedData = 1003;
+    static const TUint16 kCloseMsgTooLong      = 1004;
+private:
+    void Write(WsOpcode aOpcode, const Brx& aData, TBool aCompressed = false);
+    void Close(TUint16 aCode);
+private:
+    Bwh iMessage; // fragmented or large messages
+    WsDeflate* iDeflate; // not owned; NULL unless permessage-deflate was negotiated
+    TBool iMessageInProgress;
+    TBool iMessageCompressed;
+    Bwh iCompressed;
+    Bwh iDecompressed;
+};
+
+class DviService;
+class DviDevice;
+
+/**
+ * Serves one WebSocket client: event subscriptions plus action invocations.
+ *
+ * Invoke requests carry a client-chosen ID which is echoed in the matching
+ * InvokeCompleted/InvokeFailed response.  Requests are processed in the order
+ * they arrive so clients may pipeline several before reading any response.
+ */
+class DviSessionWebSocket : public SocketTcpSession, private IPropertyWriterFactory, private IDviInvocation
+{
+public:
+    DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterface, TUint aPort);
+    ~DviSessionWebSocket();
+    void QueuePropertyUpdate(Brh* aUpdate);
+private:
+    enum WsOpcode
+    {
+        eContinuation = 0x0
+       ,eText = 0x1
+       ,eBinary = 0x2
+       ,eClose = 0x8
+       ,ePing = 0x9
+       ,ePong = 0xA
+    };
+private:
+    void Run();
+    void Error(const HttpStatus& aStatus);
+    void Handshake();
+    WsProtocol* Handshake76();
+    WsProtocol* Handshake80();
+    void DoRead();
+    void Subscribe(const Brx& aRequest);
+    void Unsubscribe(const Brx& aRequest);
+    void Renew(const Brx& aRequest);
+    void Invoke(const Brx& aRequest);
+    void WriteInvokeFailed(TUint aCode, const Brx& aDescription);
+    void WriteSubscriptionSid(const Brx& aDevice, const Brx& aService, const Brx& aSid, TUint aSeconds);
+    void WriteSubscriptionRenewed(const Brx& aSid, TUint aSeconds);
+    void WritePropertyUpdates();
+    void LogDeflateStats();
+private: // IPropertyWriterFactory
+    IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData,
+                                 const Brx& aSid, TUint aSequenceNumber);
+    void ReleaseWriter(IPropertyWriter* aWriter);
+    IPropertyEncoder* PropertyEncoder();
+    void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded);
+    void NotifySubscriptionCreated(const Brx& aSid);
+    void NotifySubscriptionDeleted(const Brx& aSid);
+    void NotifySubscriptionExpired(const Brx& aSid);
+    void LogUserData(IWriter& aWriter, const IDviSubscriptionUserData& aUserData);
+private: // IDviInvocation
+    void Invoke();
+    TUint Version() const;
+    const TIpAddress& Adapter() const;
+    const char* ResourceUriPrefix() const;
+    Endpoint ClientEndpoint() const;
+    const Brx& ClientUserAgent() const;
+    void InvocationReadStart();
+    TBool InvocationReadBool(const TChar* aName);
+    void InvocationReadString(const TChar* aName, Brhz& aString);
+    TInt InvocationReadInt(const TChar* aName);
+    TUint InvocationReadUint(const TChar* aName);
+    void InvocationReadBinary(const TChar* aName, Brh& aData);
+    void InvocationReadEnd();
+    void InvocationReportError(TUint aCode, const Brx& aDescription);
+    void InvocationWriteStart();
+    void InvocationWriteBool(const TChar* aName, TBool aValue);
+    void InvocationWriteInt(const TChar* aName, TInt aValue);
+    void InvocationWriteUint(const TChar* aName, TUint aValue);
+    void InvocationWriteBinaryStart(const TChar* aName);
+    void InvocationWriteBinary(TByte aValue);
+    void InvocationWriteBinary(const Brx& aValue);
+    void InvocationWriteBinaryEnd(const TChar* aName);
+    void InvocationWriteStringStart(const TChar* aName);
+    void InvocationWriteString(TByte aValue);
+    void InvocationWriteString(const Brx& aValue);
+    void InvocationWriteStringEnd(const TChar* aName);
+    void InvocationWriteEnd();
+private:
+    class SubscriptionWrapper
+    {
+    public:
+        SubscriptionWrapper(DviSubscription& aSubscription, const Brx& aSid, DviService& aService);
+        ~SubscriptionWrapper();
+        DviSubscription& Subscription() { return iSubscription; }
+        const Brx& Sid() const { return iSid; }
+    private:
+        DviSubscription& iSubscription;
+        Brh iSid;
+        DviService& iService;
+    };
+public:
+    static const TUint kMaxRequestBytes = 4*1024;
+    static const TUint kMaxWriteBytes = 4*1024;
+    static const TUint kMaxPropertyUpdates = 20;
+    static const TUint kReadTimeoutMs = 5 * 1000;
+    static const TUint kInvocationWriteGranularity = 1024;
+private:
+    DvStack& iDvStack;
+    TIpAddress iAdapter;
+    Endpoint iEndpoint;
+    Srx* iReadBuffer;
+    ReaderUntil* iReaderUntil;
+    ReaderHttpRequest* iReaderRequest;
+    Sws<kMaxWriteBytes>* iWriterBuffer;
+    WriterHttpResponse* iWriterResponse;
+    HttpHeaderHost iHeaderHost;
+    HttpHeaderConnection iHeaderConnection;
+    HttpHeaderUpgrade iHeaderUpgrade;
+    WsHeaderKey1 iHeaderKey1;
+    WsHeaderKey2 iHeaderKey2;
+    WsHeaderProtocol iHeaderProtocol;
+    WsHeaderOrigin iHeaderOrigin;
+    WsHeaderKey80 iHeadverKeyV8;
+    WsHeaderVersion iHeaderVersion;
+    WsHeaderExtensions iHeaderExtensions;
+    HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderUserAgent iHeaderUserAgent;
+    const HttpStatus* iErrorStatus;
+    WsProtocol* iProtocol;
+    WsDeflate* iDeflate;
+    TBool iExit;
+    typedef std::map<Brn,SubscriptionWrapper*,BufferCmp> Map;
+    Map iMap;
+    Mutex iInterruptLock;
+    Semaphore iShutdownSem;
+    Fifo<Brh*> iPropertyUpdates; // used for web sockets
+    DviDevice* iInvocationDevice;
+    Brn iInvocationId;
+    Brn iInvocationAction;
+    Brn iInvocationArgs;
+    TUint iInvocationVersion;
+    TBool iInvocationResponseStarted;
+    WriterBwh iInvocationWriter;
+    mutable Bws<128> iResourceUriPrefix;
+};
+
+class DviServerWebSocket : public DviServer
+{
+public:
+    DviServerWebSocket(DvStack& aDvStack);
+    ~DviServerWebSocket();
+public: // from DviServer
+    void Start();
+protected:
+    virtual SocketTcpServer* CreateServer(const NetworkAdapter& aNif);
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_DVI_SERVER_WEBSOCKET
@@ -0,0 +1,312 @@
+#ifndef HEADER_DVISUBSCRIPTION
+#define HEADER_DVISUBSCRIPTION
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Exception.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Net/Private/Service.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <vector>
+#include <map>
+#include <list>
+#include <set>
+
+EXCEPTION(DvSubscriptionError)
+
+namespace OpenHome {
+namespace Net {
+
+class IDviSubscriptionUserData
+{
+public:
+    virtual ~IDviSubscriptionUserData() {}
+    virtual const void* Data() const = 0;
+    virtual void Release() = 0;
+};
+    
+/**
+ * Renders a single property in a protocol's wire format.
+ *
+ * Output must depend only on the property's name and value so that it can be
+ * shared between every subscriber whose writer uses the same encoder.
+ */
+class IPropertyEncoder
+{
+public:
+    virtual ~IPropertyEncoder() {}
+    virtual void Encode(Property& aProperty, IWriter& aWriter) = 0;
+};
+
+class IPropertyWriterFactory
+{
+public:
+    virtual ~IPropertyWriterFactory() {}
+    virtual IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData, 
+                                         const Brx& aSid, TUint aSequenceNumber) = 0;
+    virtual void ReleaseWriter(IPropertyWriter* aWriter) = 0;
+    /**
+     * Encoder for properties passed to writers from this factory.
+     * Returns NULL if writers only accept individual PropertyWrite* calls.
+     */
+    virtual IPropertyEncoder* PropertyEncoder() = 0;
+    /**
+     * Write properties already rendered by PropertyEncoder() to aWriter
+     * (which was returned by ClaimWriter).
+     */
+    virtual void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded) = 0;
+    virtual void NotifySubscriptionCreated(const Brx& aSid) = 0;
+    virtual void NotifySubscriptionDeleted(const Brx& aSid) = 0;
+    virtual void NotifySubscriptionExpired(const Brx& aSid) = 0;
+    virtual void LogUserData(IWriter& aWriter, const IDviSubscriptionUserData& aUserData) = 0;
+};
+
+/**
+ * Immutable rendering of a set of property values.
+ *
+ * Shared by every subscription to a service whose writers use the same
+ * IPropertyEncoder and need the same set of property changes.
+ */
+class EncodedPropertySet : private INonCopyable
+{
+    friend class EncodedPropertySetCache;
+public:
+    void AddRef();
+    void RemoveRef();
+    const Brx& Buffer() const;
+private:
+    EncodedPropertySet(IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers, WriterBwh& aEncoded);
+    ~EncodedPropertySet();
+    TBool Matches(const IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers) const;
+    TBool IsCurrent(const std::vector<Property*>& aProperties) const;
+private:
+    Mutex iLock;
+    TUint iRefCount;
+    IPropertyEncoder& iEncoder;
+    std::vector<TUint> iSequenceNumbers;
+    Brh iEncoded;
+};
+
+/**
+ * Per-service cache of EncodedPropertySets, keyed by encoder and by the vector
+ * of property sequence numbers being published (0 for properties left out).
+ *
+ * Claim() must be called with the service's properties lock held.
+ */
+class EncodedPropertySetCache : private INonCopyable
+{
+    static const TUint kMaxEntries = 8;
+    static const TUint kEncodeGranularity = 1024;
+public:
+    EncodedPropertySetCache();
+    ~EncodedPropertySetCache();
+    EncodedPropertySet* Claim(IPropertyEncoder& aEncoder, const std::vector<Property*>& aProperties,
+                              const std::vector<TUint>& aSequenceNumbers); // claims a ref for the caller
+private:
+    std::vector<EncodedPropertySet*> iEntries; // most recently added first
+};
+
+class DviDevice;
+class DviService;
+class DvStack;
+class DviSubscriptionManager;
+class IPublisherQueue;
+
+class DviSubscription : private IStackObject
+{
+    friend class DviSubscriptionManager;
+public:
+    DviSubscription(DvStack& aDvStack, DviDevice& aDevice, IPropertyWriterFactory& aWriterFactory,
+                    IDviSubscriptionUserData* aUserData, Brh& aSid);
+    void SetDuration(TUint& aDurationSecs);
+    void Start(DviService& aService);
+    void Stop(); // should only be called by DviService
+    void AddRef();
+    TBool TryAddRef();
+    void RemoveRef();
+    void Remove();
+    void Renew(TUint& aSeconds);
+    void WriteChanges();
+    const Brx& Sid() const;
+    DviService* Service(); // claims a ref for non-NULL return
+    DviService* ServiceLocked(); // claims a ref for non-NULL return
+    void Log(IWriter& aWriter);
+private: // from IStackObject
+    void ListObjectDetails() const;
+private:
+    virtual ~DviSubscription();
+    IPropertyWriter* CreateWriter();
+    void Expired();
+    void DoRenew(TUint& aSeconds);
+private:
+    DvStack& iDvStack;
+    mutable Mutex iLock;
+    Mutex iRefLock;
+    TUint iRefCount;
+    DviDevice& iDevice;
+    IPropertyWriterFactory& iWriterFactory;
+    IDviSubscriptionUserData* iUserData;
+    Brh iSid;
+    DviService* iService;
+    std::vector<TUint> iPropertySequenceNumbers;
+    std::vector<TUint> iChangedSequenceNumbers;
+    TUint iSequenceNumber;
+    Timer* iTimer;
+    TUint iPublisherFailures;
+    TUint iPublisherSuccesses;
+    IPublisherQueue* iPublisherQueue;
+    TBool iExpired;
+};
+
+class AutoSubscriptionRef : public INonCopyable
+{
+public:
+    AutoSubscriptionRef(DviSubscription& aSubscription);
+    ~AutoSubscriptionRef();
+private:
+    DviSubscription& iSubscription;
+};
+
+class PropertyWriter : public IPropertyWriter
+{
+public:
+    static void WriteVariable(IWriter& aWriter, const Brx& aName, const Brx& aValue);
+    static IPropertyEncoder& Encoder();
+    void WriteEncoded(const Brx& aEncoded);
+protected:
+    PropertyWriter();
+    void SetWriter(IWriter& aWriter);
+private:
+    inline void WriteVariable(const Brx& aName, const Brx& aValue);
+    inline void WriteVariableStart(const Brx& aName);
+    inline void WriteVariableEnd(const Brx& aName);
+    static void WriteVariableStart(IWriter& aWriter, const Brx& aName);
+    static void WriteVariableEnd(IWriter& aWriter, const Brx& aName);
+private: // IPropertyWriter
+    void PropertyWriteString(const Brx& aName, const Brx& aValue);
+    void PropertyWriteInt(const Brx& aName, TInt aValue);
+    void PropertyWriteUint(const Brx& aName, TUint aValue);
+    void PropertyWriteBool(const Brx& aName, TBool aValue);
+    void PropertyWriteBinary(const Brx& aName, const Brx& aValue);
+private:
+    IWriter* iWriter;
+};
+
+class IPublisherQueue
+{
+public:
+    virtual ~IPublisherQueue() {}
+    virtual void QueueUpdate(DviSubscription& aSubscription) = 0;
+};
+
+class IPublisherObserver
+{
+public:
+    virtual ~IPublisherObserver() {}
+    virtual void NotifyPublishSuccess(DviSubscription& aSubscription) = 0;
+    virtual void NotifyPublishError(DviSubscription& aSubscription) = 0;
+};
+
+class PublisherPool;
+
+class Publisher : public Thread
+{
+public:
+    Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, PublisherPool& aPool, TUint aModerationMs);
+    ~Publisher();
+private:
+    void Error(const TChar* aErr);
+    void Run();
+private:
+    IPublisherObserver& iObserver;
+    PublisherPool& iPool;
+    DviSubscription* iSubscription;
+    const TUint iModerationMs;
+    Semaphore iModerator;
+};
+
+/**
+ * Coalescing queue of subscriptions with unpublished changes.
+ *
+ * A subscription is queued at most once; further updates that arrive before a
+ * publisher has claimed it are folded into the pending entry.  Publishers pull
+ * work directly from the queue, draining as many entries as are available each
+ * time they are woken.
+ */
+class PublisherPool : public IPublisherQueue
+{
+    friend class Publisher;
+public:
+    PublisherPool(Environment& aEnv, TUint aPriority, IPublisherObserver& aObserver, TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs);
+    ~PublisherPool();
+    std::list<DviSubscription*> GetUpdates();
+    void LogStats(IWriter& aWriter);
+public: // from IPublisherQueue
+    void QueueUpdate(DviSubscription& aSubscription);
+private:
+    DviSubscription* Dequeue(Publisher& aPublisher, TUint64& aQueuedUs);
+    void PublishComplete(TUint64 aQueuedUs);
+private:
+    class PendingUpdate
+    {
+    public:
+        PendingUpdate(DviSubscription* aSubscription, TUint64 aQueuedUs);
+    public:
+        DviSubscription* iSubscription;
+        TUint64 iQueuedUs;
+    };
+private:
+    Environment& iEnv;
+    TUint iPoolNumber;
+    TUint iNumPublishers;
+    Mutex iLock;
+    std::list<PendingUpdate> iPendingUpdates;
+    std::set<DviSubscription*> iQueued;
+    std::vector<Publisher*> iIdle;
+    Publisher** iPublishers;
+    TUint iUpdatesRequested;
+    TUint iUpdatesCoalesced;
+    TUint iMaxDepth;
+    TUint iPublished;
+    TUint64 iTotalLatencyUs;
+    TUint64 iMaxLatencyUs;
+};
+
+class DviSubscriptionManager : private IPublisherObserver
+                             , private IInfoProvider
+{
+    static const Brn kQuerySubscriptions;
+    static const TUint kMaxFailures = 3;
+    static const TUint kPublisherSuccessThreshold = 5;
+public:
+    DviSubscriptionManager(DvStack& aDvStack, TUint aPriority);
+    ~DviSubscriptionManager();
+    void AddSubscription(DviSubscription& aSubscription);
+    void RemoveSubscription(DviSubscription& aSubscription);
+    DviSubscription* Find(const Brx& aSid);
+    void QueueUpdate(DviSubscription& aSubscription);
+private: // from IPublisherObserver
+    void NotifyPublishSuccess(DviSubscription& aSubscription);
+    void NotifyPublishError(DviSubscription& aSubscription);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    DvStack& iDvStack;
+    Mutex iLock;
+    typedef std::map<Brn,DviSubscription*,BufferCmp> Map;
+    std::list<DviSubscription*> iAllPendingUpdates;
+    Map iMap;
+    TUint iCount;
+    PublisherPool* iPublishersQuick;
+    PublisherPool* iPublishersSlow;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_DVISUBSCRIPTION
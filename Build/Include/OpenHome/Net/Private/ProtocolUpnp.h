@@ -0,0 +1,253 @@
+/**
+ * Invocation of a UPnP request on a particular device
+ */
+
+#ifndef HEADER_PROTOCOL_UPNP
+#define HEADER_PROTOCOL_UPNP
+
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Net/Private/CpiService.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Net/Private/XmlParser.h>
+
+#include <list>
+#include <vector>
+
+namespace OpenHome {
+namespace Net {
+
+class CpStack;
+class CpiSubscription;
+
+/**
+ * Connection to a device's control server, which may be reused for several invocations
+ */
+class InvocationConnectionUpnp : private INonCopyable
+{
+public:
+    InvocationConnectionUpnp(Environment& aEnv, const Endpoint& aEndpoint);
+    ~InvocationConnectionUpnp();
+    const OpenHome::Endpoint& Endpoint() const;
+    TBool IsConnected() const;
+    void Connect(TUint aTimeoutMs);
+    void Close();
+    SocketTcpClient& Socket();
+    ReaderUntil& Reader();
+    ReaderHttpResponse& ReaderResponse();
+    const HttpHeaderContentLength& HeaderContentLength() const;
+    const HttpHeaderTransferEncoding& HeaderTransferEncoding() const;
+    /**
+     * Returns true if the response just read allows another request on this connection.
+     * Only valid once the response's entity has been read.
+     */
+    TBool ResponseAllowsReuse() const;
+    void SetIdleSince(TUint aTime);
+    TUint IdleSince() const;
+private:
+    Environment& iEnv;
+    OpenHome::Endpoint iEndpoint;
+    SocketTcpClient iSocket;
+    Srs<1024> iReadBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    ReaderHttpResponse iReaderResponse;
+    HttpHeaderConnection iHeaderConnection;
+    HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    TBool iConnected;
+    TUint iIdleSince;
+};
+
+/**
+ * Idle invocation connections for a single device
+ *
+ * Unless fixed limits are passed to the constructor, limits are read from
+ * InitialisationParams::GetCpInvocationKeepAlive() on each use so reuse can be
+ * enabled or disabled at any time.
+ */
+class InvocationConnectionCache : private INonCopyable
+{
+public:
+    InvocationConnectionCache(Environment& aEnv);
+    InvocationConnectionCache(Environment& aEnv, TUint aMaxIdle, TUint aIdleTimeoutMs);
+    ~InvocationConnectionCache();
+    TBool Enabled() const;
+    InvocationConnectionUpnp* Claim(const Endpoint& aEndpoint); // never returns NULL
+    void Release(InvocationConnectionUpnp* aConnection, TBool aReusable);
+private:
+    void GetLimits(TUint& aMaxIdle, TUint& aIdleTimeoutMs) const;
+    void TimerExpired();
+    static void Delete(std::vector<InvocationConnectionUpnp*>& aConnections);
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    const TBool iFixedLimits;
+    const TUint iMaxIdle;
+    const TUint iIdleTimeoutMs;
+    std::list<InvocationConnectionUpnp*> iIdle; // most recently used first
+    Timer* iTimer;
+    TBool iTimerActive;
+};
+
+class InvocationUpnp : private IInterruptHandler, private IInvocationContinuation
+{
+public:
+    /**
+     * aConnectionCache is NULL if connections should not be reused
+     */
+    InvocationUpnp(CpStack& aCpStack, Invocation& aInvocation, InvocationConnectionCache* aConnectionCache = NULL);
+    ~InvocationUpnp();
+    /**
+     * Send the request then suspend aInvocation until the device responds.
+     * If aInvocation.Suspended() is true on return, it owns this object.
+     */
+    void Invoke(const Uri& aUri);
+    static void WriteServiceType(IWriterAscii& aWriter, const Invocation& aInvocation);
+private:
+    void SendRequest();
+    void Reconnect();
+    void Connect();
+    void WriteRequest(const Uri& aUri);
+    void ReadResponse();
+    void WriteHeaders(WriterHttpRequest& aWriterRequest, const Uri& aUri, TUint aBodyBytes, Environment& aEnv);
+    // IInterruptHandler
+    void Interrupt();
+    // IInvocationContinuation
+    void Continue(TBool aTimedOut);
+private:
+    static const TUint kMaxReadBytes = 16 * 1024;
+    CpStack& iCpStack;
+    Invocation& iInvocation;
+    InvocationConnectionCache* iConnectionCache;
+    InvocationConnectionUpnp* iConnection;
+    Uri iUri;
+    TBool iReused;
+    TUint iStartTime;
+    TBool iReusable;
+    TBool iInterrupted;
+};
+
+/**
+ * Write the body (entity) of a http invocation request
+ *
+ * Intended for internal use only
+ */
+class InvocationBodyWriter : public IInputArgumentProcessor
+{
+public:
+    static void Write(const Invocation& aInvocation, Bwh& aBody);
+private:
+    InvocationBodyWriter();
+    void Write(const Invocation& aInvocation);
+    // IInputArgumentProcessor
+    void ProcessString(const Brx& aVal);
+    void ProcessInt(TInt aVal);
+    void ProcessUint(TUint aVal);
+    void ProcessBool(TBool aVal);
+    void ProcessBinary(const Brx& aVal);
+private:
+    static const TInt kBufferGranularity = 4096;
+    WriterBwh iBody;
+    Sws<kBufferGranularity> iWriteBuffer;
+    WriterAscii iWriterAscii;
+};
+
+/**
+ * Read output arguments from the body (entity) of a successful http invocation response
+ *
+ * Scans the response once, regardless of the number of output arguments.
+ * Intended for internal use only
+ */
+class InvocationResponseReader : private IXmlChildHandler, private INonCopyable
+{
+public:
+    static void Read(Invocation& aInvocation, const Brx& aEntity);
+private:
+    InvocationResponseReader(const Invocation::VectorArguments& aArgs);
+    // IXmlChildHandler
+    void ProcessChild(const Brx& aName, const Brx& aValue);
+private:
+    const Invocation::VectorArguments& iArgs;
+    std::vector<Brn> iValues;
+    std::vector<TBool> iFound;
+    TUint iNext;    // index of the argument expected next
+};
+
+class EventUpnp : private IInterruptHandler, private INonCopyable
+{
+public:
+    EventUpnp(CpStack& aCpStack, CpiSubscription& aSubscription);
+    ~EventUpnp();
+    void Subscribe(const Uri& aPublisher, const Uri& aSubscriber, TUint& aDurationSecs);
+    /**
+     * Renew using a connection from aConnectionCache, returning it to the cache afterwards
+     * if the device allows another request on it.
+     */
+    void RenewSubscription(const Uri& aPublisher, TUint& aDurationSecs, InvocationConnectionCache& aConnectionCache);
+    void Unsubscribe(const Uri& aPublisher, const Brx& aSid);
+private:
+    void Interrupt();
+private:
+    void SubscribeWriteRequest(const Uri& aPublisher, const Uri& aSubscriber, TUint aDurationSecs);
+    TBool SubscribeReadResponse(ReaderUntil& aReader, Brh& aSid, TUint& aDurationSecs);
+    void RenewSubscriptionWriteRequest(IWriter& aWriter, const Uri& aPublisher, TUint aDurationSecs);
+    void UnsubscribeWriteRequest(const Uri& aPublisher, const Brx& aSid);
+    void UnsubscribeReadResponse();
+    static void WriteHeaderSid(WriterHttpRequest& aWriterRequest, const Brx& aSid);
+    static void WriteHeaderTimeout(WriterHttpRequest& aWriterRequest, TUint aSeconds);
+private:
+    static const TUint kSubscribeTimeoutMs   = 60 * 1000;
+    static const TUint kUnsubscribeTimeoutMs =  5 * 1000;
+private:
+    CpStack& iCpStack;
+    CpiSubscription& iSubscription;
+    OpenHome::SocketTcpClient iSocket;
+    Srs<1024> iReadBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    InvocationConnectionUpnp* iConnection; // only set while renewing on a cached connection
+    TBool iInterrupted;
+};
+
+class OutputProcessorUpnp : public IOutputProcessor
+{
+public:
+    void ProcessString(const Brx& aBuffer, Brhz& aVal);
+    void ProcessInt(const Brx& aBuffer, TInt& aVal);
+    void ProcessUint(const Brx& aBuffer, TUint& aVal);
+    void ProcessBool(const Brx& aBuffer, TBool& aVal);
+    void ProcessBinary(const Brx& aBuffer, Brh& aVal);
+};
+
+class HeaderNts : public HttpHeader
+{
+public:
+    const Brx& Value() const;
+private:
+    virtual TBool Recognise(const Brx& aHeader);
+    virtual void Process(const Brx& aValue);
+private:
+    Brh iValue;
+};
+
+class HeaderSeq : public HttpHeader
+{
+public:
+    TUint Seq() const;
+private:
+    virtual TBool Recognise(const Brx& aHeader);
+    virtual void Process(const Brx& aValue);
+private:
+    TUint iSeq;
+};
+
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_PROTOCOL_UPNP
@@ -0,0 +1,459 @@
+#ifndef HEADER_NETWORK
+#define HEADER_NETWORK
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Exception.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/OsTypes.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/TIpAddressUtils.h>
+
+#include <vector>
+#include <list>
+#include <map>
+
+EXCEPTION(NetworkError)
+EXCEPTION(NetworkAddressInUse)
+EXCEPTION(NetworkTimeout)
+
+#ifdef DEFINE_BIG_ENDIAN
+# define MakeIpAddress(aByte1, aByte2, aByte3, aByte4) \
+        (aByte4 | (aByte3<<8) | (aByte2<<16) | (aByte1<<24))
+#elif defined(DEFINE_LITTLE_ENDIAN)
+# define MakeIpAddress(aByte1, aByte2, aByte3, aByte4) \
+        (aByte1 | (aByte2<<8) | (aByte3<<16) | (aByte4<<24))
+#else
+# error "Endianness must be defined."
+#endif
+
+namespace OpenHome {
+
+enum ESocketType
+{
+    eSocketTypeStream = 1,              /// Tcp stream
+    eSocketTypeDatagram = 2,            /// Udp
+};
+
+enum ESocketFamily
+{
+    eSocketFamilyV4 = 1,
+    eSocketFamilyV6 = 2,
+};
+
+// Addressing
+
+// The Endpoint class has been designed with a restricted interface in order to facilitate
+// the move to different addressing schemes in the future (IPv6)
+
+class Endpoint
+{
+public:
+    static const TUint kMaxAddressBytes = TIpAddressUtils::kMaxAddressBytes; // Potentially 32 Hex characters + 7 colon de-limiters + terminator for IPv6 addr
+    static const TUint kMaxEndpointBytes = 48;                               // As above with de-limiter before port of 5 characters and '[]' enclosing the address
+    typedef Bws<TIpAddressUtils::kMaxAddressBytes> AddressBuf;
+    typedef Bws<kMaxEndpointBytes> EndpointBuf;
+public:
+    Endpoint();
+    Endpoint(TUint aPort, const Brx& aAddress);          // specify port, specify ip address from string e.g. "192.168.0.1"
+    Endpoint(TUint aPort, TIpAddress aAddress);          // specify port, specify ip address from uint
+    void SetPort(TUint aPort);                           // set port
+    void SetPort(const Endpoint& aEndpoint);             // set port from other endpoint
+    void SetAddress(const Brx& aAddress);                // set address from string e.g. "192.168.0.1"
+    void SetAddress(TIpAddress aAddress);
+    void SetAddress(const Endpoint& aEndpoint);          // set address from other endpoint
+    void Replace(const Endpoint& aEndpoint);             // set endpoint from other endpoint
+    TBool Equals(const Endpoint& aEndpoint) const;       // test if this endpoint is equal to the specified endpoint
+    inline TBool operator==(const Endpoint& aEndpoint) const { return Equals(aEndpoint); }
+    TIpAddress Address() const;
+    TUint16 Port() const;                                // return port as a network order uint16
+    void AppendAddress(Bwx& aAddress) const;
+    void AppendEndpoint(Bwx& aEndpoint) const;
+    void GetAddressOctets(TByte (&aOctets)[4]) const;    // return individual octets for an IPv4 address
+    void GetAddressFields(TUint (&aFields)[8]) const;    // return individual fields for an IPv6 address
+    void Externalise(IWriter& aWriter);
+    void Internalise(IReader& aReader);
+    void InternaliseIPv6(IReader& aReader);
+    static void AppendAddress(Bwx& aAddressBuffer, const TIpAddress& aAddress);
+private:
+    TIpAddress iAddress;
+    TUint16 iPort;
+};
+
+class Socket : public INonCopyable
+{
+public:
+    /**
+     * Close the socket, freeing any associated memory.
+     * Can only be called after any other calls to this socket from other
+     * threads have returned.
+     */
+    void Close();
+    void CloseThrows();
+    void Interrupt(TBool aInterrupt);
+    void SetSendBufBytes(TUint aBytes);
+    void SetRecvBufBytes(TUint aBytes);
+    void SetRecvTimeout(TUint aMs);
+    void LogVerbose(TBool aLog, TBool aHex = false);
+    /**
+     * Watch for this socket becoming readable using a poller from Os::NetworkPollerCreate().
+     * Polling is one-shot; call AddToPoller() again to re-arm.
+     * Returns false if the socket couldn't be added.
+     */
+    TBool AddToPoller(THandle aPoller, TUint aId);
+    void RemoveFromPoller(THandle aPoller);
+protected:
+    Socket();
+    virtual ~Socket() {}
+    void Create(Environment& aEnv, ESocketType aSocketType, ESocketFamily aSocketFamily);
+    void Send(const Brx& aBuffer);
+    void SendTo(const Brx& aBuffer, const Endpoint& aEndpoint);
+    void SendToMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint);
+    void Receive(Bwx& aBuffer);
+    void Receive(Bwx& aBuffer, TUint aBytes);
+    void ReceiveFrom(Bwx& aBuffer, Endpoint& aEndpoint);
+    TUint ReceiveFromMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts);
+    void Bind(const Endpoint& aEndpoint);
+    void GetPort(TUint& aPort);
+    void Listen(TUint aSlots);
+    THandle Accept(Endpoint& aClientEndpoint);
+    TBool IsInterrupted() const;
+private:
+    void Log(const char* aPrefix, const Brx& aBuffer) const;
+protected:
+    THandle iHandle;
+private:
+    static const uint32_t kLogNone      = 0;
+    static const uint32_t kLogPlainText = 1;
+    static const uint32_t kLogHex       = 2;
+    static const uint32_t kLogMask      = 3;
+    static const uint32_t kInterrupted  = 1 << 30;
+    uint32_t iFlags;
+    mutable Mutex iLock;
+};
+
+/**
+ * Utility class.
+ *
+ * Create an AutoSocket on the stack using a reference to an opened Socket.
+ * It will automatically be closed on stack cleanup (ie on return or when
+ * an exception passes up).
+ */
+class AutoSocket : public INonCopyable
+{
+public:
+    AutoSocket(Socket& aSocket);
+    ~AutoSocket();
+private:
+    Socket& iSocket;
+};
+
+/**
+* Utility class.
+*
+* Calls ReadFlush() on its IReader and Close() on its Socket on destruction.
+*/
+class AutoSocketReader : public AutoSocket
+{
+public:
+    AutoSocketReader(Socket& aSocket, IReader& aReader);
+    ~AutoSocketReader();
+private:
+    IReader& iReader;
+};
+
+/// Shared Tcp client / Tcp session base class
+class SocketTcp : public Socket, public IWriter, public IReaderSource
+{
+public:
+    /**
+     * Block until aBytes bytes are received, replace buffer
+     * Throw NetworkError on network error
+     * Throw NetworkError on remote socket close - returns with aBuffer.Bytes() < aBytes
+     */
+    void Receive(Bwx& aBuffer, TUint aBytes);
+
+    // IWriter
+    /**
+     * Send the buffer, block until all bytes are sent
+     * Throw NetworkError on network error
+     */
+    void Write(TByte aValue);
+    void Write(const Brx& aBuffer);
+    void WriteFlush();
+
+    // IReaderSource
+    /**
+     * Receive between [0, aBuffer.MaxBytes()] bytes, replace buffer
+     * Throw NetworkError on network error
+     * On return, aBuffer.Bytes() == 0 means remote socket closed
+     */
+    void Read(Bwx& aBuffer);
+    void Read(Bwx& aBuffer, TUint aBytes);
+    void ReadFlush();
+    void ReadInterrupt();
+protected:
+    SocketTcp();
+};
+
+class Environment;
+
+/// Tcp client
+
+class SocketTcpClient : public SocketTcp
+{
+public:
+    void Open(Environment& aEnv);
+    void Connect(const Endpoint& aEndpoint, TUint aTimeoutMs);
+};
+
+/// Tcp Session
+
+class SocketTcpServer;
+
+class SocketTcpSession : public SocketTcp /// Derive from this class to instantiate tcp server behaviour
+{
+    friend class SocketTcpServer;
+protected:
+    SocketTcpSession();
+    virtual void Run() = 0;
+    virtual ~SocketTcpSession();
+    Endpoint ClientEndpoint() const;
+    /**
+     * Hand an idle connection back to the server, which will pass it to the next free session
+     * once more data arrives.  Only valid from Run(), when no data has been read but not consumed.
+     * Returns false if the server doesn't support parking; otherwise Run() must return without
+     * further use of the socket.
+     * aState is kept with the connection and passed to whichever session resumes it.
+     */
+    TBool Park(TUint aState = 0);
+    TBool Resumed() const;  /// true if the current connection was previously Park()ed
+    TUint ResumedState() const; /// aState passed to Park() for a resumed connection, 0 for a new one
+private:
+    void Add(SocketTcpServer& aServer, const TChar* aName, TUint aPriority, TUint aStackBytes);
+    void Start();
+    void Open(THandle aHandle);
+    void Close();
+    void Terminate();   /// Called by owning TcpServer *before* invoking dtor. Waits for TcpSession::Run() to exit.
+private:
+    Mutex iMutex;
+    TBool iOpen;
+    SocketTcpServer* iServer;
+    ThreadFunctor* iThread;
+    Endpoint iClientEndpoint;
+    TBool iResumed;
+    TUint iResumedState;
+};
+
+// Tcp Server
+
+class SocketTcpServer : public Socket
+{
+    friend class SocketTcpSession;
+public:
+    SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aPort, const TIpAddress& aInterface,
+                    TUint aSessionPriority = kPriorityHigh, TUint aSessionStackBytes = Thread::kDefaultStackBytes,
+                    TUint aSlots = 128);
+    // Add is not thread safe, but why would you want that?
+    void Add(const TChar* aName, SocketTcpSession* aSession, TInt aPriorityOffset = 0);
+    /**
+     * Allow sessions to Park() idle connections.  Parked connections are watched by whichever
+     * session thread is accepting, so don't need a thread each.  Must be called before Add().
+     * Returns false (leaving parking disabled) if the platform can't poll many sockets.
+     *
+     * @param[in] aMaxParked       Maximum number of parked connections.  The oldest is closed
+     *                             to make room for another.
+     * @param[in] aIdleTimeoutMs   Parked connections are closed after being idle for
+     *                             between this and twice this time.
+     */
+    TBool EnableParking(TUint aMaxParked, TUint aIdleTimeoutMs);
+    TUint Port() const { return iPort; }
+    const TIpAddress& Interface() const { return iInterface; }
+    ~SocketTcpServer(); // Closes the server
+private:
+    TBool Terminating();            // indicates server is in process of being destroyed
+    THandle Accept(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState); // accept a connection and return the session handle
+    THandle Poll(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState);
+    TBool Park(THandle aHandle, const Endpoint& aClientEndpoint, TUint aState);
+    void CloseParkedLocked(THandle aHandle);
+private:
+    class ParkedConnection
+    {
+    public:
+        ParkedConnection(TUint aId, THandle aHandle, const Endpoint& aClientEndpoint, TUint aState, TUint aExpiryMs);
+    public:
+        TUint iId;
+        THandle iHandle;
+        Endpoint iClientEndpoint;
+        TUint iState;
+        TUint iExpiryMs;
+    };
+    typedef std::list<ParkedConnection> ParkedList;
+    static const TUint kPollIdListener = 0;
+    static const TUint kMaxPollIds = 32;
+private:
+    Environment& iEnv;
+    Mutex iMutex;                   // allows one thread to accept at a time
+    TUint iSessionPriority;         // priority given to all session threads
+    TUint iSessionStackBytes;       // stack bytes given to all session threads
+    TBool iTerminating;
+    std::vector<SocketTcpSession*> iSessions;
+    TUint iPort;
+    TIpAddress iInterface;
+    Mutex iLockParked;
+    THandle iPoller;                // kHandleNull unless parking is enabled
+    TUint iMaxParked;
+    TUint iIdleTimeoutMs;
+    TUint iNextParkId;
+    ParkedList iParked;             // oldest first
+    std::map<TUint, ParkedList::iterator> iParkedById;
+    ParkedList iResumable;          // parked connections with data to read
+};
+
+// general udp socket;
+
+class SocketUdpBase : public Socket
+{
+public:
+    void SetTtl(TUint aTtl);
+    void Send(const Brx& aBuffer, const Endpoint& aEndpoint);
+    void SendMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint);
+    Endpoint Receive(Bwx& aBuffer);
+    TUint ReceiveMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts);
+    TUint Port() const;
+    ~SocketUdpBase();
+    void ReCreate();
+protected:
+    SocketUdpBase(Environment& aEnv, ESocketFamily aSocketFamily);
+private:
+    void Create(ESocketFamily aSocketFamily);
+protected:
+    Environment& iEnv;
+    ESocketFamily iSocketFamily;
+    TUint iPort;
+};
+
+class SocketUdp : public SocketUdpBase
+{
+public:
+    SocketUdp(Environment& aEnv); // lets the os select a port
+    SocketUdp(Environment& aEnv, TUint aPort); // stipulate a port
+    SocketUdp(Environment& aEnv, TUint aPort, ESocketFamily aSocketFamily);
+    SocketUdp(Environment& aEnv, TUint aPort, const TIpAddress& aInterface); // stipulate a port and an interface
+    void ReBind(TUint aPort, const TIpAddress& aInterface);
+    void SetMulticastIf(const TIpAddress& aInterface);
+private:
+    void Bind(TUint aPort, const TIpAddress& aInterface);
+};
+
+// multicast receiver
+class SocketUdpMulticast : public SocketUdpBase
+{
+public:
+    SocketUdpMulticast(Environment& aEnv, const TIpAddress& aInterface, const Endpoint& aEndpoint);
+    ~SocketUdpMulticast();
+    void ReCreate();
+private:
+    TIpAddress iInterface;
+    TIpAddress iAddress;
+};
+
+/**
+ * Utility class which enforces the Read() - ReadFlush() useage pattern
+ * This class may be useful to subclasses of SocketUdpClient or
+ * SocketUdpMulticast but its use is entirely optional
+ */
+class UdpReader : public IReaderSource, public INonCopyable
+{
+public:
+    UdpReader();
+    UdpReader(SocketUdpBase& aSocket);
+    void SetSocket(SocketUdpBase& aSocket);
+    void ClearSocket();
+    Endpoint Sender() const; // sender of last completed Read()
+public: // from IReaderSource
+    void Read(Bwx& aBuffer);
+    void ReadFlush();
+    void ReadInterrupt();
+protected:
+    SocketUdpBase* iSocket;
+private:
+    Endpoint iSender;
+    TBool iOpen;
+};
+
+/**
+ * Utility class which receives datagrams a batch at a time into a ring of fixed size
+ * slots then returns each in turn without copying it
+ */
+class UdpBatchReader : public INonCopyable
+{
+public:
+    UdpBatchReader(SocketUdpBase& aSocket, TUint aSlots, TUint aSlotBytes);
+    /**
+     * Return the next datagram, blocking until one arrives if none are buffered.
+     * The returned buffer is valid until the following call to Read() or Discard().
+     * Throws ReaderError if the socket is interrupted or fails.
+     */
+    Brn Read();
+    Endpoint Sender() const; // sender of datagram last returned by Read()
+    void Discard();          // drop any buffered datagrams
+    void ReadInterrupt();
+    TUint Receives() const;  // number of batches read from the socket
+private:
+    SocketUdpBase& iSocket;
+    Bwh iBuffer;
+    const TUint iSlots;
+    const TUint iSlotBytes;
+    std::vector<TUint32> iBytes;
+    std::vector<TIpAddress> iAddresses;
+    std::vector<TUint16> iPorts;
+    TUint iCount; // datagrams in the current batch
+    TUint iNext;  // index of next datagram to return
+    Endpoint iSender;
+    TUint iReceives;
+};
+
+/**
+ * Utility class which enforces the Write() - WriteFlush() useage pattern
+ * This class may be useful to subclasses of SocketUdp or SocketUdpMulticast
+ */
+class UdpWriter : public IWriter, public INonCopyable
+{
+public:
+    UdpWriter(SocketUdpBase& aSocket, const Endpoint& aEndpoint);
+    virtual void Write(TByte aValue);
+    virtual void Write(const Brx& aBuffer);
+    virtual void WriteFlush();
+private:
+    SocketUdpBase& iSocket;
+    Endpoint iEndpoint;
+    TBool iOpen;
+};
+
+/**
+ * Utility class which collects a series of datagrams, each terminated by WriteFlush(),
+ * into a single buffer so that they can later be sent to one endpoint together
+ */
+class UdpBatchWriter : public IWriter, public INonCopyable
+{
+public:
+    UdpBatchWriter(TUint aMaxDatagrams, TUint aMaxDatagramBytes);
+    TUint Count() const;
+    void Clear();
+    void Send(SocketUdpBase& aSocket, const Endpoint& aEndpoint);
+public: // from IWriter
+    void Write(TByte aValue);
+    void Write(const Brx& aBuffer);
+    void WriteFlush();
+private:
+    Bwh iBuffer;
+    std::vector<TUint32> iBytes; // size of each completed datagram
+    TUint iPendingBytes;         // size of the datagram currently being written
+    TUint iMaxDatagrams;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_NETWORK
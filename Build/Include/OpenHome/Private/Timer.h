@@ -0,0 +1,150 @@
+#ifndef HEADER_TIMER
+#define HEADER_TIMER
+
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Functor.h>
+
+#include <vector>
+
+namespace OpenHome {
+
+class Environment;
+
+class Time
+{
+public:
+    static TUint Now(Environment& aEnv);
+    static TBool IsBeforeOrAt(TUint aQuestionableTime, TUint aTime);
+    static TBool IsAfter(TUint aQuestionableTime, TUint aTime);
+    static TBool IsInPastOrNow(Environment& aEnv, TUint aTime);
+    static TBool IsInFuture(Environment& aEnv, TUint aTime);
+    static TInt TimeToWaitFor(Environment& aEnv, TUint aTime);
+};
+
+class TimerManager;
+
+class ITimer
+{
+public:
+    virtual ~ITimer() {}
+    virtual void FireIn(TUint aMs) = 0;
+    virtual void Cancel() = 0;
+};
+
+class ITimerFactory
+{
+public:
+    virtual ~ITimerFactory() {}
+    virtual ITimer* CreateTimer(Functor aCallback, const TChar* aId) = 0;
+};
+
+class TimerFactory : public ITimerFactory, private OpenHome::INonCopyable
+{
+public:
+    TimerFactory(Environment& aEnv);
+public: // from ITimerFactory
+    ITimer* CreateTimer(Functor aCallback, const TChar* aId);
+private:
+    Environment& iEnv;
+};
+
+class Timer : public ITimer, private INonCopyable
+{
+    friend class TimerManager;
+public:
+    Timer(Environment& aEnv, Functor aFunctor, const TChar* aId);
+    void FireIn(TUint aTime); // Relative (milliseconds from now)
+    void FireAt(TUint aTime); // Absolute (at specified millisecond)
+    void Cancel();
+    const TChar* Id() const;
+    ~Timer();
+    static TBool IsInManagerThread(Environment& aEnv);
+private:
+    static TBool IsInManagerThread(TimerManager& aMgr);
+private:
+    TimerManager& iMgr;
+    Functor iFunctor;
+    const TChar* iId;
+    TUint iTime;        // Absolute (milliseconds from startup)
+    TUint iSequence;    // Orders timers due at the same time by when they were set
+    TUint iHeapIndex;   // Position in TimerManager's heap; kNotQueued if not pending
+};
+
+/*
+ * Pending timers are held in an indexed binary min-heap ordered on expiry time.
+ * Each Timer records its own position in the heap so FireAt and Cancel are
+ * O(log n) regardless of the number of live timers.
+ */
+class TimerManager : private INonCopyable
+{
+    friend class Timer;
+public:
+    TimerManager(Environment& aEnv, TUint aThreadPriority);
+    void Stop();
+    ~TimerManager();
+    void CallbackLock();
+    void CallbackUnlock();
+private:
+    class Callback
+    {
+    public:
+        Callback();
+        void Set(void* aPtr, const TChar* aId);
+        void Log() const;
+    private:
+        void* iPtr;
+        const TChar* iId;
+    };
+    class CallbackList
+    {
+        static const TUint kElements = 100;
+    public:
+        CallbackList();
+        void Add(Timer& aTimer);
+        void Log() const;
+    private:
+        static void IncIndex(TUint& aIndex);
+        static void DecIndex(TUint& aIndex);
+    private:
+        Callback iList[kElements];
+        TUint iHead;
+        TUint iTail;
+    };
+private:
+    void Run();
+    void Fire();
+    void FireAt(Timer& aTimer, TUint aTime);
+    void Remove(Timer& aTimer);
+    Thread* MgrThread() const;
+    // heap helpers; all require iMutex to be held
+    void HeapRemove(TUint aIndex);
+    void HeapSiftUp(TUint aIndex);
+    void HeapSiftDown(TUint aIndex);
+    void HeapSet(TUint aIndex, Timer* aTimer);
+    static TBool IsEarlier(const Timer& aTimer1, const Timer& aTimer2);
+private:
+    static const TUint kNotQueued = 0xffffffff;
+    Environment& iEnv;
+    ThreadFunctor* iThread;
+    Semaphore iSemaphore;
+    Mutex iMutex;
+    std::vector<Timer*> iHeap;
+    TUint iNextSequence;
+    TBool iStop;
+    Semaphore iStopped;
+    Mutex iCallbackMutex;
+    Thread* iThreadHandle;
+    static const TUint kMaxBusyTimeMs = 1000 * 60 * 30; // 30 minutes
+    static const TUint kMaxTimerGranularityMs = 10;
+    static const TUint kMaxCallbacksPerTick = 1000;
+    TUint iBusyStartTimeMs;
+    TUint iLastRunTimeMs;
+    TUint iCallbacksPerTick;
+    CallbackList iCallbackList;
+};
+
+} // namespace OpenHome
+
+#endif // HEADER_TIMER
@@ -33,6 +33,7 @@ objects_core = \
 	$(objdir)CpDeviceDvCore.$(objext) \
 	$(objdir)CpDeviceDvStd.$(objext) \
 	$(objdir)CpDeviceDvC.$(objext) \
+	$(objdir)CpExecutorStd.$(objext) \
 	$(objdir)CpDeviceUpnpCore.$(objext) \
 	$(objdir)CpDeviceUpnpC.$(objext) \
 	$(objdir)CpDeviceUpnpStd.$(objext) \
@@ -216,6 +217,7 @@ headers = \
 	$(inc_build)/OpenHome/Net/Cpp/CpDevice.h \
 	$(inc_build)/OpenHome/Net/Cpp/CpDeviceDv.h \
 	$(inc_build)/OpenHome/Net/Cpp/CpDeviceUpnp.h \
+	$(inc_build)/OpenHome/Net/Cpp/CpExecutor.h \
 	$(inc_build)/OpenHome/Net/Cpp/CpProxy.h \
 	$(inc_build)/OpenHome/Net/Cpp/DvDevice.h \
 	$(inc_build)/OpenHome/Net/Cpp/DvProvider.h \
@@ -271,6 +273,8 @@ $(objdir)CpDeviceDvStd.$(objext) : OpenHome/Net/Bindings/Cpp/ControlPoint/CpDevi
 	$(compiler)CpDeviceDvStd.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Bindings/Cpp/ControlPoint/CpDeviceDvStd.cpp
 $(objdir)CpDeviceDvC.$(objext) : OpenHome/Net/Bindings/C/ControlPoint/CpDeviceDvC.cpp $(headers)
 	$(compiler)CpDeviceDvC.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Bindings/C/ControlPoint/CpDeviceDvC.cpp
+$(objdir)CpExecutorStd.$(objext) : OpenHome/Net/Bindings/Cpp/ControlPoint/CpExecutorStd.cpp $(headers)
+	$(compiler)CpExecutorStd.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Bindings/Cpp/ControlPoint/CpExecutorStd.cpp
 $(objdir)CpDeviceUpnpCore.$(objext) : OpenHome/Net/ControlPoint/CpDeviceUpnpCore.cpp $(headers)
 	$(compiler)CpDeviceUpnpCore.$(objext) -c $(cppflags) $(includes) OpenHome/Net/ControlPoint/CpDeviceUpnpCore.cpp
 $(objdir)CpDeviceUpnpC.$(objext) : OpenHome/Net/Bindings/C/ControlPoint/CpDeviceUpnpC.cpp $(headers)
@@ -578,6 +582,14 @@ $(objdir)TestStream.$(objext) : OpenHome/Tests/TestStream.cpp $(headers)
 $(objdir)TestStreamMain.$(objext) : OpenHome/Tests/TestStreamMain.cpp $(headers)
 	$(compiler)TestStreamMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestStreamMain.cpp
 
+TestHttp: $(objdir)TestHttp.$(exeext)
+$(objdir)TestHttp.$(exeext) :  ohNetCore $(objdir)TestHttp.$(objext) $(objdir)TestHttpMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestHttp.$(exeext) $(objdir)TestHttpMain.$(objext) $(objdir)TestHttp.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestHttp.$(objext) : OpenHome/Tests/TestHttp.cpp $(headers)
+	$(compiler)TestHttp.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestHttp.cpp
+$(objdir)TestHttpMain.$(objext) : OpenHome/Tests/TestHttpMain.cpp $(headers)
+	$(compiler)TestHttpMain.$(objext) -c $(cppflags) $(includes) OpenHome/Tests/TestHttpMain.cpp
+
 TestTextUtils: $(objdir)TestTextUtils.$(exeext)
 $(objdir)TestTextUtils.$(exeext) :  ohNetCore $(objdir)TestTextUtils.$(objext) $(objdir)TestTextUtilsMain.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestTextUtils.$(exeext) $(objdir)TestTextUtilsMain.$(objext) $(objdir)TestTextUtils.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -763,6 +775,14 @@ $(objdir)TestDvLpec.$(objext) : OpenHome/Net/Device/Tests/TestDvLpec.cpp $(heade
 $(objdir)TestDvLpecMain.$(objext) : OpenHome/Net/Device/Tests/TestDvLpecMain.cpp $(headers)
 	$(compiler)TestDvLpecMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDvLpecMain.cpp
 
+TestDvWebSocket: $(objdir)TestDvWebSocket.$(exeext)
+$(objdir)TestDvWebSocket.$(exeext) :  ohNetCore $(objdir)TestDvWebSocket.$(objext) $(objdir)TestDvWebSocketMain.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestDvWebSocket.$(exeext) $(objdir)TestDvWebSocketMain.$(objext) $(objdir)TestDvWebSocket.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestDvWebSocket.$(objext) : OpenHome/Net/Device/Tests/TestDvWebSocket.cpp $(headers)
+	$(compiler)TestDvWebSocket.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDvWebSocket.cpp
+$(objdir)TestDvWebSocketMain.$(objext) : OpenHome/Net/Device/Tests/TestDvWebSocketMain.cpp $(headers)
+	$(compiler)TestDvWebSocketMain.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Device/Tests/TestDvWebSocketMain.cpp
+
 TestDvTestBasic: $(objdir)TestDvTestBasic.$(exeext)
 $(objdir)TestDvTestBasic.$(exeext) :  ohNetCore $(objdir)TestDvTestBasic.$(objext) $(libprefix)TestFramework.$(libext)
 	$(link) $(linkoutput)$(objdir)TestDvTestBasic.$(exeext) $(objdir)TestDvTestBasic.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -815,6 +835,12 @@ $(objdir)TestCpDeviceDvStd.$(exeext) :  ohNetCore $(objdir)TestCpDeviceDvStd.$(o
 $(objdir)TestCpDeviceDvStd.$(objext) : OpenHome/Net/Bindings/Cpp/ControlPoint/Tests/TestCpDeviceDvStd.cpp $(headers)
 	$(compiler)TestCpDeviceDvStd.$(objext) -c $(cppflags) $(includes) OpenHome/Net/Bindings/Cpp/ControlPoint/Tests/TestCpDeviceDvStd.cpp
 
+TestCpDeviceDvAwaitable: $(objdir)TestCpDeviceDvAwaitable.$(exeext)
+$(objdir)TestCpDeviceDvAwaitable.$(exeext) :  ohNetCore $(objdir)TestCpDeviceDvAwaitable.$(objext) $(objdir)TestBasicDvStd.$(objext) $(objdir)DvOpenhomeOrgTestBasic1Std.$(objext) $(objdir)CpOpenhomeOrgTestBasic1Std.$(objext) $(libprefix)TestFramework.$(libext)
+	$(link) $(linkoutput)$(objdir)TestCpDeviceDvAwaitable.$(exeext) $(objdir)TestCpDeviceDvAwaitable.$(objext) $(objdir)TestBasicDvStd.$(objext) $(objdir)DvOpenhomeOrgTestBasic1Std.$(objext) $(objdir)CpOpenhomeOrgTestBasic1Std.$(objext) $(objdir)$(libprefix)TestFramework.$(libext) $(objdir)$(libprefix)ohNetCore.$(libext)
+$(objdir)TestCpDeviceDvAwaitable.$(objext) : OpenHome/Net/Bindings/Cpp/ControlPoint/Tests/TestCpDeviceDvAwaitable.cpp $(headers)
+	$(compiler)TestCpDeviceDvAwaitable.$(objext) -c $(cppflags_cpp20) $(includes) OpenHome/Net/Bindings/Cpp/ControlPoint/Tests/TestCpDeviceDvAwaitable.cpp
+
 TestCpDeviceDvC: $(objdir)TestCpDeviceDvC.$(exeext)
 $(objdir)TestCpDeviceDvC.$(exeext) :  ohNetCore $(objdir)TestCpDeviceDvC.$(objext) $(objdir)TestBasicCpC.$(objext) $(objdir)TestBasicDvC.$(objext) $(objdir)DvOpenhomeOrgTestBasic1C.$(objext) $(objdir)CpOpenhomeOrgTestBasic1C.$(objext) $(objdir)TestFramework.$(objext) $(objdir)MainC.$(objext)
 	$(link) $(linkoutput)$(objdir)TestCpDeviceDvC.$(exeext) $(objdir)TestCpDeviceDvC.$(objext) $(objdir)TestBasicCpC.$(objext) $(objdir)TestBasicDvC.$(objext) $(objdir)DvOpenhomeOrgTestBasic1C.$(objext) $(objdir)CpOpenhomeOrgTestBasic1C.$(objext) $(objdir)TestFramework.$(objext) $(objdir)MainC.$(objext) $(objdir)$(libprefix)ohNetCore.$(libext)
@@ -853,6 +879,7 @@ tests_core = \
 	$(objdir)TestFunctorGeneric.$(objext) \
 	$(objdir)TestFifo.$(objext) \
 	$(objdir)TestStream.$(objext) \
+	$(objdir)TestHttp.$(objext) \
 	$(objdir)TestFile.$(objext) \
 	$(objdir)TestQueue.$(objext) \
 	$(objdir)TestTextUtils.$(objext) \
@@ -878,7 +905,7 @@ tests_core = \
 TestsCore: $(tests_core)
 	$(ar)ohNetTestsCore.$(libext) $(tests_core)
 
-TestsNative: TestBuffer TestPrinter TestThread TestFunctorGeneric TestFifo TestStream TestFile TestQueue TestTextUtils TestMulticast TestNetwork TestEcho TestTimer TestTimerMock TestSsdpMListen TestSsdpUListen TestXmlParser TestDeviceList TestDeviceListStd TestDeviceListC TestInvocation TestInvocationStd TestSubscription TestProxyC TestDviDiscovery TestDviDeviceList TestDvInvocation TestDvSubscription TestDvLpec TestDvTestBasic TestAdapterChange TestDeviceFinder TestDvDeviceStd TestDvDeviceC TestCpDeviceDv TestCpDeviceDvStd TestCpDeviceDvC TestShell
+TestsNative: TestBuffer TestPrinter TestThread TestFunctorGeneric TestFifo TestStream TestHttp TestFile TestQueue TestTextUtils TestMulticast TestNetwork TestEcho TestTimer TestTimerMock TestSsdpMListen TestSsdpUListen TestXmlParser TestDeviceList TestDeviceListStd TestDeviceListC TestInvocation TestInvocationStd TestSubscription TestProxyC TestDviDiscovery TestDviDeviceList TestDvInvocation TestDvSubscription TestDvLpec TestDvWebSocket TestDvTestBasic TestAdapterChange TestDeviceFinder TestDvDeviceStd TestDvDeviceC TestCpDeviceDv TestCpDeviceDvStd TestCpDeviceDvC $(tests_cpp20) TestShell
 
 TestsCs: TestProxyCs TestDvDeviceCs TestCpDeviceDvCs TestPerformanceDv TestPerformanceCp TestPerformanceDvCs TestPerformanceCpCs
 
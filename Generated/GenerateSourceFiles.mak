@@ -5,7 +5,7 @@
 
 GenAll: AllCp AllDv
 
-AllCp: CpCppCore CpCppStd CpC CpCs CpJava CpJs
+AllCp: CpCppCore CpCppStd CpCppAwaitable CpC CpCs CpJava CpJs
 
 AllDv: DvCppCore DvCppStd DvC DvCs DvJava
 
@@ -44,6 +44,23 @@ $(proxyCppStd)CpOpenhomeOrgSubscriptionLongPoll1Std.cpp : $(tt) OpenHome/Net/T4/
 	echo CpOpenhomeOrgSubscriptionLongPoll1Std.cpp
 	$(ohNetGen) --language=cpp --stack=cp "--xml=OpenHome/Net/Service/Upnp/OpenHome/SubscriptionLongPoll1.xml" --output=$(proxyCppStd) --domain=openhome.org --type=SubscriptionLongPoll --version=1
 
+CpCppAwaitable:   $(proxyCppStd)CpUpnpOrgConnectionManager1Awaitable.h $(proxyCppStd)CpAvOpenhomeOrgProduct1Awaitable.h $(proxyCppStd)CpAvOpenhomeOrgSender1Awaitable.h $(proxyCppStd)CpOpenhomeOrgTestBasic1Awaitable.h $(proxyCppStd)CpOpenhomeOrgSubscriptionLongPoll1Awaitable.h
+$(proxyCppStd)CpUpnpOrgConnectionManager1Awaitable.h : $(tt) OpenHome/Net/T4/Templates/CpUpnpCppAwaitableHeader.tt OpenHome/Net/Service/Upnp/Upnp/MediaServer_3/ConnectionManager1.xml
+	echo CpUpnpOrgConnectionManager1Awaitable.h
+	$(ohNetGen) --language=cppawaitable --stack=cp "--xml=OpenHome/Net/Service/Upnp/Upnp/MediaServer_3/ConnectionManager1.xml" --output=$(proxyCppStd) --domain=upnp.org --type=ConnectionManager --version=1
+$(proxyCppStd)CpAvOpenhomeOrgProduct1Awaitable.h : $(tt) OpenHome/Net/T4/Templates/CpUpnpCppAwaitableHeader.tt OpenHome/Net/Service/Upnp/OpenHome/Product1.xml
+	echo CpAvOpenhomeOrgProduct1Awaitable.h
+	$(ohNetGen) --language=cppawaitable --stack=cp "--xml=OpenHome/Net/Service/Upnp/OpenHome/Product1.xml" --output=$(proxyCppStd) --domain=av.openhome.org --type=Product --version=1
+$(proxyCppStd)CpAvOpenhomeOrgSender1Awaitable.h : $(tt) OpenHome/Net/T4/Templates/CpUpnpCppAwaitableHeader.tt OpenHome/Net/Service/Upnp/OpenHome/Sender1.xml
+	echo CpAvOpenhomeOrgSender1Awaitable.h
+	$(ohNetGen) --language=cppawaitable --stack=cp "--xml=OpenHome/Net/Service/Upnp/OpenHome/Sender1.xml" --output=$(proxyCppStd) --domain=av.openhome.org --type=Sender --version=1
+$(proxyCppStd)CpOpenhomeOrgTestBasic1Awaitable.h : $(tt) OpenHome/Net/T4/Templates/CpUpnpCppAwaitableHeader.tt OpenHome/Net/Service/Upnp/OpenHome/Test/TestBasic1.xml
+	echo CpOpenhomeOrgTestBasic1Awaitable.h
+	$(ohNetGen) --language=cppawaitable --stack=cp "--xml=OpenHome/Net/Service/Upnp/OpenHome/Test/TestBasic1.xml" --output=$(proxyCppStd) --domain=openhome.org --type=TestBasic --version=1
+$(proxyCppStd)CpOpenhomeOrgSubscriptionLongPoll1Awaitable.h : $(tt) OpenHome/Net/T4/Templates/CpUpnpCppAwaitableHeader.tt OpenHome/Net/Service/Upnp/OpenHome/SubscriptionLongPoll1.xml
+	echo CpOpenhomeOrgSubscriptionLongPoll1Awaitable.h
+	$(ohNetGen) --language=cppawaitable --stack=cp "--xml=OpenHome/Net/Service/Upnp/OpenHome/SubscriptionLongPoll1.xml" --output=$(proxyCppStd) --domain=openhome.org --type=SubscriptionLongPoll --version=1
+
 CpC:   $(proxyC)CpUpnpOrgConnectionManager1C.cpp $(proxyC)CpAvOpenhomeOrgProduct1C.cpp $(proxyC)CpAvOpenhomeOrgSender1C.cpp $(proxyC)CpOpenhomeOrgTestBasic1C.cpp $(proxyC)CpOpenhomeOrgSubscriptionLongPoll1C.cpp
 $(proxyC)CpUpnpOrgConnectionManager1C.cpp : $(tt) OpenHome/Net/T4/Templates/CpUpnpCSource.tt OpenHome/Net/T4/Templates/CpUpnpCHeader.tt OpenHome/Net/Service/Upnp/Upnp/MediaServer_3/ConnectionManager1.xml
 	echo CpUpnpOrgConnectionManager1C.cpp
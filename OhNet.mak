@@ -105,6 +105,8 @@ ar = lib /nologo /out:$(objdir)
 cflags_tp = $(debug_specific_cflags) /c /w $(error_handling) /FR$(objdir) -DDEFINE_LITTLE_ENDIAN -DDEFINE_TRACE $(defines_universal)
 cflags = $(cflags_tp) $(additional_includes) /WX
 cppflags = $(cflags) $(universal_cppflags) $(force_cpp) 
+cppflags_cpp20 = $(cppflags) /std:c++20
+tests_cpp20 = TestCpDeviceDvAwaitable
 
 # force everything through cpp compiler if building winrt
 !if "$(windows_universal)"=="1"
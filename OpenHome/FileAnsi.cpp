@@ -42,6 +42,18 @@ void FileSystemAnsi::Unlink(const TChar* aFilename)
     }
 }
 
+void FileSystemAnsi::Rename(const TChar* aFrom, const TChar* aTo)
+{
+#if defined(_WIN32)
+    // Windows' rename() won't replace an existing file
+    (void)remove(aTo);
+#endif
+    const int error = rename(aFrom, aTo);
+    if (error != 0) {
+        THROW(RenameFailed);
+    }
+}
+
 FileAnsi::FileAnsi(const TChar* aFilename, FileMode aFileMode)
     : iFilePtr(NULL)
 {
@@ -676,10 +676,10 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginManufacturer(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionManufacturer, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionManufacturer->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -714,10 +714,10 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginModel(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionModel, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionModel->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -752,11 +752,11 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginProduct(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionProduct, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionProduct->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -792,7 +792,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginStandby(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionStandby, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionStandby->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -824,7 +824,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSetStandby(TBool aValue, FunctorAsync&
     Invocation* invocation = Service()->Invocation(*iActionSetStandby, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetStandby->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -854,7 +854,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSourceCount(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionSourceCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -886,7 +886,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSourceXml(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionSourceXml, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXml->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -918,7 +918,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSourceIndex(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionSourceIndex, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceIndex->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -950,7 +950,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSetSourceIndex(TUint aValue, FunctorAsy
     Invocation* invocation = Service()->Invocation(*iActionSetSourceIndex, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetSourceIndex->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -980,7 +980,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSetSourceIndexByName(const Brx& aValue,
     Invocation* invocation = Service()->Invocation(*iActionSetSourceIndexByName, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetSourceIndexByName->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1010,13 +1010,13 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSource(TUint aIndex, FunctorAsync& aFun
     Invocation* invocation = Service()->Invocation(*iActionSource, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSource->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aIndex));
+    invocation->AddInputUint(*inParams[inIndex++], aIndex);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSource->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1051,7 +1051,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginAttributes(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionAttributes, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAttributes->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1083,7 +1083,7 @@ void CpProxyAvOpenhomeOrgProduct1C::BeginSourceXmlChangeCount(FunctorAsync& aFun
     Invocation* invocation = Service()->Invocation(*iActionSourceXmlChangeCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXmlChangeCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
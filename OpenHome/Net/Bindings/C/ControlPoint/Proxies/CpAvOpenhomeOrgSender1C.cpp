@@ -268,7 +268,7 @@ void CpProxyAvOpenhomeOrgSender1C::BeginPresentationUrl(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionPresentationUrl, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionPresentationUrl->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -300,7 +300,7 @@ void CpProxyAvOpenhomeOrgSender1C::BeginMetadata(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionMetadata, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionMetadata->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -332,7 +332,7 @@ void CpProxyAvOpenhomeOrgSender1C::BeginAudio(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionAudio, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAudio->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -364,7 +364,7 @@ void CpProxyAvOpenhomeOrgSender1C::BeginStatus(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionStatus, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionStatus->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -396,7 +396,7 @@ void CpProxyAvOpenhomeOrgSender1C::BeginAttributes(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionAttributes, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAttributes->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
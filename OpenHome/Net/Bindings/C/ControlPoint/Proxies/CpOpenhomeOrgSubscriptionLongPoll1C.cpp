@@ -201,14 +201,14 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1C::BeginSubscribe(const Brx& aClient
     Invocation* invocation = Service()->Invocation(*iActionSubscribe, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSubscribe->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aClientId));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aUdn));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aService));
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputString(*inParams[inIndex++], aClientId);
+    invocation->AddInputString(*inParams[inIndex++], aUdn);
+    invocation->AddInputString(*inParams[inIndex++], aService);
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSubscribe->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -241,7 +241,7 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1C::BeginUnsubscribe(const Brx& aSid,
     Invocation* invocation = Service()->Invocation(*iActionUnsubscribe, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionUnsubscribe->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aSid));
+    invocation->AddInputString(*inParams[inIndex++], aSid);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -271,11 +271,11 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1C::BeginRenew(const Brx& aSid, TUint
     Invocation* invocation = Service()->Invocation(*iActionRenew, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionRenew->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aSid));
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputString(*inParams[inIndex++], aSid);
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionRenew->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -307,10 +307,10 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1C::BeginGetPropertyUpdates(const Brx
     Invocation* invocation = Service()->Invocation(*iActionGetPropertyUpdates, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionGetPropertyUpdates->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aClientId));
+    invocation->AddInputString(*inParams[inIndex++], aClientId);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetPropertyUpdates->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -865,10 +865,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginIncrement(TUint aValue, FunctorAsync& a
     Invocation* invocation = Service()->Invocation(*iActionIncrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionIncrement->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionIncrement->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -900,10 +900,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginEchoAllowedRangeUint(TUint aValue, Func
     Invocation* invocation = Service()->Invocation(*iActionEchoAllowedRangeUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoAllowedRangeUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedRangeUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -935,10 +935,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginDecrement(TInt aValue, FunctorAsync& aF
     Invocation* invocation = Service()->Invocation(*iActionDecrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionDecrement->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValue));
+    invocation->AddInputInt(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionDecrement->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -970,10 +970,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginToggle(TBool aValue, FunctorAsync& aFun
     Invocation* invocation = Service()->Invocation(*iActionToggle, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionToggle->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionToggle->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1005,10 +1005,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginEchoString(const Brx& aValue, FunctorAs
     Invocation* invocation = Service()->Invocation(*iActionEchoString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1040,10 +1040,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginEchoAllowedValueString(const Brx& aValu
     Invocation* invocation = Service()->Invocation(*iActionEchoAllowedValueString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoAllowedValueString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedValueString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1075,10 +1075,10 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginEchoBinary(const Brx& aValue, FunctorAs
     Invocation* invocation = Service()->Invocation(*iActionEchoBinary, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoBinary->InputParameters();
-    invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], aValue));
+    invocation->AddInputBinary(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1110,7 +1110,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetUint(TUint aValueUint, FunctorAsync&
     Invocation* invocation = Service()->Invocation(*iActionSetUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1140,7 +1140,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetUint(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetUint, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1172,7 +1172,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetInt(TInt aValueInt, FunctorAsync& aF
     Invocation* invocation = Service()->Invocation(*iActionSetInt, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetInt->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1202,7 +1202,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetInt(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetInt, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetInt->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1234,7 +1234,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetBool(TBool aValueBool, FunctorAsync&
     Invocation* invocation = Service()->Invocation(*iActionSetBool, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetBool->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1264,7 +1264,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetBool(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetBool, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBool->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1296,9 +1296,9 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetMultiple(TUint aValueUint, TInt aVal
     Invocation* invocation = Service()->Invocation(*iActionSetMultiple, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetMultiple->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1328,9 +1328,9 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetMultiple(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetMultiple, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetMultiple->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1364,7 +1364,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetString(const Brx& aValueStr, Functor
     Invocation* invocation = Service()->Invocation(*iActionSetString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValueStr));
+    invocation->AddInputString(*inParams[inIndex++], aValueStr);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1394,7 +1394,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetString(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetString, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1426,7 +1426,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginSetBinary(const Brx& aValueBin, Functor
     Invocation* invocation = Service()->Invocation(*iActionSetBinary, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetBinary->InputParameters();
-    invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], aValueBin));
+    invocation->AddInputBinary(*inParams[inIndex++], aValueBin);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1456,7 +1456,7 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginGetBinary(FunctorAsync& aFunctor)
     Invocation* invocation = Service()->Invocation(*iActionGetBinary, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -1542,8 +1542,8 @@ void CpProxyOpenhomeOrgTestBasic1C::BeginWriteFile(const Brx& aData, const Brx&
     Invocation* invocation = Service()->Invocation(*iActionWriteFile, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionWriteFile->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aData));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aFileFullName));
+    invocation->AddInputString(*inParams[inIndex++], aData);
+    invocation->AddInputString(*inParams[inIndex++], aFileFullName);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -308,8 +308,8 @@ void CpProxyUpnpOrgConnectionManager1C::BeginGetProtocolInfo(FunctorAsync& aFunc
     Invocation* invocation = Service()->Invocation(*iActionGetProtocolInfo, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetProtocolInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -342,15 +342,15 @@ void CpProxyUpnpOrgConnectionManager1C::BeginPrepareForConnection(const Brx& aRe
     Invocation* invocation = Service()->Invocation(*iActionPrepareForConnection, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionPrepareForConnection->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aRemoteProtocolInfo));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aPeerConnectionManager));
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aPeerConnectionID));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aDirection));
+    invocation->AddInputString(*inParams[inIndex++], aRemoteProtocolInfo);
+    invocation->AddInputString(*inParams[inIndex++], aPeerConnectionManager);
+    invocation->AddInputInt(*inParams[inIndex++], aPeerConnectionID);
+    invocation->AddInputString(*inParams[inIndex++], aDirection);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionPrepareForConnection->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -384,7 +384,7 @@ void CpProxyUpnpOrgConnectionManager1C::BeginConnectionComplete(TInt aConnection
     Invocation* invocation = Service()->Invocation(*iActionConnectionComplete, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionConnectionComplete->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -414,7 +414,7 @@ void CpProxyUpnpOrgConnectionManager1C::BeginGetCurrentConnectionIDs(FunctorAsyn
     Invocation* invocation = Service()->Invocation(*iActionGetCurrentConnectionIDs, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionIDs->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -446,16 +446,16 @@ void CpProxyUpnpOrgConnectionManager1C::BeginGetCurrentConnectionInfo(TInt aConn
     Invocation* invocation = Service()->Invocation(*iActionGetCurrentConnectionInfo, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionGetCurrentConnectionInfo->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     Invocable().InvokeAction(*invocation);
 }
 
@@ -0,0 +1,267 @@
+#ifndef HEADER_CPAWAITABLECPP
+#define HEADER_CPAWAITABLECPP
+
+/**
+ * Support for the co_await-able proxies generated by CpUpnpCppAwaitableHeader.tt
+ *
+ * Header only; requires a C++20 compiler.  The rest of the library (including the
+ * CpExecutor these types resume coroutines on) builds as before.
+ */
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Functor.h>
+#include <OpenHome/Net/Core/FunctorAsync.h>
+#include <OpenHome/Net/Cpp/CpExecutor.h>
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace OpenHome {
+namespace Net {
+
+inline void STDCALL CpResumeCoroutine(void* aPtr)
+{
+    std::coroutine_handle<>::from_address(aPtr).resume();
+}
+
+/**
+ * Awaitable which moves the awaiting coroutine onto an executor's thread
+ * @ingroup ControlPoint
+ */
+class CpResumeOn
+{
+public:
+    CpResumeOn(CpExecutor& aExecutor) : iExecutor(aExecutor) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> aHandle) { iExecutor.Post(MakeFunctor(aHandle.address(), &CpResumeCoroutine)); }
+    void await_resume() const noexcept {}
+private:
+    CpExecutor& iExecutor;
+};
+
+/**
+ * Output of a completed action (or task) - either a value or an exception
+ */
+template <class T>
+class CpAwaitResult
+{
+public:
+    template <class F> void Complete(const F& aFunction)
+    {
+        try {
+            iValue.emplace(aFunction());
+        }
+        catch (...) {
+            iException = std::current_exception();
+        }
+    }
+    void SetValue(T aValue) { iValue.emplace(std::move(aValue)); }
+    void SetException(std::exception_ptr aException) { iException = aException; }
+    T Get()
+    {
+        if (iException) {
+            std::rethrow_exception(iException);
+        }
+        return std::move(*iValue);
+    }
+private:
+    std::optional<T> iValue;
+    std::exception_ptr iException;
+};
+
+template <>
+class CpAwaitResult<void>
+{
+public:
+    template <class F> void Complete(const F& aFunction)
+    {
+        try {
+            aFunction();
+        }
+        catch (...) {
+            iException = std::current_exception();
+        }
+    }
+    void SetException(std::exception_ptr aException) { iException = aException; }
+    void Get()
+    {
+        if (iException) {
+            std::rethrow_exception(iException);
+        }
+    }
+private:
+    std::exception_ptr iException;
+};
+
+/**
+ * Awaitable returned by the Co* functions of generated proxies
+ *
+ * Awaiting starts the action using its Begin function.  On completion, output
+ * arguments are read on the invoker thread using the End function then the awaiting
+ * coroutine is resumed on aExecutor.  co_await returns the output argument(s) or
+ * throws ProxyError if the action failed.
+ * @ingroup ControlPoint
+ */
+template <class T>
+class CpActionAwaiter
+{
+public:
+    typedef std::function<void(FunctorAsync&)> BeginFunction;
+    typedef std::function<T(IAsync&)> EndFunction;
+public:
+    CpActionAwaiter(CpExecutor& aExecutor, BeginFunction aBegin, EndFunction aEnd)
+        : iExecutor(aExecutor)
+        , iBegin(std::move(aBegin))
+        , iEnd(std::move(aEnd))
+    {
+    }
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> aHandle)
+    {
+        iHandle = aHandle;
+        FunctorAsync functor = MakeFunctorAsync(*this, &CpActionAwaiter::Completed);
+        iBegin(functor);
+    }
+    T await_resume() { return iResult.Get(); }
+private:
+    void Completed(IAsync& aAsync)
+    {
+        // aAsync is only valid during this callback so read outputs before switching thread
+        iResult.Complete([this, &aAsync]() { return iEnd(aAsync); });
+        iExecutor.Post(MakeFunctor(iHandle.address(), &CpResumeCoroutine));
+    }
+private:
+    CpExecutor& iExecutor;
+    BeginFunction iBegin;
+    EndFunction iEnd;
+    std::coroutine_handle<> iHandle;
+    CpAwaitResult<T> iResult;
+};
+
+template <class T> class CpTask;
+
+template <class T>
+class CpTaskPromiseBase
+{
+public:
+    class FinalAwaiter
+    {
+    public:
+        bool await_ready() const noexcept { return false; }
+        template <class P> std::coroutine_handle<> await_suspend(std::coroutine_handle<P> aHandle) noexcept
+        {
+            std::coroutine_handle<> continuation = aHandle.promise().iContinuation;
+            if (continuation) {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+public:
+    std::suspend_always initial_suspend() const noexcept { return std::suspend_always(); }
+    FinalAwaiter final_suspend() const noexcept { return FinalAwaiter(); }
+    void unhandled_exception() { iResult.SetException(std::current_exception()); }
+public:
+    std::coroutine_handle<> iContinuation;
+    CpAwaitResult<T> iResult;
+};
+
+template <class T>
+class CpTaskPromise : public CpTaskPromiseBase<T>
+{
+public:
+    CpTask<T> get_return_object() noexcept;
+    void return_value(T aValue) { this->iResult.SetValue(std::move(aValue)); }
+};
+
+template <>
+class CpTaskPromise<void> : public CpTaskPromiseBase<void>
+{
+public:
+    CpTask<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+};
+
+/**
+ * Return type for coroutines which co_await proxy actions (or other tasks)
+ *
+ * Tasks start when first awaited, run on the thread that resumed them and resume
+ * their awaiter directly on completion.  Use CpSpawn() to start a top-level task.
+ * @ingroup ControlPoint
+ */
+template <class T = void>
+class CpTask
+{
+    friend class CpTaskPromise<T>;
+public:
+    typedef CpTaskPromise<T> promise_type;
+public:
+    CpTask(CpTask&& aTask) noexcept : iHandle(aTask.iHandle) { aTask.iHandle = nullptr; }
+    ~CpTask()
+    {
+        if (iHandle) {
+            iHandle.destroy();
+        }
+    }
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> aAwaiting) noexcept
+    {
+        iHandle.promise().iContinuation = aAwaiting;
+        return iHandle;
+    }
+    T await_resume() { return iHandle.promise().iResult.Get(); }
+private:
+    explicit CpTask(std::coroutine_handle<promise_type> aHandle) : iHandle(aHandle) {}
+    CpTask(const CpTask&) = delete;
+    CpTask& operator=(const CpTask&) = delete;
+private:
+    std::coroutine_handle<promise_type> iHandle;
+};
+
+template <class T>
+inline CpTask<T> CpTaskPromise<T>::get_return_object() noexcept
+{
+    return CpTask<T>(std::coroutine_handle<CpTaskPromise<T> >::from_promise(*this));
+}
+
+inline CpTask<void> CpTaskPromise<void>::get_return_object() noexcept
+{
+    return CpTask<void>(std::coroutine_handle<CpTaskPromise<void> >::from_promise(*this));
+}
+
+class CpDetachedTask
+{
+public:
+    class promise_type
+    {
+    public:
+        CpDetachedTask get_return_object() const noexcept { return CpDetachedTask(); }
+        std::suspend_never initial_suspend() const noexcept { return std::suspend_never(); }
+        std::suspend_never final_suspend() const noexcept { return std::suspend_never(); }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * Start a top-level task on aExecutor's thread.
+ *
+ * The task owns itself and is destroyed when it completes.  It must catch any
+ * exceptions thrown by the actions it awaits; an uncaught exception terminates
+ * the process.
+ * @ingroup ControlPoint
+ */
+inline CpDetachedTask CpSpawn(CpExecutor& aExecutor, CpTask<void> aTask)
+{
+    co_await CpResumeOn(aExecutor);
+    co_await aTask;
+}
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_CPAWAITABLECPP
@@ -0,0 +1,53 @@
+#ifndef HEADER_CPEXECUTORCPP
+#define HEADER_CPEXECUTORCPP
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Functor.h>
+
+#include <list>
+
+namespace OpenHome {
+class Mutex;
+class Semaphore;
+namespace Net {
+
+/**
+ * Queue of callbacks which are run by whichever thread calls Run()
+ *
+ * Awaitable proxies (see CpAwaitable.h) post to an executor to resume coroutines
+ * on a thread chosen by the client rather than on an action invoker thread.
+ * @ingroup ControlPoint
+ */
+class CpExecutor
+{
+public:
+    CpExecutor();
+    ~CpExecutor();
+    /**
+     * Queue a callback to be run by Run().
+     * Threadsafe; may be called from any thread, including from a callback.
+     *
+     * @param[in] aFunctor  Callback to run
+     */
+    void Post(Functor aFunctor);
+    /**
+     * Run queued callbacks, in the order they were posted, on the calling thread.
+     * Blocks until Stop() is called and all callbacks posted before the queue
+     * next empties have been run.  May be called again after it returns.
+     */
+    void Run();
+    /**
+     * Cause Run() to return once the queue is empty.
+     * Threadsafe; may be called from any thread, including from a callback.
+     */
+    void Stop();
+private:
+    Mutex* iLock;
+    Semaphore* iSem;
+    std::list<Functor> iQueue;
+};
+
+} // namespace Net
+} // namespace OpenHome
+
+#endif // HEADER_CPEXECUTORCPP
@@ -0,0 +1,50 @@
+#include <OpenHome/Net/Cpp/CpExecutor.h>
+#include <OpenHome/Private/Thread.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+
+// CpExecutor
+
+CpExecutor::CpExecutor()
+{
+    iLock = new Mutex("CPEX");
+    iSem = new Semaphore("CPEX", 0);
+}
+
+CpExecutor::~CpExecutor()
+{
+    delete iSem;
+    delete iLock;
+}
+
+void CpExecutor::Post(Functor aFunctor)
+{
+    iLock->Wait();
+    iQueue.push_back(aFunctor);
+    iLock->Signal();
+    iSem->Signal();
+}
+
+void CpExecutor::Run()
+{
+    for (;;) {
+        // each Post() and Stop() signals iSem once so we only wake to an empty queue
+        // after every callback posted ahead of a Stop() has been run
+        iSem->Wait();
+        iLock->Wait();
+        if (iQueue.size() == 0) {
+            iLock->Signal();
+            return;
+        }
+        Functor functor = iQueue.front();
+        iQueue.pop_front();
+        iLock->Signal();
+        functor();
+    }
+}
+
+void CpExecutor::Stop()
+{
+    iSem->Signal();
+}
@@ -504,10 +504,10 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginManufacturer(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionManufacturer, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionManufacturer->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -554,10 +554,10 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginModel(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionModel, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionModel->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -604,11 +604,11 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginProduct(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionProduct, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionProduct->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -659,7 +659,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginStandby(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionStandby, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionStandby->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -691,7 +691,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSetStandby(bool aValue, FunctorAsync&
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetStandby, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetStandby->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -721,7 +721,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSourceCount(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -753,7 +753,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSourceXml(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceXml, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXml->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -788,7 +788,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSourceIndex(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceIndex, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceIndex->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -820,7 +820,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSetSourceIndex(uint32_t aValue, Funct
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetSourceIndex, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetSourceIndex->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -852,7 +852,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSetSourceIndexByName(const std::strin
     const Action::VectorParameters& inParams = iActionSetSourceIndexByName->InputParameters();
     {
         Brn buf((const TByte*)aValue.c_str(), (TUint)aValue.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
@@ -883,13 +883,13 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSource(uint32_t aIndex, FunctorAsync&
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSource, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSource->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aIndex));
+    invocation->AddInputUint(*inParams[inIndex++], aIndex);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSource->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -933,7 +933,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginAttributes(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionAttributes, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAttributes->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -968,7 +968,7 @@ void CpProxyAvOpenhomeOrgProduct1Cpp::BeginSourceXmlChangeCount(FunctorAsync& aF
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceXmlChangeCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXmlChangeCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
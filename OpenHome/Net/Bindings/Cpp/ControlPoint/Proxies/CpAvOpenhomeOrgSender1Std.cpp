@@ -201,7 +201,7 @@ void CpProxyAvOpenhomeOrgSender1Cpp::BeginPresentationUrl(FunctorAsync& aFunctor
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionPresentationUrl, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionPresentationUrl->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -236,7 +236,7 @@ void CpProxyAvOpenhomeOrgSender1Cpp::BeginMetadata(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionMetadata, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionMetadata->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -271,7 +271,7 @@ void CpProxyAvOpenhomeOrgSender1Cpp::BeginAudio(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionAudio, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAudio->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -303,7 +303,7 @@ void CpProxyAvOpenhomeOrgSender1Cpp::BeginStatus(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionStatus, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionStatus->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -338,7 +338,7 @@ void CpProxyAvOpenhomeOrgSender1Cpp::BeginAttributes(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionAttributes, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAttributes->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
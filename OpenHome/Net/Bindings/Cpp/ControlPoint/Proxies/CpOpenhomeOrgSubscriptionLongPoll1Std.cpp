@@ -166,21 +166,21 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp::BeginSubscribe(const std::strin
     const Action::VectorParameters& inParams = iActionSubscribe->InputParameters();
     {
         Brn buf((const TByte*)aClientId.c_str(), (TUint)aClientId.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     {
         Brn buf((const TByte*)aUdn.c_str(), (TUint)aUdn.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     {
         Brn buf((const TByte*)aService.c_str(), (TUint)aService.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSubscribe->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -218,7 +218,7 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp::BeginUnsubscribe(const std::str
     const Action::VectorParameters& inParams = iActionUnsubscribe->InputParameters();
     {
         Brn buf((const TByte*)aSid.c_str(), (TUint)aSid.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
@@ -251,12 +251,12 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp::BeginRenew(const std::string& a
     const Action::VectorParameters& inParams = iActionRenew->InputParameters();
     {
         Brn buf((const TByte*)aSid.c_str(), (TUint)aSid.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionRenew->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -290,11 +290,11 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1Cpp::BeginGetPropertyUpdates(const s
     const Action::VectorParameters& inParams = iActionGetPropertyUpdates->InputParameters();
     {
         Brn buf((const TByte*)aClientId.c_str(), (TUint)aClientId.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetPropertyUpdates->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
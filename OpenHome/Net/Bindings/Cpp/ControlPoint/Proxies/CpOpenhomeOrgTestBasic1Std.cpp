@@ -708,10 +708,10 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginIncrement(uint32_t aValue, FunctorAsy
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionIncrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionIncrement->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionIncrement->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -743,10 +743,10 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginEchoAllowedRangeUint(uint32_t aValue,
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionEchoAllowedRangeUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoAllowedRangeUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedRangeUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -778,10 +778,10 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginDecrement(int32_t aValue, FunctorAsyn
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionDecrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionDecrement->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValue));
+    invocation->AddInputInt(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionDecrement->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -813,10 +813,10 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginToggle(bool aValue, FunctorAsync& aFu
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionToggle, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionToggle->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionToggle->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -850,11 +850,11 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginEchoString(const std::string& aValue,
     const Action::VectorParameters& inParams = iActionEchoString->InputParameters();
     {
         Brn buf((const TByte*)aValue.c_str(), (TUint)aValue.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -891,11 +891,11 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginEchoAllowedValueString(const std::str
     const Action::VectorParameters& inParams = iActionEchoAllowedValueString->InputParameters();
     {
         Brn buf((const TByte*)aValue.c_str(), (TUint)aValue.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedValueString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -932,11 +932,11 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginEchoBinary(const std::string& aValue,
     const Action::VectorParameters& inParams = iActionEchoBinary->InputParameters();
     {
         Brn buf((const TByte*)aValue.c_str(), (TUint)aValue.length());
-        invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], buf));
+        invocation->AddInputBinary(*inParams[inIndex++], buf);
     }
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -971,7 +971,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetUint(uint32_t aValueUint, FunctorA
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1001,7 +1001,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetUint(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetUint, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1033,7 +1033,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetInt(int32_t aValueInt, FunctorAsyn
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetInt, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetInt->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1063,7 +1063,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetInt(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetInt, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetInt->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1095,7 +1095,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetBool(bool aValueBool, FunctorAsync
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetBool, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetBool->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1125,7 +1125,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetBool(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetBool, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBool->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1157,9 +1157,9 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetMultiple(uint32_t aValueUint, int3
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetMultiple, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetMultiple->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1189,9 +1189,9 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetMultiple(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetMultiple, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetMultiple->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1227,7 +1227,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetString(const std::string& aValueSt
     const Action::VectorParameters& inParams = iActionSetString->InputParameters();
     {
         Brn buf((const TByte*)aValueStr.c_str(), (TUint)aValueStr.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
@@ -1258,7 +1258,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetString(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetString, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1295,7 +1295,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginSetBinary(const std::string& aValueBi
     const Action::VectorParameters& inParams = iActionSetBinary->InputParameters();
     {
         Brn buf((const TByte*)aValueBin.c_str(), (TUint)aValueBin.length());
-        invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], buf));
+        invocation->AddInputBinary(*inParams[inIndex++], buf);
     }
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
@@ -1326,7 +1326,7 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginGetBinary(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetBinary, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1417,11 +1417,11 @@ void CpProxyOpenhomeOrgTestBasic1Cpp::BeginWriteFile(const std::string& aData, c
     const Action::VectorParameters& inParams = iActionWriteFile->InputParameters();
     {
         Brn buf((const TByte*)aData.c_str(), (TUint)aData.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     {
         Brn buf((const TByte*)aFileFullName.c_str(), (TUint)aFileFullName.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
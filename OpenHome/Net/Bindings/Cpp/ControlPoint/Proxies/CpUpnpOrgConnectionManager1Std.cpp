@@ -251,8 +251,8 @@ void CpProxyUpnpOrgConnectionManager1Cpp::BeginGetProtocolInfo(FunctorAsync& aFu
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetProtocolInfo, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetProtocolInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -293,22 +293,22 @@ void CpProxyUpnpOrgConnectionManager1Cpp::BeginPrepareForConnection(const std::s
     const Action::VectorParameters& inParams = iActionPrepareForConnection->InputParameters();
     {
         Brn buf((const TByte*)aRemoteProtocolInfo.c_str(), (TUint)aRemoteProtocolInfo.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     {
         Brn buf((const TByte*)aPeerConnectionManager.c_str(), (TUint)aPeerConnectionManager.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aPeerConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aPeerConnectionID);
     {
         Brn buf((const TByte*)aDirection.c_str(), (TUint)aDirection.length());
-        invocation->AddInput(new ArgumentString(*inParams[inIndex++], buf));
+        invocation->AddInputString(*inParams[inIndex++], buf);
     }
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionPrepareForConnection->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -342,7 +342,7 @@ void CpProxyUpnpOrgConnectionManager1Cpp::BeginConnectionComplete(int32_t aConne
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionConnectionComplete, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionConnectionComplete->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -372,7 +372,7 @@ void CpProxyUpnpOrgConnectionManager1Cpp::BeginGetCurrentConnectionIDs(FunctorAs
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetCurrentConnectionIDs, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionIDs->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -407,16 +407,16 @@ void CpProxyUpnpOrgConnectionManager1Cpp::BeginGetCurrentConnectionInfo(int32_t
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetCurrentConnectionInfo, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionGetCurrentConnectionInfo->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
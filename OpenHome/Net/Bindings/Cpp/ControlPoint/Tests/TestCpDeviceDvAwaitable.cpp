@@ -0,0 +1,164 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Net/Cpp/DvDevice.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Cpp/CpDeviceDv.h>
+#include <OpenHome/Net/Cpp/CpExecutor.h>
+#include <OpenHome/Net/Cpp/CpAwaitable.h>
+#include <OpenHome/Net/Cpp/CpOpenhomeOrgTestBasic1Awaitable.h>
+#include "../../Device/Tests/TestBasicDv.h"
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+static const TUint kNumChains = 8;
+static const TUint kChainLength = 50;
+
+class AwaitableTests
+{
+public:
+    AwaitableTests(CpDeviceCpp& aDevice);
+    ~AwaitableTests();
+    void Run();
+private:
+    CpTask<uint32_t> IncrementChain(uint32_t aStart, TUint aCount);
+    CpTask<void> Chain(TUint aIndex);
+    CpTask<void> TestActions();
+    CpTask<void> TestChains();
+    void AssertExecutorThread() const;
+private:
+    CpExecutor iExecutor;
+    CpProxyOpenhomeOrgTestBasic1Awaitable* iProxy;
+    std::thread::id iExecutorThread;
+    TUint iChainsRemaining;
+};
+
+AwaitableTests::AwaitableTests(CpDeviceCpp& aDevice)
+    : iChainsRemaining(0)
+{
+    iProxy = new CpProxyOpenhomeOrgTestBasic1Awaitable(aDevice, iExecutor);
+}
+
+AwaitableTests::~AwaitableTests()
+{
+    delete iProxy;
+}
+
+void AwaitableTests::Run()
+{
+    iExecutorThread = std::this_thread::get_id();
+    CpSpawn(iExecutor, TestActions());
+    iExecutor.Run();
+    CpSpawn(iExecutor, TestChains());
+    iExecutor.Run();
+}
+
+void AwaitableTests::AssertExecutorThread() const
+{
+    ASSERT(std::this_thread::get_id() == iExecutorThread);
+}
+
+CpTask<uint32_t> AwaitableTests::IncrementChain(uint32_t aStart, TUint aCount)
+{
+    uint32_t val = aStart;
+    for (TUint i=0; i<aCount; i++) {
+        val = co_await iProxy->CoIncrement(val);
+        AssertExecutorThread();
+    }
+    co_return val;
+}
+
+CpTask<void> AwaitableTests::TestActions()
+{
+    Print("  Actions\n");
+    uint32_t valUint = co_await IncrementChain(0, kChainLength);
+    TEST(valUint == kChainLength);
+    int32_t valInt = co_await iProxy->CoDecrement(-7);
+    TEST(valInt == -8);
+    bool valBool = co_await iProxy->CoToggle(true);
+    TEST(!valBool);
+    std::string valStr = co_await iProxy->CoEchoString(std::string("co_await"));
+    TEST(valStr == "co_await");
+    std::string bin("\0\1\2\3", 4);
+    valStr = co_await iProxy->CoEchoBinary(bin);
+    TEST(valStr == bin);
+
+    co_await iProxy->CoSetMultiple(15, -15, true);
+    AssertExecutorThread();
+    TEST((co_await iProxy->CoGetUint()) == 15);
+    TEST((co_await iProxy->CoGetInt()) == -15);
+    TEST((co_await iProxy->CoGetBool()));
+
+    Print("  Errors\n");
+    TBool threw = false;
+    try {
+        (void)co_await iProxy->CoGetMultiple(); // not enabled by DeviceBasic
+    }
+    catch (ProxyError&) {
+        threw = true;
+    }
+    AssertExecutorThread();
+    TEST(threw);
+    threw = false;
+    try {
+        co_await iProxy->CoSetInt(12345);
+    }
+    catch (ProxyError& pe) {
+        TEST(pe.Code() == 801);
+        threw = true;
+    }
+    TEST(threw);
+
+    iExecutor.Stop();
+}
+
+CpTask<void> AwaitableTests::Chain(TUint aIndex)
+{
+    const uint32_t start = aIndex * 1000;
+    uint32_t val = co_await IncrementChain(start, kChainLength);
+    TEST(val == start + kChainLength);
+    // all chains run on the executor thread so iChainsRemaining doesn't need a lock
+    if (--iChainsRemaining == 0) {
+        iExecutor.Stop();
+    }
+}
+
+CpTask<void> AwaitableTests::TestChains()
+{
+    Print("  Concurrent chains\n");
+    iChainsRemaining = kNumChains;
+    for (TUint i=0; i<kNumChains; i++) {
+        CpSpawn(iExecutor, Chain(i));
+    }
+    co_return;
+}
+
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], InitialisationParams* aInitParams)
+{
+    aInitParams->SetUseLoopbackNetworkAdapter();
+    UpnpLibrary::Initialise(aInitParams);
+    std::vector<NetworkAdapter*>* subnetList = UpnpLibrary::CreateSubnetList();
+    TIpAddress subnet = (*subnetList)[0]->Subnet();
+    UpnpLibrary::DestroySubnetList(subnetList);
+    UpnpLibrary::StartCombined(subnet);
+
+    Print("TestCpDeviceDvAwaitable - starting\n");
+
+    DeviceBasic* device = new DeviceBasic(*gEnv, DeviceBasic::eProtocolNone);
+    CpDeviceDvCpp* cpDevice = CpDeviceDvCpp::New(device->Device());
+    AwaitableTests* tests = new AwaitableTests(*cpDevice);
+    tests->Run();
+    delete tests;
+    cpDevice->RemoveRef();
+    delete device;
+
+    Print("TestCpDeviceDvAwaitable - completed\n");
+    UpnpLibrary::Close();
+}
@@ -30,9 +30,18 @@ ohnet.soaprequest = function (action, url, domain, type, version) {
     this.version = version;
     this.domain = domain;
     this.envelope = ""; // The soap envelope
+    this.args = ""; // The input arguments, for invocation over a websocket
     this.writeEnvelopeStart(action);
 }
 
+/**
+* The websocket to send requests over in place of http, or null.
+* Set by the subscription manager when started with invokeOverWebSocket.
+* @property websocket
+* @static
+*/
+ohnet.soaprequest.websocket = null;
+
 /**
 * Builds the start of the soap message
 * @method writeEnvelopeStart
@@ -90,6 +99,17 @@ ohnet.soaprequest.prototype.getSoapAction = function () {
 */
 ohnet.soaprequest.prototype.send = function (successFunction, errorFunction) {
     var _this = this;
+    var ws = ohnet.soaprequest.websocket;
+    if (ws && ws.socket.readyState == 1) { // OPEN
+        // control urls are of the form .../udn/serviceName/control
+        var path = this.url.split("/");
+        ws.invoke(path[path.length - 3], path[path.length - 2], this.action, this.args, successFunction, function (message, transport) {
+            if (errorFunction) {
+                errorFunction(message, transport);
+            }
+        });
+        return;
+    }
     this.writeEnvelopeEnd();
     return this.createAjaxRequest(
 		function (transport) {
@@ -291,5 +311,7 @@ ohnet.soaprequest.prototype.writeBinaryParameter = function (tagName, value) {
 * @param {String} value The xml tag value to be inserted into the SOAP envelope
 */
 ohnet.soaprequest.prototype.writeParameter = function (tagName, value) {
-    this.envelope += "<" + tagName + ">" + value.replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;") + "</" + tagName + ">";
+    var parameter = "<" + tagName + ">" + value.replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;") + "</" + tagName + ">";
+    this.envelope += parameter;
+    this.args += parameter;
 }
\ No newline at end of file
@@ -209,6 +209,7 @@ ohnet.subscriptionmanager = (function() {
 	 */
 	var onSocketError = function() {
 		webSocketLive = false;
+		ohnet.soaprequest.websocket = null;
 		running = false;
 		console.log("onSocketError");
 	};
@@ -220,6 +221,7 @@ ohnet.subscriptionmanager = (function() {
 	    console.log("onSocketClose");
 		stop();
 		webSocketLive = false;
+		ohnet.soaprequest.websocket = null;
 		running = false;
 
 		
@@ -264,6 +266,9 @@ ohnet.subscriptionmanager = (function() {
 		webSocketLive = true;
 		webSocketOpened = true;
 		console.log("onSocketOpen");
+		if(options.invokeOverWebSocket) {
+			ohnet.soaprequest.websocket = ws;
+		}
 		if(!running)
 		{
 			services = {};
@@ -291,6 +296,7 @@ ohnet.subscriptionmanager = (function() {
 			errorFunction : null,
 			disconnectedFunction : null,
 			allowWebSockets : true,
+			invokeOverWebSocket : false,
 			retryInterval : 3000
 		};
 		options = ohnet.util.mergeOptions(defaults, opt);
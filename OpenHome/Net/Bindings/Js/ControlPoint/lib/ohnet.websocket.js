@@ -47,14 +47,20 @@ ohnet.websocket = function (clientId,url,options) {
     this.subscriptionTimeoutSeconds = options.subscriptionTimeoutSeconds;
 	
 	this.socket.onerror = options.onSocketError;
-	this.socket.onclose = options.onSocketClose;
+	this.socket.onclose = function (event) {
+		_this.failPendingInvocations("Error:\nstatus: websocket closed");
+		if (options.onSocketClose) { options.onSocketClose(event); }
+	};
 	this.socket.onopen = options.onSocketOpen;
 	
-	this.socket.onmessage = function() {
+	this.socket.onmessage = function(event) {
 		if (_this.debug) { console.log('<< ' + event.data); }
     	_this.receiveMessage(event.data);
 	};
 	
+	this.nextInvocationId = 1;
+	this.pendingInvocations = {}; // callbacks for outstanding invocations, keyed by id
+	
 	this.onReceivePropertyUpdate =  options.onReceivePropertyUpdate;
 	this.onReceiveSubscribeCompleted =  options.onReceiveSubscribeCompleted;
 	this.onReceiveRenewCompleted =  options.onReceiveRenewCompleted;
@@ -88,6 +94,38 @@ ohnet.websocket.prototype.renew = function (subscriptionId) {
 	this.sendMessage(this.renewMessage(subscriptionId));
 }
 
+/**
+* Invokes an action.  Several invocations may be outstanding at once;
+* responses are matched to their callbacks by id.
+* @method invoke
+* @param {String} udn The udn of the device
+* @param {String} serviceName The service name, in the form domain-Type-Version
+* @param {String} action The action to invoke
+* @param {String} args The xml encoded input arguments
+* @param {Function} successFunction The function to execute with the output arguments
+* @param {Function} errorFunction The function to execute if the action fails
+*/
+ohnet.websocket.prototype.invoke = function (udn, serviceName, action, args, successFunction, errorFunction) {
+	var id = this.nextInvocationId++;
+	this.pendingInvocations[id] = { success: successFunction, error: errorFunction };
+	this.sendMessage(this.invokeMessage(id, udn, serviceName, action, args));
+}
+
+/**
+* Reports failure of all outstanding invocations
+* @method failPendingInvocations
+* @param {String} message The error message to pass to each error function
+*/
+ohnet.websocket.prototype.failPendingInvocations = function (message) {
+	var pending = this.pendingInvocations;
+	this.pendingInvocations = {};
+	for (var id in pending) {
+		if (pending.hasOwnProperty(id) && pending[id].error) {
+			pending[id].error(message, null);
+		}
+	}
+}
+
 /**
 * Closes the websocket
 * @method close
@@ -119,6 +157,11 @@ ohnet.websocket.prototype.receiveMessage = function (message) {
         var methodNode = xmlDoc.getElementsByTagNameNS("*", "METHOD"); // NON-IE
         var method = methodNode[0].textContent;
 
+        if (method == "InvokeCompleted" || method == "InvokeFailed") {
+            this.receiveInvokeResponse(method, xmlDoc);
+            return;
+        }
+
         var subscriptionIdNode = xmlDoc.getElementsByTagNameNS("*", "SID"); // NON-IE
         var subscriptionId = subscriptionIdNode[0].textContent;
 
@@ -144,6 +187,37 @@ ohnet.websocket.prototype.receiveMessage = function (message) {
 };
 
 
+/**
+* Passes the result of an invocation to the callbacks registered by invoke
+* @method receiveInvokeResponse
+* @param {String} method InvokeCompleted or InvokeFailed
+* @param {Object} xmlDoc The parsed response
+*/
+ohnet.websocket.prototype.receiveInvokeResponse = function (method, xmlDoc) {
+    var id = xmlDoc.getElementsByTagNameNS("*", "ID")[0].textContent;
+    var pending = this.pendingInvocations[id];
+    if (!pending) {
+        return;
+    }
+    delete this.pendingInvocations[id];
+
+    if (method == "InvokeCompleted") {
+        var outParameters = xmlDoc.getElementsByTagNameNS("*", "ARGS")[0].childNodes;
+        var result = {};
+        for (var i = 0, il = outParameters.length; i < il; i++) {
+            var nodeValue = outParameters[i].textContent;
+            result[outParameters[i].nodeName] = (nodeValue != "" ? nodeValue : null);
+        }
+        if (pending.success) { pending.success(result); }
+    }
+    else if (pending.error) {
+        var errorString = "Error:";
+        errorString += "\nerrorCode: " + xmlDoc.getElementsByTagNameNS("*", "CODE")[0].textContent;
+        errorString += "\nerrorDescription: " + xmlDoc.getElementsByTagNameNS("*", "DESCRIPTION")[0].textContent;
+        pending.error(errorString, null);
+    }
+};
+
 
 /**
 * Generates the subscribe message to register the service's subscription
@@ -202,6 +276,30 @@ ohnet.websocket.prototype.renewMessage = function (subscriptionId) {
     return message;
 };
 
+/**
+* Generates the Invoke message to call an action
+* @method invokeMessage
+* @param {Int} id The id echoed in the response to this invocation
+* @param {String} udn The udn of the device
+* @param {String} serviceName The service name, in the form domain-Type-Version
+* @param {String} action The action to invoke
+* @param {String} args The xml encoded input arguments
+* @return {String} The invoke message to be sent to the ohnet service 
+*/
+ohnet.websocket.prototype.invokeMessage = function (id, udn, serviceName, action, args) {
+
+    var message = "<?xml version='1.0' ?>";
+    message += "<ROOT>";
+    message += "<METHOD>Invoke</METHOD>";
+    message += "<ID>" + id + "</ID>";
+    message += "<UDN>" + udn + "</UDN>";
+    message += "<SERVICE>" + serviceName + "</SERVICE>";
+    message += "<ACTION>" + action + "</ACTION>";
+    message += "<ARGS>" + args + "</ARGS>";
+    message += "</ROOT>";
+    return message;
+};
+
 /**
 * Generates the Get property Updates message used for long polling
 * @method getPropertyUpdatesMessage
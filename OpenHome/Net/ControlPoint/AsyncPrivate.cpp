@@ -21,16 +21,27 @@ void SyncProxyAction::Wait()
     }
 }
 
+TBool SyncProxyAction::IsSynchronous(const FunctorAsync& aFunctor)
+{ // static
+    // Functor() always wraps the same static function so can be recognised by its callback
+    return (aFunctor.iCallback == &SyncProxyAction::CompletedCallback);
+}
+
 SyncProxyAction::SyncProxyAction()
     : iSem("SYNC", 0)
 {
-    iFunctor = MakeFunctorAsync(*this, &SyncProxyAction::Completed);
+    iFunctor = MakeFunctorAsync(this, &SyncProxyAction::CompletedCallback);
 }
 
 SyncProxyAction::~SyncProxyAction()
 {
 }
 
+void STDCALL SyncProxyAction::CompletedCallback(void* aPtr, IAsync* aAsync)
+{ // static
+    reinterpret_cast<SyncProxyAction*>(aPtr)->Completed(*aAsync);
+}
+
 void SyncProxyAction::Completed(IAsync& aAsync)
 {
     AutoSemaphoreSignal sem(iSem);
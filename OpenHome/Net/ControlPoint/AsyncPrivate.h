@@ -26,11 +26,17 @@ class DllExportClass SyncProxyAction
 public:
     DllExport FunctorAsync& Functor();
     DllExport void Wait();
+    /**
+     * Returns true if aFunctor was returned by Functor().  Its caller will block in
+     * Wait() until the invocation completes.
+     */
+    static TBool IsSynchronous(const FunctorAsync& aFunctor);
 protected:
     DllExport SyncProxyAction();
     DllExport virtual ~SyncProxyAction();
     virtual void CompleteRequest(IAsync& aAsync) = 0;
 private:
+    static void STDCALL CompletedCallback(void* aPtr, IAsync* aAsync);
     void Completed(IAsync& aAsync);
 private:
     Semaphore iSem;
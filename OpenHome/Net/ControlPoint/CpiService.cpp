@@ -8,9 +8,12 @@
 #include <OpenHome/Net/Core/CpProxy.h>
 #include <OpenHome/Net/Private/Error.h>
 #include <OpenHome/Net/Private/CpiSubscription.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -133,11 +136,18 @@ void CpiService::ListObjectDetails() const
 
 const OpenHome::Net::Parameter& Argument::Parameter() const
 {
-    return iParameter;
+    return *iParameter;
+}
+
+Argument::Argument()
+    : iParameter(NULL)
+    , iRecycled(true)
+{
 }
 
 Argument::Argument(const OpenHome::Net::Parameter& aParameter)
-    : iParameter(aParameter)
+    : iParameter(&aParameter)
+    , iRecycled(false)
 {
 }
 
@@ -158,21 +168,19 @@ void Argument::ValidationFailed(const OpenHome::Net::Parameter& aParameter)
 
 ArgumentString::ArgumentString(const OpenHome::Net::Parameter& aParameter)
     : Argument(aParameter)
+    , iInput(false)
 {
 }
 
 ArgumentString::ArgumentString(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
     : Argument(aParameter)
 {
-    try {
-        aParameter.ValidateString(aValue);
-        if (aValue.Bytes() > 0) {
-            iValue.Set(aValue);
-        }
-    }
-    catch (ParameterValidationError&) {
-        ValidationFailed(aParameter);
-    }
+    SetInput(aParameter, aValue);
+}
+
+ArgumentString::ArgumentString()
+    : iInput(false)
+{
 }
 
 ArgumentString::~ArgumentString()
@@ -181,6 +189,9 @@ ArgumentString::~ArgumentString()
 
 const Brx& ArgumentString::Value() const
 {
+    if (iInput) {
+        return iInputValue;
+    }
     return iValue;
 }
 
@@ -191,13 +202,40 @@ void ArgumentString::TransferTo(Brh& aBrh)
 
 void ArgumentString::ProcessInput(IInputArgumentProcessor& aProcessor)
 {
-    aProcessor.ProcessString(iValue);
+    aProcessor.ProcessString(iInputValue);
 }
 
 void ArgumentString::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer)
 {
     aProcessor.ProcessString(aBuffer, iValue);
-    iParameter.ValidateString(iValue);
+    iParameter->ValidateString(iValue);
+}
+
+void ArgumentString::SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
+{
+    iParameter = &aParameter;
+    iInput = true;
+    try {
+        aParameter.ValidateString(aValue);
+        if (aValue.Bytes() + 1 > iInputValue.MaxBytes()) {
+            iInputValue.Grow(aValue.Bytes() + 1);
+        }
+        iInputValue.Replace(aValue);
+        (void)iInputValue.PtrZ();
+    }
+    catch (ParameterValidationError&) {
+        ValidationFailed(aParameter);
+    }
+}
+
+void ArgumentString::SetOutput(const OpenHome::Net::Parameter& aParameter)
+{
+    iParameter = &aParameter;
+    iInput = false;
+    if (iValue.Bytes() > 0) { // previous client didn't claim its output
+        Brh discard;
+        iValue.TransferTo(discard);
+    }
 }
 
 
@@ -211,14 +249,13 @@ ArgumentInt::ArgumentInt(const OpenHome::Net::Parameter& aParameter)
 
 ArgumentInt::ArgumentInt(const OpenHome::Net::Parameter& aParameter, TInt aValue)
     : Argument(aParameter)
-    , iValue(aValue)
 {
-    try {
-        aParameter.ValidateInt(aValue);
-    }
-    catch (ParameterValidationError&) {
-        ValidationFailed(aParameter);
-    }
+    SetInput(aParameter, aValue);
+}
+
+ArgumentInt::ArgumentInt()
+    : iValue(0)
+{
 }
 
 ArgumentInt::~ArgumentInt()
@@ -238,7 +275,25 @@ void ArgumentInt::ProcessInput(IInputArgumentProcessor& aProcessor)
 void ArgumentInt::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer)
 {
     aProcessor.ProcessInt(aBuffer, iValue);
-    iParameter.ValidateInt(iValue);
+    iParameter->ValidateInt(iValue);
+}
+
+void ArgumentInt::SetInput(const OpenHome::Net::Parameter& aParameter, TInt aValue)
+{
+    iParameter = &aParameter;
+    iValue = aValue;
+    try {
+        aParameter.ValidateInt(aValue);
+    }
+    catch (ParameterValidationError&) {
+        ValidationFailed(aParameter);
+    }
+}
+
+void ArgumentInt::SetOutput(const OpenHome::Net::Parameter& aParameter)
+{
+    iParameter = &aParameter;
+    iValue = 0;
 }
 
 
@@ -252,14 +307,13 @@ ArgumentUint::ArgumentUint(const OpenHome::Net::Parameter& aParameter)
 
 ArgumentUint::ArgumentUint(const OpenHome::Net::Parameter& aParameter, TUint aValue)
     : Argument(aParameter)
-    , iValue(aValue)
 {
-    try {
-        aParameter.ValidateUint(aValue);
-    }
-    catch (ParameterValidationError&) {
-        ValidationFailed(aParameter);
-    }
+    SetInput(aParameter, aValue);
+}
+
+ArgumentUint::ArgumentUint()
+    : iValue(0)
+{
 }
 
 ArgumentUint::~ArgumentUint()
@@ -279,7 +333,25 @@ void ArgumentUint::ProcessInput(IInputArgumentProcessor& aProcessor)
 void ArgumentUint::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer)
 {
     aProcessor.ProcessUint(aBuffer, iValue);
-    iParameter.ValidateUint(iValue);
+    iParameter->ValidateUint(iValue);
+}
+
+void ArgumentUint::SetInput(const OpenHome::Net::Parameter& aParameter, TUint aValue)
+{
+    iParameter = &aParameter;
+    iValue = aValue;
+    try {
+        aParameter.ValidateUint(aValue);
+    }
+    catch (ParameterValidationError&) {
+        ValidationFailed(aParameter);
+    }
+}
+
+void ArgumentUint::SetOutput(const OpenHome::Net::Parameter& aParameter)
+{
+    iParameter = &aParameter;
+    iValue = 0;
 }
 
 
@@ -293,14 +365,13 @@ ArgumentBool::ArgumentBool(const OpenHome::Net::Parameter& aParameter)
 
 ArgumentBool::ArgumentBool(const OpenHome::Net::Parameter& aParameter, TBool aValue)
     : Argument(aParameter)
-    , iValue(aValue)
 {
-    try {
-        aParameter.ValidateBool(aValue);
-    }
-    catch (ParameterValidationError&) {
-        ValidationFailed(aParameter);
-    }
+    SetInput(aParameter, aValue);
+}
+
+ArgumentBool::ArgumentBool()
+    : iValue(false)
+{
 }
 
 ArgumentBool::~ArgumentBool()
@@ -320,7 +391,25 @@ void ArgumentBool::ProcessInput(IInputArgumentProcessor& aProcessor)
 void ArgumentBool::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer)
 {
     aProcessor.ProcessBool(aBuffer, iValue);
-    iParameter.ValidateBool(iValue);
+    iParameter->ValidateBool(iValue);
+}
+
+void ArgumentBool::SetInput(const OpenHome::Net::Parameter& aParameter, TBool aValue)
+{
+    iParameter = &aParameter;
+    iValue = aValue;
+    try {
+        aParameter.ValidateBool(aValue);
+    }
+    catch (ParameterValidationError&) {
+        ValidationFailed(aParameter);
+    }
+}
+
+void ArgumentBool::SetOutput(const OpenHome::Net::Parameter& aParameter)
+{
+    iParameter = &aParameter;
+    iValue = false;
 }
 
 
@@ -328,21 +417,19 @@ void ArgumentBool::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffe
 
 ArgumentBinary::ArgumentBinary(const OpenHome::Net::Parameter& aParameter)
     : Argument(aParameter)
+    , iInput(false)
 {
 }
 
 ArgumentBinary::ArgumentBinary(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
     : Argument(aParameter)
 {
-    try {
-        aParameter.ValidateBinary(aValue);
-        if (aValue.Bytes() > 0) {
-            iValue.Set(aValue);
-        }
-    }
-    catch (ParameterValidationError&) {
-        ValidationFailed(aParameter);
-    }
+    SetInput(aParameter, aValue);
+}
+
+ArgumentBinary::ArgumentBinary()
+    : iInput(false)
+{
 }
 
 ArgumentBinary::~ArgumentBinary()
@@ -351,6 +438,9 @@ ArgumentBinary::~ArgumentBinary()
 
 const Brx& ArgumentBinary::Value() const
 {
+    if (iInput) {
+        return iInputValue;
+    }
     return iValue;
 }
 
@@ -361,13 +451,39 @@ void ArgumentBinary::TransferTo(Brh& aBrh)
 
 void ArgumentBinary::ProcessInput(IInputArgumentProcessor& aProcessor)
 {
-    aProcessor.ProcessBinary(iValue);
+    aProcessor.ProcessBinary(iInputValue);
 }
 
 void ArgumentBinary::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer)
 {
     aProcessor.ProcessBinary(aBuffer, iValue);
-    iParameter.ValidateBinary(iValue);
+    iParameter->ValidateBinary(iValue);
+}
+
+void ArgumentBinary::SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
+{
+    iParameter = &aParameter;
+    iInput = true;
+    try {
+        aParameter.ValidateBinary(aValue);
+        if (aValue.Bytes() > iInputValue.MaxBytes()) {
+            iInputValue.Grow(aValue.Bytes());
+        }
+        iInputValue.Replace(aValue);
+    }
+    catch (ParameterValidationError&) {
+        ValidationFailed(aParameter);
+    }
+}
+
+void ArgumentBinary::SetOutput(const OpenHome::Net::Parameter& aParameter)
+{
+    iParameter = &aParameter;
+    iInput = false;
+    if (iValue.Bytes() > 0) { // previous client didn't claim its output
+        Brh discard;
+        iValue.TransferTo(discard);
+    }
 }
 
 
@@ -375,6 +491,10 @@ void ArgumentBinary::ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuf
 
 void OpenHome::Net::Invocation::SignalCompleted()
 {
+    // a suspended invocation's device resources (e.g. its connection) are released before
+    // the client callback, as they would have been had it not been suspended
+    delete iContinuation;
+    iContinuation = NULL;
     iCompleted = !Error();
     // log completion before running the client callback as that may transfer the content of ArgumentStrings
     if (iCompleted) {
@@ -428,6 +548,7 @@ void OpenHome::Net::Invocation::Set(CpiService& aService, const OpenHome::Net::A
     iDevice = &aDevice;
     iFunctor = aFunctor;
     iSequenceNumber = iCpStack.Env().SequenceNumber();
+    ReserveArguments(aAction);
 }
 
 void OpenHome::Net::Invocation::AddInput(Argument* aArgument)
@@ -440,6 +561,76 @@ void OpenHome::Net::Invocation::AddOutput(Argument* aArgument)
     iOutput.push_back(aArgument);
 }
 
+void OpenHome::Net::Invocation::AddInputString(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
+{
+    ArgumentString& arg = iStrings.Next();
+    arg.SetInput(aParameter, aValue);
+    iInput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddInputInt(const OpenHome::Net::Parameter& aParameter, TInt aValue)
+{
+    ArgumentInt& arg = iInts.Next();
+    arg.SetInput(aParameter, aValue);
+    iInput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddInputUint(const OpenHome::Net::Parameter& aParameter, TUint aValue)
+{
+    ArgumentUint& arg = iUints.Next();
+    arg.SetInput(aParameter, aValue);
+    iInput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddInputBool(const OpenHome::Net::Parameter& aParameter, TBool aValue)
+{
+    ArgumentBool& arg = iBools.Next();
+    arg.SetInput(aParameter, aValue);
+    iInput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddInputBinary(const OpenHome::Net::Parameter& aParameter, const Brx& aValue)
+{
+    ArgumentBinary& arg = iBinaries.Next();
+    arg.SetInput(aParameter, aValue);
+    iInput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddOutputString(const OpenHome::Net::Parameter& aParameter)
+{
+    ArgumentString& arg = iStrings.Next();
+    arg.SetOutput(aParameter);
+    iOutput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddOutputInt(const OpenHome::Net::Parameter& aParameter)
+{
+    ArgumentInt& arg = iInts.Next();
+    arg.SetOutput(aParameter);
+    iOutput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddOutputUint(const OpenHome::Net::Parameter& aParameter)
+{
+    ArgumentUint& arg = iUints.Next();
+    arg.SetOutput(aParameter);
+    iOutput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddOutputBool(const OpenHome::Net::Parameter& aParameter)
+{
+    ArgumentBool& arg = iBools.Next();
+    arg.SetOutput(aParameter);
+    iOutput.push_back(&arg);
+}
+
+void OpenHome::Net::Invocation::AddOutputBinary(const OpenHome::Net::Parameter& aParameter)
+{
+    ArgumentBinary& arg = iBinaries.Next();
+    arg.SetOutput(aParameter);
+    iOutput.push_back(&arg);
+}
+
 void OpenHome::Net::Invocation::SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription)
 {
     /* If an error is set repeatedly, assume that the first setter will have had
@@ -458,13 +649,28 @@ void OpenHome::Net::Invocation::SetInterruptHandler(IInterruptHandler* aHandler)
     }
 }
 
-void OpenHome::Net::Invocation::Interrupt(const Service& aService)
+TBool OpenHome::Net::Invocation::Interrupt(const Service& aService)
 {
     AutoMutex a(iLock);
     if (iService == &aService && iInterruptHandler != NULL) {
         SetError(Error::eAsync, Error::eCodeInterrupted, Error::kDescriptionAsyncInterrupted);
         iInterruptHandler->Interrupt();
+        return true;
     }
+    return false;
+}
+
+void OpenHome::Net::Invocation::Suspend(Socket& aSocket, TUint aTimeoutMs, IInvocationContinuation& aContinuation)
+{
+    ASSERT(iContinuation == NULL || iContinuation == &aContinuation);
+    iContinuation = &aContinuation;
+    iSuspendSocket = &aSocket;
+    iSuspendTimeoutMs = aTimeoutMs;
+}
+
+TBool OpenHome::Net::Invocation::Suspended() const
+{
+    return (iSuspendSocket != NULL);
 }
 
 const OpenHome::Net::ServiceType& OpenHome::Net::Invocation::ServiceType() const
@@ -596,6 +802,10 @@ OpenHome::Net::Invocation::Invocation(CpStack& aCpStack, Fifo<OpenHome::Net::Inv
     , iDevice(NULL)
     , iCompleted(false)
     , iInterruptHandler(NULL)
+    , iContinuation(NULL)
+    , iSuspendSocket(NULL)
+    , iSuspendTimeoutMs(0)
+    , iTimedOut(false)
 {
 }
 
@@ -603,6 +813,47 @@ OpenHome::Net::Invocation::~Invocation()
 {
 }
 
+OpenHome::Net::Parameter::EType OpenHome::Net::Invocation::ArgumentType(const OpenHome::Net::Parameter& aParameter)
+{ // static
+    if (aParameter.Type() == OpenHome::Net::Parameter::eTypeRelated) {
+        return ((const ParameterRelated&)aParameter).Related().Parameter().Type();
+    }
+    return aParameter.Type();
+}
+
+void OpenHome::Net::Invocation::ReserveArguments(const OpenHome::Net::Action& aAction)
+{
+    const Action::VectorParameters& inParams = aAction.InputParameters();
+    const Action::VectorParameters& outParams = aAction.OutputParameters();
+    TUint counts[Parameter::eTypeRelated] = { 0 };
+    TUint i;
+    for (i=0; i<inParams.size(); i++) {
+        counts[ArgumentType(*inParams[i])]++;
+    }
+    for (i=0; i<outParams.size(); i++) {
+        counts[ArgumentType(*outParams[i])]++;
+    }
+    iStrings.Reserve(counts[Parameter::eTypeString]);
+    iInts.Reserve(counts[Parameter::eTypeInt]);
+    iUints.Reserve(counts[Parameter::eTypeUint]);
+    iBools.Reserve(counts[Parameter::eTypeBool]);
+    iBinaries.Reserve(counts[Parameter::eTypeBinary]);
+    iInput.reserve(inParams.size());
+    iOutput.reserve(outParams.size());
+}
+
+TBool OpenHome::Net::Invocation::Continue()
+{
+    if (iContinuation == NULL) {
+        return false;
+    }
+    const TBool timedOut = iTimedOut;
+    iSuspendSocket = NULL;
+    iTimedOut = false;
+    iContinuation->Continue(timedOut);
+    return true;
+}
+
 void OpenHome::Net::Invocation::Clear()
 {
     LOG(kService, "Invocation::Clear for %p\n", this);
@@ -613,25 +864,36 @@ void OpenHome::Net::Invocation::Clear()
     iFunctor = FunctorAsync();
     TUint i;
     for (i=0; i<iInput.size(); i++) {
-        delete iInput[i];
+        if (!iInput[i]->iRecycled) {
+            delete iInput[i];
+        }
     }
     iInput.clear();
     for (i=0; i<iOutput.size(); i++) {
-        delete iOutput[i];
+        if (!iOutput[i]->iRecycled) {
+            delete iOutput[i];
+        }
     }
     iOutput.clear();
+    iStrings.Reset();
+    iInts.Reset();
+    iUints.Reset();
+    iBools.Reset();
+    iBinaries.Reset();
     iError.Clear();
     iCompleted = false;
     iInterruptHandler = NULL;
+    iSuspendSocket = NULL;
+    iTimedOut = false;
     iLock.Signal();
 }
 
 
 // Invoker
 
-Invoker::Invoker(const TChar* aName, Fifo<Invoker*>& aFree)
+Invoker::Invoker(const TChar* aName, InvocationManager& aManager)
     : Thread(aName)
-    , iFree(aFree)
+    , iManager(aManager)
     , iInvocation(NULL)
     , iLock("MVOK")
 {
@@ -655,64 +917,246 @@ void Invoker::Interrupt(const Service& aService)
 {
     AutoMutex a(iLock);
     if (iInvocation != NULL) {
-        iInvocation->Interrupt(aService);
+        (void)iInvocation->Interrupt(aService);
     }
 }
 
-void Invoker::SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr)
-{
-    iInvocation->SetError(aLevel, aCode, aDescription);
+TBool Invoker::InvokeAction(Invocation& aInvocation, TBool aCanSuspend)
+{ // static
+    TBool suspended = false;
+    try {
+        const Brx& actionName = aInvocation.Action().Name();
+        LOG(kService, "Invoker::InvokeAction (%.*s %p), action %.*s, device %.*s\n",
+                      PBUF(Thread::CurrentThreadName()), &aInvocation, PBUF(actionName), PBUF(aInvocation.Udn()));
+        if (!aInvocation.Continue()) {
+            aInvocation.Invoker().InvokeAction(aInvocation);
+        }
+        while (aInvocation.Suspended() && !aCanSuspend) {
+            // nothing to watch suspended invocations so wait for their response on this thread
+            (void)aInvocation.Continue();
+        }
+        suspended = aInvocation.Suspended();
+    }
+    catch (HttpError&) {
+        SetError(aInvocation, Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Http");
+    }
+    catch (UriError&) {
+        SetError(aInvocation, Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Uri");
+    }
+    catch (NetworkError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Network");
+    }
+    catch (NetworkTimeout&) {
+        SetError(aInvocation, Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout, "NetworkTimeout");
+    }
+    catch (ReaderError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Reader");
+    }
+    catch (WriterError&) {
+        SetError(aInvocation, Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Writer");
+    }
+    catch (ParameterValidationError&) {
+        SetError(aInvocation, Error::eService, Error::eCodeParameterInvalid, Error::kDescriptionParameterInvalid, "Parameter");
+    }
+    return suspended;
+}
+
+void Invoker::SetError(Invocation& aInvocation, Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr)
+{ // static
+    aInvocation.SetError(aLevel, aCode, aDescription);
     // the above error details might be ignored if an earlier (presumed more detailed) error had been set
     Error::ELevel level = Error::eNone;
     TUint code = 0;
     const TChar* desc = NULL;
-    (void)iInvocation->Error(level, code, desc);
-    const Brx& actionName = iInvocation->Action().Name();
-    const Brx& udn = iInvocation->Device().Udn();
+    (void)aInvocation.Error(level, code, desc);
+    const Brx& actionName = aInvocation.Action().Name();
+    const Brx& udn = aInvocation.Device().Udn();
     LOG_ERROR(kService, "Error - %s(%s, %d, %s) - from invocation %p, on action %.*s, from device %.*s\n",
-        aLogStr, Error::LevelName(level), code, (desc==NULL? "" : desc), iInvocation, PBUF(actionName), PBUF(udn));
+        aLogStr, Error::LevelName(level), code, (desc==NULL? "" : desc), &aInvocation, PBUF(actionName), PBUF(udn));
 }
 
 void Invoker::Run()
 {
     for (;;) {
         Wait();
-        try {
-            const Brx& actionName = iInvocation->Action().Name();
-            LOG(kService, "Invoker::Run (%s %p), action %.*s, device %.*s\n",
-                          (const TChar*)Name().Ptr(), iInvocation, PBUF(actionName), PBUF(iInvocation->Udn()));
-            iInvocation->Invoker().InvokeAction(*iInvocation);
+        // only used to identify the device; it may have been deleted once the invocation completes
+        CpiDevice* device = &iInvocation->Device();
+        const TBool suspended = InvokeAction(*iInvocation, iManager.CanSuspend());
+        iLock.Wait();
+        Invocation* invocation = iInvocation;
+        iInvocation = NULL;
+        if (!suspended) {
+            invocation->SignalCompleted();
+            invocation = NULL;
         }
-        catch (HttpError&) {
-            SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Http");
+        iLock.Signal();
+        iManager.InvokerFree(*this, device, invocation);
+    }
+}
+
+
+// InvocationPoller
+
+InvocationPoller::InvocationPoller(Environment& aEnv, InvocationManager& aManager)
+    : Thread("InvocationPoller")
+    , iEnv(aEnv)
+    , iManager(aManager)
+    , iLock("INVP")
+    , iNextId(0)
+    , iStopping(false)
+{
+    iPoller = OpenHome::Os::NetworkPollerCreate(aEnv.OsCtx());
+    if (iPoller == kHandleNull) {
+        LOG(kService, "InvocationPoller - polling not supported, invocations will block their invoker\n");
+    }
+    Start();
+}
+
+InvocationPoller::~InvocationPoller()
+{
+    iLock.Wait();
+    iStopping = true;
+    if (iPoller != kHandleNull) {
+        OpenHome::Os::NetworkPollerInterrupt(iPoller, true);
+    }
+    iLock.Signal();
+    Join();
+    if (iPoller != kHandleNull) {
+        OpenHome::Os::NetworkPollerDestroy(iPoller);
+    }
+}
+
+TBool InvocationPoller::Enabled() const
+{
+    return (iPoller != kHandleNull);
+}
+
+void InvocationPoller::Park(OpenHome::Net::Invocation& aInvocation)
+{
+    TBool parked = false;
+    iLock.Wait();
+    /* Don't park an invocation whose service is being deleted.  Its socket may already have
+       been interrupted, which wouldn't wake the poller, and Interrupt() may have been called. */
+    if (!iStopping && !aInvocation.Interrupt()) {
+        const TUint id = iNextId++;
+        const TUint expiryMs = Time::Now(iEnv) + aInvocation.iSuspendTimeoutMs;
+        ParkedList::iterator pos = iParked.end();
+        while (pos != iParked.begin()) {
+            ParkedList::iterator prev = pos;
+            if ((TInt)(expiryMs - (--prev)->iExpiryMs) >= 0) {
+                break;
+            }
+            pos = prev;
         }
-        catch (UriError&) {
-            SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown, "Uri");
+        ParkedList::iterator it = iParked.insert(pos, ParkedInvocation(id, aInvocation, expiryMs));
+        iParkedById.insert(std::pair<TUint, ParkedList::iterator>(id, it));
+        if (aInvocation.iSuspendSocket->AddToPoller(iPoller, id)) {
+            parked = true;
+            if (it == iParked.begin()) {
+                OpenHome::Os::NetworkPollerInterrupt(iPoller, true); // recalculate poll timeout
+            }
         }
-        catch (NetworkError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Network");
+        else {
+            LOG_ERROR(kService, "InvocationPoller::Park - failed to poll socket for invocation %p\n", &aInvocation);
+            iParkedById.erase(id);
+            iParked.erase(it);
         }
-        catch (NetworkTimeout&) {
-            SetError(Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout, "NetworkTimeout");
+    }
+    iLock.Signal();
+    if (!parked) {
+        iManager.Resume(aInvocation, false);
+    }
+}
+
+void InvocationPoller::Interrupt(const Service& aService)
+{
+    std::vector<OpenHome::Net::Invocation*> interrupted;
+    iLock.Wait();
+    ParkedList::iterator it = iParked.begin();
+    while (it != iParked.end()) {
+        if (!it->iInvocation->Interrupt(aService)) {
+            ++it;
         }
-        catch (ReaderError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Reader");
+        else {
+            it->iInvocation->iSuspendSocket->RemoveFromPoller(iPoller);
+            interrupted.push_back(it->iInvocation);
+            iParkedById.erase(it->iId);
+            it = iParked.erase(it);
         }
-        catch (WriterError&) {
-            SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown, "Writer");
+    }
+    iLock.Signal();
+    for (TUint i=0; i<(TUint)interrupted.size(); i++) {
+        iManager.Resume(*interrupted[i], false);
+    }
+}
+
+void InvocationPoller::Run()
+{
+    if (iPoller == kHandleNull) {
+        return;
+    }
+    TUint32 ids[kMaxPollIds];
+    std::vector<OpenHome::Net::Invocation*> expired;
+    std::vector<OpenHome::Net::Invocation*> ready;
+    for (;;) {
+        TUint timeoutMs = 0; // wait indefinitely
+        iLock.Wait();
+        const TUint now = Time::Now(iEnv);
+        while (iParked.size() > 0 && (TInt)(iParked.front().iExpiryMs - now) <= 0) {
+            ParkedInvocation& parked = iParked.front();
+            parked.iInvocation->iSuspendSocket->RemoveFromPoller(iPoller);
+            expired.push_back(parked.iInvocation);
+            iParkedById.erase(parked.iId);
+            iParked.pop_front();
         }
-        catch (ParameterValidationError&) {
-            SetError(Error::eService, Error::eCodeParameterInvalid, Error::kDescriptionParameterInvalid, "Parameter");
+        if (iParked.size() > 0) {
+            timeoutMs = iParked.front().iExpiryMs - now;
         }
+        iLock.Signal();
+        for (TUint i=0; i<(TUint)expired.size(); i++) {
+            iManager.Resume(*expired[i], true);
+        }
+        expired.clear();
+
+        const TInt count = OpenHome::Os::NetworkPollerWait(iPoller, ids, kMaxPollIds, timeoutMs);
         iLock.Wait();
-        iInvocation->SignalCompleted();
-        iInvocation = NULL;
+        if (count < 0) {
+            if (iStopping) {
+                iLock.Signal();
+                return;
+            }
+            OpenHome::Os::NetworkPollerInterrupt(iPoller, false);
+        }
+        for (TInt i=0; i<count; i++) {
+            std::map<TUint, ParkedList::iterator>::iterator it = iParkedById.find(ids[i]);
+            if (it == iParkedById.end()) {
+                continue; // interrupted since the poller reported it
+            }
+            OpenHome::Net::Invocation* invocation = it->second->iInvocation;
+            invocation->iSuspendSocket->RemoveFromPoller(iPoller);
+            ready.push_back(invocation);
+            iParked.erase(it->second);
+            iParkedById.erase(it);
+        }
         iLock.Signal();
-        iFree.Write(this);
+        for (TUint i=0; i<(TUint)ready.size(); i++) {
+            iManager.Resume(*ready[i], false);
+        }
+        ready.clear();
     }
 }
 
 
+// InvocationPoller::ParkedInvocation
+
+InvocationPoller::ParkedInvocation::ParkedInvocation(TUint aId, OpenHome::Net::Invocation& aInvocation, TUint aExpiryMs)
+    : iId(aId)
+    , iInvocation(&aInvocation)
+    , iExpiryMs(aExpiryMs)
+{
+}
+
+
 // InvocationManager
 
 InvocationManager::InvocationManager(CpStack& aCpStack)
@@ -721,22 +1165,38 @@ InvocationManager::InvocationManager(CpStack& aCpStack)
     , iLock("INVM")
     , iFreeInvocations(aCpStack.Env().InitParams()->NumInvocations())
     , iWaitingInvocations(aCpStack.Env().InitParams()->NumInvocations())
-    , iFreeInvokers(aCpStack.Env().InitParams()->NumActionInvokerThreads())
-{
+    , iLockQueues("INVQ")
+    , iPoller(NULL)
+{
+    InitialisationParams* initParams = iCpStack.Env().InitParams();
+    const TUint numInvokers = initParams->NumActionInvokerThreads();
+    iMaxInvokersPerDevice = initParams->CpMaxInvokersPerDevice();
+    if (iMaxInvokersPerDevice == 0 || iMaxInvokersPerDevice > numInvokers) {
+        iMaxInvokersPerDevice = numInvokers;
+    }
     TUint i;
-    iInvokers = (Invoker**)malloc(sizeof(*iInvokers) * iCpStack.Env().InitParams()->NumActionInvokerThreads());
-    for (i=0; i<iCpStack.Env().InitParams()->NumActionInvokerThreads(); i++) {
+    iInvokers = (Invoker**)malloc(sizeof(*iInvokers) * numInvokers);
+    iFreeInvokers.reserve(numInvokers);
+    for (i=0; i<numInvokers; i++) {
         Bws<Thread::kMaxNameBytes+1> thName;
         thName.AppendPrintf("ActionInvoker %d", i);
         thName.PtrZ();
-        iInvokers[i] = new Invoker((const TChar*)thName.Ptr(), iFreeInvokers);
-        iFreeInvokers.Write(iInvokers[i]);
+        iInvokers[i] = new Invoker((const TChar*)thName.Ptr(), *this);
+        iFreeInvokers.push_back(iInvokers[i]);
         iInvokers[i]->Start();
     }
 
-    for (i=0; i<iCpStack.Env().InitParams()->NumInvocations(); i++) {
+    for (i=0; i<initParams->NumInvocations(); i++) {
         iFreeInvocations.Write(new OpenHome::Net::Invocation(iCpStack, iFreeInvocations));
     }
+    iCallerThreadInvocations.reserve(initParams->NumInvocations());
+    if (initParams->CpInvocationPolling()) {
+        iPoller = new InvocationPoller(iCpStack.Env(), *this);
+        if (!iPoller->Enabled()) {
+            delete iPoller;
+            iPoller = NULL;
+        }
+    }
     iActive = true;
     Start();
 }
@@ -747,7 +1207,6 @@ InvocationManager::~InvocationManager()
     iActive = false;
     iLock.Signal();
 
-    iFreeInvokers.ReadInterrupt();
     Kill();
     Join();
 
@@ -756,6 +1215,7 @@ InvocationManager::~InvocationManager()
         delete iInvokers[i];
     }
     free(iInvokers);
+    delete iPoller;
 
     for (i=0; i<iCpStack.Env().InitParams()->NumInvocations(); i++) {
         OpenHome::Net::Invocation* invocation = iFreeInvocations.Read();
@@ -778,26 +1238,155 @@ void InvocationManager::Invoke(OpenHome::Net::Invocation* aInvocation)
     if (asyncBeginHandler) {
         asyncBeginHandler(*aInvocation);
     }
+    if (iCpStack.Env().InitParams()->CpSyncInvocationsOnCallerThread() &&
+        SyncProxyAction::IsSynchronous(aInvocation->iFunctor)) {
+        InvokeOnCallerThread(*aInvocation);
+        return;
+    }
     iWaitingInvocations.Write(aInvocation);
     Signal();
 }
 
+void InvocationManager::InvokeOnCallerThread(OpenHome::Net::Invocation& aInvocation)
+{
+    /* The caller would otherwise block until an invoker completes aInvocation, so skip
+       the hand-offs to this thread and an invoker and run it here instead */
+    if (aInvocation.Interrupt()) {
+        aInvocation.SetError(Error::eAsync,
+                             Error::eCodeInterrupted,
+                             Error::kDescriptionAsyncInterrupted);
+    }
+    else {
+        iLockQueues.Wait();
+        iCallerThreadInvocations.push_back(&aInvocation);
+        iLockQueues.Signal();
+        (void)Invoker::InvokeAction(aInvocation, false);
+        iLockQueues.Wait();
+        std::vector<OpenHome::Net::Invocation*>::iterator it =
+            std::find(iCallerThreadInvocations.begin(), iCallerThreadInvocations.end(), &aInvocation);
+        iCallerThreadInvocations.erase(it);
+        iLockQueues.Signal();
+    }
+    aInvocation.SignalCompleted();
+}
+
 void InvocationManager::Interrupt(const Service& aService)
 {
     const TUint numThreads = iCpStack.Env().InitParams()->NumActionInvokerThreads();
     for (TUint i=0; i<numThreads; i++) {
         iInvokers[i]->Interrupt(aService);
     }
+    if (iPoller != NULL) {
+        iPoller->Interrupt(aService);
+    }
+    AutoMutex _(iLockQueues);
+    for (TUint i=0; i<(TUint)iCallerThreadInvocations.size(); i++) {
+        (void)iCallerThreadInvocations[i]->Interrupt(aService);
+    }
+}
+
+TBool InvocationManager::CanSuspend() const
+{
+    return (iPoller != NULL);
+}
+
+void InvocationManager::InvokerFree(Invoker& aInvoker, CpiDevice* aDevice, OpenHome::Net::Invocation* aSuspended)
+{
+    iLockQueues.Wait();
+    std::map<CpiDevice*, DeviceInvocations>::iterator it = iDevices.find(aDevice);
+    ASSERT(it != iDevices.end());
+    DeviceInvocations& device = it->second;
+    device.iActive--;
+    if (device.iActive == 0 && device.iWaiting.empty()) {
+        iDevices.erase(it);
+    }
+    iFreeInvokers.push_back(&aInvoker);
+    iLockQueues.Signal();
+    if (aSuspended != NULL) {
+        iPoller->Park(*aSuspended);
+    }
+    Signal();
+}
+
+void InvocationManager::Resume(OpenHome::Net::Invocation& aInvocation, TBool aTimedOut)
+{
+    aInvocation.iTimedOut = aTimedOut;
+    iLockQueues.Wait();
+    QueueLocked(aInvocation, true);
+    iLockQueues.Signal();
+    Signal();
+}
+
+void InvocationManager::QueueLocked(OpenHome::Net::Invocation& aInvocation, TBool aFront)
+{
+    CpiDevice* device = &aInvocation.Device();
+    DeviceInvocations& queue = iDevices[device];
+    if (queue.iWaiting.empty()) {
+        iReadyDevices.push_back(device);
+    }
+    if (aFront) {
+        queue.iWaiting.push_front(&aInvocation);
+    }
+    else {
+        queue.iWaiting.push_back(&aInvocation);
+    }
+}
+
+OpenHome::Net::Invocation* InvocationManager::NextLocked()
+{
+    std::list<CpiDevice*>::iterator it;
+    for (it=iReadyDevices.begin(); it!=iReadyDevices.end(); ++it) {
+        CpiDevice* device = *it;
+        DeviceInvocations& queue = iDevices[device];
+        if (queue.iActive >= iMaxInvokersPerDevice) {
+            continue;
+        }
+        OpenHome::Net::Invocation* invocation = queue.iWaiting.front();
+        queue.iWaiting.pop_front();
+        iReadyDevices.erase(it);
+        if (!queue.iWaiting.empty()) {
+            iReadyDevices.push_back(device); // give other devices a turn before this one's next invocation
+        }
+        return invocation;
+    }
+    return NULL;
 }
 
 void InvocationManager::Run()
 {
     for (;;) {
         Wait();
-        OpenHome::Net::Invocation* invocation = NULL;
-        try {
-            invocation = iWaitingInvocations.Read();
-            if (invocation->Interrupt()) {
+        iLockQueues.Wait();
+        while (iWaitingInvocations.SlotsUsed() > 0) {
+            QueueLocked(*iWaitingInvocations.Read(), false);
+        }
+        iLockQueues.Signal();
+        for (;;) {
+            OpenHome::Net::Invocation* invocation = NULL;
+            Invoker* invoker = NULL;
+            iLockQueues.Wait();
+            if (iFreeInvokers.size() > 0) {
+                invocation = NextLocked();
+            }
+            if (invocation != NULL) {
+                std::map<CpiDevice*, DeviceInvocations>::iterator it = iDevices.find(&invocation->Device());
+                if (!invocation->Interrupt()) {
+                    invoker = iFreeInvokers.back();
+                    iFreeInvokers.pop_back();
+                    it->second.iActive++;
+                }
+                else if (it->second.iActive == 0 && it->second.iWaiting.empty()) {
+                    iDevices.erase(it);
+                }
+            }
+            iLockQueues.Signal();
+            if (invocation == NULL) {
+                break;
+            }
+            if (invoker != NULL) {
+                invoker->Invoke(invocation);
+            }
+            else {
                 // the service associated with this invocation is being deleted
                 // complete it with an error immediately and process the next waiting
                 invocation->SetError(Error::eAsync,
@@ -805,19 +1394,14 @@ void InvocationManager::Run()
                                      Error::kDescriptionAsyncInterrupted);
                 invocation->SignalCompleted();
             }
-            else {
-                Invoker* invoker = iFreeInvokers.Read();
-                invoker->Invoke(invocation);
-            }
-        }
-        catch (FifoReadError&) {
-            if (invocation != NULL) {
-                invocation->SetError(Error::eAsync,
-                                     Error::eCodeShutdown,
-                                     Error::kDescriptionAsyncShutdown);
-                invocation->SignalCompleted();
-            }
-            break;
         }
     }
 }
+
+
+// InvocationManager::DeviceInvocations
+
+InvocationManager::DeviceInvocations::DeviceInvocations()
+    : iActive(0)
+{
+}
@@ -25,8 +25,10 @@
 
 #include <vector>
 #include <map>
+#include <list>
 
 namespace OpenHome {
+class Socket;
 namespace Net {
 
 class Invocation;
@@ -139,6 +141,8 @@ public:
     virtual void ProcessBinary(const Brx& aVal) = 0;
 };
 
+template <class T> class ArgumentSlab;
+
 /**
  * (Action) Argument
  *
@@ -146,19 +150,26 @@ public:
  * Input parameters should construct arguments using the (Parameter, Val) constructor.
  * Output parameters should construct arguments using only the parameter and should
  * read the value when the invocation completes.
+ *
+ * Invocation also keeps a pool of recycled arguments (see Invocation::AddInputUint() etc.).
+ * These are created using the default constructor and have their Parameter set on each use.
  */
 class Argument : public INonCopyable
 {
+    friend class Invocation;
 public:
     virtual ~Argument();
     virtual void ProcessInput(IInputArgumentProcessor& aProcessor) = 0;
     virtual void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer) = 0;
     const OpenHome::Net::Parameter& Parameter() const;
 protected:
+    Argument();
     Argument(const OpenHome::Net::Parameter& aParameter);
     void ValidationFailed(const OpenHome::Net::Parameter& aParameter);
 protected:
-    const OpenHome::Net::Parameter& iParameter;
+    const OpenHome::Net::Parameter* iParameter;
+private:
+    TBool iRecycled;
 };
 
 /**
@@ -174,8 +185,16 @@ public:
     DllExport void TransferTo(Brh& aBrh);
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentString>;
+    friend class Invocation;
+    ArgumentString();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
 private:
     Brhz iValue;
+    Bwh iInputValue; // reused by recycled input arguments
+    TBool iInput;
 };
 
 /**
@@ -190,6 +209,12 @@ public:
     DllExport TInt Value() const;
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentInt>;
+    friend class Invocation;
+    ArgumentInt();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TInt aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
 private:
     TInt iValue;
 };
@@ -206,6 +231,12 @@ public:
     DllExport TUint Value() const;
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentUint>;
+    friend class Invocation;
+    ArgumentUint();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TUint aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
 private:
     TUint iValue;
 };
@@ -222,6 +253,12 @@ public:
     DllExport TBool Value() const;
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentBool>;
+    friend class Invocation;
+    ArgumentBool();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, TBool aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
 private:
     TBool iValue;
 };
@@ -239,8 +276,51 @@ public:
     DllExport void TransferTo(Brh& aBrh);
     void ProcessInput(IInputArgumentProcessor& aProcessor);
     void ProcessOutput(IOutputProcessor& aProcessor, const Brx& aBuffer);
+private:
+    friend class ArgumentSlab<ArgumentBinary>;
+    friend class Invocation;
+    ArgumentBinary();
+    void SetInput(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    void SetOutput(const OpenHome::Net::Parameter& aParameter);
 private:
     Brh iValue;
+    Bwh iInputValue; // reused by recycled input arguments
+    TBool iInput;
+};
+
+/**
+ * Pool of recycled arguments of a single type.
+ *
+ * Each Invocation owns one of these per argument type.  Arguments are never deleted
+ * while the Invocation exists; Reset() makes all of them available for reuse.
+ *
+ * Intended for internal use only
+ */
+template <class T> class ArgumentSlab : public INonCopyable
+{
+public:
+    ArgumentSlab() : iUsed(0) {}
+    ~ArgumentSlab()
+    {
+        for (TUint i=0; i<iArguments.size(); i++) {
+            delete iArguments[i];
+        }
+    }
+    void Reserve(TUint aCount)
+    {
+        while (iArguments.size() < aCount) {
+            iArguments.push_back(new T());
+        }
+    }
+    T& Next()
+    {
+        Reserve(iUsed + 1);
+        return *iArguments[iUsed++];
+    }
+    void Reset() { iUsed = 0; }
+private:
+    std::vector<T*> iArguments;
+    TUint iUsed;
 };
 
 /**
@@ -257,6 +337,23 @@ public:
     virtual void Interrupt() = 0;
 };
 
+/**
+ * Completes an invocation which released its invoker thread using Invocation::Suspend()
+ *
+ * Intended for internal use only
+ */
+class IInvocationContinuation
+{
+public:
+    /**
+     * Called on an invoker thread once the suspended socket is readable or, if aTimedOut
+     * is true, once the timeout passed to Suspend() has elapsed.
+     * May throw the same exceptions as IInvocable::InvokeAction() or call Suspend() again.
+     */
+    virtual void Continue(TBool aTimedOut) = 0;
+    virtual ~IInvocationContinuation() {}
+};
+
 /**
  * Used to invoke an Action with particular Arguments on a Service
  *
@@ -274,6 +371,8 @@ public:
  * - create one Argument-derived class for each OutputParameter on the action
  *      these arguments should not have their values set (i.e. use the c'tor taking one param)
  * - call AddOutput() for each of these arguments
+ *      alternatively, use AddInputUint(), AddOutputUint() etc. to use argument
+ *      storage which is owned by the invocation and recycled between uses
  * - call IInvocable::QueueInvocation()
  * ....
  * - The invocation completed callback will run.  Invocation::Error() will be
@@ -330,6 +429,30 @@ public:
      */
     DllExport void AddOutput(Argument* aArgument);
 
+    /**
+     * Add an input argument, using storage owned by this invocation
+     *
+     * Argument objects and their buffers are recycled when the invocation is returned
+     * to its pool so, unlike AddInput(), these don't allocate once the invocation has
+     * been used for an action with a similar signature.
+     */
+    DllExport void AddInputString(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+    DllExport void AddInputInt(const OpenHome::Net::Parameter& aParameter, TInt aValue);
+    DllExport void AddInputUint(const OpenHome::Net::Parameter& aParameter, TUint aValue);
+    DllExport void AddInputBool(const OpenHome::Net::Parameter& aParameter, TBool aValue);
+    DllExport void AddInputBinary(const OpenHome::Net::Parameter& aParameter, const Brx& aValue);
+
+    /**
+     * Add an output argument, using storage owned by this invocation
+     *
+     * As with AddInputString() etc., these avoid allocating Argument objects.
+     */
+    DllExport void AddOutputString(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputInt(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputUint(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputBool(const OpenHome::Net::Parameter& aParameter);
+    DllExport void AddOutputBinary(const OpenHome::Net::Parameter& aParameter);
+
     /**
      * Set error details on this invocation.
      *
@@ -345,9 +468,25 @@ public:
 
     /**
      * Signal that this invocation should be interrupted if its Action is a member of aService
+     * Returns true if the invocation was interrupted.
      * Intended for internal use only
      */
-    void Interrupt(const Service& aService);
+    TBool Interrupt(const Service& aService);
+
+    /**
+     * Release the invoker thread until aSocket is readable or aTimeoutMs has elapsed
+     *
+     * aContinuation is then run on an invoker thread to complete the invocation.  This
+     * must be the last thing IInvocable::InvokeAction() or IInvocationContinuation::Continue()
+     * does.  Passes ownership of aContinuation; it is deleted once the invocation completes.
+     * Intended for use by CpiDevice-derived classes.
+     */
+    void Suspend(Socket& aSocket, TUint aTimeoutMs, IInvocationContinuation& aContinuation);
+
+    /**
+     * Returns true if Suspend() has been called and the invocation hasn't yet continued
+     */
+    TBool Suspended() const;
 
     const OpenHome::Net::ServiceType& ServiceType() const;
     DllExport const OpenHome::Net::Action& Action() const;
@@ -381,6 +520,9 @@ private:
     Invocation& operator=(const Invocation& aInvocation);
     ~Invocation();
     void Clear();
+    TBool Continue();
+    void ReserveArguments(const OpenHome::Net::Action& aAction);
+    static OpenHome::Net::Parameter::EType ArgumentType(const OpenHome::Net::Parameter& aParameter);
     static void OutputArgument(IAsyncOutput& aConsole, const TChar* aKey, const Argument& aArgument);
     virtual TUint Type() const;
 private:
@@ -396,12 +538,25 @@ private:
     TBool iCompleted;
     VectorArguments iInput;
     VectorArguments iOutput;
+    ArgumentSlab<ArgumentString> iStrings;
+    ArgumentSlab<ArgumentInt> iInts;
+    ArgumentSlab<ArgumentUint> iUints;
+    ArgumentSlab<ArgumentBool> iBools;
+    ArgumentSlab<ArgumentBinary> iBinaries;
     IInterruptHandler* iInterruptHandler;
     IInvocable* iInvoker;
+    IInvocationContinuation* iContinuation;
+    Socket* iSuspendSocket;
+    TUint iSuspendTimeoutMs;
+    TBool iTimedOut;
 private:
     friend class InvocationManager;
+    friend class InvocationPoller;
+    friend class Invoker;
 };
 
+class InvocationManager;
+
 /**
  * Dedicated thread which processes action invocations
  *
@@ -410,7 +565,7 @@ private:
 class Invoker : public Thread
 {
 public:
-    Invoker(const TChar* aName, Fifo<Invoker*>& aFree);
+    Invoker(const TChar* aName, InvocationManager& aManager);
     ~Invoker();
 
     /**
@@ -422,21 +577,79 @@ public:
      * Interrupt any current invocation if its action is a member of aService
      */
     void Interrupt(const Service& aService);
+
+    /**
+     * Run aInvocation on the calling thread, setting its error if it fails
+     *
+     * If aCanSuspend is false, this waits for the response to any suspended invocation.
+     * Returns true if aInvocation was suspended (so shouldn't be completed yet).
+     */
+    static TBool InvokeAction(Invocation& aInvocation, TBool aCanSuspend);
 private:
-    void SetError(Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr);
+    static void SetError(Invocation& aInvocation, Error::ELevel aLevel, TUint aCode, const Brx& aDescription, const TChar* aLogStr);
     void Run();
 private:
-    Fifo<Invoker*>& iFree;
+    InvocationManager& iManager;
     Invocation* iInvocation;
     OpenHome::Mutex iLock;
 };
 
+/**
+ * Dedicated thread which watches the sockets of suspended invocations
+ *
+ * Invocations are passed back to the InvocationManager once their socket is readable
+ * or their timeout elapses.  Intended for internal use only
+ */
+class InvocationPoller : public Thread
+{
+public:
+    InvocationPoller(Environment& aEnv, InvocationManager& aManager);
+    ~InvocationPoller();
+    /**
+     * Returns false if this platform can't poll many sockets
+     */
+    TBool Enabled() const;
+    /**
+     * Watch the socket passed to aInvocation.Suspend()
+     */
+    void Park(OpenHome::Net::Invocation& aInvocation);
+    /**
+     * Interrupt and resume any parked invocations whose action is a member of aService
+     */
+    void Interrupt(const Service& aService);
+private:
+    void Run();
+private:
+    class ParkedInvocation
+    {
+    public:
+        ParkedInvocation(TUint aId, OpenHome::Net::Invocation& aInvocation, TUint aExpiryMs);
+    public:
+        TUint iId;
+        OpenHome::Net::Invocation* iInvocation;
+        TUint iExpiryMs;
+    };
+    typedef std::list<ParkedInvocation> ParkedList;
+    static const TUint kMaxPollIds = 64;
+private:
+    Environment& iEnv;
+    InvocationManager& iManager;
+    OpenHome::Mutex iLock;
+    THandle iPoller;
+    TUint iNextId;
+    ParkedList iParked;             // earliest expiry first
+    std::map<TUint, ParkedList::iterator> iParkedById;
+    TBool iStopping;
+};
+
 /**
  * Singleton which manages the pools of Invocation and Invoker instances
  */
 class InvocationManager : public Thread
 {
     friend class CpiService;
+    friend class Invoker;
+    friend class InvocationPoller;
 public:
     InvocationManager(CpStack& aCpStack);
     ~InvocationManager();
@@ -444,14 +657,35 @@ public:
     void Interrupt(const Service& aService);
 private:
     OpenHome::Net::Invocation* Invocation();
+    void InvokeOnCallerThread(OpenHome::Net::Invocation& aInvocation);
+    TBool CanSuspend() const;
+    void InvokerFree(Invoker& aInvoker, CpiDevice* aDevice, OpenHome::Net::Invocation* aSuspended);
+    void Resume(OpenHome::Net::Invocation& aInvocation, TBool aTimedOut);
+    void QueueLocked(OpenHome::Net::Invocation& aInvocation, TBool aFront);
+    OpenHome::Net::Invocation* NextLocked();
     void Run();
+private:
+    class DeviceInvocations
+    {
+    public:
+        DeviceInvocations();
+    public:
+        std::list<OpenHome::Net::Invocation*> iWaiting;
+        TUint iActive;              // number of invokers in use
+    };
 private:
     CpStack& iCpStack;
     OpenHome::Mutex iLock;
     Fifo<OpenHome::Net::Invocation*> iFreeInvocations;
     Fifo<OpenHome::Net::Invocation*> iWaitingInvocations;
-    Fifo<Invoker*> iFreeInvokers;
+    OpenHome::Mutex iLockQueues;
+    std::vector<Invoker*> iFreeInvokers;
+    std::map<CpiDevice*, DeviceInvocations> iDevices;
+    std::list<CpiDevice*> iReadyDevices; // devices with waiting invocations, in round robin order
+    std::vector<OpenHome::Net::Invocation*> iCallerThreadInvocations;
+    TUint iMaxInvokersPerDevice;
     Invoker** iInvokers;
+    InvocationPoller* iPoller;
     TBool iActive;
 };
 
@@ -4,6 +4,7 @@
 #include <OpenHome/Net/Private/XmlFetcher.h>
 #include <OpenHome/Net/Private/CpiSubscription.h>
 #include <OpenHome/Net/Private/CpiDevice.h>
+#include <OpenHome/Net/Private/CpiDeviceUpnp.h>
 #include <OpenHome/Private/Printer.h>
 
 using namespace OpenHome;
@@ -17,6 +18,7 @@ CpStack::CpStack(OpenHome::Environment& aStack)
     iEnv.SetCpStack(this);
     iInvocationManager = new OpenHome::Net::InvocationManager(*this);
     iXmlFetchManager = new OpenHome::Net::XmlFetchManager(*this);
+    iDescriptionCache = new CpiDeviceDescriptionCache(aStack);
     iSubscriptionManager = new CpiSubscriptionManager(*this);
     iDeviceListUpdater = new CpiDeviceListUpdater();
 }
@@ -26,6 +28,7 @@ CpStack::~CpStack()
     delete iDeviceListUpdater;
     delete iSubscriptionManager;
     delete iXmlFetchManager;
+    delete iDescriptionCache;
     delete iInvocationManager;
 }
 
@@ -48,3 +51,8 @@ CpiDeviceListUpdater& CpStack::DeviceListUpdater()
 {
     return *iDeviceListUpdater;
 }
+
+CpiDeviceDescriptionCache& CpStack::DescriptionCache()
+{
+    return *iDescriptionCache;
+}
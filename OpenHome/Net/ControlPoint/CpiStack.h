@@ -20,6 +20,7 @@ class InvocationManager;
 class XmlFetchManager;
 class CpiSubscriptionManager;
 class CpiDeviceListUpdater;
+class CpiDeviceDescriptionCache;
 
 class CpStack : public IStack, private INonCopyable
 {
@@ -30,6 +31,7 @@ public:
     OpenHome::Net::XmlFetchManager& XmlFetchManager();
     CpiSubscriptionManager& SubscriptionManager();
     CpiDeviceListUpdater& DeviceListUpdater();
+    CpiDeviceDescriptionCache& DescriptionCache();
 private:
     ~CpStack();
 private:
@@ -38,6 +40,7 @@ private:
     OpenHome::Net::XmlFetchManager* iXmlFetchManager;
     CpiSubscriptionManager* iSubscriptionManager;
     CpiDeviceListUpdater* iDeviceListUpdater;
+    CpiDeviceDescriptionCache* iDescriptionCache;
 };
 
 } // namespace Net
@@ -155,12 +155,22 @@ void CpiSubscription::RunInSubscriber()
         DoUnsubscribe();
         break;
     case eResubscribe:
+        iCpStack.SubscriptionManager().Renewals().ResubscribeStarted();
         DoUnsubscribe();
         Schedule(eSubscribe);
         break;
     }
 }
 
+CpiSubscription* CpiSubscription::TakeNextInBatch()
+{
+    AutoMutex _(iLockInternal);
+    CpiSubscription* next = iNextInBatch;
+    iNextInBatch = NULL;
+    iInBatch = false;
+    return next;
+}
+
 CpiSubscription::CpiSubscription(CpiDevice& aDevice, IEventProcessor& aEventProcessor, const OpenHome::Net::ServiceType& aServiceType, TUint aId)
     : iLock("SUBM")
     , iSubscriberLock("SBM2")
@@ -177,8 +187,10 @@ CpiSubscription::CpiSubscription(CpiDevice& aDevice, IEventProcessor& aEventProc
     , iSubscribeErrorCount(0)
     , iInterruptHandler(NULL)
     , iSuspended(false)
+    , iNextInBatch(NULL)
+    , iInBatch(false)
+    , iRenewDue(0)
 {
-    iTimer = new Timer(iEnv, MakeFunctor(*this, &CpiSubscription::Renew), "CpiSubscription");
     iTimerSubscribeRetry = new Timer(iEnv, MakeFunctor(*this, &CpiSubscription::SubscribeRetry), "CpiSubscription2");
     iDevice.AddRef();
     iRejectFutureOperations = false;
@@ -187,13 +199,12 @@ CpiSubscription::CpiSubscription(CpiDevice& aDevice, IEventProcessor& aEventProc
 
 CpiSubscription::~CpiSubscription()
 {
-    iTimer->Cancel();
+    iCpStack.SubscriptionManager().Renewals().Cancel(*this);
     iTimerSubscribeRetry->Cancel();
     ASSERT(iSid.Bytes() == 0);
     iCpStack.SubscriptionManager().Remove(*this); // in case we never subscribed, so never need to unsubscribe
     iDevice.RemoveRef();
     delete iTimerSubscribeRetry;
-    delete iTimer;
     iEnv.RemoveObject(this);
 }
 
@@ -218,6 +229,23 @@ TBool CpiSubscription::StartSchedule(EOperation aOperation, TBool aRejectFutureO
     return true;
 }
 
+TBool CpiSubscription::StartBatch(EOperation aOperation)
+{
+    AutoMutex _(iLockInternal);
+    /* A zero ref count means we're being deleted - our destructor is waiting for
+       CpiRenewalScheduler (which calls this) to release its lock */
+    if (iRejectFutureOperations || iRefCount == 0) {
+        return false;
+    }
+    iPendingOperation = aOperation;
+    if (iInBatch) {
+        return false; // an earlier batch hasn't reached us yet; it'll run aOperation instead
+    }
+    iInBatch = true;
+    iRefCount++;
+    return true;
+}
+
 void CpiSubscription::DoSubscribe()
 {
     Bws<Uri::kMaxUriBytes> uri;
@@ -286,40 +314,30 @@ void CpiSubscription::DoSubscribe()
     SetRenewTimer(renewSecs);
 }
 
-void CpiSubscription::Renew()
-{
-    Schedule(eRenew);
-}
-
 void CpiSubscription::DoRenew()
 {
     LOG(kEvent, "Renewing (%p) sid %.*s\n", this, PBUF(iSid));
 
+    CpiRenewalScheduler& renewals = iCpStack.SubscriptionManager().Renewals();
+    renewals.RenewalStarted();
     TUint renewSecs = 0;
+    TBool renewed = false;
     try {
         renewSecs = iDevice.Renew(*this);
-        LOG(kEvent, "Renewed (%p) %.*s.  Renew again in %u secs\n",
-                    this, PBUF(iSid), renewSecs);
-        SetRenewTimer(renewSecs);
+        renewed = true;
     }
     catch (NetworkTimeout&) {
-        Schedule(eResubscribe);
     }
     catch (NetworkError&) {
-        Schedule(eResubscribe);
     }
     catch (HttpError&) {
-        Schedule(eResubscribe);
     }
     catch (WriterError&) {
-        Schedule(eResubscribe);
     }
     catch (ReaderError&) {
-        Schedule(eResubscribe);
     }
     catch (DvSubscriptionError&) {
         Log::Print("WARNING: CpiSubscription::DoRenew() caught DvSubscriptionError (has some other CP removed a subscription used by a CpDeviceDv?)\n");
-        Schedule(eResubscribe);
     }
     catch (AssertionFailed&) {
         throw;
@@ -328,6 +346,16 @@ void CpiSubscription::DoRenew()
         Log::Print("ERROR - unexpected exception renewing subscription: %s from %s:%u\n", e.Message(), e.File(), e.Line());
         ASSERTS();
     }
+    renewals.RenewalCompleted(iRenewDue, renewed);
+
+    if (renewed) {
+        LOG(kEvent, "Renewed (%p) %.*s.  Renew again in %u secs\n",
+                    this, PBUF(iSid), renewSecs);
+        SetRenewTimer(renewSecs);
+    }
+    else {
+        Schedule(eResubscribe);
+    }
 }
 
 void CpiSubscription::DoUnsubscribe()
@@ -335,7 +363,7 @@ void CpiSubscription::DoUnsubscribe()
     LOG(kEvent, "Unsubscribing (%p) sid %.*s\n", this, PBUF(iSid));
 
     const TUint startTime = Os::TimeInMs(iEnv.OsCtx());
-    iTimer->Cancel();
+    iCpStack.SubscriptionManager().Renewals().Cancel(*this);
     if (iSid.Bytes() == 0) {
         LOG(kEvent, "Skipped unsubscribing since sid is empty (we're not subscribed)\n");
         return;
@@ -389,11 +417,7 @@ void CpiSubscription::SetRenewTimer(TUint aMaxSeconds)
         LOG_ERROR(kEvent, "ERROR: subscription (%p) sid %.*s has 0s renew time\n", this, PBUF(iSid));
         return;
     }
-    TUint64 maxSeconds = aMaxSeconds;
-    const TUint randMin = (TUint)((maxSeconds*1000*3)/4);
-    const TUint randMax = (TUint)((maxSeconds*1000)/2);
-    TUint renewMs = iEnv.Random(randMin, randMax);
-    iTimer->FireIn(renewMs);
+    iCpStack.SubscriptionManager().Renewals().ScheduleRenewal(*this, aMaxSeconds);
 }
 
 void CpiSubscription::SetRenewTimerDefault()
@@ -402,14 +426,6 @@ void CpiSubscription::SetRenewTimerDefault()
     SetRenewTimer(defaultDurationSecs);
 }
 
-void CpiSubscription::Resubscribe()
-{
-    EOperation op = iSuspended? eSubscribe : eResubscribe;
-    if (StartSchedule(op, false)) {
-        iDevice.GetCpStack().SubscriptionManager().ScheduleLocked(*this);
-    }
-}
-
 void CpiSubscription::NotifySubnetChanged()
 {
     /* We're on a new network so all existing subscriptions are pretty much useless.
@@ -426,7 +442,7 @@ void CpiSubscription::NotifySubnetChanged()
 
 void CpiSubscription::Suspend()
 {
-    iTimer->Cancel();
+    iCpStack.SubscriptionManager().Renewals().Cancel(*this);
     iSuspended = true;
     if (StartSchedule(eUnsubscribe, false)) {
         iDevice.GetCpStack().SubscriptionManager().ScheduleLocked(*this);
@@ -534,32 +550,36 @@ void Subscriber::Run()
             }
             exit = true;
         }
-        try {
-            iSubscription->RunInSubscriber();
-        }
-        catch (HttpError&) {
-            Error("Http");
-        }
-        catch (UriError&) {
-            Error("Uri");
-        }
-        catch (NetworkError&) {
-            Error("Network");
-        }
-        catch (NetworkTimeout&) {
-            Error("Timeout");
-        }
-        catch (WriterError&) {
-            Error("Writer");
-        }
-        catch (ReaderError&) {
-            Error("Reader");
-        }
-        catch (XmlError&) {
-            Error("XmlError");
+        // run a batch of renewals from CpiRenewalScheduler back to back
+        while (iSubscription != NULL) {
+            CpiSubscription* next = iSubscription->TakeNextInBatch();
+            try {
+                iSubscription->RunInSubscriber();
+            }
+            catch (HttpError&) {
+                Error("Http");
+            }
+            catch (UriError&) {
+                Error("Uri");
+            }
+            catch (NetworkError&) {
+                Error("Network");
+            }
+            catch (NetworkTimeout&) {
+                Error("Timeout");
+            }
+            catch (WriterError&) {
+                Error("Writer");
+            }
+            catch (ReaderError&) {
+                Error("Reader");
+            }
+            catch (XmlError&) {
+                Error("XmlError");
+            }
+            iSubscription->RemoveRef();
+            iSubscription = next;
         }
-        iSubscription->RemoveRef();
-        iSubscription = NULL;
         if (exit) {
             break;
         }
@@ -568,6 +588,250 @@ void Subscriber::Run()
 }
 
 
+// CpiRenewalScheduler
+
+const Brn CpiRenewalScheduler::kQueryRenewals("subscriptionrenewals");
+
+CpiRenewalScheduler::CpiRenewalScheduler(Environment& aEnv, CpiSubscriptionManager& aManager)
+    : iEnv(aEnv)
+    , iManager(aManager)
+    , iLock("CPRS")
+    , iRenewals(0)
+    , iBatches(0)
+    , iInProgress(0)
+    , iPeakConcurrent(0)
+    , iTotalLatencyMs(0)
+    , iMaxLatencyMs(0)
+    , iFailures(0)
+    , iConnections(0)
+    , iRetries(0)
+    , iResubscribes(0)
+{
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &CpiRenewalScheduler::TimerExpired), "CpiRenewalScheduler");
+    IInfoAggregator* infoAggregator = aEnv.InfoAggregator();
+    if (infoAggregator != NULL) {
+        std::vector<Brn> queries;
+        queries.push_back(kQueryRenewals);
+        infoAggregator->Register(*this, queries);
+    }
+}
+
+CpiRenewalScheduler::~CpiRenewalScheduler()
+{
+    delete iTimer;
+}
+
+void CpiRenewalScheduler::ScheduleRenewal(CpiSubscription& aSubscription, TUint aDurationSecs)
+{
+    const TUint64 durationMs = (TUint64)aDurationSecs * 1000;
+    const TUint earliestMs = (TUint)(durationMs/2);
+    const TUint latestMs = (TUint)((durationMs*3)/4);
+    const TUint dueMs = iEnv.Random(latestMs, earliestMs);
+    AutoMutex _(iLock);
+    const TUint now = Time::Now(iEnv);
+    CancelLocked(aSubscription);
+    InsertLocked(Renewal(aSubscription, CpiSubscription::eRenew, now + earliestMs, now + dueMs));
+}
+
+void CpiRenewalScheduler::ScheduleResubscribeAll(const std::vector<CpiSubscription*>& aSubscriptions)
+{
+    // every subscription to a device shares a random delay so they'll be processed as one batch
+    std::map<CpiDevice*,TUint> delays;
+    for (TUint i=0; i<(TUint)aSubscriptions.size(); i++) {
+        delays.insert(std::pair<CpiDevice*,TUint>(&aSubscriptions[i]->iDevice, 0));
+    }
+    TUint spreadMs = (TUint)delays.size() * kBulkSpreadPerDeviceMs;
+    if (spreadMs > kMaxBulkSpreadMs) {
+        spreadMs = kMaxBulkSpreadMs;
+    }
+    std::map<CpiDevice*,TUint>::iterator it;
+    for (it=delays.begin(); it!=delays.end(); ++it) {
+        it->second = iEnv.Random(spreadMs);
+    }
+
+    AutoMutex _(iLock);
+    const TUint now = Time::Now(iEnv);
+    for (TUint i=0; i<(TUint)aSubscriptions.size(); i++) {
+        CpiSubscription& subscription = *aSubscriptions[i];
+        const CpiSubscription::EOperation op = (subscription.iSuspended? CpiSubscription::eSubscribe : CpiSubscription::eResubscribe);
+        const TUint due = now + delays[&subscription.iDevice];
+        CancelLocked(subscription);
+        InsertLocked(Renewal(subscription, op, due, due));
+    }
+}
+
+void CpiRenewalScheduler::Cancel(CpiSubscription& aSubscription)
+{
+    AutoMutex _(iLock);
+    CancelLocked(aSubscription);
+}
+
+void CpiRenewalScheduler::RenewalStarted()
+{
+    AutoMutex _(iLock);
+    if (++iInProgress > iPeakConcurrent) {
+        iPeakConcurrent = iInProgress;
+    }
+}
+
+void CpiRenewalScheduler::RenewalCompleted(TUint aDueTime, TBool aRenewed)
+{
+    AutoMutex _(iLock);
+    ASSERT(iInProgress > 0);
+    iInProgress--;
+    iRenewals++;
+    if (!aRenewed) {
+        iFailures++;
+    }
+    const TUint now = Time::Now(iEnv);
+    const TUint latencyMs = (Time::IsAfter(now, aDueTime)? now - aDueTime : 0);
+    iTotalLatencyMs += latencyMs;
+    if (latencyMs > iMaxLatencyMs) {
+        iMaxLatencyMs = latencyMs;
+    }
+}
+
+void CpiRenewalScheduler::RenewalConnectionOpened(TBool aRetry)
+{
+    AutoMutex _(iLock);
+    iConnections++;
+    if (aRetry) {
+        iRetries++;
+    }
+}
+
+void CpiRenewalScheduler::ResubscribeStarted()
+{
+    AutoMutex _(iLock);
+    iResubscribes++;
+}
+
+void CpiRenewalScheduler::GetStats(Stats& aStats) const
+{
+    AutoMutex _(iLock);
+    aStats.iRenewals = iRenewals;
+    aStats.iBatches = iBatches;
+    aStats.iInProgress = iInProgress;
+    aStats.iPeakConcurrent = iPeakConcurrent;
+    aStats.iAvgLatencyMs = (iRenewals == 0? 0 : (TUint)(iTotalLatencyMs / iRenewals));
+    aStats.iMaxLatencyMs = iMaxLatencyMs;
+    aStats.iFailures = iFailures;
+    aStats.iConnections = iConnections;
+    aStats.iRetries = iRetries;
+    aStats.iResubscribes = iResubscribes;
+}
+
+void CpiRenewalScheduler::InsertLocked(const Renewal& aRenewal)
+{
+    std::list<Renewal>::iterator it = iPending.begin();
+    while (it != iPending.end() && Time::IsBeforeOrAt(it->iDue, aRenewal.iDue)) {
+        ++it;
+    }
+    const TBool first = (it == iPending.begin());
+    (void)iPending.insert(it, aRenewal);
+    if (first) {
+        iTimer->FireAt(aRenewal.iDue);
+    }
+}
+
+void CpiRenewalScheduler::CancelLocked(CpiSubscription& aSubscription)
+{
+    // leave iTimer running if we remove the first renewal; TimerExpired() will restart it
+    std::list<Renewal>::iterator it;
+    for (it=iPending.begin(); it!=iPending.end(); ++it) {
+        if (it->iSubscription == &aSubscription) {
+            iPending.erase(it);
+            break;
+        }
+    }
+}
+
+void CpiRenewalScheduler::AppendToBatch(const Renewal& aRenewal, CpiSubscription*& aFirst, CpiSubscription*& aLast)
+{
+    CpiSubscription* subscription = aRenewal.iSubscription;
+    if (!subscription->StartBatch(aRenewal.iOperation)) {
+        return;
+    }
+    subscription->iRenewDue = aRenewal.iDue;
+    if (aFirst == NULL) {
+        aFirst = subscription;
+    }
+    else {
+        aLast->iNextInBatch = subscription;
+    }
+    aLast = subscription;
+}
+
+void CpiRenewalScheduler::TimerExpired()
+{
+    std::vector<CpiSubscription*> batches;
+    iLock.Wait();
+    const TUint now = Time::Now(iEnv);
+    while (iPending.size() > 0 && Time::IsBeforeOrAt(iPending.front().iDue, now)) {
+        const Renewal due = iPending.front();
+        iPending.pop_front();
+        CpiSubscription* first = NULL;
+        CpiSubscription* last = NULL;
+        AppendToBatch(due, first, last);
+        // renew other subscriptions to the same device early if their window has opened
+        std::list<Renewal>::iterator it = iPending.begin();
+        while (it != iPending.end()) {
+            if (it->iDevice == due.iDevice && Time::IsBeforeOrAt(it->iEarliest, now)) {
+                AppendToBatch(*it, first, last);
+                it = iPending.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        if (first != NULL) {
+            batches.push_back(first);
+            iBatches++;
+        }
+    }
+    if (iPending.size() > 0) {
+        iTimer->FireAt(iPending.front().iDue);
+    }
+    iLock.Signal();
+
+    // CpiSubscriptionManager may call us with its lock held so can't be called with iLock held
+    for (TUint i=0; i<(TUint)batches.size(); i++) {
+        iManager.Schedule(*batches[i]);
+    }
+}
+
+void CpiRenewalScheduler::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery != kQueryRenewals) {
+        return;
+    }
+    Stats stats;
+    GetStats(stats);
+    Bws<320> summary;
+    iLock.Wait();
+    summary.AppendPrintf("Subscription renewals: %u pending\n", (TUint)iPending.size());
+    iLock.Signal();
+    summary.AppendPrintf("\t%u renewals in %u batches, %u in progress (peak %u), latency %ums avg / %ums max\n",
+                         stats.iRenewals, stats.iBatches, stats.iInProgress, stats.iPeakConcurrent,
+                         stats.iAvgLatencyMs, stats.iMaxLatencyMs);
+    summary.AppendPrintf("\t%u failed, %u connections (%u retries), %u resubscribes\n",
+                         stats.iFailures, stats.iConnections, stats.iRetries, stats.iResubscribes);
+    aWriter.Write(summary);
+}
+
+
+// CpiRenewalScheduler::Renewal
+
+CpiRenewalScheduler::Renewal::Renewal(CpiSubscription& aSubscription, CpiSubscription::EOperation aOperation, TUint aEarliest, TUint aDue)
+    : iSubscription(&aSubscription)
+    , iDevice(&aSubscription.iDevice)
+    , iOperation(aOperation)
+    , iEarliest(aEarliest)
+    , iDue(aDue)
+{
+}
+
+
 // CpiSubscriptionManager
 
 CpiSubscriptionManager::CpiSubscriptionManager(CpStack& aCpStack)
@@ -580,6 +844,7 @@ CpiSubscriptionManager::CpiSubscriptionManager(CpStack& aCpStack)
     , iInterface(kIpAddressV4AllAdapters)
     , iNextSubscriptionId(1)
 {
+    iRenewals = new CpiRenewalScheduler(aCpStack.Env(), *this);
     NetworkAdapterList& ifList = iCpStack.Env().NetworkAdapterList();
     AutoNetworkAdapterRef ref(aCpStack.Env(), "CpiSubscriptionManager ctor");
     const NetworkAdapter* currentInterface = ref.Adapter();
@@ -640,6 +905,7 @@ CpiSubscriptionManager::~CpiSubscriptionManager()
             iCpStack.Env().ListObjects();
         }
     }
+    delete iRenewals;
 
     Kill();
     Join();
@@ -740,11 +1006,19 @@ TUint CpiSubscriptionManager::EventServerPort()
 void CpiSubscriptionManager::RenewAll()
 {
     AutoMutex a(iLock);
+    std::vector<CpiSubscription*> subscriptions;
+    subscriptions.reserve(iMap.size());
     std::map<TUint,CpiSubscription*>::iterator it = iMap.begin();
     while (it != iMap.end()) {
-        it->second->Resubscribe();
+        subscriptions.push_back(it->second);
         it++;
     }
+    iRenewals->ScheduleResubscribeAll(subscriptions);
+}
+
+CpiRenewalScheduler& CpiSubscriptionManager::Renewals()
+{
+    return *iRenewals;
 }
 
 void CpiSubscriptionManager::NotifySuspended()
@@ -13,6 +13,7 @@
 #include <OpenHome/Functor.h>
 #include <OpenHome/Net/Core/CpProxy.h> // for IEventProcessor
 #include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Private/InfoProvider.h>
 
 #include <list>
 #include <map>
@@ -103,6 +104,13 @@ public:
      */
     void RunInSubscriber();
 
+    /**
+     * Used by Subscriber threads to find the next subscription in a batch of renewals
+     * (see CpiRenewalScheduler).  Returns NULL at the end of the batch.
+     * Intended for internal use only
+     */
+    CpiSubscription* TakeNextInBatch();
+
     /**
      * Used by event processing threads to serialise handling of updates to a particular subscription.
      * Intended for internal use only
@@ -132,15 +140,14 @@ private:
      */
     void Schedule(EOperation aOperation, TBool aRejectFutureOperations = false);
     TBool StartSchedule(EOperation aOperation, TBool aRejectFutureOperations);
+    TBool StartBatch(EOperation aOperation);
     void DoSubscribe();
-    void Renew();
     void DoRenew();
     void DoUnsubscribe();
     void ScheduleSubscribeRetry(const TChar* aMsg);
     void SubscribeRetry();
     void SetRenewTimer(TUint aMaxSeconds);
     void SetRenewTimerDefault();
-    void Resubscribe();
     void NotifySubnetChanged();
     void Suspend();
     TBool RemoveOnSubnetChange() const;
@@ -164,7 +171,6 @@ private:
     OpenHome::Net::ServiceType iServiceType;
     TUint iId;
     Brh iSid;
-    Timer* iTimer;
     TUint iNextSequenceNumber;
     EOperation iPendingOperation;
     TUint iRefCount;
@@ -173,8 +179,12 @@ private:
     IInterruptHandler* iInterruptHandler;
     TBool iRejectFutureOperations;
     TBool iSuspended;
+    CpiSubscription* iNextInBatch;
+    TBool iInBatch;
+    TUint iRenewDue;
 
     friend class CpiSubscriptionManager;
+    friend class CpiRenewalScheduler;
 };
 
 /**
@@ -199,6 +209,95 @@ private:
     CpiSubscription* iSubscription;
 };
 
+class CpiSubscriptionManager;
+
+/**
+ * Schedules renewal of all subscriptions from a single timer
+ *
+ * Each renewal is due at a random point in its safety window (between 50% and 75% of
+ * the subscription's duration).  When one falls due, any other subscriptions to the
+ * same device whose window has opened are renewed with it, back to back in a single
+ * Subscriber thread.  Bulk resubscriptions (after an adapter change or resume) are
+ * spread over a short period, again grouped by device, rather than queued at once.
+ *
+ * Intended for internal use only
+ */
+class CpiRenewalScheduler : private IInfoProvider, private INonCopyable
+{
+    static const Brn kQueryRenewals;
+    static const TUint kBulkSpreadPerDeviceMs = 50;
+    static const TUint kMaxBulkSpreadMs = 5 * 1000;
+public:
+    class Stats
+    {
+    public:
+        TUint iRenewals;
+        TUint iBatches;
+        TUint iInProgress;
+        TUint iPeakConcurrent;
+        TUint iAvgLatencyMs;    // from the time a renewal was due until it completed
+        TUint iMaxLatencyMs;
+        TUint iFailures;        // renewals which failed, leading to a resubscribe
+        TUint iConnections;     // connections opened for renewals
+        TUint iRetries;         // renewals retried after the device closed an idle connection
+        TUint iResubscribes;
+    };
+public:
+    CpiRenewalScheduler(Environment& aEnv, CpiSubscriptionManager& aManager);
+    ~CpiRenewalScheduler();
+    /**
+     * Schedule a renewal for a subscription which lasts for aDurationSecs.
+     * Replaces any operation already scheduled for aSubscription.
+     */
+    void ScheduleRenewal(CpiSubscription& aSubscription, TUint aDurationSecs);
+    /**
+     * Schedule a resubscription for each of aSubscriptions.  Called with the subscription
+     * manager's lock held.
+     */
+    void ScheduleResubscribeAll(const std::vector<CpiSubscription*>& aSubscriptions);
+    void Cancel(CpiSubscription& aSubscription);
+    void RenewalStarted();
+    void RenewalCompleted(TUint aDueTime, TBool aRenewed);
+    void RenewalConnectionOpened(TBool aRetry);
+    void ResubscribeStarted();
+    void GetStats(Stats& aStats) const;
+private:
+    class Renewal
+    {
+    public:
+        Renewal(CpiSubscription& aSubscription, CpiSubscription::EOperation aOperation, TUint aEarliest, TUint aDue);
+    public:
+        CpiSubscription* iSubscription;
+        CpiDevice* iDevice;
+        CpiSubscription::EOperation iOperation;
+        TUint iEarliest;
+        TUint iDue;
+    };
+private:
+    void InsertLocked(const Renewal& aRenewal);
+    void CancelLocked(CpiSubscription& aSubscription);
+    void AppendToBatch(const Renewal& aRenewal, CpiSubscription*& aFirst, CpiSubscription*& aLast);
+    void TimerExpired();
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    Environment& iEnv;
+    CpiSubscriptionManager& iManager;
+    mutable Mutex iLock;
+    std::list<Renewal> iPending; // ordered by iDue
+    Timer* iTimer;
+    TUint iRenewals;
+    TUint iBatches;
+    TUint iInProgress;
+    TUint iPeakConcurrent;
+    TUint64 iTotalLatencyMs;
+    TUint iMaxLatencyMs;
+    TUint iFailures;
+    TUint iConnections;
+    TUint iRetries;
+    TUint iResubscribes;
+};
+
 class PendingSubscription;
 
 /**
@@ -226,6 +325,7 @@ public:
     void ScheduleLocked(CpiSubscription& aSubscription);
     TUint EventServerPort();
     void RenewAll();
+    CpiRenewalScheduler& Renewals();
 private: // from ISuspendObserver
     void NotifySuspended();
 private: // from IResumeObserver
@@ -250,7 +350,7 @@ private:
 private:
     CpStack& iCpStack;
     OpenHome::Mutex iLock;
-    std::list<CpiSubscription*> iList;
+    std::list<CpiSubscription*> iList; // may be the first of a batch from CpiRenewalScheduler
     Fifo<Subscriber*> iFree;
     Subscriber** iSubscribers;
     std::map<TUint,CpiSubscription*> iMap;
@@ -263,6 +363,7 @@ private:
     TIpAddress iInterface;
     TUint iSubnetListenerId;
     TUint iNextSubscriptionId;
+    CpiRenewalScheduler* iRenewals;
 };
 
 } // namespace Net
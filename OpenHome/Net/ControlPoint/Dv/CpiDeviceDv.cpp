@@ -165,6 +165,16 @@ void CpiDeviceDv::ReleaseWriter(IPropertyWriter* aWriter)
     delete aWriter;
 }
 
+IPropertyEncoder* CpiDeviceDv::PropertyEncoder()
+{
+    return NULL; // properties are passed directly to the control point, not serialised
+}
+
+void CpiDeviceDv::PropertyWriteEncoded(IPropertyWriter& /*aWriter*/, const Brx& /*aEncoded*/)
+{
+    ASSERTS();
+}
+
 void CpiDeviceDv::NotifySubscriptionCreated(const Brx& /*aSid*/)
 {
 }
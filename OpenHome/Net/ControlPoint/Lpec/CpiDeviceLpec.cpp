@@ -25,11 +25,13 @@ using namespace OpenHome::Net;
 CpiDeviceLpec::CpiDeviceLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName, Functor aStateChanged)
     : iCpStack(aCpStack)
     , iLock("CLP1")
+    , iWriteLock("CLP2")
     , iLocation(aLocation)
     , iLpecName(aLpecName)
     , iStateChanged(aStateChanged)
     , iDevice(NULL)
-    , iResponseHandler(NULL)
+    , iPipelineSlots("CLPW", aCpStack.Env().InitParams()->CpLpecMaxPipelinedRequests())
+    , iResponsesEnded(false)
     , iConnected(false)
     , iExiting(false)
 {
@@ -123,8 +125,8 @@ void CpiDeviceLpec::LpecThread()
             else if (method == Lpec::kMethodEvent) {
                 HandleEventedUpdate(parser.Remaining());
             }
-            else if (iResponseHandler == NULL || !iResponseHandler->HandleLpecResponse(method, parser.Remaining())) {
-                LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(line));
+            else {
+                HandleResponse(method, parser.Remaining(), line);
             }
         }
     }
@@ -142,6 +144,7 @@ void CpiDeviceLpec::LpecThread()
             LogError("ReaderError");
         }
     }
+    FailPendingResponses();
 }
 
 void CpiDeviceLpec::LogError(const TChar* aError)
@@ -211,6 +214,72 @@ void CpiDeviceLpec::HandleEventedUpdate(const Brx& aUpdate)
     subscription->RemoveRef();
 }
 
+void CpiDeviceLpec::SendRequest(const Brx& aRequest, ILpecResponse& aResponse)
+{
+    iPipelineSlots.Wait();
+    /* Don't hold iLock while writing.  A write may block until the device reads more, which
+       it may not do until LpecThread (which needs iLock to dequeue responses) reads ours. */
+    AutoMutex a(iWriteLock);
+    iLock.Wait();
+    if (iResponsesEnded) {
+        iLock.Signal();
+        iPipelineSlots.Signal();
+        THROW(ReaderError);
+    }
+    // queue before writing so that the reply can't arrive before we're ready for it
+    iPendingResponses.push_back(&aResponse);
+    iLock.Signal();
+    try {
+        iWriteBuffer->Write(aRequest);
+        iWriteBuffer->Write(Lpec::kMsgTerminator);
+        iWriteBuffer->WriteFlush();
+    }
+    catch (WriterError&) {
+        iLock.Wait();
+        const TUint count = (TUint)iPendingResponses.size();
+        iPendingResponses.remove(&aResponse);
+        const TBool removed = (iPendingResponses.size() < count);
+        iLock.Signal();
+        if (removed) { // otherwise FailPendingResponses has already failed it and freed its slot
+            iPipelineSlots.Signal();
+        }
+        throw;
+    }
+}
+
+void CpiDeviceLpec::HandleResponse(const Brx& aMethod, const Brx& aBody, const Brx& aLine)
+{
+    ILpecResponse* response = NULL;
+    iLock.Wait();
+    if (iPendingResponses.size() > 0) {
+        response = iPendingResponses.front();
+        iPendingResponses.pop_front();
+    }
+    iLock.Signal();
+    if (response == NULL) {
+        LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(aLine));
+        return;
+    }
+    iPipelineSlots.Signal();
+    // response may be deleted by its owner as soon as it has been handled
+    if (!response->HandleLpecResponse(aMethod, aBody)) {
+        LOG_ERROR(kLpec, "Unexpected LPEC message: %.*s\n", PBUF(aLine));
+        response->HandleLpecFailure();
+    }
+}
+
+void CpiDeviceLpec::FailPendingResponses()
+{
+    AutoMutex a(iLock);
+    iResponsesEnded = true;
+    while (iPendingResponses.size() > 0) {
+        ILpecResponse* response = iPendingResponses.front();
+        iPendingResponses.pop_front();
+        response->HandleLpecFailure();
+        iPipelineSlots.Signal();
+    }
+}
+
 void CpiDeviceLpec::InvokeAction(Invocation& aInvocation)
 {
     aInvocation.SetInvoker(*iInvocable);
@@ -225,26 +294,24 @@ TBool CpiDeviceLpec::GetAttribute(const char* /*aKey*/, Brh& /*aValue*/) const
 
 TUint CpiDeviceLpec::Subscribe(CpiSubscription& aSubscription, const OpenHome::Uri& /*aSubscriber*/)
 {
-    Semaphore sem("CLS2", 0);
-    SubscriptionResponse resp(sem);
-    AutoMutex a(iLock);
-    iResponseHandler = &resp;
-    iWriteBuffer->Write(Lpec::kMethodSubscribe);
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(iLpecName);
-    iWriteBuffer->Write('/');
-    iWriteBuffer->Write(aSubscription.ServiceType().Name());
-    iWriteBuffer->Write(Lpec::kMsgTerminator);
-    iWriteBuffer->WriteFlush();
-
-    sem.Wait();
+    WriterBwh request(kRequestGranularity);
+    request.Write(Lpec::kMethodSubscribe);
+    request.Write(' ');
+    request.Write(iLpecName);
+    request.Write('/');
+    request.Write(aSubscription.ServiceType().Name());
+    SubscriptionResponse resp;
+    SendRequest(request.Buffer(), resp);
+
+    if (!resp.Wait()) {
+        THROW(ReaderError);
+    }
     Bws<128> sid(iDevice->Udn());
     sid.Append('-');
     sid.Append(resp.SidFragment());
     Brh sid2(sid);
     aSubscription.SetSid(sid2);
 
-    iResponseHandler = NULL;
     return kSubscriptionDurationSecs;
 }
 
@@ -255,14 +322,13 @@ TUint CpiDeviceLpec::Renew(CpiSubscription& /*aSubscription*/)
 
 void CpiDeviceLpec::Unsubscribe(CpiSubscription& aSubscription, const Brx& /*aSid*/)
 {
-    AutoMutex a(iLock);
-    iWriteBuffer->Write(Lpec::kMethodUnsubscribe);
-    iWriteBuffer->Write(' ');
-    iWriteBuffer->Write(iLpecName);
-    iWriteBuffer->Write('/');
-    iWriteBuffer->Write(aSubscription.ServiceType().Name());
-    iWriteBuffer->Write(Lpec::kMsgTerminator);
-    iWriteBuffer->WriteFlush();
+    WriterBwh request(kRequestGranularity);
+    request.Write(Lpec::kMethodUnsubscribe);
+    request.Write(' ');
+    request.Write(iLpecName);
+    request.Write('/');
+    request.Write(aSubscription.ServiceType().Name());
+    SendRequest(request.Buffer(), iUnsubscriptionResponse);
 
     // no great benefit in waiting for a response
 }
@@ -291,84 +357,101 @@ void CpiDeviceLpec::Release()
 
 CpiDeviceLpec::Invocable::Invocable(CpiDeviceLpec& aDevice)
     : iDevice(aDevice)
-    , iSem("CLPS", 0)
-    , iInvocation(NULL)
 {
 }
 
 void CpiDeviceLpec::Invocable::InvokeAction(Invocation& aInvocation)
 {
-    AutoMutex a(iDevice.iLock);
-    iDevice.iResponseHandler = this;
-    iInvocation = &aInvocation;
-    iDevice.iWriteBuffer->Write(Lpec::kMethodAction);
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(iDevice.iLpecName);
-    iDevice.iWriteBuffer->Write('/');
-    iDevice.iWriteBuffer->Write(aInvocation.ServiceType().Name());
-    iDevice.iWriteBuffer->Write(' ');
+    WriterBwh request(kRequestGranularity);
+    request.Write(Lpec::kMethodAction);
+    request.Write(' ');
+    request.Write(iDevice.iLpecName);
+    request.Write('/');
+    request.Write(aInvocation.ServiceType().Name());
+    request.Write(' ');
     Bws<Ascii::kMaxUintStringBytes> verBuf;
     (void)Ascii::AppendDec(verBuf, aInvocation.ServiceType().Version());
-    iDevice.iWriteBuffer->Write(verBuf);
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(aInvocation.Action().Name());
-    std::vector<Argument*> inputArgs = aInvocation.InputArguments();
+    request.Write(verBuf);
+    request.Write(' ');
+    request.Write(aInvocation.Action().Name());
+    InputArgumentWriter argWriter(request);
+    const Invocation::VectorArguments& inputArgs = aInvocation.InputArguments();
     for (TUint i=0; i<inputArgs.size(); i++) {
-        inputArgs[i]->ProcessInput(*this);
+        inputArgs[i]->ProcessInput(argWriter);
     }
-    iDevice.iWriteBuffer->Write(Lpec::kMsgTerminator);
-    iDevice.iWriteBuffer->WriteFlush();
 
-    iSem.Wait(); // wait for response
-    iInvocation = NULL;
-    iDevice.iResponseHandler = NULL;
+    InvocationResponse response(aInvocation);
+    iDevice.SendRequest(request.Buffer(), response);
+    response.Wait();
 }
 
-void CpiDeviceLpec::Invocable::ProcessString(const Brx& aVal)
+
+// CpiDeviceLpec::InputArgumentWriter
+
+CpiDeviceLpec::InputArgumentWriter::InputArgumentWriter(IWriter& aWriter)
+    : iWriter(aWriter)
 {
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
-    Converter::ToXmlEscaped(*(iDevice.iWriteBuffer), aVal);
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
 }
 
-void CpiDeviceLpec::Invocable::ProcessInt(TInt aVal)
+void CpiDeviceLpec::InputArgumentWriter::ProcessString(const Brx& aVal)
 {
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(' ');
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Converter::ToXmlEscaped(iWriter, aVal);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void CpiDeviceLpec::InputArgumentWriter::ProcessInt(TInt aVal)
+{
+    iWriter.Write(' ');
+    iWriter.Write(Lpec::kArgumentDelimiter);
     Bws<Ascii::kMaxIntStringBytes> valBuf;
     (void)Ascii::AppendDec(valBuf, aVal);
-    iDevice.iWriteBuffer->Write(valBuf);
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(valBuf);
+    iWriter.Write(Lpec::kArgumentDelimiter);
 }
 
-void CpiDeviceLpec::Invocable::ProcessUint(TUint aVal)
+void CpiDeviceLpec::InputArgumentWriter::ProcessUint(TUint aVal)
 {
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(' ');
+    iWriter.Write(Lpec::kArgumentDelimiter);
     Bws<Ascii::kMaxUintStringBytes> valBuf;
     (void)Ascii::AppendDec(valBuf, aVal);
-    iDevice.iWriteBuffer->Write(valBuf);
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(valBuf);
+    iWriter.Write(Lpec::kArgumentDelimiter);
 }
 
-void CpiDeviceLpec::Invocable::ProcessBool(TBool aVal)
+void CpiDeviceLpec::InputArgumentWriter::ProcessBool(TBool aVal)
 {
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
-    iDevice.iWriteBuffer->Write(aVal? Lpec::kBoolTrue : Lpec::kBoolFalse);
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(' ');
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(aVal? Lpec::kBoolTrue : Lpec::kBoolFalse);
+    iWriter.Write(Lpec::kArgumentDelimiter);
 }
 
-void CpiDeviceLpec::Invocable::ProcessBinary(const Brx& aVal)
+void CpiDeviceLpec::InputArgumentWriter::ProcessBinary(const Brx& aVal)
 {
-    iDevice.iWriteBuffer->Write(' ');
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
-    Converter::ToBase64(*(iDevice.iWriteBuffer), aVal);
-    iDevice.iWriteBuffer->Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(' ');
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Converter::ToBase64(iWriter, aVal);
+    iWriter.Write(Lpec::kArgumentDelimiter);
 }
 
-TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx& aBody)
+
+// CpiDeviceLpec::InvocationResponse
+
+CpiDeviceLpec::InvocationResponse::InvocationResponse(Invocation& aInvocation)
+    : iInvocation(aInvocation)
+    , iSem("CLPS", 0)
+{
+}
+
+void CpiDeviceLpec::InvocationResponse::Wait()
+{
+    iSem.Wait();
+}
+
+TBool CpiDeviceLpec::InvocationResponse::HandleLpecResponse(const Brx& aMethod, const Brx& aBody)
 {
     Brn body = Ascii::Trim(aBody);
     Parser parser(body);
@@ -382,7 +465,7 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
         }
         parser.Next(Lpec::kArgumentDelimiter);
         Brn description = parser.Next(Lpec::kArgumentDelimiter);
-        iInvocation->SetError(Error::eUpnp/*nearest alternative to eProtocol*/, code, description);
+        iInvocation.SetError(Error::eUpnp/*nearest alternative to eProtocol*/, code, description);
         iSem.Signal();
         return true;
     }
@@ -390,7 +473,7 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
         return false;
     }
 
-    const std::vector<Argument*>& outArgs = iInvocation->OutputArguments();
+    const std::vector<Argument*>& outArgs = iInvocation.OutputArguments();
     try {
         OutputProcessor outputProcessor;
         for (TUint i=0; i<outArgs.size(); i++) {
@@ -411,14 +494,26 @@ TBool CpiDeviceLpec::Invocable::HandleLpecResponse(const Brx& aMethod, const Brx
     return true;
 }
 
+void CpiDeviceLpec::InvocationResponse::HandleLpecFailure()
+{
+    iInvocation.SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown);
+    iSem.Signal();
+}
+
 
 // CpiDeviceLpec::SubscriptionResponse
 
-CpiDeviceLpec::SubscriptionResponse::SubscriptionResponse(Semaphore& aComplete)
-    : iComplete(aComplete)
+CpiDeviceLpec::SubscriptionResponse::SubscriptionResponse()
+    : iSem("CLS2", 0)
 {
 }
 
+TBool CpiDeviceLpec::SubscriptionResponse::Wait()
+{
+    iSem.Wait();
+    return (iSidFragment.Bytes() > 0);
+}
+
 const Brx& CpiDeviceLpec::SubscriptionResponse::SidFragment() const
 {
     return iSidFragment;
@@ -430,10 +525,28 @@ TBool CpiDeviceLpec::SubscriptionResponse::HandleLpecResponse(const Brx& aMethod
         return false;
     }
     iSidFragment.Replace(Ascii::Trim(aBody));
-    iComplete.Signal();
+    iSem.Signal();
     return true;
 }
 
+void CpiDeviceLpec::SubscriptionResponse::HandleLpecFailure()
+{
+    iSidFragment.SetBytes(0);
+    iSem.Signal();
+}
+
+
+// CpiDeviceLpec::UnsubscriptionResponse
+
+TBool CpiDeviceLpec::UnsubscriptionResponse::HandleLpecResponse(const Brx& aMethod, const Brx& /*aBody*/)
+{
+    return (aMethod == Lpec::kMethodUnsubscribe || aMethod == Lpec::kMethodError);
+}
+
+void CpiDeviceLpec::UnsubscriptionResponse::HandleLpecFailure()
+{
+}
+
 
 // CpiDeviceLpec::OutputProcessor
 
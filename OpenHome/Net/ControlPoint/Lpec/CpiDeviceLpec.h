@@ -12,6 +12,7 @@
 #include <OpenHome/Private/Thread.h>
 
 #include <limits.h>
+#include <list>
 
 namespace OpenHome {
     class Uri;
@@ -24,10 +25,19 @@ class IEventProcessor;
 class ILpecResponse
 {
 public:
-    virtual TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody) = 0;
+    virtual TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody) = 0; // false if aMethod isn't a reply to this request
+    virtual void HandleLpecFailure() = 0; // no reply will be received
     virtual ~ILpecResponse() {}
 };
 
+/**
+ * Client for a single LPEC connection.
+ *
+ * Requests from any number of threads are pipelined over the connection.  The server
+ * replies to requests in the order it receives them so each reply is matched to the
+ * oldest outstanding request.  At most InitialisationParams::CpLpecMaxPipelinedRequests()
+ * requests may be outstanding at once.
+ */
 class CpiDeviceLpec : private ICpiProtocol, private ICpiDeviceObserver
 {
     static const TUint kSubscriptionDurationSecs = 60 * 60 * 24; // arbitrarily chosen largish value
@@ -41,6 +51,9 @@ private:
     void LpecThread();
     void LogError(const TChar* aError);
     void HandleEventedUpdate(const Brx& aUpdate);
+    void SendRequest(const Brx& aRequest, ILpecResponse& aResponse);
+    void HandleResponse(const Brx& aMethod, const Brx& aBody, const Brx& aLine);
+    void FailPendingResponses();
 private: // from ICpiProtocol
     void InvokeAction(Invocation& aInvocation);
     TBool GetAttribute(const TChar* aKey, Brh& aValue) const;
@@ -53,36 +66,59 @@ private: // from ICpiProtocol
 private: // from ICpiDeviceObserver
     void Release();
 private:
-    class Invocable : public IInvocable, private IInputArgumentProcessor, private ILpecResponse, private INonCopyable
+    class Invocable : public IInvocable, private INonCopyable
     {
     public:
         Invocable(CpiDeviceLpec& aDevice);
     private: // from IInvocable
         void InvokeAction(Invocation& aInvocation);
+    private:
+        CpiDeviceLpec& iDevice;
+    };
+    class InputArgumentWriter : public IInputArgumentProcessor, private INonCopyable
+    {
+    public:
+        InputArgumentWriter(IWriter& aWriter);
     private: // from IInputArgumentProcessor
         void ProcessString(const Brx& aVal);
         void ProcessInt(TInt aVal);
         void ProcessUint(TUint aVal);
         void ProcessBool(TBool aVal);
         void ProcessBinary(const Brx& aVal);
+    private:
+        IWriter& iWriter;
+    };
+    class InvocationResponse : public ILpecResponse, private INonCopyable
+    {
+    public:
+        InvocationResponse(Invocation& aInvocation);
+        void Wait();
     private: // from ILpecResponse
         TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecFailure();
     private:
-        CpiDeviceLpec& iDevice;
+        Invocation& iInvocation;
         Semaphore iSem;
-        Invocation* iInvocation;
     };
     class SubscriptionResponse : public ILpecResponse, private INonCopyable
     {
     public:
-        SubscriptionResponse(Semaphore& aComplete);
+        SubscriptionResponse();
+        TBool Wait(); // false if the subscription failed
         const Brx& SidFragment() const;
     private: // from ILpecResponse
         TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecFailure();
     private:
-        Semaphore& iComplete;
+        Semaphore iSem;
         Bws<Ascii::kMaxUintStringBytes> iSidFragment;
     };
+    class UnsubscriptionResponse : public ILpecResponse
+    {
+    private: // from ILpecResponse
+        TBool HandleLpecResponse(const Brx& aMethod, const Brx& aBody);
+        void HandleLpecFailure();
+    };
     class OutputProcessor : public IOutputProcessor
     {
     private: // from IOutputProcessor
@@ -95,9 +131,11 @@ private:
 private:
     static const TUint kMaxReadBufferBytes = 12000;
     static const TUint kMaxWriteBufferBytes = 4000;
+    static const TUint kRequestGranularity = 256;
 
     CpStack& iCpStack;
     Mutex iLock;
+    Mutex iWriteLock;   // keeps requests in the same order as iPendingResponses
     SocketTcpClient iSocket;
     Srx* iReadBuffer;
     ReaderUntilS<kMaxReadBufferBytes>* iReaderUntil;
@@ -108,7 +146,10 @@ private:
     CpiDevice* iDevice;
     ThreadFunctor* iThread;
     Invocable* iInvocable;
-    ILpecResponse* iResponseHandler;
+    UnsubscriptionResponse iUnsubscriptionResponse;
+    std::list<ILpecResponse*> iPendingResponses; // oldest first
+    Semaphore iPipelineSlots;
+    TBool iResponsesEnded;
     TBool iConnected;
     TBool iExiting;
 };
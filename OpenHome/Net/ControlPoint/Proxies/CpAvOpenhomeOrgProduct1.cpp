@@ -512,10 +512,10 @@ void CpProxyAvOpenhomeOrgProduct1::BeginManufacturer(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionManufacturer, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionManufacturer->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -550,10 +550,10 @@ void CpProxyAvOpenhomeOrgProduct1::BeginModel(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionModel, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionModel->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -588,11 +588,11 @@ void CpProxyAvOpenhomeOrgProduct1::BeginProduct(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionProduct, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionProduct->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -628,7 +628,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginStandby(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionStandby, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionStandby->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -660,7 +660,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSetStandby(TBool aValue, FunctorAsync& a
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetStandby, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetStandby->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -690,7 +690,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSourceCount(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -722,7 +722,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSourceXml(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceXml, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXml->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -754,7 +754,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSourceIndex(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceIndex, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceIndex->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -786,7 +786,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSetSourceIndex(TUint aValue, FunctorAsyn
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetSourceIndex, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetSourceIndex->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -816,7 +816,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSetSourceIndexByName(const Brx& aValue,
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetSourceIndexByName, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetSourceIndexByName->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -846,13 +846,13 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSource(TUint aIndex, FunctorAsync& aFunc
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSource, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSource->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aIndex));
+    invocation->AddInputUint(*inParams[inIndex++], aIndex);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSource->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -887,7 +887,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginAttributes(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionAttributes, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionAttributes->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -919,7 +919,7 @@ void CpProxyAvOpenhomeOrgProduct1::BeginSourceXmlChangeCount(FunctorAsync& aFunc
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSourceXmlChangeCount, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSourceXmlChangeCount->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -172,14 +172,14 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1::BeginSubscribe(const Brx& aClientI
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSubscribe, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSubscribe->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aClientId));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aUdn));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aService));
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputString(*inParams[inIndex++], aClientId);
+    invocation->AddInputString(*inParams[inIndex++], aUdn);
+    invocation->AddInputString(*inParams[inIndex++], aService);
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionSubscribe->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -212,7 +212,7 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1::BeginUnsubscribe(const Brx& aSid,
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionUnsubscribe, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionUnsubscribe->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aSid));
+    invocation->AddInputString(*inParams[inIndex++], aSid);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -242,11 +242,11 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1::BeginRenew(const Brx& aSid, TUint
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionRenew, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionRenew->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aSid));
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aRequestedDuration));
+    invocation->AddInputString(*inParams[inIndex++], aSid);
+    invocation->AddInputUint(*inParams[inIndex++], aRequestedDuration);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionRenew->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -278,10 +278,10 @@ void CpProxyOpenhomeOrgSubscriptionLongPoll1::BeginGetPropertyUpdates(const Brx&
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetPropertyUpdates, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionGetPropertyUpdates->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aClientId));
+    invocation->AddInputString(*inParams[inIndex++], aClientId);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetPropertyUpdates->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -716,10 +716,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginIncrement(TUint aValue, FunctorAsync& aF
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionIncrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionIncrement->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionIncrement->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -751,10 +751,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginEchoAllowedRangeUint(TUint aValue, Funct
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionEchoAllowedRangeUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoAllowedRangeUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValue));
+    invocation->AddInputUint(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedRangeUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -786,10 +786,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginDecrement(TInt aValue, FunctorAsync& aFu
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionDecrement, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionDecrement->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValue));
+    invocation->AddInputInt(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionDecrement->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -821,10 +821,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginToggle(TBool aValue, FunctorAsync& aFunc
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionToggle, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionToggle->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValue));
+    invocation->AddInputBool(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionToggle->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -856,10 +856,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginEchoString(const Brx& aValue, FunctorAsy
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionEchoString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -891,10 +891,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginEchoAllowedValueString(const Brx& aValue
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionEchoAllowedValueString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoAllowedValueString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValue));
+    invocation->AddInputString(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoAllowedValueString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -926,10 +926,10 @@ void CpProxyOpenhomeOrgTestBasic1::BeginEchoBinary(const Brx& aValue, FunctorAsy
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionEchoBinary, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionEchoBinary->InputParameters();
-    invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], aValue));
+    invocation->AddInputBinary(*inParams[inIndex++], aValue);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionEchoBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -961,7 +961,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetUint(TUint aValueUint, FunctorAsync&
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetUint, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetUint->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -991,7 +991,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetUint(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetUint, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetUint->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1023,7 +1023,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetInt(TInt aValueInt, FunctorAsync& aFu
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetInt, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetInt->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1053,7 +1053,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetInt(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetInt, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetInt->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1085,7 +1085,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetBool(TBool aValueBool, FunctorAsync&
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetBool, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetBool->InputParameters();
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1115,7 +1115,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetBool(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetBool, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBool->OutputParameters();
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1147,9 +1147,9 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetMultiple(TUint aValueUint, TInt aValu
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetMultiple, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetMultiple->InputParameters();
-    invocation->AddInput(new ArgumentUint(*inParams[inIndex++], aValueUint));
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aValueInt));
-    invocation->AddInput(new ArgumentBool(*inParams[inIndex++], aValueBool));
+    invocation->AddInputUint(*inParams[inIndex++], aValueUint);
+    invocation->AddInputInt(*inParams[inIndex++], aValueInt);
+    invocation->AddInputBool(*inParams[inIndex++], aValueBool);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1179,9 +1179,9 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetMultiple(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetMultiple, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetMultiple->OutputParameters();
-    invocation->AddOutput(new ArgumentUint(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentBool(*outParams[outIndex++]));
+    invocation->AddOutputUint(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputBool(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1215,7 +1215,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetString(const Brx& aValueStr, FunctorA
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetString, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetString->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aValueStr));
+    invocation->AddInputString(*inParams[inIndex++], aValueStr);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1245,7 +1245,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetString(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetString, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetString->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1277,7 +1277,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginSetBinary(const Brx& aValueBin, FunctorA
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionSetBinary, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionSetBinary->InputParameters();
-    invocation->AddInput(new ArgumentBinary(*inParams[inIndex++], aValueBin));
+    invocation->AddInputBinary(*inParams[inIndex++], aValueBin);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1307,7 +1307,7 @@ void CpProxyOpenhomeOrgTestBasic1::BeginGetBinary(FunctorAsync& aFunctor)
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetBinary, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetBinary->OutputParameters();
-    invocation->AddOutput(new ArgumentBinary(*outParams[outIndex++]));
+    invocation->AddOutputBinary(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -1393,8 +1393,8 @@ void CpProxyOpenhomeOrgTestBasic1::BeginWriteFile(const Brx& aData, const Brx& a
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionWriteFile, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionWriteFile->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aData));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aFileFullName));
+    invocation->AddInputString(*inParams[inIndex++], aData);
+    invocation->AddInputString(*inParams[inIndex++], aFileFullName);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
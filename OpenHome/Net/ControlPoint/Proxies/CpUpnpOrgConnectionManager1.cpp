@@ -259,8 +259,8 @@ void CpProxyUpnpOrgConnectionManager1::BeginGetProtocolInfo(FunctorAsync& aFunct
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetProtocolInfo, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetProtocolInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -293,15 +293,15 @@ void CpProxyUpnpOrgConnectionManager1::BeginPrepareForConnection(const Brx& aRem
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionPrepareForConnection, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionPrepareForConnection->InputParameters();
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aRemoteProtocolInfo));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aPeerConnectionManager));
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aPeerConnectionID));
-    invocation->AddInput(new ArgumentString(*inParams[inIndex++], aDirection));
+    invocation->AddInputString(*inParams[inIndex++], aRemoteProtocolInfo);
+    invocation->AddInputString(*inParams[inIndex++], aPeerConnectionManager);
+    invocation->AddInputInt(*inParams[inIndex++], aPeerConnectionID);
+    invocation->AddInputString(*inParams[inIndex++], aDirection);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionPrepareForConnection->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -335,7 +335,7 @@ void CpProxyUpnpOrgConnectionManager1::BeginConnectionComplete(TInt aConnectionI
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionConnectionComplete, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionConnectionComplete->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -365,7 +365,7 @@ void CpProxyUpnpOrgConnectionManager1::BeginGetCurrentConnectionIDs(FunctorAsync
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetCurrentConnectionIDs, aFunctor);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionIDs->OutputParameters();
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
@@ -397,16 +397,16 @@ void CpProxyUpnpOrgConnectionManager1::BeginGetCurrentConnectionInfo(TInt aConne
     Invocation* invocation = iCpProxy.GetService().Invocation(*iActionGetCurrentConnectionInfo, aFunctor);
     TUint inIndex = 0;
     const Action::VectorParameters& inParams = iActionGetCurrentConnectionInfo->InputParameters();
-    invocation->AddInput(new ArgumentInt(*inParams[inIndex++], aConnectionID));
+    invocation->AddInputInt(*inParams[inIndex++], aConnectionID);
     TUint outIndex = 0;
     const Action::VectorParameters& outParams = iActionGetCurrentConnectionInfo->OutputParameters();
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentInt(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
-    invocation->AddOutput(new ArgumentString(*outParams[outIndex++]));
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputInt(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
+    invocation->AddOutputString(*outParams[outIndex++]);
     iCpProxy.GetInvocable().InvokeAction(*invocation);
 }
 
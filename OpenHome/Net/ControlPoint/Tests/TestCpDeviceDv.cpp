@@ -6,9 +6,14 @@
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/CpiStack.h>
+#include <OpenHome/Net/Private/CpiSubscription.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
+#include <new>
+#include <stdlib.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -20,7 +25,10 @@ namespace TestCpDeviceDv {
 class ProviderTestBasic : public DvProviderOpenhomeOrgTestBasic1
 {
 public:
-    ProviderTestBasic(DvDevice& aDevice);
+    /**
+     * If aIncrementGate is non-NULL, each Increment waits on it before responding
+     */
+    ProviderTestBasic(DvDevice& aDevice, Semaphore* aIncrementGate = NULL);
 private:
     void Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult);
     void Decrement(IDvInvocation& aInvocation, TInt aValue, IDvInvocationResponseInt& aResult);
@@ -38,12 +46,26 @@ private:
     void GetString(IDvInvocation& aInvocation, IDvInvocationResponseString& aValueStr);
     void SetBinary(IDvInvocation& aInvocation, const Brx& aValueBin);
     void GetBinary(IDvInvocation& aInvocation, IDvInvocationResponseBinary& aValueBin);
+private:
+    Semaphore* iIncrementGate;
+};
+
+class AsyncWaiter
+{
+public:
+    AsyncWaiter();
+    FunctorAsync Functor();
+    void Wait();
+private:
+    void Completed(IAsync& aAsync);
+private:
+    Semaphore iSem;
 };
 
 class DeviceBasic
 {
 public:
-    DeviceBasic(DvStack& aDvStack);
+    DeviceBasic(DvStack& aDvStack, Semaphore* aIncrementGate = NULL);
     ~DeviceBasic();
     DvDevice& Device();
 private:
@@ -55,8 +77,9 @@ private:
 } // namespace TestCpDeviceDv
 using namespace OpenHome::TestCpDeviceDv;
 
-ProviderTestBasic::ProviderTestBasic(DvDevice& aDevice)
+ProviderTestBasic::ProviderTestBasic(DvDevice& aDevice, Semaphore* aIncrementGate)
     : DvProviderOpenhomeOrgTestBasic1(aDevice)
+    , iIncrementGate(aIncrementGate)
 {
     EnablePropertyVarUint();
     EnablePropertyVarInt();
@@ -89,6 +112,9 @@ ProviderTestBasic::ProviderTestBasic(DvDevice& aDevice)
 
 void ProviderTestBasic::Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult)
 {
+    if (iIncrementGate != NULL) {
+        iIncrementGate->Wait();
+    }
     aInvocation.StartResponse();
     aResult.Write(++aValue);
     aInvocation.EndResponse();
@@ -230,9 +256,66 @@ void ProviderTestBasic::GetBinary(IDvInvocation& aInvocation, IDvInvocationRespo
 }
 
 
+AsyncWaiter::AsyncWaiter()
+    : iSem("TSEM", 0)
+{
+}
+
+FunctorAsync AsyncWaiter::Functor()
+{
+    return MakeFunctorAsync(*this, &AsyncWaiter::Completed);
+}
+
+void AsyncWaiter::Wait()
+{
+    iSem.Wait();
+}
+
+void AsyncWaiter::Completed(IAsync& /*aAsync*/)
+{
+    iSem.Signal();
+}
+
+
+// Count the allocations made by a single thread while gCountAllocations is set.
+static TBool gCountAllocations = false;
+static Thread* gAllocationThread = NULL;
+static TUint gAllocationCount = 0;
+
+void* operator new(size_t aBytes)
+{
+    if (gCountAllocations && Thread::Current() == gAllocationThread) {
+        gAllocationCount++;
+    }
+    void* ptr = malloc(aBytes==0? 1 : aBytes);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* aPtr) throw()
+{
+    free(aPtr);
+}
+
+static void StartCountingAllocations()
+{
+    gAllocationThread = Thread::Current();
+    gAllocationCount = 0;
+    gCountAllocations = true;
+}
+
+static TUint StopCountingAllocations()
+{
+    gCountAllocations = false;
+    return gAllocationCount;
+}
+
+
 static Bwh gDeviceName("device");
 
-DeviceBasic::DeviceBasic(DvStack& aDvStack)
+DeviceBasic::DeviceBasic(DvStack& aDvStack, Semaphore* aIncrementGate)
 {
     RandomiseUdn(aDvStack.Env(), gDeviceName);
     iDevice = new DvDevice(aDvStack, gDeviceName);
@@ -242,7 +325,7 @@ DeviceBasic::DeviceBasic(DvStack& aDvStack)
     iDevice->SetAttribute("Upnp.FriendlyName", "ohNetTestDevice");
     iDevice->SetAttribute("Upnp.Manufacturer", "None");
     iDevice->SetAttribute("Upnp.ModelName", "ohNet test device");
-    iTestBasic = new ProviderTestBasic(*iDevice);
+    iTestBasic = new ProviderTestBasic(*iDevice, aIncrementGate);
     iDevice->SetEnabled();
 }
 
@@ -317,6 +400,148 @@ static void TestInvocation(CpDevice& aDevice)
     delete proxy;
 }
 
+static const TUint kNumAllocationTestActions = 6;
+
+static void InvokeAction(CpProxyOpenhomeOrgTestBasic1& aProxy, AsyncWaiter& aWaiter, TUint aIndex, const Brx& aStr, const Brx& aBin)
+{
+    FunctorAsync functor = aWaiter.Functor();
+    switch (aIndex)
+    {
+    case 0:
+        aProxy.BeginIncrement(1, functor);
+        break;
+    case 1:
+        aProxy.BeginDecrement(1, functor);
+        break;
+    case 2:
+        aProxy.BeginToggle(true, functor);
+        break;
+    case 3:
+        aProxy.BeginEchoString(aStr, functor);
+        break;
+    case 4:
+        aProxy.BeginEchoBinary(aBin, functor);
+        break;
+    default:
+        aProxy.BeginSetMultiple(0, 0, false, functor); // leave properties unchanged for TestSubscription()
+        break;
+    }
+    aWaiter.Wait();
+}
+
+static void TestInvocationAllocations(CpStack& aCpStack, CpDevice& aDevice)
+{
+    static const TUint kTestIterations = 100;
+
+    Print("  Allocations per invocation\n");
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    AsyncWaiter waiter;
+    Brn valStr("<&'tag\">");
+    TByte bin[64];
+    for (TUint i=0; i<sizeof(bin); i++) {
+        bin[i] = (TByte)i;
+    }
+    Brn valBin(bin, sizeof(bin));
+
+    // check the counter itself
+    StartCountingAllocations();
+    TUint* ptr = new TUint(0);
+    delete ptr;
+    ASSERT(StopCountingAllocations() == 1);
+
+    /* each pooled Invocation allocates argument slots the first time it's used for an action
+       so run every action on (more than) every Invocation before counting */
+    const TUint warmups = 2 * aCpStack.Env().InitParams()->NumInvocations();
+    TUint i, j;
+    for (j=0; j<kNumAllocationTestActions; j++) {
+        for (i=0; i<warmups; i++) {
+            InvokeAction(*proxy, waiter, j, valStr, valBin);
+        }
+    }
+    StartCountingAllocations();
+    for (i=0; i<kTestIterations; i++) {
+        for (j=0; j<kNumAllocationTestActions; j++) {
+            InvokeAction(*proxy, waiter, j, valStr, valBin);
+        }
+    }
+    const TUint allocations = StopCountingAllocations();
+    Print("    %u allocations for %u invocations\n", allocations, kTestIterations * kNumAllocationTestActions);
+    ASSERT(allocations == 0);
+
+    delete proxy;
+}
+
+static void TestInvokerFairness(CpStack& aCpStack, DvStack& aDvStack, CpDevice& aDevice)
+{
+    Print("  Invoker fairness\n");
+    Semaphore gate("TGAT", 0);
+    DeviceBasic* slowDevice = new DeviceBasic(aDvStack, &gate);
+    CpDeviceDv* cpSlowDevice = CpDeviceDv::New(aCpStack, slowDevice->Device());
+    CpProxyOpenhomeOrgTestBasic1* slowProxy = new CpProxyOpenhomeOrgTestBasic1(*cpSlowDevice);
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    AsyncWaiter waiter;
+
+    // queue more blocked invocations on one device than there are invoker threads...
+    const TUint numSlow = 2 * aCpStack.Env().InitParams()->NumActionInvokerThreads();
+    FunctorAsync functor = waiter.Functor();
+    TUint i;
+    for (i=0; i<numSlow; i++) {
+        slowProxy->BeginIncrement(i, functor);
+    }
+    // ...and check that they don't prevent another device being invoked
+    TUint result;
+    proxy->SyncIncrement(1, result);
+    ASSERT(result == 2);
+
+    for (i=0; i<numSlow; i++) {
+        gate.Signal();
+    }
+    for (i=0; i<numSlow; i++) {
+        waiter.Wait();
+    }
+    delete proxy;
+    delete slowProxy;
+    cpSlowDevice->RemoveRef();
+    delete slowDevice;
+}
+
+static void BenchmarkSyncInvocations(CpStack& aCpStack, CpDevice& aDevice)
+{
+    static const TUint kTestIterations = 2000;
+
+    Print("  Sync invocations on invoker and caller threads\n");
+    InitialisationParams* initParams = aCpStack.Env().InitParams();
+    OsContext* ctx = aCpStack.Env().OsCtx();
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    for (TUint i=0; i<2; i++) {
+        const TBool callerThread = (i == 1);
+        initParams->SetCpSyncInvocationsOnCallerThread(callerThread);
+        const TUint64 start = Os::TimeInUs(ctx);
+        for (TUint j=0; j<kTestIterations; j++) {
+            TUint result;
+            proxy->SyncIncrement(j, result);
+            ASSERT(result == j+1);
+        }
+        const TUint elapsedUs = (TUint)(Os::TimeInUs(ctx) - start);
+        Print("    %s thread: %u invocations in %ums (%uus each)\n", (callerThread? "caller " : "invoker"),
+              kTestIterations, elapsedUs / 1000, elapsedUs / kTestIterations);
+    }
+
+    // errors are still reported by throwing from the Sync function
+    // (ProviderTestBasic doesn't enable EchoAllowedRangeUint)
+    TBool threw = false;
+    try {
+        TUint result;
+        proxy->SyncEchoAllowedRangeUint(10, result);
+    }
+    catch (ProxyError&) {
+        threw = true;
+    }
+    ASSERT(threw);
+    initParams->SetCpSyncInvocationsOnCallerThread(false);
+    delete proxy;
+}
+
 static void STDCALL updatesComplete(void* aPtr)
 {
     reinterpret_cast<Semaphore*>(aPtr)->Signal();
@@ -436,6 +661,66 @@ static void TestSubscription(CpDevice& aDevice)
     delete proxy; // automatically unsubscribes
 }
 
+static void TestSubscriptionRenewals(CpStack& aCpStack, CpDevice& aDevice)
+{
+    static const TUint kNumProxies = 8;
+    static const TUint kTimeoutMs = 10 * 1000;
+
+    Print("  Subscription renewals\n");
+    InitialisationParams* initParams = aCpStack.Env().InitParams();
+    const TUint durationSecs = initParams->SubscriptionDurationSecs();
+    initParams->SetSubscriptionDuration(2); // each subscription will be renewed after 1-1.5s
+    CpiRenewalScheduler& renewals = aCpStack.SubscriptionManager().Renewals();
+    CpiRenewalScheduler::Stats before;
+    renewals.GetStats(before);
+
+    Semaphore sem("TSRN", 0);
+    Functor functor = MakeFunctor(&sem, updatesComplete);
+    std::vector<CpProxyOpenhomeOrgTestBasic1*> proxies;
+    for (TUint i=0; i<kNumProxies; i++) {
+        CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+        proxy->SetPropertyInitialEvent(functor);
+        proxy->Subscribe();
+        proxies.push_back(proxy);
+    }
+    for (TUint i=0; i<kNumProxies; i++) {
+        sem.Wait();
+    }
+
+    // wait for every subscription to be renewed at least once
+    CpiRenewalScheduler::Stats after;
+    const TUint start = Time::Now(aCpStack.Env());
+    for (;;) {
+        renewals.GetStats(after);
+        if (after.iRenewals - before.iRenewals >= kNumProxies || Time::Now(aCpStack.Env()) - start > kTimeoutMs) {
+            break;
+        }
+        Thread::Sleep(100);
+    }
+    const TUint numRenewals = after.iRenewals - before.iRenewals;
+    const TUint numBatches = after.iBatches - before.iBatches;
+    Print("    %u renewals in %u batches, peak concurrency %u, latency %ums avg / %ums max\n",
+          numRenewals, numBatches, after.iPeakConcurrent, after.iAvgLatencyMs, after.iMaxLatencyMs);
+    ASSERT(numRenewals >= kNumProxies);
+    // all subscriptions are to the same device so renewals are grouped and run back to back
+    ASSERT(numBatches < numRenewals);
+    ASSERT(after.iPeakConcurrent == 1);
+
+    // check that renewed subscriptions still deliver updates
+    CpProxyOpenhomeOrgTestBasic1* proxy = proxies[0];
+    proxy->SetPropertyChanged(functor);
+    proxy->SyncSetUint(7);
+    sem.Wait();
+    TUint propUint;
+    proxy->PropertyVarUint(propUint);
+    ASSERT(propUint == 7);
+
+    for (TUint i=0; i<kNumProxies; i++) {
+        delete proxies[i];
+    }
+    initParams->SetSubscriptionDuration(durationSecs);
+}
+
 void TestCpDeviceDv(CpStack& aCpStack, DvStack& aDvStack)
 {
     Print("TestCpDeviceDv - starting\n");
@@ -443,7 +728,11 @@ void TestCpDeviceDv(CpStack& aCpStack, DvStack& aDvStack)
     DeviceBasic* device = new DeviceBasic(aDvStack);
     CpDeviceDv* cpDevice = CpDeviceDv::New(aCpStack, device->Device());
     TestInvocation(*cpDevice);
+    TestInvocationAllocations(aCpStack, *cpDevice);
+    TestInvokerFairness(aCpStack, aDvStack, *cpDevice);
+    BenchmarkSyncInvocations(aCpStack, *cpDevice);
     TestSubscription(*cpDevice);
+    TestSubscriptionRenewals(aCpStack, *cpDevice);
     cpDevice->RemoveRef();
     delete device;
 
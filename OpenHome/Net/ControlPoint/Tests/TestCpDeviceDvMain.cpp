@@ -12,6 +12,9 @@ extern void TestCpDeviceDv(CpStack& aCpStack, DvStack& aDvStack);
 void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
 {
     aInitParams->SetUseLoopbackNetworkAdapter();
+    // CpDeviceDv invocations hold an invoker thread until they complete so TestInvokerFairness
+    // relies on a blocked device leaving some threads for others
+    aInitParams->SetCpMaxInvokersPerDevice(aInitParams->NumActionInvokerThreads() / 2);
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
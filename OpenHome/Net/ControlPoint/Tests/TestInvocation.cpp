@@ -1,6 +1,8 @@
 // Test for service/action invocation
 // Builds a list of providers of the ConnectionManager service
 // ... then checks how many times GetProtocolInfo can be run on each device in a second
+// Benchmark mode instead reports the latency of sync GetProtocolInfo calls to each device,
+// with and without reuse of invocation connections
 
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Types.h>
@@ -16,6 +18,7 @@
 #include <OpenHome/Net/Core/CpUpnpOrgConnectionManager1.h>
 
 #include <vector>
+#include <algorithm>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -33,12 +36,14 @@ public:
     void Stop();
     void TestSync();
     void Poll();
+    void Benchmark(TUint aIterations);
     TUint Count() const;
     void Added(CpDevice& aDevice);
     void Removed(CpDevice& aDevice);
 private:
     void TimerExpired();
     void GetProtocolInfoComplete(IAsync& aAsync);
+    void BenchmarkDevice(CpDevice& aDevice, TUint aIterations, TBool aKeepAlive);
 private:
     Environment& iEnv;
     Mutex iLock;
@@ -127,6 +132,61 @@ void DeviceListTI::Poll()
     }
 }
 
+void DeviceListTI::Benchmark(TUint aIterations)
+{
+    TUint maxIdle, idleTimeoutMs;
+    iEnv.InitParams()->GetCpInvocationKeepAlive(maxIdle, idleTimeoutMs);
+    const TUint count = (TUint)iList.size();
+    for (TUint i=0; i<count; i++) {
+        CpDevice* device = iList[i];
+        Print("Device ");
+        Print(device->Udn());
+        Print("\n");
+        BenchmarkDevice(*device, aIterations, false);
+        BenchmarkDevice(*device, aIterations, true);
+    }
+    iEnv.InitParams()->SetCpInvocationKeepAlive(maxIdle, idleTimeoutMs);
+}
+
+void DeviceListTI::BenchmarkDevice(CpDevice& aDevice, TUint aIterations, TBool aKeepAlive)
+{
+    if (aKeepAlive) {
+        iEnv.InitParams()->SetCpInvocationKeepAlive(1, 30 * 1000);
+    }
+    else {
+        iEnv.InitParams()->SetCpInvocationKeepAlive(0, 0);
+    }
+    CpProxyUpnpOrgConnectionManager1* connMgr = new CpProxyUpnpOrgConnectionManager1(aDevice);
+    std::vector<TUint> latenciesUs;
+    latenciesUs.reserve(aIterations);
+    TUint errors = 0;
+    Brh source;
+    Brh sink;
+    for (TUint i=0; i<aIterations; i++) {
+        const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+        try {
+            connMgr->SyncGetProtocolInfo(source, sink);
+        }
+        catch (ProxyError&) {
+            errors++;
+            continue;
+        }
+        latenciesUs.push_back((TUint)(Os::TimeInUs(iEnv.OsCtx()) - start));
+    }
+    delete connMgr;
+
+    Print("    keep-alive %s: ", (aKeepAlive? "on " : "off"));
+    const TUint completed = (TUint)latenciesUs.size();
+    if (completed == 0) {
+        Print("no successful invocations (%u errors)\n", errors);
+        return;
+    }
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    const TUint p50 = latenciesUs[completed / 2];
+    const TUint p99 = latenciesUs[std::min(completed - 1, (completed * 99) / 100)];
+    Print("p50 %uus, p99 %uus (%u invocations, %u errors)\n", p50, p99, completed, errors);
+}
+
 TUint DeviceListTI::Count() const
 {
     return (TUint)iList.size();
@@ -196,33 +256,35 @@ void DeviceListTI::Removed(CpDevice& aDevice)
 }
 
 
-void TestInvocation(CpStack& aCpStack)
+static DeviceListTI* FindDevices(CpStack& aCpStack, CpDeviceListUpnpServiceType*& aList)
 {
-    gActionCount = 0; // reset this here in case we're run multiple times via TestShell
     Environment& env = aCpStack.Env();
-    FunctorAsync dummy;
-    /* Set an empty handler for errors to avoid test output being swamped by expected
-       errors from invocations we interrupt at the end of each device's 1s timeslice */
-    env.InitParams()->SetAsyncErrorHandler(dummy);
-
-    Debug::SetLevel(Debug::kNone);
     DeviceListTI* deviceList = new DeviceListTI(env);
     FunctorCpDevice added = MakeFunctorCpDevice(*deviceList, &DeviceListTI::Added);
     FunctorCpDevice removed = MakeFunctorCpDevice(*deviceList, &DeviceListTI::Removed);
     const Brn domainName("upnp.org");
     const Brn serviceType("ConnectionManager");
-#if 1
     const TUint ver = 1;
-    CpDeviceListUpnpServiceType* list =
-                new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, added, removed);
-#else
-    const Brn uuid("7076436f-6e65-1063-8074-000da201f542");
-    CpDeviceListUpnpUuid* list = new CpDeviceListUpnpUuid(aCpStack, uuid, added, removed);
-#endif
+    aList = new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, added, removed);
     Blocker* blocker = new Blocker(env);
     blocker->Wait(env.InitParams()->MsearchTimeSecs());
     delete blocker;
     deviceList->Stop();
+    return deviceList;
+}
+
+void TestInvocation(CpStack& aCpStack)
+{
+    gActionCount = 0; // reset this here in case we're run multiple times via TestShell
+    Environment& env = aCpStack.Env();
+    FunctorAsync dummy;
+    /* Set an empty handler for errors to avoid test output being swamped by expected
+       errors from invocations we interrupt at the end of each device's 1s timeslice */
+    env.InitParams()->SetAsyncErrorHandler(dummy);
+
+    Debug::SetLevel(Debug::kNone);
+    CpDeviceListUpnpServiceType* list;
+    DeviceListTI* deviceList = FindDevices(aCpStack, list);
 
     TUint startTime = Os::TimeInMs(env.OsCtx());
     //deviceList->TestSync();
@@ -235,3 +297,17 @@ void TestInvocation(CpStack& aCpStack)
     delete list;
     delete deviceList;
 }
+
+void TestInvocationBenchmark(CpStack& aCpStack, TUint aIterations)
+{
+    Debug::SetLevel(Debug::kNone);
+    CpDeviceListUpnpServiceType* list;
+    DeviceListTI* deviceList = FindDevices(aCpStack, list);
+    if (deviceList->Count() == 0) {
+        Print("No devices found, so nothing to benchmark\n");
+    }
+    deviceList->Benchmark(aIterations);
+
+    delete list;
+    delete deviceList;
+}
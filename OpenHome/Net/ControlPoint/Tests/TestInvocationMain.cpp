@@ -9,16 +9,29 @@ using namespace OpenHome;
 using namespace OpenHome::Net;
 
 extern void TestInvocation(CpStack& aCpStack);
+extern void TestInvocationBenchmark(CpStack& aCpStack, TUint aIterations);
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionUint bench("-b", "--benchmark", 0, "[iterations] report latency of this many invocations per device with keep-alive off then on");
+    parser.AddOption(&bench);
+    if (!parser.Parse(aArgc, aArgv) || parser.HelpDisplayed()) {
+        return;
+    }
+
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
     Library::DestroySubnetList(subnetList);
     CpStack* cpStack = lib->StartCp(subnet);
 
-    TestInvocation(*cpStack);
+    if (bench.Value() > 0) {
+        TestInvocationBenchmark(*cpStack, bench.Value());
+    }
+    else {
+        TestInvocation(*cpStack);
+    }
 
     delete lib;
 }
@@ -21,22 +21,556 @@
 #include <OpenHome/OsWrapper.h>
 #include <OpenHome/Net/Private/Globals.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
+#include <OpenHome/Net/Private/Ssdp.h>
+#include <OpenHome/Private/File.h>
 
 #include <string.h>
+#include <time.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
 
+// CpiDeviceDescription
+
+CpiDeviceDescription::CpiDeviceDescription(Brh& aXml)
+    : iLock("CDDS")
+    , iRefCount(1)
+{
+    aXml.TransferTo(iXml);
+    try {
+        iDocument = new DeviceXmlDocument(iXml);
+    }
+    catch (XmlError&) {
+        iXml.TransferTo(aXml);
+        throw;
+    }
+}
+
+CpiDeviceDescription::~CpiDeviceDescription()
+{
+    delete iDocument;
+}
+
+void CpiDeviceDescription::AddRef()
+{
+    AutoMutex _(iLock);
+    iRefCount++;
+}
+
+void CpiDeviceDescription::RemoveRef()
+{
+    iLock.Wait();
+    const TBool dead = (--iRefCount == 0);
+    iLock.Signal();
+    if (dead) {
+        delete this;
+    }
+}
+
+TBool CpiDeviceDescription::IsShared() const
+{
+    AutoMutex _(iLock);
+    return (iRefCount > 1);
+}
+
+const Brx& CpiDeviceDescription::Xml() const
+{
+    return iXml;
+}
+
+DeviceXmlDocument& CpiDeviceDescription::Document()
+{
+    return *iDocument;
+}
+
+
+// CpiDeviceDescriptionCache
+
+const Brn CpiDeviceDescriptionCache::kQueryDescriptions("descriptioncache");
+const Brn CpiDeviceDescriptionCache::kFileMagic("OHDC");
+const Brn CpiDeviceDescriptionCache::kTempSuffix(".tmp");
+
+static TUint64 WallClockSecs()
+{
+    // Os::TimeInUs() is relative to library startup so can't be compared across runs
+    return (TUint64)time(NULL);
+}
+
+CpiDeviceDescriptionCache::CpiDeviceDescriptionCache(Environment& aEnv)
+    : iEnv(aEnv)
+    , iLock("CDDC")
+    , iMaxAgeSecs(0)
+    , iHits(0)
+    , iMisses(0)
+    , iCoalesced(0)
+    , iInvalidated(0)
+    , iFetchErrors(0)
+    , iRestoredSeen(0)
+{
+    const TChar* path;
+    TUint maxAgeSecs;
+    if (aEnv.InitParams()->CpIsUpnpDeviceCacheEnabled(path, maxAgeSecs)) {
+        iPath.Set(path);
+        iMaxAgeSecs = maxAgeSecs;
+        Load();
+    }
+    IInfoAggregator* infoAggregator = aEnv.InfoAggregator();
+    if (infoAggregator != NULL) {
+        std::vector<Brn> queries;
+        queries.push_back(kQueryDescriptions);
+        infoAggregator->Register(*this, queries);
+    }
+}
+
+CpiDeviceDescriptionCache::~CpiDeviceDescriptionCache()
+{
+    Save();
+    Map::iterator it = iMap.begin();
+    for (; it != iMap.end(); ++it) {
+        delete it->second;
+    }
+    for (TUint i=0; i<(TUint)iRestored.size(); i++) {
+        delete iRestored[i];
+    }
+}
+
+void CpiDeviceDescriptionCache::GetRestored(const TIpAddress& aInterface, std::vector<RestoredDevice>& aDevices)
+{
+    AutoMutex _(iLock);
+    for (TUint i=0; i<(TUint)iRestored.size(); i++) {
+        Entry* entry = iRestored[i];
+        if (TIpAddressUtils::Equals(entry->iInterface, aInterface)) {
+            RestoredDevice device;
+            device.iUdn.Set(entry->iUdn);
+            device.iLocation.Set(entry->iLocation);
+            device.iConfigId = entry->iConfigId;
+            device.iDescription = entry->iDescription;
+            device.iDescription->AddRef();
+            aDevices.push_back(device);
+        }
+    }
+}
+
+void CpiDeviceDescriptionCache::DeviceSeen(const Brx& aUdn, TBool aConfirmsRestored)
+{
+    const TUint64 now = WallClockSecs();
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    Map::iterator it = iMap.find(udn);
+    if (it != iMap.end() && it->second->iDescription != NULL) {
+        it->second->iSeenSecs = now;
+    }
+    for (TUint i=0; i<(TUint)iRestored.size(); i++) {
+        if (iRestored[i]->iUdn == aUdn) {
+            iRestored[i]->iSeenSecs = now;
+            if (aConfirmsRestored) {
+                iRestoredSeen++;
+            }
+            break;
+        }
+    }
+}
+
+CpiDeviceDescription* CpiDeviceDescriptionCache::Claim(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface,
+                                                       ICpiDeviceDescriptionObserver& aObserver, TBool& aFetch)
+{
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    Map::iterator it = iMap.find(udn);
+    if (it != iMap.end()) {
+        Entry* entry = it->second;
+        if (entry->Matches(aLocation, aConfigId)) {
+            if (entry->iDescription == NULL) {
+                entry->iWaiters.push_back(&aObserver);
+                iCoalesced++;
+                aFetch = false;
+                return NULL;
+            }
+            if (entry->Reusable()) {
+                entry->iDescription->AddRef();
+                entry->iSeenSecs = WallClockSecs();
+                iHits++;
+                aFetch = false;
+                return entry->iDescription;
+            }
+        }
+        iMisses++;
+        aFetch = true;
+        if (entry->iDescription == NULL) {
+            // another device is fetching a different description for this udn; don't disturb it
+            return NULL;
+        }
+        if (!entry->Matches(aLocation, aConfigId)) {
+            iInvalidated++;
+        }
+        EraseLocked(it);
+    }
+    else {
+        iMisses++;
+        aFetch = true;
+    }
+    Entry* entry = new Entry(aUdn, aLocation, aConfigId, aInterface);
+    iMap.insert(std::pair<Brn,Entry*>(Brn(entry->iUdn), entry));
+    PruneLocked();
+    return NULL;
+}
+
+CpiDeviceDescription* CpiDeviceDescriptionCache::Store(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, Brh& aXml)
+{
+    CpiDeviceDescription* description;
+    try {
+        description = new CpiDeviceDescription(aXml);
+    }
+    catch (XmlError&) {
+        FetchFailed(aUdn, aLocation, aConfigId);
+        throw;
+    }
+    Waiters waiters;
+    iLock.Wait();
+    Map::iterator it = FindPendingLocked(aUdn, aLocation, aConfigId);
+    if (it != iMap.end()) {
+        Entry* entry = it->second;
+        entry->iDescription = description;
+        entry->iSeenSecs = WallClockSecs();
+        description->AddRef();
+        waiters.swap(entry->iWaiters);
+        for (TUint i=0; i<(TUint)waiters.size(); i++) {
+            description->AddRef();
+        }
+        PruneLocked();
+    }
+    iLock.Signal();
+    Notify(waiters, description);
+    return description;
+}
+
+void CpiDeviceDescriptionCache::FetchFailed(const Brx& aUdn, const Brx& aLocation, TUint aConfigId)
+{
+    Waiters waiters;
+    iLock.Wait();
+    iFetchErrors++;
+    Map::iterator it = FindPendingLocked(aUdn, aLocation, aConfigId);
+    if (it != iMap.end()) {
+        waiters.swap(it->second->iWaiters);
+        EraseLocked(it);
+    }
+    iLock.Signal();
+    Notify(waiters, NULL);
+}
+
+TBool CpiDeviceDescriptionCache::CancelWait(const Brx& aUdn, ICpiDeviceDescriptionObserver& aObserver)
+{
+    AutoMutex _(iLock);
+    Brn udn(aUdn);
+    Map::iterator it = iMap.find(udn);
+    if (it == iMap.end()) {
+        return false;
+    }
+    Waiters& waiters = it->second->iWaiters;
+    for (Waiters::iterator it2 = waiters.begin(); it2 != waiters.end(); ++it2) {
+        if (*it2 == &aObserver) {
+            waiters.erase(it2);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CpiDeviceDescriptionCache::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery != kQueryDescriptions) {
+        return;
+    }
+    Bws<160> summary;
+    iLock.Wait();
+    summary.AppendPrintf("Device descriptions: %u cached, %u restored (%u seen)\n",
+                         (TUint)iMap.size(), (TUint)iRestored.size(), iRestoredSeen);
+    summary.AppendPrintf("\t%u hits, %u misses, %u coalesced, %u invalidated, %u fetch errors\n",
+                         iHits, iMisses, iCoalesced, iInvalidated, iFetchErrors);
+    iLock.Signal();
+    aWriter.Write(summary);
+}
+
+CpiDeviceDescriptionCache::Map::iterator CpiDeviceDescriptionCache::FindPendingLocked(const Brx& aUdn, const Brx& aLocation, TUint aConfigId)
+{
+    Brn udn(aUdn);
+    Map::iterator it = iMap.find(udn);
+    if (it != iMap.end() && (it->second->iDescription != NULL || !it->second->Matches(aLocation, aConfigId))) {
+        it = iMap.end();
+    }
+    return it;
+}
+
+void CpiDeviceDescriptionCache::EraseLocked(Map::iterator aIt)
+{
+    Entry* entry = aIt->second;
+    iMap.erase(aIt);
+    delete entry;
+}
+
+void CpiDeviceDescriptionCache::PruneLocked()
+{
+    /* Descriptions nobody else holds are only worth keeping if they can be validated
+       against a later CONFIGID or will be saved for the next run.  Cap the number of
+       those we retain too. */
+    const TBool persist = (iPath.Bytes() > 0);
+    Map::iterator it = iMap.begin();
+    while (it != iMap.end()) {
+        Entry* entry = it->second;
+        if (entry->iDescription != NULL && !entry->iDescription->IsShared() &&
+            ((!persist && !entry->Reusable()) || iMap.size() > kMaxEntries)) {
+            Map::iterator next = it;
+            ++next;
+            EraseLocked(it);
+            it = next;
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void CpiDeviceDescriptionCache::Notify(Waiters& aWaiters, CpiDeviceDescription* aDescription)
+{
+    for (TUint i=0; i<(TUint)aWaiters.size(); i++) {
+        aWaiters[i]->DescriptionFetched(aDescription);
+    }
+}
+
+/*
+ * File format (all integers big endian)
+ *   magic[4] version[1] count[4]
+ *   count * { seenSecs[8] udnBytes[2] udn locationBytes[2] location configId[4]
+ *             family[1] v4[4] v6[16] xmlBytes[4] xml }
+ * seenSecs values are wall clock seconds.  Entries with seenSecs in the future are
+ * assumed to be from before a clock reset and are discarded.
+ */
+
+static Brn ReadBytes(ReaderBuffer& aReader, TUint aBytes)
+{
+    Brn buf = aReader.Read(aBytes);
+    if (buf.Bytes() != aBytes) {
+        THROW(ReaderError);
+    }
+    return buf;
+}
+
+void CpiDeviceDescriptionCache::Load()
+{
+    Bwh file;
+    try {
+        IFile* f = IFile::Open(iPath.CString(), eFileReadOnly);
+        try {
+            file.Grow(f->Bytes());
+            while (file.BytesRemaining() > 0) {
+                f->Read(file);
+            }
+        }
+        catch (FileReadError&) {
+            file.SetBytes(0);
+        }
+        delete f;
+    }
+    catch (FileOpenError&) {
+        return;
+    }
+
+    const TUint64 now = WallClockSecs();
+    std::vector<Entry*> restored;
+    ReaderBuffer reader(file);
+    ReaderBinary readerBinary(reader);
+    try {
+        if (ReadBytes(reader, kFileMagic.Bytes()) != kFileMagic || readerBinary.ReadUintBe(1) != kFileVersion) {
+            THROW(ReaderError);
+        }
+        const TUint count = readerBinary.ReadUintBe(4);
+        for (TUint i=0; i<count; i++) {
+            const TUint64 seenSecs = readerBinary.ReadUint64Be(8);
+            Brn udn = ReadBytes(reader, readerBinary.ReadUintBe(2));
+            Brn location = ReadBytes(reader, readerBinary.ReadUintBe(2));
+            const TUint configId = readerBinary.ReadUintBe(4);
+            TIpAddress iface;
+            iface.iFamily = (uint8_t)readerBinary.ReadUintBe(1);
+            iface.iV4 = readerBinary.ReadUintBe(4);
+            Brn v6 = ReadBytes(reader, sizeof(iface.iV6));
+            (void)memcpy(iface.iV6, v6.Ptr(), sizeof(iface.iV6));
+            Brh xml(ReadBytes(reader, readerBinary.ReadUintBe(4)));
+            if (seenSecs > now || now - seenSecs > iMaxAgeSecs) {
+                continue;
+            }
+            Entry* entry = new Entry(udn, location, configId, iface);
+            entry->iSeenSecs = seenSecs;
+            try {
+                entry->iDescription = new CpiDeviceDescription(xml);
+            }
+            catch (XmlError&) {
+                delete entry;
+                continue;
+            }
+            restored.push_back(entry);
+        }
+    }
+    catch (ReaderError&) {
+        LOG_ERROR(kDevice, "Ignoring corrupt device cache %s\n", iPath.CString());
+        for (TUint i=0; i<(TUint)restored.size(); i++) {
+            delete restored[i];
+        }
+        return;
+    }
+
+    AutoMutex _(iLock);
+    iRestored.swap(restored);
+    for (TUint i=0; i<(TUint)iRestored.size(); i++) {
+        Entry* entry = iRestored[i];
+        if (entry->iConfigId == Ssdp::kConfigIdUnknown || iMap.find(Brn(entry->iUdn)) != iMap.end()) {
+            continue;
+        }
+        // descriptions with a CONFIGID can be validated against future announcements so can also be shared
+        Entry* shared = new Entry(entry->iUdn, entry->iLocation, entry->iConfigId, entry->iInterface);
+        shared->iSeenSecs = entry->iSeenSecs;
+        shared->iDescription = entry->iDescription;
+        shared->iDescription->AddRef();
+        iMap.insert(std::pair<Brn,Entry*>(Brn(shared->iUdn), shared));
+    }
+}
+
+void CpiDeviceDescriptionCache::Save()
+{
+    if (iPath.Bytes() == 0) {
+        return;
+    }
+    const TUint64 now = WallClockSecs();
+    Map latest;
+    for (TUint i=0; i<(TUint)iRestored.size(); i++) {
+        latest.insert(std::pair<Brn,Entry*>(Brn(iRestored[i]->iUdn), iRestored[i]));
+    }
+    for (Map::iterator it = iMap.begin(); it != iMap.end(); ++it) {
+        Entry* entry = it->second;
+        if (entry->iDescription == NULL) {
+            continue;
+        }
+        Map::iterator it2 = latest.find(it->first);
+        if (it2 == latest.end()) {
+            latest.insert(std::pair<Brn,Entry*>(it->first, entry));
+        }
+        else if (entry->iSeenSecs >= it2->second->iSeenSecs) {
+            it2->second = entry;
+        }
+    }
+
+    WriterBwh writer(1024);
+    WriterBinary writerBinary(writer);
+    TUint count = 0;
+    for (Map::iterator it = latest.begin(); it != latest.end(); ++it) {
+        if (now - it->second->iSeenSecs <= iMaxAgeSecs) {
+            count++;
+        }
+    }
+    writerBinary.Write(kFileMagic);
+    writerBinary.WriteUint8(kFileVersion);
+    writerBinary.WriteUint32Be(count);
+    for (Map::iterator it = latest.begin(); it != latest.end(); ++it) {
+        const Entry& entry = *(it->second);
+        if (now - entry.iSeenSecs > iMaxAgeSecs) {
+            continue;
+        }
+        const Brx& xml = entry.iDescription->Xml();
+        writerBinary.WriteUint64Be(entry.iSeenSecs);
+        writerBinary.WriteUint16Be(entry.iUdn.Bytes());
+        writerBinary.Write(entry.iUdn);
+        writerBinary.WriteUint16Be(entry.iLocation.Bytes());
+        writerBinary.Write(entry.iLocation);
+        writerBinary.WriteUint32Be(entry.iConfigId);
+        writerBinary.WriteUint8(entry.iInterface.iFamily);
+        writerBinary.WriteUint32Be(entry.iInterface.iV4);
+        writerBinary.Write(Brn(entry.iInterface.iV6, sizeof(entry.iInterface.iV6)));
+        writerBinary.WriteUint32Be(xml.Bytes());
+        writerBinary.Write(xml);
+    }
+
+    // write to a temporary file then replace the old cache so a crash can't leave a partial file behind
+    Bwh tmpPath(iPath.Bytes() + kTempSuffix.Bytes() + 1);
+    tmpPath.Append(iPath);
+    tmpPath.Append(kTempSuffix);
+    const TChar* tmpName = tmpPath.PtrZ();
+    TBool written = false;
+    try {
+        IFile* f = IFile::Open(tmpName, eFileWriteOnly);
+        try {
+            f->Write(writer.Buffer());
+            f->Flush();
+            f->Sync();
+            written = true;
+        }
+        catch (FileWriteError&) {
+            LOG_ERROR(kDevice, "Failed to write device cache %s\n", iPath.CString());
+        }
+        delete f;
+    }
+    catch (FileOpenError&) {
+        LOG_ERROR(kDevice, "Failed to open device cache %s\n", iPath.CString());
+    }
+    FileSystemAnsi fileSystem;
+    try {
+        if (written) {
+            fileSystem.Rename(tmpName, iPath.CString());
+        }
+        else {
+            fileSystem.Unlink(tmpName);
+        }
+    }
+    catch (RenameFailed&) {
+        LOG_ERROR(kDevice, "Failed to replace device cache %s\n", iPath.CString());
+    }
+    catch (UnlinkFailed&) {
+    }
+}
+
+// CpiDeviceDescriptionCache::Entry
+
+CpiDeviceDescriptionCache::Entry::Entry(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface)
+    : iUdn(aUdn)
+    , iLocation(aLocation)
+    , iConfigId(aConfigId)
+    , iInterface(aInterface)
+    , iSeenSecs(0)
+    , iDescription(NULL)
+{
+}
+
+CpiDeviceDescriptionCache::Entry::~Entry()
+{
+    ASSERT(iWaiters.size() == 0);
+    if (iDescription != NULL) {
+        iDescription->RemoveRef();
+    }
+}
+
+TBool CpiDeviceDescriptionCache::Entry::Matches(const Brx& aLocation, TUint aConfigId) const
+{
+    return (iConfigId == aConfigId && iLocation == aLocation);
+}
+
+TBool CpiDeviceDescriptionCache::Entry::Reusable() const
+{
+    return (iConfigId != Ssdp::kConfigIdUnknown || iDescription->IsShared());
+}
+
+
 // CpiDeviceUpnp
 
-CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList)
+CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, TUint aConfigId, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList)
     : iCpStack(aCpStack)
     , iLock("CDUP")
     , iLocation(aLocation)
     , iXmlFetch(NULL)
-    , iDeviceXmlDocument(NULL)
+    , iDescription(NULL)
     , iDeviceXml(NULL)
+    , iConfigId(aConfigId)
+    , iInterface(aList.Interface())
+    , iAwaitingDescription(false)
+    , iTentative(false)
     , iExpiryTime(0)
     , iMaxAgeSeconds(aMaxAgeSecs)
     , iDeviceList(aDeviceList)
@@ -53,6 +587,8 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLoc
     iTimer = new Timer(env, MakeFunctor(*this, &CpiDeviceUpnp::TimerExpired), "CpiDeviceUpnp");
     UpdateMaxAge(aMaxAgeSecs);
     iInvocable = new Invocable(*this);
+    iConnectionCache = new InvocationConnectionCache(aCpStack.Env());
+    iRenewConnectionCache = new InvocationConnectionCache(aCpStack.Env(), 1, kRenewConnectionIdleTimeoutMs);
 }
 
 CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList)
@@ -60,8 +596,12 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRem
     , iLock("CDUP")
     , iLocation(aLocation)
     , iXmlFetch(NULL)
-    , iDeviceXmlDocument(NULL)
+    , iDescription(NULL)
     , iDeviceXml(NULL)
+    , iConfigId(Ssdp::kConfigIdUnknown)
+    , iInterface(aList.Interface())
+    , iAwaitingDescription(false)
+    , iTentative(false)
     , iExpiryTime(0)
     , iMaxAgeSeconds(0)
     , iDeviceList(aDeviceList)
@@ -76,6 +616,8 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRem
     iDevice = NULL; // we need to read device XML to find the udn first
     iTimer = NULL; // don't assume we'll receive later ALIVEs
     iInvocable = new Invocable(*this);
+    iConnectionCache = new InvocationConnectionCache(aCpStack.Env());
+    iRenewConnectionCache = new InvocationConnectionCache(aCpStack.Env(), 1, kRenewConnectionIdleTimeoutMs);
 
     AutoMutex _(iLock);
     XmlFetchManager& xmlFetchManager = aCpStack.XmlFetchManager();
@@ -85,6 +627,38 @@ CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRem
     xmlFetchManager.Fetch(iXmlFetch);
 }
 
+CpiDeviceUpnp::CpiDeviceUpnp(CpStack& aCpStack, const CpiDeviceDescriptionCache::RestoredDevice& aRestored, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList)
+    : iCpStack(aCpStack)
+    , iLock("CDUP")
+    , iLocation(aRestored.iLocation)
+    , iXmlFetch(NULL)
+    , iDescription(aRestored.iDescription)
+    , iDeviceXml(NULL)
+    , iConfigId(aRestored.iConfigId)
+    , iInterface(aList.Interface())
+    , iAwaitingDescription(false)
+    , iTentative(true)
+    , iExpiryTime(0)
+    , iMaxAgeSeconds(0)
+    , iDeviceList(aDeviceList)
+    , iList(&aList)
+    , iSemReady("CDUS", 0)
+    , iRemoved(false)
+    , iNewLocation(NULL)
+    , iXmlCheckLocation(NULL)
+    , iXmlCheckRefresh(NULL)
+{
+    Environment& env = aCpStack.Env();
+    iHostUdpIsLowQuality = env.InitParams()->IsHostUdpLowQuality();
+    iDescription->AddRef();
+    iDeviceXml = new DeviceXml(iDescription->Document().Find(aRestored.iUdn)); // CpiDeviceListUpnp has already checked this
+    iDevice = new CpiDevice(aCpStack, aRestored.iUdn, *this, *this, this);
+    iTimer = new Timer(env, MakeFunctor(*this, &CpiDeviceUpnp::TimerExpired), "CpiDeviceUpnp"); // not started until we receive an alive
+    iInvocable = new Invocable(*this);
+    iConnectionCache = new InvocationConnectionCache(aCpStack.Env());
+    iRenewConnectionCache = new InvocationConnectionCache(aCpStack.Env(), 1, kRenewConnectionIdleTimeoutMs);
+}
+
 const Brx& CpiDeviceUpnp::Udn() const
 {
     return iDevice->Udn();
@@ -100,6 +674,17 @@ TUint CpiDeviceUpnp::MaxAgeSeconds() const
     return iMaxAgeSeconds;
 }
 
+TUint CpiDeviceUpnp::ConfigId() const
+{
+    return iConfigId;
+}
+
+TBool CpiDeviceUpnp::IsTentative() const
+{
+    AutoMutex _(iLock);
+    return iTentative;
+}
+
 CpiDevice& CpiDeviceUpnp::Device()
 {
     return *iDevice;
@@ -113,6 +698,11 @@ TBool CpiDeviceUpnp::Ready() const
 
 void CpiDeviceUpnp::UpdateMaxAge(TUint aSeconds)
 {
+    iLock.Wait();
+    const TBool confirmed = iTentative;
+    iTentative = false;
+    iLock.Signal();
+    iCpStack.DescriptionCache().DeviceSeen(Udn(), confirmed);
     iMaxAgeSeconds = aSeconds;
     if (iTimer == NULL) {
         return;
@@ -130,26 +720,24 @@ void CpiDeviceUpnp::UpdateMaxAge(TUint aSeconds)
 
 void CpiDeviceUpnp::FetchXml()
 {
-    AutoMutex a(iLock);
-    if (iXml.Bytes() > 0) {
-        // device was constructed based on a previous location. We've already fetched the XML (to get a udn)
-        iSemReady.Signal();
-        if (iList != NULL) {
-            iList->XmlFetchCompleted(*this, true);
+    {
+        AutoMutex a(iLock);
+        if (iDescription != NULL) {
+            // device was constructed based on a previous location. We've already fetched the XML (to get a udn)
+            iSemReady.Signal();
+            if (iList != NULL) {
+                iList->XmlFetchCompleted(*this, true);
+            }
+            return;
         }
-        return;
     }
-    XmlFetchManager& xmlFetchManager = iDevice->GetCpStack().XmlFetchManager();
-    iXmlFetch = xmlFetchManager.Fetch();
     iDevice->AddRef();
-    FunctorAsync functor = MakeFunctorAsync(*this, &CpiDeviceUpnp::XmlFetchCompleted);
-    iXmlFetch->Set(iLocation, functor);
-    xmlFetchManager.Fetch(iXmlFetch);
+    ClaimDescription();
 }
 
 void CpiDeviceUpnp::InterruptXmlFetch()
 {
-    AutoMutex a(iLock);
+    iLock.Wait();
     if (iXmlFetch != NULL) {
         iXmlFetch->Interrupt();
         iXmlFetch = NULL;
@@ -163,6 +751,12 @@ void CpiDeviceUpnp::InterruptXmlFetch()
         iXmlCheckRefresh = NULL;
     }
     iList = NULL;
+    const TBool awaitingDescription = iAwaitingDescription;
+    iLock.Signal();
+    if (awaitingDescription && iCpStack.DescriptionCache().CancelWait(Udn(), *this)) {
+        // we were waiting on another device's fetch; complete now rather than waiting for it
+        DescriptionAvailable(NULL);
+    }
 }
 
 void CpiDeviceUpnp::CheckStillAvailable(CpiDeviceUpnp* aNewLocation)
@@ -202,6 +796,12 @@ void CpiDeviceUpnp::CheckStillAvailable()
     xmlFetchManager.Fetch(iXmlCheckRefresh);
 }
 
+void CpiDeviceUpnp::CheckRestored(TUint aConfirmMs)
+{
+    iTimer->FireIn(aConfirmMs); // superseded by UpdateMaxAge() when an alive confirms the device
+    CheckStillAvailable();
+}
+
 TBool CpiDeviceUpnp::GetAttribute(const char* aKey, Brh& aValue) const
 {
     Brn key(aKey);
@@ -216,14 +816,18 @@ TBool CpiDeviceUpnp::GetAttribute(const char* aKey, Brh& aValue) const
             return (true);
         }
         if (property == Brn("DeviceXml")) {
-            aValue.Set(iXml);
+            aValue.Set(Xml());
+            return (true);
+        }
+        if (property == Brn("Tentative")) {
+            aValue.Set(IsTentative()? Brn("true") : Brn("false"));
             return (true);
         }
 
         const DeviceXml* device = iDeviceXml;
         
         if (parser.Next('.') == Brn("Root")) {
-            device = &iDeviceXmlDocument->Root();
+            device = &iDescription->Document().Root();
             property.Set(parser.Remaining());
         }
         
@@ -275,7 +879,7 @@ TUint CpiDeviceUpnp::Renew(CpiSubscription& aSubscription)
     Uri uri;
     GetServiceUri(uri, "eventSubURL", aSubscription.ServiceType());
     EventUpnp eventUpnp(iDevice->GetCpStack(), aSubscription);
-    eventUpnp.RenewSubscription(uri, durationSecs);
+    eventUpnp.RenewSubscription(uri, durationSecs, *iRenewConnectionCache);
     return durationSecs;
 }
 
@@ -314,7 +918,7 @@ TUint CpiDeviceUpnp::Version(const TChar* aDomain, const TChar* aName, TUint /*a
     Brn targServiceTypeNoVer(targServiceType.Ptr(), serviceParser.Index()); // full name minus ":x" (where x is version)
 
     try {
-        Brn root = XmlParserBasic::Find("root", iXml);
+        Brn root = XmlParserBasic::Find("root", Xml());
         Brn device = XmlParserBasic::Find("device", root);
         Brn udn = XmlParserBasic::Find("UDN", device);
         if (!CpiDeviceUpnp::UdnMatches(udn, Udn())) {
@@ -365,10 +969,94 @@ void CpiDeviceUpnp::Release()
 
 CpiDeviceUpnp::~CpiDeviceUpnp()
 {
-    delete iDeviceXmlDocument;
     delete iDeviceXml;
+    if (iDescription != NULL) {
+        iDescription->RemoveRef();
+    }
     delete iTimer;
     delete iInvocable;
+    delete iConnectionCache;
+    delete iRenewConnectionCache;
+}
+
+const Brx& CpiDeviceUpnp::Xml() const
+{
+    if (iDescription == NULL) {
+        return Brx::Empty();
+    }
+    return iDescription->Xml();
+}
+
+void CpiDeviceUpnp::ClaimDescription()
+{
+    iLock.Wait();
+    iAwaitingDescription = true;
+    iLock.Signal();
+    TBool fetch;
+    CpiDeviceDescription* description = iCpStack.DescriptionCache().Claim(Udn(), iLocation, iConfigId, iInterface, *this, fetch);
+    if (description == NULL && !fetch) {
+        // another device is fetching the same description; DescriptionFetched() will be called later
+        return;
+    }
+    iLock.Wait();
+    iAwaitingDescription = false;
+    if (description == NULL) {
+        XmlFetchManager& xmlFetchManager = iCpStack.XmlFetchManager();
+        iXmlFetch = xmlFetchManager.Fetch();
+        FunctorAsync functor = MakeFunctorAsync(*this, &CpiDeviceUpnp::XmlFetchCompleted);
+        iXmlFetch->Set(iLocation, functor);
+        xmlFetchManager.Fetch(iXmlFetch);
+        iLock.Signal();
+        return;
+    }
+    iLock.Signal();
+    DescriptionAvailable(description);
+}
+
+void CpiDeviceUpnp::DescriptionFetched(CpiDeviceDescription* aDescription)
+{
+    iLock.Wait();
+    iAwaitingDescription = false;
+    const TBool removed = iRemoved;
+    iLock.Signal();
+    if (aDescription == NULL && !removed) {
+        // the other device's fetch failed; try fetching the description ourselves
+        ClaimDescription();
+        return;
+    }
+    DescriptionAvailable(aDescription);
+}
+
+void CpiDeviceUpnp::DescriptionAvailable(CpiDeviceDescription* aDescription)
+{
+    TBool err = (aDescription == NULL);
+    DeviceXml* deviceXml = NULL;
+    if (!err) {
+        try {
+            deviceXml = new DeviceXml(aDescription->Document().Find(Udn()));
+        }
+        catch (XmlError&) {
+            err = true;
+            const Brx& udn = Udn();
+            const Brx& xml = aDescription->Xml();
+            LOG_ERROR(kDevice, "Error within xml for %.*s from %.*s.  Xml is %.*s\n",
+                                  PBUF(udn), PBUF(iLocation), PBUF(xml));
+            aDescription->RemoveRef();
+        }
+    }
+    iLock.Wait();
+    if (!err) {
+        iDescription = aDescription;
+        iDeviceXml = deviceXml;
+    }
+    if (iList != NULL) {
+        iList->XmlFetchCompleted(*this, err);
+    }
+    iLock.Signal();
+    iSemReady.Signal();
+    iDevice->RemoveRef();
+    // Don't add code after the RemoveRef(), we might have
+    // just deleted this object!
 }
 
 void CpiDeviceUpnp::TimerExpired()
@@ -385,7 +1073,7 @@ void CpiDeviceUpnp::TimerExpired()
 
 void CpiDeviceUpnp::GetServiceUri(Uri& aUri, const TChar* aType, const ServiceType& aServiceType)
 {
-    Brn root = XmlParserBasic::Find("root", iXml);
+    Brn root = XmlParserBasic::Find("root", Xml());
     Brn device = XmlParserBasic::Find("device", root);
     Brn udn = XmlParserBasic::Find("UDN", device);
     if (!CpiDeviceUpnp::UdnMatches(udn, Udn())) {
@@ -478,10 +1166,12 @@ void CpiDeviceUpnp::XmlFetchReadUdnCompleted(IAsync& aAsync)
     iXmlFetch = NULL;
     iLock.Signal();
     TBool err = iRemoved;
+    Brh xml;
     try {
-        XmlFetch::Xml(aAsync).TransferTo(iXml);
-        iDeviceXmlDocument = new DeviceXmlDocument(iXml);
-        iDeviceXml = new DeviceXml(iDeviceXmlDocument->Root());
+        // udn isn't known yet so the description can't be shared via CpStack::DescriptionCache()
+        XmlFetch::Xml(aAsync).TransferTo(xml);
+        iDescription = new CpiDeviceDescription(xml);
+        iDeviceXml = new DeviceXml(iDescription->Document().Root());
     }
     catch (XmlFetchError&) {
         err = true;
@@ -489,7 +1179,8 @@ void CpiDeviceUpnp::XmlFetchReadUdnCompleted(IAsync& aAsync)
     }
     catch (XmlError&) {
         err = true;
-        LOG_ERROR(kDevice, "Error within xml for %.*s.  Xml is %.*s\n", PBUF(iLocation), PBUF(iXml));
+        const Brx& badXml = (iDescription == NULL? xml : iDescription->Xml());
+        LOG_ERROR(kDevice, "Error within xml for %.*s.  Xml is %.*s\n", PBUF(iLocation), PBUF(badXml));
     }
     if (err) {
         delete this; // safe because no associated CpiDevice and not yet part of a device list
@@ -513,38 +1204,34 @@ void CpiDeviceUpnp::XmlFetchCompleted(IAsync& aAsync)
     iLock.Wait();
     iXmlFetch = NULL;
     iLock.Signal();
-    TBool err = iRemoved;
-    if (!err) {
+    CpiDeviceDescriptionCache& cache = iCpStack.DescriptionCache();
+    const Brx& udn = Udn();
+    CpiDeviceDescription* description = NULL;
+    if (iRemoved) {
+        cache.FetchFailed(udn, iLocation, iConfigId);
+    }
+    else {
+        Brh xml;
+        TBool fetched = true;
         try {
-            XmlFetch::Xml(aAsync).TransferTo(iXml);
+            XmlFetch::Xml(aAsync).TransferTo(xml);
         }
         catch (XmlFetchError&) {
-            err = true;
-            const Brx& udn = Udn();
+            fetched = false;
+            cache.FetchFailed(udn, iLocation, iConfigId);
             LOG_ERROR(kDevice, "Error fetching xml for %.*s from %.*s\n", PBUF(udn), PBUF(iLocation));
         }
-    }
-    if (!err) {
-        try {
-            iDeviceXmlDocument = new DeviceXmlDocument(iXml);
-            iDeviceXml = new DeviceXml(iDeviceXmlDocument->Find(Udn()));
-        }
-        catch (XmlError&) {
-            err = true;
-            const Brx& udn = Udn();
-            LOG_ERROR(kDevice, "Error within xml for %.*s from %.*s.  Xml is %.*s\n",
-                                  PBUF(udn), PBUF(iLocation), PBUF(iXml));
+        if (fetched) {
+            try {
+                description = cache.Store(udn, iLocation, iConfigId, xml);
+            }
+            catch (XmlError&) {
+                LOG_ERROR(kDevice, "Error within xml for %.*s from %.*s.  Xml is %.*s\n",
+                                      PBUF(udn), PBUF(iLocation), PBUF(xml));
+            }
         }
     }
-    iLock.Wait();
-    if (iList != NULL) {
-        iList->XmlFetchCompleted(*this, err);
-    }
-    iLock.Signal();
-    iSemReady.Signal();
-    iDevice->RemoveRef();
-    // Don't add code after the RemoveRef(), we might have
-    // just deleted this object!
+    DescriptionAvailable(description);
 }
 
 void CpiDeviceUpnp::XmlCheckLocationCompleted(IAsync& aAsync)
@@ -609,8 +1296,17 @@ void CpiDeviceUpnp::Invocable::InvokeAction(Invocation& aInvocation)
     try {
         Uri uri;
         iDevice.GetServiceUri(uri, "controlURL", aInvocation.ServiceType());
-        InvocationUpnp invoker(iDevice.Device().GetCpStack(), aInvocation);
-        invoker.Invoke(uri);
+        InvocationConnectionCache* cache = (iDevice.iConnectionCache->Enabled()? iDevice.iConnectionCache : NULL);
+        InvocationUpnp* invoker = new InvocationUpnp(iDevice.Device().GetCpStack(), aInvocation, cache);
+        try {
+            invoker->Invoke(uri);
+        }
+        catch (Exception&) {
+            delete invoker;
+            throw;
+        }
+        // once suspended, aInvocation owns invoker and completes the invocation later
+        ASSERT(aInvocation.Suspended());
     }
     catch (XmlError&) {
         THROW(ReaderError);
@@ -620,10 +1316,14 @@ void CpiDeviceUpnp::Invocable::InvokeAction(Invocation& aInvocation)
 
 // CpiDeviceListUpnp
 
-CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
+CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, ESsdpTarget aNotifyTarget, const Brx& aNotifyUuidOrDomain, const Brx& aNotifyType,
+                                     FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
     : CpiDeviceList(aCpStack, aAdded, aRemoved)
     , iSsdpLock("DLSM")
     , iEnv(aCpStack.Env())
+    , iNotifyTarget(aNotifyTarget)
+    , iNotifyUuidOrDomain(aNotifyUuidOrDomain)
+    , iNotifyType(aNotifyType)
     , iStarted(false)
     , iNoRemovalsFromRefresh(false)
     , iRepeatMsearchMs(30 * 1000)
@@ -648,7 +1348,7 @@ CpiDeviceListUpnp::CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded,
         iInterface = current->Address();
         iUnicastListener = new SsdpListenerUnicast(iCpStack.Env(), *this, iInterface);
         iMulticastListener = &(iCpStack.Env().MulticastListenerClaim(iInterface));
-        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this);
+        AddNotifyHandler();
     }
     iSsdpLock.Signal();
     iCpStack.Env().AddResumeObserver(*this);
@@ -679,6 +1379,11 @@ CpiDeviceListUpnp::~CpiDeviceListUpnp()
     delete iResumedTimer;
 }
 
+void CpiDeviceListUpnp::AddNotifyHandler()
+{
+    iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this, iNotifyTarget, iNotifyUuidOrDomain, iNotifyType);
+}
+
 void CpiDeviceListUpnp::StopListeners()
 {
     iSsdpLock.Wait();
@@ -720,7 +1425,13 @@ void CpiDeviceListUpnp::TryAdd(const Brx& aLocation)
     // FIXME - may leak if we shutdown while xml fetch is in progress
 }
 
-TBool CpiDeviceListUpnp::Update(const Brx& aUdn, const Brx& aLocation, TUint aMaxAge)
+TIpAddress CpiDeviceListUpnp::Interface() const
+{
+    AutoMutex _(iLock);
+    return iInterface;
+}
+
+TBool CpiDeviceListUpnp::Update(const Brx& aUdn, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
     if (!IsLocationReachable(aLocation)) {
         return false;
@@ -735,11 +1446,19 @@ TBool CpiDeviceListUpnp::Update(const Brx& aUdn, const Brx& aLocation, TUint aMa
                stick with the older location; if it isn't, remove the old device and add
                a new one. */
             iLock.Signal();
-            CpiDeviceUpnp* newDevice = new CpiDeviceUpnp(iCpStack, aUdn, aLocation, aMaxAge, *this, *this);
+            CpiDeviceUpnp* newDevice = new CpiDeviceUpnp(iCpStack, aUdn, aLocation, aMaxAge, aConfigId, *this, *this);
             deviceUpnp->CheckStillAvailable(newDevice);
             device->RemoveRef();
             return true;
         }
+        if (deviceUpnp->ConfigId() != aConfigId && deviceUpnp->IsTentative()) {
+            /* Device was restored from a previous run but its description has changed since.
+               Replace it with a newly discovered device. */
+            iLock.Signal();
+            device->RemoveRef();
+            Remove(aUdn);
+            return false;
+        }
         deviceUpnp->UpdateMaxAge(aMaxAge);
         iLock.Signal();
         device->RemoveRef();
@@ -757,6 +1476,7 @@ void CpiDeviceListUpnp::DoStart()
     iStarted = true;
     iLock.Signal();
     if (needsStart) {
+        AddRestoredDevices();
         AutoMutex a(iSsdpLock);
         if (iUnicastListener != NULL) {
             iUnicastListener->Start();
@@ -911,7 +1631,7 @@ void CpiDeviceListUpnp::HandleInterfaceChange()
         iUnicastListener = new SsdpListenerUnicast(iCpStack.Env(), *this, iInterface);
         iUnicastListener->Start();
         iMulticastListener = &(iCpStack.Env().MulticastListenerClaim(iInterface));
-        iNotifyHandlerId = iMulticastListener->AddNotifyHandler(this);
+        AddNotifyHandler();
     }
     Refresh();
 }
@@ -935,6 +1655,43 @@ void CpiDeviceListUpnp::RemoveAll()
     }
 }
 
+void CpiDeviceListUpnp::AddRestoredDevices()
+{
+    std::vector<CpiDeviceDescriptionCache::RestoredDevice> restored;
+    iCpStack.DescriptionCache().GetRestored(Interface(), restored);
+    /* Restored devices are probed at their last known location rather than running a
+       full refresh.  Those that aren't contactable are removed as soon as the probe
+       fails; the rest are confirmed by an alive in response to the msearch our caller
+       is about to send, or removed if none arrives within a refresh's duration. */
+    const TUint confirmMs = kRefreshRetries * (iEnv.InitParams()->MsearchTimeSecs() * 1000 + 500);
+    for (TUint i=0; i<(TUint)restored.size(); i++) {
+        CpiDeviceDescriptionCache::RestoredDevice& device = restored[i];
+        TBool wanted = false;
+        try {
+            DeviceXmlDocument& doc = device.iDescription->Document();
+            DeviceXml deviceXml(doc.Find(device.iUdn));
+            wanted = IsRestoredDeviceWanted(deviceXml, deviceXml.Udn() == doc.Root().Udn());
+        }
+        catch (XmlError&) {
+        }
+        if (wanted && IsLocationReachable(device.iLocation)) {
+            CpiDeviceUpnp* deviceUpnp = new CpiDeviceUpnp(iCpStack, device, *this, *this);
+            CpiDevice& cpiDevice = deviceUpnp->Device();
+            cpiDevice.AddRef();
+            Add(deviceUpnp);
+            CpiDevice* listed = RefDevice(cpiDevice.Udn());
+            if (listed != NULL) {
+                if (listed == &cpiDevice) { // Add() ignores a device whose udn is already listed
+                    deviceUpnp->CheckRestored(confirmMs);
+                }
+                listed->RemoveRef();
+            }
+            cpiDevice.RemoveRef();
+        }
+        device.iDescription->RemoveRef();
+    }
+}
+
 void CpiDeviceListUpnp::XmlFetchCompleted(CpiDeviceUpnp& aDevice, TBool aError)
 {
     if (aError) {
@@ -955,26 +1712,26 @@ void CpiDeviceListUpnp::DeviceLocationChanged(CpiDeviceUpnp* aOriginal, CpiDevic
     Add(aNew);
 }
 
-void CpiDeviceListUpnp::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnp::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    (void)Update(aUuid, aLocation, aMaxAge);
+    (void)Update(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
-void CpiDeviceListUpnp::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnp::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    (void)Update(aUuid, aLocation, aMaxAge);
+    (void)Update(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/,
-                                                 TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge)
+                                                 TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    (void)Update(aUuid, aLocation, aMaxAge);
+    (void)Update(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/,
-                                                  TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge)
+                                                  TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    (void)Update(aUuid, aLocation, aMaxAge);
+    (void)Update(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
 void CpiDeviceListUpnp::SsdpNotifyRootByeBye(const Brx& aUuid)
@@ -1008,7 +1765,7 @@ void CpiDeviceListUpnp::NotifyResumed()
 // CpiDeviceListUpnpAll
 
 CpiDeviceListUpnpAll::CpiDeviceListUpnpAll(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, eSsdpAll, Brx::Empty(), Brx::Empty(), aAdded, aRemoved)
 {
 }
 
@@ -1034,35 +1791,40 @@ void CpiDeviceListUpnpAll::Start()
     }
 }
 
-void CpiDeviceListUpnpAll::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnpAll::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    SsdpNotification(aUuid, aLocation, aMaxAge);
+    SsdpNotification(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
-void CpiDeviceListUpnpAll::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnpAll::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    SsdpNotification(aUuid, aLocation, aMaxAge);
+    SsdpNotification(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
 void CpiDeviceListUpnpAll::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/,
-                                                     TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge)
+                                                     TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    SsdpNotification(aUuid, aLocation, aMaxAge);
+    SsdpNotification(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
 void CpiDeviceListUpnpAll::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/,
-                                                      TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge)
+                                                      TUint /*aVersion*/, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    SsdpNotification(aUuid, aLocation, aMaxAge);
+    SsdpNotification(aUuid, aLocation, aMaxAge, aConfigId);
 }
 
-void CpiDeviceListUpnpAll::SsdpNotification(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+TBool CpiDeviceListUpnpAll::IsRestoredDeviceWanted(const DeviceXml& /*aDevice*/, TBool /*aIsRoot*/)
 {
-    if (Update(aUuid, aLocation, aMaxAge)) {
+    return true;
+}
+
+void CpiDeviceListUpnpAll::SsdpNotification(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
+{
+    if (Update(aUuid, aLocation, aMaxAge, aConfigId)) {
         return;
     }
     if (IsLocationReachable(aLocation)) {
-        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, *this, *this);
+        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, aConfigId, *this, *this);
         Add(device);
     }
 }
@@ -1071,7 +1833,7 @@ void CpiDeviceListUpnpAll::SsdpNotification(const Brx& aUuid, const Brx& aLocati
 // CpiDeviceListUpnpRoot
 
 CpiDeviceListUpnpRoot::CpiDeviceListUpnpRoot(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, eSsdpRoot, Brx::Empty(), Brx::Empty(), aAdded, aRemoved)
 {
 }
 
@@ -1097,22 +1859,27 @@ void CpiDeviceListUpnpRoot::Start()
     }
 }
 
-void CpiDeviceListUpnpRoot::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnpRoot::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
-    if (Update(aUuid, aLocation, aMaxAge)) {
+    if (Update(aUuid, aLocation, aMaxAge, aConfigId)) {
         return;
     }
     if (IsLocationReachable(aLocation)) {
-        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, *this, *this);
+        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, aConfigId, *this, *this);
         Add(device);
     }
 }
 
+TBool CpiDeviceListUpnpRoot::IsRestoredDeviceWanted(const DeviceXml& /*aDevice*/, TBool aIsRoot)
+{
+    return aIsRoot;
+}
+
 
 // CpiDeviceListUpnpUuid
 
 CpiDeviceListUpnpUuid::CpiDeviceListUpnpUuid(CpStack& aCpStack, const Brx& aUuid, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, eSsdpUuid, aUuid, Brx::Empty(), aAdded, aRemoved)
     , iUuid(aUuid)
 {
 }
@@ -1139,26 +1906,31 @@ void CpiDeviceListUpnpUuid::Start()
     }
 }
 
-void CpiDeviceListUpnpUuid::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void CpiDeviceListUpnpUuid::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
     if (aUuid != iUuid) {
         return;
     }
-    if (Update(aUuid, aLocation, aMaxAge)) {
+    if (Update(aUuid, aLocation, aMaxAge, aConfigId)) {
         return;
     }
     if (IsLocationReachable(aLocation)) {
-        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, *this, *this);
+        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, aConfigId, *this, *this);
         Add(device);
     }
 }
 
+TBool CpiDeviceListUpnpUuid::IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool /*aIsRoot*/)
+{
+    return (aDevice.Udn() == iUuid);
+}
+
 
 // CpiDeviceListUpnpDeviceType
 
 CpiDeviceListUpnpDeviceType::CpiDeviceListUpnpDeviceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aDeviceType,
                                                          TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, eSsdpDeviceType, aDomainName, aDeviceType, aAdded, aRemoved)
     , iDomainName(aDomainName)
     , iDeviceType(aDeviceType)
     , iVersion(aVersion)
@@ -1188,26 +1960,51 @@ void CpiDeviceListUpnpDeviceType::Start()
 }
 
 void CpiDeviceListUpnpDeviceType::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType,
-                                                            TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+                                                            TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
     if (aVersion<iVersion || aDomain!=iDomainName || aType!=iDeviceType) {
         return;
     }
-    if (Update(aUuid, aLocation, aMaxAge)) {
+    if (Update(aUuid, aLocation, aMaxAge, aConfigId)) {
         return;
     }
     if (IsLocationReachable(aLocation)) {
-        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, *this, *this);
+        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, aConfigId, *this, *this);
         Add(device);
     }
 }
 
+TBool CpiDeviceListUpnpDeviceType::IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool /*aIsRoot*/)
+{
+    const TUint kMaxDomainBytes = 64;
+    // deviceType is of the form urn:domain:device:type:version
+    Parser parser(aDevice.DeviceType());
+    if (parser.Next(':') != Brn("urn")) {
+        return false;
+    }
+    Brn upnpDomain = parser.Next(':');
+    if (upnpDomain.Bytes() > kMaxDomainBytes) {
+        return false;
+    }
+    Bws<kMaxDomainBytes> domain;
+    Ssdp::UpnpDomainToCanonical(upnpDomain, domain);
+    if (domain != iDomainName || parser.Next(':') != Brn("device") || parser.Next(':') != iDeviceType) {
+        return false;
+    }
+    try {
+        return (Ascii::Uint(parser.Remaining()) >= iVersion);
+    }
+    catch (AsciiError&) {
+        return false;
+    }
+}
+
 
 // CpiDeviceListUpnpServiceType
 
 CpiDeviceListUpnpServiceType::CpiDeviceListUpnpServiceType(CpStack& aCpStack, const Brx& aDomainName, const Brx& aServiceType,
                                                            TUint aVersion, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved)
-    : CpiDeviceListUpnp(aCpStack, aAdded, aRemoved)
+    : CpiDeviceListUpnp(aCpStack, eSsdpServiceType, aDomainName, aServiceType, aAdded, aRemoved)
     , iDomainName(aDomainName)
     , iServiceType(aServiceType)
     , iVersion(aVersion)
@@ -1237,16 +2034,30 @@ void CpiDeviceListUpnpServiceType::Start()
 }
 
 void CpiDeviceListUpnpServiceType::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType,
-                                                              TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+                                                              TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId)
 {
     if (aVersion<iVersion || aDomain!=iDomainName || aType!=iServiceType) {
         return;
     }
-    if (Update(aUuid, aLocation, aMaxAge)) {
+    if (Update(aUuid, aLocation, aMaxAge, aConfigId)) {
         return;
     }
     if (IsLocationReachable(aLocation)) {
-        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, *this, *this);
+        CpiDeviceUpnp* device = new CpiDeviceUpnp(iCpStack, aUuid, aLocation, aMaxAge, aConfigId, *this, *this);
         Add(device);
     }
 }
+
+TBool CpiDeviceListUpnpServiceType::IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool /*aIsRoot*/)
+{
+    Bwh serviceType(iDomainName.Bytes() + 1 + iServiceType.Bytes());
+    serviceType.Append(iDomainName);
+    serviceType.Append('.');
+    serviceType.Append(iServiceType);
+    try {
+        return (Ascii::Uint(aDevice.ServiceVersion(serviceType)) >= iVersion);
+    }
+    catch (AsciiError&) {
+        return false;
+    }
+}
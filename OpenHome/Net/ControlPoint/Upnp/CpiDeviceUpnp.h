@@ -18,27 +18,178 @@
 #include <OpenHome/Net/Private/DeviceXml.h>
 #include <OpenHome/Net/Private/XmlFetcher.h>
 #include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/InfoProvider.h>
+
+#include <map>
+#include <vector>
 
 namespace OpenHome {
 namespace Net {
 
 class CpiDeviceListUpnp;
 class CpStack;
+class InvocationConnectionCache;
+
+/**
+ * Ref-counted device description document
+ *
+ * Shared by all CpiDeviceUpnp instances (across all device lists) for the same udn.
+ * Immutable once constructed.
+ */
+class CpiDeviceDescription : private INonCopyable
+{
+public:
+    CpiDeviceDescription(Brh& aXml); // takes ownership of aXml's buffer.  Throws XmlError, leaving aXml unchanged
+    void AddRef();
+    void RemoveRef();
+    TBool IsShared() const;
+    const Brx& Xml() const;
+    DeviceXmlDocument& Document();
+private:
+    ~CpiDeviceDescription();
+private:
+    mutable Mutex iLock;
+    TUint iRefCount;
+    Brh iXml;
+    DeviceXmlDocument* iDocument;
+};
+
+class ICpiDeviceDescriptionObserver
+{
+public:
+    /**
+     * Called when a fetch started by another device completes.
+     * aDescription is NULL if the fetch failed, otherwise has already been ref'd for the observer.
+     */
+    virtual void DescriptionFetched(CpiDeviceDescription* aDescription) = 0;
+    virtual ~ICpiDeviceDescriptionObserver() {}
+};
+
+/**
+ * Stack-wide cache of device descriptions, keyed by udn
+ *
+ * Entries are only reused for the same LOCATION and CONFIGID.UPNP.ORG.  Devices which
+ * don't report a config id only share descriptions which are currently in use (or
+ * being fetched) by another device list.  Concurrent requests for the same description
+ * are coalesced into a single fetch.
+ *
+ * If InitialisationParams::SetCpUpnpDeviceCache() was called, descriptions are also saved
+ * on destruction and restored on construction so that device lists can report
+ * previously seen devices before they're re-discovered.
+ */
+class CpiDeviceDescriptionCache : private IInfoProvider, private INonCopyable
+{
+    static const Brn kQueryDescriptions;
+    static const TUint kMaxEntries = 64;
+    static const Brn kFileMagic;
+    static const TUint kFileVersion = 1;
+    static const Brn kTempSuffix;
+public:
+    class RestoredDevice
+    {
+    public:
+        Brn iUdn;
+        Brn iLocation;
+        TUint iConfigId;
+        CpiDeviceDescription* iDescription; // ref'd for the caller
+    };
+public:
+    CpiDeviceDescriptionCache(Environment& aEnv);
+    ~CpiDeviceDescriptionCache();
+    /**
+     * Retrieve devices restored from file that were last seen on aInterface.
+     * Buffers in aDevices remain valid for the lifetime of the cache.
+     */
+    void GetRestored(const TIpAddress& aInterface, std::vector<RestoredDevice>& aDevices);
+    /**
+     * Note that a device is still present (e.g. an alive message was received) so
+     * its description doesn't age out of the saved cache.
+     * aConfirmsRestored indicates that this is the first sighting of a restored device.
+     */
+    void DeviceSeen(const Brx& aUdn, TBool aConfirmsRestored);
+    /**
+     * Returns a ref'd description if a valid one is cached.
+     * Otherwise returns NULL and sets aFetch.  If aFetch is true, the caller should fetch the
+     * description then report the result via Store() or FetchFailed().  If aFetch is false,
+     * another fetch is already in progress and aObserver will be notified when it completes.
+     */
+    CpiDeviceDescription* Claim(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface,
+                                ICpiDeviceDescriptionObserver& aObserver, TBool& aFetch);
+    /**
+     * Returns a ref'd description for aXml, notifying any other devices waiting on it.
+     * Throws XmlError (after notifying waiters of failure) if aXml is invalid.
+     */
+    CpiDeviceDescription* Store(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, Brh& aXml);
+    void FetchFailed(const Brx& aUdn, const Brx& aLocation, TUint aConfigId);
+    /**
+     * Returns true if aObserver was waiting for a fetch and will no longer be notified.
+     */
+    TBool CancelWait(const Brx& aUdn, ICpiDeviceDescriptionObserver& aObserver);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    class Entry : private INonCopyable
+    {
+    public:
+        Entry(const Brx& aUdn, const Brx& aLocation, TUint aConfigId, const TIpAddress& aInterface);
+        ~Entry();
+        TBool Matches(const Brx& aLocation, TUint aConfigId) const;
+        TBool Reusable() const;
+    public:
+        Brh iUdn;
+        Brh iLocation;
+        TUint iConfigId;
+        TIpAddress iInterface;
+        TUint64 iSeenSecs;
+        CpiDeviceDescription* iDescription; // NULL while fetch is in progress
+        std::vector<ICpiDeviceDescriptionObserver*> iWaiters;
+    };
+    typedef std::map<Brn,Entry*,BufferCmp> Map;
+    typedef std::vector<ICpiDeviceDescriptionObserver*> Waiters;
+private:
+    Map::iterator FindPendingLocked(const Brx& aUdn, const Brx& aLocation, TUint aConfigId);
+    void EraseLocked(Map::iterator aIt);
+    void PruneLocked();
+    static void Notify(Waiters& aWaiters, CpiDeviceDescription* aDescription);
+    void Load();
+    void Save();
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    Map iMap;
+    std::vector<Entry*> iRestored;
+    Brhz iPath;
+    TUint64 iMaxAgeSecs;
+    TUint iHits;
+    TUint iMisses;
+    TUint iCoalesced;
+    TUint iInvalidated;
+    TUint iFetchErrors;
+    TUint iRestoredSeen;
+};
+
 /**
  * UPnP-specific device
  *
  * Can be created in response to either a msearch request or a multicast alive
  * notification.  Uses a timer to remove itself from ots owning list if no
  * subsequent alive message is received within a specified maxage.
+ * Can also be restored from a previous run, in which case the device is tentative
+ * (and has no maxage timeout) until an alive message is received.
  */
-class CpiDeviceUpnp : private ICpiProtocol, private ICpiDeviceObserver
+class CpiDeviceUpnp : private ICpiProtocol, private ICpiDeviceObserver, private ICpiDeviceDescriptionObserver
 {
+    // renewals for a device are sent back to back (see CpiRenewalScheduler) so only need a short idle timeout
+    static const TUint kRenewConnectionIdleTimeoutMs = 5 * 1000;
 public:
-    CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
+    CpiDeviceUpnp(CpStack& aCpStack, const Brx& aUdn, const Brx& aLocation, TUint aMaxAgeSecs, TUint aConfigId, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
     CpiDeviceUpnp(CpStack& aCpStack, const Brx& aLocation, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
+    CpiDeviceUpnp(CpStack& aCpStack, const CpiDeviceDescriptionCache::RestoredDevice& aRestored, IDeviceRemover& aDeviceList, CpiDeviceListUpnp& aList);
     const Brx& Udn() const;
     const Brx& Location() const;
     TUint MaxAgeSeconds() const;
+    TUint ConfigId() const;
+    TBool IsTentative() const;
     CpiDevice& Device();
     TBool Ready() const;
 
@@ -54,6 +205,12 @@ public:
     void InterruptXmlFetch();
     void CheckStillAvailable(CpiDeviceUpnp* aNewDevice);
     void CheckStillAvailable();
+    /**
+     * Check a device restored from a previous run is still contactable at its last
+     * known location.  It is removed if not, or if it hasn't announced itself within
+     * aConfirmMs.
+     */
+    void CheckRestored(TUint aConfirmMs);
 private: // ICpiProtocol
     TBool GetAttribute(const char* aKey, Brh& aValue) const;
     void InvokeAction(Invocation& aInvocation);
@@ -65,8 +222,13 @@ private: // ICpiProtocol
     TUint Version(const TChar* aDomain, const TChar* aName, TUint aProxyVersion) const;
 private: // ICpiDeviceObserver
     void Release();
+private: // ICpiDeviceDescriptionObserver
+    void DescriptionFetched(CpiDeviceDescription* aDescription);
 private:
     ~CpiDeviceUpnp();
+    const Brx& Xml() const;
+    void ClaimDescription();
+    void DescriptionAvailable(CpiDeviceDescription* aDescription);
     void TimerExpired();
     void GetServiceUri(Uri& aUri, const TChar* aType, const ServiceType& aServiceType);
     void XmlFetchReadUdnCompleted(IAsync& aAsync);
@@ -89,15 +251,20 @@ private:
     mutable Mutex iLock;
     Brhz iLocation;
     XmlFetch* iXmlFetch;
-    Brh iXml;
-    DeviceXmlDocument* iDeviceXmlDocument;
+    CpiDeviceDescription* iDescription;
     DeviceXml* iDeviceXml;
+    TUint iConfigId;
+    TIpAddress iInterface;
+    TBool iAwaitingDescription;
+    TBool iTentative;
     Timer* iTimer;
     TUint iExpiryTime;
     TUint iMaxAgeSeconds;
     IDeviceRemover& iDeviceList;
     CpiDeviceListUpnp* iList;
     Invocable* iInvocable;
+    InvocationConnectionCache* iConnectionCache;
+    InvocationConnectionCache* iRenewConnectionCache;
     Semaphore iSemReady;
     TBool iRemoved;
     TBool iHostUdpIsLowQuality;
@@ -118,8 +285,14 @@ public:
     void XmlFetchCompleted(CpiDeviceUpnp& aDevice, TBool aError);
     void DeviceLocationChanged(CpiDeviceUpnp* aOriginal, CpiDeviceUpnp* aNew);
     void TryAdd(const Brx& aLocation);
+    TIpAddress Interface() const;
 protected:
-    CpiDeviceListUpnp(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
+    /**
+     * aNotifyTarget, aNotifyUuidOrDomain and aNotifyType select the multicast notifications
+     * passed to this list.  See SsdpListenerMulticast::AddNotifyHandler.
+     */
+    CpiDeviceListUpnp(CpStack& aCpStack, ESsdpTarget aNotifyTarget, const Brx& aNotifyUuidOrDomain, const Brx& aNotifyType,
+                      FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
     ~CpiDeviceListUpnp();
 
     void StopListeners();
@@ -132,8 +305,12 @@ protected:
      * that this is a new device which should be added to the list.
      * false will always be returned while a list is being refreshed.
      */
-    TBool Update(const Brx& aUdn, const Brx& aLocation, TUint aMaxAge);
+    TBool Update(const Brx& aUdn, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void DoStart();
+    /**
+     * Returns true if a device restored from a previous run belongs in this list.
+     */
+    virtual TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot) = 0;
     void DoRefresh();
 protected: // from CpiDeviceList
     void Start();
@@ -141,12 +318,12 @@ protected: // from CpiDeviceList
     TBool IsDeviceReady(CpiDevice& aDevice);
     TBool IsLocationReachable(const Brx& aLocation) const;
 protected: // from ISsdpNotifyHandler
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                   const Brx& aLocation, TUint aMaxAge);
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                    const Brx& aLocation, TUint aMaxAge);
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyRootByeBye(const Brx& aUuid);
     void SsdpNotifyUuidByeBye(const Brx& aUuid);
     void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
@@ -161,6 +338,8 @@ private:
     void SubnetListChanged();
     void HandleInterfaceChange();
     void RemoveAll();
+    void AddRestoredDevices();
+    void AddNotifyHandler();
 protected:
     SsdpListenerUnicast* iUnicastListener;
     Mutex iSsdpLock;
@@ -171,6 +350,9 @@ private:
     Environment& iEnv;
     TIpAddress iInterface;
     SsdpListenerMulticast* iMulticastListener;
+    const ESsdpTarget iNotifyTarget;
+    Brh iNotifyUuidOrDomain;
+    Brh iNotifyType;
     TInt iNotifyHandlerId;
     TUint iInterfaceChangeListenerId;
     TUint iSubnetListChangeListenerId;
@@ -194,14 +376,16 @@ public:
     CpiDeviceListUpnpAll(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
     ~CpiDeviceListUpnpAll();
     void Start();
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                   const Brx& aLocation, TUint aMaxAge);
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                    const Brx& aLocation, TUint aMaxAge);
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
 private:
-    void SsdpNotification(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotification(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
 };
 
 /**
@@ -215,7 +399,9 @@ public:
     CpiDeviceListUpnpRoot(CpStack& aCpStack, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
     ~CpiDeviceListUpnpRoot();
     void Start();
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
 };
 
 /**
@@ -229,7 +415,9 @@ public:
     CpiDeviceListUpnpUuid(CpStack& aCpStack, const Brx& aUuid, FunctorCpiDevice aAdded, FunctorCpiDevice aRemoved);
     ~CpiDeviceListUpnpUuid();
     void Start();
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
 private:
     Brh iUuid;
 };
@@ -247,7 +435,9 @@ public:
     ~CpiDeviceListUpnpDeviceType();
     void Start();
     void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                   const Brx& aLocation, TUint aMaxAge);
+                                   const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
 private:
     Brh iDomainName;
     Brh iDeviceType;
@@ -267,7 +457,9 @@ public:
     ~CpiDeviceListUpnpServiceType();
     void Start();
     void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion,
-                                    const Brx& aLocation, TUint aMaxAge);
+                                    const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+private: // from CpiDeviceListUpnp
+    TBool IsRestoredDeviceWanted(const DeviceXml& aDevice, TBool aIsRoot);
 private:
     Brh iDomainName;
     Brh iServiceType;
@@ -60,6 +60,11 @@ const Brx& DeviceXml::Udn() const
     return iUdn;
 }
 
+Brn DeviceXml::DeviceType() const
+{
+    return XmlParserBasic::Find("deviceType", iXml);
+}
+
 Brn DeviceXml::Find(const Brx& aUdn)
 {
     if (iUdn == aUdn) {
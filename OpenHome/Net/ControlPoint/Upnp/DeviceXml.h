@@ -16,6 +16,7 @@ class DeviceXml
 public:
     DeviceXml(const Brx& aXml);
     const Brx& Udn() const;
+    Brn DeviceType() const; // e.g. "urn:schemas-upnp-org:device:MediaServer:1"
     Brn Find(const Brx& aUdn);
     void GetFriendlyName(Brh& aValue) const;
     void GetPresentationUrl(Brh& aValue) const;
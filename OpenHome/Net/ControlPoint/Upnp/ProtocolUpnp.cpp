@@ -12,21 +12,263 @@
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
+// InvocationConnectionUpnp
+
+InvocationConnectionUpnp::InvocationConnectionUpnp(Environment& aEnv, const OpenHome::Endpoint& aEndpoint)
+    : iEnv(aEnv)
+    , iEndpoint(aEndpoint)
+    , iReadBuffer(iSocket)
+    , iReaderUntil(iReadBuffer)
+    , iReaderResponse(aEnv, iReaderUntil)
+    , iConnected(false)
+    , iIdleSince(0)
+{
+    iReaderResponse.AddHeader(iHeaderConnection);
+    iReaderResponse.AddHeader(iHeaderContentLength);
+    iReaderResponse.AddHeader(iHeaderTransferEncoding);
+}
+
+InvocationConnectionUpnp::~InvocationConnectionUpnp()
+{
+    Close();
+}
+
+const OpenHome::Endpoint& InvocationConnectionUpnp::Endpoint() const
+{
+    return iEndpoint;
+}
+
+TBool InvocationConnectionUpnp::IsConnected() const
+{
+    return iConnected;
+}
+
+void InvocationConnectionUpnp::Connect(TUint aTimeoutMs)
+{
+    ASSERT(!iConnected);
+    iSocket.Open(iEnv);
+    iConnected = true;
+    iSocket.Connect(iEndpoint, aTimeoutMs);
+}
+
+void InvocationConnectionUpnp::Close()
+{
+    if (iConnected) {
+        iConnected = false;
+        try {
+            iSocket.Close();
+        }
+        catch (NetworkError&) {}
+    }
+}
+
+SocketTcpClient& InvocationConnectionUpnp::Socket()
+{
+    return iSocket;
+}
+
+ReaderUntil& InvocationConnectionUpnp::Reader()
+{
+    return iReaderUntil;
+}
+
+ReaderHttpResponse& InvocationConnectionUpnp::ReaderResponse()
+{
+    return iReaderResponse;
+}
+
+const HttpHeaderContentLength& InvocationConnectionUpnp::HeaderContentLength() const
+{
+    return iHeaderContentLength;
+}
+
+const HttpHeaderTransferEncoding& InvocationConnectionUpnp::HeaderTransferEncoding() const
+{
+    return iHeaderTransferEncoding;
+}
+
+TBool InvocationConnectionUpnp::ResponseAllowsReuse() const
+{
+    if (iReaderResponse.Version() != Http::eHttp11 || iHeaderConnection.Close()) {
+        return false;
+    }
+    // an entity without Content-Length or chunking is delimited by the device closing the connection
+    return (iHeaderContentLength.Received() || iHeaderTransferEncoding.IsChunked());
+}
+
+void InvocationConnectionUpnp::SetIdleSince(TUint aTime)
+{
+    iIdleSince = aTime;
+}
+
+TUint InvocationConnectionUpnp::IdleSince() const
+{
+    return iIdleSince;
+}
+
+
+// InvocationConnectionCache
+
+InvocationConnectionCache::InvocationConnectionCache(Environment& aEnv)
+    : iEnv(aEnv)
+    , iLock("ICCL")
+    , iFixedLimits(false)
+    , iMaxIdle(0)
+    , iIdleTimeoutMs(0)
+    , iTimerActive(false)
+{
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &InvocationConnectionCache::TimerExpired), "InvocationConnectionCache");
+}
+
+InvocationConnectionCache::InvocationConnectionCache(Environment& aEnv, TUint aMaxIdle, TUint aIdleTimeoutMs)
+    : iEnv(aEnv)
+    , iLock("ICCL")
+    , iFixedLimits(true)
+    , iMaxIdle(aMaxIdle)
+    , iIdleTimeoutMs(aIdleTimeoutMs)
+    , iTimerActive(false)
+{
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &InvocationConnectionCache::TimerExpired), "InvocationConnectionCache");
+}
+
+InvocationConnectionCache::~InvocationConnectionCache()
+{
+    delete iTimer;
+    std::list<InvocationConnectionUpnp*>::iterator it;
+    for (it=iIdle.begin(); it!=iIdle.end(); ++it) {
+        delete *it;
+    }
+}
+
+TBool InvocationConnectionCache::Enabled() const
+{
+    TUint maxIdle, idleTimeoutMs;
+    GetLimits(maxIdle, idleTimeoutMs);
+    return (maxIdle > 0);
+}
+
+InvocationConnectionUpnp* InvocationConnectionCache::Claim(const Endpoint& aEndpoint)
+{
+    TUint maxIdle, idleTimeoutMs;
+    GetLimits(maxIdle, idleTimeoutMs);
+    InvocationConnectionUpnp* connection = NULL;
+    std::vector<InvocationConnectionUpnp*> expired;
+    iLock.Wait();
+    const TUint now = Time::Now(iEnv);
+    std::list<InvocationConnectionUpnp*>::iterator it = iIdle.begin();
+    while (it != iIdle.end()) {
+        InvocationConnectionUpnp* candidate = *it;
+        if (now - candidate->IdleSince() >= idleTimeoutMs) {
+            expired.push_back(candidate);
+            it = iIdle.erase(it);
+        }
+        else if (candidate->Endpoint() == aEndpoint) {
+            connection = candidate;
+            iIdle.erase(it);
+            break;
+        }
+        else {
+            ++it;
+        }
+    }
+    iLock.Signal();
+    // deleting a connection may block on the timer thread so can't be done with iLock held
+    Delete(expired);
+    if (connection == NULL) {
+        connection = new InvocationConnectionUpnp(iEnv, aEndpoint);
+    }
+    return connection;
+}
+
+void InvocationConnectionCache::Release(InvocationConnectionUpnp* aConnection, TBool aReusable)
+{
+    TUint maxIdle, idleTimeoutMs;
+    GetLimits(maxIdle, idleTimeoutMs);
+    std::vector<InvocationConnectionUpnp*> discard;
+    if (!aReusable || maxIdle == 0) {
+        discard.push_back(aConnection);
+    }
+    else {
+        AutoMutex _(iLock);
+        aConnection->SetIdleSince(Time::Now(iEnv));
+        iIdle.push_front(aConnection);
+        while (iIdle.size() > maxIdle) {
+            discard.push_back(iIdle.back());
+            iIdle.pop_back();
+        }
+        if (!iTimerActive) {
+            iTimerActive = true;
+            iTimer->FireIn(idleTimeoutMs);
+        }
+    }
+    Delete(discard);
+}
+
+void InvocationConnectionCache::GetLimits(TUint& aMaxIdle, TUint& aIdleTimeoutMs) const
+{
+    if (iFixedLimits) {
+        aMaxIdle = iMaxIdle;
+        aIdleTimeoutMs = iIdleTimeoutMs;
+    }
+    else {
+        iEnv.InitParams()->GetCpInvocationKeepAlive(aMaxIdle, aIdleTimeoutMs);
+    }
+}
+
+void InvocationConnectionCache::TimerExpired()
+{
+    TUint maxIdle, idleTimeoutMs;
+    GetLimits(maxIdle, idleTimeoutMs);
+    std::vector<InvocationConnectionUpnp*> expired;
+    iLock.Wait();
+    const TUint now = Time::Now(iEnv);
+    while (iIdle.size() > 0 && (maxIdle == 0 || now - iIdle.back()->IdleSince() >= idleTimeoutMs)) {
+        expired.push_back(iIdle.back());
+        iIdle.pop_back();
+    }
+    if (iIdle.size() == 0) {
+        iTimerActive = false;
+    }
+    else {
+        iTimer->FireIn(iIdle.back()->IdleSince() + idleTimeoutMs - now);
+    }
+    iLock.Signal();
+    Delete(expired);
+}
+
+void InvocationConnectionCache::Delete(std::vector<InvocationConnectionUpnp*>& aConnections)
+{ // static
+    for (TUint i=0; i<(TUint)aConnections.size(); i++) {
+        delete aConnections[i];
+    }
+}
+
+
 // InvocationUpnp
 
-InvocationUpnp::InvocationUpnp(CpStack& aCpStack, Invocation& aInvocation)
+InvocationUpnp::InvocationUpnp(CpStack& aCpStack, Invocation& aInvocation, InvocationConnectionCache* aConnectionCache)
     : iCpStack(aCpStack)
     , iInvocation(aInvocation)
-    , iReadBuffer(iSocket)
-    , iReaderUntil(iReadBuffer)
-    , iReaderResponse(aCpStack.Env(), iReaderUntil)
+    , iConnectionCache(aConnectionCache)
+    , iConnection(NULL)
+    , iReused(false)
+    , iStartTime(0)
+    , iReusable(false)
+    , iInterrupted(false)
 {
 }
 
 InvocationUpnp::~InvocationUpnp()
 {
     iInvocation.SetInterruptHandler(NULL);
-    iSocket.Close();
+    if (iConnection != NULL) {
+        if (iConnectionCache != NULL) {
+            iConnectionCache->Release(iConnection, iReusable && !iInterrupted);
+        }
+        else {
+            delete iConnection;
+        }
+    }
 }
 
 void InvocationUpnp::Invoke(const Uri& aUri)
@@ -35,11 +277,85 @@ void InvocationUpnp::Invoke(const Uri& aUri)
     LOG(kService, "> InvocationUpnp::Invoke (%p, action %.*s, device %.*s)\n",
                   &iInvocation, PBUF(actionName), PBUF(iInvocation.Udn()));
 
-    iSocket.Open(iCpStack.Env());
-    WriteRequest(aUri);
-    iInvocation.SetInterruptHandler(this);
-    ReadResponse();
+    iUri.Replace(aUri.AbsoluteUri());
+    Endpoint endpoint(aUri.Port(), aUri.Host());
+    if (iConnectionCache != NULL) {
+        iConnection = iConnectionCache->Claim(endpoint);
+    }
+    else {
+        iConnection = new InvocationConnectionUpnp(iCpStack.Env(), endpoint);
+    }
+    iReused = iConnection->IsConnected();
+    SendRequest();
+}
+
+void InvocationUpnp::SendRequest()
+{
+    for (;;) {
+        if (!iConnection->IsConnected()) {
+            Connect();
+        }
+        iStartTime = Time::Now(iCpStack.Env());
+        try {
+            WriteRequest(iUri);
+            iInvocation.SetInterruptHandler(this);
+            // release the invoker thread until the device responds; Continue() reads the response
+            iInvocation.Suspend(iConnection->Socket(), iCpStack.Env().InitParams()->InvocationTimeoutMs(), *this);
+            return;
+        }
+        catch (WriterError&) {
+            if (!iReused) {
+                iInvocation.SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown);
+                throw;
+            }
+        }
+        Reconnect();
+    }
+}
+
+void InvocationUpnp::Reconnect()
+{
+    LOG(kService, "InvocationUpnp::Invoke (%p) reconnecting after idle connection closed\n", &iInvocation);
+    iInvocation.SetInterruptHandler(NULL);
+    iConnection->Close();
+    iReused = false;
+}
+
+void InvocationUpnp::Continue(TBool aTimedOut)
+{
+    const TUint timeoutMs = iCpStack.Env().InitParams()->InvocationTimeoutMs();
+    const TUint elapsedMs = Time::Now(iCpStack.Env()) - iStartTime;
+    if (aTimedOut || elapsedMs >= timeoutMs) {
+        LOG_ERROR(kService, "InvocationUpnp::Continue (%p) timed out waiting for response\n", &iInvocation);
+        iInvocation.SetError(Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout);
+        THROW(ReaderError);
+    }
+    try {
+        iConnection->ReaderResponse().Read(timeoutMs - elapsedMs);
+    }
+    catch (ReaderError&) {
+        const TBool timedOut = (Time::Now(iCpStack.Env()) - iStartTime >= timeoutMs);
+        if (timedOut && !iInterrupted) {
+            // read was interrupted by its timer, rather than the poller noticing the timeout
+            iInvocation.SetError(Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout);
+        }
+        /* Only retry if the device closed the connection without reading the request.
+           A response that timed out or was interrupted may have been acted on. */
+        if (!iReused || iInterrupted || timedOut) {
+            throw;
+        }
+        Reconnect();
+        SendRequest();
+        return;
+    }
+    try {
+        ReadResponse();
+    }
+    catch (XmlError&) {
+        THROW(ReaderError);
+    }
 
+    const Brx& actionName = iInvocation.Action().Name();
     LOG(kService, "< InvocationUpnp::Invoke (%p, action %.*s)\n", &iInvocation, PBUF(actionName));
 }
 
@@ -49,16 +365,10 @@ void InvocationUpnp::WriteServiceType(IWriterAscii& aWriter, const Invocation& a
     aWriter.Write(serviceType.FullName());
 }
 
-void InvocationUpnp::WriteRequest(const Uri& aUri)
+void InvocationUpnp::Connect()
 {
-    Sws<1024> writeBuffer(iSocket);
-    WriterHttpRequest writerRequest(writeBuffer);
-    Bwh body;
-
     try {
-        Endpoint endpoint(aUri.Port(), aUri.Host());
-        TUint timeout = iCpStack.Env().InitParams()->TcpConnectTimeoutMs();
-        iSocket.Connect(endpoint, timeout);
+        iConnection->Connect(iCpStack.Env().InitParams()->TcpConnectTimeoutMs());
     }
     catch (NetworkTimeout&) {
         iInvocation.SetError(Error::eSocket, Error::eCodeTimeout, Error::kDescriptionSocketTimeout);
@@ -68,30 +378,25 @@ void InvocationUpnp::WriteRequest(const Uri& aUri)
         iInvocation.SetError(Error::eSocket, Error::kCodeUnknown, Error::kDescriptionUnknown);
         throw;
     }
+}
 
-    try {
-        InvocationBodyWriter::Write(iInvocation, body);
-        WriteHeaders(writerRequest, aUri, body.Bytes(), iCpStack.Env());
-        writeBuffer.Write(body);
-        writeBuffer.WriteFlush();
-    }
-    catch (WriterError) {
-        iInvocation.SetError(Error::eHttp, Error::kCodeUnknown, Error::kDescriptionUnknown);
-        THROW(WriterError);
-    }
+void InvocationUpnp::WriteRequest(const Uri& aUri)
+{
+    Sws<1024> writeBuffer(iConnection->Socket());
+    WriterHttpRequest writerRequest(writeBuffer);
+    Bwh body;
+
+    InvocationBodyWriter::Write(iInvocation, body);
+    WriteHeaders(writerRequest, aUri, body.Bytes(), iCpStack.Env());
+    writeBuffer.Write(body);
+    writeBuffer.WriteFlush();
 }
 
 void InvocationUpnp::ReadResponse()
 {
-    OutputProcessorUpnp outputProcessor;
-    HttpHeaderContentLength headerContentLength;
-    HttpHeaderTransferEncoding headerTransferEncoding;
     Bwh entity;
 
-    iReaderResponse.AddHeader(headerContentLength);
-    iReaderResponse.AddHeader(headerTransferEncoding);
-    iReaderResponse.Read(iCpStack.Env().InitParams()->InvocationTimeoutMs());
-    const HttpStatus& status = iReaderResponse.Status();
+    const HttpStatus& status = iConnection->ReaderResponse().Status();
     if (status != HttpStatus::kOk) {
         const Brx& reason = status.Reason();
         LOG_ERROR(kService, "InvocationUpnp::ReadResponse, http error %u %.*s\n", status.Code(), PBUF(reason));
@@ -102,9 +407,10 @@ void InvocationUpnp::ReadResponse()
     }
 
     WriterBwh writer(1024);
-    ReaderHttpEntity readerEntity(iReaderUntil);
-    readerEntity.ReadAll(writer, headerContentLength, headerTransferEncoding, ReaderHttpEntity::Client);
+    ReaderHttpEntity readerEntity(iConnection->Reader());
+    readerEntity.ReadAll(writer, iConnection->HeaderContentLength(), iConnection->HeaderTransferEncoding(), ReaderHttpEntity::Client);
     writer.TransferTo(entity);
+    iReusable = (iConnectionCache != NULL && iConnection->ResponseAllowsReuse());
 
     if (status == HttpStatus::kInternalServerError) {
         Brn envelope = XmlParserBasic::Find("Envelope", entity);
@@ -117,22 +423,7 @@ void InvocationUpnp::ReadResponse()
         THROW(HttpError);
     }
 
-    const Invocation::VectorArguments& outArgs = iInvocation.OutputArguments();
-    const TUint count = (TUint)outArgs.size();
-    Brn envelope = XmlParserBasic::Find("Envelope", entity);
-    Brn body = XmlParserBasic::Find("Body", envelope);
-    const Brn responseTagTrailer("Response");
-    const Brx& actionName = iInvocation.Action().Name();
-    TUint len = actionName.Bytes() + responseTagTrailer.Bytes();
-    Bwh responseTag(len);
-    responseTag.Append(actionName);
-    responseTag.Append(responseTagTrailer);
-    Brn response = XmlParserBasic::Find(responseTag, body);
-    for (TUint i=0; i<count; i++) {
-        const Brx& name = outArgs[i]->Parameter().Name();
-        Brn value = XmlParserBasic::Find(name, response);
-        outArgs[i]->ProcessOutput(outputProcessor, value);
-    }
+    InvocationResponseReader::Read(iInvocation, entity);
 }
 
 void InvocationUpnp::WriteHeaders(WriterHttpRequest& aWriterRequest, const Uri& aUri, TUint aBodyBytes, Environment& aEnv)
@@ -141,7 +432,9 @@ void InvocationUpnp::WriteHeaders(WriterHttpRequest& aWriterRequest, const Uri&
     const Brn kContentType("text/xml; charset=\"utf-8\"");
     const Brn kSoapAction("SOAPACTION");
 
-    aWriterRequest.WriteMethod(Http::kMethodPost, aUri.PathAndQuery(), Http::eHttp10);
+    // HTTP/1.1 connections are persistent by default; 1.0 ones close after each response
+    const Http::EVersion version = (iConnectionCache == NULL? Http::eHttp10 : Http::eHttp11);
+    aWriterRequest.WriteMethod(Http::kMethodPost, aUri.PathAndQuery(), version);
 
     Http::WriteHeaderHostAndPort(aWriterRequest, aUri.Host(), aUri.Port());
     Http::WriteHeaderContentLength(aWriterRequest, aBodyBytes);
@@ -163,7 +456,8 @@ void InvocationUpnp::Interrupt()
 {
     /* Assumes that interrupting the socket is always safe, regardless of whether we're
        using it or one of its stream/http wrappers */
-    iSocket.Interrupt(true);
+    iInterrupted = true;
+    iConnection->Socket().Interrupt(true);
 }
 
 
@@ -259,6 +553,63 @@ void InvocationBodyWriter::ProcessBinary(const Brx& aVal)
 }
 
 
+// InvocationResponseReader
+
+void InvocationResponseReader::Read(Invocation& aInvocation, const Brx& aEntity)
+{
+    const Brn kEnvelope("Envelope");
+    const Brn kBody("Body");
+    const Brn kResponseTagTrailer("Response");
+    const Brx& actionName = aInvocation.Action().Name();
+    Bwh responseTag(actionName.Bytes() + kResponseTagTrailer.Bytes());
+    responseTag.Append(actionName);
+    responseTag.Append(kResponseTagTrailer);
+    const Brx* path[] = { &kEnvelope, &kBody, &responseTag };
+
+    const Invocation::VectorArguments& outArgs = aInvocation.OutputArguments();
+    InvocationResponseReader self(outArgs);
+    XmlParserBasic::FindChildren(path, sizeof(path)/sizeof(path[0]), aEntity, self);
+    OutputProcessorUpnp outputProcessor;
+    const TUint count = (TUint)outArgs.size();
+    for (TUint i=0; i<count; i++) {
+        if (!self.iFound[i]) {
+            THROW(XmlError);
+        }
+        outArgs[i]->ProcessOutput(outputProcessor, self.iValues[i]);
+    }
+}
+
+InvocationResponseReader::InvocationResponseReader(const Invocation::VectorArguments& aArgs)
+    : iArgs(aArgs)
+    , iValues(aArgs.size())
+    , iFound(aArgs.size(), false)
+    , iNext(0)
+{
+}
+
+void InvocationResponseReader::ProcessChild(const Brx& aName, const Brx& aValue)
+{
+    // arguments are normally in the order they're declared so only search if this isn't the case
+    const TUint count = (TUint)iArgs.size();
+    TUint index = iNext;
+    if (index >= count || !Ascii::CaseInsensitiveEquals(aName, iArgs[index]->Parameter().Name())) {
+        for (index=0; index<count; index++) {
+            if (Ascii::CaseInsensitiveEquals(aName, iArgs[index]->Parameter().Name())) {
+                break;
+            }
+        }
+        if (index == count) {
+            return; // not an output argument we know about
+        }
+    }
+    if (!iFound[index]) { // as with XmlParserBasic::Find, only the first of any duplicates is used
+        iValues[index].Set(aValue);
+        iFound[index] = true;
+    }
+    iNext = index + 1;
+}
+
+
 // EventUpnp
 
 EventUpnp::EventUpnp(CpStack& aCpStack, CpiSubscription& aSubscription)
@@ -266,6 +617,8 @@ EventUpnp::EventUpnp(CpStack& aCpStack, CpiSubscription& aSubscription)
     , iSubscription(aSubscription)
     , iReadBuffer(iSocket)
     , iReaderUntil(iReadBuffer)
+    , iConnection(NULL)
+    , iInterrupted(false)
 {
 }
 
@@ -286,25 +639,64 @@ void EventUpnp::Subscribe(const Uri& aPublisher, const Uri& aSubscriber, TUint&
 
     SubscribeWriteRequest(aPublisher, aSubscriber, aDurationSecs);
     Brh sid;
-    SubscribeReadResponse(sid, aDurationSecs);
+    (void)SubscribeReadResponse(iReaderUntil, sid, aDurationSecs);
     iSubscription.SetSid(sid);
 }
 
-void EventUpnp::RenewSubscription(const Uri& aPublisher, TUint& aDurationSecs)
+void EventUpnp::RenewSubscription(const Uri& aPublisher, TUint& aDurationSecs, InvocationConnectionCache& aConnectionCache)
 {
-    iReaderUntil.ReadFlush();
-    iSocket.Open(iCpStack.Env());
-    iSubscription.SetInterruptHandler(this);
     Endpoint endpoint(aPublisher.Port(), aPublisher.Host());
-    TUint timeout = iCpStack.Env().InitParams()->TcpConnectTimeoutMs();
-    iSocket.Connect(endpoint, timeout);
-
-    RenewSubscriptionWriteRequest(aPublisher, aDurationSecs);
-    Brh tmp;
-    SubscribeReadResponse(tmp, aDurationSecs);
-    if (tmp != iSubscription.Sid()) {
-        THROW(HttpError);
+    InvocationConnectionUpnp* connection = aConnectionCache.Claim(endpoint);
+    CpiRenewalScheduler& renewals = iCpStack.SubscriptionManager().Renewals();
+    TBool reused = connection->IsConnected();
+    TBool retry = false;
+    TBool reusable = false;
+    try {
+        for (;;) {
+            if (!connection->IsConnected()) {
+                connection->Reader().ReadFlush();
+                connection->Connect(iCpStack.Env().InitParams()->TcpConnectTimeoutMs());
+                renewals.RenewalConnectionOpened(retry);
+            }
+            iConnection = connection;
+            iSubscription.SetInterruptHandler(this);
+            try {
+                RenewSubscriptionWriteRequest(connection->Socket(), aPublisher, aDurationSecs);
+                Brh tmp;
+                reusable = SubscribeReadResponse(connection->Reader(), tmp, aDurationSecs);
+                if (tmp != iSubscription.Sid()) {
+                    THROW(HttpError);
+                }
+                break;
+            }
+            catch (WriterError&) {
+                if (!reused || iInterrupted) {
+                    throw;
+                }
+            }
+            catch (ReaderError&) {
+                if (!reused || iInterrupted) {
+                    throw;
+                }
+            }
+            // the device closed this connection while it was idle; retry on a new one
+            LOG(kEvent, "EventUpnp::RenewSubscription (%p) reconnecting after idle connection closed\n", &iSubscription);
+            iSubscription.SetInterruptHandler(NULL);
+            iConnection = NULL;
+            connection->Close();
+            reused = false;
+            retry = true;
+        }
+    }
+    catch (...) {
+        iSubscription.SetInterruptHandler(NULL);
+        iConnection = NULL;
+        aConnectionCache.Release(connection, false);
+        throw;
     }
+    iSubscription.SetInterruptHandler(NULL);
+    iConnection = NULL;
+    aConnectionCache.Release(connection, reusable && !iInterrupted);
 }
 
 void EventUpnp::Unsubscribe(const Uri& aPublisher, const Brx& aSid)
@@ -323,7 +715,13 @@ void EventUpnp::Interrupt()
 {
     /* Assumes that interrupting the socket is always safe, regardless of whether we're
        using it or one of its stream/http wrappers */
-    iSocket.Interrupt(true);
+    iInterrupted = true;
+    if (iConnection != NULL) {
+        iConnection->Socket().Interrupt(true);
+    }
+    else {
+        iSocket.Interrupt(true);
+    }
 }
 
 void EventUpnp::SubscribeWriteRequest(const Uri& aPublisher, const Uri& aSubscriber, TUint aDurationSecs)
@@ -356,14 +754,18 @@ void EventUpnp::SubscribeWriteRequest(const Uri& aPublisher, const Uri& aSubscri
     writerRequest.WriteFlush();
 }
 
-void EventUpnp::SubscribeReadResponse(Brh& aSid, TUint& aDurationSecs)
+TBool EventUpnp::SubscribeReadResponse(ReaderUntil& aReader, Brh& aSid, TUint& aDurationSecs)
 {
-    ReaderHttpResponse readerResponse(iCpStack.Env(), iReaderUntil);
+    ReaderHttpResponse readerResponse(iCpStack.Env(), aReader);
     HeaderSid headerSid;
     HeaderTimeout headerTimeout;
+    HttpHeaderConnection headerConnection;
+    HttpHeaderContentLength headerContentLength;
 
     readerResponse.AddHeader(headerSid);
     readerResponse.AddHeader(headerTimeout);
+    readerResponse.AddHeader(headerConnection);
+    readerResponse.AddHeader(headerContentLength);
     readerResponse.Read(kSubscribeTimeoutMs);
     const HttpStatus& status = readerResponse.Status();
     if (status != HttpStatus::kOk) {
@@ -382,16 +784,20 @@ void EventUpnp::SubscribeReadResponse(Brh& aSid, TUint& aDurationSecs)
     if (aDurationSecs == 0) {
         THROW(HttpError);
     }
+
+    // the connection can only be reused if we know the response had no entity
+    return (readerResponse.Version() == Http::eHttp11 && !headerConnection.Close() &&
+            headerContentLength.Received() && headerContentLength.ContentLength() == 0);
 }
 
-void EventUpnp::RenewSubscriptionWriteRequest(const Uri& aPublisher, TUint aDurationSecs)
+void EventUpnp::RenewSubscriptionWriteRequest(IWriter& aWriter, const Uri& aPublisher, TUint aDurationSecs)
 {
     ASSERT(aPublisher.Port()!=Uri::kPortNotSpecified);
     const Brn kRequestMethod("SUBSCRIBE");
     const Brn kMethodCallback("CALLBACK");
     const Brn kMethodNt("NT");
     const Brn kFieldNt("upnp:event");
-    Sws<1024> writeBuffer(iSocket);
+    Sws<1024> writeBuffer(aWriter);
     WriterHttpRequest writerRequest(writeBuffer);
     WriterAscii writerAscii(writeBuffer);
 
@@ -13,6 +13,12 @@
 #include <OpenHome/Private/Http.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Net/Private/XmlParser.h>
+
+#include <list>
+#include <vector>
 
 namespace OpenHome {
 namespace Net {
@@ -20,27 +26,111 @@ namespace Net {
 class CpStack;
 class CpiSubscription;
 
-class InvocationUpnp : private IInterruptHandler
+/**
+ * Connection to a device's control server, which may be reused for several invocations
+ */
+class InvocationConnectionUpnp : private INonCopyable
+{
+public:
+    InvocationConnectionUpnp(Environment& aEnv, const Endpoint& aEndpoint);
+    ~InvocationConnectionUpnp();
+    const OpenHome::Endpoint& Endpoint() const;
+    TBool IsConnected() const;
+    void Connect(TUint aTimeoutMs);
+    void Close();
+    SocketTcpClient& Socket();
+    ReaderUntil& Reader();
+    ReaderHttpResponse& ReaderResponse();
+    const HttpHeaderContentLength& HeaderContentLength() const;
+    const HttpHeaderTransferEncoding& HeaderTransferEncoding() const;
+    /**
+     * Returns true if the response just read allows another request on this connection.
+     * Only valid once the response's entity has been read.
+     */
+    TBool ResponseAllowsReuse() const;
+    void SetIdleSince(TUint aTime);
+    TUint IdleSince() const;
+private:
+    Environment& iEnv;
+    OpenHome::Endpoint iEndpoint;
+    SocketTcpClient iSocket;
+    Srs<1024> iReadBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    ReaderHttpResponse iReaderResponse;
+    HttpHeaderConnection iHeaderConnection;
+    HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    TBool iConnected;
+    TUint iIdleSince;
+};
+
+/**
+ * Idle invocation connections for a single device
+ *
+ * Unless fixed limits are passed to the constructor, limits are read from
+ * InitialisationParams::GetCpInvocationKeepAlive() on each use so reuse can be
+ * enabled or disabled at any time.
+ */
+class InvocationConnectionCache : private INonCopyable
+{
+public:
+    InvocationConnectionCache(Environment& aEnv);
+    InvocationConnectionCache(Environment& aEnv, TUint aMaxIdle, TUint aIdleTimeoutMs);
+    ~InvocationConnectionCache();
+    TBool Enabled() const;
+    InvocationConnectionUpnp* Claim(const Endpoint& aEndpoint); // never returns NULL
+    void Release(InvocationConnectionUpnp* aConnection, TBool aReusable);
+private:
+    void GetLimits(TUint& aMaxIdle, TUint& aIdleTimeoutMs) const;
+    void TimerExpired();
+    static void Delete(std::vector<InvocationConnectionUpnp*>& aConnections);
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    const TBool iFixedLimits;
+    const TUint iMaxIdle;
+    const TUint iIdleTimeoutMs;
+    std::list<InvocationConnectionUpnp*> iIdle; // most recently used first
+    Timer* iTimer;
+    TBool iTimerActive;
+};
+
+class InvocationUpnp : private IInterruptHandler, private IInvocationContinuation
 {
 public:
-    InvocationUpnp(CpStack& aCpStack, Invocation& aInvocation);
+    /**
+     * aConnectionCache is NULL if connections should not be reused
+     */
+    InvocationUpnp(CpStack& aCpStack, Invocation& aInvocation, InvocationConnectionCache* aConnectionCache = NULL);
     ~InvocationUpnp();
+    /**
+     * Send the request then suspend aInvocation until the device responds.
+     * If aInvocation.Suspended() is true on return, it owns this object.
+     */
     void Invoke(const Uri& aUri);
     static void WriteServiceType(IWriterAscii& aWriter, const Invocation& aInvocation);
 private:
+    void SendRequest();
+    void Reconnect();
+    void Connect();
     void WriteRequest(const Uri& aUri);
     void ReadResponse();
     void WriteHeaders(WriterHttpRequest& aWriterRequest, const Uri& aUri, TUint aBodyBytes, Environment& aEnv);
     // IInterruptHandler
     void Interrupt();
+    // IInvocationContinuation
+    void Continue(TBool aTimedOut);
 private:
     static const TUint kMaxReadBytes = 16 * 1024;
     CpStack& iCpStack;
     Invocation& iInvocation;
-    OpenHome::SocketTcpClient iSocket;
-    Srs<1024> iReadBuffer;
-    ReaderUntilS<1024> iReaderUntil;
-    ReaderHttpResponse iReaderResponse;
+    InvocationConnectionCache* iConnectionCache;
+    InvocationConnectionUpnp* iConnection;
+    Uri iUri;
+    TBool iReused;
+    TUint iStartTime;
+    TBool iReusable;
+    TBool iInterrupted;
 };
 
 /**
@@ -68,20 +158,45 @@ private:
     WriterAscii iWriterAscii;
 };
 
+/**
+ * Read output arguments from the body (entity) of a successful http invocation response
+ *
+ * Scans the response once, regardless of the number of output arguments.
+ * Intended for internal use only
+ */
+class InvocationResponseReader : private IXmlChildHandler, private INonCopyable
+{
+public:
+    static void Read(Invocation& aInvocation, const Brx& aEntity);
+private:
+    InvocationResponseReader(const Invocation::VectorArguments& aArgs);
+    // IXmlChildHandler
+    void ProcessChild(const Brx& aName, const Brx& aValue);
+private:
+    const Invocation::VectorArguments& iArgs;
+    std::vector<Brn> iValues;
+    std::vector<TBool> iFound;
+    TUint iNext;    // index of the argument expected next
+};
+
 class EventUpnp : private IInterruptHandler, private INonCopyable
 {
 public:
     EventUpnp(CpStack& aCpStack, CpiSubscription& aSubscription);
     ~EventUpnp();
     void Subscribe(const Uri& aPublisher, const Uri& aSubscriber, TUint& aDurationSecs);
-    void RenewSubscription(const Uri& aPublisher, TUint& aDurationSecs);
+    /**
+     * Renew using a connection from aConnectionCache, returning it to the cache afterwards
+     * if the device allows another request on it.
+     */
+    void RenewSubscription(const Uri& aPublisher, TUint& aDurationSecs, InvocationConnectionCache& aConnectionCache);
     void Unsubscribe(const Uri& aPublisher, const Brx& aSid);
 private:
     void Interrupt();
 private:
     void SubscribeWriteRequest(const Uri& aPublisher, const Uri& aSubscriber, TUint aDurationSecs);
-    void SubscribeReadResponse(Brh& aSid, TUint& aDurationSecs);
-    void RenewSubscriptionWriteRequest(const Uri& aPublisher, TUint aDurationSecs);
+    TBool SubscribeReadResponse(ReaderUntil& aReader, Brh& aSid, TUint& aDurationSecs);
+    void RenewSubscriptionWriteRequest(IWriter& aWriter, const Uri& aPublisher, TUint aDurationSecs);
     void UnsubscribeWriteRequest(const Uri& aPublisher, const Brx& aSid);
     void UnsubscribeReadResponse();
     static void WriteHeaderSid(WriterHttpRequest& aWriterRequest, const Brx& aSid);
@@ -95,6 +210,8 @@ private:
     OpenHome::SocketTcpClient iSocket;
     Srs<1024> iReadBuffer;
     ReaderUntilS<1024> iReaderUntil;
+    InvocationConnectionUpnp* iConnection; // only set while renewing on a cached connection
+    TBool iInterrupted;
 };
 
 class OutputProcessorUpnp : public IOutputProcessor
@@ -20,6 +20,23 @@ public:
      * @param[in] aMimeType    MIME type of the file.  May be NULL if this is unknown.
      */
     virtual void WriteResourceBegin(uint32_t aTotalBytes, const char* aMimeType=NULL) = 0;
+    /**
+     * Alternative to WriteResourceBegin for files identified by a strong entity tag
+     *
+     * Writers which support conditional requests may skip file data the requester already holds.
+     *
+     * @param[in] aTotalBytes  Size in bytes of the file.  Can be 0 if size is unknown.
+     * @param[in] aMimeType    MIME type of the file.  May be NULL if this is unknown.
+     * @param[in] aETag        Quoted strong entity tag for this version of the file.
+     *
+     * @return  true if file data should be written; false if it should be skipped.
+     *          WriteResourceEnd must be called in either case.
+     */
+    virtual bool WriteResourceBeginWithETag(uint32_t aTotalBytes, const char* aMimeType, const char* /*aETag*/)
+    {
+        WriteResourceBegin(aTotalBytes, aMimeType);
+        return true;
+    }
     /**
      * Called to write a block of file data
      *
@@ -19,6 +19,7 @@ DviDevice::DviDevice(OpenHome::Net::DvStack& aDvStack, const Brx& aUdn)
     : iDvStack(aDvStack)
     , iLock("DDVM")
     , iServiceLock("DVM2")
+    , iDescriptionLock("DVM4")
     , iResourceManager(NULL)
     , iDisableLock("DVM3")
     , iShutdownSem("DVSD", 1)
@@ -30,6 +31,7 @@ DviDevice::DviDevice(OpenHome::Net::DvStack& aDvStack, const Brx& aUdn, IResourc
     : iDvStack(aDvStack)
     , iLock("DDVM")
     , iServiceLock("DVM2")
+    , iDescriptionLock("DVM4")
     , iResourceManager(&aResourceManager)
     , iDisableLock("DVM3")
     , iShutdownSem("DVSD", 1)
@@ -45,6 +47,7 @@ void DviDevice::Construct(const Brx& aUdn)
     iEnabled = eDisabled;
     iConfigId = 0;
     iConfigUpdated = false;
+    iDescriptionGeneration = 0;
     iParent = NULL;
     iProtocolDisableCount = 0;
     iSubscriptionId = 0;
@@ -361,6 +364,13 @@ TUint DviDevice::ConfigId()
     return iConfigId;
 }
 
+TUint DviDevice::DescriptionGeneration() const
+{
+    DviDevice* root = Root();
+    AutoMutex _(root->iDescriptionLock);
+    return root->iDescriptionGeneration;
+}
+
 void DviDevice::CreateSid(Brh& aSid)
 {
     Bwh sid(iUdn.Bytes() + 1 + Ascii::kMaxUintStringBytes + 1);
@@ -440,6 +450,7 @@ void DviDevice::SetEnabledLocked()
     }
     iEnabled = eEnabled;
     iConfigUpdated = false;
+    DescriptionChanged();
     iDisableLock.Wait();
     iShutdownSem.Clear();
     iDisableLock.Signal();
@@ -554,12 +565,22 @@ TBool DviDevice::ChildHasService(const OpenHome::Net::ServiceType& aServiceType)
 
 void DviDevice::ConfigChanged()
 {
+    DescriptionChanged();
     if (!iConfigUpdated) {
         iConfigId++;
         iConfigUpdated = true;
     }
 }
 
+void DviDevice::DescriptionChanged()
+{
+    /* A root device's description embeds those of all its children so a single
+       generation for the whole tree is used to invalidate any cached copies */
+    DviDevice* root = Root();
+    AutoMutex _(root->iDescriptionLock);
+    root->iDescriptionGeneration++;
+}
+
 TUint DviDevice::SubscriptionId()
 {
     iLock.Wait();
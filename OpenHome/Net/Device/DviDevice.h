@@ -73,6 +73,7 @@ public:
     void GetUriBase(Bwx& aUriBase, const TIpAddress& aInterface, TUint aPort, IDvProtocol& aProtocol);
     void GetUriBase(Bwx& aUriBase, const TIpAddress& aInterface, TUint aPort, const Brx& aProtocolName);
     TUint ConfigId();
+    TUint DescriptionGeneration() const; // changes whenever any description in this device's tree may have changed
     void CreateSid(Brh& aSid);
     IResourceManager* ResourceManager();
     DvStack& GetDvStack();
@@ -91,6 +92,7 @@ private:
     TBool HasService(const OpenHome::Net::ServiceType& aServiceType) const;
     TBool ChildHasService(const OpenHome::Net::ServiceType& aServiceType) const;
     void ConfigChanged();
+    void DescriptionChanged();
     TUint SubscriptionId();
 private: // from IStackObject
     void ListObjectDetails() const;
@@ -106,11 +108,13 @@ protected:
 private:
     mutable Mutex iLock;
     Mutex iServiceLock;
+    mutable Mutex iDescriptionLock;
     TUint iRefCount;
     Brhz iUdn;
     EEnableState iEnabled;
     TUint iConfigId;
     TBool iConfigUpdated;
+    TUint iDescriptionGeneration;
     DviDevice* iParent;
     std::vector<DviService*> iServices;
     std::vector<DviDevice*> iDevices;
@@ -420,6 +420,16 @@ void DviPropertyUpdateCollection::ReleaseWriter(IPropertyWriter* aWriter)
     delete aWriter;
 }
 
+IPropertyEncoder* DviPropertyUpdateCollection::PropertyEncoder()
+{
+    return NULL; // updates are stored per-property so that they can be merged
+}
+
+void DviPropertyUpdateCollection::PropertyWriteEncoded(IPropertyWriter& /*aWriter*/, const Brx& /*aEncoded*/)
+{
+    ASSERTS();
+}
+
 void DviPropertyUpdateCollection::NotifySubscriptionCreated(const Brx& /*aSid*/)
 {
 }
@@ -46,6 +46,7 @@ DviService::DviService(DvStack& aDvStack, const TChar* aDomain, const TChar* aNa
     , iLock("DVSM")
     , iRefCount(1)
     , iPropertiesLock("SPRM")
+    , iInvocationLock("DVSI")
     , iDisabled(true)
     , iCurrentInvocationCount(0)
     , iDisabledSem("DVSS", 0)
@@ -107,26 +108,29 @@ void DviService::RemoveRef()
 
 void DviService::Disable()
 {
-    iLock.Wait();
+    iInvocationLock.Wait();
     iDisabled = true;
-    iLock.Signal();
+    iInvocationLock.Signal();
     iDisabledSem.Wait();
     iDisabledSem.Signal(); // allow for possible further calls to Disable()
 }
 
 void DviService::Enable()
 {
-    iLock.Wait();
+    iInvocationLock.Wait();
     iDisabled = false;
     AssertPropertiesInitialised();
     iDisabledSem.Signal();
-    iLock.Signal();
+    iInvocationLock.Signal();
 }
 
 void DviService::AddAction(Action* aAction, FunctorDviInvocation aFunctor)
 {
     DvAction action(aAction, aFunctor);
     iDvActions.push_back(action);
+    // insert won't replace an earlier action with the same name, matching the old linear search
+    Brn name(aAction->Name());
+    (void)iActionIndex.insert(std::pair<Brn,TUint>(name, (TUint)iDvActions.size() - 1));
 }
 
 const std::vector<DvAction>& DviService::DvActions() const
@@ -146,40 +150,39 @@ void DviService::InvokeDirect(IDviInvocation& aInvocation, const Brx& aActionNam
 
 void DviService::Invoke(IDviInvocation& aInvocation, const Brx& aActionName, TBool aIgnoreEnableState)
 {
-    iLock.Wait();
     LOG(kDvInvocation, "Service: %.*s, Action: %.*s\n",
                        PBUF(iServiceType.Name()), PBUF(aActionName));
+    iInvocationLock.Wait();
     if (!aIgnoreEnableState && iDisabled) {
-        iLock.Signal();
+        iInvocationLock.Signal();
         aInvocation.InvocationReportError(502, Brn("Action not available"));
     }
     iCurrentInvocationCount++;
     (void)iDisabledSem.Clear();
-    iLock.Signal();
+    iInvocationLock.Signal();
 
     {
         AutoFunctor a(MakeFunctor(*this, &DviService::InvocationCompleted));
-        for (TUint i=0; i<iDvActions.size(); i++) {
-            if (iDvActions[i].Action()->Name() == aActionName) {
-                try {
-                    iDvActions[i].Functor()(aInvocation);
-                }
-                catch (InvocationError&) {
-                    // avoid calls to aInvocation.InvocationReportError in other catch blocks
-                    throw;
-                }
-                catch (AssertionFailed&) {
-                    throw;
-                }
-                catch (Exception& e) {
-                    Brn msg(e.Message());
-                    aInvocation.InvocationReportError(801, msg);
-                }
-                catch (...) {
-                    aInvocation.InvocationReportError(801, Brn("Unknown error"));
-                }
-                return;
+        ActionIndex::const_iterator it = iActionIndex.find(Brn(aActionName));
+        if (it != iActionIndex.end()) {
+            try {
+                iDvActions[it->second].Functor()(aInvocation);
+            }
+            catch (InvocationError&) {
+                // avoid calls to aInvocation.InvocationReportError in other catch blocks
+                throw;
+            }
+            catch (AssertionFailed&) {
+                throw;
             }
+            catch (Exception& e) {
+                Brn msg(e.Message());
+                aInvocation.InvocationReportError(801, msg);
+            }
+            catch (...) {
+                aInvocation.InvocationReportError(801, Brn("Unknown error"));
+            }
+            return;
         }
     }
 
@@ -188,12 +191,12 @@ void DviService::Invoke(IDviInvocation& aInvocation, const Brx& aActionName, TBo
 
 void DviService::InvocationCompleted()
 {
-    iLock.Wait();
+    iInvocationLock.Wait();
     iCurrentInvocationCount--;
     if (iCurrentInvocationCount == 0) {
         iDisabledSem.Signal();
     }
-    iLock.Signal();
+    iInvocationLock.Signal();
 }
 
 void DviService::PropertiesLock()
@@ -216,6 +219,11 @@ const std::vector<Property*>& DviService::Properties() const
     return iProperties;
 }
 
+EncodedPropertySetCache& DviService::EncodedPropertyCache()
+{
+    return iEncodedPropertyCache;
+}
+
 void DviService::PublishPropertyUpdates()
 {
     iLock.Wait();
@@ -15,6 +15,7 @@
 #include <OpenHome/Net/Core/OhNet.h>
 
 #include <vector>
+#include <map>
 
 EXCEPTION(InvocationError)
 
@@ -93,6 +94,7 @@ public:
     void PropertiesUnlock();
     DllExport void AddProperty(Property* aProperty);
     const std::vector<Property*>& Properties() const;
+    EncodedPropertySetCache& EncodedPropertyCache(); // only use while PropertiesLock() is held
     void PublishPropertyUpdates();
 
     void AddSubscription(DviSubscription* aSubscription);
@@ -105,13 +107,17 @@ private:
 private: // from IStackObject
     void ListObjectDetails() const;
 private:
+    typedef std::map<Brn,TUint,BufferCmp> ActionIndex;
     DvStack& iDvStack;
     Mutex iLock;
     TUint iRefCount;
     Mutex iPropertiesLock;
     std::vector<DvAction> iDvActions;
+    ActionIndex iActionIndex; // action name -> index into iDvActions
     std::vector<Property*> iProperties;
+    EncodedPropertySetCache iEncodedPropertyCache;
     std::vector<DviSubscription*> iSubscriptions;
+    Mutex iInvocationLock; // only guards the next three members so invocations aren't serialised with other uses of iLock
     TBool iDisabled;
     TUint iCurrentInvocationCount;
     Semaphore iDisabledSem;
@@ -22,9 +22,15 @@ DvStack::DvStack(OpenHome::Environment& aEnv)
     , iControlPoint(OpenHome::Brx::Empty())
 {
     iEnv.SetDvStack(this);
+    InitialisationParams* initParams = iEnv.InitParams();
+    TUint maxIdleEventConnections, eventConnectionTimeoutMs;
+    initParams->GetDvEventKeepAlive(maxIdleEventConnections, eventConnectionTimeoutMs);
+    iEventConnections = NULL;
+    if (maxIdleEventConnections > 0) {
+        iEventConnections = new EventConnectionPool(iEnv, maxIdleEventConnections, eventConnectionTimeoutMs);
+    }
     iSsdpNotifierManager = new DviSsdpNotifierManager(*this);
     iPropertyUpdateCollection = new DviPropertyUpdateCollection(*this);
-    InitialisationParams* initParams = iEnv.InitParams();
     TUint port = initParams->DvUpnpServerPort();
     iDviDeviceMap = new DviDeviceMap;
     iDviServerUpnp = new DviServerUpnp(*this, port);
@@ -48,6 +54,7 @@ DvStack::~DvStack()
     delete iSubscriptionManager;
     delete iPropertyUpdateCollection;
     delete iSsdpNotifierManager;
+    delete iEventConnections;
     ASSERT(iControlPointObservers.size() == 0);
 }
 
@@ -129,6 +136,11 @@ DviSsdpNotifierManager& DvStack::SsdpNotifierManager()
     return *iSsdpNotifierManager;
 }
 
+EventConnectionPool* DvStack::EventConnections()
+{
+    return iEventConnections;
+}
+
 void DvStack::AddProtocolFactory(IDvProtocolFactory* aProtocolFactory)
 {
     iProtocolFactories.push_back(aProtocolFactory);
@@ -48,6 +48,7 @@ public:
     DviSubscriptionManager& SubscriptionManager();
     DviPropertyUpdateCollection& PropertyUpdateCollection();
     DviSsdpNotifierManager& SsdpNotifierManager();
+    EventConnectionPool* EventConnections(); // NULL if event connections aren't reused
     void AddProtocolFactory(IDvProtocolFactory* aProtocolFactory);
     std::vector<IDvProtocolFactory*>& ProtocolFactories();
     void AddControlPointObserver(IControlPointObserver& aObserver);
@@ -66,6 +67,7 @@ private:
     DviServerWebSocket* iDviServerWebSocket;
     DviPropertyUpdateCollection* iPropertyUpdateCollection;
     DviSsdpNotifierManager* iSsdpNotifierManager;
+    EventConnectionPool* iEventConnections;
     std::vector<IDvProtocolFactory*> iProtocolFactories;
     std::vector<IControlPointObserver*> iControlPointObservers;
     Bws<kMaxControlPointBytes> iControlPoint;
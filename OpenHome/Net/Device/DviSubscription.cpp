@@ -9,6 +9,8 @@
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Converter.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 #include <stdlib.h>
@@ -46,6 +48,114 @@ AutoPropertiesLock::~AutoPropertiesLock()
 }
 
 
+// EncodedPropertySet
+
+EncodedPropertySet::EncodedPropertySet(IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers, WriterBwh& aEncoded)
+    : iLock("EPSL")
+    , iRefCount(1)
+    , iEncoder(aEncoder)
+    , iSequenceNumbers(aSequenceNumbers)
+{
+    aEncoded.TransferTo(iEncoded);
+}
+
+EncodedPropertySet::~EncodedPropertySet()
+{
+}
+
+void EncodedPropertySet::AddRef()
+{
+    AutoMutex _(iLock);
+    iRefCount++;
+}
+
+void EncodedPropertySet::RemoveRef()
+{
+    iLock.Wait();
+    const TBool dead = (--iRefCount == 0);
+    iLock.Signal();
+    if (dead) {
+        delete this;
+    }
+}
+
+const Brx& EncodedPropertySet::Buffer() const
+{
+    return iEncoded;
+}
+
+TBool EncodedPropertySet::Matches(const IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers) const
+{
+    return (&iEncoder == &aEncoder && iSequenceNumbers == aSequenceNumbers);
+}
+
+TBool EncodedPropertySet::IsCurrent(const std::vector<Property*>& aProperties) const
+{
+    for (TUint i=0; i<iSequenceNumbers.size(); i++) {
+        if (iSequenceNumbers[i] != 0 && iSequenceNumbers[i] != aProperties[i]->SequenceNumber()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// EncodedPropertySetCache
+
+EncodedPropertySetCache::EncodedPropertySetCache()
+{
+}
+
+EncodedPropertySetCache::~EncodedPropertySetCache()
+{
+    for (TUint i=0; i<iEntries.size(); i++) {
+        iEntries[i]->RemoveRef();
+    }
+}
+
+EncodedPropertySet* EncodedPropertySetCache::Claim(IPropertyEncoder& aEncoder, const std::vector<Property*>& aProperties,
+                                                   const std::vector<TUint>& aSequenceNumbers)
+{
+    ASSERT(aSequenceNumbers.size() == aProperties.size());
+    // Any entry containing a superseded value will never be asked for again
+    for (TUint i=0; i<iEntries.size();) {
+        if (iEntries[i]->IsCurrent(aProperties)) {
+            i++;
+        }
+        else {
+            iEntries[i]->RemoveRef();
+            iEntries.erase(iEntries.begin() + i);
+        }
+    }
+    for (TUint i=0; i<iEntries.size(); i++) {
+        if (iEntries[i]->Matches(aEncoder, aSequenceNumbers)) {
+            iEntries[i]->AddRef();
+            return iEntries[i];
+        }
+    }
+
+    WriterBwh writer(kEncodeGranularity);
+    for (TUint i=0; i<aProperties.size(); i++) {
+        if (aSequenceNumbers[i] != 0) {
+            aEncoder.Encode(*aProperties[i], writer);
+        }
+    }
+    EncodedPropertySet* encoded = new EncodedPropertySet(aEncoder, aSequenceNumbers, writer);
+    if (!encoded->IsCurrent(aProperties)) {
+        // a property was updated without the service's properties lock while we were encoding
+        // it; our caller gets a value newer than its sequence number suggests but nobody else should
+        return encoded;
+    }
+    encoded->AddRef();
+    iEntries.insert(iEntries.begin(), encoded);
+    if (iEntries.size() > kMaxEntries) {
+        iEntries.back()->RemoveRef();
+        iEntries.pop_back();
+    }
+    return encoded;
+}
+
+
 // DviSubscription
 
 DviSubscription::DviSubscription(DvStack& aDvStack, DviDevice& aDevice, IPropertyWriterFactory& aWriterFactory,
@@ -191,7 +301,9 @@ void DviSubscription::WriteChanges()
         throw;
     }
     catch (NetworkTimeout&) {
-        iWriterFactory.ReleaseWriter(writer);
+        if (writer != NULL) {
+            iWriterFactory.ReleaseWriter(writer);
+        }
         throw;
     }
     catch (Exception& ex) {
@@ -247,15 +359,47 @@ IPropertyWriter* DviSubscription::CreateWriter()
         iSequenceNumber++;
     }
 
-    AutoPropertiesLock b(*iService);
-    for (TUint i=0; i<properties.size(); i++) {
-        Property* prop = properties[i];
-        const TUint seq = prop->SequenceNumber();
-        if (seq != iPropertySequenceNumbers[i]) {
-            prop->Write(*writer);
-            iPropertySequenceNumbers[i] = seq;
+    IPropertyEncoder* encoder = iWriterFactory.PropertyEncoder();
+    if (encoder == NULL) {
+        AutoPropertiesLock b(*iService);
+        for (TUint i=0; i<properties.size(); i++) {
+            Property* prop = properties[i];
+            const TUint seq = prop->SequenceNumber();
+            if (seq != iPropertySequenceNumbers[i]) {
+                prop->Write(*writer);
+                iPropertySequenceNumbers[i] = seq;
+            }
+        }
+        return writer;
+    }
+
+    // Other subscribers with the same view of the service are likely to want the
+    // same set of changes.  Render them once and share the result.
+    EncodedPropertySet* encoded;
+    {
+        AutoPropertiesLock b(*iService);
+        iChangedSequenceNumbers.resize(properties.size());
+        for (TUint i=0; i<properties.size(); i++) {
+            const TUint seq = properties[i]->SequenceNumber();
+            if (seq != iPropertySequenceNumbers[i]) {
+                iChangedSequenceNumbers[i] = seq;
+                iPropertySequenceNumbers[i] = seq;
+            }
+            else {
+                iChangedSequenceNumbers[i] = 0;
+            }
         }
+        encoded = iService->EncodedPropertyCache().Claim(*encoder, properties, iChangedSequenceNumbers);
     }
+    try {
+        iWriterFactory.PropertyWriteEncoded(*writer, encoded->Buffer());
+    }
+    catch (Exception&) {
+        encoded->RemoveRef();
+        iWriterFactory.ReleaseWriter(writer);
+        throw;
+    }
+    encoded->RemoveRef();
     return writer;
 }
 
@@ -371,6 +515,32 @@ AutoSubscriptionRef::~AutoSubscriptionRef()
 }
 
 
+// PropertyWriterXml
+
+class PropertyWriterXml : public PropertyWriter
+{
+public:
+    PropertyWriterXml(IWriter& aWriter) { SetWriter(aWriter); }
+private: // from IPropertyWriter
+    void PropertyWriteEnd() {}
+};
+
+
+// PropertyEncoderXml
+
+class PropertyEncoderXml : public IPropertyEncoder
+{
+private: // from IPropertyEncoder
+    void Encode(Property& aProperty, IWriter& aWriter);
+};
+
+void PropertyEncoderXml::Encode(Property& aProperty, IWriter& aWriter)
+{
+    PropertyWriterXml writer(aWriter);
+    aProperty.Write(writer);
+}
+
+
 // PropertyWriter
 
 PropertyWriter::PropertyWriter()
@@ -378,6 +548,18 @@ PropertyWriter::PropertyWriter()
 {
 }
 
+IPropertyEncoder& PropertyWriter::Encoder()
+{ // static
+    static PropertyEncoderXml encoder;
+    return encoder;
+}
+
+void PropertyWriter::WriteEncoded(const Brx& aEncoded)
+{
+    ASSERT(iWriter != NULL);
+    iWriter->Write(aEncoded);
+}
+
 void PropertyWriter::SetWriter(IWriter& aWriter)
 {
     iWriter = &aWriter;
@@ -459,10 +641,11 @@ void PropertyWriter::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
 
 // Publisher
 
-Publisher::Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, Fifo<Publisher*>& aFree, TUint aModerationMs)
+Publisher::Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, PublisherPool& aPool, TUint aModerationMs)
     : Thread(aName, aPriority)
     , iObserver(aObserver)
-    , iFree(aFree)
+    , iPool(aPool)
+    , iSubscription(NULL)
     , iModerationMs(aModerationMs)
     , iModerator("PBMS", 0)
 {
@@ -474,12 +657,6 @@ Publisher::~Publisher()
     Join();
 }
 
-void Publisher::Publish(DviSubscription* aSubscription)
-{
-    iSubscription = aSubscription;
-    Signal();
-}
-
 #ifdef DEFINE_TRACE
 void Publisher::Error(const TChar* aErr)
 #else
@@ -494,7 +671,13 @@ void Publisher::Error(const TChar* /*aErr*/)
 void Publisher::Run()
 {
     for (;;) {
-        Wait();
+        TUint64 queuedUs;
+        iSubscription = iPool.Dequeue(*this, queuedUs);
+        if (iSubscription == NULL) {
+            // pool has registered us as idle and will Signal() when more work arrives
+            Wait();
+            continue;
+        }
         TBool timeout = false;
         try {
             iSubscription->WriteChanges();
@@ -511,79 +694,134 @@ void Publisher::Run()
         if (!timeout) {
             iObserver.NotifyPublishSuccess(*iSubscription);
         }
+        iPool.PublishComplete(queuedUs);
         iSubscription->RemoveRef();
+        iSubscription = NULL;
         if (iModerationMs > 0) {
             try {
                 iModerator.Wait(iModerationMs);
             }
             catch (Timeout&) {}
         }
-        iFree.Write(this);
+        CheckForKill();
     }
 }
 
 // PublisherPool
 
-PublisherPool::PublisherPool(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver,
+PublisherPool::PendingUpdate::PendingUpdate(DviSubscription* aSubscription, TUint64 aQueuedUs)
+    : iSubscription(aSubscription)
+    , iQueuedUs(aQueuedUs)
+{
+}
+
+PublisherPool::PublisherPool(Environment& aEnv, TUint aPriority, IPublisherObserver& aObserver,
                              TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs)
-    : Thread(aName, aPriority)
+    : iEnv(aEnv)
+    , iPoolNumber(aPoolNumber)
     , iNumPublishers(aNumPublisherThreads)
-    , iFree(aNumPublisherThreads)
     , iLock("DVPP")
+    , iUpdatesRequested(0)
+    , iUpdatesCoalesced(0)
+    , iMaxDepth(0)
+    , iPublished(0)
+    , iTotalLatencyUs(0)
+    , iMaxLatencyUs(0)
 {
     LOG_DEBUG(kDvEvent, "> PublisherPool %u: creating %u publisher threads\n", aPoolNumber, iNumPublishers);
+    iIdle.reserve(iNumPublishers);
     iPublishers = (Publisher**)malloc(sizeof(*iPublishers) * iNumPublishers);
 
     for (TUint i=0; i<iNumPublishers; i++) {
         Bws<Thread::kMaxNameBytes+1> thName;
         thName.AppendPrintf("Publisher_%d_%d", aPoolNumber, i);
         thName.PtrZ();
-        iPublishers[i] = new Publisher((const TChar*)thName.Ptr(), aPriority, aObserver, iFree, aModerationMs);
-        iFree.Write(iPublishers[i]);
+        iPublishers[i] = new Publisher((const TChar*)thName.Ptr(), aPriority, aObserver, *this, aModerationMs);
         iPublishers[i]->Start();
     }
-    Start();
+}
+
+PublisherPool::~PublisherPool()
+{
+    for (TUint i=0; i<iNumPublishers; i++) {
+        delete iPublishers[i];
+    }
+    free(iPublishers);
+    for (std::list<PendingUpdate>::iterator it = iPendingUpdates.begin(); it != iPendingUpdates.end(); ++it) {
+        it->iSubscription->RemoveRef();
+    }
 }
 
 std::list<DviSubscription*> PublisherPool::GetUpdates()
 {
     AutoMutex amx(iLock);
-    return iPendingUpdates;
+    std::list<DviSubscription*> updates;
+    for (std::list<PendingUpdate>::iterator it = iPendingUpdates.begin(); it != iPendingUpdates.end(); ++it) {
+        updates.push_back(it->iSubscription);
+    }
+    return updates;
 }
 
-void PublisherPool::QueueUpdate(DviSubscription& aSubscription)
+void PublisherPool::LogStats(IWriter& aWriter)
 {
-    iLock.Wait();
-    iPendingUpdates.push_back(&aSubscription);
-    Signal();
-    iLock.Signal();
+    AutoMutex amx(iLock);
+    const TUint coalescePercent = (iUpdatesRequested == 0? 0 : (TUint)(((TUint64)iUpdatesCoalesced * 100) / iUpdatesRequested));
+    const TUint avgLatencyUs = (iPublished == 0? 0 : (TUint)(iTotalLatencyUs / iPublished));
+    Bws<256> stats;
+    stats.AppendPrintf("\n\tPool %u: depth %u (max %u), %u updates requested, %u coalesced (%u%%), %u published, latency avg %uus max %uus",
+                       iPoolNumber, (TUint)iPendingUpdates.size(), iMaxDepth, iUpdatesRequested, iUpdatesCoalesced,
+                       coalescePercent, iPublished, avgLatencyUs, (TUint)iMaxLatencyUs);
+    aWriter.Write(stats);
 }
 
-void PublisherPool::Run()
+void PublisherPool::QueueUpdate(DviSubscription& aSubscription)
 {
-    for (;;) {
-        Wait();
-        Publisher* publisher = iFree.Read();
-        iLock.Wait();
-        DviSubscription* subscription = iPendingUpdates.front();
-        iPendingUpdates.pop_front();
-        iLock.Signal();
-        publisher->Publish(subscription);
+    AutoMutex amx(iLock);
+    iUpdatesRequested++;
+    if (!iQueued.insert(&aSubscription).second) {
+        // already pending; WriteChanges() will pick up this update too.  Drop the
+        // reference our caller claimed on our behalf.
+        iUpdatesCoalesced++;
+        aSubscription.RemoveRef();
+        return;
+    }
+    iPendingUpdates.push_back(PendingUpdate(&aSubscription, Os::TimeInUs(iEnv.OsCtx())));
+    if (iPendingUpdates.size() > iMaxDepth) {
+        iMaxDepth = (TUint)iPendingUpdates.size();
+    }
+    if (iIdle.size() > 0) {
+        Publisher* publisher = iIdle.back();
+        iIdle.pop_back();
+        publisher->Signal();
     }
 }
 
-PublisherPool::~PublisherPool()
+DviSubscription* PublisherPool::Dequeue(Publisher& aPublisher, TUint64& aQueuedUs)
 {
-    iLock.Wait();
-    Kill();
-    Join();
-    iLock.Signal();
-    for (TUint i=0; i<iNumPublishers; i++) {
-        delete iPublishers[i];
+    AutoMutex amx(iLock);
+    if (iPendingUpdates.size() == 0) {
+        iIdle.push_back(&aPublisher);
+        return NULL;
     }
-    free(iPublishers);
-    for (std::list<DviSubscription*>::iterator it = iPendingUpdates.begin(); it != iPendingUpdates.end(); ++it) {
-        (*it)->RemoveRef();
+    const PendingUpdate& update = iPendingUpdates.front();
+    DviSubscription* subscription = update.iSubscription;
+    aQueuedUs = update.iQueuedUs;
+    iPendingUpdates.pop_front();
+    /* clear the dirty flag before publishing so that changes made while
+       WriteChanges() runs cause the subscription to be queued again */
+    (void)iQueued.erase(subscription);
+    return subscription;
+}
+
+void PublisherPool::PublishComplete(TUint64 aQueuedUs)
+{
+    const TUint64 now = Os::TimeInUs(iEnv.OsCtx());
+    const TUint64 latencyUs = (now > aQueuedUs? now - aQueuedUs : 0);
+    AutoMutex amx(iLock);
+    iPublished++;
+    iTotalLatencyUs += latencyUs;
+    if (latencyUs > iMaxLatencyUs) {
+        iMaxLatencyUs = latencyUs;
     }
 }
 
@@ -606,10 +844,8 @@ DviSubscriptionManager::DviSubscriptionManager(DvStack& aDvStack, TUint aPriorit
     InitialisationParams* initParams = iDvStack.Env().InitParams();
     const TUint numPublisherThreads = initParams->DvNumPublisherThreads();
     const TUint moderationMs = initParams->DvPublisherModerationTimeMs();
-    Brn quickPoolThName("DviPublisherPool1");
-    Brn slowPoolThName("DviPublisherPool2");
-    iPublishersQuick = new PublisherPool((const TChar*)quickPoolThName.Ptr(), aPriority, *this, numPublisherThreads, 1, moderationMs);
-    iPublishersSlow = new PublisherPool((const TChar*)slowPoolThName.Ptr(), aPriority, *this, numPublisherThreads, 2, moderationMs);
+    iPublishersQuick = new PublisherPool(iDvStack.Env(), aPriority, *this, numPublisherThreads, 1, moderationMs);
+    iPublishersSlow = new PublisherPool(iDvStack.Env(), aPriority, *this, numPublisherThreads, 2, moderationMs);
 }
 
 DviSubscriptionManager::~DviSubscriptionManager()
@@ -712,7 +948,10 @@ void DviSubscriptionManager::QueryInfo(const Brx& aQuery, IWriter& aWriter)
     iAllPendingUpdates.merge(slowUpdates, SidComparison);
     for (it2=iAllPendingUpdates.begin(); it2!=iAllPendingUpdates.end(); ++it2) {
         aWriter.Write(Brn("\n\t"));
-        it->second->Log(aWriter);
+        (*it2)->Log(aWriter);
     }
+    aWriter.Write(Brn("\n\nPublishers:"));
+    iPublishersQuick->LogStats(aWriter);
+    iPublishersSlow->LogStats(aWriter);
     aWriter.Write(Brn("\n"));
 }
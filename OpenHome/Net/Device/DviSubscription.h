@@ -15,6 +15,7 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <set>
 
 EXCEPTION(DvSubscriptionError)
 
@@ -29,6 +30,19 @@ public:
     virtual void Release() = 0;
 };
     
+/**
+ * Renders a single property in a protocol's wire format.
+ *
+ * Output must depend only on the property's name and value so that it can be
+ * shared between every subscriber whose writer uses the same encoder.
+ */
+class IPropertyEncoder
+{
+public:
+    virtual ~IPropertyEncoder() {}
+    virtual void Encode(Property& aProperty, IWriter& aWriter) = 0;
+};
+
 class IPropertyWriterFactory
 {
 public:
@@ -36,12 +50,67 @@ public:
     virtual IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData, 
                                          const Brx& aSid, TUint aSequenceNumber) = 0;
     virtual void ReleaseWriter(IPropertyWriter* aWriter) = 0;
+    /**
+     * Encoder for properties passed to writers from this factory.
+     * Returns NULL if writers only accept individual PropertyWrite* calls.
+     */
+    virtual IPropertyEncoder* PropertyEncoder() = 0;
+    /**
+     * Write properties already rendered by PropertyEncoder() to aWriter
+     * (which was returned by ClaimWriter).
+     */
+    virtual void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded) = 0;
     virtual void NotifySubscriptionCreated(const Brx& aSid) = 0;
     virtual void NotifySubscriptionDeleted(const Brx& aSid) = 0;
     virtual void NotifySubscriptionExpired(const Brx& aSid) = 0;
     virtual void LogUserData(IWriter& aWriter, const IDviSubscriptionUserData& aUserData) = 0;
 };
 
+/**
+ * Immutable rendering of a set of property values.
+ *
+ * Shared by every subscription to a service whose writers use the same
+ * IPropertyEncoder and need the same set of property changes.
+ */
+class EncodedPropertySet : private INonCopyable
+{
+    friend class EncodedPropertySetCache;
+public:
+    void AddRef();
+    void RemoveRef();
+    const Brx& Buffer() const;
+private:
+    EncodedPropertySet(IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers, WriterBwh& aEncoded);
+    ~EncodedPropertySet();
+    TBool Matches(const IPropertyEncoder& aEncoder, const std::vector<TUint>& aSequenceNumbers) const;
+    TBool IsCurrent(const std::vector<Property*>& aProperties) const;
+private:
+    Mutex iLock;
+    TUint iRefCount;
+    IPropertyEncoder& iEncoder;
+    std::vector<TUint> iSequenceNumbers;
+    Brh iEncoded;
+};
+
+/**
+ * Per-service cache of EncodedPropertySets, keyed by encoder and by the vector
+ * of property sequence numbers being published (0 for properties left out).
+ *
+ * Claim() must be called with the service's properties lock held.
+ */
+class EncodedPropertySetCache : private INonCopyable
+{
+    static const TUint kMaxEntries = 8;
+    static const TUint kEncodeGranularity = 1024;
+public:
+    EncodedPropertySetCache();
+    ~EncodedPropertySetCache();
+    EncodedPropertySet* Claim(IPropertyEncoder& aEncoder, const std::vector<Property*>& aProperties,
+                              const std::vector<TUint>& aSequenceNumbers); // claims a ref for the caller
+private:
+    std::vector<EncodedPropertySet*> iEntries; // most recently added first
+};
+
 class DviDevice;
 class DviService;
 class DvStack;
@@ -85,6 +154,7 @@ private:
     Brh iSid;
     DviService* iService;
     std::vector<TUint> iPropertySequenceNumbers;
+    std::vector<TUint> iChangedSequenceNumbers;
     TUint iSequenceNumber;
     Timer* iTimer;
     TUint iPublisherFailures;
@@ -106,6 +176,8 @@ class PropertyWriter : public IPropertyWriter
 {
 public:
     static void WriteVariable(IWriter& aWriter, const Brx& aName, const Brx& aValue);
+    static IPropertyEncoder& Encoder();
+    void WriteEncoded(const Brx& aEncoded);
 protected:
     PropertyWriter();
     void SetWriter(IWriter& aWriter);
@@ -140,39 +212,69 @@ public:
     virtual void NotifyPublishError(DviSubscription& aSubscription) = 0;
 };
 
+class PublisherPool;
+
 class Publisher : public Thread
 {
 public:
-    Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, Fifo<Publisher*>& aFree, TUint aModerationMs);
+    Publisher(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, PublisherPool& aPool, TUint aModerationMs);
     ~Publisher();
-    void Publish(DviSubscription* aSubscription);
 private:
     void Error(const TChar* aErr);
     void Run();
 private:
     IPublisherObserver& iObserver;
-    Fifo<Publisher*>& iFree;
+    PublisherPool& iPool;
     DviSubscription* iSubscription;
     const TUint iModerationMs;
     Semaphore iModerator;
 };
 
-class PublisherPool : public Thread, public IPublisherQueue
+/**
+ * Coalescing queue of subscriptions with unpublished changes.
+ *
+ * A subscription is queued at most once; further updates that arrive before a
+ * publisher has claimed it are folded into the pending entry.  Publishers pull
+ * work directly from the queue, draining as many entries as are available each
+ * time they are woken.
+ */
+class PublisherPool : public IPublisherQueue
 {
+    friend class Publisher;
 public:
-    PublisherPool(const TChar* aName, TUint aPriority, IPublisherObserver& aObserver, TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs);
+    PublisherPool(Environment& aEnv, TUint aPriority, IPublisherObserver& aObserver, TUint aNumPublisherThreads, TUint aPoolNumber, TUint aModerationMs);
     ~PublisherPool();
     std::list<DviSubscription*> GetUpdates();
+    void LogStats(IWriter& aWriter);
 public: // from IPublisherQueue
     void QueueUpdate(DviSubscription& aSubscription);
-private: // from Thread
-    void Run();
 private:
+    DviSubscription* Dequeue(Publisher& aPublisher, TUint64& aQueuedUs);
+    void PublishComplete(TUint64 aQueuedUs);
+private:
+    class PendingUpdate
+    {
+    public:
+        PendingUpdate(DviSubscription* aSubscription, TUint64 aQueuedUs);
+    public:
+        DviSubscription* iSubscription;
+        TUint64 iQueuedUs;
+    };
+private:
+    Environment& iEnv;
+    TUint iPoolNumber;
     TUint iNumPublishers;
-    Fifo<Publisher*> iFree;
     Mutex iLock;
-    std::list<DviSubscription*> iPendingUpdates;
+    std::list<PendingUpdate> iPendingUpdates;
+    std::set<DviSubscription*> iQueued;
+    std::vector<Publisher*> iIdle;
     Publisher** iPublishers;
+    TUint iUpdatesRequested;
+    TUint iUpdatesCoalesced;
+    TUint iMaxDepth;
+    TUint iPublished;
+    TUint64 iTotalLatencyUs;
+    TUint64 iMaxLatencyUs;
 };
 
 class DviSubscriptionManager : private IPublisherObserver
@@ -82,12 +82,97 @@ const LpecError LpecError::kSubscriptionNotFound = LpecErrorMaker(404, "Subscrip
 const LpecError LpecError::kServiceNotSubscribed = LpecErrorMaker(405, "Service not subscribed");
 
 
+// PropertyEncoderLpec
+
+class PropertyEncoderLpec : public IPropertyEncoder
+{
+private: // from IPropertyEncoder
+    void Encode(Property& aProperty, IWriter& aWriter);
+};
+
+void PropertyEncoderLpec::Encode(Property& aProperty, IWriter& aWriter)
+{
+    PropertyWriterLpec writer(aWriter);
+    aProperty.Write(writer);
+}
+
+
+// PropertyWriterLpec
+
+PropertyWriterLpec::PropertyWriterLpec(IWriter& aWriter)
+    : iWriter(aWriter)
+{
+}
+
+IPropertyEncoder& PropertyWriterLpec::Encoder()
+{ // static
+    static PropertyEncoderLpec encoder;
+    return encoder;
+}
+
+void PropertyWriterLpec::WriteName(const Brx& aName)
+{
+    iWriter.Write(' ');
+    iWriter.Write(aName);
+    iWriter.Write(' ');
+}
+
+void PropertyWriterLpec::PropertyWriteString(const Brx& aName, const Brx& aValue)
+{
+    WriteName(aName);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Converter::ToXmlEscaped(iWriter, aValue);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void PropertyWriterLpec::PropertyWriteInt(const Brx& aName, TInt aValue)
+{
+    WriteName(aName);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Bws<Ascii::kMaxIntStringBytes> valBuf;
+    (void)Ascii::AppendDec(valBuf, aValue);
+    iWriter.Write(valBuf);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void PropertyWriterLpec::PropertyWriteUint(const Brx& aName, TUint aValue)
+{
+    WriteName(aName);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Bws<Ascii::kMaxUintStringBytes> valBuf;
+    (void)Ascii::AppendDec(valBuf, aValue);
+    iWriter.Write(valBuf);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void PropertyWriterLpec::PropertyWriteBool(const Brx& aName, TBool aValue)
+{
+    WriteName(aName);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    iWriter.Write(aValue? Lpec::kBoolTrue : Lpec::kBoolFalse);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void PropertyWriterLpec::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
+{
+    WriteName(aName);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+    Converter::ToBase64(iWriter, aValue);
+    iWriter.Write(Lpec::kArgumentDelimiter);
+}
+
+void PropertyWriterLpec::PropertyWriteEnd()
+{
+}
+
+
 // PropertyWriterFactoryLpec
 
 PropertyWriterFactoryLpec::PropertyWriterFactoryLpec(IEventWriter& aEventWriter)
     : iLock("PFL1")
     , iRefCount(1)
     , iEventWriter(aEventWriter)
+    , iPropertyWriter(aEventWriter)
     , iEnabled(true)
     , iSubscriptionMapLock("PFL2")
 {
@@ -158,6 +243,22 @@ void PropertyWriterFactoryLpec::ReleaseWriter(IPropertyWriter* /*aWriter*/)
 {
 }
 
+IPropertyEncoder* PropertyWriterFactoryLpec::PropertyEncoder()
+{
+    return &PropertyWriterLpec::Encoder();
+}
+
+void PropertyWriterFactoryLpec::PropertyWriteEncoded(IPropertyWriter& /*aWriter*/, const Brx& aEncoded)
+{
+    try {
+        iEventWriter.Write(aEncoded);
+    }
+    catch (WriterError&) {
+        iEventWriter.Unlock();
+        throw;
+    }
+}
+
 void PropertyWriterFactoryLpec::NotifySubscriptionCreated(const Brx& /*aSid*/)
 {
 }
@@ -188,12 +289,7 @@ void PropertyWriterFactoryLpec::LogUserData(IWriter& aWriter, const IDviSubscrip
 void PropertyWriterFactoryLpec::PropertyWriteString(const Brx& aName, const Brx& aValue)
 {
     try {
-        iEventWriter.Write(' ');
-        iEventWriter.Write(aName);
-        iEventWriter.Write(' ');
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
-        Converter::ToXmlEscaped(iEventWriter, aValue);
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
+        iPropertyWriter.PropertyWriteString(aName, aValue);
     }
     catch (WriterError&) {
         iEventWriter.Unlock();
@@ -204,14 +300,7 @@ void PropertyWriterFactoryLpec::PropertyWriteString(const Brx& aName, const Brx&
 void PropertyWriterFactoryLpec::PropertyWriteInt(const Brx& aName, TInt aValue)
 {
     try {
-        iEventWriter.Write(' ');
-        iEventWriter.Write(aName);
-        iEventWriter.Write(' ');
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
-        Bws<Ascii::kMaxIntStringBytes> valBuf;
-        (void)Ascii::AppendDec(valBuf, aValue);
-        iEventWriter.Write(valBuf);
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
+        iPropertyWriter.PropertyWriteInt(aName, aValue);
     }
     catch (WriterError&) {
         iEventWriter.Unlock();
@@ -222,14 +311,7 @@ void PropertyWriterFactoryLpec::PropertyWriteInt(const Brx& aName, TInt aValue)
 void PropertyWriterFactoryLpec::PropertyWriteUint(const Brx& aName, TUint aValue)
 {
     try {
-        iEventWriter.Write(' ');
-        iEventWriter.Write(aName);
-        iEventWriter.Write(' ');
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
-        Bws<Ascii::kMaxUintStringBytes> valBuf;
-        (void)Ascii::AppendDec(valBuf, aValue);
-        iEventWriter.Write(valBuf);
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
+        iPropertyWriter.PropertyWriteUint(aName, aValue);
     }
     catch (WriterError&) {
         iEventWriter.Unlock();
@@ -240,12 +322,7 @@ void PropertyWriterFactoryLpec::PropertyWriteUint(const Brx& aName, TUint aValue
 void PropertyWriterFactoryLpec::PropertyWriteBool(const Brx& aName, TBool aValue)
 {
     try {
-        iEventWriter.Write(' ');
-        iEventWriter.Write(aName);
-        iEventWriter.Write(' ');
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
-        iEventWriter.Write(aValue? Lpec::kBoolTrue : Lpec::kBoolFalse);
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
+        iPropertyWriter.PropertyWriteBool(aName, aValue);
     }
     catch (WriterError&) {
         iEventWriter.Unlock();
@@ -256,12 +333,7 @@ void PropertyWriterFactoryLpec::PropertyWriteBool(const Brx& aName, TBool aValue
 void PropertyWriterFactoryLpec::PropertyWriteBinary(const Brx& aName, const Brx& aValue)
 {
     try {
-        iEventWriter.Write(' ');
-        iEventWriter.Write(aName);
-        iEventWriter.Write(' ');
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
-        Converter::ToBase64(iEventWriter, aValue);
-        iEventWriter.Write(Lpec::kArgumentDelimiter);
+        iPropertyWriter.PropertyWriteBinary(aName, aValue);
     }
     catch (WriterError&) {
         iEventWriter.Unlock();
@@ -76,6 +76,24 @@ public:
     virtual TUint LpecSid(const Brx& aSid) = 0;
 };
 
+class PropertyWriterLpec : public IPropertyWriter, private INonCopyable
+{
+public:
+    PropertyWriterLpec(IWriter& aWriter);
+    static IPropertyEncoder& Encoder();
+public: // from IPropertyWriter
+    void PropertyWriteString(const Brx& aName, const Brx& aValue);
+    void PropertyWriteInt(const Brx& aName, TInt aValue);
+    void PropertyWriteUint(const Brx& aName, TUint aValue);
+    void PropertyWriteBool(const Brx& aName, TBool aValue);
+    void PropertyWriteBinary(const Brx& aName, const Brx& aValue);
+    void PropertyWriteEnd();
+private:
+    void WriteName(const Brx& aName);
+private:
+    IWriter& iWriter;
+};
+
 class PropertyWriterFactoryLpec : public IPropertyWriterFactory, private IPropertyWriter
 {
 public:
@@ -85,6 +103,8 @@ public:
 private: // from IPropertyWriterFactory
     IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData, const Brx& aSid, TUint aSequenceNumber);
     void ReleaseWriter(IPropertyWriter* aWriter);
+    IPropertyEncoder* PropertyEncoder();
+    void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded);
     void NotifySubscriptionCreated(const Brx& aSid);
     void NotifySubscriptionDeleted(const Brx& aSid);
     void NotifySubscriptionExpired(const Brx& aSid);
@@ -105,6 +125,7 @@ private:
     Mutex iLock;
     TUint iRefCount;
     IEventWriter& iEventWriter;
+    PropertyWriterLpec iPropertyWriter;
     TBool iEnabled;
     typedef std::map<Brn,DviSubscription*,BufferCmp> SubscriptionMap;
     SubscriptionMap iSubscriptionMap;
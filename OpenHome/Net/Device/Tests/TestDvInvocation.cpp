@@ -11,6 +11,12 @@
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/Error.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Uri.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 
@@ -28,6 +34,7 @@ public:
     CpDevices(Semaphore& aAddedSem, const Brx& aTargetUdn);
     ~CpDevices();
     void Test();
+    CpDevice& Device();
     void Added(CpDevice& aDevice);
     void Removed(CpDevice& aDevice);
 private:
@@ -37,6 +44,60 @@ private:
     const Brx& iTargetUdn;
 };
 
+// Device whose Increment action waits on a semaphore before responding
+class DeviceGated
+{
+public:
+    DeviceGated(DvStack& aDvStack, Semaphore& aGate);
+    ~DeviceGated();
+    const Brx& Udn() const;
+private:
+    DvDeviceStandard* iDevice;
+    DvProviderOpenhomeOrgTestBasic1* iProvider;
+};
+
+class ProviderGated : public DvProviderOpenhomeOrgTestBasic1
+{
+public:
+    ProviderGated(DvDevice& aDevice, Semaphore& aGate);
+private:
+    void Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult);
+private:
+    Semaphore& iGate;
+};
+
+class AsyncIncrements
+{
+public:
+    AsyncIncrements(CpProxyOpenhomeOrgTestBasic1& aProxy);
+    void Begin(TUint aValue);
+    void Wait(); // waits for one invocation to complete
+    TUint Succeeded() const;
+    TUint TimedOut() const;
+private:
+    void Completed(IAsync& aAsync);
+private:
+    CpProxyOpenhomeOrgTestBasic1& iProxy;
+    mutable Mutex iLock;
+    Semaphore iSem;
+    TUint iSucceeded;
+    TUint iTimedOut;
+};
+
+// Deletes a proxy from another thread after a delay
+class ProxyDeleter
+{
+public:
+    ProxyDeleter(CpProxyOpenhomeOrgTestBasic1* aProxy, TUint aDelayMs);
+    ~ProxyDeleter();
+private:
+    void Run();
+private:
+    CpProxyOpenhomeOrgTestBasic1* iProxy;
+    TUint iDelayMs;
+    ThreadFunctor* iThread;
+};
+
 } // namespace TestDvInvocation
 } // namespace OpenHome
 
@@ -196,6 +257,12 @@ void CpDevices::Test()
     delete proxy;
 }
 
+CpDevice& CpDevices::Device()
+{
+    ASSERT(iList.size() != 0);
+    return *(iList[0]);
+}
+
 void CpDevices::Added(CpDevice& aDevice)
 {
     AutoMutex _(iLock);
@@ -211,6 +278,287 @@ void CpDevices::Removed(CpDevice& /*aDevice*/)
 }
 
 
+
+// DeviceGated
+
+static Bwh gNameDeviceGated("DeviceGated");
+
+DeviceGated::DeviceGated(DvStack& aDvStack, Semaphore& aGate)
+{
+    RandomiseUdn(aDvStack.Env(), gNameDeviceGated);
+    iDevice = new DvDeviceStandard(aDvStack, gNameDeviceGated);
+    iDevice->SetAttribute("Upnp.Domain", "openhome.org");
+    iDevice->SetAttribute("Upnp.Type", "Test");
+    iDevice->SetAttribute("Upnp.Version", "1");
+    iDevice->SetAttribute("Upnp.FriendlyName", "ohNetTestDeviceGated");
+    iDevice->SetAttribute("Upnp.Manufacturer", "None");
+    iDevice->SetAttribute("Upnp.ModelName", "ohNet test device");
+    iProvider = new ProviderGated(*iDevice, aGate);
+    iDevice->SetEnabled();
+}
+
+DeviceGated::~DeviceGated()
+{
+    delete iProvider;
+    delete iDevice;
+}
+
+const Brx& DeviceGated::Udn() const
+{
+    return iDevice->Udn();
+}
+
+
+// ProviderGated
+
+ProviderGated::ProviderGated(DvDevice& aDevice, Semaphore& aGate)
+    : DvProviderOpenhomeOrgTestBasic1(aDevice)
+    , iGate(aGate)
+{
+    EnableActionIncrement();
+}
+
+void ProviderGated::Increment(IDvInvocation& aInvocation, TUint aValue, IDvInvocationResponseUint& aResult)
+{
+    iGate.Wait();
+    aInvocation.StartResponse();
+    aResult.Write(++aValue);
+    aInvocation.EndResponse();
+}
+
+
+// AsyncIncrements
+
+AsyncIncrements::AsyncIncrements(CpProxyOpenhomeOrgTestBasic1& aProxy)
+    : iProxy(aProxy)
+    , iLock("TAIN")
+    , iSem("TAIN", 0)
+    , iSucceeded(0)
+    , iTimedOut(0)
+{
+}
+
+void AsyncIncrements::Begin(TUint aValue)
+{
+    FunctorAsync functor = MakeFunctorAsync(*this, &AsyncIncrements::Completed);
+    iProxy.BeginIncrement(aValue, functor);
+}
+
+void AsyncIncrements::Wait()
+{
+    iSem.Wait();
+}
+
+TUint AsyncIncrements::Succeeded() const
+{
+    AutoMutex _(iLock);
+    return iSucceeded;
+}
+
+TUint AsyncIncrements::TimedOut() const
+{
+    AutoMutex _(iLock);
+    return iTimedOut;
+}
+
+void AsyncIncrements::Completed(IAsync& aAsync)
+{
+    try {
+        TUint result;
+        iProxy.EndIncrement(aAsync, result);
+        AutoMutex _(iLock);
+        iSucceeded++;
+    }
+    catch (ProxyError& e) {
+        if (e.Level() == Error::eSocket && e.Code() == Error::eCodeTimeout) {
+            AutoMutex _(iLock);
+            iTimedOut++;
+        }
+    }
+    iSem.Signal();
+}
+
+
+// ProxyDeleter
+
+ProxyDeleter::ProxyDeleter(CpProxyOpenhomeOrgTestBasic1* aProxy, TUint aDelayMs)
+    : iProxy(aProxy)
+    , iDelayMs(aDelayMs)
+{
+    iThread = new ThreadFunctor("PXDL", MakeFunctor(*this, &ProxyDeleter::Run));
+    iThread->Start();
+}
+
+ProxyDeleter::~ProxyDeleter()
+{
+    delete iThread;
+}
+
+void ProxyDeleter::Run()
+{
+    Thread::Sleep(iDelayMs);
+    delete iProxy;
+}
+
+
+static void TestSuspendedInvocations(Environment& aEnv, CpDevice& aDevice, CpDevice& aGatedDevice, Semaphore& aGate)
+{
+    InitialisationParams* initParams = aEnv.InitParams();
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    CpProxyOpenhomeOrgTestBasic1* gatedProxy = new CpProxyOpenhomeOrgTestBasic1(aGatedDevice);
+    AsyncIncrements increments(*gatedProxy);
+
+    /* Keep more actions waiting for responses than there are invoker threads.  They
+       release their invokers while waiting so a second device can still be invoked. */
+    Print("  Invocations waiting for responses don't block invoker threads...\n");
+    const TUint numGated = initParams->NumActionInvokerThreads() + 2;
+    ASSERT(numGated < initParams->DvNumServerThreads()); // device needs a spare session for proxy
+    TUint i;
+    for (i=0; i<numGated; i++) {
+        increments.Begin(i);
+    }
+    for (i=0; i<10; i++) {
+        TUint result;
+        proxy->SyncIncrement(i, result);
+        ASSERT(result == i+1);
+    }
+    ASSERT(increments.Succeeded() == 0);
+    for (i=0; i<numGated; i++) {
+        aGate.Signal();
+    }
+    for (i=0; i<numGated; i++) {
+        increments.Wait();
+    }
+    ASSERT(increments.Succeeded() == numGated);
+
+    Print("  Invocations time out if the device doesn't respond...\n");
+    const TUint oldTimeoutMs = initParams->InvocationTimeoutMs();
+    initParams->SetInvocationTimeout(500);
+    increments.Begin(0);
+    increments.Wait();
+    ASSERT(increments.TimedOut() == 1);
+    initParams->SetInvocationTimeout(oldTimeoutMs);
+    aGate.Signal();
+
+    /* Actions sent over a kept-alive connection that the device has since closed are
+       retried on a new connection */
+    Print("  Invocations reconnect after device closes an idle connection...\n");
+    TUint oldMaxIdle, oldIdleTimeoutMs, oldMaxRequests, oldDvIdleTimeoutMs;
+    initParams->GetCpInvocationKeepAlive(oldMaxIdle, oldIdleTimeoutMs);
+    initParams->GetDvUpnpKeepAlive(oldMaxRequests, oldDvIdleTimeoutMs);
+    initParams->SetCpInvocationKeepAlive(1, 10 * 1000);
+    initParams->SetDvUpnpKeepAlive(100, 100);
+    for (i=0; i<3; i++) {
+        TUint result;
+        proxy->SyncIncrement(i, result);
+        ASSERT(result == i+1);
+        Thread::Sleep(300);
+    }
+    initParams->SetCpInvocationKeepAlive(oldMaxIdle, oldIdleTimeoutMs);
+    initParams->SetDvUpnpKeepAlive(oldMaxRequests, oldDvIdleTimeoutMs);
+
+    delete gatedProxy;
+    delete proxy;
+}
+
+/* Sync invocations run on the caller thread rather than an invoker must still time out
+   if the device doesn't respond and be interrupted when their proxy is deleted. */
+static void TestCallerThreadInvocations(Environment& aEnv, CpDevice& aGatedDevice, Semaphore& aGate)
+{
+    static const TUint kDeleteDelayMs = 500;
+    InitialisationParams* initParams = aEnv.InitParams();
+    initParams->SetCpSyncInvocationsOnCallerThread(true);
+    CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(aGatedDevice);
+
+    Print("  Sync invocations on the caller thread time out if the device doesn't respond...\n");
+    const TUint oldTimeoutMs = initParams->InvocationTimeoutMs();
+    initParams->SetInvocationTimeout(500);
+    TBool timedOut = false;
+    try {
+        TUint result;
+        proxy->SyncIncrement(0, result);
+    }
+    catch (ProxyError& e) {
+        timedOut = (e.Level() == Error::eSocket && e.Code() == Error::eCodeTimeout);
+    }
+    ASSERT(timedOut);
+    initParams->SetInvocationTimeout(oldTimeoutMs);
+    aGate.Signal();
+
+    Print("  Sync invocations on the caller thread are interrupted by deleting their proxy...\n");
+    ASSERT(oldTimeoutMs > 2 * kDeleteDelayMs);
+    const TUint start = Os::TimeInMs(aEnv.OsCtx());
+    ProxyDeleter* deleter = new ProxyDeleter(proxy, kDeleteDelayMs);
+    TBool interrupted = false;
+    try {
+        TUint result;
+        proxy->SyncIncrement(0, result);
+    }
+    catch (ProxyError& e) {
+        interrupted = (e.Level() == Error::eAsync && e.Code() == Error::eCodeInterrupted);
+    }
+    ASSERT(interrupted);
+    ASSERT(Os::TimeInMs(aEnv.OsCtx()) - start < oldTimeoutMs);
+    delete deleter;
+    aGate.Signal();
+
+    initParams->SetCpSyncInvocationsOnCallerThread(false);
+}
+
+/* Connections are parked between requests (see TestDvInvocationMain) and may be resumed
+   by a different session.  The device's per-connection request limit must still apply. */
+static void TestParkedRequestLimit(Environment& aEnv, CpDevice& aDevice)
+{
+    static const TUint kMaxRequests = 3;
+    Print("  Parked connections are closed after the request limit...\n");
+    InitialisationParams* initParams = aEnv.InitParams();
+    TUint oldMaxRequests, oldIdleTimeoutMs;
+    initParams->GetDvUpnpKeepAlive(oldMaxRequests, oldIdleTimeoutMs);
+    initParams->SetDvUpnpKeepAlive(kMaxRequests, oldIdleTimeoutMs);
+
+    Brh location;
+    ASSERT(aDevice.GetAttribute("Upnp.Location", location));
+    Uri uri(location);
+    SocketTcpClient socket;
+    socket.Open(aEnv);
+    socket.Connect(Endpoint(uri.Port(), uri.Host()), 5000);
+    Srs<1024> readBuffer(socket);
+    ReaderUntilS<1024> readerUntil(readBuffer);
+    Sws<1024> writeBuffer(socket);
+    ReaderHttpResponse readerResponse(aEnv, readerUntil);
+    HttpHeaderContentLength headerContentLength;
+    HttpHeaderConnection headerConnection;
+    readerResponse.AddHeader(headerContentLength);
+    readerResponse.AddHeader(headerConnection);
+    for (TUint i=0; i<kMaxRequests; i++) {
+        writeBuffer.Write(Brn("GET "));
+        writeBuffer.Write(uri.PathAndQuery());
+        writeBuffer.Write(Brn(" HTTP/1.1\r\nHost: "));
+        writeBuffer.Write(uri.Authority());
+        writeBuffer.Write(Brn("\r\n\r\n"));
+        writeBuffer.WriteFlush();
+        readerResponse.Read(5000);
+        ASSERT(readerResponse.Status() == HttpStatus::kOk);
+        ASSERT(headerConnection.Close() == (i+1 == kMaxRequests));
+        TUint remaining = headerContentLength.ContentLength();
+        ASSERT(remaining > 0);
+        while (remaining > 0) {
+            remaining -= readerUntil.Read(remaining).Bytes();
+        }
+    }
+    TBool closed = false;
+    try {
+        closed = (readerUntil.Read(1).Bytes() == 0);
+    }
+    catch (ReaderError&) {
+        closed = true;
+    }
+    ASSERT(closed);
+    socket.Close();
+
+    initParams->SetDvUpnpKeepAlive(oldMaxRequests, oldIdleTimeoutMs);
+}
+
 void TestDvInvocation(CpStack& aCpStack, DvStack& aDvStack)
 {
     InitialisationParams* initParams = aDvStack.Env().InitParams();
@@ -230,6 +578,21 @@ void TestDvInvocation(CpStack& aCpStack, DvStack& aDvStack)
                 new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, added, removed);
     sem->Wait(30*1000); // allow up to 30 seconds to find our one device
     deviceList->Test();
+    TestParkedRequestLimit(aDvStack.Env(), deviceList->Device());
+
+    Semaphore gate("GATE", 0);
+    DeviceGated* gatedDevice = new DeviceGated(aDvStack, gate);
+    CpDevices* gatedDeviceList = new CpDevices(*sem, gatedDevice->Udn());
+    FunctorCpDevice gatedAdded = MakeFunctorCpDevice(*gatedDeviceList, &CpDevices::Added);
+    CpDeviceListUpnpServiceType* gatedList =
+                new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, gatedAdded, removed);
+    sem->Wait(30*1000);
+    TestSuspendedInvocations(aDvStack.Env(), deviceList->Device(), gatedDeviceList->Device(), gate);
+    TestCallerThreadInvocations(aDvStack.Env(), gatedDeviceList->Device(), gate);
+    delete gatedList;
+    delete gatedDeviceList;
+    delete gatedDevice;
+
     delete list;
     delete deviceList;
     delete sem;
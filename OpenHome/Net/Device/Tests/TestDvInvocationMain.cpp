@@ -23,6 +23,10 @@ void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::Init
         aInitParams->SetUseLoopbackNetworkAdapter();
     }
     aInitParams->SetDvUpnpServerPort(0);
+    aInitParams->SetDvNumServerThreads(aInitParams->NumActionInvokerThreads() + 4);
+    // keep-alive connections are parked between requests
+    aInitParams->SetDvUpnpKeepAlive(100, 100);
+    aInitParams->SetDvUpnpParkIdleConnections(8);
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
@@ -11,7 +11,11 @@
 #include <OpenHome/Net/Private/DviServerLpec.h>
 #include <OpenHome/Net/Private/CpiDeviceLpec.h>
 #include <OpenHome/Net/Core/CpDevice.h>
+#include <OpenHome/Net/Core/CpStack.h>
 #include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 
@@ -35,18 +39,60 @@ private:
     ProviderTestBasic* iTestBasic;
 };
 
+// Repeatedly invokes Increment (or EchoBinary, if aBinaryBytes is non-zero) from its own thread
+class Caller : private INonCopyable
+{
+public:
+    Caller(CpDevice& aDevice, TUint aId, TUint aCalls, Semaphore& aDone, TUint aBinaryBytes = 0);
+    ~Caller();
+    void Start();
+    TBool Succeeded() const;
+private:
+    void Run();
+private:
+    CpProxyOpenhomeOrgTestBasic1* iProxy;
+    ThreadFunctor* iThread;
+    TUint iId;
+    TUint iCalls;
+    Semaphore& iDone;
+    TBool iSucceeded;
+    Bwh iBinary;
+};
+
+/* Minimal LPEC device which reads a backlog of requests before replying to any, then
+   echoes each request's last argument.  It writes through a small send buffer so doesn't
+   read further requests until the control point has read most of the backlog of responses. */
+class StalledEchoSession : public SocketTcpSession
+{
+    static const TUint kSendBufBytes = 8 * 1024;
+    static const TUint kMaxLineBytes = 12000;
+public:
+    static const Brn kLpecName;
+public:
+    StalledEchoSession(TUint aBacklog);
+private:
+    void Run();
+private:
+    TUint iBacklog;
+};
+
 class TestLpec
 {
     static const TUint kTestIterations = 10;
+    static const TUint kConcurrentCallers = 4;
+    static const TUint kLargeBinaryBytes = 8000; // base64 encoded request and response fit within LPEC's line limits
 public:
     TestLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName, Semaphore& aSem);
     ~TestLpec();
     void TestActions();
     void TestSubscriptions();
+    void TestLargeBinary(TUint aCallers);
+    TBool RunCallers(TUint aCallers, TUint aCallsPerCaller, TUint aBinaryBytes = 0);
 private:
     void DeviceReady();
     void UpdatesComplete();
 private:
+    Environment& iEnv;
     Semaphore& iSem;
     Semaphore iUpdatesComplete;
     CpDevice* iCpDevice;
@@ -92,10 +138,123 @@ const Brx& DeviceLpec::LpecDeviceName() const
 }
 
 
+// Caller
+
+Caller::Caller(CpDevice& aDevice, TUint aId, TUint aCalls, Semaphore& aDone, TUint aBinaryBytes)
+    : iId(aId)
+    , iCalls(aCalls)
+    , iDone(aDone)
+    , iSucceeded(true)
+    , iBinary(aBinaryBytes)
+{
+    // contents are distinct per caller so that mismatched responses would be spotted
+    for (TUint i=0; i<aBinaryBytes; i++) {
+        iBinary.Append((TByte)(aId + i));
+    }
+    iProxy = new CpProxyOpenhomeOrgTestBasic1(aDevice);
+    iThread = new ThreadFunctor("LPCL", MakeFunctor(*this, &Caller::Run));
+}
+
+Caller::~Caller()
+{
+    delete iThread;
+    delete iProxy;
+}
+
+void Caller::Start()
+{
+    iThread->Start();
+}
+
+TBool Caller::Succeeded() const
+{
+    return iSucceeded;
+}
+
+void Caller::Run()
+{
+    // values are distinct per caller so that mismatched responses would be spotted
+    const TUint base = iId * 1000000;
+    for (TUint i=0; i<iCalls; i++) {
+        TUint result = 0;
+        Brh resultBin;
+        try {
+            if (iBinary.Bytes() > 0) {
+                iProxy->SyncEchoBinary(iBinary, resultBin);
+            }
+            else {
+                iProxy->SyncIncrement(base + i, result);
+            }
+        }
+        catch (ProxyError&) {
+            iSucceeded = false;
+            break;
+        }
+        if (iBinary.Bytes() > 0? resultBin != iBinary : result != base + i + 1) {
+            iSucceeded = false;
+            break;
+        }
+    }
+    iDone.Signal();
+}
+
+
+// StalledEchoSession
+
+const Brn StalledEchoSession::kLpecName("TestLpecStalled");
+
+StalledEchoSession::StalledEchoSession(TUint aBacklog)
+    : iBacklog(aBacklog)
+{
+}
+
+void StalledEchoSession::Run()
+{
+    SetSendBufBytes(kSendBufBytes);
+    Srs<1024> readBuffer(*this);
+    ReaderUntilS<kMaxLineBytes> readerUntil(readBuffer);
+    WriterBwh responses(kMaxLineBytes);
+    try {
+        responses.Write(Lpec::kMethodAlive);
+        responses.Write(' ');
+        responses.Write(kLpecName);
+        responses.Write(Brn(" stalled-udn"));
+        responses.Write(Lpec::kMsgTerminator);
+        Write(responses.Buffer());
+        for (TUint backlog = iBacklog; ; backlog = 1) {
+            responses.Reset();
+            for (TUint i=0; i<backlog; i++) {
+                Brn req = Ascii::Trim(readerUntil.ReadUntil(Ascii::kLf));
+                Brn arg; // last argument, without its closing and opening delimiters
+                if (req.Bytes() > 1) {
+                    TUint start = req.Bytes() - 1;
+                    while (start > 0 && req[start-1] != Lpec::kArgumentDelimiter) {
+                        start--;
+                    }
+                    arg.Set(req.Ptr() + start, req.Bytes() - 1 - start);
+                }
+                responses.Write(Lpec::kMethodResponse);
+                responses.Write(' ');
+                responses.Write(Lpec::kArgumentDelimiter);
+                responses.Write(arg);
+                responses.Write(Lpec::kArgumentDelimiter);
+                responses.Write(Lpec::kMsgTerminator);
+            }
+            Write(responses.Buffer());
+        }
+    }
+    catch (ReaderError&) {
+    }
+    catch (WriterError&) {
+    }
+}
+
+
 // TestLpec
 
 TestLpec::TestLpec(CpStack& aCpStack, Endpoint aLocation, const Brx& aLpecName, Semaphore& aSem)
-    : iSem(aSem)
+    : iEnv(aCpStack.Env())
+    , iSem(aSem)
     , iUpdatesComplete("SEM2", 0)
     , iCpDevice(NULL)
 {
@@ -165,6 +324,9 @@ void TestLpec::TestActions()
         ASSERT(result == valBin);
     }
 
+    Print("    Concurrent...\n");
+    ASSERT(RunCallers(kConcurrentCallers, kTestIterations * 10));
+
     delete proxy;
 }
 
@@ -270,6 +432,38 @@ void TestLpec::TestSubscriptions()
     delete proxy; // automatically unsubscribes
 }
 
+void TestLpec::TestLargeBinary(TUint aCallers)
+{
+    /* Many large requests in flight at once, each from its own thread, so that writes may
+       block until the device reads more while responses are still arriving */
+    Print("  Concurrent large binary...\n");
+    InitialisationParams* initParams = iEnv.InitParams();
+    initParams->SetCpSyncInvocationsOnCallerThread(true);
+    ASSERT(RunCallers(aCallers, kTestIterations, kLargeBinaryBytes));
+    initParams->SetCpSyncInvocationsOnCallerThread(false);
+}
+
+TBool TestLpec::RunCallers(TUint aCallers, TUint aCallsPerCaller, TUint aBinaryBytes)
+{
+    Semaphore done("LPCD", 0);
+    std::vector<Caller*> callers;
+    for (TUint i=0; i<aCallers; i++) {
+        callers.push_back(new Caller(*iCpDevice, i+1, aCallsPerCaller, done, aBinaryBytes));
+    }
+    for (TUint i=0; i<aCallers; i++) {
+        callers[i]->Start();
+    }
+    TBool succeeded = true;
+    for (TUint i=0; i<aCallers; i++) {
+        done.Wait();
+    }
+    for (TUint i=0; i<aCallers; i++) {
+        succeeded = succeeded && callers[i]->Succeeded();
+        delete callers[i];
+    }
+    return succeeded;
+}
+
 void TestLpec::DeviceReady()
 {
     ASSERT(iCpDeviceLpec->Device() != NULL);
@@ -284,6 +478,29 @@ void TestLpec::UpdatesComplete()
 
 
 
+static TIpAddress CurrentSubnetAddress()
+{
+    NetworkAdapter* nif = UpnpLibrary::CurrentSubnetAdapter("TestDvLpec");
+    ASSERT(nif != NULL);
+    const TIpAddress address = nif->Address();
+    nif->RemoveRef("TestDvLpec");
+    return address;
+}
+
+static TestLpec* CreateClient(CpStack& aCpStack, const Endpoint& aLocation, const Brx& aLpecName)
+{
+    Semaphore sem("SEM1", 0);
+    TestLpec* cpDevice = new TestLpec(aCpStack, aLocation, aLpecName, sem);
+    sem.Wait(5*1000); // allow up to 5 seconds to connect to LPEC server and receive initial ALIVE message
+    return cpDevice;
+}
+
+static TestLpec* CreateClient(CpStack& aCpStack, DvStack& aDvStack, DeviceLpec& aDevice)
+{
+    const TUint port = aDvStack.Env().InitParams()->DvLpecServerPort();
+    return CreateClient(aCpStack, Endpoint(port, CurrentSubnetAddress()), aDevice.LpecDeviceName());
+}
+
 void TestDvLpec(CpStack& aCpStack, DvStack& aDvStack)
 {
     Print("TestDvLpec - starting\n");
@@ -292,20 +509,66 @@ void TestDvLpec(CpStack& aCpStack, DvStack& aDvStack)
     Debug::SetSeverity(Debug::kSeverityError);
 
 
-    Semaphore* sem = new Semaphore("SEM1", 0);
     DeviceLpec* device = new DeviceLpec(aDvStack);
-    NetworkAdapter* nif = UpnpLibrary::CurrentSubnetAdapter("TestDvLpec");
-    ASSERT(nif != NULL);
-    const TUint port = aDvStack.Env().InitParams()->DvLpecServerPort();
-    Endpoint location(port, nif->Address());
-    nif->RemoveRef("TestDvLpec");
-    TestLpec* cpDevice = new TestLpec(aCpStack, location, device->LpecDeviceName(), *sem);
-    sem->Wait(5*1000); // allow up to 5 seconds to connect to LPEC server and receive initial ALIVE message
-    delete sem;
+    TestLpec* cpDevice = CreateClient(aCpStack, aDvStack, *device);
     cpDevice->TestActions();
     //cpDevice->TestSubscriptions();
     delete cpDevice;
+
+    // a client which pipelines as many requests as there are callers
+    static const TUint kLargeBinaryCallers = 128;
+    InitialisationParams* initParams = aDvStack.Env().InitParams();
+    const TUint maxPipelined = initParams->CpLpecMaxPipelinedRequests();
+    initParams->SetCpLpecMaxPipelinedRequests(kLargeBinaryCallers);
+    cpDevice = CreateClient(aCpStack, aDvStack, *device);
+    cpDevice->TestLargeBinary(kLargeBinaryCallers);
+    delete cpDevice;
     delete device;
 
+    // ...and keeps reading responses while it writes requests to a device answering a backlog of them
+    static const TUint kStalledBacklog = 48; // must be less than the number of callers
+    SocketTcpServer* server = new SocketTcpServer(aDvStack.Env(), "LPSS", 0, CurrentSubnetAddress());
+    server->Add("LPSE", new StalledEchoSession(kStalledBacklog));
+    cpDevice = CreateClient(aCpStack, Endpoint(server->Port(), server->Interface()), StalledEchoSession::kLpecName);
+    cpDevice->TestLargeBinary(kLargeBinaryCallers);
+    delete cpDevice;
+    delete server;
+    initParams->SetCpLpecMaxPipelinedRequests(maxPipelined);
+
     Print("TestDvLpec - completed\n");
 }
+
+void TestDvLpecBenchmark(CpStack& aCpStack, DvStack& aDvStack)
+{
+    static const TUint kCallsPerCaller = 2000;
+    static const TUint kMaxPipelined[] = { 1, 8 }; // 1 => each request waits for the previous response
+    static const TUint kCallers[] = { 1, 2, 4, 8 };
+    Print("TestDvLpec - benchmark (%u calls per caller)\n", kCallsPerCaller);
+
+    Debug::SetLevel(Debug::kLpec);
+    Debug::SetSeverity(Debug::kSeverityError);
+
+    DeviceLpec* device = new DeviceLpec(aDvStack);
+    Net::InitialisationParams* initParams = aCpStack.Env().InitParams();
+    const TUint defaultMaxPipelined = initParams->CpLpecMaxPipelinedRequests();
+    for (TUint i=0; i<sizeof(kMaxPipelined)/sizeof(kMaxPipelined[0]); i++) {
+        initParams->SetCpLpecMaxPipelinedRequests(kMaxPipelined[i]);
+        TestLpec* cpDevice = CreateClient(aCpStack, aDvStack, *device);
+        for (TUint j=0; j<sizeof(kCallers)/sizeof(kCallers[0]); j++) {
+            const TUint start = Os::TimeInMs(aCpStack.Env().OsCtx());
+            ASSERT(cpDevice->RunCallers(kCallers[j], kCallsPerCaller));
+            TUint elapsedMs = Os::TimeInMs(aCpStack.Env().OsCtx()) - start;
+            if (elapsedMs == 0) {
+                elapsedMs = 1;
+            }
+            const TUint calls = kCallers[j] * kCallsPerCaller;
+            Print("  max pipelined %u, %u caller(s): %6u ms, %6u calls/s\n",
+                  kMaxPipelined[i], kCallers[j], elapsedMs, (TUint)(((TUint64)calls * 1000) / elapsedMs));
+        }
+        delete cpDevice;
+    }
+    initParams->SetCpLpecMaxPipelinedRequests(defaultMaxPipelined);
+    delete device;
+
+    Print("TestDvLpec - benchmark completed\n");
+}
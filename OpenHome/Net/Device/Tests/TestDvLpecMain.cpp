@@ -10,10 +10,21 @@ using namespace OpenHome;
 using namespace OpenHome::Net;
 
 extern void TestDvLpec(CpStack& aCpStack, DvStack& aDvStack);
+extern void TestDvLpecBenchmark(CpStack& aCpStack, DvStack& aDvStack);
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionBool benchmark("-b", "--benchmark", "Measure action throughput with concurrent callers");
+    parser.AddOption(&benchmark);
+    if (!parser.Parse(aArgc, aArgv) || parser.HelpDisplayed()) {
+        return;
+    }
+    if (benchmark.Value()) {
+        aInitParams->SetNumActionInvokerThreads(8);
+    }
     aInitParams->SetDvNumLpecThreads(2);
+    aInitParams->SetNumInvocations(160); // TestDvLpec keeps many large binary invocations in flight
     aInitParams->SetDvLpecServerPort(2324);
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
@@ -24,7 +35,12 @@ void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], N
     lib->StartCombined(subnet, cpStack, dvStack);
     dvStack->Start();
 
-    TestDvLpec(*cpStack, *dvStack);
+    if (benchmark.Value()) {
+        TestDvLpecBenchmark(*cpStack, *dvStack);
+    }
+    else {
+        TestDvLpec(*cpStack, *dvStack);
+    }
 
     delete lib;
 }
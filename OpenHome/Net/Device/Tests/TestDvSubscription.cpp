@@ -8,9 +8,13 @@
 #include <OpenHome/Net/Core/OhNet.h>
 #include <OpenHome/Net/Core/CpDevice.h>
 #include <OpenHome/Net/Core/CpDeviceUpnp.h>
+#include <OpenHome/Net/Core/CpStack.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/CpiStack.h>
+#include <OpenHome/Net/Private/CpiSubscription.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <vector>
 
@@ -27,6 +31,7 @@ public:
     CpDevices(Semaphore& aAddedSem, const Brx& aTargetUdn);
     ~CpDevices();
     void Test();
+    void TestRenewals(CpStack& aCpStack);
     void Added(CpDevice& aDevice);
     void Removed(CpDevice& aDevice);
 private:
@@ -169,6 +174,115 @@ void CpDevices::Test()
     delete proxy; // automatically unsubscribes
 }
 
+static void WaitForRenewals(CpStack& aCpStack, const CpiRenewalScheduler::Stats& aBefore,
+                            TUint aRenewals, TUint aResubscribes, CpiRenewalScheduler::Stats& aAfter)
+{
+    static const TUint kTimeoutMs = 20 * 1000;
+    CpiRenewalScheduler& renewals = aCpStack.SubscriptionManager().Renewals();
+    const TUint start = Time::Now(aCpStack.Env());
+    for (;;) {
+        renewals.GetStats(aAfter);
+        if (aAfter.iRenewals - aBefore.iRenewals >= aRenewals &&
+            aAfter.iResubscribes - aBefore.iResubscribes >= aResubscribes) {
+            break;
+        }
+        ASSERT(Time::Now(aCpStack.Env()) - start < kTimeoutMs);
+        Thread::Sleep(50);
+    }
+}
+
+void CpDevices::TestRenewals(CpStack& aCpStack)
+{
+    static const TUint kNumProxies = 8;
+
+    ASSERT(iList.size() == 1);
+    Environment& env = aCpStack.Env();
+    InitialisationParams* initParams = env.InitParams();
+    const TUint durationSecs = initParams->SubscriptionDurationSecs();
+    TUint maxRequests, idleTimeoutMs;
+    initParams->GetDvUpnpKeepAlive(maxRequests, idleTimeoutMs);
+    CpiRenewalScheduler& renewals = aCpStack.SubscriptionManager().Renewals();
+    CpiRenewalScheduler::Stats before;
+    CpiRenewalScheduler::Stats after;
+
+    // each subscription will be renewed after 1-1.5s, by which time the device will have
+    // closed the connection used for the previous renewals
+    initParams->SetSubscriptionDuration(2);
+    initParams->SetDvUpnpKeepAlive(100, 200);
+    Functor functor = MakeFunctor(*this, &CpDevices::UpdatesComplete);
+    std::vector<CpProxyOpenhomeOrgTestBasic1*> proxies;
+    for (TUint i=0; i<kNumProxies; i++) {
+        CpProxyOpenhomeOrgTestBasic1* proxy = new CpProxyOpenhomeOrgTestBasic1(*(iList[0]));
+        proxy->SetPropertyInitialEvent(functor);
+        proxy->Subscribe();
+        proxies.push_back(proxy);
+    }
+    for (TUint i=0; i<kNumProxies; i++) {
+        iUpdatesComplete.Wait();
+    }
+
+    Print("  Renewal after device closed connection...\n");
+    renewals.GetStats(before);
+    WaitForRenewals(aCpStack, before, 3 * kNumProxies, 0, after);
+    Print("    %u renewals, %u connections, %u retries\n", after.iRenewals - before.iRenewals,
+          after.iConnections - before.iConnections, after.iRetries - before.iRetries);
+    ASSERT(after.iFailures == before.iFailures);
+    ASSERT(after.iRetries > before.iRetries);
+
+    Print("  Renewals share a connection...\n");
+    initParams->SetDvUpnpKeepAlive(100, 10 * 1000);
+    // let the device close any connection opened with the old idle timeout then wait for
+    // a round of renewals to open one which it'll keep alive
+    Thread::Sleep(500);
+    renewals.GetStats(before);
+    WaitForRenewals(aCpStack, before, kNumProxies, 0, after);
+    renewals.GetStats(before);
+    WaitForRenewals(aCpStack, before, 3 * kNumProxies, 0, after);
+    Print("    %u renewals in %u batches, %u connections, peak concurrency %u\n",
+          after.iRenewals - before.iRenewals, after.iBatches - before.iBatches,
+          after.iConnections - before.iConnections, after.iPeakConcurrent);
+    ASSERT(after.iConnections == before.iConnections);
+    ASSERT(after.iRetries == before.iRetries);
+    ASSERT(after.iFailures == before.iFailures);
+    ASSERT(after.iPeakConcurrent == 1);
+
+    Print("  Resubscribe all...\n");
+    // renew once more with the normal duration so that no renewal is due while resubscribing
+    initParams->SetSubscriptionDuration(durationSecs);
+    renewals.GetStats(before);
+    Thread::Sleep(2500);
+    renewals.GetStats(after);
+    while (after.iInProgress > 0) {
+        Thread::Sleep(50);
+        renewals.GetStats(after);
+    }
+    ASSERT(after.iRenewals - before.iRenewals >= kNumProxies);
+    renewals.GetStats(before);
+    aCpStack.SubscriptionManager().RenewAll();
+    WaitForRenewals(aCpStack, before, 0, kNumProxies, after);
+    Print("    %u resubscribes in %u batches\n", after.iResubscribes - before.iResubscribes,
+          after.iBatches - before.iBatches);
+    ASSERT(after.iResubscribes - before.iResubscribes == kNumProxies);
+    // all subscriptions are to the same device so are resubscribed together
+    ASSERT(after.iBatches - before.iBatches == 1);
+
+    // check that resubscribed subscriptions still deliver updates
+    CpProxyOpenhomeOrgTestBasic1* proxy = proxies[0];
+    proxy->SetPropertyChanged(functor);
+    TUint valUint;
+    proxy->SyncGetUint(valUint);
+    proxy->SyncSetUint(valUint + 1);
+    iUpdatesComplete.Wait();
+    TUint propUint;
+    proxy->PropertyVarUint(propUint);
+    ASSERT(propUint == valUint + 1);
+
+    for (TUint i=0; i<kNumProxies; i++) {
+        delete proxies[i];
+    }
+    initParams->SetDvUpnpKeepAlive(maxRequests, idleTimeoutMs);
+}
+
 void CpDevices::Added(CpDevice& aDevice)
 {
     iLock.Wait();
@@ -214,6 +328,7 @@ void TestDvSubscription(CpStack& aCpStack, DvStack& aDvStack)
         Print(" loop #%u\n", i);
         deviceList->Test();
     }
+    deviceList->TestRenewals(aCpStack);
     delete list;
     delete deviceList;
     delete device;
@@ -0,0 +1,633 @@
+#include <OpenHome/Private/TestFramework.h>
+#include "TestBasicDv.h"
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Net/Core/DvDevice.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Private/DviStack.h>
+#include <OpenHome/Net/Private/DviServerWebSocket.h>
+#include <OpenHome/Net/Private/XmlParser.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace TestDvWebSocket {
+
+class DeviceWs
+{
+public:
+    DeviceWs(DvStack& aDvStack);
+    ~DeviceWs();
+    const Brx& Udn() const;
+private:
+    DvDeviceStandard* iDevice;
+    ProviderTestBasic* iTestBasic;
+};
+
+// Minimal WebSocket (RFC 6455) client, optionally using permessage-deflate
+class WsClient : private INonCopyable
+{
+    static const TUint kMaxMessageBytes = 16 * 1024;
+public:
+    WsClient(Environment& aEnv, const Endpoint& aEndpoint);
+    ~WsClient();
+    TBool Handshake(const TChar* aExtensions, Bwx& aExtensionsResponse);
+    void Write(const Brx& aMessage, TUint aMaxFrameBytes = 0); // 0 => don't fragment
+    Brn ReadMethod(const Brx& aMethod); // skips any messages which don't match aMethod
+    void WriteCompressed(const Brx& aPayload); // sends aPayload as is, marked as compressed
+    TUint ReadCloseCode(); // skips any messages before the server's close frame
+private:
+    void WriteFrame(TByte aByte0, const Brx& aPayload);
+    Brn Read();
+private:
+    Environment& iEnv;
+    SocketTcpClient iSocket;
+    Srs<1024> iReadBuffer;
+    ReaderUntilS<kMaxMessageBytes> iReaderUntil;
+    Sws<kMaxMessageBytes> iWriteBuffer;
+    WsDeflate* iDeflate;
+    Bwh iCompressed;
+    Bwh iDecompressed;
+    Bwh iFrame;
+};
+
+class SuiteUnmask : public Suite
+{
+public:
+    SuiteUnmask(Environment& aEnv);
+    void Test();
+private:
+    static void UnmaskBytewise(TByte* aData, TUint aBytes, const TByte* aMask, TUint aMaskOffset);
+    void Benchmark(TUint aBytes, TUint aIterations);
+private:
+    Environment& iEnv;
+};
+
+class SuiteHandshake : public Suite
+{
+public:
+    SuiteHandshake(DvStack& aDvStack, const Endpoint& aEndpoint);
+    void Test();
+private:
+    void Check(const TChar* aOffer, const TChar* aExpected);
+private:
+    DvStack& iDvStack;
+    Endpoint iEndpoint;
+};
+
+class SuiteSubscribe : public Suite
+{
+public:
+    SuiteSubscribe(DvStack& aDvStack, const Endpoint& aEndpoint, const Brx& aUdn);
+    void Test();
+private:
+    void Subscribe(const TChar* aOffer);
+    void CorruptMessage();
+private:
+    DvStack& iDvStack;
+    Endpoint iEndpoint;
+    Brh iUdn;
+};
+
+class SuiteInvoke : public Suite
+{
+public:
+    SuiteInvoke(DvStack& aDvStack, const Endpoint& aEndpoint, const Brx& aUdn);
+    void Test();
+private:
+    void Invoke(const TChar* aOffer);
+    void WriteInvoke(WsClient& aClient, TUint aId, const TChar* aService, const TChar* aAction, const TChar* aArgs);
+    Brn ReadInvokeResponse(WsClient& aClient, TUint aId, const Brx& aMethod);
+private:
+    DvStack& iDvStack;
+    Endpoint iEndpoint;
+    Brh iUdn;
+};
+
+} // namespace TestDvWebSocket
+} // namespace OpenHome
+
+using namespace OpenHome::TestDvWebSocket;
+
+
+// DeviceWs
+
+static Bwh gDeviceName("device");
+
+DeviceWs::DeviceWs(DvStack& aDvStack)
+{
+    RandomiseUdn(aDvStack.Env(), gDeviceName);
+    iDevice = new DvDeviceStandard(aDvStack, gDeviceName);
+    iDevice->SetAttribute("Upnp.Domain", "openhome.org");
+    iDevice->SetAttribute("Upnp.Type", "Test");
+    iDevice->SetAttribute("Upnp.Version", "1");
+    iDevice->SetAttribute("Upnp.FriendlyName", "ohNetTestDevice");
+    iDevice->SetAttribute("Upnp.Manufacturer", "None");
+    iDevice->SetAttribute("Upnp.ModelName", "ohNet test device");
+    iTestBasic = new ProviderTestBasic(*iDevice);
+    iDevice->SetEnabled();
+}
+
+DeviceWs::~DeviceWs()
+{
+    delete iTestBasic;
+    delete iDevice;
+}
+
+const Brx& DeviceWs::Udn() const
+{
+    return gDeviceName;
+}
+
+
+// WsClient
+
+WsClient::WsClient(Environment& aEnv, const Endpoint& aEndpoint)
+    : iEnv(aEnv)
+    , iReadBuffer(iSocket)
+    , iReaderUntil(iReadBuffer)
+    , iWriteBuffer(iSocket)
+    , iDeflate(NULL)
+{
+    iSocket.Open(aEnv);
+    iSocket.Connect(aEndpoint, 5000);
+}
+
+WsClient::~WsClient()
+{
+    delete iDeflate;
+    iSocket.Close();
+}
+
+TBool WsClient::Handshake(const TChar* aExtensions, Bwx& aExtensionsResponse)
+{
+    iWriteBuffer.Write(Brn("GET / HTTP/1.1\r\n"));
+    iWriteBuffer.Write(Brn("Upgrade: websocket\r\n"));
+    iWriteBuffer.Write(Brn("Connection: Upgrade\r\n"));
+    iWriteBuffer.Write(Brn("Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"));
+    iWriteBuffer.Write(Brn("Sec-WebSocket-Protocol: upnpevent.openhome.org\r\n"));
+    iWriteBuffer.Write(Brn("Sec-WebSocket-Version: 13\r\n"));
+    if (aExtensions != NULL) {
+        iWriteBuffer.Write(Brn("Sec-WebSocket-Extensions: "));
+        iWriteBuffer.Write(Brn(aExtensions));
+        iWriteBuffer.Write(Brn("\r\n"));
+    }
+    iWriteBuffer.Write(Brn("\r\n"));
+    iWriteBuffer.WriteFlush();
+
+    aExtensionsResponse.SetBytes(0);
+    Brn status = Ascii::Trim(iReaderUntil.ReadUntil('\n'));
+    const TBool switched = (status == Brn("HTTP/1.1 101 Switching Protocols"));
+    TBool accepted = false;
+    for (;;) {
+        Brn line = Ascii::Trim(iReaderUntil.ReadUntil('\n'));
+        if (line.Bytes() == 0) {
+            break;
+        }
+        Parser parser(line);
+        Brn field = parser.Next(':');
+        Brn value = Ascii::Trim(parser.Remaining());
+        if (Ascii::CaseInsensitiveEquals(field, WebSocket::kHeaderExtensions)) {
+            aExtensionsResponse.Replace(value);
+        }
+        else if (Ascii::CaseInsensitiveEquals(field, Brn("Sec-WebSocket-Accept"))) {
+            accepted = (value == Brn("s3pPLMBiTxaQ9kYGzzhZRbK+xOo="));
+        }
+    }
+    if (aExtensionsResponse.Bytes() > 0) {
+        // the server compresses messages for us; we compress ours for it
+        Parser parser(aExtensionsResponse);
+        TBool clientNoContextTakeover = false;
+        while (!parser.Finished()) {
+            if (parser.Next(';') == WebSocket::kParamClientNoContextTakeover) {
+                clientNoContextTakeover = true;
+            }
+        }
+        iDeflate = new WsDeflate(iEnv, WsDeflate::kMaxWindowBits, !clientNoContextTakeover, true);
+    }
+    return (switched && accepted);
+}
+
+void WsClient::Write(const Brx& aMessage, TUint aMaxFrameBytes)
+{
+    Brn payload(aMessage);
+    TByte rsv = 0;
+    if (iDeflate != NULL) {
+        iDeflate->Compress(aMessage, iCompressed);
+        payload.Set(iCompressed);
+        rsv = 0x40; // first frame only
+    }
+    if (aMaxFrameBytes == 0) {
+        aMaxFrameBytes = payload.Bytes();
+    }
+    TByte opcode = 0x01; // text
+    for (;;) {
+        const TUint bytes = (payload.Bytes() < aMaxFrameBytes? payload.Bytes() : aMaxFrameBytes);
+        const TBool final = (bytes == payload.Bytes());
+        WriteFrame((TByte)((final? 0x80 : 0) | rsv | opcode), payload.Split(0, bytes));
+        if (final) {
+            break;
+        }
+        payload.Set(payload.Split(bytes));
+        rsv = 0;
+        opcode = 0x00; // continuation
+    }
+    iWriteBuffer.WriteFlush();
+}
+
+void WsClient::WriteFrame(TByte aByte0, const Brx& aPayload)
+{
+    iWriteBuffer.Write(aByte0);
+    const TUint bytes = aPayload.Bytes();
+    if (bytes < 126) {
+        iWriteBuffer.Write((TByte)(0x80 | bytes));
+    }
+    else {
+        ASSERT(bytes < (1<<16));
+        iWriteBuffer.Write((TByte)(0x80 | 126));
+        iWriteBuffer.Write((TByte)(bytes >> 8));
+        iWriteBuffer.Write((TByte)(bytes & 0xff));
+    }
+    static const TByte kMask[] = { 0x12, 0x34, 0x56, 0x78 };
+    iWriteBuffer.Write(Brn(kMask, sizeof(kMask)));
+    iFrame.Grow(bytes);
+    iFrame.Replace(aPayload);
+    WsProtocol80::Unmask(const_cast<TByte*>(iFrame.Ptr()), bytes, kMask, 0);
+    iWriteBuffer.Write(iFrame);
+}
+
+Brn WsClient::ReadMethod(const Brx& aMethod)
+{
+    for (;;) {
+        Brn msg = Read();
+        if (XmlParserBasic::Find(WebSocket::kTagMethod, msg) == aMethod) {
+            return msg;
+        }
+    }
+}
+
+void WsClient::WriteCompressed(const Brx& aPayload)
+{
+    WriteFrame(0x80 | 0x40 | 0x01, aPayload);
+    iWriteBuffer.WriteFlush();
+}
+
+TUint WsClient::ReadCloseCode()
+{
+    for (;;) {
+        Brn ctrl = iReaderUntil.ReadProtocol(2);
+        const TByte opcode = ctrl[0] & 0x0f;
+        TUint bytes = ctrl[1] & 0x7f;
+        if (bytes == 126) {
+            Brn len = iReaderUntil.ReadProtocol(2);
+            bytes = (len[0] << 8) | len[1];
+        }
+        Brn payload = iReaderUntil.ReadProtocol(bytes);
+        if (opcode == 0x08) {
+            TEST(payload.Bytes() == 2);
+            return (payload[0] << 8) | payload[1];
+        }
+    }
+}
+
+Brn WsClient::Read()
+{
+    Brn ctrl = iReaderUntil.ReadProtocol(2);
+    const TByte byte0 = ctrl[0];
+    const TByte byte1 = ctrl[1];
+    TEST((byte0 & 0x80) != 0); // server doesn't fragment
+    TEST((byte0 & 0x0f) == 0x01);
+    TEST(((byte0 & 0x40) != 0) == (iDeflate != NULL));
+    TEST((byte1 & 0x80) == 0);
+    TUint bytes = byte1 & 0x7f;
+    if (bytes == 126) {
+        Brn len = iReaderUntil.ReadProtocol(2);
+        bytes = (len[0] << 8) | len[1];
+    }
+    else {
+        TEST(bytes < 126);
+    }
+    Brn payload = iReaderUntil.ReadProtocol(bytes);
+    if (iDeflate == NULL) {
+        return payload;
+    }
+    TEST(iDeflate->Decompress(payload, iDecompressed, kMaxMessageBytes));
+    return Brn(iDecompressed);
+}
+
+
+// SuiteHandshake
+
+SuiteHandshake::SuiteHandshake(DvStack& aDvStack, const Endpoint& aEndpoint)
+    : Suite("permessage-deflate negotiation")
+    , iDvStack(aDvStack)
+    , iEndpoint(aEndpoint)
+{
+}
+
+void SuiteHandshake::Test()
+{
+    Check(NULL, NULL);
+    Check("x-webkit-deflate-frame", NULL);
+    Check("permessage-deflate; unknown_param", NULL);
+    Check("permessage-deflate; server_max_window_bits=8", NULL);
+    Check("permessage-deflate", "permessage-deflate");
+    Check("permessage-deflate; client_max_window_bits", "permessage-deflate");
+    Check("permessage-deflate; client_no_context_takeover",
+          "permessage-deflate; client_no_context_takeover");
+    Check("x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=8, permessage-deflate; server_no_context_takeover; server_max_window_bits=\"10\"",
+          "permessage-deflate; server_no_context_takeover; server_max_window_bits=10");
+}
+
+void SuiteHandshake::Check(const TChar* aOffer, const TChar* aExpected)
+{
+    WsClient client(iDvStack.Env(), iEndpoint);
+    Bws<256> extensions;
+    TEST(client.Handshake(aOffer, extensions));
+    if (aExpected == NULL || !WsDeflate::Supported()) {
+        TEST(extensions.Bytes() == 0);
+    }
+    else {
+        TEST(extensions == Brn(aExpected));
+    }
+}
+
+
+// SuiteSubscribe
+
+SuiteSubscribe::SuiteSubscribe(DvStack& aDvStack, const Endpoint& aEndpoint, const Brx& aUdn)
+    : Suite("Subscribe with and without permessage-deflate")
+    , iDvStack(aDvStack)
+    , iEndpoint(aEndpoint)
+    , iUdn(aUdn)
+{
+}
+
+void SuiteSubscribe::Test()
+{
+    Subscribe(NULL);
+    Subscribe("permessage-deflate");
+    Subscribe("permessage-deflate; server_no_context_takeover; client_no_context_takeover; server_max_window_bits=9");
+    CorruptMessage();
+}
+
+void SuiteSubscribe::Subscribe(const TChar* aOffer)
+{
+    WsClient client(iDvStack.Env(), iEndpoint);
+    Bws<256> extensions;
+    TEST(client.Handshake(aOffer, extensions));
+    TEST((extensions.Bytes() > 0) == (aOffer != NULL && WsDeflate::Supported()));
+
+    Bws<512> req;
+    req.Append("<?xml version=\"1.0\"?><ROOT><METHOD>Subscribe</METHOD><UDN>");
+    req.Append(iUdn);
+    req.Append("</UDN><SERVICE>openhome.org-TestBasic-1</SERVICE><NT>upnp:event</NT><TIMEOUT>30</TIMEOUT></ROOT>");
+    client.Write(req);
+    Brn resp = client.ReadMethod(WebSocket::kMethodSubscriptionSid);
+    TEST(XmlParserBasic::Find(WebSocket::kTagUdn, resp) == iUdn);
+    Brh sid(XmlParserBasic::Find(WebSocket::kTagSid, resp));
+    TEST(sid.Bytes() > 0);
+
+    // initial event, covering all state variables
+    resp = client.ReadMethod(WebSocket::kMethodPropertyUpdate);
+    TEST(XmlParserBasic::Find(WebSocket::kTagSid, resp) == sid);
+    TEST(XmlParserBasic::Find(WebSocket::kTagSeq, resp) == Brn("0"));
+
+    // repeat a request to check compression contexts are maintained (or reset) correctly
+    for (TUint i=0; i<3; i++) {
+        req.Replace("<?xml version=\"1.0\"?><ROOT><METHOD>Renew</METHOD><SID>");
+        req.Append(sid);
+        req.Append("</SID><TIMEOUT>30</TIMEOUT></ROOT>");
+        client.Write(req);
+        resp = client.ReadMethod(WebSocket::kMethodSubscriptionRenewed);
+        TEST(XmlParserBasic::Find(WebSocket::kTagSid, resp) == sid);
+    }
+
+    // requests larger than the session's read buffer, optionally fragmented
+    Bwh large(20 * 1024);
+    large.Replace("<?xml version=\"1.0\"?><ROOT><METHOD>Renew</METHOD><SID>");
+    large.Append(sid);
+    large.Append("</SID><TIMEOUT>30</TIMEOUT><PADDING>");
+    while (large.Bytes() < large.MaxBytes() - 64) {
+        large.Append("Lorem ipsum dolor sit amet, ");
+    }
+    large.Append("</PADDING></ROOT>");
+    const TUint kFrameBytes[] = { 0, 1000, 4096, 7 * 1024 };
+    for (TUint i=0; i<sizeof(kFrameBytes)/sizeof(kFrameBytes[0]); i++) {
+        client.Write(large, kFrameBytes[i]);
+        resp = client.ReadMethod(WebSocket::kMethodSubscriptionRenewed);
+        TEST(XmlParserBasic::Find(WebSocket::kTagSid, resp) == sid);
+    }
+
+    req.Replace("<?xml version=\"1.0\"?><ROOT><METHOD>Unsubscribe</METHOD><SID>");
+    req.Append(sid);
+    req.Append("</SID></ROOT>");
+    client.Write(req);
+}
+
+void SuiteSubscribe::CorruptMessage()
+{
+    if (!WsDeflate::Supported()) {
+        return;
+    }
+    WsClient client(iDvStack.Env(), iEndpoint);
+    Bws<256> extensions;
+    TEST(client.Handshake("permessage-deflate", extensions));
+    static const TByte kCorrupt[] = { 0xff, 0xff, 0xff, 0xff }; // deflate block type 3 is reserved
+    client.WriteCompressed(Brn(kCorrupt, sizeof(kCorrupt)));
+    TEST(client.ReadCloseCode() == 1002); // protocol error
+}
+
+
+// SuiteInvoke
+
+SuiteInvoke::SuiteInvoke(DvStack& aDvStack, const Endpoint& aEndpoint, const Brx& aUdn)
+    : Suite("Invoke actions over a WebSocket")
+    , iDvStack(aDvStack)
+    , iEndpoint(aEndpoint)
+    , iUdn(aUdn)
+{
+}
+
+void SuiteInvoke::Test()
+{
+    Invoke(NULL);
+    Invoke("permessage-deflate");
+}
+
+void SuiteInvoke::Invoke(const TChar* aOffer)
+{
+    WsClient client(iDvStack.Env(), iEndpoint);
+    Bws<256> extensions;
+    TEST(client.Handshake(aOffer, extensions));
+
+    // pipeline several requests before reading any responses
+    const TUint kPipelined = 10;
+    for (TUint i=0; i<kPipelined; i++) {
+        Bws<64> args("<Value>");
+        (void)Ascii::AppendDec(args, i);
+        args.Append("</Value>");
+        WriteInvoke(client, i, "openhome.org-TestBasic-1", "Increment", args.PtrZ());
+    }
+    for (TUint i=0; i<kPipelined; i++) {
+        Brn resp = ReadInvokeResponse(client, i, WebSocket::kMethodInvokeCompleted);
+        Brn args = XmlParserBasic::Find(WebSocket::kTagArgs, resp);
+        TEST(Ascii::Uint(XmlParserBasic::Find("Result", args)) == i+1);
+    }
+
+    WriteInvoke(client, 100, "openhome.org-TestBasic-1", "Decrement", "<Value>-3</Value>");
+    Brn resp = ReadInvokeResponse(client, 100, WebSocket::kMethodInvokeCompleted);
+    TEST(Ascii::Int(XmlParserBasic::Find("Result", resp)) == -4);
+
+    WriteInvoke(client, 101, "openhome.org-TestBasic-1", "Toggle", "<Value>true</Value>");
+    resp = ReadInvokeResponse(client, 101, WebSocket::kMethodInvokeCompleted);
+    TEST(XmlParserBasic::Find("Result", resp) == Brn("0"));
+
+    // strings are xml escaped in both directions
+    WriteInvoke(client, 102, "openhome.org-TestBasic-1", "EchoString", "<Value>a &lt;b&gt; &amp; c</Value>");
+    resp = ReadInvokeResponse(client, 102, WebSocket::kMethodInvokeCompleted);
+    TEST(XmlParserBasic::Find("Result", resp) == Brn("a &lt;b&gt; &amp; c"));
+
+    // binary is base64 encoded in both directions
+    WriteInvoke(client, 103, "openhome.org-TestBasic-1", "EchoBinary", "<Value>AAECAwQF</Value>");
+    resp = ReadInvokeResponse(client, 103, WebSocket::kMethodInvokeCompleted);
+    TEST(XmlParserBasic::Find("Result", resp) == Brn("AAECAwQF"));
+
+    WriteInvoke(client, 104, "openhome.org-TestBasic-1", "NoSuchAction", "");
+    resp = ReadInvokeResponse(client, 104, WebSocket::kMethodInvokeFailed);
+    TEST(XmlParserBasic::Find(WebSocket::kTagCode, resp) == Brn("501"));
+
+    WriteInvoke(client, 105, "openhome.org-TestBasic-1", "Increment", "<Value>abc</Value>");
+    resp = ReadInvokeResponse(client, 105, WebSocket::kMethodInvokeFailed);
+    TEST(XmlParserBasic::Find(WebSocket::kTagCode, resp) == Brn("402"));
+
+    WriteInvoke(client, 106, "openhome.org-TestBasic-1", "Increment", "");
+    resp = ReadInvokeResponse(client, 106, WebSocket::kMethodInvokeFailed);
+    TEST(XmlParserBasic::Find(WebSocket::kTagCode, resp) == Brn("402"));
+
+    WriteInvoke(client, 107, "openhome.org-NoSuchService-1", "Increment", "<Value>1</Value>");
+    resp = ReadInvokeResponse(client, 107, WebSocket::kMethodInvokeFailed);
+    TEST(XmlParserBasic::Find(WebSocket::kTagCode, resp) == Brn("404"));
+
+    // failures don't close the session
+    WriteInvoke(client, 108, "openhome.org-TestBasic-1", "Increment", "<Value>41</Value>");
+    resp = ReadInvokeResponse(client, 108, WebSocket::kMethodInvokeCompleted);
+    TEST(Ascii::Uint(XmlParserBasic::Find("Result", resp)) == 42);
+}
+
+void SuiteInvoke::WriteInvoke(WsClient& aClient, TUint aId, const TChar* aService, const TChar* aAction, const TChar* aArgs)
+{
+    Bws<512> req("<?xml version=\"1.0\"?><ROOT><METHOD>Invoke</METHOD><ID>");
+    (void)Ascii::AppendDec(req, aId);
+    req.Append("</ID><UDN>");
+    req.Append(iUdn);
+    req.Append("</UDN><SERVICE>");
+    req.Append(aService);
+    req.Append("</SERVICE><ACTION>");
+    req.Append(aAction);
+    req.Append("</ACTION><ARGS>");
+    req.Append(aArgs);
+    req.Append("</ARGS></ROOT>");
+    aClient.Write(req);
+}
+
+Brn SuiteInvoke::ReadInvokeResponse(WsClient& aClient, TUint aId, const Brx& aMethod)
+{
+    Brn resp = aClient.ReadMethod(aMethod);
+    TEST(Ascii::Uint(XmlParserBasic::Find(WebSocket::kTagId, resp)) == aId);
+    return resp;
+}
+
+
+// SuiteUnmask
+
+SuiteUnmask::SuiteUnmask(Environment& aEnv)
+    : Suite("Frame unmasking")
+    , iEnv(aEnv)
+{
+}
+
+void SuiteUnmask::Test()
+{
+    static const TByte kMask[] = { 0xa5, 0x3c, 0x0f, 0x96 };
+    Bwh data(1024 + 16);
+    Bwh expected(1024 + 16);
+    for (TUint bytes=0; bytes<=1024; bytes = (bytes < 40? bytes+1 : bytes*2)) {
+        for (TUint align=0; align<8; align++) {
+            for (TUint offset=0; offset<4; offset++) {
+                data.SetBytes(0);
+                for (TUint i=0; i<align+bytes; i++) {
+                    data.Append((TByte)(i * 7));
+                }
+                expected.Replace(data);
+                TByte* ptr = const_cast<TByte*>(data.Ptr()) + align;
+                WsProtocol80::Unmask(ptr, bytes, kMask, offset);
+                UnmaskBytewise(const_cast<TByte*>(expected.Ptr()) + align, bytes, kMask, offset);
+                TEST(data == expected);
+                // masking is its own inverse
+                WsProtocol80::Unmask(ptr, bytes, kMask, offset);
+                UnmaskBytewise(const_cast<TByte*>(expected.Ptr()) + align, bytes, kMask, offset);
+                TEST(data == expected);
+            }
+        }
+    }
+
+    Benchmark(125, 20000);
+    Benchmark(4 * 1024, 2000);
+    Benchmark(64 * 1024, 200);
+}
+
+void SuiteUnmask::UnmaskBytewise(TByte* aData, TUint aBytes, const TByte* aMask, TUint aMaskOffset)
+{ // static
+    for (TUint i=0; i<aBytes; i++) {
+        aData[i] ^= aMask[(i + aMaskOffset) % 4];
+    }
+}
+
+void SuiteUnmask::Benchmark(TUint aBytes, TUint aIterations)
+{
+    static const TByte kMask[] = { 0x01, 0x02, 0x03, 0x04 };
+    Bwh buf(aBytes);
+    buf.SetBytes(aBytes);
+    TByte* ptr = const_cast<TByte*>(buf.Ptr());
+    OsContext* ctx = iEnv.OsCtx();
+    TUint64 start = Os::TimeInUs(ctx);
+    for (TUint i=0; i<aIterations; i++) {
+        UnmaskBytewise(ptr, aBytes, kMask, i & 3);
+    }
+    const TUint64 bytewiseUs = Os::TimeInUs(ctx) - start;
+    start = Os::TimeInUs(ctx);
+    for (TUint i=0; i<aIterations; i++) {
+        WsProtocol80::Unmask(ptr, aBytes, kMask, i & 3);
+    }
+    const TUint64 wordUs = Os::TimeInUs(ctx) - start;
+    const TUint64 totalKb = ((TUint64)aBytes * aIterations) / 1024;
+    Print("\n    %6u byte frames: bytewise %6llu us, word-wide %6llu us (%llu kB each)",
+          aBytes, bytewiseUs, wordUs, totalKb);
+}
+
+
+void TestDvWebSocket(DvStack& aDvStack)
+{
+    DeviceWs* device = new DeviceWs(aDvStack);
+    NetworkAdapter* nif = UpnpLibrary::CurrentSubnetAdapter("TestDvWebSocket");
+    ASSERT(nif != NULL);
+    Endpoint endpoint(aDvStack.Env().InitParams()->DvWebSocketPort(), nif->Address());
+    nif->RemoveRef("TestDvWebSocket");
+
+    Runner runner("WebSocket server\n");
+    runner.Add(new SuiteUnmask(aDvStack.Env()));
+    runner.Add(new SuiteHandshake(aDvStack, endpoint));
+    runner.Add(new SuiteSubscribe(aDvStack, endpoint, device->Udn()));
+    runner.Add(new SuiteInvoke(aDvStack, endpoint, device->Udn()));
+    runner.Run();
+
+    delete device;
+}
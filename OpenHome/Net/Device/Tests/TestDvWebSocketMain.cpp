@@ -0,0 +1,39 @@
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+#include <OpenHome/Net/Core/OhNet.h>
+#include <OpenHome/Net/Private/DviStack.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::Net;
+
+extern void TestDvWebSocket(DvStack& aDvStack);
+
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
+{
+    OptionParser parser;
+    OptionBool loopback("-l", "--loopback", "Use the loopback adapter only");
+    parser.AddOption(&loopback);
+    if (!parser.Parse(aArgc, aArgv) || parser.HelpDisplayed()) {
+        return;
+    }
+    if (loopback.Value()) {
+        aInitParams->SetUseLoopbackNetworkAdapter();
+    }
+    aInitParams->SetDvNumWebSocketThreads(2);
+    aInitParams->SetDvWebSocketPort(54321);
+    aInitParams->SetDvWebSocketDeflate(true);
+    Library* lib = new Library(aInitParams);
+    std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
+    TIpAddress subnet = (*subnetList)[0]->Subnet();
+    Library::DestroySubnetList(subnetList);
+    lib->SetCurrentSubnet(subnet);
+    DvStack* dvStack = lib->StartDv();
+    dvStack->Start();
+
+    TestDvWebSocket(*dvStack);
+
+    delete lib;
+}
@@ -10,6 +10,12 @@
 #include <OpenHome/Net/Core/CpDevice.h>
 #include <OpenHome/Net/Core/CpDeviceUpnp.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Uri.h>
+#include <OpenHome/Private/File.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Net/Private/CpiDeviceUpnp.h>
 
 #include <stdlib.h>
 #include <time.h>
@@ -36,6 +42,8 @@ class DvDevices
 public:
     DvDevices(DvStack& aDvStack);
     ~DvDevices();
+    const Brx& RootServicePath() const;
+    void RenameEmbeddedDevice(const TChar* aName);
 private:
     DviDeviceStandard* iDevices[2];
 };
@@ -92,6 +100,16 @@ DvDevices::~DvDevices()
     iDevices[1]->Destroy();
 }
 
+const Brx& DvDevices::RootServicePath() const
+{
+    return iDevices[0]->Service(0).ServiceType().PathUpnp();
+}
+
+void DvDevices::RenameEmbeddedDevice(const TChar* aName)
+{
+    iDevices[0]->Device(0).SetAttribute("Upnp.FriendlyName", aName);
+}
+
 
 
 class CpDevices
@@ -103,6 +121,7 @@ public:
     void Validate(std::vector<const char*>& aExpectedUdns);
     void Added(CpDevice& aDevice);
     void Removed(CpDevice& aDevice);
+    void GetLocation(const Brx& aUdn, Brh& aLocation);
 private:
     Mutex iLock;
     std::vector<CpDevice*> iList;
@@ -216,6 +235,325 @@ void CpDevices::Removed(CpDevice& aDevice)
 }
 
 
+void CpDevices::GetLocation(const Brx& aUdn, Brh& aLocation)
+{
+    AutoMutex _(iLock);
+    for (TUint i=0; i<iList.size(); i++) {
+        if (iList[i]->Udn() == aUdn) {
+            TEST(iList[i]->GetAttribute("Upnp.Location", aLocation));
+            return;
+        }
+    }
+    ASSERTS();
+}
+
+
+class HeaderETag : public HttpHeader
+{
+public:
+    const Brx& ETag() const { return iETag; }
+private:
+    TBool Recognise(const Brx& aHeader) { return Ascii::CaseInsensitiveEquals(aHeader, Http::kHeaderETag); }
+    void Process(const Brx& aValue) { iETag.Replace(aValue); SetReceived(); }
+private:
+    Bws<64> iETag;
+};
+
+static TUint FetchDescription(Environment& aEnv, const Uri& aUri, const Brx& aIfNoneMatch, Bwx& aETag)
+{
+    SocketTcpClient socket;
+    socket.Open(aEnv);
+    AutoSocket _(socket);
+    socket.Connect(Endpoint(aUri.Port(), aUri.Host()), 5 * 1000);
+
+    Sws<1024> writeBuffer(socket);
+    WriterHttpRequest writerRequest(writeBuffer);
+    writerRequest.WriteMethod(Http::kMethodGet, aUri.PathAndQuery(), Http::eHttp11);
+    Http::WriteHeaderHostAndPort(writerRequest, aUri.Host(), aUri.Port());
+    if (aIfNoneMatch.Bytes() > 0) {
+        writerRequest.WriteHeader(Http::kHeaderIfNoneMatch, aIfNoneMatch);
+    }
+    Http::WriteHeaderConnectionClose(writerRequest);
+    writerRequest.WriteFlush();
+
+    Srs<1024> readBuffer(socket);
+    ReaderUntilS<4096> readerUntil(readBuffer);
+    ReaderHttpResponse readerResponse(aEnv, readerUntil);
+    HeaderETag headerETag;
+    readerResponse.AddHeader(headerETag);
+    readerResponse.Read(5 * 1000);
+    aETag.Replace(headerETag.ETag());
+    return readerResponse.Status().Code();
+}
+
+static void TestConditionalFetch(Environment& aEnv, DvDevices& aDevices, const Brx& aLocation)
+{
+    Bws<64> etag;
+    Bws<64> etag2;
+    Uri deviceXml(aLocation);
+    TEST(FetchDescription(aEnv, deviceXml, Brx::Empty(), etag) == HttpStatus::kOk.Code());
+    TEST(etag.Bytes() > 0);
+    TEST(FetchDescription(aEnv, deviceXml, etag, etag2) == HttpStatus::kNotModified.Code());
+    TEST(etag2 == etag);
+    Bws<80> weakList("\"nomatch\", W/");
+    weakList.Append(etag);
+    TEST(FetchDescription(aEnv, deviceXml, weakList, etag2) == HttpStatus::kNotModified.Code());
+
+    static const Brn kDeviceXml("device.xml");
+    Bws<Uri::kMaxUriBytes> serviceUri(aLocation.Split(0, aLocation.Bytes() - kDeviceXml.Bytes()));
+    serviceUri.Append(aDevices.RootServicePath());
+    serviceUri.Append("/service.xml");
+    Uri serviceXml(serviceUri);
+    Bws<64> serviceETag;
+    TEST(FetchDescription(aEnv, serviceXml, Brx::Empty(), serviceETag) == HttpStatus::kOk.Code());
+    TEST(serviceETag != etag);
+    TEST(FetchDescription(aEnv, serviceXml, serviceETag, etag2) == HttpStatus::kNotModified.Code());
+
+    // root device's description embeds its children's so must change when they do
+    aDevices.RenameEmbeddedDevice("renamed");
+    TEST(FetchDescription(aEnv, deviceXml, etag, etag2) == HttpStatus::kOk.Code());
+    TEST(etag2 != etag);
+
+    // entity tags depend only on content so restoring the old name restores the old tag
+    aDevices.RenameEmbeddedDevice((const TChar*)gNameDevice1_1.Ptr());
+    TEST(FetchDescription(aEnv, deviceXml, etag, etag2) == HttpStatus::kNotModified.Code());
+}
+
+
+// device description cache
+
+class NullDescriptionObserver : public ICpiDeviceDescriptionObserver
+{
+private: // from ICpiDeviceDescriptionObserver
+    void DescriptionFetched(CpiDeviceDescription* /*aDescription*/) { ASSERTS(); }
+};
+
+class CachedDevice
+{
+public:
+    const TChar* iUdn;
+    TUint64 iSeenSecs;
+};
+
+static const TChar* kCacheFile = "TestDviDeviceList.cache";
+static const Brn kCacheLocation("http://127.0.0.1:1234/device.xml");
+static const TUint kCacheConfigId = 3;
+
+static void CacheDescriptionXml(const Brx& aUdn, Bwx& aXml)
+{
+    aXml.Replace("<root><device><UDN>uuid:");
+    aXml.Append(aUdn);
+    aXml.Append("</UDN></device></root>");
+}
+
+static void WriteCacheFile(const TChar* aFilename, const CachedDevice* aDevices, TUint aCount,
+                           const Brx& aLocation, const TIpAddress& aInterface)
+{
+    WriterBwh writer(1024);
+    WriterBinary writerBinary(writer);
+    writerBinary.Write(Brn("OHDC"));
+    writerBinary.WriteUint8(1);
+    writerBinary.WriteUint32Be(aCount);
+    for (TUint i=0; i<aCount; i++) {
+        Brn udn(aDevices[i].iUdn);
+        Bws<128> xml;
+        CacheDescriptionXml(udn, xml);
+        writerBinary.WriteUint64Be(aDevices[i].iSeenSecs);
+        writerBinary.WriteUint16Be(udn.Bytes());
+        writerBinary.Write(udn);
+        writerBinary.WriteUint16Be(aLocation.Bytes());
+        writerBinary.Write(aLocation);
+        writerBinary.WriteUint32Be(kCacheConfigId);
+        writerBinary.WriteUint8(aInterface.iFamily);
+        writerBinary.WriteUint32Be(aInterface.iV4);
+        writerBinary.Write(Brn(aInterface.iV6, sizeof(aInterface.iV6)));
+        writerBinary.WriteUint32Be(xml.Bytes());
+        writerBinary.Write(xml);
+    }
+    IFile* f = IFile::Open(aFilename, eFileWriteOnly);
+    f->Write(writer.Buffer());
+    delete f;
+}
+
+static void WriteCacheFile(const CachedDevice* aDevices, TUint aCount)
+{
+    WriteCacheFile(kCacheFile, aDevices, aCount, kCacheLocation, kIpAddressV4AllAdapters);
+}
+
+static TBool IsRestored(CpiDeviceDescriptionCache& aCache, const TChar* aUdn)
+{
+    std::vector<CpiDeviceDescriptionCache::RestoredDevice> restored;
+    aCache.GetRestored(kIpAddressV4AllAdapters, restored);
+    TBool found = false;
+    for (TUint i=0; i<(TUint)restored.size(); i++) {
+        if (restored[i].iUdn == Brn(aUdn)) {
+            Bws<128> xml;
+            CacheDescriptionXml(restored[i].iUdn, xml);
+            TEST(restored[i].iLocation == kCacheLocation);
+            TEST(restored[i].iConfigId == kCacheConfigId);
+            TEST(restored[i].iDescription->Xml() == xml);
+            found = true;
+        }
+        restored[i].iDescription->RemoveRef();
+    }
+    return found;
+}
+
+static TBool FileExists(const TChar* aFilename)
+{
+    try {
+        delete IFile::Open(aFilename, eFileReadOnly);
+        return true;
+    }
+    catch (FileOpenError&) {
+        return false;
+    }
+}
+
+static void TestDescriptionCache(Environment& aEnv)
+{
+    InitialisationParams* initParams = aEnv.InitParams();
+    FileSystemAnsi fileSystem;
+    try {
+        fileSystem.Unlink(kCacheFile);
+    }
+    catch (UnlinkFailed&) {
+    }
+    NullDescriptionObserver observer;
+    TBool fetch;
+
+    Print("  Save then restore a fetched description\n");
+    initParams->SetCpUpnpDeviceCache(kCacheFile, 60 * 60);
+    CpiDeviceDescriptionCache* cache = new CpiDeviceDescriptionCache(aEnv);
+    TEST(!IsRestored(*cache, "cache1"));
+    TEST(cache->Claim(Brn("cache1"), kCacheLocation, kCacheConfigId, kIpAddressV4AllAdapters, observer, fetch) == NULL);
+    TEST(fetch);
+    Bws<128> xml;
+    CacheDescriptionXml(Brn("cache1"), xml);
+    Brh xmlh(xml);
+    cache->Store(Brn("cache1"), kCacheLocation, kCacheConfigId, xmlh)->RemoveRef();
+    delete cache;
+    TEST(FileExists(kCacheFile));
+    Bws<64> tmpFile(kCacheFile);
+    tmpFile.Append(".tmp");
+    TEST(!FileExists(tmpFile.PtrZ()));
+    cache = new CpiDeviceDescriptionCache(aEnv);
+    TEST(IsRestored(*cache, "cache1"));
+    CpiDeviceDescription* description = cache->Claim(Brn("cache1"), kCacheLocation, kCacheConfigId, kIpAddressV4AllAdapters, observer, fetch);
+    TEST(description != NULL);
+    TEST(!fetch);
+    description->RemoveRef();
+    delete cache;
+
+    Print("  Discard descriptions older than the max age\n");
+    const TUint64 now = (TUint64)time(NULL);
+    const CachedDevice aged[] = { { "cache1", now - 10 }, { "cache2", now - 1000 } };
+    WriteCacheFile(aged, 2);
+    initParams->SetCpUpnpDeviceCache(kCacheFile, 100);
+    cache = new CpiDeviceDescriptionCache(aEnv);
+    TEST(IsRestored(*cache, "cache1"));
+    TEST(!IsRestored(*cache, "cache2"));
+    delete cache;
+
+    Print("  Devices seen while running are kept, others age out\n");
+    const CachedDevice restored[] = { { "cache1", now - 90 }, { "cache2", now - 90 }, { "cache3", now - 90 } };
+    WriteCacheFile(restored, 3);
+    cache = new CpiDeviceDescriptionCache(aEnv);
+    TEST(IsRestored(*cache, "cache1"));
+    TEST(IsRestored(*cache, "cache2"));
+    TEST(IsRestored(*cache, "cache3"));
+    cache->DeviceSeen(Brn("cache1"), true);    // confirmed by an alive
+    description = cache->Claim(Brn("cache2"), kCacheLocation, kCacheConfigId, kIpAddressV4AllAdapters, observer, fetch);
+    TEST(description != NULL);                  // reused by another device list
+    description->RemoveRef();
+    delete cache;
+    initParams->SetCpUpnpDeviceCache(kCacheFile, 60);
+    cache = new CpiDeviceDescriptionCache(aEnv);
+    TEST(IsRestored(*cache, "cache1"));
+    TEST(IsRestored(*cache, "cache2"));
+    TEST(!IsRestored(*cache, "cache3"));
+    delete cache;
+
+    initParams->SetCpUpnpDeviceCache("", 0);
+    fileSystem.Unlink(kCacheFile);
+}
+
+static const TChar* kRestoredCacheFile = "TestDviDeviceList.restored";
+static const Brn kRestoredUdn("restored1");
+
+void TestDviDeviceListRestoreDevices(InitialisationParams& aInitParams, const TIpAddress& aInterface)
+{
+    // nothing listens on port 1 so the restored device can't be contacted
+    Bws<Endpoint::kMaxEndpointBytes + 32> location("http://");
+    Endpoint(1, aInterface).AppendEndpoint(location);
+    location.Append("/device.xml");
+    const CachedDevice device = { (const TChar*)kRestoredUdn.Ptr(), (TUint64)time(NULL) };
+    WriteCacheFile(kRestoredCacheFile, &device, 1, location, aInterface);
+    aInitParams.SetCpUpnpDeviceCache(kRestoredCacheFile, 60 * 60);
+}
+
+void TestDviDeviceListRestoreDevicesComplete()
+{
+    FileSystemAnsi fileSystem;
+    fileSystem.Unlink(kRestoredCacheFile);
+}
+
+class RestoredDevices : private INonCopyable
+{
+public:
+    RestoredDevices();
+    void Added(CpDevice& aDevice);
+    void Removed(CpDevice& aDevice);
+public:
+    Semaphore iAdded;
+    Semaphore iRemoved;
+    TBool iTentative;
+};
+
+RestoredDevices::RestoredDevices()
+    : iAdded("RDAS", 0)
+    , iRemoved("RDRS", 0)
+    , iTentative(false)
+{
+}
+
+void RestoredDevices::Added(CpDevice& aDevice)
+{
+    if (aDevice.Udn() == kRestoredUdn) {
+        Brh tentative;
+        iTentative = (aDevice.GetAttribute("Upnp.Tentative", tentative) && tentative == Brn("true"));
+        iAdded.Signal();
+    }
+}
+
+void RestoredDevices::Removed(CpDevice& aDevice)
+{
+    if (aDevice.Udn() == kRestoredUdn) {
+        iRemoved.Signal();
+    }
+}
+
+static void TestRestoredDevices(CpStack& aCpStack)
+{
+    /* TestDviDeviceListRestoreDevices() saved a device at an address that can't be contacted.
+       It should be reported straight away then removed as soon as a probe of its location
+       fails, well before a refresh would complete. */
+    RestoredDevices restored;
+    FunctorCpDevice added = MakeFunctorCpDevice(restored, &RestoredDevices::Added);
+    FunctorCpDevice removed = MakeFunctorCpDevice(restored, &RestoredDevices::Removed);
+    CpDeviceListUpnpUuid* list = new CpDeviceListUpnpUuid(aCpStack, kRestoredUdn, added, removed);
+    const TUint refreshMs = 4 * (aCpStack.Env().InitParams()->MsearchTimeSecs() * 1000 + 500);
+    try {
+        restored.iAdded.Wait(refreshMs / 2);
+        TEST(restored.iTentative);
+        restored.iRemoved.Wait(refreshMs / 2);
+    }
+    catch (Timeout&) {
+        TEST(0);
+    }
+    delete list;
+}
+
 
 void TestDviDeviceList(CpStack& aCpStack, DvStack& aDvStack)
 {
@@ -244,9 +582,14 @@ void TestDviDeviceList(CpStack& aCpStack, DvStack& aDvStack)
     udns.push_back((const char*)gNameDevice2.Ptr());
     deviceList->Validate(udns);
     udns.clear();
+    Brh location;
+    deviceList->GetLocation(gNameDevice1, location);
     delete list;
     deviceList->Clear();
 
+    Print("Conditional fetch of device and service descriptions\n");
+    TestConditionalFetch(aDvStack.Env(), *devices, location);
+
     Print("Count devices implementing service2\n");
     serviceType.Set("service2");
     list = new CpDeviceListUpnpServiceType(aCpStack, domainName, serviceType, ver, added, removed);
@@ -259,6 +602,12 @@ void TestDviDeviceList(CpStack& aCpStack, DvStack& aDvStack)
     delete deviceList;
     delete devices;
 
+    Print("Save and restore device descriptions\n");
+    TestDescriptionCache(aDvStack.Env());
+
+    Print("Remove restored devices that can't be contacted\n");
+    TestRestoredDevices(aCpStack);
+
     Print("TestDviDeviceList - completed\n");
     initParams->SetMsearchTime(oldMsearchTime);
 }
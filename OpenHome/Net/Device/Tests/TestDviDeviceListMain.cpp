@@ -10,6 +10,8 @@ using namespace OpenHome;
 using namespace OpenHome::Net;
 
 extern void TestDviDeviceList(CpStack& aCpStack, DvStack& aDvStack);
+extern void TestDviDeviceListRestoreDevices(InitialisationParams& aInitParams, const TIpAddress& aInterface);
+extern void TestDviDeviceListRestoreDevicesComplete();
 
 void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
@@ -26,6 +28,7 @@ void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::Init
     Library* lib = new Library(aInitParams);
     std::vector<NetworkAdapter*>* subnetList = lib->CreateSubnetList();
     TIpAddress subnet = (*subnetList)[0]->Subnet();
+    TestDviDeviceListRestoreDevices(*aInitParams, (*subnetList)[0]->Address());
     Library::DestroySubnetList(subnetList);
     CpStack* cpStack = NULL;
     DvStack* dvStack = NULL;
@@ -35,4 +38,5 @@ void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::Init
     TestDviDeviceList(*cpStack, *dvStack);
 
     delete lib;
+    TestDviDeviceListRestoreDevicesComplete();
 }
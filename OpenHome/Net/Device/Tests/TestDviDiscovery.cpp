@@ -5,6 +5,8 @@
 #include <OpenHome/Net/Private/Discovery.h>
 #include <OpenHome/Net/Private/DviDevice.h>
 #include <OpenHome/Net/Private/DviService.h>
+#include <OpenHome/Net/Private/DviProtocolUpnp.h>
+#include <OpenHome/Net/Private/DviSsdpNotifier.h>
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Net/Private/DviStack.h>
 #include <OpenHome/Private/NetworkAdapterList.h>
@@ -22,21 +24,22 @@ static const TChar* kAdapterCookie = "TestDviDiscovery";
 class CpListenerBasic : public ISsdpNotifyHandler
 {
 public:
-    CpListenerBasic();
+    CpListenerBasic(const Brx& aUdn);
     TUint TotalAlives() const { return iTotalAlives; }
     TUint TotalByeByes() const { return iTotalByeByes; }
 private:
     TBool LogAdd(const Brx& aUuid);
     TBool LogRemove(const Brx& aUuid);
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyRootByeBye(const Brx& aUuid);
     void SsdpNotifyUuidByeBye(const Brx& aUuid);
     void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
     void SsdpNotifyServiceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
 private:
+    Brn iUdn;
     Mutex iLock;
     TUint iTotalAlives;
     TUint iTotalByeByes;
@@ -60,10 +63,10 @@ public:
 private:
     TBool LogUdn(const Brx& aUuid, const Brx& aLocation);
     TChar* CreateTypeString(const Brx& aDomain, const Brx& aType, TUint aVersion);
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyRootByeBye(const Brx& aUuid);
     void SsdpNotifyUuidByeBye(const Brx& aUuid);
     void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
@@ -99,6 +102,70 @@ private:
     Semaphore iSem;
 };
 
+class BatchAnnouncementData : public IUpnpAnnouncementData
+{
+public:
+    BatchAnnouncementData(DvStack& aDvStack, const Brx& aUdn, TUint aServiceCount);
+    ~BatchAnnouncementData();
+private: // from IUpnpAnnouncementData
+    const Brx& Udn() const;
+    TBool IsRoot() const;
+    TUint ServiceCount() const;
+    DviService& Service(TUint aIndex);
+    Brn Domain() const;
+    Brn Type() const;
+    TUint Version() const;
+private:
+    Brn iUdn;
+    std::vector<DviService*> iServices;
+};
+
+class SuiteBatch : public Suite, private ISsdpNotifyListener
+{
+public:
+    static Bwh gNameDevice1;
+public:
+    SuiteBatch(DvStack& aDvStack);
+    ~SuiteBatch();
+    void Test();
+private:
+    DeviceAnnouncement* AnnounceAlive(BatchAnnouncementData& aData, TUint aBatchSize);
+private: // from ISsdpNotifyListener
+    void NotifySchedulerComplete(SsdpNotifierScheduler* aScheduler);
+private:
+    static const TUint kServiceCount = 12;
+    static const TUint kMsgIntervalMs = 20;
+    DvStack& iDvStack;
+    Semaphore iSem;
+};
+
+class SuiteFilter : public Suite
+{
+public:
+    static Bwh gNameDevice1;
+public:
+    SuiteFilter(DvStack& aDvStack);
+    void Test();
+    static void Send(SocketUdp& aSocket, const TChar* aNt, const TChar* aUsn, TBool aLocation);
+private:
+    static const TUint kMaxWaitMs = 5000;
+    DvStack& iDvStack;
+};
+
+class SuiteIndex : public Suite
+{
+public:
+    static Bwh gNameDevice1;
+public:
+    SuiteIndex(DvStack& aDvStack);
+    void Test();
+private:
+    void WaitForAlives(CpListenerBasic& aListener, TUint aCount);
+private:
+    static const TUint kMaxWaitMs = 5000;
+    DvStack& iDvStack;
+};
+
 class SuiteMsearch : public Suite, private INonCopyable
 {
 public:
@@ -126,6 +193,9 @@ private:
 };
 
 Bwh SuiteAlive::gNameDevice1("TestAlive");
+Bwh SuiteBatch::gNameDevice1("TestBatch");
+Bwh SuiteFilter::gNameDevice1("TestFilter");
+Bwh SuiteIndex::gNameDevice1("TestIndex");
 Bwh SuiteMsearch::gNameDevice1("TestDevice1");
 Bwh SuiteMsearch::gNameDevice2("TestDevice2");
 Bwh SuiteMsearch::gNameDevice2Embedded1("TestDevice2.Embedded.1");
@@ -158,8 +228,9 @@ static void AddService(DviDevice* aDevice, DviService* aService)
 
 // CpListenerBasic
 
-CpListenerBasic::CpListenerBasic()
-    : iLock("LBMX")
+CpListenerBasic::CpListenerBasic(const Brx& aUdn)
+    : iUdn(aUdn)
+    , iLock("LBMX")
     , iTotalAlives(0)
     , iTotalByeByes(0)
 {
@@ -167,7 +238,7 @@ CpListenerBasic::CpListenerBasic()
 
 TBool CpListenerBasic::LogAdd(const Brx& aUuid)
 {
-    if (aUuid == SuiteAlive::gNameDevice1) {
+    if (aUuid == iUdn) {
         iLock.Wait();
         iTotalAlives++;
         iLock.Signal();
@@ -178,7 +249,7 @@ TBool CpListenerBasic::LogAdd(const Brx& aUuid)
 
 TBool CpListenerBasic::LogRemove(const Brx& aUuid)
 {
-    if (aUuid == SuiteAlive::gNameDevice1) {
+    if (aUuid == iUdn) {
         iLock.Wait();
         iTotalByeByes++;
         iLock.Signal();
@@ -187,22 +258,22 @@ TBool CpListenerBasic::LogRemove(const Brx& aUuid)
     return false;
 }
 
-void CpListenerBasic::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& /*aLocation*/, TUint /*aMaxAge*/)
+void CpListenerBasic::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& /*aLocation*/, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     LogAdd(aUuid);
 }
 
-void CpListenerBasic::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& /*aLocation*/, TUint /*aMaxAge*/)
+void CpListenerBasic::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& /*aLocation*/, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     LogAdd(aUuid);
 }
 
-void CpListenerBasic::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/, const Brx& /*aLocation*/, TUint /*aMaxAge*/)
+void CpListenerBasic::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/, const Brx& /*aLocation*/, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     LogAdd(aUuid);
 }
 
-void CpListenerBasic::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/, const Brx& /*aLocation*/, TUint /*aMaxAge*/)
+void CpListenerBasic::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& /*aDomain*/, const Brx& /*aType*/, TUint /*aVersion*/, const Brx& /*aLocation*/, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     LogAdd(aUuid);
 }
@@ -249,7 +320,7 @@ void SuiteAlive::Test()
 {
     Environment& env = iDvStack.Env();
     Blocker* blocker = new Blocker(env);
-    CpListenerBasic* listener = new CpListenerBasic;
+    CpListenerBasic* listener = new CpListenerBasic(gNameDevice1);
     NetworkAdapter* nif = env.NetworkAdapterList().CurrentAdapter(kAdapterCookie).Ptr();
     SsdpListenerMulticast* listenerMulticast = new SsdpListenerMulticast(env, nif->Address());
     nif->RemoveRef(kAdapterCookie);
@@ -310,6 +381,276 @@ void SuiteAlive::Disabled()
 }
 
 
+// BatchAnnouncementData
+
+BatchAnnouncementData::BatchAnnouncementData(DvStack& aDvStack, const Brx& aUdn, TUint aServiceCount)
+    : iUdn(aUdn)
+{
+    for (TUint i=0; i<aServiceCount; i++) {
+        iServices.push_back(new DviService(aDvStack, "a.b.c", "batch", i+1));
+    }
+}
+
+BatchAnnouncementData::~BatchAnnouncementData()
+{
+    for (TUint i=0; i<iServices.size(); i++) {
+        iServices[i]->RemoveRef();
+    }
+}
+
+const Brx& BatchAnnouncementData::Udn() const
+{
+    return iUdn;
+}
+
+TBool BatchAnnouncementData::IsRoot() const
+{
+    return true;
+}
+
+TUint BatchAnnouncementData::ServiceCount() const
+{
+    return (TUint)iServices.size();
+}
+
+DviService& BatchAnnouncementData::Service(TUint aIndex)
+{
+    return *iServices[aIndex];
+}
+
+Brn BatchAnnouncementData::Domain() const
+{
+    return Brn("a.b.c");
+}
+
+Brn BatchAnnouncementData::Type() const
+{
+    return Brn("batch");
+}
+
+TUint BatchAnnouncementData::Version() const
+{
+    return 1;
+}
+
+
+// SuiteBatch
+
+SuiteBatch::SuiteBatch(DvStack& aDvStack)
+    : Suite("Batched announcements")
+    , iDvStack(aDvStack)
+    , iSem("SBAT", 0)
+{
+    RandomiseUdn(iDvStack.Env(), gNameDevice1);
+}
+
+SuiteBatch::~SuiteBatch()
+{
+}
+
+void SuiteBatch::Test()
+{
+    Environment& env = iDvStack.Env();
+    Blocker* blocker = new Blocker(env);
+    CpListenerBasic* listener = new CpListenerBasic(gNameDevice1);
+    NetworkAdapter* nif = env.NetworkAdapterList().CurrentAdapter(kAdapterCookie).Ptr();
+    SsdpListenerMulticast* listenerMulticast = new SsdpListenerMulticast(env, nif->Address());
+    nif->RemoveRef(kAdapterCookie);
+    TInt listenerId = listenerMulticast->AddNotifyHandler(listener);
+    listenerMulticast->Start();
+    BatchAnnouncementData data(iDvStack, gNameDevice1, kServiceCount);
+    const TUint msgCount = 3 + kServiceCount;
+
+    // one message per timer callback
+    DeviceAnnouncement* single = AnnounceAlive(data, 1);
+    blocker->Wait(1);
+    TEST(single->TimerCallbacks() == msgCount);
+    TEST(single->SendCalls() == msgCount);
+    const TUint alives = listener->TotalAlives();
+    TEST(alives > 0);
+    TEST(alives % msgCount == 0);
+
+    // same alive cycle, sent as two batches
+    const TUint batchSize = (msgCount + 1) / 2;
+    DeviceAnnouncement* batched = AnnounceAlive(data, batchSize);
+    blocker->Wait(1);
+    TEST(batched->TimerCallbacks() == 2);
+    TEST(batched->SendCalls() == 2);
+    TEST(listener->TotalAlives() > alives);
+    TEST((listener->TotalAlives() - alives) % msgCount == 0);
+    Print("Alive cycle of %u messages: %u timer callbacks / %u sends unbatched, %u / %u with batches of %u\n",
+          msgCount, single->TimerCallbacks(), single->SendCalls(),
+          batched->TimerCallbacks(), batched->SendCalls(), batchSize);
+
+    delete batched;
+    delete single;
+    listenerMulticast->RemoveNotifyHandler(listenerId);
+    delete listenerMulticast;
+    delete listener;
+    delete blocker;
+}
+
+DeviceAnnouncement* SuiteBatch::AnnounceAlive(BatchAnnouncementData& aData, TUint aBatchSize)
+{
+    DeviceAnnouncement* announcement = new DeviceAnnouncement(iDvStack, *this, kMsgIntervalMs, kMsgIntervalMs, aBatchSize);
+    NetworkAdapter* nif = iDvStack.Env().NetworkAdapterList().CurrentAdapter(kAdapterCookie).Ptr();
+    announcement->SetUdn(gNameDevice1);
+    announcement->StartAlive(aData, nif->Address(), Brn("http://127.0.0.1/TestBatch/device.xml"), 1);
+    nif->RemoveRef(kAdapterCookie);
+    iSem.Wait();
+    return announcement;
+}
+
+void SuiteBatch::NotifySchedulerComplete(SsdpNotifierScheduler* /*aScheduler*/)
+{
+    iSem.Signal();
+}
+
+
+// SuiteFilter
+
+SuiteFilter::SuiteFilter(DvStack& aDvStack)
+    : Suite("Rejection of malformed / inconsistent notifications")
+    , iDvStack(aDvStack)
+{
+    RandomiseUdn(iDvStack.Env(), gNameDevice1);
+}
+
+void SuiteFilter::Test()
+{
+    Environment& env = iDvStack.Env();
+    CpListenerBasic* listener = new CpListenerBasic(gNameDevice1);
+    NetworkAdapter* nif = env.NetworkAdapterList().CurrentAdapter(kAdapterCookie).Ptr();
+    SsdpListenerMulticast* listenerMulticast = new SsdpListenerMulticast(env, nif->Address());
+    SocketUdp socket(env, 0, nif->Address());
+    socket.SetMulticastIf(nif->Address());
+    nif->RemoveRef(kAdapterCookie);
+    TInt listenerId = listenerMulticast->AddNotifyHandler(listener);
+    listenerMulticast->Start();
+
+    Bws<128> uuid("uuid:");
+    uuid.Append(gNameDevice1);
+    Bws<128> usnRoot(uuid);
+    usnRoot.Append("::upnp:rootdevice");
+    const TChar* uuidStr = (const TChar*)uuid.PtrZ();
+
+    // none of these should reach the handler
+    socket.Send(Brn("not an ssdp message"), Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress));
+    Send(socket, uuidStr, "uuid:mismatched", true);
+    Send(socket, "upnp:rootdevice", uuidStr, true);
+    Send(socket, "upnp:rootdevice", (const TChar*)usnRoot.PtrZ(), false);
+    // ...and this should
+    Send(socket, "upnp:rootdevice", (const TChar*)usnRoot.PtrZ(), true);
+
+    for (TUint i=0; i<kMaxWaitMs/10 && listener->TotalAlives() == 0; i++) {
+        Thread::Sleep(10);
+    }
+    TEST(listener->TotalAlives() == 1);
+    TEST(listenerMulticast->MessagesReceived() >= 5);
+    TEST(listenerMulticast->MessagesMalformed() >= 1);
+    TEST(listenerMulticast->MessagesRejected() >= 3);
+    Print("Received %u messages, dropped %u malformed, %u rejected\n", listenerMulticast->MessagesReceived(),
+          listenerMulticast->MessagesMalformed(), listenerMulticast->MessagesRejected());
+
+    listenerMulticast->RemoveNotifyHandler(listenerId);
+    delete listenerMulticast;
+    delete listener;
+}
+
+void SuiteFilter::Send(SocketUdp& aSocket, const TChar* aNt, const TChar* aUsn, TBool aLocation)
+{
+    Bws<512> msg("NOTIFY * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nCACHE-CONTROL: max-age=1800\r\n");
+    if (aLocation) {
+        msg.Append("LOCATION: http://127.0.0.1/TestFilter/device.xml\r\n");
+    }
+    msg.Append("SERVER: Posix/1 UPnP/1.1 TestDviDiscovery/1\r\nNT: ");
+    msg.Append(aNt);
+    msg.Append("\r\nNTS: ssdp:alive\r\nUSN: ");
+    msg.Append(aUsn);
+    msg.Append("\r\n\r\n");
+    aSocket.Send(msg, Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress));
+}
+
+
+// SuiteIndex
+
+SuiteIndex::SuiteIndex(DvStack& aDvStack)
+    : Suite("Notifications indexed by target")
+    , iDvStack(aDvStack)
+{
+    RandomiseUdn(iDvStack.Env(), gNameDevice1);
+}
+
+void SuiteIndex::Test()
+{
+    Environment& env = iDvStack.Env();
+    NetworkAdapter* nif = env.NetworkAdapterList().CurrentAdapter(kAdapterCookie).Ptr();
+    SsdpListenerMulticast* listenerMulticast = new SsdpListenerMulticast(env, nif->Address());
+    SocketUdp socket(env, 0, nif->Address());
+    socket.SetMulticastIf(nif->Address());
+    nif->RemoveRef(kAdapterCookie);
+    CpListenerBasic all(gNameDevice1);
+    CpListenerBasic root(gNameDevice1);
+    CpListenerBasic uuid(gNameDevice1);
+    CpListenerBasic otherUuid(gNameDevice1);
+    CpListenerBasic serviceType(gNameDevice1);
+    CpListenerBasic otherServiceType(gNameDevice1);
+    std::vector<TInt> ids;
+    ids.push_back(listenerMulticast->AddNotifyHandler(&all));
+    ids.push_back(listenerMulticast->AddNotifyHandler(&root, eSsdpRoot));
+    ids.push_back(listenerMulticast->AddNotifyHandler(&uuid, eSsdpUuid, gNameDevice1));
+    ids.push_back(listenerMulticast->AddNotifyHandler(&otherUuid, eSsdpUuid, Brn("NotTestIndex")));
+    ids.push_back(listenerMulticast->AddNotifyHandler(&serviceType, eSsdpServiceType, Brn("openhome.org"), Brn("Index")));
+    ids.push_back(listenerMulticast->AddNotifyHandler(&otherServiceType, eSsdpServiceType, Brn("openhome.org"), Brn("NotIndex")));
+    listenerMulticast->Start();
+
+    Bws<128> nt("uuid:");
+    nt.Append(gNameDevice1);
+    Bws<128> usn(nt);
+    usn.Append("::upnp:rootdevice");
+    SuiteFilter::Send(socket, "upnp:rootdevice", (const TChar*)usn.PtrZ(), true);
+    WaitForAlives(all, 1);
+    TEST(root.TotalAlives() == 1);
+    TEST(uuid.TotalAlives() == 0);
+
+    SuiteFilter::Send(socket, (const TChar*)nt.PtrZ(), (const TChar*)nt.PtrZ(), true);
+    WaitForAlives(all, 2);
+    TEST(uuid.TotalAlives() == 1);
+    TEST(otherUuid.TotalAlives() == 0);
+
+    usn.Replace(nt);
+    usn.Append("::urn:openhome-org:service:Index:2");
+    SuiteFilter::Send(socket, "urn:openhome-org:service:Index:2", (const TChar*)usn.PtrZ(), true);
+    WaitForAlives(all, 3);
+    TEST(serviceType.TotalAlives() == 1);
+    TEST(otherServiceType.TotalAlives() == 0);
+    TEST(root.TotalAlives() == 1);
+    TEST(uuid.TotalAlives() == 1);
+
+    // a removed handler leaves others with the same key indexed
+    listenerMulticast->RemoveNotifyHandler(ids[2]);
+    ids.erase(ids.begin() + 2);
+    ids.push_back(listenerMulticast->AddNotifyHandler(&otherUuid, eSsdpUuid, gNameDevice1));
+    SuiteFilter::Send(socket, (const TChar*)nt.PtrZ(), (const TChar*)nt.PtrZ(), true);
+    WaitForAlives(all, 4);
+    TEST(uuid.TotalAlives() == 1);
+    TEST(otherUuid.TotalAlives() == 1);
+
+    for (TUint i=0; i<(TUint)ids.size(); i++) {
+        listenerMulticast->RemoveNotifyHandler(ids[i]);
+    }
+    delete listenerMulticast;
+}
+
+void SuiteIndex::WaitForAlives(CpListenerBasic& aListener, TUint aCount)
+{
+    for (TUint i=0; i<kMaxWaitMs/10 && aListener.TotalAlives() < aCount; i++) {
+        Thread::Sleep(10);
+    }
+    TEST(aListener.TotalAlives() == aCount);
+}
+
+
 // CpListenerMsearch
 
 CpListenerMsearch::CpListenerMsearch(Environment& aEnv)
@@ -425,7 +766,7 @@ TChar* CpListenerMsearch::CreateTypeString(const Brx& aDomain, const Brx& aType,
     return type;
 }
 
-void CpListenerMsearch::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint /*aMaxAge*/)
+void CpListenerMsearch::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     AutoMutex a(iLock);
     if (LogUdn(aUuid, aLocation)) {
@@ -433,13 +774,13 @@ void CpListenerMsearch::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocati
     }
 }
 
-void CpListenerMsearch::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint /*aMaxAge*/)
+void CpListenerMsearch::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     AutoMutex a(iLock);
     (void)LogUdn(aUuid, aLocation);
 }
 
-void CpListenerMsearch::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint /*aMaxAge*/)
+void CpListenerMsearch::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     AutoMutex a(iLock);
     if (LogUdn(aUuid, aLocation)) {
@@ -460,7 +801,7 @@ void CpListenerMsearch::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& a
     }
 }
 
-void CpListenerMsearch::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint /*aMaxAge*/)
+void CpListenerMsearch::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint /*aMaxAge*/, TUint /*aConfigId*/)
 {
     AutoMutex a(iLock);
     if (LogUdn(aUuid, aLocation)) {
@@ -749,6 +1090,9 @@ void TestDviDiscovery(DvStack& aDvStack)
     //Debug::SetLevel(Debug::kSsdpUnicast);
     Runner runner("SSDP discovery\n");
     runner.Add(new SuiteAlive(aDvStack));
+    runner.Add(new SuiteBatch(aDvStack));
+    runner.Add(new SuiteFilter(aDvStack));
+    runner.Add(new SuiteIndex(aDvStack));
     runner.Add(new SuiteMsearch(aDvStack));
     runner.Run();
 
@@ -89,6 +89,9 @@ DviProtocolUpnp::~DviProtocolUpnp()
     for (TUint i=0; i<adapters.size(); i++) {
         adapters[i]->RemoveRef();
     }
+    for (ServiceXmlMap::iterator it=iServiceXml.begin(); it!=iServiceXml.end(); ++it) {
+        it->second->RemoveRef();
+    }
     iDvStack.SsdpNotifierManager().Stop(iDevice.Udn());
 }
 
@@ -246,32 +249,25 @@ TInt DviProtocolUpnp::FindListenerForInterface(const TIpAddress& aAdapter)
 void DviProtocolUpnp::WriteResource(const Brx& aUriTail, const TIpAddress& aAdapter, std::vector<char*>& aLanguageList, IResourceWriter& aResourceWriter)
 {
     if (aUriTail == kDeviceXmlName) {
-        Brh xml;
-        Brn xmlBuf;
-        AutoMutex _(iLock);
-        const TInt index = FindListenerForInterface(aAdapter);
-        if (index == -1) {
-            return;
-        }
-        if (iDevice.IsRoot()) {
-            const Brx& cachedXml = iAdapters[index]->DeviceXml();
-            if (cachedXml.Bytes() > 0) {
-                xmlBuf.Set(cachedXml);
+        DviProtocolUpnpDescription* xml;
+        {
+            AutoMutex _(iLock);
+            const TInt index = FindListenerForInterface(aAdapter);
+            if (index == -1) {
+                return;
             }
-        }
-        if (xmlBuf.Bytes() == 0) {
-            GetDeviceXml(xml, aAdapter);
-            if (iDevice.IsRoot()) {
+            const TUint generation = iDevice.DescriptionGeneration();
+            xml = iAdapters[index]->DeviceXml();
+            if (xml == NULL || xml->Generation() != generation) {
+                Brh buf;
+                GetDeviceXml(buf, aAdapter);
+                xml = new DviProtocolUpnpDescription(buf, generation);
                 iAdapters[index]->SetDeviceXml(xml);
-                xmlBuf.Set(iAdapters[index]->DeviceXml());
-            }
-            else {
-                xmlBuf.Set(xml);
             }
+            xml->AddRef();
         }
-        aResourceWriter.WriteResourceBegin(xmlBuf.Bytes(), kOhNetMimeTypeXml);
-        aResourceWriter.WriteResource(xmlBuf.Ptr(), xmlBuf.Bytes());
-        aResourceWriter.WriteResourceEnd();
+        xml->Write(aResourceWriter);
+        xml->RemoveRef();
     }
     else {
         Parser parser(aUriTail);
@@ -284,21 +280,44 @@ void DviProtocolUpnp::WriteResource(const Brx& aUriTail, const TIpAddress& aAdap
             }
         }
         else if (rem == kServiceXmlName) {
-            iLock.Wait();
-            DviService* service = 0;
-            const TUint count = iDevice.ServiceCount();
-            for (TUint i=0; i<count; i++) {
-                DviService& s = iDevice.Service(i);
-                if (s.ServiceType().PathUpnp() == buf) {
-                    service = &s;
-                    break;
+            DviProtocolUpnpDescription* xml;
+            {
+                AutoMutex _(iLock);
+                DviService* service = 0;
+                const TUint count = iDevice.ServiceCount();
+                for (TUint i=0; i<count; i++) {
+                    DviService& s = iDevice.Service(i);
+                    if (s.ServiceType().PathUpnp() == buf) {
+                        service = &s;
+                        break;
+                    }
                 }
+                if (service == 0) {
+                    THROW(ReaderError);
+                }
+                // service descriptions don't vary by adapter so are cached once per device
+                const TUint generation = iDevice.DescriptionGeneration();
+                const Brx& path = service->ServiceType().PathUpnp();
+                ServiceXmlMap::iterator it = iServiceXml.find(Brn(path));
+                if (it != iServiceXml.end() && it->second->Generation() == generation) {
+                    xml = it->second;
+                }
+                else {
+                    Brh xmlBuf;
+                    DviProtocolUpnpServiceXmlWriter::Write(*service, *this, xmlBuf);
+                    xml = new DviProtocolUpnpDescription(xmlBuf, generation);
+                    if (it != iServiceXml.end()) {
+                        it->second->RemoveRef();
+                        it->second = xml;
+                    }
+                    else {
+                        iServiceXml.insert(std::pair<Brn, DviProtocolUpnpDescription*>(Brn(path), xml));
+                    }
+                }
+                xml->AddRef();
             }
-            iLock.Signal();
-            if (service == 0) {
-                THROW(ReaderError);
-            }
-            DviProtocolUpnpServiceXmlWriter::Write(*service, *this, aResourceWriter);
+            xml->Write(aResourceWriter);
+            xml->RemoveRef();
         }
     }
 }
@@ -716,6 +735,7 @@ DviProtocolUpnpAdapterSpecificData::DviProtocolUpnpAdapterSpecificData(DvStack&
     , iMask(aAdapter.Mask())
     , iUriBase(aUriBase)
     , iServerPort(aServerPort)
+    , iDeviceXml(NULL)
 #ifndef DEFINE_WINDOWS_UNIVERSAL
     , iBonjourWebPage(0)
 #endif
@@ -755,6 +775,7 @@ DviProtocolUpnpAdapterSpecificData::~DviProtocolUpnpAdapterSpecificData()
 #endif
     iListener->RemoveMsearchHandler(iId);
     iDvStack.Env().MulticastListenerRelease(iAdapter);
+    ClearDeviceXml();
 }
 
 const TIpAddress& DviProtocolUpnpAdapterSpecificData::Interface() const
@@ -788,20 +809,23 @@ TUint DviProtocolUpnpAdapterSpecificData::ServerPort() const
     return iServerPort;
 }
 
-const Brx& DviProtocolUpnpAdapterSpecificData::DeviceXml() const
+DviProtocolUpnpDescription* DviProtocolUpnpAdapterSpecificData::DeviceXml() const
 {
     return iDeviceXml;
 }
 
-void DviProtocolUpnpAdapterSpecificData::SetDeviceXml(Brh& aXml)
+void DviProtocolUpnpAdapterSpecificData::SetDeviceXml(DviProtocolUpnpDescription* aXml)
 {
-    aXml.TransferTo(iDeviceXml);
+    ClearDeviceXml();
+    iDeviceXml = aXml;
 }
 
 void DviProtocolUpnpAdapterSpecificData::ClearDeviceXml()
 {
-    Brh tmp;
-    iDeviceXml.TransferTo(tmp);
+    if (iDeviceXml != NULL) {
+        iDeviceXml->RemoveRef();
+        iDeviceXml = NULL;
+    }
 }
 
 void DviProtocolUpnpAdapterSpecificData::SetPendingDelete()
@@ -957,6 +981,61 @@ static void writeSpecVersion(WriterBwh& aWriter, const DviProtocolUpnp& aDevice)
     aWriter.Write("</specVersion>");
 }
 
+// DviProtocolUpnpDescription
+
+DviProtocolUpnpDescription::DviProtocolUpnpDescription(Brh& aXml, TUint aGeneration)
+    : iLock("DPUD")
+    , iRefCount(1)
+    , iGeneration(aGeneration)
+{
+    aXml.TransferTo(iXml);
+    // strong validator - 64-bit FNV-1a hash of the content
+    TUint64 hash = 0xcbf29ce484222325ULL;
+    const TByte* ptr = iXml.Ptr();
+    const TUint bytes = iXml.Bytes();
+    for (TUint i=0; i<bytes; i++) {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ULL;
+    }
+    Bws<20> etag;
+    etag.AppendPrintf("\"%08x%08x\"", (TUint)(hash >> 32), (TUint)(hash & 0xffffffff));
+    iETag.Set(etag);
+}
+
+DviProtocolUpnpDescription::~DviProtocolUpnpDescription()
+{
+}
+
+void DviProtocolUpnpDescription::AddRef()
+{
+    iLock.Wait();
+    iRefCount++;
+    iLock.Signal();
+}
+
+void DviProtocolUpnpDescription::RemoveRef()
+{
+    iLock.Wait();
+    const TBool dead = (--iRefCount == 0);
+    iLock.Signal();
+    if (dead) {
+        delete this;
+    }
+}
+
+TUint DviProtocolUpnpDescription::Generation() const
+{
+    return iGeneration;
+}
+
+void DviProtocolUpnpDescription::Write(IResourceWriter& aResourceWriter) const
+{
+    if (aResourceWriter.WriteResourceBeginWithETag(iXml.Bytes(), kOhNetMimeTypeXml, iETag.CString())) {
+        aResourceWriter.WriteResource(iXml.Ptr(), iXml.Bytes());
+    }
+    aResourceWriter.WriteResourceEnd();
+}
+
 // DviProtocolUpnpDeviceXmlWriter
 
 DviProtocolUpnpDeviceXmlWriter::DviProtocolUpnpDeviceXmlWriter(DviProtocolUpnp& aDeviceUpnp)
@@ -1173,16 +1252,12 @@ void DviProtocolUpnpDeviceXmlWriter::WriteResourceEnd()
 
 // DviProtocolUpnpServiceXmlWriter
 
-void DviProtocolUpnpServiceXmlWriter::Write(const DviService& aService, const DviProtocolUpnp& aDevice, IResourceWriter& aResourceWriter)
+void DviProtocolUpnpServiceXmlWriter::Write(const DviService& aService, const DviProtocolUpnp& aDevice, Brh& aXml)
 {
     static const TUint kBufGranularity = 1024 * 8;
     WriterBwh writer(kBufGranularity);
     WriteServiceXml(writer, aService, aDevice);
-    Brh xml;
-    writer.TransferTo(xml);
-    aResourceWriter.WriteResourceBegin(xml.Bytes(), kOhNetMimeTypeXml);
-    aResourceWriter.WriteResource(xml.Ptr(), xml.Bytes());
-    aResourceWriter.WriteResourceEnd();
+    writer.TransferTo(aXml);
 }
 
 void DviProtocolUpnpServiceXmlWriter::WriteServiceXml(WriterBwh& aWriter, const DviService& aService, const DviProtocolUpnp& aDevice)
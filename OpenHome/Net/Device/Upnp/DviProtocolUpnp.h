@@ -15,6 +15,7 @@
 #include <OpenHome/Net/Private/DviServerUpnp.h>
 
 #include <vector>
+#include <map>
 
 namespace OpenHome {
 namespace Net {
@@ -23,6 +24,7 @@ class DviMsgScheduler;
 class DviProtocolUpnpDeviceXmlWriter;
 class BonjourWebPage;
 class DviProtocolUpnpAdapterSpecificData;
+class DviProtocolUpnpDescription;
 class DvStack;
 
 class IUpnpMsearchHandler
@@ -119,6 +121,32 @@ private:
     TUint iUpdateCount;
     TBool iSuppressScheduledEvents;
     DviServerUpnp* iServer;
+    typedef std::map<Brn, DviProtocolUpnpDescription*, BufferCmp> ServiceXmlMap;
+    ServiceXmlMap iServiceXml;
+};
+
+/**
+ * Rendered device or service description.
+ *
+ * Immutable once constructed so can be written to any number of clients without
+ * holding the owning device's lock.  Reference counted; constructed with a single reference.
+ */
+class DviProtocolUpnpDescription : private INonCopyable
+{
+public:
+    DviProtocolUpnpDescription(Brh& aXml, TUint aGeneration); // takes ownership of aXml's buffer
+    void AddRef();
+    void RemoveRef();
+    TUint Generation() const;
+    void Write(IResourceWriter& aResourceWriter) const;
+private:
+    ~DviProtocolUpnpDescription();
+private:
+    Mutex iLock;
+    TUint iRefCount;
+    Brh iXml;
+    Brhz iETag;
+    TUint iGeneration;
 };
 
 class DviProtocolUpnpAdapterSpecificData : public ISsdpMsearchHandler, public INonCopyable
@@ -134,8 +162,8 @@ public:
     void UpdateServerPort(DviServerUpnp& aServer);
     void UpdateUriBase(Bwx& aUriBase);
     TUint ServerPort() const;
-    const Brx& DeviceXml() const;
-    void SetDeviceXml(Brh& aXml);
+    DviProtocolUpnpDescription* DeviceXml() const;
+    void SetDeviceXml(DviProtocolUpnpDescription* aXml); // takes ownership of caller's reference
     void ClearDeviceXml();
     void SetPendingDelete();
     void BonjourRegister(const TChar* aName, const Brx& aUdn, const Brx& aProtocol, const Brx& aResourceDir);
@@ -164,7 +192,7 @@ private:
     TIpAddress iMask;
     Bws<Uri::kMaxUriBytes> iUriBase;
     TUint iServerPort;
-    Brh iDeviceXml;
+    DviProtocolUpnpDescription* iDeviceXml;
 #ifndef DEFINE_WINDOWS_UNIVERSAL
     BonjourWebPage* iBonjourWebPage;
 #endif
@@ -203,7 +231,7 @@ private:
 class DviProtocolUpnpServiceXmlWriter
 {
 public:
-    static void Write(const DviService& aService, const DviProtocolUpnp& aDevice, IResourceWriter& aResourceWriter);
+    static void Write(const DviService& aService, const DviProtocolUpnp& aDevice, Brh& aXml);
 private:
     static void WriteServiceXml(WriterBwh& aWriter, const DviService& aService, const DviProtocolUpnp& aDevice);
     static void WriteServiceActionParams(WriterBwh& aWriter, const Action& aAction, TBool aIn);
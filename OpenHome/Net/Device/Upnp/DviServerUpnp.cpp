@@ -260,6 +260,46 @@ void HeaderAcceptLanguage::AddPrioritisedLanguage(std::vector<PrioritisedLanguag
 }
 
 
+// HeaderIfNoneMatch
+
+TBool HeaderIfNoneMatch::Matches(const Brx& aETag) const
+{
+    if (!Received()) {
+        return false;
+    }
+    Parser parser(iValue);
+    while (!parser.Finished()) {
+        Brn tag = Ascii::Trim(parser.Next(','));
+        if (tag == Brn("*")) {
+            return true;
+        }
+        // If-None-Match uses the weak comparison function
+        static const Brn kWeakPrefix("W/");
+        if (tag.BeginsWith(kWeakPrefix)) {
+            tag.Set(tag.Split(kWeakPrefix.Bytes()));
+        }
+        if (tag == aETag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TBool HeaderIfNoneMatch::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, Http::kHeaderIfNoneMatch);
+}
+
+void HeaderIfNoneMatch::Process(const Brx& aValue)
+{
+    try {
+        iValue.ReplaceThrow(aValue);
+        SetReceived();
+    }
+    catch (BufferOverflow&) {
+    }
+}
+
 // SubscriptionDataUpnp
 
 SubscriptionDataUpnp::SubscriptionDataUpnp(const Endpoint& aSubscriber, const Brx& aSubscriberPath, const Http::EVersion aHttpVersion)
@@ -315,103 +355,306 @@ void SubscriptionDataUpnp::Release()
 }
 
 
-// PropertyWriterUpnp
+// EventConnectionUpnp
 
-PropertyWriterUpnp::PropertyWriterUpnp(Environment& aEnv)
+EventConnectionUpnp::EventConnectionUpnp(Environment& aEnv)
     : iEnv(aEnv)
-    , iEventBody(kWriteGranularity)
+    , iWriteBuffer(iSocket)
+    , iWriterRequest(iWriteBuffer)
+    , iReadBuffer(iSocket)
+    , iReaderUntil(iReadBuffer)
+    , iReaderResponse(aEnv, iReaderUntil)
+    , iOpen(false)
+    , iIdleSince(0)
 {
-    iWriteBuffer = new Sws<kWriteGranularity>(iSocket);
-    iWriterEvent = new WriterHttpRequest(*iWriteBuffer);
-    SetWriter(iEventBody);
+    iReaderResponse.AddHeader(iHeaderConnection);
+    iReaderResponse.AddHeader(iHeaderContentLength);
+    iReaderResponse.AddHeader(iHeaderTransferEncoding);
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &EventConnectionUpnp::ReadTimeout), "EventConnectionUpnp");
 }
 
-void PropertyWriterUpnp::Initialise(const Endpoint& aPublisher, const Endpoint& aSubscriber,
-                                    const Brx& aSubscriberPath, Http::EVersion aHttpVersion,
-                                    const Brx& aSid, TUint aSequenceNumber)
+EventConnectionUpnp::~EventConnectionUpnp()
 {
-    iPublisher = aPublisher;
-    iSubscriber = aSubscriber;
-    iSubscriberPath.Set(aSubscriberPath);
-    iHttpVersion = aHttpVersion;
-    iSid.Set(aSid);
-    iSequenceNumber = aSequenceNumber;
+    delete iTimer;
+    Close();
+}
 
-    iEventBody.Write("<?xml version=\"1.0\"?>");
-    iEventBody.Write("<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">");
+void EventConnectionUpnp::SetSubscriber(const Endpoint& aSubscriber)
+{
+    iSubscriber = aSubscriber;
 }
 
-void PropertyWriterUpnp::Reset()
+const Endpoint& EventConnectionUpnp::Subscriber() const
 {
-    try {
-        iSocket.Close();
-    }
-    catch (NetworkError&) {}
-    iEventBody.Reset();
+    return iSubscriber;
 }
 
-void PropertyWriterUpnp::Connect()
+void EventConnectionUpnp::Connect()
 {
 #if 0
     Endpoint::AddressBuf buf;
     iSubscriber.AppendAddress(buf);
-    Log::Print("PropertyWriterUpnp connecting to %s\n", buf.Ptr());
+    Log::Print("EventConnectionUpnp connecting to %s\n", buf.Ptr());
 #endif
     iSocket.Open(iEnv);
+    iOpen = true;
     iSocket.Connect(iSubscriber, iEnv.InitParams()->TcpConnectTimeoutMs());
     //iSocket.LogVerbose(true);
 }
 
-void PropertyWriterUpnp::WriteHeaders(TUint aContentLength)
+void EventConnectionUpnp::Close()
 {
-    iWriterEvent->WriteMethod(kUpnpMethodNotify, iSubscriberPath, iHttpVersion);
+    if (iOpen) {
+        iOpen = false;
+        try {
+            iSocket.Close();
+        }
+        catch (NetworkError&) {}
+    }
+}
 
-    IWriterAscii& writer = iWriterEvent->WriteHeaderField(Http::kHeaderHost);
-    Endpoint::EndpointBuf buf;
-    iPublisher.AppendEndpoint(buf);
-    writer.Write(buf);
-    writer.WriteFlush();
+WriterHttpRequest& EventConnectionUpnp::WriterRequest()
+{
+    return iWriterRequest;
+}
 
-    iWriterEvent->WriteHeader(Http::kHeaderContentType, Brn("text/xml; charset=\"utf-8\""));
-    Http::WriteHeaderContentLength(*iWriterEvent, aContentLength);
-    iWriterEvent->WriteHeader(kUpnpHeaderNt, Brn("upnp:event"));
-    iWriterEvent->WriteHeader(kUpnpHeaderNts, Brn("upnp:propchange"));
+IWriter& EventConnectionUpnp::WriterBody()
+{
+    return iSocket;
+}
 
-    writer = iWriterEvent->WriteHeaderField(HeaderSid::kHeaderSid);
-    writer.Write(HeaderSid::kFieldSidPrefix);
-    writer.Write(iSid);
-    writer.WriteFlush();
+TBool EventConnectionUpnp::ReadResponse(TUint aTimeoutMs, TBool aKeepAlive)
+{
+    TBool reusable = false;
+    iTimer->FireIn(aTimeoutMs);
+    try {
+        iReaderResponse.Read();
+        const HttpStatus& status = iReaderResponse.Status();
+        if (status != HttpStatus::kOk) {
+            const Brx& reason = status.Reason();
+            LOG_ERROR(kDvEvent, "PropertyWriter, http error %u %.*s\n", status.Code(), PBUF(reason));
+        }
+        /* A response without Content-Length is delimited by the subscriber closing the
+           connection so can't be followed by another request */
+        if (aKeepAlive && iReaderResponse.Version() == Http::eHttp11 && !iHeaderConnection.Close() &&
+            !iHeaderTransferEncoding.IsChunked() && iHeaderContentLength.Received()) {
+            TUint remaining = iHeaderContentLength.ContentLength();
+            if (remaining <= kMaxResponseBytes) {
+                while (remaining > 0) {
+                    remaining -= iReaderUntil.Read(remaining).Bytes();
+                }
+                reusable = true;
+            }
+        }
+    }
+    catch (Exception&) {
+        iTimer->Cancel();
+        throw;
+    }
+    iTimer->Cancel();
+    return reusable;
+}
 
-    writer = iWriterEvent->WriteHeaderField(kUpnpHeaderSeq);
-    writer.WriteUint(iSequenceNumber);
-    writer.WriteFlush();
+void EventConnectionUpnp::SetIdleSince(TUint aTime)
+{
+    iIdleSince = aTime;
+}
 
-    iWriterEvent->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
-    iWriterEvent->WriteFlush();
+TUint EventConnectionUpnp::IdleSince() const
+{
+    return iIdleSince;
 }
 
-PropertyWriterUpnp::~PropertyWriterUpnp()
+void EventConnectionUpnp::ReadTimeout()
 {
-    delete iWriterEvent;
-    delete iWriteBuffer;
-    try {
-        iSocket.Close();
+    LOG_ERROR(kDvEvent, "EventConnectionUpnp - response read timeout\n");
+    iReaderUntil.ReadInterrupt();
+}
+
+
+// EventConnectionPool
+
+const Brn EventConnectionPool::kQueryEventConnections("eventconnections");
+
+EventConnectionPool::EventConnectionPool(Environment& aEnv, TUint aMaxIdle, TUint aIdleTimeoutMs)
+    : iEnv(aEnv)
+    , iLock("DECP")
+    , iMaxIdle(aMaxIdle)
+    , iIdleTimeoutMs(aIdleTimeoutMs)
+    , iTimerActive(false)
+    , iHits(0)
+    , iMisses(0)
+    , iReconnects(0)
+    , iExpired(0)
+{
+    ASSERT(iMaxIdle > 0 && iIdleTimeoutMs > 0);
+    iTimer = new Timer(aEnv, MakeFunctor(*this, &EventConnectionPool::TimerExpired), "EventConnectionPool");
+    IInfoAggregator* infoAggregator = aEnv.InfoAggregator();
+    if (infoAggregator != NULL) {
+        std::vector<Brn> queries;
+        queries.push_back(kQueryEventConnections);
+        infoAggregator->Register(*this, queries);
     }
-    catch (NetworkError&) {}
 }
 
-void PropertyWriterUpnp::PropertyWriteEnd()
+EventConnectionPool::~EventConnectionPool()
 {
-    iEventBody.Write("</e:propertyset>");
+    delete iTimer;
+    std::list<EventConnectionUpnp*>::iterator it;
+    for (it=iIdle.begin(); it!=iIdle.end(); ++it) {
+        delete *it;
+    }
+}
+
+EventConnectionUpnp* EventConnectionPool::Claim(const Endpoint& aSubscriber)
+{
+    EventConnectionUpnp* connection = NULL;
+    std::vector<EventConnectionUpnp*> expired;
+    iLock.Wait();
+    const TUint now = Time::Now(iEnv);
+    std::list<EventConnectionUpnp*>::iterator it = iIdle.begin();
+    while (it != iIdle.end()) {
+        EventConnectionUpnp* candidate = *it;
+        if (now - candidate->IdleSince() >= iIdleTimeoutMs) {
+            expired.push_back(candidate);
+            it = iIdle.erase(it);
+        }
+        else if (candidate->Subscriber() == aSubscriber) {
+            connection = candidate;
+            iIdle.erase(it);
+            break;
+        }
+        else {
+            ++it;
+        }
+    }
+    if (connection == NULL) {
+        iMisses++;
+    }
+    else {
+        iHits++;
+    }
+    iExpired += (TUint)expired.size();
+    iLock.Signal();
+    // deleting a connection may block on the timer thread so can't be done with iLock held
+    Delete(expired);
+    return connection;
+}
+
+void EventConnectionPool::Release(EventConnectionUpnp* aConnection, TBool aReusable)
+{
+    std::vector<EventConnectionUpnp*> discard;
+    if (!aReusable) {
+        discard.push_back(aConnection);
+    }
+    else {
+        AutoMutex _(iLock);
+        aConnection->SetIdleSince(Time::Now(iEnv));
+        iIdle.push_front(aConnection);
+        if (iIdle.size() > iMaxIdle) {
+            discard.push_back(iIdle.back());
+            iIdle.pop_back();
+        }
+        if (!iTimerActive) {
+            iTimerActive = true;
+            iTimer->FireIn(iIdleTimeoutMs);
+        }
+    }
+    Delete(discard);
+}
+
+void EventConnectionPool::NotifyReconnected()
+{
+    AutoMutex _(iLock);
+    iReconnects++;
+}
 
+void EventConnectionPool::TimerExpired()
+{
+    std::vector<EventConnectionUpnp*> expired;
+    iLock.Wait();
+    const TUint now = Time::Now(iEnv);
+    while (iIdle.size() > 0 && now - iIdle.back()->IdleSince() >= iIdleTimeoutMs) {
+        expired.push_back(iIdle.back());
+        iIdle.pop_back();
+    }
+    iExpired += (TUint)expired.size();
+    if (iIdle.size() == 0) {
+        iTimerActive = false;
+    }
+    else {
+        iTimer->FireIn(iIdle.back()->IdleSince() + iIdleTimeoutMs - now);
+    }
+    iLock.Signal();
+    Delete(expired);
+}
+
+void EventConnectionPool::Delete(std::vector<EventConnectionUpnp*>& aConnections)
+{ // static
+    for (TUint i=0; i<(TUint)aConnections.size(); i++) {
+        delete aConnections[i];
+    }
+}
+
+void EventConnectionPool::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery != kQueryEventConnections) {
+        return;
+    }
+    Bws<160> summary;
+    iLock.Wait();
+    summary.AppendPrintf("Event connections: %u idle (max %u, timeout %ums)\n",
+                         (TUint)iIdle.size(), iMaxIdle, iIdleTimeoutMs);
+    summary.AppendPrintf("\t%u hits, %u misses, %u reconnects, %u expired\n",
+                         iHits, iMisses, iReconnects, iExpired);
+    iLock.Signal();
+    aWriter.Write(summary);
+}
+
+
+// PropertyWriterUpnp
+
+PropertyWriterUpnp::PropertyWriterUpnp(Environment& aEnv, EventConnectionPool* aConnectionPool)
+    : iEnv(aEnv)
+    , iConnectionPool(aConnectionPool)
+    , iEventBody(kWriteGranularity)
+{
+    iConnection = new EventConnectionUpnp(aEnv);
+    SetWriter(iEventBody);
+}
+
+void PropertyWriterUpnp::Initialise(const Endpoint& aPublisher, const Endpoint& aSubscriber,
+                                    const Brx& aSubscriberPath, Http::EVersion aHttpVersion,
+                                    const Brx& aSid, TUint aSequenceNumber)
+{
+    iPublisher = aPublisher;
+    iSubscriber = aSubscriber;
+    iSubscriberPath.Set(aSubscriberPath);
+    iHttpVersion = aHttpVersion;
+    iSid.Set(aSid);
+    iSequenceNumber = aSequenceNumber;
+
+    iEventBody.Write("<?xml version=\"1.0\"?>");
+    iEventBody.Write("<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">");
+}
+
+void PropertyWriterUpnp::Reset()
+{
+    iConnection->Close();
+    iEventBody.Reset();
+}
+
+void PropertyWriterUpnp::WriteEvent(EventConnectionUpnp& aConnection, TBool aConnect, TBool aKeepAlive)
+{
     Endpoint::AddressBuf subscriberAddress;
     iSubscriber.AppendAddress(subscriberAddress);
     try {
-        Connect();
-        //iSocket.LogVerbose(true);
+        if (aConnect) {
+            aConnection.Connect();
+        }
         const Brx& body = iEventBody.Buffer();
-        WriteHeaders(body.Bytes());
-        iSocket.Write(body);
+        WriteHeaders(aConnection.WriterRequest(), body.Bytes(), aKeepAlive);
+        aConnection.WriterBody().Write(body);
     }
     catch (NetworkTimeout&) {
         LOG_ERROR(kDvEvent, "PropertyWriterUpnp - NetworkTimeout eventing to %.*s\n", PBUF(subscriberAddress));
@@ -429,16 +672,91 @@ void PropertyWriterUpnp::PropertyWriteEnd()
         LOG_ERROR(kDvEvent, "PropertyWriterUpnp - WriterError eventing to %.*s\n", PBUF(subscriberAddress));
         throw;
     }
+}
+
+void PropertyWriterUpnp::WriteHeaders(WriterHttpRequest& aWriter, TUint aContentLength, TBool aKeepAlive)
+{
+    aWriter.WriteMethod(kUpnpMethodNotify, iSubscriberPath, iHttpVersion);
+
+    IWriterAscii& writer = aWriter.WriteHeaderField(Http::kHeaderHost);
+    Endpoint::EndpointBuf buf;
+    iPublisher.AppendEndpoint(buf);
+    writer.Write(buf);
+    writer.WriteFlush();
+
+    aWriter.WriteHeader(Http::kHeaderContentType, Brn("text/xml; charset=\"utf-8\""));
+    Http::WriteHeaderContentLength(aWriter, aContentLength);
+    aWriter.WriteHeader(kUpnpHeaderNt, Brn("upnp:event"));
+    aWriter.WriteHeader(kUpnpHeaderNts, Brn("upnp:propchange"));
+
+    writer = aWriter.WriteHeaderField(HeaderSid::kHeaderSid);
+    writer.Write(HeaderSid::kFieldSidPrefix);
+    writer.Write(iSid);
+    writer.WriteFlush();
+
+    writer = aWriter.WriteHeaderField(kUpnpHeaderSeq);
+    writer.WriteUint(iSequenceNumber);
+    writer.WriteFlush();
+
+    if (!aKeepAlive) { // HTTP/1.1 connections are persistent unless either side says otherwise
+        aWriter.WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    }
+    aWriter.WriteFlush();
+}
+
+PropertyWriterUpnp::~PropertyWriterUpnp()
+{
+    delete iConnection;
+}
+
+void PropertyWriterUpnp::PropertyWriteEnd()
+{
+    iEventBody.Write("</e:propertyset>");
+
+    if (iConnectionPool == NULL || iHttpVersion != Http::eHttp11) {
+        iConnection->SetSubscriber(iSubscriber);
+        WriteEvent(*iConnection, true, false);
+        (void)iConnection->ReadResponse(kReadTimeoutMs, false);
+        return; // connection is closed by Reset()
+    }
 
-    Srs<kMaxResponseBytes> readBuffer(iSocket);
-    ReaderUntilS<kMaxResponseBytes> readerUntil(readBuffer);
-    ReaderHttpResponse readerResponse(iEnv, readerUntil);
-    readerResponse.Read(kReadTimeoutMs);
-    const HttpStatus& status = readerResponse.Status();
-    if (status != HttpStatus::kOk) {
-        const Brx& reason = status.Reason();
-        LOG_ERROR(kDvEvent, "PropertyWriter, http error %u %.*s\n", status.Code(), PBUF(reason));
+    EventConnectionUpnp* connection = iConnectionPool->Claim(iSubscriber);
+    TBool reused = (connection != NULL);
+    if (!reused) {
+        connection = new EventConnectionUpnp(iEnv);
+        connection->SetSubscriber(iSubscriber);
+    }
+    TBool reusable = false;
+    for (;;) {
+        const TUint start = Time::Now(iEnv);
+        try {
+            WriteEvent(*connection, !reused, true);
+            reusable = connection->ReadResponse(kReadTimeoutMs, true);
+            break;
+        }
+        catch (WriterError&) {
+            if (!reused) {
+                iConnectionPool->Release(connection, false);
+                throw;
+            }
+        }
+        catch (ReaderError&) {
+            // a response that timed out may still be processed by the subscriber so isn't retried
+            if (!reused || Time::Now(iEnv) - start >= kReadTimeoutMs) {
+                iConnectionPool->Release(connection, false);
+                throw;
+            }
+        }
+        catch (Exception&) {
+            iConnectionPool->Release(connection, false);
+            throw;
+        }
+        // subscriber closed an idle connection; retry once on a new one
+        connection->Close();
+        reused = false;
+        iConnectionPool->NotifyReconnected();
     }
+    iConnectionPool->Release(connection, reusable);
 }
 
 
@@ -455,7 +773,7 @@ PropertyWriterFactory::PropertyWriterFactory(DvStack& aDvStack, const TIpAddress
 {
     const TUint numWriters = iFifo.Slots();
     for (TUint i=0; i<numWriters; i++) {
-        iFifo.Write(new PropertyWriterUpnp(aDvStack.Env()));
+        iFifo.Write(new PropertyWriterUpnp(aDvStack.Env(), aDvStack.EventConnections()));
     }
 }
 
@@ -521,6 +839,16 @@ void PropertyWriterFactory::ReleaseWriter(IPropertyWriter* aWriter)
     iFifo.Write(writer);
 }
 
+IPropertyEncoder* PropertyWriterFactory::PropertyEncoder()
+{
+    return &PropertyWriter::Encoder();
+}
+
+void PropertyWriterFactory::PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded)
+{
+    static_cast<PropertyWriterUpnp&>(aWriter).WriteEncoded(aEncoded);
+}
+
 void PropertyWriterFactory::NotifySubscriptionCreated(const Brx& /*aSid*/)
 {
 }
@@ -590,6 +918,7 @@ DviSessionUpnp::DviSessionUpnp(DvStack& aDvStack, const NetworkAdapter& aNif, TU
     , iPropertyWriterFactory(aPropertyWriterFactory)
     , iPathMapper(aPathMapper)
     , iRedirector(aRedirector)
+    , iRequestCount(0)
     , iShutdownSem("DSUS", 1)
 {
     iNif.AddRef("DviSessionUpnp");
@@ -620,6 +949,7 @@ DviSessionUpnp::DviSessionUpnp(DvStack& aDvStack, const NetworkAdapter& aNif, TU
     iReaderRequest->AddHeader(iHeaderCallback);
     iReaderRequest->AddHeader(iHeaderAcceptLanguage);
     iReaderRequest->AddHeader(iHeaderUserAgent);
+    iReaderRequest->AddHeader(iHeaderIfNoneMatch);
 }
 
 DviSessionUpnp::~DviSessionUpnp()
@@ -639,25 +969,55 @@ DviSessionUpnp::~DviSessionUpnp()
 void DviSessionUpnp::Run()
 {
     iShutdownSem.Wait();
-    iErrorStatus = &HttpStatus::kOk;
     iReaderRequest->Flush();
+    iReaderEntity->ReadFlush();
+    TUint maxRequests, idleTimeoutMs;
+    iDvStack.Env().InitParams()->GetDvUpnpKeepAlive(maxRequests, idleTimeoutMs);
+    /* A parked connection may be resumed by any session so carries its request count with
+       it (see SocketTcpSession::Park).  Only park once all buffered (pipelined) data has
+       been handled. */
+    iRequestCount = (Resumed()? ResumedState() : 0);
+    for (;;) {
+        const TBool firstRequest = (iRequestCount == 0);
+        const TBool mayKeepAlive = (iRequestCount+1 < maxRequests);
+        if (!HandleRequest(firstRequest? kReadTimeoutMs : idleTimeoutMs, firstRequest, mayKeepAlive)) {
+            break;
+        }
+        iRequestCount++;
+        if (iReaderUntil->BytesBuffered() == 0 && iReadBuffer->BytesBuffered() == 0 && Park(iRequestCount)) {
+            break;
+        }
+    }
+    iShutdownSem.Signal();
+}
+
+TBool DviSessionUpnp::HandleRequest(TUint aReadTimeoutMs, TBool aFirstRequest, TBool aMayKeepAlive)
+{
+    iErrorStatus = &HttpStatus::kOk;
     iWriterChunked->SetChunked(false);
     iInvocationService = NULL;
     iResourceWriterHeadersOnly = false;
     iSoapRequest.SetBytes(0);
-    iReaderEntity->ReadFlush();
     iResponseStarted = false;
     iResponseEnded = false;
+    iKeepAlive = false;
+    TBool completed = false;
     Brn method;
     Brn reqUri;
     // check headers
     try {
         try {
-            iReaderRequest->Read(kReadTimeoutMs);
+            iReaderRequest->Read(aReadTimeoutMs);
         }
         catch (HttpError&) {
             Error(HttpStatus::kBadRequest);
         }
+        catch (ReaderError&) {
+            if (!aFirstRequest) {
+                return false; // persistent connection closed or idle for too long
+            }
+            throw;
+        }
         if (iReaderRequest->MethodNotAllowed()) {
             Error(HttpStatus::kMethodNotAllowed);
         }
@@ -667,6 +1027,14 @@ void DviSessionUpnp::Run()
         reqUri.Set(iReaderRequest->Uri());
         LOG(kDvDevice, "Method: %.*s, uri: %.*s\n", PBUF(method), PBUF(reqUri));
 
+        /* Only keep the connection if the end of this request and its response can be found
+           without closing it.  HEAD responses and request entities (other than for POST,
+           which reads its entity) don't meet this. */
+        iKeepAlive = (aMayKeepAlive && iReaderRequest->Version() == Http::eHttp11 && !iHeaderConnection.Close() &&
+                      method != Http::kMethodHead &&
+                      (method == Http::kMethodPost ||
+                       (iHeaderContentLength.ContentLength() == 0 && !iHeaderTransferEncoding.IsChunked())));
+
         iDvStack.NotifyControlPointUsed(iHeaderUserAgent.UserAgent());
 
         if (method == Http::kMethodGet) {
@@ -685,6 +1053,7 @@ void DviSessionUpnp::Run()
         else if (method == kUpnpMethodUnsubscribe) {
             Unsubscribe();
         }
+        completed = true;
     }
     catch (HttpError&) {
         LOG(/*kDvDevice|*/kDvEvent, "HttpError handling %.*s for %.*s\n", PBUF(method), PBUF(reqUri));
@@ -714,17 +1083,20 @@ void DviSessionUpnp::Run()
             iWriterResponse->WriteStatus(*iErrorStatus, Http::eHttp11);
             Http::WriteHeaderConnectionClose(*iWriterResponse);
             iWriterResponse->WriteFlush();
+            return false;
         }
         else if (!iResponseEnded) {
             iWriterResponse->WriteFlush();
+            return false;
         }
     }
     catch (WriterError&) {
         if(OpenHome::Debug::TestLevel(OpenHome::Debug::kDvDevice|OpenHome::Debug::kDvEvent)) {
            Log::Print("WriterError(2) handling %.*s for %.*s\n", PBUF(method), PBUF(reqUri));
         }
+        return false;
     }
-    iShutdownSem.Signal();
+    return (completed && iKeepAlive);
 }
 
 void DviSessionUpnp::Error(const HttpStatus& aStatus)
@@ -756,6 +1128,7 @@ void DviSessionUpnp::Get()
         writerLocation.Write(endptBuf);
         writerLocation.Write(redirectTo);
         writerLocation.WriteFlush();
+        WriteHeaderConnection(false);
         iWriterResponse->WriteFlush();
         iResponseEnded = true;
     }
@@ -797,6 +1170,7 @@ void DviSessionUpnp::Post()
         }
     }
     else {
+        iKeepAlive = false; // request entity hasn't been read
         const HttpStatus* err = &HttpStatus::kNotFound;
         InvocationReportErrorNoThrow(err->Code(), err->Reason());
     }
@@ -873,7 +1247,7 @@ void DviSessionUpnp::Subscribe()
         writerTimeout.Write(HeaderTimeout::kFieldTimeoutPrefix);
         writerTimeout.WriteUint(duration);
         writerTimeout.WriteFlush();
-        iWriterResponse->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+        WriteHeaderConnection(false);
         iWriterResponse->WriteFlush();
         iResponseEnded = true;
     }
@@ -929,7 +1303,7 @@ void DviSessionUpnp::Unsubscribe()
     }
     iResponseStarted = true;
     iWriterResponse->WriteStatus(HttpStatus::kOk, Http::eHttp11);
-    iWriterResponse->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    WriteHeaderConnection(false);
     iWriterResponse->WriteFlush();
     iResponseEnded = true;
 
@@ -979,7 +1353,7 @@ void DviSessionUpnp::Renew()
     writerTimeout.Write(HeaderTimeout::kFieldTimeoutPrefix);
     writerTimeout.WriteUint(duration);
     writerTimeout.WriteFlush();
-    iWriterResponse->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    WriteHeaderConnection(false);
     iWriterResponse->WriteFlush();
     iResponseEnded = true;
 
@@ -1028,7 +1402,37 @@ void DviSessionUpnp::WriteServerHeader(IWriterHttpHeader& aWriter)
     stream.WriteFlush();
 }
 
+void DviSessionUpnp::WriteHeaderConnection(TBool aHasEntity)
+{
+    if (!iKeepAlive) {
+        Http::WriteHeaderConnectionClose(*iWriterResponse);
+    }
+    else if (!aHasEntity) {
+        // HTTP/1.1 responses without a length are otherwise terminated by closing the connection
+        Http::WriteHeaderContentLength(*iWriterResponse, 0);
+    }
+}
+
 void DviSessionUpnp::WriteResourceBegin(TUint aTotalBytes, const TChar* aMimeType)
+{
+    DoWriteResourceBegin(aTotalBytes, aMimeType, NULL);
+}
+
+TBool DviSessionUpnp::WriteResourceBeginWithETag(TUint aTotalBytes, const TChar* aMimeType, const TChar* aETag)
+{
+    if (!iHeaderIfNoneMatch.Matches(Brn(aETag))) {
+        DoWriteResourceBegin(aTotalBytes, aMimeType, aETag);
+        return true;
+    }
+    iWriterResponse->WriteStatus(HttpStatus::kNotModified, Http::eHttp11);
+    iWriterResponse->WriteHeader(Http::kHeaderETag, Brn(aETag));
+    WriteHeaderConnection(true); // 304 responses never have a body
+    iWriterResponse->WriteFlush();
+    iResponseStarted = true;
+    return false;
+}
+
+void DviSessionUpnp::DoWriteResourceBegin(TUint aTotalBytes, const TChar* aMimeType, const TChar* aETag)
 {
     if (iHeaderExpect.Continue()) {
         iWriterResponse->WriteStatus(HttpStatus::kContinue, Http::eHttp11);
@@ -1049,7 +1453,10 @@ void DviSessionUpnp::WriteResourceBegin(TUint aTotalBytes, const TChar* aMimeTyp
         writer.Write(Brn("; charset=\"utf-8\""));
         writer.WriteFlush();
     }
-    Http::WriteHeaderConnectionClose(*iWriterResponse);
+    if (aETag != NULL) {
+        iWriterResponse->WriteHeader(Http::kHeaderETag, Brn(aETag));
+    }
+    WriteHeaderConnection(true);
     iWriterResponse->WriteFlush();
     if (aTotalBytes == 0) {
         if (iReaderRequest->Version() == Http::eHttp11) { 
@@ -1257,7 +1664,7 @@ void DviSessionUpnp::InvocationReportErrorNoThrow(TUint aCode, const Brx& aDescr
     if (iReaderRequest->Version() == Http::eHttp11) { 
         iWriterResponse->WriteHeader(Http::kHeaderTransferEncoding, Http::kTransferEncodingChunked);
     }
-    iWriterResponse->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    WriteHeaderConnection(true);
     iWriterResponse->WriteFlush();
 
     if (iReaderRequest->Version() == Http::eHttp11) { 
@@ -1294,7 +1701,7 @@ void DviSessionUpnp::InvocationWriteStart()
     if (iReaderRequest->Version() == Http::eHttp11) { 
         iWriterResponse->WriteHeader(Http::kHeaderTransferEncoding, Http::kTransferEncodingChunked);
     }
-    iWriterResponse->WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    WriteHeaderConnection(true);
     iWriterResponse->WriteFlush();
 
     if (iReaderRequest->Version() == Http::eHttp11) { 
@@ -1458,6 +1865,12 @@ void DviServerUpnp::Redirect(const Brx& aUriRequested, const Brx& aUriRedirected
 SocketTcpServer* DviServerUpnp::CreateServer(const NetworkAdapter& aNif)
 {
     SocketTcpServer* server = new SocketTcpServer(iDvStack.Env(), "UpnpServer", iPort, aNif.Address());
+    TUint maxRequests, idleTimeoutMs;
+    iDvStack.Env().InitParams()->GetDvUpnpKeepAlive(maxRequests, idleTimeoutMs);
+    const TUint maxParked = iDvStack.Env().InitParams()->DvUpnpParkIdleConnections();
+    if (maxRequests > 1 && maxParked > 0) {
+        (void)server->EnableParking(maxParked, idleTimeoutMs);
+    }
     PropertyWriterFactory* pwf = new PropertyWriterFactory(iDvStack, aNif.Address(), server->Port());
     iPropertyWriterFactories.push_back(pwf);
     const TUint numWsThreads = iDvStack.Env().InitParams()->DvNumServerThreads();
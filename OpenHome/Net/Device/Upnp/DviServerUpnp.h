@@ -12,9 +12,12 @@
 #include <OpenHome/Net/Private/Service.h>
 #include <OpenHome/Net/Private/DviServer.h>
 #include <OpenHome/Net/Private/DviSubscription.h>
+#include <OpenHome/Private/Timer.h>
+#include <OpenHome/Private/InfoProvider.h>
 
 #include <vector>
 #include <map>
+#include <list>
 
 namespace OpenHome {
 namespace Net {
@@ -89,6 +92,18 @@ private:
     std::vector<char*> iLanguageList;
 };
 
+class HeaderIfNoneMatch : public HttpHeader
+{
+    static const TUint kMaxValueBytes = 1024;
+public:
+    TBool Matches(const Brx& aETag) const;
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Bws<kMaxValueBytes> iValue;
+};
+
 class SubscriptionDataUpnp : public IDviSubscriptionUserData
 {
 public:
@@ -107,27 +122,107 @@ private:
     Http::EVersion iHttpVersion;
 };
 
+/**
+ * TCP connection to an event subscriber.  Owns the buffers needed to write a NOTIFY
+ * request and read its response so that the connection can be reused for later events.
+ */
+class EventConnectionUpnp : private INonCopyable
+{
+public:
+    static const TUint kWriteGranularity = 4 * 1024;
+    static const TUint kMaxResponseBytes = 128;
+public:
+    EventConnectionUpnp(Environment& aEnv);
+    ~EventConnectionUpnp();
+    void SetSubscriber(const Endpoint& aSubscriber);
+    const Endpoint& Subscriber() const;
+    void Connect();
+    void Close();
+    WriterHttpRequest& WriterRequest();
+    IWriter& WriterBody();
+    /**
+     * Read the response to a NOTIFY, discarding any entity body.
+     * Returns true if the subscriber is willing to accept further requests on this connection.
+     */
+    TBool ReadResponse(TUint aTimeoutMs, TBool aKeepAlive);
+    void SetIdleSince(TUint aTime);
+    TUint IdleSince() const;
+private:
+    void ReadTimeout();
+private:
+    Environment& iEnv;
+    Endpoint iSubscriber;
+    SocketTcpClient iSocket;
+    Sws<kWriteGranularity> iWriteBuffer;
+    WriterHttpRequest iWriterRequest;
+    Srs<kMaxResponseBytes> iReadBuffer;
+    ReaderUntilS<kMaxResponseBytes> iReaderUntil;
+    ReaderHttpResponse iReaderResponse;
+    HttpHeaderConnection iHeaderConnection;
+    HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    Timer* iTimer;
+    TBool iOpen;
+    TUint iIdleSince;
+};
+
+/**
+ * Idle NOTIFY connections, shared by all PropertyWriterUpnp instances in a DvStack.
+ * Only created if InitialisationParams::SetDvEventKeepAlive() enabled connection reuse.
+ */
+class EventConnectionPool : private IInfoProvider, private INonCopyable
+{
+    static const Brn kQueryEventConnections;
+public:
+    EventConnectionPool(Environment& aEnv, TUint aMaxIdle, TUint aIdleTimeoutMs);
+    ~EventConnectionPool();
+    /**
+     * Returns an idle connection to aSubscriber or NULL if none is available.
+     */
+    EventConnectionUpnp* Claim(const Endpoint& aSubscriber);
+    /**
+     * Return a connection after use.  Deleted if aReusable is false or the pool is full.
+     */
+    void Release(EventConnectionUpnp* aConnection, TBool aReusable);
+    void NotifyReconnected();
+private:
+    void TimerExpired();
+    static void Delete(std::vector<EventConnectionUpnp*>& aConnections);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter);
+private:
+    Environment& iEnv;
+    Mutex iLock;
+    const TUint iMaxIdle;
+    const TUint iIdleTimeoutMs;
+    std::list<EventConnectionUpnp*> iIdle; // most recently used first
+    Timer* iTimer;
+    TBool iTimerActive;
+    TUint iHits;
+    TUint iMisses;
+    TUint iReconnects;
+    TUint iExpired;
+};
+
 class PropertyWriterUpnp : public PropertyWriter
 {
 public:
-    PropertyWriterUpnp(Environment& aEnv);
+    PropertyWriterUpnp(Environment& aEnv, EventConnectionPool* aConnectionPool);
     ~PropertyWriterUpnp();
     void Initialise(const Endpoint& aPublisher, const Endpoint& aSubscriber, const Brx& aSubscriberPath,
                     Http::EVersion aHttpVersion, const Brx& aSid, TUint aSequenceNumber);
     void Reset();
 private:
-    void Connect();
-    void WriteHeaders(TUint aContentLength);
+    void WriteEvent(EventConnectionUpnp& aConnection, TBool aConnect, TBool aKeepAlive);
+    void WriteHeaders(WriterHttpRequest& aWriter, TUint aContentLength, TBool aKeepAlive);
 private: // from IPropertyWriter
     void PropertyWriteEnd();
 private:
     static const TUint kWriteGranularity = 4 * 1024;
-    static const TUint kMaxResponseBytes = 128;
     static const TUint kReadTimeoutMs = 5 * 1000;
     Environment& iEnv;
-    SocketTcpClient iSocket;
-    Sws<kWriteGranularity>* iWriteBuffer;
-    WriterHttpRequest* iWriterEvent;
+    EventConnectionPool* iConnectionPool;
+    EventConnectionUpnp* iConnection;
     WriterBwh iEventBody;
     // event specific members follow
     Endpoint iPublisher;
@@ -150,6 +245,8 @@ public:
 private: // IPropertyWriterFactory
     IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData, const Brx& aSid, TUint aSequenceNumber);
     void ReleaseWriter(IPropertyWriter* aWriter);
+    IPropertyEncoder* PropertyEncoder();
+    void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded);
     void NotifySubscriptionCreated(const Brx& aSid);
     void NotifySubscriptionDeleted(const Brx& aSid);
     void NotifySubscriptionExpired(const Brx& aSid);
@@ -180,6 +277,7 @@ public:
     ~DviSessionUpnp();
 private:
     void Run();
+    TBool HandleRequest(TUint aReadTimeoutMs, TBool aFirstRequest, TBool aMayKeepAlive);
     void Error(const HttpStatus& aStatus);
     void Get();
     void Post();
@@ -188,9 +286,12 @@ private:
     void Renew();
     void ParseRequestUri(const Brx& aUrlTail, DviDevice** aDevice, DviService** aService);
     void WriteServerHeader(IWriterHttpHeader& aWriter);
+    void WriteHeaderConnection(TBool aHasEntity);
+    void DoWriteResourceBegin(TUint aTotalBytes, const TChar* aMimeType, const TChar* aETag);
     void InvocationReportErrorNoThrow(TUint aCode, const Brx& aDescription);
 private: // IResourceWriter
     void WriteResourceBegin(TUint aTotalBytes, const TChar* aMimeType);
+    TBool WriteResourceBeginWithETag(TUint aTotalBytes, const TChar* aMimeType, const TChar* aETag);
     void WriteResource(const TByte* aData, TUint aBytes);
     void WriteResourceEnd();
 private: // IDviInvocation
@@ -253,9 +354,12 @@ private:
     HeaderCallback iHeaderCallback;
     HeaderAcceptLanguage iHeaderAcceptLanguage;
     HttpHeaderUserAgent iHeaderUserAgent;
+    HeaderIfNoneMatch iHeaderIfNoneMatch;
     const HttpStatus* iErrorStatus;
     TBool iResponseStarted;
     TBool iResponseEnded;
+    TBool iKeepAlive;
+    TUint iRequestCount;    // requests handled on the current connection, including before it was parked
     Bws<kMaxRequestBytes> iSoapRequest;
     Bws<kMaxRequestPathBytes> iMappedRequestUri;
     DviDevice* iInvocationDevice;
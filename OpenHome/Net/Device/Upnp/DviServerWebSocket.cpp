@@ -17,6 +17,9 @@
 #include <OpenHome/Private/Parser.h>
 
 #include <stdlib.h>
+#ifdef DEFINE_ZLIB
+# include <zlib.h>
+#endif
 
 using namespace OpenHome;
 using namespace OpenHome::Net;
@@ -41,6 +44,7 @@ const Brn WebSocket::kHeaderResponseOrigin("Sec-WebSocket-Origin");
 const Brn WebSocket::kHeaderLocation("Sec-WebSocket-Location");
 const Brn WebSocket::kHeaderKey("Sec-WebSocket-Key");
 const Brn WebSocket::kHeaderVersion("Sec-WebSocket-Version");
+const Brn WebSocket::kHeaderExtensions("Sec-WebSocket-Extensions");
 const Brn WebSocket::kHeaderOrigin("Origin");
 const Brn WebSocket::kUpgradeWebSocket("WebSocket");
 const Brn WebSocket::kTagRoot("ROOT");
@@ -54,6 +58,11 @@ const Brn WebSocket::kTagNts("NTS");
 const Brn WebSocket::kTagSubscription("SUBSCRIPTION");
 const Brn WebSocket::kTagSeq("SEQ");
 const Brn WebSocket::kTagClientId("CLIENTID");
+const Brn WebSocket::kTagId("ID");
+const Brn WebSocket::kTagAction("ACTION");
+const Brn WebSocket::kTagArgs("ARGS");
+const Brn WebSocket::kTagCode("CODE");
+const Brn WebSocket::kTagDescription("DESCRIPTION");
 const Brn WebSocket::kMethodSubscribe("Subscribe");
 const Brn WebSocket::kMethodUnsubscribe("Unsubscribe");
 const Brn WebSocket::kMethodRenew("Renew");
@@ -61,9 +70,17 @@ const Brn WebSocket::kMethodSubscriptionSid("SubscribeCompleted");
 const Brn WebSocket::kMethodSubscriptionRenewed("RenewCompleted");
 const Brn WebSocket::kMethodGetPropertyUpdates("GetPropertyUpdates");
 const Brn WebSocket::kMethodPropertyUpdate("PropertyUpdate");
+const Brn WebSocket::kMethodInvoke("Invoke");
+const Brn WebSocket::kMethodInvokeCompleted("InvokeCompleted");
+const Brn WebSocket::kMethodInvokeFailed("InvokeFailed");
 const Brn WebSocket::kValueProtocol("upnpevent.openhome.org");
 const Brn WebSocket::kValueNt("upnp:event");
 const Brn WebSocket::kValuePropChange("upnp:propchange");
+const Brn WebSocket::kValuePermessageDeflate("permessage-deflate");
+const Brn WebSocket::kParamServerNoContextTakeover("server_no_context_takeover");
+const Brn WebSocket::kParamClientNoContextTakeover("client_no_context_takeover");
+const Brn WebSocket::kParamServerMaxWindowBits("server_max_window_bits");
+const Brn WebSocket::kParamClientMaxWindowBits("client_max_window_bits");
 
 
 // HttpHeaderUpgrade
@@ -224,6 +241,291 @@ void WsHeaderVersion::Process(const Brx& aValue)
 }
 
 
+// WsHeaderExtensions
+
+WsHeaderExtensions::WsHeaderExtensions()
+{
+    Reset();
+}
+
+TBool WsHeaderExtensions::PermessageDeflate() const
+{
+    return iPermessageDeflate;
+}
+
+TBool WsHeaderExtensions::ServerNoContextTakeover() const
+{
+    return iServerNoContextTakeover;
+}
+
+TBool WsHeaderExtensions::ClientNoContextTakeover() const
+{
+    return iClientNoContextTakeover;
+}
+
+TUint WsHeaderExtensions::ServerMaxWindowBits() const
+{
+    return iServerMaxWindowBits;
+}
+
+TBool WsHeaderExtensions::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, WebSocket::kHeaderExtensions);
+}
+
+void WsHeaderExtensions::Process(const Brx& aValue)
+{
+    SetReceived();
+    // offers are listed in order of client preference and may be split across several headers
+    Parser parser(aValue);
+    while (!iPermessageDeflate && !parser.Finished()) {
+        const Brn offer = parser.Next(',');
+        if (!ProcessOffer(offer)) {
+            iServerNoContextTakeover = false;
+            iClientNoContextTakeover = false;
+            iServerMaxWindowBits = 0;
+        }
+    }
+}
+
+void WsHeaderExtensions::Reset()
+{
+    HttpHeader::Reset();
+    iPermessageDeflate = false;
+    iServerNoContextTakeover = false;
+    iClientNoContextTakeover = false;
+    iServerMaxWindowBits = 0;
+}
+
+TBool WsHeaderExtensions::ProcessOffer(const Brx& aOffer)
+{
+    Parser parser(aOffer);
+    if (!Ascii::CaseInsensitiveEquals(parser.Next(';'), WebSocket::kValuePermessageDeflate)) {
+        return false;
+    }
+    while (!parser.Finished()) {
+        Parser param(parser.Next(';'));
+        const Brn name = param.Next('=');
+        Brn value = param.Remaining();
+        if (value.Bytes() >= 2 && value[0] == '"' && value[value.Bytes()-1] == '"') {
+            value.Set(value.Split(1, value.Bytes()-2));
+        }
+        if (Ascii::CaseInsensitiveEquals(name, WebSocket::kParamServerNoContextTakeover)) {
+            iServerNoContextTakeover = true;
+        }
+        else if (Ascii::CaseInsensitiveEquals(name, WebSocket::kParamClientNoContextTakeover)) {
+            iClientNoContextTakeover = true;
+        }
+        else if (Ascii::CaseInsensitiveEquals(name, WebSocket::kParamServerMaxWindowBits)) {
+            try {
+                iServerMaxWindowBits = Ascii::Uint(value);
+            }
+            catch (AsciiError&) {
+                return false;
+            }
+            // zlib can't produce raw deflate streams with an 8 bit window
+            if (iServerMaxWindowBits < 9 || iServerMaxWindowBits > WsDeflate::kMaxWindowBits) {
+                return false;
+            }
+        }
+        else if (Ascii::CaseInsensitiveEquals(name, WebSocket::kParamClientMaxWindowBits)) {
+            // we always inflate using the largest window so don't need to limit the client
+        }
+        else {
+            return false;
+        }
+    }
+    iPermessageDeflate = true;
+    return true;
+}
+
+
+// WsDeflate
+
+#ifdef DEFINE_ZLIB
+
+static const TByte kDeflateTail[] = { 0x00, 0x00, 0xff, 0xff };
+
+TBool WsDeflate::Supported()
+{ // static
+    return true;
+}
+
+WsDeflate::WsDeflate(Environment& aEnv, TUint aServerMaxWindowBits, TBool aServerContextTakeover, TBool aClientContextTakeover)
+    : iEnv(aEnv)
+    , iServerContextTakeover(aServerContextTakeover)
+    , iClientContextTakeover(aClientContextTakeover)
+    , iMessagesCompressed(0)
+    , iMessagesDecompressed(0)
+    , iBytesUncompressed(0)
+    , iBytesCompressed(0)
+    , iTimeUs(0)
+{
+    iDeflate = new z_stream;
+    (void)memset(iDeflate, 0, sizeof(*iDeflate));
+    int err = deflateInit2(iDeflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -(int)aServerMaxWindowBits, 8, Z_DEFAULT_STRATEGY);
+    ASSERT(err == Z_OK);
+    iInflate = new z_stream;
+    (void)memset(iInflate, 0, sizeof(*iInflate));
+    err = inflateInit2(iInflate, -(int)kMaxWindowBits);
+    ASSERT(err == Z_OK);
+}
+
+WsDeflate::~WsDeflate()
+{
+    (void)deflateEnd(iDeflate);
+    delete iDeflate;
+    (void)inflateEnd(iInflate);
+    delete iInflate;
+}
+
+void WsDeflate::Compress(const Brx& aData, Bwh& aCompressed)
+{
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    aCompressed.SetBytes(0);
+    const TUint bound = (TUint)deflateBound(iDeflate, aData.Bytes()) + 16; // allow for sync flush markers
+    if (aCompressed.MaxBytes() < bound) {
+        aCompressed.Grow(bound);
+    }
+    iDeflate->next_in = const_cast<Bytef*>(aData.Ptr());
+    iDeflate->avail_in = aData.Bytes();
+    for (;;) {
+        iDeflate->next_out = const_cast<Bytef*>(aCompressed.Ptr()) + aCompressed.Bytes();
+        iDeflate->avail_out = aCompressed.MaxBytes() - aCompressed.Bytes();
+        const int err = deflate(iDeflate, Z_SYNC_FLUSH);
+        ASSERT(err == Z_OK || err == Z_BUF_ERROR);
+        aCompressed.SetBytes(aCompressed.MaxBytes() - iDeflate->avail_out);
+        if (iDeflate->avail_out != 0) {
+            break;
+        }
+        aCompressed.Grow(aCompressed.MaxBytes() * 2);
+    }
+    // RFC 7692 s7.2.1: remove the empty stored block appended by the sync flush
+    ASSERT(aCompressed.Bytes() >= sizeof(kDeflateTail));
+    aCompressed.SetBytes(aCompressed.Bytes() - sizeof(kDeflateTail));
+    if (!iServerContextTakeover) {
+        (void)deflateReset(iDeflate);
+    }
+    iMessagesCompressed++;
+    iBytesUncompressed += aData.Bytes();
+    iBytesCompressed += aCompressed.Bytes();
+    iTimeUs += Os::TimeInUs(iEnv.OsCtx()) - start;
+}
+
+TBool WsDeflate::Decompress(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes)
+{
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    aData.SetBytes(0);
+    const Brn tail(kDeflateTail, sizeof(kDeflateTail));
+    TBool ok = Inflate(aCompressed, aData, aMaxBytes) && Inflate(tail, aData, aMaxBytes);
+    if (!ok || !iClientContextTakeover) {
+        (void)inflateReset(iInflate);
+    }
+    iMessagesDecompressed++;
+    iTimeUs += Os::TimeInUs(iEnv.OsCtx()) - start;
+    return ok;
+}
+
+TBool WsDeflate::Inflate(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes)
+{
+    iInflate->next_in = const_cast<Bytef*>(aCompressed.Ptr());
+    iInflate->avail_in = aCompressed.Bytes();
+    for (;;) {
+        if (aData.Bytes() == aData.MaxBytes()) {
+            if (aData.MaxBytes() >= aMaxBytes) {
+                return false;
+            }
+            const TUint grow = aData.MaxBytes() * 2;
+            aData.Grow(grow < aMaxBytes? grow : aMaxBytes);
+        }
+        iInflate->next_out = const_cast<Bytef*>(aData.Ptr()) + aData.Bytes();
+        iInflate->avail_out = aData.MaxBytes() - aData.Bytes();
+        const int err = inflate(iInflate, Z_SYNC_FLUSH);
+        aData.SetBytes(aData.MaxBytes() - iInflate->avail_out);
+        if (err == Z_STREAM_END) {
+            // client set BFINAL; any further data starts a new stream
+            (void)inflateReset(iInflate);
+        }
+        else if (err != Z_OK && !(err == Z_BUF_ERROR && iInflate->avail_in == 0)) {
+            return false;
+        }
+        if (iInflate->avail_in == 0 && iInflate->avail_out > 0) {
+            break;
+        }
+    }
+    return true;
+}
+
+#else // DEFINE_ZLIB
+
+TBool WsDeflate::Supported()
+{ // static
+    return false;
+}
+
+WsDeflate::WsDeflate(Environment& aEnv, TUint /*aServerMaxWindowBits*/, TBool aServerContextTakeover, TBool aClientContextTakeover)
+    : iEnv(aEnv)
+    , iServerContextTakeover(aServerContextTakeover)
+    , iClientContextTakeover(aClientContextTakeover)
+    , iDeflate(NULL)
+    , iInflate(NULL)
+    , iMessagesCompressed(0)
+    , iMessagesDecompressed(0)
+    , iBytesUncompressed(0)
+    , iBytesCompressed(0)
+    , iTimeUs(0)
+{
+    ASSERTS(); // callers must check Supported()
+}
+
+WsDeflate::~WsDeflate()
+{
+}
+
+void WsDeflate::Compress(const Brx& /*aData*/, Bwh& /*aCompressed*/)
+{
+    ASSERTS();
+}
+
+TBool WsDeflate::Decompress(const Brx& /*aCompressed*/, Bwh& /*aData*/, TUint /*aMaxBytes*/)
+{
+    ASSERTS();
+    return false;
+}
+
+TBool WsDeflate::Inflate(const Brx& /*aCompressed*/, Bwh& /*aData*/, TUint /*aMaxBytes*/)
+{
+    return false;
+}
+
+#endif // DEFINE_ZLIB
+
+TUint WsDeflate::MessagesCompressed() const
+{
+    return iMessagesCompressed;
+}
+
+TUint WsDeflate::MessagesDecompressed() const
+{
+    return iMessagesDecompressed;
+}
+
+TUint64 WsDeflate::BytesUncompressed() const
+{
+    return iBytesUncompressed;
+}
+
+TUint64 WsDeflate::BytesCompressed() const
+{
+    return iBytesCompressed;
+}
+
+TUint64 WsDeflate::TimeUs() const
+{
+    return iTimeUs;
+}
+
+
 // PropertyWriterWs
 
 PropertyWriterWs* PropertyWriterWs::Create(DviSessionWebSocket& aSession, const Brx& aSid, TUint aSequenceNumber)
@@ -345,30 +647,57 @@ void WsProtocol76::Close()
 
 // WsProtocol80
 
-WsProtocol80::WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer)
+WsProtocol80::WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer, WsDeflate* aDeflate)
     : WsProtocol(aReaderUntil, aWriteBuffer)
-    , iReaderProtocol(aReaderUntil)
+    , iDeflate(aDeflate)
+    , iMessageInProgress(false)
+    , iMessageCompressed(false)
 {
 }
 
+void WsProtocol80::Unmask(TByte* aData, TUint aBytes, const TByte* aMask, TUint aMaskOffset)
+{ // static
+    TByte mask[8];
+    for (TUint i=0; i<sizeof(mask); i++) {
+        mask[i] = aMask[(aMaskOffset + i) & 3];
+    }
+    // xor a word at a time; memcpy avoids alignment/aliasing problems and compiles to plain loads/stores
+    TUint64 mask64;
+    (void)memcpy(&mask64, mask, sizeof(mask64));
+    TUint i = 0;
+    for (; i + 2*sizeof(TUint64) <= aBytes; i += 2*sizeof(TUint64)) {
+        TUint64 words[2];
+        (void)memcpy(words, aData + i, sizeof(words));
+        words[0] ^= mask64;
+        words[1] ^= mask64;
+        (void)memcpy(aData + i, words, sizeof(words));
+    }
+    for (; i<aBytes; i++) {
+        aData[i] ^= mask[i & 3];
+    }
+}
+
 void WsProtocol80::Read(Brn& aData, TBool& aClosed)
 {
     aData.Set(NULL, 0);
     aClosed = false;
 
     static const TByte kBitMaskFinalFragment = 1<<7;
+    static const TByte kBitMaskRsv1          = 0x40;
     static const TByte kBitMaskRsv123        = 0x70;
     static const TByte kBitMaskOpcode        = 0xf;
     static const TByte kBitMaskPayloadMask   = 1<<7;
     static const TByte kBitMaskPayloadLen    = 0x7f;
+    static const TUint kMaxControlPayloadBytes = 125;
 
     // validate framing
-    Bws<2> ctrl;
-    ctrl.Append(iReaderProtocol.Read(2));
-    const TByte& byte0 = ctrl.At(0);
-    const TByte& byte1 = ctrl.At(1);
+    Brn ctrl = iReaderUntil.ReadProtocol(2);
+    const TByte byte0 = ctrl[0];
+    const TByte byte1 = ctrl[1];
     const TBool fragment = ((byte0 & kBitMaskFinalFragment) == 0);
-    if (byte0 & kBitMaskRsv123) {
+    // permessage-deflate sets RSV1 on the first frame of a compressed text message only
+    const TBool compressed = (iDeflate != NULL && (byte0 & kBitMaskOpcode) == eText && (byte0 & kBitMaskRsv1) != 0);
+    if ((byte0 & kBitMaskRsv123) != (compressed? kBitMaskRsv1 : 0)) {
         LOG_ERROR(kDvWebSocket, "WS: RSV bit(s) set - %u - but no extension negotiated\n", (byte0 & kBitMaskRsv123) >> 4);
         Close(kCloseProtocolError);
         aClosed = true;
@@ -384,16 +713,29 @@ void WsProtocol80::Read(Brn& aData, TBool& aClosed)
     switch (opcode)
     {
     case eContinuation:
-        // test for already having stored some data from a previous text (non-final) message??
+        if (!iMessageInProgress) {
+            LOG_ERROR(kDvWebSocket, "WS: continuation frame without preceding fragment\n");
+            Close(kCloseProtocolError);
+            aClosed = true;
+            return;
+        }
         break;
     case eText:
+        if (iMessageInProgress) {
+            LOG_ERROR(kDvWebSocket, "WS: text frame interrupts fragmented message\n");
+            Close(kCloseProtocolError);
+            aClosed = true;
+            return;
+        }
+        iMessage.SetBytes(0);
+        iMessageCompressed = compressed;
         break;
     case eClose:
         aClosed = true;
         return;
     case ePing:
     case ePong:
-        if (fragment) {
+        if (fragment || (byte1 & kBitMaskPayloadLen) > kMaxControlPayloadBytes) {
             Close(kCloseProtocolError);
             aClosed = true;
             return;
@@ -412,50 +754,70 @@ void WsProtocol80::Read(Brn& aData, TBool& aClosed)
     }
 
     // calculate payload length
-    TUint32 payloadLen = byte1 & kBitMaskPayloadLen;
+    TUint64 payloadLen = byte1 & kBitMaskPayloadLen;
     if (payloadLen == 0x7f) {
         ReaderBinary rb(iReaderUntil);
-        payloadLen = (TUint32)rb.ReadUint64Be(8);
+        payloadLen = rb.ReadUint64Be(8);
     }
     else if (payloadLen == 0x7e) {
         ReaderBinary rb(iReaderUntil);
         payloadLen = rb.ReadUintBe(2);
     }
-    if (payloadLen > DviSessionWebSocket::kMaxRequestBytes) {
+    if (payloadLen > kMaxMessageBytes - iMessage.Bytes()) {
         // larger message than we expect to handle - close the socket
         Close(kCloseMsgTooLong);
         aClosed = true;
         return;
     }
+    const TUint bytes = (TUint)payloadLen;
 
     // read/decode payload
     // decoding is in-place since we'll have no future use for the original data after decoding it
-    Bws<4> mask;
-    mask.Append(iReaderProtocol.Read(4));
-    Brn maskedData = iReaderProtocol.Read(payloadLen);
-    Bwn data(maskedData.Ptr(), maskedData.Bytes());
-    for (TUint i=0; i<maskedData.Bytes(); i++) {
-        data.Append((TByte)(maskedData[i] ^ mask[i%4]));
+    TByte mask[4];
+    (void)memcpy(mask, iReaderUntil.ReadProtocol(sizeof(mask)).Ptr(), sizeof(mask));
+    Brn data;
+    const TBool dataFrame = (opcode == eText || opcode == eContinuation);
+    if (dataFrame && (fragment || iMessageInProgress || bytes > DviSessionWebSocket::kMaxRequestBytes)) {
+        // fragmented or too large for the read buffer - stream directly into iMessage
+        const TUint offset = iMessage.Bytes();
+        iMessage.Grow(offset + bytes);
+        TUint remaining = bytes;
+        while (remaining > 0) {
+            Brn buf = iReaderUntil.Read(remaining);
+            if (buf.Bytes() == 0) {
+                THROW(ReaderError);
+            }
+            iMessage.Append(buf);
+            remaining -= buf.Bytes();
+        }
+        Unmask(const_cast<TByte*>(iMessage.Ptr()) + offset, bytes, mask, 0);
+        data.Set(iMessage);
+    }
+    else {
+        data.Set(iReaderUntil.ReadProtocol(bytes));
+        Unmask(const_cast<TByte*>(data.Ptr()), bytes, mask, 0);
     }
 
     // now, finally, process the message
     switch (opcode)
     {
     case eText:
-        iMessage.SetBytes(0);
-        // fallthrough
     case eContinuation:
-        if (iMessage.Bytes() > 0 || fragment) {
-            iMessage.Grow(iMessage.Bytes() + data.Bytes());
-            iMessage.Append(data);
-        }
+        iMessageInProgress = fragment;
         if (!fragment) {
-            if (iMessage.Bytes() > 0) {
-                aData.Set(iMessage);
-            }
-            else {
-                aData.Set(data);
+            Brn msg(data);
+            if (iMessageCompressed) {
+                if (!iDeflate->Decompress(msg, iDecompressed, kMaxMessageBytes)) {
+                    // only a message that inflates beyond our limit is too long; anything else is corrupt
+                    const TBool tooLong = (iDecompressed.Bytes() >= kMaxMessageBytes);
+                    LOG_ERROR(kDvWebSocket, "WS: failed to decompress message (%s)\n", (tooLong? "too long" : "corrupt"));
+                    Close(tooLong? kCloseMsgTooLong : kCloseProtocolError);
+                    aClosed = true;
+                    return;
+                }
+                msg.Set(iDecompressed);
             }
+            aData.Set(msg);
         }
         break;
     case ePing:
@@ -473,7 +835,13 @@ void WsProtocol80::Read(Brn& aData, TBool& aClosed)
 
 void WsProtocol80::Write(const Brx& aData)
 {
-    Write(eText, aData);
+    if (iDeflate == NULL) {
+        Write(eText, aData);
+    }
+    else {
+        iDeflate->Compress(aData, iCompressed);
+        Write(eText, iCompressed, true);
+    }
 }
 
 void WsProtocol80::Close()
@@ -481,9 +849,12 @@ void WsProtocol80::Close()
     Close(kCloseNormal);
 }
 
-void WsProtocol80::Write(WsOpcode aOpcode, const Brx& aData)
+void WsProtocol80::Write(WsOpcode aOpcode, const Brx& aData, TBool aCompressed)
 {
     TByte b = 0x80 | (TByte)aOpcode;
+    if (aCompressed) {
+        b |= 0x40; // RSV1
+    }
     iWriteBuffer.Write(b);
     const TUint dataLen = aData.Bytes();
     if (dataLen < 126) {
@@ -526,11 +897,18 @@ void WsProtocol80::Close(TUint16 aCode)
 
 DviSessionWebSocket::DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterface, TUint aPort)
     : iDvStack(aDvStack)
+    , iAdapter(aInterface)
     , iEndpoint(aPort, aInterface)
+    , iProtocol(NULL)
+    , iDeflate(NULL)
     , iExit(false)
     , iInterruptLock("WSIM")
     , iShutdownSem("WSIS", 1)
     , iPropertyUpdates(kMaxPropertyUpdates)
+    , iInvocationDevice(NULL)
+    , iInvocationVersion(0)
+    , iInvocationResponseStarted(false)
+    , iInvocationWriter(kInvocationWriteGranularity)
 {
     iReadBuffer = new Srs<1024>(*this);
     iReaderUntil = new ReaderUntilS<kMaxRequestBytes>(*iReadBuffer);
@@ -549,7 +927,9 @@ DviSessionWebSocket::DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterfac
     iReaderRequest->AddHeader(iHeaderOrigin);
     iReaderRequest->AddHeader(iHeadverKeyV8);
     iReaderRequest->AddHeader(iHeaderVersion);
+    iReaderRequest->AddHeader(iHeaderExtensions);
     iReaderRequest->AddHeader(iHeaderContentLength);
+    iReaderRequest->AddHeader(iHeaderUserAgent);
 }
 
 DviSessionWebSocket::~DviSessionWebSocket()
@@ -641,6 +1021,11 @@ void DviSessionWebSocket::Run()
         }
         delete iProtocol;
         iProtocol = NULL;
+        if (iDeflate != NULL) {
+            LogDeflateStats();
+            delete iDeflate;
+            iDeflate = NULL;
+        }
         while (iPropertyUpdates.SlotsUsed() > 0) {
             delete iPropertyUpdates.Read();
         }
@@ -785,9 +1170,37 @@ WsProtocol* DviSessionWebSocket::Handshake80()
     stream = iWriterResponse->WriteHeaderField(Brn("Sec-WebSocket-Protocol"));
     stream.Write(iHeaderProtocol.Protocol());
     stream.WriteFlush();
+    TBool contextTakeover;
+    if (iHeaderExtensions.PermessageDeflate() && WsDeflate::Supported() &&
+        iDvStack.Env().InitParams()->DvWebSocketDeflate(contextTakeover)) {
+        const TBool serverContextTakeover = contextTakeover && !iHeaderExtensions.ServerNoContextTakeover();
+        const TBool clientContextTakeover = contextTakeover && !iHeaderExtensions.ClientNoContextTakeover();
+        TUint windowBits = iHeaderExtensions.ServerMaxWindowBits();
+        stream = iWriterResponse->WriteHeaderField(WebSocket::kHeaderExtensions);
+        stream.Write(WebSocket::kValuePermessageDeflate);
+        if (!serverContextTakeover) {
+            stream.Write(Brn("; "));
+            stream.Write(WebSocket::kParamServerNoContextTakeover);
+        }
+        if (!clientContextTakeover) {
+            stream.Write(Brn("; "));
+            stream.Write(WebSocket::kParamClientNoContextTakeover);
+        }
+        if (windowBits != 0) {
+            stream.Write(Brn("; "));
+            stream.Write(WebSocket::kParamServerMaxWindowBits);
+            stream.Write('=');
+            stream.WriteUint(windowBits);
+        }
+        else {
+            windowBits = WsDeflate::kMaxWindowBits;
+        }
+        stream.WriteFlush();
+        iDeflate = new WsDeflate(iDvStack.Env(), windowBits, serverContextTakeover, clientContextTakeover);
+    }
     iWriterResponse->WriteFlush();
 
-    return new WsProtocol80(*iReaderUntil, *iWriterBuffer);
+    return new WsProtocol80(*iReaderUntil, *iWriterBuffer, iDeflate);
 }
 
 void DviSessionWebSocket::DoRead()
@@ -814,6 +1227,9 @@ void DviSessionWebSocket::DoRead()
         else if (method == WebSocket::kMethodRenew) {
             Renew(data);
         }
+        else if (method == WebSocket::kMethodInvoke) {
+            Invoke(data);
+        }
         else {
             THROW(WebSocketError);
         }
@@ -908,6 +1324,76 @@ void DviSessionWebSocket::Renew(const Brx& aRequest)
     WriteSubscriptionRenewed(wrapper->Sid(), timeout);
 }
 
+void DviSessionWebSocket::Invoke(const Brx& aRequest)
+{
+    iInvocationId.Set(XmlParserBasic::Find(WebSocket::kTagId, aRequest));
+    Brn udn = XmlParserBasic::Find(WebSocket::kTagUdn, aRequest);
+    Brn serviceId = XmlParserBasic::Find(WebSocket::kTagService, aRequest);
+    iInvocationAction.Set(XmlParserBasic::Find(WebSocket::kTagAction, aRequest));
+    try {
+        iInvocationArgs.Set(XmlParserBasic::Find(WebSocket::kTagArgs, aRequest));
+    }
+    catch (XmlError&) {
+        iInvocationArgs.Set(Brx::Empty());
+    }
+    LOG(kDvWebSocket, "WS: Invoke %.*s (id %.*s)\n", PBUF(iInvocationAction), PBUF(iInvocationId));
+
+    // serviceId is domain-Name-Version, matching the SERVICE tag used by Subscribe
+    Parser parser(serviceId);
+    (void)parser.Next('-');
+    (void)parser.Next('-');
+    try {
+        iInvocationVersion = Ascii::Uint(parser.Remaining());
+    }
+    catch (AsciiError&) {
+        WriteInvokeFailed(404, Brn("Service not found"));
+        return;
+    }
+    DviDevice* device = iDvStack.DeviceMap().Find(udn);
+    if (device == NULL) {
+        WriteInvokeFailed(404, Brn("Device not found"));
+        return;
+    }
+    AutoDeviceRef d(device);
+    DviService* service = device->ServiceReference(serviceId);
+    if (service == NULL) {
+        WriteInvokeFailed(404, Brn("Service not found"));
+        return;
+    }
+    AutoServiceRef s(service);
+    iInvocationDevice = device;
+    iInvocationResponseStarted = false;
+    try {
+        service->Invoke(*this, iInvocationAction);
+    }
+    catch (InvocationError&) {}
+    iInvocationDevice = NULL;
+    iInvocationArgs.Set(Brx::Empty());
+}
+
+void DviSessionWebSocket::WriteInvokeFailed(TUint aCode, const Brx& aDescription)
+{
+    LOG(kDvWebSocket, "WS: Invoke %.*s failed - %u\n", PBUF(iInvocationAction), aCode);
+    iInvocationWriter.Reset();
+    iInvocationWriter.Write(Brn("<?xml version=\"1.0\"?>"));
+    iInvocationWriter.Write(Brn("<root>"));
+    WriteTag(iInvocationWriter, WebSocket::kTagMethod, WebSocket::kMethodInvokeFailed);
+    WriteTag(iInvocationWriter, WebSocket::kTagId, iInvocationId);
+    Bws<Ascii::kMaxUintStringBytes> code;
+    (void)Ascii::AppendDec(code, aCode);
+    WriteTag(iInvocationWriter, WebSocket::kTagCode, code);
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write(WebSocket::kTagDescription);
+    iInvocationWriter.Write('>');
+    Converter::ToXmlEscaped(iInvocationWriter, aDescription);
+    iInvocationWriter.Write(Brn("</"));
+    iInvocationWriter.Write(WebSocket::kTagDescription);
+    iInvocationWriter.Write('>');
+    iInvocationWriter.Write(Brn("</root>"));
+    iProtocol->Write(iInvocationWriter.Buffer());
+    iInvocationWriter.Reset();
+}
+
 void DviSessionWebSocket::WriteSubscriptionSid(const Brx& aDevice, const Brx& aService, const Brx& aSid, TUint aSeconds)
 {
     WriterBwh writer(1024);
@@ -954,6 +1440,17 @@ void DviSessionWebSocket::WritePropertyUpdates()
     }
 }
 
+void DviSessionWebSocket::LogDeflateStats()
+{
+    const TUint64 bytesIn = iDeflate->BytesUncompressed();
+    const TUint64 bytesOut = iDeflate->BytesCompressed();
+    // small messages can grow when compressed so savedPercent may be negative
+    const TInt savedPercent = (bytesIn == 0? 0 : (TInt)((((TInt64)bytesIn - (TInt64)bytesOut) * 100) / (TInt64)bytesIn));
+    LOG(kDvWebSocket, "WS: permessage-deflate - sent %u msgs, %llu bytes compressed to %llu (%d%% saved), received %u msgs, %llu us cpu\n",
+                      iDeflate->MessagesCompressed(), bytesIn, bytesOut, savedPercent,
+                      iDeflate->MessagesDecompressed(), iDeflate->TimeUs());
+}
+
 IPropertyWriter* DviSessionWebSocket::ClaimWriter(const IDviSubscriptionUserData* /*aUserData*/, const Brx& aSid, TUint aSequenceNumber)
 {
     return PropertyWriterWs::Create(*this, aSid, aSequenceNumber);
@@ -964,6 +1461,16 @@ void DviSessionWebSocket::ReleaseWriter(IPropertyWriter* aWriter)
     delete aWriter;
 }
 
+IPropertyEncoder* DviSessionWebSocket::PropertyEncoder()
+{
+    return &PropertyWriter::Encoder();
+}
+
+void DviSessionWebSocket::PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded)
+{
+    static_cast<PropertyWriterWs&>(aWriter).WriteEncoded(aEncoded);
+}
+
 void DviSessionWebSocket::NotifySubscriptionCreated(const Brx& /*aSid*/)
 {
 }
@@ -981,6 +1488,256 @@ void DviSessionWebSocket::LogUserData(IWriter& /*aWriter*/, const IDviSubscripti
 }
 
 
+void DviSessionWebSocket::Invoke()
+{
+    // never called - DviService::Invoke calls back via the functor registered for each action
+    ASSERTS();
+}
+
+TUint DviSessionWebSocket::Version() const
+{
+    return iInvocationVersion;
+}
+
+const TIpAddress& DviSessionWebSocket::Adapter() const
+{
+    return iAdapter;
+}
+
+const char* DviSessionWebSocket::ResourceUriPrefix() const
+{
+    // resources are served by the UPnP server rather than over this socket
+    iResourceUriPrefix.SetBytes(0);
+    iResourceUriPrefix.Append("http://");
+    Endpoint ep(iDvStack.ServerUpnp().Port(iAdapter), iAdapter);
+    ep.AppendEndpoint(iResourceUriPrefix);
+    iResourceUriPrefix.Append("/");
+    iResourceUriPrefix.Append(iInvocationDevice->Udn());
+    iResourceUriPrefix.Append("/");
+    iResourceUriPrefix.Append("Upnp");
+    iResourceUriPrefix.Append("/");
+    iResourceUriPrefix.Append("resource");
+    iResourceUriPrefix.Append("/");
+    iResourceUriPrefix.PtrZ();
+    return (const char*)iResourceUriPrefix.Ptr();
+}
+
+Endpoint DviSessionWebSocket::ClientEndpoint() const
+{
+    Endpoint ep(SocketTcpSession::ClientEndpoint());
+    return ep;
+}
+
+const Brx& DviSessionWebSocket::ClientUserAgent() const
+{
+    if (!iHeaderUserAgent.Received()) {
+        return Brx::Empty();
+    }
+    return iHeaderUserAgent.UserAgent();
+}
+
+void DviSessionWebSocket::InvocationReadStart()
+{
+}
+
+TBool DviSessionWebSocket::InvocationReadBool(const TChar* aName)
+{
+    try {
+        Brn value = XmlParserBasic::Find(aName, iInvocationArgs);
+        try {
+            TUint num = Ascii::Uint(value);
+            return (num != 0);
+        }
+        catch (AsciiError&) {
+            if (value == Brn("true")) {
+                return true;
+            }
+            else if (value == Brn("false")) {
+                return false;
+            }
+            THROW(XmlError);
+        }
+    }
+    catch (XmlError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+    return false;
+}
+
+void DviSessionWebSocket::InvocationReadString(const TChar* aName, Brhz& aString)
+{
+    try {
+        Brn value = XmlParserBasic::Find(aName, iInvocationArgs);
+        Bwh writable(value.Bytes()+1);
+        if (value.Bytes()) {
+            writable.Append(value);
+            Converter::FromXmlEscaped(writable);
+        }
+        writable.PtrZ();
+        writable.TransferTo(aString);
+    }
+    catch (XmlError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+}
+
+TInt DviSessionWebSocket::InvocationReadInt(const TChar* aName)
+{
+    try {
+        Brn value = XmlParserBasic::Find(aName, iInvocationArgs);
+        return Ascii::Int(value);
+    }
+    catch (XmlError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+    catch (AsciiError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+    return 0;
+}
+
+TUint DviSessionWebSocket::InvocationReadUint(const TChar* aName)
+{
+    try {
+        Brn value = XmlParserBasic::Find(aName, iInvocationArgs);
+        return Ascii::Uint(value);
+    }
+    catch (XmlError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+    catch (AsciiError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+    return 0;
+}
+
+void DviSessionWebSocket::InvocationReadBinary(const TChar* aName, Brh& aData)
+{
+    try {
+        Brn value = XmlParserBasic::Find(aName, iInvocationArgs);
+        if (value.Bytes()) {
+            Bwh writable(value.Bytes()+1);
+            writable.Append(value);
+            Converter::FromBase64(writable);
+            writable.TransferTo(aData);
+        }
+    }
+    catch (XmlError&) {
+        InvocationReportError(402, Brn("Invalid Args"));
+    }
+}
+
+void DviSessionWebSocket::InvocationReadEnd()
+{
+    iInvocationArgs.Set(Brx::Empty());
+}
+
+void DviSessionWebSocket::InvocationReportError(TUint aCode, const Brx& aDescription)
+{
+    // any partially written response is discarded; the client only sees the failure
+    iInvocationResponseStarted = false;
+    WriteInvokeFailed(aCode, aDescription);
+    THROW(InvocationError);
+}
+
+void DviSessionWebSocket::InvocationWriteStart()
+{
+    iInvocationResponseStarted = true;
+    iInvocationWriter.Reset();
+    iInvocationWriter.Write(Brn("<?xml version=\"1.0\"?>"));
+    iInvocationWriter.Write(Brn("<root>"));
+    WriteTag(iInvocationWriter, WebSocket::kTagMethod, WebSocket::kMethodInvokeCompleted);
+    WriteTag(iInvocationWriter, WebSocket::kTagId, iInvocationId);
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write(WebSocket::kTagArgs);
+    iInvocationWriter.Write('>');
+}
+
+void DviSessionWebSocket::InvocationWriteBool(const TChar* aName, TBool aValue)
+{
+    WriteTag(iInvocationWriter, Brn(aName), aValue? Brn("1") : Brn("0"));
+}
+
+void DviSessionWebSocket::InvocationWriteInt(const TChar* aName, TInt aValue)
+{
+    Bws<Ascii::kMaxIntStringBytes> val;
+    (void)Ascii::AppendDec(val, aValue);
+    WriteTag(iInvocationWriter, Brn(aName), val);
+}
+
+void DviSessionWebSocket::InvocationWriteUint(const TChar* aName, TUint aValue)
+{
+    Bws<Ascii::kMaxUintStringBytes> val;
+    (void)Ascii::AppendDec(val, aValue);
+    WriteTag(iInvocationWriter, Brn(aName), val);
+}
+
+void DviSessionWebSocket::InvocationWriteBinaryStart(const TChar* aName)
+{
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write(Brn(aName));
+    iInvocationWriter.Write('>');
+}
+
+void DviSessionWebSocket::InvocationWriteBinary(TByte aValue)
+{
+    Brn buf(&aValue, 1);
+    InvocationWriteBinary(buf);
+}
+
+void DviSessionWebSocket::InvocationWriteBinary(const Brx& aValue)
+{
+    Converter::ToBase64(iInvocationWriter, aValue);
+}
+
+void DviSessionWebSocket::InvocationWriteBinaryEnd(const TChar* aName)
+{
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write('/');
+    iInvocationWriter.Write(Brn(aName));
+    iInvocationWriter.Write('>');
+}
+
+void DviSessionWebSocket::InvocationWriteStringStart(const TChar* aName)
+{
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write(Brn(aName));
+    iInvocationWriter.Write('>');
+}
+
+void DviSessionWebSocket::InvocationWriteString(TByte aValue)
+{
+    Brn buf(&aValue, 1);
+    InvocationWriteString(buf);
+}
+
+void DviSessionWebSocket::InvocationWriteString(const Brx& aValue)
+{
+    Converter::ToXmlEscaped(iInvocationWriter, aValue);
+}
+
+void DviSessionWebSocket::InvocationWriteStringEnd(const TChar* aName)
+{
+    iInvocationWriter.Write('<');
+    iInvocationWriter.Write('/');
+    iInvocationWriter.Write(Brn(aName));
+    iInvocationWriter.Write('>');
+}
+
+void DviSessionWebSocket::InvocationWriteEnd()
+{
+    if (!iInvocationResponseStarted) {
+        return;
+    }
+    iInvocationResponseStarted = false;
+    iInvocationWriter.Write(Brn("</"));
+    iInvocationWriter.Write(WebSocket::kTagArgs);
+    iInvocationWriter.Write('>');
+    iInvocationWriter.Write(Brn("</root>"));
+    iProtocol->Write(iInvocationWriter.Buffer());
+    iInvocationWriter.Reset();
+}
+
 // DviSessionWebSocket::SubscriptionWrapper
 
 DviSessionWebSocket::SubscriptionWrapper::SubscriptionWrapper(DviSubscription& aSubscription, const Brx& aSid, DviService& aService)
@@ -1007,6 +1764,11 @@ DviServerWebSocket::DviServerWebSocket(DvStack& aDvStack)
 {
 }
 
+DviServerWebSocket::~DviServerWebSocket()
+{
+    Deinitialise();
+}
+
 void DviServerWebSocket::Start()
 {
     if (iDvStack.Env().InitParams()->DvNumWebSocketThreads() > 0) {
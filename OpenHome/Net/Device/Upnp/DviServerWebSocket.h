@@ -12,11 +12,14 @@
 #include <OpenHome/Exception.h>
 #include <OpenHome/Private/Fifo.h>
 #include <OpenHome/Net/Private/DviSubscription.h>
+#include <OpenHome/Net/Private/DviService.h>
 
 #include <map>
 
 EXCEPTION(WebSocketError)
 
+struct z_stream_s;
+
 namespace OpenHome {
 namespace Net {
 
@@ -29,6 +32,7 @@ public:
     static const Brn kHeaderLocation;
     static const Brn kHeaderKey;
     static const Brn kHeaderVersion;
+    static const Brn kHeaderExtensions;
     static const Brn kUpgradeWebSocket;
     static const Brn kTagRoot;
     static const Brn kTagMethod;
@@ -41,6 +45,11 @@ public:
     static const Brn kTagSubscription;
     static const Brn kTagSeq;
     static const Brn kTagClientId;
+    static const Brn kTagId;
+    static const Brn kTagAction;
+    static const Brn kTagArgs;
+    static const Brn kTagCode;
+    static const Brn kTagDescription;
     static const Brn kMethodSubscribe;
     static const Brn kMethodUnsubscribe;
     static const Brn kMethodRenew;
@@ -48,9 +57,17 @@ public:
     static const Brn kMethodSubscriptionRenewed;
     static const Brn kMethodGetPropertyUpdates;
     static const Brn kMethodPropertyUpdate;
+    static const Brn kMethodInvoke;
+    static const Brn kMethodInvokeCompleted;
+    static const Brn kMethodInvokeFailed;
     static const Brn kValueProtocol;
     static const Brn kValueNt;
     static const Brn kValuePropChange;
+    static const Brn kValuePermessageDeflate;
+    static const Brn kParamServerNoContextTakeover;
+    static const Brn kParamClientNoContextTakeover;
+    static const Brn kParamServerMaxWindowBits;
+    static const Brn kParamClientMaxWindowBits;
 };
 
 class HttpHeaderUpgrade : public HttpHeader
@@ -134,6 +151,63 @@ private:
     TUint iVersion;;
 };
 
+/**
+ * Sec-WebSocket-Extensions request header.
+ * Selects the first permessage-deflate (RFC 7692) offer whose parameters we understand.
+ */
+class WsHeaderExtensions : public HttpHeader
+{
+public:
+    WsHeaderExtensions();
+    TBool PermessageDeflate() const;
+    TBool ServerNoContextTakeover() const;
+    TBool ClientNoContextTakeover() const;
+    TUint ServerMaxWindowBits() const; // 0 if not requested
+private:
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+    void Reset();
+    TBool ProcessOffer(const Brx& aOffer);
+private:
+    TBool iPermessageDeflate;
+    TBool iServerNoContextTakeover;
+    TBool iClientNoContextTakeover;
+    TUint iServerMaxWindowBits;
+};
+
+/**
+ * permessage-deflate compression state for a single WebSocket session.
+ * Only functional when built with zlib (DEFINE_ZLIB); Supported() reports this.
+ */
+class WsDeflate : private INonCopyable
+{
+public:
+    static const TUint kMaxWindowBits = 15;
+    static TBool Supported();
+    WsDeflate(Environment& aEnv, TUint aServerMaxWindowBits, TBool aServerContextTakeover, TBool aClientContextTakeover);
+    ~WsDeflate();
+    void Compress(const Brx& aData, Bwh& aCompressed);
+    TBool Decompress(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes); // false if corrupt or larger than aMaxBytes
+    TUint MessagesCompressed() const;
+    TUint MessagesDecompressed() const;
+    TUint64 BytesUncompressed() const;
+    TUint64 BytesCompressed() const;
+    TUint64 TimeUs() const;
+private:
+    TBool Inflate(const Brx& aCompressed, Bwh& aData, TUint aMaxBytes);
+private:
+    Environment& iEnv;
+    TBool iServerContextTakeover;
+    TBool iClientContextTakeover;
+    z_stream_s* iDeflate;
+    z_stream_s* iInflate;
+    TUint iMessagesCompressed;
+    TUint iMessagesDecompressed;
+    TUint64 iBytesUncompressed;
+    TUint64 iBytesCompressed;
+    TUint64 iTimeUs;
+};
+
 class DviSessionWebSocket;
 
 class PropertyWriterWs : public PropertyWriter
@@ -183,9 +257,14 @@ private:
 
 class WsProtocol80 : public WsProtocol
 {
-    static const TUint kMaxRequestBytes = 4*1024;
+    static const TUint kMaxMessageBytes = 64*1024;
 public:
-    WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer);
+    WsProtocol80(ReaderUntil& aReaderUntil, Swx& aWriteBuffer, WsDeflate* aDeflate);
+    /**
+     * Unmask (or mask) aBytes of client frame payload in place.
+     * aMaskOffset is the index into the 4 byte aMask of aData[0].
+     */
+    static void Unmask(TByte* aData, TUint aBytes, const TByte* aMask, TUint aMaskOffset);
 private:
     void Read(Brn& aData, TBool& aClosed);
     void Write(const Brx& aData);
@@ -205,16 +284,28 @@ private:
     static const TUint16 kCloseUnsupportedData = 1003;
     static const TUint16 kCloseMsgTooLong      = 1004;
 private:
-    void Write(WsOpcode aOpcode, const Brx& aData);
+    void Write(WsOpcode aOpcode, const Brx& aData, TBool aCompressed = false);
     void Close(TUint16 aCode);
 private:
-    Bwh iMessage;
-    ReaderProtocolS<kMaxRequestBytes> iReaderProtocol;
+    Bwh iMessage; // fragmented or large messages
+    WsDeflate* iDeflate; // not owned; NULL unless permessage-deflate was negotiated
+    TBool iMessageInProgress;
+    TBool iMessageCompressed;
+    Bwh iCompressed;
+    Bwh iDecompressed;
 };
 
 class DviService;
+class DviDevice;
 
-class DviSessionWebSocket : public SocketTcpSession, private IPropertyWriterFactory
+/**
+ * Serves one WebSocket client: event subscriptions plus action invocations.
+ *
+ * Invoke requests carry a client-chosen ID which is echoed in the matching
+ * InvokeCompleted/InvokeFailed response.  Requests are processed in the order
+ * they arrive so clients may pipeline several before reading any response.
+ */
+class DviSessionWebSocket : public SocketTcpSession, private IPropertyWriterFactory, private IDviInvocation
 {
 public:
     DviSessionWebSocket(DvStack& aDvStack, TIpAddress aInterface, TUint aPort);
@@ -240,17 +331,50 @@ private:
     void Subscribe(const Brx& aRequest);
     void Unsubscribe(const Brx& aRequest);
     void Renew(const Brx& aRequest);
+    void Invoke(const Brx& aRequest);
+    void WriteInvokeFailed(TUint aCode, const Brx& aDescription);
     void WriteSubscriptionSid(const Brx& aDevice, const Brx& aService, const Brx& aSid, TUint aSeconds);
     void WriteSubscriptionRenewed(const Brx& aSid, TUint aSeconds);
     void WritePropertyUpdates();
+    void LogDeflateStats();
 private: // IPropertyWriterFactory
     IPropertyWriter* ClaimWriter(const IDviSubscriptionUserData* aUserData,
                                  const Brx& aSid, TUint aSequenceNumber);
     void ReleaseWriter(IPropertyWriter* aWriter);
+    IPropertyEncoder* PropertyEncoder();
+    void PropertyWriteEncoded(IPropertyWriter& aWriter, const Brx& aEncoded);
     void NotifySubscriptionCreated(const Brx& aSid);
     void NotifySubscriptionDeleted(const Brx& aSid);
     void NotifySubscriptionExpired(const Brx& aSid);
     void LogUserData(IWriter& aWriter, const IDviSubscriptionUserData& aUserData);
+private: // IDviInvocation
+    void Invoke();
+    TUint Version() const;
+    const TIpAddress& Adapter() const;
+    const char* ResourceUriPrefix() const;
+    Endpoint ClientEndpoint() const;
+    const Brx& ClientUserAgent() const;
+    void InvocationReadStart();
+    TBool InvocationReadBool(const TChar* aName);
+    void InvocationReadString(const TChar* aName, Brhz& aString);
+    TInt InvocationReadInt(const TChar* aName);
+    TUint InvocationReadUint(const TChar* aName);
+    void InvocationReadBinary(const TChar* aName, Brh& aData);
+    void InvocationReadEnd();
+    void InvocationReportError(TUint aCode, const Brx& aDescription);
+    void InvocationWriteStart();
+    void InvocationWriteBool(const TChar* aName, TBool aValue);
+    void InvocationWriteInt(const TChar* aName, TInt aValue);
+    void InvocationWriteUint(const TChar* aName, TUint aValue);
+    void InvocationWriteBinaryStart(const TChar* aName);
+    void InvocationWriteBinary(TByte aValue);
+    void InvocationWriteBinary(const Brx& aValue);
+    void InvocationWriteBinaryEnd(const TChar* aName);
+    void InvocationWriteStringStart(const TChar* aName);
+    void InvocationWriteString(TByte aValue);
+    void InvocationWriteString(const Brx& aValue);
+    void InvocationWriteStringEnd(const TChar* aName);
+    void InvocationWriteEnd();
 private:
     class SubscriptionWrapper
     {
@@ -269,8 +393,10 @@ public:
     static const TUint kMaxWriteBytes = 4*1024;
     static const TUint kMaxPropertyUpdates = 20;
     static const TUint kReadTimeoutMs = 5 * 1000;
+    static const TUint kInvocationWriteGranularity = 1024;
 private:
     DvStack& iDvStack;
+    TIpAddress iAdapter;
     Endpoint iEndpoint;
     Srx* iReadBuffer;
     ReaderUntil* iReaderUntil;
@@ -286,21 +412,33 @@ private:
     WsHeaderOrigin iHeaderOrigin;
     WsHeaderKey80 iHeadverKeyV8;
     WsHeaderVersion iHeaderVersion;
+    WsHeaderExtensions iHeaderExtensions;
     HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderUserAgent iHeaderUserAgent;
     const HttpStatus* iErrorStatus;
     WsProtocol* iProtocol;
+    WsDeflate* iDeflate;
     TBool iExit;
     typedef std::map<Brn,SubscriptionWrapper*,BufferCmp> Map;
     Map iMap;
     Mutex iInterruptLock;
     Semaphore iShutdownSem;
     Fifo<Brh*> iPropertyUpdates; // used for web sockets
+    DviDevice* iInvocationDevice;
+    Brn iInvocationId;
+    Brn iInvocationAction;
+    Brn iInvocationArgs;
+    TUint iInvocationVersion;
+    TBool iInvocationResponseStarted;
+    WriterBwh iInvocationWriter;
+    mutable Bws<128> iResourceUriPrefix;
 };
 
 class DviServerWebSocket : public DviServer
 {
 public:
     DviServerWebSocket(DvStack& aDvStack);
+    ~DviServerWebSocket();
 public: // from DviServer
     void Start();
 protected:
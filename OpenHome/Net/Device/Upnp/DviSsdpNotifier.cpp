@@ -24,12 +24,16 @@ SsdpNotifierScheduler::~SsdpNotifierScheduler()
     delete iTimer;
 }
 
-SsdpNotifierScheduler::SsdpNotifierScheduler(DvStack& aDvStack, ISsdpNotifyListener& aListener, const TChar* aId)
+SsdpNotifierScheduler::SsdpNotifierScheduler(DvStack& aDvStack, ISsdpNotifyListener& aListener, const TChar* aId, TUint aMaxBatchMsgs)
     : iType(NULL)
     , iId(aId)
     , iDvStack(aDvStack)
     , iListener(aListener)
+    , iMaxBatchMsgs(aMaxBatchMsgs)
+    , iTimerCallbacks(0)
+    , iSendCalls(0)
 {
+    ASSERT(iMaxBatchMsgs > 0);
     Functor functor = MakeFunctor(*this, &SsdpNotifierScheduler::SendNextMsg);
     iTimer = new Timer(iDvStack.Env(), functor, "SsdpNotifierScheduler");
 }
@@ -39,9 +43,21 @@ void SsdpNotifierScheduler::SetUdn(const Brx& aUdn)
     iUdn.Set(aUdn);
 }
 
+TUint SsdpNotifierScheduler::TimerCallbacks() const
+{
+    return iTimerCallbacks;
+}
+
+TUint SsdpNotifierScheduler::SendCalls() const
+{
+    return iSendCalls;
+}
+
 void SsdpNotifierScheduler::Start(TUint aDuration, TUint aMsgCount)
 {
     iStop = false;
+    iTimerCallbacks = 0;
+    iSendCalls = 0;
     iEndTimeMs = Os::TimeInMs(iDvStack.Env().OsCtx()) + aDuration;
     ScheduleNextTimer(aMsgCount);
 }
@@ -60,8 +76,18 @@ void SsdpNotifierScheduler::SendNextMsg()
 {
     TUint remaining = 0;
     TBool stop = true;
+    iTimerCallbacks++;
     try {
-        stop = (iStop || ((remaining = NextMsg()) == 0));
+        if (!iStop) {
+            // build up to iMaxBatchMsgs messages then send them together
+            TUint batched = 0;
+            do {
+                remaining = NextMsg();
+            } while (remaining > 0 && ++batched < iMaxBatchMsgs);
+            FlushMsgs();
+            iSendCalls++;
+        }
+        stop = (iStop || remaining == 0);
     }
     catch (WriterError&) {
         stop = true;
@@ -100,7 +126,8 @@ void SsdpNotifierScheduler::ScheduleNextTimer(TUint aRemainingMsgs) const
     else {
         remaining = iEndTimeMs - timeNow;
     }
-    TInt maxInterval = remaining / (TInt)aRemainingMsgs;
+    const TUint remainingBatches = (aRemainingMsgs + iMaxBatchMsgs - 1) / iMaxBatchMsgs;
+    TInt maxInterval = remaining / (TInt)remainingBatches;
     if (maxInterval < kMinTimerIntervalMs) {
         // we're running behind.  Schedule another timer to run immediately
         interval = 0;
@@ -124,11 +151,11 @@ void SsdpNotifierScheduler::LogNotifierStart(const TChar* aType)
 #define NEXT_MSG_DEVICE_TYPE  (2)
 #define NEXT_MSG_SERVICE_TYPE (3)
 
-MsearchResponse::MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener)
-    : SsdpNotifierScheduler(aDvStack, aListener, "MSearchResponse")
+MsearchResponse::MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMaxBatchMsgs)
+    : SsdpNotifierScheduler(aDvStack, aListener, "MSearchResponse", aMaxBatchMsgs)
     , iAnnouncementData(NULL)
 {
-    iNotifier = new SsdpMsearchResponder(aDvStack);
+    iNotifier = new SsdpMsearchResponder(aDvStack, aMaxBatchMsgs);
 }
 
 MsearchResponse::~MsearchResponse()
@@ -190,7 +217,7 @@ void MsearchResponse::Start(IUpnpAnnouncementData& aAnnouncementData, TUint aTot
     iAnnouncementData = &aAnnouncementData;
     iNextMsgIndex = aNextMsgIndex;
     iRemainingMsgs = aTotalMsgs;
-    static_cast<SsdpMsearchResponder*>(iNotifier)->SetRemote(aRemote, aConfigId, aAdapter);
+    iNotifier->SetRemote(aRemote, aConfigId, aAdapter);
     iRemote = aRemote;
     iUri.Replace(aUri);
     SsdpNotifierScheduler::Start(aMx * 1000, iRemainingMsgs);
@@ -219,12 +246,17 @@ TUint MsearchResponse::NextMsg()
     return --iRemainingMsgs;
 }
 
+void MsearchResponse::FlushMsgs()
+{
+    iNotifier->Flush();
+}
+
 
 // DeviceAnnouncement
 
-DeviceAnnouncement::DeviceAnnouncement(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMsgIntervalAlive, TUint aMsgIntervalByeBye)
-    : SsdpNotifierScheduler(aDvStack, aListener, "DevAnounce")
-    , iSsdpNotifier(aDvStack)
+DeviceAnnouncement::DeviceAnnouncement(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMsgIntervalAlive, TUint aMsgIntervalByeBye, TUint aMaxBatchMsgs)
+    : SsdpNotifierScheduler(aDvStack, aListener, "DevAnounce", aMaxBatchMsgs)
+    , iSsdpNotifier(aDvStack, aMaxBatchMsgs)
     , iNotifierAlive(iSsdpNotifier)
     , iNotifierByeBye(iSsdpNotifier)
     , iNotifierUpdate(iSsdpNotifier)
@@ -289,6 +321,11 @@ TUint DeviceAnnouncement::NextMsg()
     return (iTotalMsgs - iNextMsgIndex);
 }
 
+void DeviceAnnouncement::FlushMsgs()
+{
+    iSsdpNotifier.Flush();
+}
+
 void DeviceAnnouncement::NotifyComplete(TBool aCancelled)
 {
     SsdpNotifierScheduler::NotifyComplete(aCancelled);
@@ -308,6 +345,7 @@ DviSsdpNotifierManager::DviSsdpNotifierManager(DvStack& aDvStack)
     , iShutdownSem("DVDM", 1)
 {
     iDvStack.Env().InitParams()->GetDvAnnouncementIntervals(iAnnounceIntervalByeBye, iAnnounceIntervalAlive);
+    iBatchSize = iDvStack.Env().InitParams()->DvSsdpBatchSize();
 }
 
 DviSsdpNotifierManager::~DviSsdpNotifierManager()
@@ -467,7 +505,7 @@ DviSsdpNotifierManager::Responder* DviSsdpNotifierManager::GetResponder(IUpnpAnn
 
     DviSsdpNotifierManager::Responder* responder;
     if (iFreeResponders.size() == 0) {
-        MsearchResponse* msr = new MsearchResponse(iDvStack, *this);
+        MsearchResponse* msr = new MsearchResponse(iDvStack, *this, iBatchSize);
         responder = new Responder(msr);
         iActiveResponders.push_back(responder);
     }
@@ -485,7 +523,7 @@ DviSsdpNotifierManager::Announcer* DviSsdpNotifierManager::GetAnnouncer(IUpnpAnn
     DviSsdpNotifierManager::Announcer* announcer;
     if (iFreeAnnouncers.size() == 0) {
         try {
-            DeviceAnnouncement* da = new DeviceAnnouncement(iDvStack, *this, iAnnounceIntervalAlive, iAnnounceIntervalByeBye);
+            DeviceAnnouncement* da = new DeviceAnnouncement(iDvStack, *this, iAnnounceIntervalAlive, iAnnounceIntervalByeBye, iBatchSize);
             announcer = new Announcer(da);
             iActiveAnnouncers.push_back(announcer);
         }
@@ -30,12 +30,15 @@ public:
     virtual ~SsdpNotifierScheduler();
     void Stop();
     void SetUdn(const Brx& aUdn);
+    TUint TimerCallbacks() const; // since last Start()
+    TUint SendCalls() const;      // since last Start()
 protected:
-    SsdpNotifierScheduler(DvStack& aDvStack, ISsdpNotifyListener& aListener, const TChar* aId);
+    SsdpNotifierScheduler(DvStack& aDvStack, ISsdpNotifyListener& aListener, const TChar* aId, TUint aMaxBatchMsgs);
     void Start(TUint aDuration, TUint aMsgCount);
     virtual void NotifyComplete(TBool aCancelled);
 private:
     virtual TUint NextMsg() = 0;
+    virtual void FlushMsgs() = 0;
     void SendNextMsg();
     void ScheduleNextTimer(TUint aRemainingMsgs) const;
 protected:
@@ -49,13 +52,16 @@ private:
     ISsdpNotifyListener& iListener;
     TBool iStop;
     Brn iUdn;
+    const TUint iMaxBatchMsgs;
+    TUint iTimerCallbacks;
+    TUint iSendCalls;
 };
 
 
 class MsearchResponse : public SsdpNotifierScheduler
 {
 public:
-    MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener);
+    MsearchResponse(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMaxBatchMsgs);
     ~MsearchResponse();
     void StartAll(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
     void StartRoot(IUpnpAnnouncementData& aAnnouncementData, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
@@ -67,10 +73,11 @@ private:
     void Start(IUpnpAnnouncementData& aAnnouncementData, TUint aTotalMsgs, TUint aNextMsgIndex, const Endpoint& aRemote, TUint aMx, const Brx& aUri, TUint aConfigId, TIpAddress aAdapter);
 private: // from DviMsg
     TUint NextMsg();
+    void FlushMsgs();
 private:
     static const TUint kMaxUriBytes = 256;
     IUpnpAnnouncementData* iAnnouncementData;
-    ISsdpNotify* iNotifier;
+    SsdpMsearchResponder* iNotifier;
     Endpoint iRemote;
     Bws<kMaxUriBytes> iUri;
     TUint iRemainingMsgs;
@@ -81,7 +88,7 @@ class DeviceAnnouncement : public SsdpNotifierScheduler
 {
     static const TUint kMsgIntervalMsUpdate = 20;
 public:
-    DeviceAnnouncement(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMsgIntervalAlive, TUint aMsgIntervalByeBye);
+    DeviceAnnouncement(DvStack& aDvStack, ISsdpNotifyListener& aListener, TUint aMsgIntervalAlive, TUint aMsgIntervalByeBye, TUint aMaxBatchMsgs);
     void StartAlive(IUpnpAnnouncementData& aAnnouncementData, TIpAddress aAdapter, const Brx& aUri, TUint aConfigId);
     void StartByeBye(IUpnpAnnouncementData& aAnnouncementData, TIpAddress aAdapter, const Brx& aUri, TUint aConfigId, FunctorGeneric<TBool>& aCompleted);
     void StartUpdate(IUpnpAnnouncementData& aAnnouncementData, TIpAddress aAdapter, const Brx& aUri, TUint aConfigId, FunctorGeneric<TBool>& aCompleted);
@@ -89,6 +96,7 @@ private:
     void Start(ISsdpNotify& aNotifier, IUpnpAnnouncementData& aAnnouncementData, TIpAddress aAdapter, const Brx& aUri, TUint aConfigId, TUint aMsgInterval);
 private: // from DviMsg
     TUint NextMsg();
+    void FlushMsgs();
     void NotifyComplete(TBool aCancelled);
 private:
     static const TUint kMaxUriBytes = 256;
@@ -167,6 +175,7 @@ private:
     std::list<Notifier*> iActiveAnnouncers;
     TUint iAnnounceIntervalAlive;
     TUint iAnnounceIntervalByeBye;
+    TUint iBatchSize;
 };
 
 } // namespace Net
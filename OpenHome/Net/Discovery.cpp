@@ -5,54 +5,67 @@
 #include <OpenHome/Net/Core/OhNet.h>
 #include <OpenHome/Private/DnsChangeNotifier.h>
 
+#include <algorithm>
+
 using namespace OpenHome;
 using namespace OpenHome::Net;
 
-// SsdpSocketReader
+// SsdpListener
 
-SsdpSocketReader::SsdpSocketReader(Environment& aEnv, const TIpAddress& aInterface, const Endpoint& aMulticast)
-    : SocketUdpMulticast(aEnv, aInterface, aMulticast)
+SsdpListener::SsdpListener(const TChar* aName)
+    : Thread(aName, kPriority)
+    , iCountLock("SSLC")
+    , iReceived(0)
+    , iMalformed(0)
+    , iRejected(0)
 {
-    SetTtl(aEnv.InitParams()->MsearchTtl()); 
-    iReader = new UdpReader(*this);
 }
 
-SsdpSocketReader::~SsdpSocketReader()
+TUint SsdpListener::MessagesReceived() const
 {
-    delete iReader;
+    AutoMutex a(iCountLock);
+    return iReceived;
 }
 
-Endpoint SsdpSocketReader::Sender() const
+TUint SsdpListener::MessagesMalformed() const
 {
-    return iReader->Sender();
+    AutoMutex a(iCountLock);
+    return iMalformed;
 }
 
-void SsdpSocketReader::Read(Bwx& aBuffer)
+TUint SsdpListener::MessagesRejected() const
 {
-    iReader->Read(aBuffer);
+    AutoMutex a(iCountLock);
+    return iRejected;
 }
 
-void SsdpSocketReader::ReadFlush()
+void SsdpListener::CountReceived()
 {
-    iReader->ReadFlush();
+    AutoMutex a(iCountLock);
+    iReceived++;
 }
 
-void SsdpSocketReader::ReadInterrupt()
+void SsdpListener::CountMalformed()
 {
-    iReader->ReadInterrupt();
+    AutoMutex a(iCountLock);
+    iMalformed++;
 }
 
-// SsdpListener
-
-SsdpListener::SsdpListener(const TChar* aName)
-    : Thread(aName, kPriority)
+void SsdpListener::CountRejected()
 {
+    AutoMutex a(iCountLock);
+    iRejected++;
 }
 
 // SsdpListenerMulticast
 
-// Reader chain: Multicast Socket -> Srs -> ReaderHttpRequest -> this -> aMsearch
-//                                                                    -> aNotify
+// Datagrams are read in batches into fixed slots then parsed in place:
+//
+// Multicast Socket -> UdpBatchReader -> SsdpMessageParser -> this -> aMsearch
+//                                                                 -> aNotify
+//
+// Messages are fully validated before any handler is called so that the (common)
+// case of unwanted or inconsistent messages costs no handler locks or copies.
 
 SsdpListenerMulticast::SsdpListenerMulticast(Environment& aEnv, const TIpAddress& aInterface)
     : SsdpListener("SsdpListenerM")
@@ -61,13 +74,12 @@ SsdpListenerMulticast::SsdpListenerMulticast(Environment& aEnv, const TIpAddress
     , iNextHandlerId(0)
     , iInterface(aInterface)
     , iSocket(aEnv, aInterface, Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress))
-    , iBuffer(iSocket)
-    , iReaderUntil(iBuffer)
-    , iReaderRequest(aEnv, iReaderUntil)
+    , iReader(iSocket, kReceiveSlots, kMaxBufferBytes)
     , iDnsChangeListenerId(DnsChangeNotifier::kIdInvalid)
     , iExiting(false)
     , iRecreateSocket(false)
 {
+    iSocket.SetTtl(aEnv.InitParams()->MsearchTtl());
     try
     {
         iSocket.SetRecvBufBytes(kRecvBufBytes);
@@ -77,73 +89,37 @@ SsdpListenerMulticast::SsdpListenerMulticast(Environment& aEnv, const TIpAddress
     aEnv.AddResumeObserver(*this);
     iDnsChangeListenerId = iEnv.DnsChangeNotifier()->Register(MakeFunctor(*this, &SsdpListenerMulticast::DnsChanged));
 
-    iReaderRequest.AddHeader(iHeaderHost);
-    iReaderRequest.AddHeader(iHeaderCacheControl);
-    iReaderRequest.AddHeader(iHeaderLocation);
-    iReaderRequest.AddHeader(iHeaderNt);
-    iReaderRequest.AddHeader(iHeaderNts);
-    iReaderRequest.AddHeader(iHeaderServer);
-    iReaderRequest.AddHeader(iHeaderUsn);
-    iReaderRequest.AddHeader(iHeaderMan);
-    iReaderRequest.AddHeader(iHeaderMx);
-    iReaderRequest.AddHeader(iHeaderSt);
-    iReaderRequest.AddMethod(Ssdp::kMethodNotify);
-    iReaderRequest.AddMethod(Ssdp::kMethodMsearch);
+    iParser.AddHeader(iHeaderHost, Ssdp::kHeaderHost);
+    iParser.AddHeader(iHeaderCacheControl, Ssdp::kHeaderCacheControl);
+    iParser.AddHeader(iHeaderLocation, Ssdp::kHeaderLocation);
+    iParser.AddHeader(iHeaderNt, Ssdp::kHeaderNt);
+    iParser.AddHeader(iHeaderNts, Ssdp::kHeaderNts);
+    iParser.AddHeader(iHeaderServer, Ssdp::kHeaderServer);
+    iParser.AddHeader(iHeaderUsn, Ssdp::kHeaderUsn);
+    iParser.AddHeader(iHeaderMan, Ssdp::kHeaderMan);
+    iParser.AddHeader(iHeaderMx, Ssdp::kHeaderMx);
+    iParser.AddHeader(iHeaderSt, Ssdp::kHeaderSt);
+    iParser.AddHeader(iHeaderConfigId, Ssdp::kHeaderConfigId);
 }
 
 void SsdpListenerMulticast::Run()
 {
     Signal();
     for (;;) {
-        iReaderRequest.Flush();
-
         try {
             LOG(kSsdpMulticast, "SSDP Multicast      Listen\n");
-            iReaderRequest.Read(0);
-            if (iReaderRequest.Version() == Http::eHttp11) {
-                if (iReaderRequest.Uri() == Ssdp::kMethodUri) {
-                    const Brx& method = iReaderRequest.Method();
-                    if (method == Ssdp::kMethodNotify) {
-                        LOG(kSsdpMulticast, "SSDP Multicast      Notify\n");
-                        iLock.Wait();
-                        EraseDisabled(iNotifyHandlers);
-                        VectorNotifyHandler callbacks;
-                        TUint count = (TUint)iNotifyHandlers.size();
-                        for (TUint i=0; i<count; i++) {
-                            callbacks.push_back(iNotifyHandlers[i]);
-                        }
-                        iLock.Signal();
-                        for (TUint i = 0; i<count; i++) {
-                            Notify(*(callbacks[i]));
-                        }
-                    }
-                    else if (method == Ssdp::kMethodMsearch) {
-                        LOG(kSsdpMulticast, "SSDP Multicast      Msearch\n");
-                        iLock.Wait();
-                        EraseDisabled(iMsearchHandlers);
-                        VectorMsearchHandler callbacks;
-                        TUint count = (TUint)iMsearchHandlers.size();
-                        for (TUint i=0; i<count; i++) {
-                            callbacks.push_back(iMsearchHandlers[i]);
-                        }
-                        iLock.Signal();
-                        for (TUint i = 0; i<count; i++) {
-                            Msearch(*(callbacks[i]));
-                        }
-                    }
-                }
-            }
-        }
-        catch (HttpError& ex) {
-            Endpoint::EndpointBuf epb;
-            iSocket.Sender().AppendEndpoint(epb);
-            epb.PtrZ();
+            Brn msg = iReader.Read();
+            CountReceived();
             try {
-                Brn buf = iReaderUntil.Read(kMaxBufferBytes);
-                LOG_ERROR(kSsdpMulticast, "SSDP Multicast      HttpError (sender=%s) from %s:%u.  Received: %.*s\n\n",
-                                             (const char*)epb.Ptr(), ex.File(), ex.Line(), PBUF(buf));
+                Process(msg);
             }
-            catch (ReaderError&) {
+            catch (HttpError& ex) {
+                CountMalformed();
+                Endpoint::EndpointBuf epb;
+                iReader.Sender().AppendEndpoint(epb);
+                epb.PtrZ();
+                LOG_ERROR(kSsdpMulticast, "SSDP Multicast      HttpError (sender=%s) from %s:%u.  Received: %.*s\n\n",
+                                             (const char*)epb.Ptr(), ex.File(), ex.Line(), PBUF(msg));
             }
         }
         catch (WriterError&) {
@@ -157,6 +133,7 @@ void SsdpListenerMulticast::Run()
         }
         if (iRecreateSocket) {
             try {
+                iReader.Discard();
                 iSocket.Interrupt(false);
                 iSocket.ReCreate();
                 iRecreateSocket = false;
@@ -168,16 +145,108 @@ void SsdpListenerMulticast::Run()
     }
 }
 
-void SsdpListenerMulticast::Msearch(MsearchHandler& aHandler)
+void SsdpListenerMulticast::Process(const Brx& aMessage)
 {
-    AutoMutex a(aHandler.Mutex());
-    if (!aHandler.IsDisabled()) {
-        Msearch(*(aHandler.Handler()));
+    iParser.ParseRequest(aMessage);
+    if (iParser.Version() != Http::eHttp11 || iParser.Uri() != Ssdp::kMethodUri) {
+        CountRejected();
+        return;
+    }
+    const Brx& method = iParser.Method();
+    if (method == Ssdp::kMethodNotify) {
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify\n");
+        const ENotification type = NotifyType();
+        if (type == eNotifyInvalid) {
+            CountRejected();
+            return;
+        }
+        VectorNotifyHandler callbacks;
+        iLock.Wait();
+        DeleteDisabled();
+        NotifyHandlers(type, callbacks);
+        iLock.Signal();
+        if (callbacks.size() == 0) {
+            CountRejected();
+            return;
+        }
+        for (TUint i=0; i<(TUint)callbacks.size(); i++) {
+            Notify(*(callbacks[i]), type);
+        }
+    }
+    else if (method == Ssdp::kMethodMsearch) {
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch\n");
+        const TUint mx = MsearchMx();
+        iLock.Wait();
+        EraseDisabled(iMsearchHandlers);
+        if (mx == 0 || iMsearchHandlers.size() == 0) {
+            iLock.Signal();
+            CountRejected();
+            return;
+        }
+        VectorMsearchHandler callbacks(iMsearchHandlers);
+        iLock.Signal();
+        for (TUint i=0; i<(TUint)callbacks.size(); i++) {
+            Msearch(*(callbacks[i]), mx);
+        }
+    }
+    else {
+        CountRejected();
     }
 }
 
-void SsdpListenerMulticast::Msearch(ISsdpMsearchHandler& aMsearchHandler)
+SsdpListenerMulticast::ENotification SsdpListenerMulticast::NotifyType() const
 {
+    if (!iHeaderNts.Received() || !iHeaderHost.Received() || !iHeaderNt.Received() || !iHeaderUsn.Received()) {
+        return eNotifyInvalid;
+    }
+    const TBool alive = iHeaderNts.Alive();
+    if (alive && (iHeaderCacheControl.MaxAge() == 0 || !iHeaderLocation.Received() || !iHeaderServer.Received())) {
+        return eNotifyInvalid;
+    }
+    const ESsdpTarget target = iHeaderNt.Target();
+    if (iHeaderUsn.Target() != target) {
+        return eNotifyInvalid;
+    }
+    switch (target) {
+    case eSsdpRoot:
+        return (alive? eNotifyRootAlive : eNotifyRootByeBye);
+    case eSsdpUuid:
+        if (iHeaderNt.Uuid() != iHeaderUsn.Uuid()) {
+            return eNotifyInvalid;
+        }
+        return (alive? eNotifyUuidAlive : eNotifyUuidByeBye);
+    case eSsdpDeviceType:
+    case eSsdpServiceType:
+        if (iHeaderNt.Domain() != iHeaderUsn.Domain() ||
+            iHeaderNt.Type() != iHeaderUsn.Type() ||
+            iHeaderNt.Version() != iHeaderUsn.Version()) {
+            return eNotifyInvalid;
+        }
+        if (target == eSsdpDeviceType) {
+            return (alive? eNotifyDeviceTypeAlive : eNotifyDeviceTypeByeBye);
+        }
+        return (alive? eNotifyServiceTypeAlive : eNotifyServiceTypeByeBye);
+    default:
+        break;
+    }
+    return eNotifyInvalid;
+}
+
+TUint SsdpListenerMulticast::MsearchMx() const
+{
+    if (!iHeaderHost.Received() || !iHeaderMan.Received() || !iHeaderSt.Received()) {
+        return 0;
+    }
+    switch (iHeaderSt.Target()) {
+    case eSsdpRoot:
+    case eSsdpUuid:
+    case eSsdpDeviceType:
+    case eSsdpServiceType:
+    case eSsdpAll:
+        break;
+    default:
+        return 0;
+    }
     TUint mx = iHeaderMx.Mx();
     if (mx == 0) {
         mx = 1;
@@ -185,155 +254,101 @@ void SsdpListenerMulticast::Msearch(ISsdpMsearchHandler& aMsearchHandler)
     else if (mx > kMaxMxSecs) {
         mx = kMaxMxSecs;
     }
+    return mx;
+}
 
-    if (mx && iHeaderHost.Received() && iHeaderMan.Received() && iHeaderSt.Received()) {
-        switch(iHeaderSt.Target()) {
-        case eSsdpRoot:
-            LOG(kSsdpMulticast, "SSDP Multicast      Msearch Root\n");
-            aMsearchHandler.SsdpSearchRoot(iSocket.Sender(), mx);
-            return;
-        case eSsdpUuid:
-            LOG(kSsdpMulticast, "SSDP Multicast      Msearch Uuid - %.*s\n", PBUF(iHeaderSt.Uuid()));
-            aMsearchHandler.SsdpSearchUuid(iSocket.Sender(), mx, iHeaderSt.Uuid());
-            return;
-        case eSsdpDeviceType:
-            LOG(kSsdpMulticast, "SSDP Multicast      Msearch Device Type - %.*s : %.*s : %u\n",
-                                PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()), iHeaderSt.Version());
-            aMsearchHandler.SsdpSearchDeviceType(iSocket.Sender(), mx, iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version());
-            return;
-        case eSsdpServiceType:
-            LOG(kSsdpMulticast, "SSDP Multicast      Msearch Service Type - %.*s : %.*s : %u\n",
-                                PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()), iHeaderSt.Version());
-            aMsearchHandler.SsdpSearchServiceType(iSocket.Sender(), mx, iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version());
-            return;
-        case eSsdpAll:
-            LOG(kSsdpMulticast, "SSDP Multicast      Msearch All\n");
-            aMsearchHandler.SsdpSearchAll(iSocket.Sender(), mx);
-            return;
-        default:
-            break;
-        }
+void SsdpListenerMulticast::Msearch(MsearchHandler& aHandler, TUint aMx)
+{
+    AutoMutex a(aHandler.Mutex());
+    if (!aHandler.IsDisabled()) {
+        Msearch(*(aHandler.Handler()), aMx);
+    }
+}
+
+void SsdpListenerMulticast::Msearch(ISsdpMsearchHandler& aMsearchHandler, TUint aMx)
+{
+    const Endpoint sender = iReader.Sender();
+    switch(iHeaderSt.Target()) {
+    case eSsdpRoot:
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch Root\n");
+        aMsearchHandler.SsdpSearchRoot(sender, aMx);
+        break;
+    case eSsdpUuid:
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch Uuid - %.*s\n", PBUF(iHeaderSt.Uuid()));
+        aMsearchHandler.SsdpSearchUuid(sender, aMx, iHeaderSt.Uuid());
+        break;
+    case eSsdpDeviceType:
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch Device Type - %.*s : %.*s : %u\n",
+                            PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()), iHeaderSt.Version());
+        aMsearchHandler.SsdpSearchDeviceType(sender, aMx, iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version());
+        break;
+    case eSsdpServiceType:
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch Service Type - %.*s : %.*s : %u\n",
+                            PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()), iHeaderSt.Version());
+        aMsearchHandler.SsdpSearchServiceType(sender, aMx, iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version());
+        break;
+    case eSsdpAll:
+        LOG(kSsdpMulticast, "SSDP Multicast      Msearch All\n");
+        aMsearchHandler.SsdpSearchAll(sender, aMx);
+        break;
+    default:
+        break;
     }
 }
 
-void SsdpListenerMulticast::Notify(NotifyHandler& aHandler)
+void SsdpListenerMulticast::Notify(NotifyHandler& aHandler, ENotification aType)
 {
     AutoMutex a(aHandler.Mutex());
     if (!aHandler.IsDisabled()) {
-        Notify(*(aHandler.Handler()));
-    }
-}
-
-void SsdpListenerMulticast::Notify(ISsdpNotifyHandler& aNotifyHandler)
-{
-    if (iHeaderNts.Received()) {
-        if (iHeaderNts.Alive()) {
-            TUint maxage = iHeaderCacheControl.MaxAge();
-            if (maxage && iHeaderHost.Received() && iHeaderLocation.Received() && iHeaderServer.Received() && iHeaderNt.Received() && iHeaderUsn.Received()) {
-                switch(iHeaderNt.Target()) {
-                case eSsdpRoot:
-                    if (iHeaderUsn.Target() == eSsdpRoot) {
-                        LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Root\n");
-                        aNotifyHandler.SsdpNotifyRootAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage);
-                        return;
-                    }
-                    break;
-                case eSsdpUuid:
-                    if (iHeaderUsn.Target() == eSsdpUuid) {
-                        if (iHeaderNt.Uuid() == iHeaderUsn.Uuid()) {
-                            LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Uuid - %.*s, %.*s, %u\n",
-                                                PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderLocation.Location()), maxage);
-                            aNotifyHandler.SsdpNotifyUuidAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage);
-                            return;
-                        }
-                    }
-                    break;
-                case eSsdpDeviceType:
-                    if (iHeaderUsn.Target() == eSsdpDeviceType) {
-                        if (iHeaderNt.Domain() == iHeaderUsn.Domain()) {
-                            if (iHeaderNt.Type() == iHeaderUsn.Type()) {
-                                if (iHeaderNt.Version() == iHeaderUsn.Version()) {
-                                    LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Device Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
-                                                        PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()),
-                                                        iHeaderNt.Version(), PBUF(iHeaderLocation.Location()), maxage);
-                                    aNotifyHandler.SsdpNotifyDeviceTypeAlive(iHeaderUsn.Uuid(), iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version(), iHeaderLocation.Location(), maxage);
-                                    return;
-                                }
-                            }
-                        }
-                    }
-                    break;
-                case eSsdpServiceType:
-                    if (iHeaderUsn.Target() == eSsdpServiceType) {
-                        if (iHeaderNt.Domain() == iHeaderUsn.Domain()) {
-                            if (iHeaderNt.Type() == iHeaderUsn.Type()) {
-                                if (iHeaderNt.Version() == iHeaderUsn.Version()) {
-                                    LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Service Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
-                                                        PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()),
-                                                        iHeaderNt.Version(), PBUF(iHeaderLocation.Location()), maxage);
-                                    aNotifyHandler.SsdpNotifyServiceTypeAlive(iHeaderUsn.Uuid(), iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version(), iHeaderLocation.Location(), maxage);
-                                    return;
-                                }
-                            }
-                        }
-                    }
-                    break;
-                default:
-                    break;
-                }
-            }
-        }
-        else {
-            if (iHeaderHost.Received() && iHeaderNt.Received() && iHeaderUsn.Received()) {
-                switch(iHeaderNt.Target()) {
-                case eSsdpRoot:
-                    if (iHeaderUsn.Target() == eSsdpRoot) {
-                        LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Root - %.*s\n", PBUF(iHeaderUsn.Uuid()));
-                        aNotifyHandler.SsdpNotifyRootByeBye(iHeaderUsn.Uuid());
-                        return;
-                    }
-                    break;
-                case eSsdpUuid:
-                    if (iHeaderUsn.Target() == eSsdpUuid) {
-                        if (iHeaderNt.Uuid() == iHeaderUsn.Uuid()) {
-                            LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Uuid - %.*s\n", PBUF(iHeaderUsn.Uuid()));
-                            aNotifyHandler.SsdpNotifyUuidByeBye(iHeaderUsn.Uuid());
-                            return;
-                        }
-                    }
-                    break;
-                case eSsdpDeviceType:
-                    if (iHeaderUsn.Target() == eSsdpDeviceType) {
-                        if (iHeaderNt.Domain() == iHeaderUsn.Domain()) {
-                            if (iHeaderNt.Type() == iHeaderUsn.Type()) {
-                                if (iHeaderNt.Version() == iHeaderUsn.Version()) {
-                                    LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Device Type - %.*s, %.*s, %.*s, %u\n",
-                                                        PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()), iHeaderNt.Version());
-                                    aNotifyHandler.SsdpNotifyDeviceTypeByeBye(iHeaderUsn.Uuid(), iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version());
-                                    return;
-                                }
-                            }
-                        }
-                    }
-                    break;
-                case eSsdpServiceType:
-                    if (iHeaderUsn.Target() == eSsdpServiceType) {
-                        if (iHeaderNt.Domain() == iHeaderUsn.Domain()) {
-                            if (iHeaderNt.Type() == iHeaderUsn.Type()) {
-                                if (iHeaderNt.Version() == iHeaderUsn.Version()) {
-                                    LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Service Type - %.*s, %.*s, %.*s, %u\n",
-                                                        PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()), iHeaderNt.Version());
-                                    aNotifyHandler.SsdpNotifyServiceTypeByeBye(iHeaderUsn.Uuid(), iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version());
-                                    return;
-                                }
-                            }
-                        }
-                    }
-                default:
-                    break;
-                }
-            }
-        }
+        Notify(*(aHandler.Handler()), aType);
+    }
+}
+
+void SsdpListenerMulticast::Notify(ISsdpNotifyHandler& aNotifyHandler, ENotification aType)
+{
+    const Brx& uuid = iHeaderUsn.Uuid();
+    switch (aType) {
+    case eNotifyRootAlive:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Root\n");
+        aNotifyHandler.SsdpNotifyRootAlive(uuid, iHeaderLocation.Location(), iHeaderCacheControl.MaxAge(), iHeaderConfigId.ConfigId());
+        break;
+    case eNotifyUuidAlive:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Uuid - %.*s, %.*s, %u\n",
+                            PBUF(uuid), PBUF(iHeaderLocation.Location()), iHeaderCacheControl.MaxAge());
+        aNotifyHandler.SsdpNotifyUuidAlive(uuid, iHeaderLocation.Location(), iHeaderCacheControl.MaxAge(), iHeaderConfigId.ConfigId());
+        break;
+    case eNotifyDeviceTypeAlive:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Device Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
+                            PBUF(uuid), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()),
+                            iHeaderNt.Version(), PBUF(iHeaderLocation.Location()), iHeaderCacheControl.MaxAge());
+        aNotifyHandler.SsdpNotifyDeviceTypeAlive(uuid, iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version(), iHeaderLocation.Location(), iHeaderCacheControl.MaxAge(), iHeaderConfigId.ConfigId());
+        break;
+    case eNotifyServiceTypeAlive:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify Alive Service Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
+                            PBUF(uuid), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()),
+                            iHeaderNt.Version(), PBUF(iHeaderLocation.Location()), iHeaderCacheControl.MaxAge());
+        aNotifyHandler.SsdpNotifyServiceTypeAlive(uuid, iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version(), iHeaderLocation.Location(), iHeaderCacheControl.MaxAge(), iHeaderConfigId.ConfigId());
+        break;
+    case eNotifyRootByeBye:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Root - %.*s\n", PBUF(uuid));
+        aNotifyHandler.SsdpNotifyRootByeBye(uuid);
+        break;
+    case eNotifyUuidByeBye:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Uuid - %.*s\n", PBUF(uuid));
+        aNotifyHandler.SsdpNotifyUuidByeBye(uuid);
+        break;
+    case eNotifyDeviceTypeByeBye:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Device Type - %.*s, %.*s, %.*s, %u\n",
+                            PBUF(uuid), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()), iHeaderNt.Version());
+        aNotifyHandler.SsdpNotifyDeviceTypeByeBye(uuid, iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version());
+        break;
+    case eNotifyServiceTypeByeBye:
+        LOG(kSsdpMulticast, "SSDP Multicast      Notify ByeBye Service Type - %.*s, %.*s, %.*s, %u\n",
+                            PBUF(uuid), PBUF(iHeaderNt.Domain()), PBUF(iHeaderNt.Type()), iHeaderNt.Version());
+        aNotifyHandler.SsdpNotifyServiceTypeByeBye(uuid, iHeaderNt.Domain(), iHeaderNt.Type(), iHeaderNt.Version());
+        break;
+    default:
+        break;
     }
 }
 
@@ -343,23 +358,54 @@ SsdpListenerMulticast::~SsdpListenerMulticast()
     iEnv.DnsChangeNotifier()->Deregister(iDnsChangeListenerId);
     iEnv.RemoveResumeObserver(*this);
     iExiting = true;
-    iReaderRequest.Interrupt();
+    iReader.ReadInterrupt();
     Join();
-    EraseDisabled(iNotifyHandlers);
+    DeleteDisabled();
     ASSERT(iNotifyHandlers.size() == 0);
     EraseDisabled(iMsearchHandlers);
     ASSERT(iMsearchHandlers.size() == 0);
 }
 
-TInt SsdpListenerMulticast::AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler)
+TInt SsdpListenerMulticast::AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler, ESsdpTarget aTarget,
+                                             const Brx& aUuidOrDomain, const Brx& aType)
 {
     ASSERT(aNotifyHandler != NULL);
-    iLock.Wait();
-    TInt id = iNextHandlerId;
-    NotifyHandler* handler = new NotifyHandler(aNotifyHandler, iNextHandlerId);
+    Bwh key;
+    if (aTarget == eSsdpUuid) {
+        key.Grow(aUuidOrDomain.Bytes());
+        key.Replace(aUuidOrDomain);
+    }
+    else if (aTarget == eSsdpDeviceType || aTarget == eSsdpServiceType) {
+        key.Grow(aUuidOrDomain.Bytes() + 1 + aType.Bytes());
+        TypeKey(aUuidOrDomain, aType, key);
+    }
+    else {
+        ASSERT(aTarget == eSsdpAll || aTarget == eSsdpRoot);
+    }
+    AutoMutex a(iLock);
+    TInt id = iNextHandlerId++;
+    NotifyHandler* handler = new NotifyHandler(aNotifyHandler, id, aTarget, key);
     iNotifyHandlers.push_back(handler);
-    iNextHandlerId++;
-    iLock.Signal();
+    switch (aTarget)
+    {
+    case eSsdpAll:
+        iNotifyHandlersAll.push_back(handler);
+        break;
+    case eSsdpRoot:
+        iNotifyHandlersRoot.push_back(handler);
+        break;
+    case eSsdpUuid:
+        iNotifyHandlersUuid[Brn(handler->Key())].push_back(handler);
+        break;
+    case eSsdpDeviceType:
+        iNotifyHandlersDeviceType[Brn(handler->Key())].push_back(handler);
+        break;
+    case eSsdpServiceType:
+        iNotifyHandlersServiceType[Brn(handler->Key())].push_back(handler);
+        break;
+    default:
+        break;
+    }
     return id;
 }
 
@@ -377,18 +423,43 @@ TInt SsdpListenerMulticast::AddMsearchHandler(ISsdpMsearchHandler* aMsearchHandl
 
 void SsdpListenerMulticast::RemoveNotifyHandler(TInt aHandlerId)
 {
-    iLock.Wait();
-    TUint count = (TUint)iNotifyHandlers.size();
-    for (TUint i = 0; i<count; i++) {
-        NotifyHandler* nh = iNotifyHandlers[i];
-        if (nh->Id() == aHandlerId) {
-            nh->Lock();
-            nh->Disable();
-            nh->Unlock();
+    AutoMutex a(iLock);
+    VectorNotifyHandler::iterator it = iNotifyHandlers.begin();
+    for (; it != iNotifyHandlers.end(); ++it) {
+        if ((*it)->Id() == aHandlerId) {
             break;
         }
     }
-    iLock.Signal();
+    if (it == iNotifyHandlers.end()) {
+        return;
+    }
+    NotifyHandler* nh = *it;
+    iNotifyHandlers.erase(it);
+    switch (nh->Target())
+    {
+    case eSsdpAll:
+        iNotifyHandlersAll.erase(std::find(iNotifyHandlersAll.begin(), iNotifyHandlersAll.end(), nh));
+        break;
+    case eSsdpRoot:
+        iNotifyHandlersRoot.erase(std::find(iNotifyHandlersRoot.begin(), iNotifyHandlersRoot.end(), nh));
+        break;
+    case eSsdpUuid:
+        RemoveIndexed(iNotifyHandlersUuid, nh);
+        break;
+    case eSsdpDeviceType:
+        RemoveIndexed(iNotifyHandlersDeviceType, nh);
+        break;
+    case eSsdpServiceType:
+        RemoveIndexed(iNotifyHandlersServiceType, nh);
+        break;
+    default:
+        break;
+    }
+    nh->Lock();
+    nh->Disable();
+    nh->Unlock();
+    // Run() may hold a copy of this pointer; it deletes disabled handlers before its next dispatch
+    iNotifyHandlersDisabled.push_back(nh);
 }
 
 void SsdpListenerMulticast::RemoveMsearchHandler(TInt aHandlerId)
@@ -412,24 +483,74 @@ const TIpAddress& SsdpListenerMulticast::Interface() const
     return iInterface;
 }
 
-void SsdpListenerMulticast::EraseDisabled(VectorNotifyHandler& aVector)
+void SsdpListenerMulticast::NotifyHandlers(ENotification aType, VectorNotifyHandler& aHandlers) const
 {
-    VectorNotifyHandler::iterator it = aVector.begin();
-    while (it != aVector.end()) {
-        NotifyHandler* handler = reinterpret_cast<NotifyHandler*>(*it);
-        handler->Lock();
-        if (handler->IsDisabled()) {
-            handler->Unlock();
-            delete handler;
-            it = aVector.erase(it);
-        }
-        else {
-            handler->Unlock();
-            it++;
-        }
+    aHandlers = iNotifyHandlersAll;
+    Bws<kMaxTypeKeyBytes> key;
+    switch (aType)
+    {
+    case eNotifyRootAlive:
+    case eNotifyRootByeBye:
+        aHandlers.insert(aHandlers.end(), iNotifyHandlersRoot.begin(), iNotifyHandlersRoot.end());
+        break;
+    case eNotifyUuidAlive:
+    case eNotifyUuidByeBye:
+        AppendIndexed(iNotifyHandlersUuid, iHeaderUsn.Uuid(), aHandlers);
+        break;
+    case eNotifyDeviceTypeAlive:
+    case eNotifyDeviceTypeByeBye:
+        TypeKey(iHeaderNt.Domain(), iHeaderNt.Type(), key);
+        AppendIndexed(iNotifyHandlersDeviceType, key, aHandlers);
+        break;
+    case eNotifyServiceTypeAlive:
+    case eNotifyServiceTypeByeBye:
+        TypeKey(iHeaderNt.Domain(), iHeaderNt.Type(), key);
+        AppendIndexed(iNotifyHandlersServiceType, key, aHandlers);
+        break;
+    default:
+        break;
+    }
+}
+
+void SsdpListenerMulticast::AppendIndexed(const NotifyIndex& aIndex, const Brx& aKey, VectorNotifyHandler& aHandlers)
+{
+    NotifyIndex::const_iterator it = aIndex.find(Brn(aKey));
+    if (it != aIndex.end()) {
+        aHandlers.insert(aHandlers.end(), it->second.begin(), it->second.end());
     }
 }
 
+void SsdpListenerMulticast::RemoveIndexed(NotifyIndex& aIndex, NotifyHandler* aHandler)
+{
+    NotifyIndex::iterator it = aIndex.find(Brn(aHandler->Key()));
+    ASSERT(it != aIndex.end());
+    VectorNotifyHandler handlers(it->second);
+    aIndex.erase(it);
+    handlers.erase(std::find(handlers.begin(), handlers.end(), aHandler));
+    if (handlers.size() > 0) {
+        // re-key as the old key may have pointed into aHandler
+        aIndex.insert(std::pair<Brn, VectorNotifyHandler>(Brn(handlers[0]->Key()), handlers));
+    }
+}
+
+void SsdpListenerMulticast::TypeKey(const Brx& aDomain, const Brx& aType, Bwx& aKey)
+{
+    aKey.SetBytes(0);
+    if (aDomain.Bytes() + 1 + aType.Bytes() <= aKey.MaxBytes()) {
+        aKey.Append(aDomain);
+        aKey.Append(':');
+        aKey.Append(aType);
+    }
+}
+
+void SsdpListenerMulticast::DeleteDisabled()
+{
+    for (TUint i=0; i<(TUint)iNotifyHandlersDisabled.size(); i++) {
+        delete iNotifyHandlersDisabled[i];
+    }
+    iNotifyHandlersDisabled.clear();
+}
+
 void SsdpListenerMulticast::EraseDisabled(VectorMsearchHandler& aVector)
 {
     VectorMsearchHandler::iterator it = aVector.begin();
@@ -465,8 +586,7 @@ void SsdpListenerMulticast::NotifyResumed()
 
 // Writes request to SSDP multicast address and listens for unicast responses
 //
-// Reader chain: Multicast Socket -> Srs -> ReaderHttpRequest -> this -> aMsearch
-//                                                                    -> aNotify
+// Unicast Socket -> UdpBatchReader -> SsdpMessageParser -> this -> aNotify
 
 SsdpListenerUnicast::SsdpListenerUnicast(Environment& aEnv, ISsdpNotifyHandler& aNotifyHandler, const TIpAddress& aInterface)
     : SsdpListener("SsdpListenerU")
@@ -475,12 +595,9 @@ SsdpListenerUnicast::SsdpListenerUnicast(Environment& aEnv, ISsdpNotifyHandler&
     , iInterface(aInterface)
     , iSocket(aEnv, 0, aInterface)
     , iSocketWriter(iSocket, Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress))
-    , iSocketReader(iSocket)
+    , iReader(iSocket, kReceiveSlots, kMaxBufferBytes)
     , iWriteBuffer(iSocketWriter)
     , iWriter(iWriteBuffer)
-    , iReadBuffer(iSocketReader)
-    , iReaderUntil(iReadBuffer)
-    , iReaderResponse(aEnv, iReaderUntil)
     , iWriterLock("SSLU")
     , iExiting(false)
     , iRecreateSocket(false)
@@ -496,19 +613,20 @@ SsdpListenerUnicast::SsdpListenerUnicast(Environment& aEnv, ISsdpNotifyHandler&
     catch (NetworkError&) {}
     aEnv.AddResumeObserver(*this);
     
-    iReaderResponse.AddHeader(iHeaderCacheControl);
-    iReaderResponse.AddHeader(iHeaderExt);
-    iReaderResponse.AddHeader(iHeaderLocation);
-    iReaderResponse.AddHeader(iHeaderServer);
-    iReaderResponse.AddHeader(iHeaderSt);
-    iReaderResponse.AddHeader(iHeaderUsn);
+    iParser.AddHeader(iHeaderCacheControl, Ssdp::kHeaderCacheControl);
+    iParser.AddHeader(iHeaderExt, Ssdp::kHeaderExt);
+    iParser.AddHeader(iHeaderLocation, Ssdp::kHeaderLocation);
+    iParser.AddHeader(iHeaderServer, Ssdp::kHeaderServer);
+    iParser.AddHeader(iHeaderSt, Ssdp::kHeaderSt);
+    iParser.AddHeader(iHeaderUsn, Ssdp::kHeaderUsn);
+    iParser.AddHeader(iHeaderConfigId, Ssdp::kHeaderConfigId);
 }
 
 SsdpListenerUnicast::~SsdpListenerUnicast()
 {
     LOG(kSsdpUnicast, "SSDP Unicast        Destructor\n");
     iExiting = true;
-    iSocketReader.ReadInterrupt();
+    iReader.ReadInterrupt();
     Join();
     iEnv.RemoveResumeObserver(*this);
 }
@@ -518,80 +636,17 @@ void SsdpListenerUnicast::Run()
     LOG(kSsdpUnicast, "SSDP Unicast        Run\n");
     Signal();
     for (;;) {
-        iReaderResponse.Flush();
-
         try {
-            iReaderResponse.Read(0);
-
-            if (iReaderResponse.Version() == Http::eHttp11) {
-                if (iReaderResponse.Status() == HttpStatus::kOk) {
-                    TUint maxage = iHeaderCacheControl.MaxAge();
-                    if (maxage && iHeaderExt.Received() && iHeaderLocation.Received() && iHeaderServer.Received() && iHeaderSt.Received() && iHeaderUsn.Received()) {
-                        switch(iHeaderSt.Target()) {
-                        case eSsdpRoot:
-                            if (iHeaderUsn.Target() == eSsdpRoot) {
-                                LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Root - %.*s, %.*s, %u\n",
-                                                   PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderLocation.Location()), maxage);
-                                iNotifyHandler.SsdpNotifyRootAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage);
-                            }
-                            break;
-                        case eSsdpUuid:
-                            if (iHeaderUsn.Target() == eSsdpUuid) {
-                                if (iHeaderSt.Uuid() == iHeaderUsn.Uuid()) {
-                                    LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Uuid - %.*s, %.*s, %u\n",
-                                                      PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderLocation.Location()), maxage);
-                                    iNotifyHandler.SsdpNotifyUuidAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage);
-                                }
-                            }
-                            break;
-                        case eSsdpDeviceType:
-                            if (iHeaderUsn.Target() == eSsdpDeviceType) {
-                                if (iHeaderSt.Domain() == iHeaderUsn.Domain()) {
-                                    if (iHeaderSt.Type() == iHeaderUsn.Type()) {
-                                        if (iHeaderSt.Version() == iHeaderUsn.Version()) {
-                                            LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Device Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
-                                                              PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()),
-                                                              iHeaderSt.Version(), PBUF(iHeaderLocation.Location()), maxage);
-                                            iNotifyHandler.SsdpNotifyDeviceTypeAlive(iHeaderUsn.Uuid(), iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version(), iHeaderLocation.Location(), maxage);
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        case eSsdpServiceType:
-                            if (iHeaderUsn.Target() == eSsdpServiceType) {
-                                if (iHeaderSt.Domain() == iHeaderUsn.Domain()) {
-                                    if (iHeaderSt.Type() == iHeaderUsn.Type()) {
-                                        if (iHeaderSt.Version() == iHeaderUsn.Version()) {
-                                            LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Service Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
-                                                              PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()),
-                                                              iHeaderSt.Version(), PBUF(iHeaderLocation.Location()), maxage);
-                                            iNotifyHandler.SsdpNotifyServiceTypeAlive(iHeaderUsn.Uuid(), iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version(), iHeaderLocation.Location(), maxage);
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        default:
-                            LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected target - %u\n", iHeaderSt.Target());
-                            break;
-                        }
-                    }
-                    else {
-                        LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected headers\n");
-                    }
-                }
-                else {
-                    LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected status - %u\n", iReaderResponse.Status().Code());
-                }
+            Brn msg = iReader.Read();
+            CountReceived();
+            try {
+                Process(msg);
             }
-            else {
-                    LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected http version - %u\n", iReaderResponse.Version());
+            catch (HttpError&) {
+                CountMalformed();
+                LOG_ERROR(kSsdpUnicast, "SSDP Unicast        HttpError\n");
             }
         }
-        catch (HttpError&) {
-            LOG_ERROR(kSsdpUnicast, "SSDP Unicast        HttpError\n");
-        }
         catch (ReaderError&) {
             LOG_ERROR(kSsdpUnicast, "SSDP Unicast        ReaderError\n");
             if (iExiting) {
@@ -604,6 +659,7 @@ void SsdpListenerUnicast::Run()
         if (iRecreateSocket) {
             try {
                 AutoMutex a(iWriterLock);
+                iReader.Discard();
                 iSocket.Interrupt(false);
                 iSocket.ReBind(iSocket.Port(), iInterface);
                 iRecreateSocket = false;
@@ -615,6 +671,79 @@ void SsdpListenerUnicast::Run()
     }
 }
 
+void SsdpListenerUnicast::Process(const Brx& aMessage)
+{
+    iParser.ParseResponse(aMessage);
+    if (iParser.Version() != Http::eHttp11) {
+        LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected http version - %u\n", iParser.Version());
+        CountRejected();
+        return;
+    }
+    if (iParser.Status() != HttpStatus::kOk.Code()) {
+        LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected status - %u\n", iParser.Status());
+        CountRejected();
+        return;
+    }
+    const TUint maxage = iHeaderCacheControl.MaxAge();
+    if (maxage == 0 || !iHeaderExt.Received() || !iHeaderLocation.Received() || !iHeaderServer.Received() || !iHeaderSt.Received() || !iHeaderUsn.Received()) {
+        LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected headers\n");
+        CountRejected();
+        return;
+    }
+    const ESsdpTarget target = iHeaderSt.Target();
+    TBool valid = (iHeaderUsn.Target() == target);
+    if (valid) {
+        switch (target) {
+        case eSsdpRoot:
+            break;
+        case eSsdpUuid:
+            valid = (iHeaderSt.Uuid() == iHeaderUsn.Uuid());
+            break;
+        case eSsdpDeviceType:
+        case eSsdpServiceType:
+            valid = (iHeaderSt.Domain() == iHeaderUsn.Domain() &&
+                     iHeaderSt.Type() == iHeaderUsn.Type() &&
+                     iHeaderSt.Version() == iHeaderUsn.Version());
+            break;
+        default:
+            LOG_ERROR(kSsdpUnicast, "SSDP Unicast: unexpected target - %u\n", target);
+            valid = false;
+            break;
+        }
+    }
+    if (!valid) {
+        CountRejected();
+        return;
+    }
+
+    switch (target) {
+    case eSsdpRoot:
+        LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Root - %.*s, %.*s, %u\n",
+                          PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderLocation.Location()), maxage);
+        iNotifyHandler.SsdpNotifyRootAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage, iHeaderConfigId.ConfigId());
+        break;
+    case eSsdpUuid:
+        LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Uuid - %.*s, %.*s, %u\n",
+                          PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderLocation.Location()), maxage);
+        iNotifyHandler.SsdpNotifyUuidAlive(iHeaderUsn.Uuid(), iHeaderLocation.Location(), maxage, iHeaderConfigId.ConfigId());
+        break;
+    case eSsdpDeviceType:
+        LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Device Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
+                          PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()),
+                          iHeaderSt.Version(), PBUF(iHeaderLocation.Location()), maxage);
+        iNotifyHandler.SsdpNotifyDeviceTypeAlive(iHeaderUsn.Uuid(), iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version(), iHeaderLocation.Location(), maxage, iHeaderConfigId.ConfigId());
+        break;
+    case eSsdpServiceType:
+        LOG(kSsdpUnicast, "SSDP Unicast        Notify Alive Service Type - %.*s, %.*s, %.*s, %u, %.*s, %u\n",
+                          PBUF(iHeaderUsn.Uuid()), PBUF(iHeaderSt.Domain()), PBUF(iHeaderSt.Type()),
+                          iHeaderSt.Version(), PBUF(iHeaderLocation.Location()), maxage);
+        iNotifyHandler.SsdpNotifyServiceTypeAlive(iHeaderUsn.Uuid(), iHeaderSt.Domain(), iHeaderSt.Type(), iHeaderSt.Version(), iHeaderLocation.Location(), maxage, iHeaderConfigId.ConfigId());
+        break;
+    default:
+        break;
+    }
+}
+
 void SsdpListenerUnicast::MsearchRoot()
 {
     AutoMutex a(iWriterLock);
@@ -9,6 +9,7 @@
 #include <OpenHome/Private/Network.h>
 
 #include <vector>
+#include <map>
 
 namespace OpenHome {
 class Environment;
@@ -19,10 +20,11 @@ namespace Net {
 class ISsdpNotifyHandler
 {
 public:
-    virtual void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge) = 0;
-    virtual void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge) = 0;
-    virtual void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge) = 0;
-    virtual void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge) = 0;
+    // aConfigId is Ssdp::kConfigIdUnknown for devices which don't report CONFIGID.UPNP.ORG
+    virtual void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
+    virtual void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId) = 0;
     virtual void SsdpNotifyRootByeBye(const Brx& aUuid) = 0;
     virtual void SsdpNotifyUuidByeBye(const Brx& aUuid) = 0;
     virtual void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion) = 0;
@@ -42,32 +44,35 @@ public:
     virtual ~ISsdpMsearchHandler() {}
 };
 
-class SsdpSocketReader : public SocketUdpMulticast, public IReaderSource
-{
-public:
-    SsdpSocketReader(Environment& aEnv, const TIpAddress& aInterface, const Endpoint& aMulticast);
-    ~SsdpSocketReader();
-    Endpoint Sender() const; // endpoint of the sender to the multicast address
-private: // from IReaderSource
-    void Read(Bwx& aBuffer);
-    void ReadFlush();
-    void ReadInterrupt();
-private:
-    UdpReader* iReader;
-};
-
 // SsdpListener - base class for ListenerMulticast and ListenerUnicast
 class SsdpListener : public Thread
 {
     static const TUint kPriority = kPriorityNormal;
+public:
+    TUint MessagesReceived() const;
+    TUint MessagesMalformed() const; // dropped as they couldn't be parsed
+    TUint MessagesRejected() const;  // dropped before any handler was called (missing, inconsistent or unwanted headers)
+protected:
+    static const TUint kMaxBufferBytes = 1024;
+    static const TUint kReceiveSlots = 16;
 protected:
     SsdpListener(const TChar* aName);
+    void CountReceived();
+    void CountMalformed();
+    void CountRejected();
 protected:
+    SsdpMessageParser iParser;
     SsdpHeaderCacheControl iHeaderCacheControl;
     HttpHeaderLocation iHeaderLocation;
     SsdpHeaderServer iHeaderServer;
     SsdpHeaderSt iHeaderSt;
     SsdpHeaderUsn iHeaderUsn;
+    SsdpHeaderConfigId iHeaderConfigId;
+private:
+    mutable OpenHome::Mutex iCountLock;
+    TUint iReceived;
+    TUint iMalformed;
+    TUint iRejected;
 };
 
 // SsdpListenerMulticast - listens to the multicast udp endpoint
@@ -75,8 +80,19 @@ protected:
 class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
 {
     static const TUint kMaxMxSecs = 5; // UPnP 1.0 allows [1..120]; 1.1 reduced this to a more sensible [1..5]
-    static const TUint kMaxBufferBytes = 1024;
     static const TUint kRecvBufBytes = 32 * 1024;
+    enum ENotification
+    {
+        eNotifyInvalid
+       ,eNotifyRootAlive
+       ,eNotifyUuidAlive
+       ,eNotifyDeviceTypeAlive
+       ,eNotifyServiceTypeAlive
+       ,eNotifyRootByeBye
+       ,eNotifyUuidByeBye
+       ,eNotifyDeviceTypeByeBye
+       ,eNotifyServiceTypeByeBye
+    };
     class Handler
     {
     public:
@@ -96,10 +112,15 @@ class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
     class NotifyHandler : public Handler
     {
     public:
-        NotifyHandler(ISsdpNotifyHandler* aHandler, TInt aId) : SsdpListenerMulticast::Handler(aId), iHandler(aHandler) {}
+        NotifyHandler(ISsdpNotifyHandler* aHandler, TInt aId, ESsdpTarget aTarget, const Brx& aKey)
+            : SsdpListenerMulticast::Handler(aId), iHandler(aHandler), iTarget(aTarget), iKey(aKey) {}
         ISsdpNotifyHandler* Handler() { return iHandler; }
+        ESsdpTarget Target() const { return iTarget; }
+        const Brx& Key() const { return iKey; }
     private:
         ISsdpNotifyHandler* iHandler;
+        ESsdpTarget iTarget;
+        Brh iKey;
     };
     class MsearchHandler : public Handler
     {
@@ -111,10 +132,22 @@ class SsdpListenerMulticast : public SsdpListener, private IResumeObserver
     };
     typedef std::vector<NotifyHandler*> VectorNotifyHandler;
     typedef std::vector<MsearchHandler*> VectorMsearchHandler;
+    typedef std::map<Brn, VectorNotifyHandler, BufferCmp> NotifyIndex; // keys point into the first handler's Key()
+    static const TUint kMaxTypeKeyBytes = 129; // domain:type, as limited by SsdpHeaderNt
 public:
     SsdpListenerMulticast(Environment& aEnv, const TIpAddress& aInterface);
     virtual ~SsdpListenerMulticast();
-    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler);
+    /**
+     * aTarget restricts the notifications passed to aNotifyHandler:
+     *   eSsdpAll         - every notification
+     *   eSsdpRoot        - root device notifications
+     *   eSsdpUuid        - uuid notifications for device aUuidOrDomain
+     *   eSsdpDeviceType  - notifications for device type aType (any version) in domain aUuidOrDomain
+     *   eSsdpServiceType - notifications for service type aType (any version) in domain aUuidOrDomain
+     * Handlers are indexed by target so each notification is only passed to the handlers it matches.
+     */
+    TInt AddNotifyHandler(ISsdpNotifyHandler* aNotifyHandler, ESsdpTarget aTarget = eSsdpAll,
+                          const Brx& aUuidOrDomain = Brx::Empty(), const Brx& aType = Brx::Empty());
     TInt AddMsearchHandler(ISsdpMsearchHandler* aMsearchHandler);
     void RemoveNotifyHandler(TInt aHandlerId);
     void RemoveMsearchHandler(TInt aHandlerId);
@@ -122,26 +155,37 @@ public:
 private:
     void Run();
     void Terminated();
-    void Notify(NotifyHandler& aHandler);
-    void Notify(ISsdpNotifyHandler& aNotifyHandler);
-    void Msearch(MsearchHandler& aHandler);
-    void Msearch(ISsdpMsearchHandler& aMsearchHandler);
-    void EraseDisabled(VectorNotifyHandler& aVector);
+    void Process(const Brx& aMessage);
+    ENotification NotifyType() const;
+    TUint MsearchMx() const;
+    void Notify(NotifyHandler& aHandler, ENotification aType);
+    void Notify(ISsdpNotifyHandler& aNotifyHandler, ENotification aType);
+    void Msearch(MsearchHandler& aHandler, TUint aMx);
+    void Msearch(ISsdpMsearchHandler& aMsearchHandler, TUint aMx);
+    void NotifyHandlers(ENotification aType, VectorNotifyHandler& aHandlers) const;
+    static void AppendIndexed(const NotifyIndex& aIndex, const Brx& aKey, VectorNotifyHandler& aHandlers);
+    static void RemoveIndexed(NotifyIndex& aIndex, NotifyHandler* aHandler);
+    static void TypeKey(const Brx& aDomain, const Brx& aType, Bwx& aKey);
+    void DeleteDisabled();
     void EraseDisabled(VectorMsearchHandler& aVector);
     void DnsChanged();
 private: // from IResumeObserver
     void NotifyResumed();
 private:
     Environment& iEnv;
-    VectorNotifyHandler iNotifyHandlers;
+    VectorNotifyHandler iNotifyHandlers;         // every registered handler
+    VectorNotifyHandler iNotifyHandlersAll;      // handlers for eSsdpAll
+    VectorNotifyHandler iNotifyHandlersRoot;     // handlers for eSsdpRoot
+    NotifyIndex iNotifyHandlersUuid;             // handlers for eSsdpUuid, indexed by uuid
+    NotifyIndex iNotifyHandlersDeviceType;       // handlers for eSsdpDeviceType, indexed by domain:type
+    NotifyIndex iNotifyHandlersServiceType;      // handlers for eSsdpServiceType, indexed by domain:type
+    VectorNotifyHandler iNotifyHandlersDisabled; // removed but possibly still referenced by Run()
     VectorMsearchHandler iMsearchHandlers;
     OpenHome::Mutex iLock;
     TInt iNextHandlerId;
     TIpAddress iInterface;
-    SsdpSocketReader iSocket;
-    Srs<kMaxBufferBytes> iBuffer;
-    ReaderUntilS<kMaxBufferBytes> iReaderUntil;
-    ReaderHttpRequest iReaderRequest;
+    SocketUdpMulticast iSocket;
+    UdpBatchReader iReader;
     SsdpHeaderHost iHeaderHost;
     SsdpHeaderMan iHeaderMan;
     SsdpHeaderMx iHeaderMx;
@@ -156,7 +200,6 @@ private:
 //                     - processes received messages and passes them on an INotifyHandler
 class SsdpListenerUnicast : public SsdpListener, private IResumeObserver
 {
-    static const TUint kMaxBufferBytes = 1024;
     static const TUint kRecvBufBytes = 64 * 1024;
 public:
     SsdpListenerUnicast(Environment& aEnv, ISsdpNotifyHandler& aNotifyHandler, const TIpAddress& aInterface);
@@ -171,18 +214,16 @@ private: // from IResumeObserver
 private:
     TUint MsearchDurationSeconds() const;
     void Run();
+    void Process(const Brx& aMessage);
 private:
     Environment& iEnv;
     ISsdpNotifyHandler& iNotifyHandler;
     TIpAddress iInterface;
     SocketUdp iSocket;
     UdpWriter iSocketWriter;
-    UdpReader iSocketReader;
+    UdpBatchReader iReader;
     Sws<kMaxBufferBytes> iWriteBuffer;
     SsdpWriterMsearchRequest iWriter;
-    Srs<kMaxBufferBytes> iReadBuffer;
-    ReaderUntilS<kMaxBufferBytes> iReaderUntil;
-    ReaderHttpResponse iReaderResponse;
     Mutex iWriterLock;
     SsdpHeaderExt iHeaderExt;
     TBool iExiting;
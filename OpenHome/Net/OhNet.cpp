@@ -400,6 +400,41 @@ void InitialisationParams::SetCpUpnpEventServerPort(TUint aPort)
     iCpUpnpEventServerPort = aPort;
 }
 
+void InitialisationParams::SetCpInvocationKeepAlive(uint32_t aMaxIdleConnections, uint32_t aIdleTimeoutMs)
+{
+    ASSERT(aMaxIdleConnections == 0 || aIdleTimeoutMs != 0);
+    iCpInvocationKeepAliveMaxIdle = aMaxIdleConnections;
+    iCpInvocationKeepAliveIdleTimeoutMs = aIdleTimeoutMs;
+}
+
+void InitialisationParams::SetCpUpnpDeviceCache(const TChar* aPath, uint32_t aMaxAgeSecs)
+{
+    ASSERT(aPath != NULL);
+    iCpUpnpDeviceCachePath.Set(aPath);
+    iCpUpnpDeviceCacheMaxAgeSecs = aMaxAgeSecs;
+}
+
+void InitialisationParams::SetCpLpecMaxPipelinedRequests(uint32_t aMaxRequests)
+{
+    ASSERT(aMaxRequests > 0);
+    iCpLpecMaxPipelinedRequests = aMaxRequests;
+}
+
+void InitialisationParams::SetCpMaxInvokersPerDevice(uint32_t aMaxInvokers)
+{
+    iCpMaxInvokersPerDevice = aMaxInvokers;
+}
+
+void InitialisationParams::SetCpInvocationPolling(bool aEnable)
+{
+    iCpInvocationPolling = aEnable;
+}
+
+void InitialisationParams::SetCpSyncInvocationsOnCallerThread(bool aEnable)
+{
+    iCpSyncInvocationsOnCallerThread = aEnable;
+}
+
 void InitialisationParams::SetDvUpnpServerPort(TUint aPort)
 {
     iDvUpnpWebServerPort = aPort;
@@ -410,6 +445,12 @@ void InitialisationParams::SetDvWebSocketPort(TUint aPort)
     iDvWebSocketPort = aPort;
 }
 
+void InitialisationParams::SetDvWebSocketDeflate(bool aContextTakeover)
+{
+    iDvWebSocketDeflate = true;
+    iDvWebSocketDeflateContextTakeover = aContextTakeover;
+}
+
 void InitialisationParams::SetDvEnableBonjour(const TChar* aHostName, TBool aRequiresMdnsCache)
 {
     iDvBonjourHostName.Set(aHostName);
@@ -437,6 +478,31 @@ void InitialisationParams::SetDvAnnouncementIntervals(uint32_t aByeByeMs, uint32
     iDvAnnouncementIntervalAliveMs = aAliveMs;
 }
 
+void InitialisationParams::SetDvSsdpBatchSize(uint32_t aMaxMsgs)
+{
+    ASSERT(aMaxMsgs != 0);
+    iDvSsdpBatchSize = aMaxMsgs;
+}
+
+void InitialisationParams::SetDvUpnpKeepAlive(uint32_t aMaxRequests, uint32_t aIdleTimeoutMs)
+{
+    ASSERT(aMaxRequests <= 1 || aIdleTimeoutMs != 0);
+    iDvUpnpKeepAliveMaxRequests = aMaxRequests;
+    iDvUpnpKeepAliveIdleTimeoutMs = aIdleTimeoutMs;
+}
+
+void InitialisationParams::SetDvUpnpParkIdleConnections(uint32_t aMaxConnections)
+{
+    iDvUpnpParkIdleConnections = aMaxConnections;
+}
+
+void InitialisationParams::SetDvEventKeepAlive(uint32_t aMaxIdleConnections, uint32_t aIdleTimeoutMs)
+{
+    ASSERT(aMaxIdleConnections == 0 || aIdleTimeoutMs != 0);
+    iDvEventKeepAliveMaxIdle = aMaxIdleConnections;
+    iDvEventKeepAliveIdleTimeoutMs = aIdleTimeoutMs;
+}
+
 void InitialisationParams::SetHostUdpIsLowQuality(TBool aLow)
 {
     iHostUdpLowQuality = aLow;
@@ -624,6 +690,39 @@ uint32_t InitialisationParams::CpUpnpEventServerPort() const
     return iCpUpnpEventServerPort;
 }
 
+void InitialisationParams::GetCpInvocationKeepAlive(uint32_t& aMaxIdleConnections, uint32_t& aIdleTimeoutMs) const
+{
+    aMaxIdleConnections = iCpInvocationKeepAliveMaxIdle;
+    aIdleTimeoutMs = iCpInvocationKeepAliveIdleTimeoutMs;
+}
+
+bool InitialisationParams::CpIsUpnpDeviceCacheEnabled(const TChar*& aPath, uint32_t& aMaxAgeSecs) const
+{
+    aPath = iCpUpnpDeviceCachePath.CString();
+    aMaxAgeSecs = iCpUpnpDeviceCacheMaxAgeSecs;
+    return (iCpUpnpDeviceCachePath.Bytes() > 0);
+}
+
+uint32_t InitialisationParams::CpLpecMaxPipelinedRequests() const
+{
+    return iCpLpecMaxPipelinedRequests;
+}
+
+uint32_t InitialisationParams::CpMaxInvokersPerDevice() const
+{
+    return iCpMaxInvokersPerDevice;
+}
+
+bool InitialisationParams::CpInvocationPolling() const
+{
+    return iCpInvocationPolling;
+}
+
+bool InitialisationParams::CpSyncInvocationsOnCallerThread() const
+{
+    return iCpSyncInvocationsOnCallerThread;
+}
+
 uint32_t InitialisationParams::DvUpnpServerPort() const
 {
     // Disable conflation of use of Bonjour with MDNS hostname setting for UPnP devices
@@ -638,6 +737,12 @@ uint32_t InitialisationParams::DvWebSocketPort() const
     return iDvWebSocketPort;
 }
 
+bool InitialisationParams::DvWebSocketDeflate(bool& aContextTakeover) const
+{
+    aContextTakeover = iDvWebSocketDeflateContextTakeover;
+    return iDvWebSocketDeflate;
+}
+
 bool InitialisationParams::DvIsBonjourEnabled(const TChar*& aHostName, TBool& aRequiresMdnsCache) const
 {
     aHostName = iDvBonjourHostName.CString();
@@ -661,6 +766,28 @@ void InitialisationParams::GetDvAnnouncementIntervals(uint32_t& aByeByeMs, uint3
     aAliveMs = iDvAnnouncementIntervalAliveMs;
 }
 
+uint32_t InitialisationParams::DvSsdpBatchSize() const
+{
+    return iDvSsdpBatchSize;
+}
+
+void InitialisationParams::GetDvUpnpKeepAlive(uint32_t& aMaxRequests, uint32_t& aIdleTimeoutMs) const
+{
+    aMaxRequests = iDvUpnpKeepAliveMaxRequests;
+    aIdleTimeoutMs = iDvUpnpKeepAliveIdleTimeoutMs;
+}
+
+uint32_t InitialisationParams::DvUpnpParkIdleConnections() const
+{
+    return iDvUpnpParkIdleConnections;
+}
+
+void InitialisationParams::GetDvEventKeepAlive(uint32_t& aMaxIdleConnections, uint32_t& aIdleTimeoutMs) const
+{
+    aMaxIdleConnections = iDvEventKeepAliveMaxIdle;
+    aIdleTimeoutMs = iDvEventKeepAliveIdleTimeoutMs;
+}
+
 bool InitialisationParams::IsHostUdpLowQuality()
 {
     return iHostUdpLowQuality;
@@ -723,8 +850,17 @@ InitialisationParams::InitialisationParams()
     , iDvPublisherThreadPriority(kPriorityNormal)
     , iDvNumWebSocketThreads(0)
     , iCpUpnpEventServerPort(0)
+    , iCpInvocationKeepAliveMaxIdle(0)
+    , iCpInvocationKeepAliveIdleTimeoutMs(0)
+    , iCpUpnpDeviceCacheMaxAgeSecs(0)
+    , iCpLpecMaxPipelinedRequests(8)
+    , iCpMaxInvokersPerDevice(0)
+    , iCpInvocationPolling(true)
+    , iCpSyncInvocationsOnCallerThread(false)
     , iDvUpnpWebServerPort(0)
     , iDvWebSocketPort(0)
+    , iDvWebSocketDeflate(false)
+    , iDvWebSocketDeflateContextTakeover(true)
     , iHostUdpLowQuality(HOST_UDP_LOW_QUALITY_DEFAULT)
     , iEnableBonjour(false)
     , iRequiresMdnsCache(false)
@@ -733,6 +869,12 @@ InitialisationParams::InitialisationParams()
     , iDvLpecServerPort(0)
     , iDvAnnouncementIntervalByeByeMs(10)
     , iDvAnnouncementIntervalAliveMs(40)
+    , iDvSsdpBatchSize(1)
+    , iDvUpnpKeepAliveMaxRequests(0)
+    , iDvUpnpKeepAliveIdleTimeoutMs(0)
+    , iDvUpnpParkIdleConnections(0)
+    , iDvEventKeepAliveMaxIdle(0)
+    , iDvEventKeepAliveIdleTimeoutMs(0)
     , iTimerManagerThreadPriority(kPriorityHigh)
     , iEnableShell(false)
     , iShellPort(0)
@@ -342,11 +342,88 @@ public:
      * requirements) running on a device.
      */ 
     void SetCpUpnpEventServerPort(TUint aPort);
+    /**
+     * Reuse TCP connections for UPnP action invocations on a device.
+     * Disabled by default, in which case each invocation uses a new connection.
+     *
+     * @param[in] aMaxIdleConnections  Maximum number of idle connections to keep open
+     *                                 for each device.  0 disables reuse.
+     * @param[in] aIdleTimeoutMs       Time after which an unused connection is closed.
+     */
+    void SetCpInvocationKeepAlive(uint32_t aMaxIdleConnections, uint32_t aIdleTimeoutMs);
+    /**
+     * Remember UPnP devices discovered by the control point stack between runs.
+     * Disabled by default.
+     * The devices are saved when the library is closed.  At the next startup, UPnP device
+     * lists report any matching devices last seen on the current network adapter
+     * straight away, before they have been re-discovered.  These devices have the
+     * attribute "Upnp.Tentative" set to "true" until they respond to a msearch or
+     * announce themselves.  They are removed if they can't be contacted at their
+     * last known location or aren't re-discovered within the duration of a refresh.
+     *
+     * @param[in] aPath        File to store devices in.  Its directory must be writable
+     *                         (the file is replaced via a temporary aPath.tmp).
+     * @param[in] aMaxAgeSecs  Devices not seen for longer than this are discarded.
+     */
+    void SetCpUpnpDeviceCache(const TChar* aPath, uint32_t aMaxAgeSecs);
+    /**
+     * Set the maximum number of requests (actions or (un)subscriptions) a control point
+     * may have outstanding on each LPEC connection.
+     * Requests beyond this block until an earlier one completes.  1 disables pipelining.
+     * Must be greater than zero.
+     */
+    void SetCpLpecMaxPipelinedRequests(uint32_t aMaxRequests);
+    /**
+     * Set the maximum number of action invoker threads (see SetNumActionInvokerThreads())
+     * a single device may use at once.
+     * Further invocations on that device wait while those for other devices proceed.
+     * The default value of 0 doesn't limit devices, allowing any one to use all invoker threads.
+     */
+    void SetCpMaxInvokersPerDevice(uint32_t aMaxInvokers);
+    /**
+     * Set whether UPnP action invocations release their invoker thread while waiting for
+     * a device to respond.  Waiting invocations are then watched by a single thread.
+     * Only has an effect on platforms which can poll many sockets (currently Linux).
+     * Enabled by default.
+     */
+    void SetCpInvocationPolling(bool aEnable);
+    /**
+     * Set whether synchronous proxy actions (Sync*() functions) run on the calling thread
+     * rather than being passed to an action invoker thread while the caller waits.
+     * This saves two thread switches per action.  Invocation timeouts and interruption
+     * by proxy deletion are unaffected but the number of invoker threads (see
+     * SetNumActionInvokerThreads()) no longer limits how many sync actions can run at once.
+     * Read on each invocation so can be changed at any time.  Disabled by default.
+     */
+    void SetCpSyncInvocationsOnCallerThread(bool aEnable);
     /**
      * Set the tcp port number the device stack's UPnP web server will run on.
      * The default value is 0 (OS-assigned).
      */ 
     void SetDvUpnpServerPort(TUint aPort);
+    /**
+     * Allow control points to send several HTTP/1.1 requests on one connection to the
+     * device stack's UPnP web server.
+     * Disabled by default, in which case the server closes the connection after each request.
+     * Each persistent connection occupies one of the DvNumServerThreads session threads
+     * while it is open.
+     *
+     * @param[in] aMaxRequests     Maximum number of requests handled on a connection before
+     *                             it is closed.  0 or 1 disables keep-alive.
+     * @param[in] aIdleTimeoutMs   Time to wait for a further request before closing the connection.
+     */
+    void SetDvUpnpKeepAlive(uint32_t aMaxRequests, uint32_t aIdleTimeoutMs);
+    /**
+     * Let idle persistent connections to the device stack's UPnP web server wait for their
+     * next request without occupying a session thread.
+     * Only has an effect if SetDvUpnpKeepAlive() has enabled keep-alive and the platform
+     * supports polling many sockets (currently Linux only).  Disabled by default.
+     *
+     * @param[in] aMaxConnections  Maximum number of idle connections per network adapter.
+     *                             The longest idle connection is closed to make room for
+     *                             another.  0 disables parking.
+     */
+    void SetDvUpnpParkIdleConnections(uint32_t aMaxConnections);
     /**
      * Set the tcp port number the device stack's websocket servers will run on.
      * The default value is 0 (meaning that the OS will assign a port).
@@ -354,6 +431,15 @@ public:
      * requirements) running on a device.
      */
     void SetDvWebSocketPort(TUint aPort);
+    /**
+     * Offer permessage-deflate compression (RFC 7692) to WebSocket clients which request it.
+     * Disabled by default.  Has no effect unless ohNet was built with zlib support.
+     *
+     * @param[in] aContextTakeover  true to reuse the compression context across messages
+     *                              (better compression, ~300kB extra memory per session);
+     *                              false to compress each message independently.
+     */
+    void SetDvWebSocketDeflate(bool aContextTakeover);
     /**
      * Enable use of Bonjour.
      * All DvDevice instances with an IResourceManager will be published using Bonjour.
@@ -379,6 +465,24 @@ public:
      * Set the minimum gap (per device) between multicast announcement messages.
      */
     void SetDvAnnouncementIntervals(uint32_t aByeByeMs, uint32_t aAliveMs);
+    /**
+     * Send up to aMaxMsgs SSDP announcement or m-search response messages per timer callback.
+     * The default value of 1 spreads messages individually over the announcement / MX period.
+     * Higher values build each group of messages into a single buffer and send it in one
+     * go (using a single system call where the platform allows), reducing per-message
+     * timer and socket overheads for devices with many services or embedded devices.
+     * Groups are still sent at random intervals within the same overall period.
+     */
+    void SetDvSsdpBatchSize(uint32_t aMaxMsgs);
+    /**
+     * Reuse TCP connections for UPnP event (NOTIFY) messages to HTTP/1.1 subscribers.
+     * Disabled by default, in which case each event uses a new connection.
+     *
+     * @param[in] aMaxIdleConnections  Maximum number of idle connections (across all
+     *                                 subscribers) to keep open.  0 disables reuse.
+     * @param[in] aIdleTimeoutMs       Time after which an unused connection is closed.
+     */
+    void SetDvEventKeepAlive(uint32_t aMaxIdleConnections, uint32_t aIdleTimeoutMs);
     /**
      * Inform ohNet that UDP will be measurably unreliable on even a local network.
      * (e.g. for an Apple device using wifi)
@@ -441,12 +545,23 @@ public:
     uint32_t DvPublisherModerationTimeMs() const;
     uint32_t DvNumWebSocketThreads() const;
     uint32_t CpUpnpEventServerPort() const;
+    void GetCpInvocationKeepAlive(uint32_t& aMaxIdleConnections, uint32_t& aIdleTimeoutMs) const;
+    bool CpIsUpnpDeviceCacheEnabled(const TChar*& aPath, uint32_t& aMaxAgeSecs) const;
+    uint32_t CpLpecMaxPipelinedRequests() const;
+    uint32_t CpMaxInvokersPerDevice() const;
+    bool CpInvocationPolling() const;
+    bool CpSyncInvocationsOnCallerThread() const;
     uint32_t DvUpnpServerPort() const;
     uint32_t DvWebSocketPort() const;
+    bool DvWebSocketDeflate(bool& aContextTakeover) const;
     bool DvIsBonjourEnabled(const TChar*& aHostName, TBool& aRequiresMdnsCache) const;
     uint32_t DvNumLpecThreads();
     uint32_t DvLpecServerPort();
     void GetDvAnnouncementIntervals(uint32_t& aByeByeMs, uint32_t& aAliveMs);
+    uint32_t DvSsdpBatchSize() const;
+    void GetDvUpnpKeepAlive(uint32_t& aMaxRequests, uint32_t& aIdleTimeoutMs) const;
+    uint32_t DvUpnpParkIdleConnections() const;
+    void GetDvEventKeepAlive(uint32_t& aMaxIdleConnections, uint32_t& aIdleTimeoutMs) const;
     bool IsHostUdpLowQuality();
     uint32_t TimerManagerPriority() const;
     const Brx& HttpUserAgent() const;
@@ -489,8 +604,18 @@ private:
     uint32_t iDvPublisherThreadPriority;
     uint32_t iDvNumWebSocketThreads;
     uint32_t iCpUpnpEventServerPort;
+    uint32_t iCpInvocationKeepAliveMaxIdle;
+    uint32_t iCpInvocationKeepAliveIdleTimeoutMs;
+    Brhz iCpUpnpDeviceCachePath;
+    uint32_t iCpUpnpDeviceCacheMaxAgeSecs;
+    uint32_t iCpLpecMaxPipelinedRequests;
+    uint32_t iCpMaxInvokersPerDevice;
+    bool iCpInvocationPolling;
+    bool iCpSyncInvocationsOnCallerThread;
     uint32_t iDvUpnpWebServerPort;
     uint32_t iDvWebSocketPort;
+    bool iDvWebSocketDeflate;
+    bool iDvWebSocketDeflateContextTakeover;
     bool iHostUdpLowQuality;
     bool iEnableBonjour;
     bool iRequiresMdnsCache;
@@ -500,6 +625,12 @@ private:
     uint32_t iDvLpecServerPort;
     uint32_t iDvAnnouncementIntervalByeByeMs;
     uint32_t iDvAnnouncementIntervalAliveMs;
+    uint32_t iDvSsdpBatchSize;
+    uint32_t iDvUpnpKeepAliveMaxRequests;
+    uint32_t iDvUpnpKeepAliveIdleTimeoutMs;
+    uint32_t iDvUpnpParkIdleConnections;
+    uint32_t iDvEventKeepAliveMaxIdle;
+    uint32_t iDvEventKeepAliveIdleTimeoutMs;
     uint32_t iTimerManagerThreadPriority;
     Brh iUserAgent;
     TBool iEnableShell;
@@ -739,6 +739,29 @@ void SsdpHeaderMx::Process(const Brx& aValue)
     }
 }
 
+// SsdpHeaderConfigId
+
+TUint SsdpHeaderConfigId::ConfigId() const
+{
+    return (Received()? iConfigId : Ssdp::kConfigIdUnknown);
+}
+
+TBool SsdpHeaderConfigId::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, Ssdp::kHeaderConfigId);
+}
+
+void SsdpHeaderConfigId::Process(const Brx& aValue)
+{
+    // a malformed CONFIGID is treated as absent rather than invalidating the whole message
+    try {
+        iConfigId = Ascii::Uint(aValue);
+        SetReceived();
+    }
+    catch (AsciiError&) {
+    }
+}
+
 // SsdpHeaderNts
 
 TBool SsdpHeaderNts::Alive() const
@@ -782,6 +805,138 @@ void SsdpHeaderExt::Process(const Brx& aValue)
     SetReceived();
 }
 
+// SsdpMessageParser
+
+SsdpMessageParser::Entry::Entry()
+    : iHeader(NULL)
+{
+}
+
+SsdpMessageParser::SsdpMessageParser()
+    : iStatus(0)
+    , iVersion(Http::eHttp11)
+{
+}
+
+void SsdpMessageParser::AddHeader(IHttpHeader& aHeader, const Brx& aField)
+{
+    ASSERT(iHeaders.size() < kMaxHeaders);
+    ASSERT(FindHeader(aField) == NULL);
+    TUint slot = Slot(aField);
+    while (iTable[slot].iHeader != NULL) {
+        slot = (slot + 1) & (kTableSlots - 1);
+    }
+    iTable[slot].iField.Set(aField);
+    iTable[slot].iHeader = &aHeader;
+    iHeaders.push_back(&aHeader);
+}
+
+void SsdpMessageParser::ParseRequest(const Brx& aMessage)
+{
+    Parser parser(aMessage);
+    Parser line(StartLine(parser));
+    iMethod.Set(line.Next());
+    iUri.Set(line.Next());
+    iVersion = Http::Version(Ascii::Trim(line.Remaining())); // may throw HttpError
+    ParseHeaders(parser);
+}
+
+void SsdpMessageParser::ParseResponse(const Brx& aMessage)
+{
+    Parser parser(aMessage);
+    Parser line(StartLine(parser));
+    iVersion = Http::Version(line.Next()); // may throw HttpError
+    try {
+        iStatus = Ascii::Uint(line.Next());
+    }
+    catch (AsciiError&) {
+        THROW(HttpError);
+    }
+    ParseHeaders(parser);
+}
+
+const Brx& SsdpMessageParser::Method() const
+{
+    return iMethod;
+}
+
+const Brx& SsdpMessageParser::Uri() const
+{
+    return iUri;
+}
+
+TUint SsdpMessageParser::Status() const
+{
+    return iStatus;
+}
+
+Http::EVersion SsdpMessageParser::Version() const
+{
+    return iVersion;
+}
+
+Brn SsdpMessageParser::StartLine(Parser& aParser)
+{
+    for (TUint i=0; i<iHeaders.size(); i++) {
+        iHeaders[i]->Reset();
+    }
+    while (!aParser.Finished()) {
+        Brn line = Ascii::Trim(aParser.Next(Ascii::kLf));
+        if (line.Bytes() > 0) {
+            return line;
+        }
+    }
+    THROW(HttpError);
+}
+
+void SsdpMessageParser::ParseHeaders(Parser& aParser)
+{
+    while (!aParser.Finished()) {
+        Brn raw = aParser.NextNoTrim(Ascii::kLf);
+        Brn line = Ascii::Trim(raw);
+        if (line.Bytes() == 0) {
+            return; // end of headers
+        }
+        if (Ascii::IsWhitespace(raw[0])) {
+            continue; // a line starting with spaces is a continuation line
+        }
+        Parser header(line);
+        Brn field = header.Next(':');
+        IHttpHeader* target = FindHeader(field);
+        if (target != NULL) {
+            target->Process(Ascii::Trim(header.Remaining()));
+        }
+    }
+}
+
+IHttpHeader* SsdpMessageParser::FindHeader(const Brx& aField) const
+{
+    TUint slot = Slot(aField);
+    for (;;) { // table is never full so this always terminates at an unused slot
+        const Entry& entry = iTable[slot];
+        if (entry.iHeader == NULL) {
+            return NULL;
+        }
+        if (entry.iField.Bytes() == aField.Bytes() && Ascii::CaseInsensitiveEquals(entry.iField, aField)) {
+            return entry.iHeader;
+        }
+        slot = (slot + 1) & (kTableSlots - 1);
+    }
+}
+
+TUint SsdpMessageParser::Slot(const Brx& aField)
+{
+    // SSDP field names are short and mostly differ in length or first character
+    const TUint bytes = aField.Bytes();
+    if (bytes == 0) {
+        return 0;
+    }
+    const TUint first = (TByte)Ascii::ToLowerCase(aField[0]);
+    const TUint last = (TByte)Ascii::ToLowerCase(aField[bytes-1]);
+    return ((bytes * 7) + (first * 3) + last) & (kTableSlots - 1);
+}
+
+
 // SsdpWriterMsearchRequest
 
 SsdpWriterMsearchRequest::SsdpWriterMsearchRequest(IWriter& aWriter)
@@ -6,6 +6,9 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Private/Stream.h>
 #include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Parser.h>
+
+#include <vector>
 
 namespace OpenHome {
 
@@ -28,6 +31,7 @@ enum ESsdpTarget
 class Ssdp
 {
 public:
+    static const TUint kConfigIdUnknown = 0xffffffff; // reported when a device doesn't include CONFIGID.UPNP.ORG
     static const TByte kUrnSeparator;
     static const TUint kMulticastPort;
     static const Brn kUrn;
@@ -213,6 +217,18 @@ private:
     TUint iMx;
 };
 
+class SsdpHeaderConfigId : public HttpHeader
+{
+public:
+    TUint ConfigId() const; // Ssdp::kConfigIdUnknown if header not received
+private:
+    // IHttpHeader
+    virtual TBool Recognise(const Brx& aHeader);
+    virtual void Process(const Brx& aValue);
+private:
+    TUint iConfigId;
+};
+
 class SsdpHeaderNts : public HttpHeader
 {
 public:
@@ -233,6 +249,49 @@ private:
     virtual void Process(const Brx& aValue);
 };
 
+/**
+ * Tokenises a single SSDP datagram in place.
+ *
+ * Field names are matched against a table built as headers are added so each
+ * recognised value is passed straight to its header, without copying the message
+ * or asking every header to Recognise() every field.
+ */
+class SsdpMessageParser : private INonCopyable
+{
+    static const TUint kTableSlots = 32; // must be a power of 2
+    static const TUint kMaxHeaders = kTableSlots / 2;
+public:
+    SsdpMessageParser();
+    void AddHeader(IHttpHeader& aHeader, const Brx& aField);
+    void ParseRequest(const Brx& aMessage);  // throws HttpError if malformed
+    void ParseResponse(const Brx& aMessage); // throws HttpError if malformed
+    const Brx& Method() const; // only valid after ParseRequest()
+    const Brx& Uri() const;    // only valid after ParseRequest()
+    TUint Status() const;      // only valid after ParseResponse()
+    Http::EVersion Version() const;
+private:
+    Brn StartLine(Parser& aParser);
+    void ParseHeaders(Parser& aParser);
+    IHttpHeader* FindHeader(const Brx& aField) const;
+    static TUint Slot(const Brx& aField);
+private:
+    class Entry
+    {
+    public:
+        Entry();
+    public:
+        Brn iField;
+        IHttpHeader* iHeader;
+    };
+private:
+    Entry iTable[kTableSlots];
+    std::vector<IHttpHeader*> iHeaders;
+    Brn iMethod;
+    Brn iUri;
+    TUint iStatus;
+    Http::EVersion iVersion;
+};
+
 class SsdpWriterMsearchRequest
 {
 public:
@@ -261,8 +320,9 @@ public:
        ,EUpdate
     };
 public:
-    SsdpNotifier(DvStack& aDvStack);
+    SsdpNotifier(DvStack& aDvStack, TUint aMaxBatchMsgs);
     void Start(TIpAddress aInterface, TUint aConfigId);
+    void Flush(); // sends all messages written since the last call
     // ISsdpNotify-based services
     void SsdpNotifyRoot(const Brx& aUuid, const Brx& aUri, ENotificationType aNotificationType);
     void SsdpNotifyUuid(const Brx& aUuid, const Brx& aUri, ENotificationType aNotificationType);
@@ -275,7 +335,7 @@ private:
 private:
     DvStack& iDvStack;
     SocketUdp iSocket;
-    UdpWriter iSocketWriter;
+    UdpBatchWriter iBatch;
     Sws<kMaxBufferBytes> iBuffer;
     WriterHttpRequest iWriter;
     TUint iConfigId;
@@ -333,8 +393,9 @@ private:
 class SsdpMsearchResponder : public ISsdpNotify
 {
 public:
-    SsdpMsearchResponder(DvStack& aDvStack);
+    SsdpMsearchResponder(DvStack& aDvStack, TUint aMaxBatchMsgs);
     void SetRemote(const Endpoint& aEndpoint, TUint aConfigId, TIpAddress aAdapter);
+    void Flush(); // sends all responses written since the last call
     // ISsdpNotify
     void SsdpNotifyRoot(const Brx& aUuid, const Brx& aUri);
     void SsdpNotifyUuid(const Brx& aUuid, const Brx& aUri);
@@ -342,13 +403,14 @@ public:
     void SsdpNotifyServiceType(const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aUuid, const Brx& aUri);
 private:
     void SsdpNotify(const Brx& aUri);
-    void Flush();
+    void WriteResponse();
 private:
     static const TUint kMaxBufferBytes = 1024;
 private:
     DvStack& iDvStack;
     Bws<kMaxBufferBytes> iResponse;
     WriterBuffer iBuffer;
+    UdpBatchWriter iBatch;
     WriterHttpResponse iWriter;
     TUint iConfigId;
     Endpoint iRemote;
@@ -32,11 +32,11 @@ void Ssdp::WriteNextBootId(DvStack& aDvStack, IWriterHttpHeader& aWriter)
 
 // SsdpNotifier
 
-SsdpNotifier::SsdpNotifier(DvStack& aDvStack)
+SsdpNotifier::SsdpNotifier(DvStack& aDvStack, TUint aMaxBatchMsgs)
     : iDvStack(aDvStack)
     , iSocket(aDvStack.Env())
-    , iSocketWriter(iSocket, Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress))
-    , iBuffer(iSocketWriter)
+    , iBatch(aMaxBatchMsgs, kMaxBufferBytes)
+    , iBuffer(iBatch)
     , iWriter(iBuffer)
     , iConfigId(0)
 {
@@ -48,6 +48,12 @@ void SsdpNotifier::Start(TIpAddress aInterface, TUint aConfigId)
     iSocket.SetMulticastIf(aInterface);
     iSocket.SetTtl(iDvStack.Env().InitParams()->MsearchTtl());
     iConfigId = aConfigId;
+    iBatch.Clear();
+}
+
+void SsdpNotifier::Flush()
+{
+    iBatch.Send(iSocket, Endpoint(Ssdp::kMulticastPort, Ssdp::kMulticastAddress));
 }
 
 void SsdpNotifier::SsdpNotify(const Brx& aUri, ENotificationType aNotificationType)
@@ -193,9 +199,10 @@ void SsdpNotifierUpdate::SsdpNotifyServiceType(const Brx& aDomain, const Brx& aT
 
 // SsdpMsearchResponder
 
-SsdpMsearchResponder::SsdpMsearchResponder(DvStack& aDvStack)
+SsdpMsearchResponder::SsdpMsearchResponder(DvStack& aDvStack, TUint aMaxBatchMsgs)
     : iDvStack(aDvStack)
     , iBuffer(iResponse)
+    , iBatch(aMaxBatchMsgs, kMaxBufferBytes)
     , iWriter(iBuffer)
     , iConfigId(0)
 {
@@ -206,6 +213,15 @@ void SsdpMsearchResponder::SetRemote(const Endpoint& aEndpoint, TUint aConfigId,
     iRemote.Replace(aEndpoint);
     iConfigId = aConfigId;
     iAdapter = aAdapter;
+    iBatch.Clear();
+}
+
+void SsdpMsearchResponder::Flush()
+{
+    if (iBatch.Count() > 0) {
+        SocketUdp socket(iDvStack.Env(), 0, iAdapter);
+        iBatch.Send(socket, iRemote);
+    }
 }
 
 void SsdpMsearchResponder::SsdpNotify(const Brx& aUri)
@@ -221,11 +237,11 @@ void SsdpMsearchResponder::SsdpNotify(const Brx& aUri)
     // !!!! Ssdp::WriteSearchPort(iWriter, ????);
 }
 
-void SsdpMsearchResponder::Flush()
+void SsdpMsearchResponder::WriteResponse()
 {
     iWriter.WriteFlush();
-    SocketUdp socket(iDvStack.Env(), 0, iAdapter);
-    socket.Send(iResponse, iRemote);
+    iBatch.Write(iResponse);
+    iBatch.WriteFlush();
     iBuffer.Flush();
 }
 
@@ -234,7 +250,7 @@ void SsdpMsearchResponder::SsdpNotifyRoot(const Brx& aUuid, const Brx& aUri)
     SsdpNotify(aUri);
     Ssdp::WriteSearchTypeRoot(iWriter);
     Ssdp::WriteUsnRoot(iWriter, aUuid);
-    Flush();
+    WriteResponse();
 }
 
 void SsdpMsearchResponder::SsdpNotifyUuid(const Brx& aUuid, const Brx& aUri)
@@ -242,7 +258,7 @@ void SsdpMsearchResponder::SsdpNotifyUuid(const Brx& aUuid, const Brx& aUri)
     SsdpNotify(aUri);
     Ssdp::WriteSearchTypeUuid(iWriter, aUuid);
     Ssdp::WriteUsnUuid(iWriter, aUuid);
-    Flush();
+    WriteResponse();
 }
 
 void SsdpMsearchResponder::SsdpNotifyDeviceType(const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aUuid, const Brx& aUri)
@@ -250,7 +266,7 @@ void SsdpMsearchResponder::SsdpNotifyDeviceType(const Brx& aDomain, const Brx& a
     SsdpNotify(aUri);
     Ssdp::WriteSearchTypeDeviceType(iWriter, aDomain, aType, aVersion);
     Ssdp::WriteUsnDeviceType(iWriter, aDomain, aType, aVersion, aUuid);
-    Flush();
+    WriteResponse();
 }
 
 void SsdpMsearchResponder::SsdpNotifyServiceType(const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aUuid, const Brx& aUri)
@@ -258,5 +274,5 @@ void SsdpMsearchResponder::SsdpNotifyServiceType(const Brx& aDomain, const Brx&
     SsdpNotify(aUri);
     Ssdp::WriteSearchTypeServiceType(iWriter, aDomain, aType, aVersion);
     Ssdp::WriteUsnServiceType(iWriter, aDomain, aType, aVersion, aUuid);
-    Flush();
+    WriteResponse();
 }
@@ -56,6 +56,7 @@ namespace OpenHome.Net
             eUndefined,
             eCpp,
             eCppCore,
+            eCppAwaitable,
             eC,
             eCs,
             eJava,
@@ -91,6 +92,10 @@ namespace OpenHome.Net
                     {
                         language = ETargetLanguage.eCppCore;
                     }
+                    else if (var[1] == "cppawaitable")
+                    {
+                        language = ETargetLanguage.eCppAwaitable;
+                    }
                     else if (var[1] == "c")
                     {
                         language = ETargetLanguage.eC;
@@ -193,6 +198,14 @@ namespace OpenHome.Net
                         templates.Add(new TemplateFile("DvUpnpCppCoreSource.tt", ".cpp"));
                     }
                     break;
+                case ETargetLanguage.eCppAwaitable:
+                    if (stack != ETargetStack.eCp)
+                    {
+                        Console.WriteLine("ERROR: CppAwaitable only supported for the --stack=cp");
+                        return;
+                    }
+                    templates.Add(new TemplateFile("CpUpnpCppAwaitableHeader.tt", ".h", "Awaitable"));
+                    break;
                 case ETargetLanguage.eC:
                     if (stack == ETargetStack.eCp)
                     {
@@ -302,7 +315,7 @@ namespace OpenHome.Net
         private static void PrintUsage()
         {
             Console.WriteLine("Usage is OhNetGen");
-            Console.WriteLine("\t--language=[cpp|cppcore|c|cs|java|js]");
+            Console.WriteLine("\t--language=[cpp|cppcore|cppawaitable|c|cs|java|js]");
             Console.WriteLine("\t--stack=[cp|dv]");
             Console.WriteLine("\t--xml=[path + name of xml service description]");
             Console.WriteLine("\t--output=[dir for generated files]");
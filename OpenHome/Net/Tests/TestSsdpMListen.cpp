@@ -26,10 +26,10 @@ class SsdpNotifyLoggerM : public ISsdpNotifyHandler
 {
 public:
     // ISsdpNotifyHandler
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyRootByeBye(const Brx& aUuid);
     void SsdpNotifyUuidByeBye(const Brx& aUuid);
     void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
@@ -48,7 +48,7 @@ public:
 };
 
 
-void SsdpNotifyLoggerM::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerM::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Root\n    uuid = ");
     Print(aUuid);
@@ -57,7 +57,7 @@ void SsdpNotifyLoggerM::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocati
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerM::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerM::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Uuid\n    uuid = ");
     Print(aUuid);
@@ -66,7 +66,7 @@ void SsdpNotifyLoggerM::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocati
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerM::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerM::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Device\n    uuid = ");
     Print(aUuid);
@@ -79,7 +79,7 @@ void SsdpNotifyLoggerM::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& a
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerM::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerM::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Service\n    uuid = ");
     Print(aUuid);
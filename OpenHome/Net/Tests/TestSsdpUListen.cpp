@@ -18,17 +18,17 @@ class SsdpNotifyLoggerU : public ISsdpNotifyHandler
 {
 public:
     // ISsdpNotifyHandler
-    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
-    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge);
+    void SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
+    void SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint aConfigId);
     void SsdpNotifyRootByeBye(const Brx& aUuid);
     void SsdpNotifyUuidByeBye(const Brx& aUuid);
     void SsdpNotifyDeviceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
     void SsdpNotifyServiceTypeByeBye(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion);
 };
 
-void SsdpNotifyLoggerU::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerU::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Root\n    uuid = ");
     Print(aUuid);
@@ -37,7 +37,7 @@ void SsdpNotifyLoggerU::SsdpNotifyRootAlive(const Brx& aUuid, const Brx& aLocati
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerU::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerU::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Uuid\n    uuid = ");
     Print(aUuid);
@@ -46,7 +46,7 @@ void SsdpNotifyLoggerU::SsdpNotifyUuidAlive(const Brx& aUuid, const Brx& aLocati
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerU::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerU::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Device\n    uuid = ");
     Print(aUuid);
@@ -59,7 +59,7 @@ void SsdpNotifyLoggerU::SsdpNotifyDeviceTypeAlive(const Brx& aUuid, const Brx& a
     Print("\n    maxAge = %u\n", aMaxAge);
 }
 
-void SsdpNotifyLoggerU::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge)
+void SsdpNotifyLoggerU::SsdpNotifyServiceTypeAlive(const Brx& aUuid, const Brx& aDomain, const Brx& aType, TUint aVersion, const Brx& aLocation, TUint aMaxAge, TUint /*aConfigId*/)
 {
     Print("Alive    Service\n    uuid = ");
     Print(aUuid);
@@ -1,5 +1,10 @@
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Net/Private/XmlParser.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <vector>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -86,10 +91,167 @@ void SuiteXmlParserBasic::Test()
     TEST(XmlParserBasic::Element(Brn("inner"), xmlBuffer) == innerTag);
 }
 
+
+class ChildCollector : public IXmlChildHandler
+{
+public:
+    void ProcessChild(const Brx& aName, const Brx& aValue);
+public:
+    std::vector<Brn> iNames;
+    std::vector<Brn> iValues;
+};
+
+void ChildCollector::ProcessChild(const Brx& aName, const Brx& aValue)
+{
+    iNames.push_back(Brn(aName));
+    iValues.push_back(Brn(aValue));
+}
+
+class SuiteXmlParserChildren : public Suite
+{
+public:
+    SuiteXmlParserChildren() : Suite("FindChildren tests") {}
+    void Test();
+};
+
+void SuiteXmlParserChildren::Test()
+{
+    const TChar data[] =
+        "<?xml version=\"1.0\"?>"                                               \
+        "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\">"    \
+            "<s:Body>"                                                          \
+                "<u:GetResponse xmlns:u=\"urn:av-openhome-org:service:Test:1\">" \
+                    "<First>1</First>"                                          \
+                    "<Second/>"                                                 \
+                    "<Third><nested>x</nested></Third>"                         \
+                    "<Fourth>&lt;four&gt;</Fourth>"                             \
+                "</u:GetResponse>"                                              \
+            "</s:Body>"                                                         \
+        "</s:Envelope>";
+    const Brn kEnvelope("Envelope");
+    const Brn kBody("Body");
+    const Brn kResponse("GetResponse");
+    const Brx* path[] = { &kEnvelope, &kBody, &kResponse };
+
+    ChildCollector children;
+    XmlParserBasic::FindChildren(path, 3, Brn(data), children);
+    TEST(children.iNames.size() == 4);
+    if (children.iNames.size() == 4) {
+        TEST(children.iNames[0] == Brn("First"));
+        TEST(children.iValues[0] == Brn("1"));
+        TEST(children.iNames[1] == Brn("Second"));
+        TEST(children.iValues[1] == Brx::Empty());
+        TEST(children.iNames[2] == Brn("Third"));
+        TEST(children.iValues[2] == Brn("<nested>x</nested>"));
+        TEST(children.iNames[3] == Brn("Fourth"));
+        TEST(children.iValues[3] == Brn("&lt;four&gt;"));
+    }
+
+    // tags in path are matched case insensitively, as with Find
+    const Brn kBodyLower("body");
+    const Brx* pathLower[] = { &kEnvelope, &kBodyLower, &kResponse };
+    ChildCollector children2;
+    XmlParserBasic::FindChildren(pathLower, 3, Brn(data), children2);
+    TEST(children2.iNames.size() == 4);
+
+    // element with no children
+    const Brn kSecond("Second");
+    const Brx* pathEmpty[] = { &kResponse, &kSecond };
+    ChildCollector children3;
+    XmlParserBasic::FindChildren(pathEmpty, 2, Brn(data), children3);
+    TEST(children3.iNames.size() == 0);
+
+    // missing element
+    const Brn kFault("Fault");
+    const Brx* pathMissing[] = { &kEnvelope, &kFault };
+    ChildCollector children4;
+    TEST_THROWS(XmlParserBasic::FindChildren(pathMissing, 2, Brn(data), children4), XmlError);
+
+    // mismatched and truncated documents
+    ChildCollector children5;
+    TEST_THROWS(XmlParserBasic::FindChildren(path, 3, Brn("<Envelope><Body><GetResponse><a>1</b></GetResponse></Body></Envelope>"), children5), XmlError);
+    TEST_THROWS(XmlParserBasic::FindChildren(path, 3, Brn("<Envelope><Body><GetResponse><a>1</a>"), children5), XmlError);
+}
+
+class SuiteXmlParserBenchmark : public Suite, private IXmlChildHandler
+{
+    static const TUint kNumArgs = 32;
+    static const TUint kIterations = 2000;
+public:
+    SuiteXmlParserBenchmark(Environment& aEnv) : Suite("Response parsing benchmark"), iEnv(aEnv) {}
+    void Test();
+private:
+    void ProcessChild(const Brx& aName, const Brx& aValue);
+    TUint64 NowUs() { return Os::TimeInUs(iEnv.OsCtx()); }
+    void Report(const TChar* aOp, TUint64 aTotalUs);
+private:
+    Environment& iEnv;
+    TUint iChildBytes;
+};
+
+void SuiteXmlParserBenchmark::ProcessChild(const Brx& /*aName*/, const Brx& aValue)
+{
+    iChildBytes += aValue.Bytes();
+}
+
+void SuiteXmlParserBenchmark::Report(const TChar* aOp, TUint64 aTotalUs)
+{
+    const TUint nsPerOp = (TUint)((aTotalUs * 1000) / kIterations);
+    Print("    %s: %u responses in %ums (%uns/response)\n", aOp, kIterations, (TUint)(aTotalUs / 1000), nsPerOp);
+}
+
+void SuiteXmlParserBenchmark::Test()
+{
+    // response similar to those from actions with many output arguments
+    Bwh doc(8 * 1024);
+    std::vector<Bwh*> names;
+    doc.Append("<?xml version=\"1.0\"?><s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+               "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\"><s:Body>"
+               "<u:ProductResponse xmlns:u=\"urn:av-openhome-org:service:Product:1\">");
+    for (TUint i=0; i<kNumArgs; i++) {
+        Bwh* name = new Bwh(16);
+        name->AppendPrintf("Argument%u", i);
+        names.push_back(name);
+        doc.AppendPrintf("<%.*s>value of output argument %u</%.*s>", PBUF(*name), i, PBUF(*name));
+    }
+    doc.Append("</u:ProductResponse></s:Body></s:Envelope>");
+
+    const Brn kEnvelope("Envelope");
+    const Brn kBody("Body");
+    const Brn kResponse("ProductResponse");
+    const Brx* path[] = { &kEnvelope, &kBody, &kResponse };
+
+    TUint findBytes = 0;
+    TUint64 start = NowUs();
+    for (TUint j=0; j<kIterations; j++) {
+        Brn envelope = XmlParserBasic::Find(kEnvelope, doc);
+        Brn body = XmlParserBasic::Find(kBody, envelope);
+        Brn response = XmlParserBasic::Find(kResponse, body);
+        for (TUint i=0; i<kNumArgs; i++) {
+            findBytes += XmlParserBasic::Find(*names[i], response).Bytes();
+        }
+    }
+    Report("Find per argument", NowUs() - start);
+
+    iChildBytes = 0;
+    start = NowUs();
+    for (TUint j=0; j<kIterations; j++) {
+        XmlParserBasic::FindChildren(path, 3, doc, *this);
+    }
+    Report("FindChildren", NowUs() - start);
+    TEST(iChildBytes == findBytes);
+
+    for (TUint i=0; i<kNumArgs; i++) {
+        delete names[i];
+    }
+}
+
 void TestXmlParser()
 {
     Runner runner("Test XmlParser");
     runner.Add(new SuiteXmlParserBasic());
+    runner.Add(new SuiteXmlParserChildren());
+    runner.Add(new SuiteXmlParserBenchmark(*gEnv));
     runner.Run();
 }
 
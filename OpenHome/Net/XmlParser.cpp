@@ -275,3 +275,77 @@ Brn XmlParserBasic::Element(const Brx& aTag, const Brx& aDocument, Brn& aRemaini
     }
 }
 
+
+void XmlParserBasic::FindChildren(const Brx* aPath[], TUint aPathLength, const Brx& aDocument, IXmlChildHandler& aHandler)
+{
+    ASSERT(aPathLength > 0 && aPathLength <= kMaxPathLength);
+    TUint pathDepth[kMaxPathLength]; // nesting depth of each element from aPath, once found
+    Brn pathNs[kMaxPathLength];
+    TUint found = 0;                 // number of elements from aPath found so far
+    TUint depth = 0;                 // number of currently open elements
+    Brn name;
+    Brn attributes;
+    Brn ns;
+    Brn childName;
+    Brn childNs;
+    const TByte* childStart = NULL;
+    TUint index;
+    Brn doc(Ascii::Trim(aDocument));
+    Brn remaining;
+    ETagType tagType;
+    for (;;) {
+        NextTag(doc, name, attributes, ns, index, remaining, tagType);
+        if (tagType == eTagClose) {
+            if (depth == 0) {
+                THROW(XmlError);
+            }
+            depth--;
+            if (found == aPathLength && childStart != NULL && depth == pathDepth[found-1] + 1) {
+                if (!Ascii::CaseInsensitiveEquals(name, childName) || ns != childNs) {
+                    THROW(XmlError);
+                }
+                const TUint childBytes = (TUint)(doc.Ptr() + index - childStart);
+                aHandler.ProcessChild(childName, Brn(childStart, childBytes));
+                childStart = NULL;
+            }
+            else if (found > 0 && depth == pathDepth[found-1]) {
+                // closing the last element from aPath that we found
+                if (found < aPathLength || ns != pathNs[found-1]) {
+                    THROW(XmlError);
+                }
+                return;
+            }
+        }
+        else if (found < aPathLength && Ascii::CaseInsensitiveEquals(name, *aPath[found])) {
+            if (tagType == eTagOpenClose) {
+                if (found+1 < aPathLength) {
+                    THROW(XmlError);
+                }
+                return; // no children
+            }
+            pathDepth[found] = depth;
+            pathNs[found].Set(ns);
+            found++;
+            depth++;
+        }
+        else {
+            if (found == aPathLength && depth == pathDepth[found-1] + 1) {
+                if (tagType == eTagOpenClose) {
+                    aHandler.ProcessChild(name, Brx::Empty());
+                }
+                else {
+                    childName.Set(name);
+                    childNs.Set(ns);
+                    childStart = remaining.Ptr();
+                }
+            }
+            if (tagType == eTagOpen) {
+                depth++;
+            }
+        }
+        if (remaining.Bytes() == 0) {
+            THROW(XmlError);
+        }
+        doc.Set(remaining);
+    }
+}
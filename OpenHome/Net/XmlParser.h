@@ -10,12 +10,25 @@ EXCEPTION(XmlError)
 namespace OpenHome {
 namespace Net {
 
+/**
+ * Receives each child element found by XmlParserBasic::FindChildren
+ */
+class IXmlChildHandler
+{
+public:
+    virtual void ProcessChild(const Brx& aName, const Brx& aValue) = 0;
+    virtual ~IXmlChildHandler() {}
+};
+
 /**
  * Very basic XML parser
  *
  * Find returns the data inside a given tag and (optionally) the data remaining after the tag
  * Attribute returns the value of a given attribute within an element
  * Element returns a full element (including its start and end tags) and (optionally) the data remaining after the element
+ * FindChildren passes the name and contents of each child of an element to a handler.  The element is
+ *   found by following aPath, as repeated calls to Find would.  Unlike those calls, and calls to Find for
+ *   each child, the document is scanned only once.
  */
 class XmlParserBasic
 {
@@ -30,6 +43,7 @@ public:
     static Brn Element(const Brx& aTag, const Brx& aDocument);
     static Brn Element(const TChar* aTag, const Brx& aDocument, Brn& aRemaining);
     static Brn Element(const Brx& aTag, const Brx& aDocument, Brn& aRemaining);
+    static void FindChildren(const Brx* aPath[], TUint aPathLength, const Brx& aDocument, IXmlChildHandler& aHandler);
 
 private:
     enum ETagType
@@ -46,6 +60,8 @@ private:
 
 private:
     static void NextTag(const Brx& aDocument, Brn& aName, Brn& aAttributes, Brn& aNamespace, TUint& aIndex, Brn& aRemaining, ETagType& aType);
+private:
+    static const TUint kMaxPathLength = 8;
 };
 
 } // namespace Net
@@ -7,6 +7,7 @@
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
+#include <OpenHome/Private/Timer.h>
 
 #include <errno.h>
 
@@ -295,6 +296,23 @@ void Socket::SetRecvTimeout(TUint aMs)
     OpenHome::Os::NetworkSocketSetReceiveTimeout(iHandle, aMs);
 }
 
+TBool Socket::AddToPoller(THandle aPoller, TUint aId)
+{
+    AutoMutex a(iLock);
+    if (iHandle == kHandleNull) {
+        return false;
+    }
+    return (OpenHome::Os::NetworkPollerAdd(aPoller, iHandle, aId) == 0);
+}
+
+void Socket::RemoveFromPoller(THandle aPoller)
+{
+    AutoMutex a(iLock);
+    if (iHandle != kHandleNull) {
+        (void)OpenHome::Os::NetworkPollerRemove(aPoller, iHandle);
+    }
+}
+
 void Socket::LogVerbose(TBool aLog, TBool aHex)
 {
     iFlags &= ~kLogMask;
@@ -347,6 +365,21 @@ void Socket::SendTo(const Brx& aBuffer, const Endpoint& aEndpoint)
     }
 }
 
+void Socket::SendToMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint)
+{
+    LOG_TRACE(kNetwork, "Socket::SendToMany  H = %d, BC = %d, C = %u\n", iHandle, aBuffer.Bytes(), aCount);
+    Log("Socket::SendToMany, sending\n", aBuffer);
+    TInt sent = OpenHome::Os::NetworkSendToMany(iHandle, aBuffer, aBytes, aCount, aEndpoint);
+    if(sent < 0) {
+        LOG_ERROR(kNetwork, "Socket::SendToMany H = %d, RETURN VALUE = %d\n", iHandle, sent);
+        THROW(NetworkError);
+    }
+    if((TUint)sent != aCount) {
+        LOG_ERROR(kNetwork, "Socket::SendToMany H = %d, RETURN VALUE = %d, INCOMPLETE\n", iHandle, sent);
+        THROW(NetworkError);
+    }
+}
+
 void Socket::Receive(Bwx& aBuffer)
 {
     // This variant of Receive will receive any number of bytes in the
@@ -406,6 +439,18 @@ void Socket::ReceiveFrom(Bwx& aBuffer, Endpoint& aEndpoint)
     LOG_TRACE(kNetwork, "<Socket::ReceiveFrom H = %d\n", iHandle);
 }
 
+TUint Socket::ReceiveFromMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts)
+{
+    LOG_TRACE(kNetwork, "Socket::ReceiveFromMany H = %d\n", iHandle);
+    TInt received = OpenHome::Os::NetworkReceiveFromMany(iHandle, aBuffer, aSlotBytes, aCount, aBytes, aAddresses, aPorts);
+    if(received <= 0) {
+        LOG_ERROR(kNetwork, "Socket::ReceiveFromMany H = %d, RETURN VALUE = %d\n", iHandle, received);
+        THROW(NetworkError);
+    }
+    LOG_TRACE(kNetwork, "<Socket::ReceiveFromMany H = %d, C = %d\n", iHandle, received);
+    return (TUint)received;
+}
+
 void Socket::Bind(const Endpoint& aEndpoint)
 {
     LOG_TRACE(kNetwork, "Socket::Bind H = %d\n", iHandle);
@@ -625,10 +670,16 @@ void SocketTcpClient::Connect(const Endpoint& aEndpoint, TUint aTimeout)
 
 SocketTcpServer::SocketTcpServer(Environment& aEnv, const TChar* aName, TUint aPort, const TIpAddress& aInterface,
                                  TUint aSessionPriority, TUint aSessionStackBytes, TUint aSlots)
-    : iMutex(aName)
+    : iEnv(aEnv)
+    , iMutex(aName)
     , iSessionPriority(aSessionPriority)
     , iSessionStackBytes(aSessionStackBytes)
     , iTerminating(false)
+    , iLockParked("TCPP")
+    , iPoller(kHandleNull)
+    , iMaxParked(0)
+    , iIdleTimeoutMs(0)
+    , iNextParkId(kPollIdListener + 1)
 {
     LOG_TRACE(kNetwork, "SocketTcpServer::SocketTcpServer\n");
     iHandle = SocketCreate(aEnv, eSocketTypeStream, aInterface.iFamily == kFamilyV4 ? eSocketFamilyV4 : eSocketFamilyV6);
@@ -655,16 +706,139 @@ void SocketTcpServer::Add(const TChar* aName, SocketTcpSession* aSession, TInt a
     }
 }
 
-THandle SocketTcpServer::Accept(Endpoint& aClientEndpoint)
+TBool SocketTcpServer::EnableParking(TUint aMaxParked, TUint aIdleTimeoutMs)
+{
+    ASSERT(iSessions.size() == 0);
+    ASSERT(aMaxParked > 0 && aIdleTimeoutMs > 0);
+    iPoller = OpenHome::Os::NetworkPollerCreate(iEnv.OsCtx());
+    if (iPoller == kHandleNull) {
+        LOG_ERROR(kNetwork, "SocketTcpServer::EnableParking - polling not supported\n");
+        return false;
+    }
+    if (OpenHome::Os::NetworkPollerAdd(iPoller, iHandle, kPollIdListener) != 0) {
+        LOG_ERROR(kNetwork, "SocketTcpServer::EnableParking - failed to poll listening socket\n");
+        OpenHome::Os::NetworkPollerDestroy(iPoller);
+        iPoller = kHandleNull;
+        return false;
+    }
+    iMaxParked = aMaxParked;
+    iIdleTimeoutMs = aIdleTimeoutMs;
+    return true;
+}
+
+THandle SocketTcpServer::Accept(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState)
 {
     LOG_TRACE(kNetwork, "SocketTcpServer::Accept\n");
     AutoMutex a(iMutex);                        // wait to become the single accepting thread
     if (iTerminating)
         THROW(NetworkError);
 
+    aResumed = false;
+    aState = 0;
+    if (iPoller != kHandleNull) {
+        return Poll(aClientEndpoint, aResumed, aState);
+    }
     return Socket::Accept(aClientEndpoint);     // accept the connection
 }
 
+THandle SocketTcpServer::Poll(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState)
+{ // called with iMutex held, so by one session thread at a time
+    TUint32 ids[kMaxPollIds];
+    for (;;) {
+        TUint timeoutMs = iIdleTimeoutMs;
+        {
+            AutoMutex _(iLockParked);
+            if (iResumable.size() > 0) {
+                const ParkedConnection& parked = iResumable.front();
+                THandle handle = parked.iHandle;
+                aClientEndpoint = parked.iClientEndpoint;
+                aState = parked.iState;
+                iResumable.pop_front();
+                aResumed = true;
+                return handle;
+            }
+            const TUint now = Time::Now(iEnv);
+            while (iParked.size() > 0 && (TInt)(iParked.front().iExpiryMs - now) <= 0) {
+                CloseParkedLocked(iParked.front().iHandle);
+                iParkedById.erase(iParked.front().iId);
+                iParked.pop_front();
+            }
+            if (iParked.size() > 0) {
+                timeoutMs = iParked.front().iExpiryMs - now;
+            }
+        }
+
+        const TInt count = OpenHome::Os::NetworkPollerWait(iPoller, ids, kMaxPollIds, timeoutMs);
+        if (count < 0) {
+            THROW(NetworkError);                // server is being destroyed
+        }
+        TBool listenerReady = false;
+        {
+            AutoMutex _(iLockParked);
+            for (TInt i=0; i<count; i++) {
+                if (ids[i] == kPollIdListener) {
+                    listenerReady = true;
+                    continue;
+                }
+                std::map<TUint, ParkedList::iterator>::iterator it = iParkedById.find(ids[i]);
+                if (it == iParkedById.end()) {
+                    continue;                   // evicted since the poller reported it
+                }
+                (void)OpenHome::Os::NetworkPollerRemove(iPoller, it->second->iHandle);
+                iResumable.splice(iResumable.end(), iParked, it->second);
+                iParkedById.erase(it);
+            }
+        }
+        if (listenerReady) {
+            try {
+                THandle handle = Socket::Accept(aClientEndpoint);
+                (void)OpenHome::Os::NetworkPollerAdd(iPoller, iHandle, kPollIdListener);
+                return handle;
+            }
+            catch (NetworkError&) {
+                (void)OpenHome::Os::NetworkPollerAdd(iPoller, iHandle, kPollIdListener);
+                throw;
+            }
+        }
+    }
+}
+
+TBool SocketTcpServer::Park(THandle aHandle, const Endpoint& aClientEndpoint, TUint aState)
+{
+    if (iPoller == kHandleNull) {
+        return false;
+    }
+    AutoMutex _(iLockParked);
+    if (iTerminating) {
+        return false;
+    }
+    if (iParked.size() >= iMaxParked) {
+        CloseParkedLocked(iParked.front().iHandle);
+        iParkedById.erase(iParked.front().iId);
+        iParked.pop_front();
+    }
+    const TUint id = iNextParkId;
+    if (++iNextParkId == kPollIdListener) {
+        iNextParkId++;
+    }
+    iParked.push_back(ParkedConnection(id, aHandle, aClientEndpoint, aState, Time::Now(iEnv) + iIdleTimeoutMs));
+    ParkedList::iterator it = iParked.end();
+    iParkedById.insert(std::pair<TUint, ParkedList::iterator>(id, --it));
+    if (OpenHome::Os::NetworkPollerAdd(iPoller, aHandle, id) != 0) {
+        LOG_ERROR(kNetwork, "SocketTcpServer::Park H = %d - failed to poll socket\n", aHandle);
+        iParkedById.erase(id);
+        iParked.pop_back();
+        return false;
+    }
+    return true;
+}
+
+void SocketTcpServer::CloseParkedLocked(THandle aHandle)
+{
+    (void)OpenHome::Os::NetworkPollerRemove(iPoller, aHandle);
+    (void)OpenHome::Os::NetworkClose(aHandle);
+}
+
 TBool SocketTcpServer::Terminating()
 {
     LOG_TRACE(kNetwork, "SocketTcpServer::Terminating %d\n", iTerminating);
@@ -674,24 +848,51 @@ TBool SocketTcpServer::Terminating()
 SocketTcpServer::~SocketTcpServer()
 {
     LOG_TRACE(kNetwork, ">SocketTcpServer::~SocketTcpServer\n");
+    iLockParked.Wait();
     iTerminating = true;            // indicates terminating phase
+    iLockParked.Signal();
 
     // cause exception in pending AND subsequent accept attempts in session threads.
     Interrupt(true);
+    if (iPoller != kHandleNull) {
+        OpenHome::Os::NetworkPollerInterrupt(iPoller, true);
+    }
     TUint count = (TUint)iSessions.size();
     for (TUint i = 0; i < count; i++) {             // delete all sessions
         iSessions[i]->Terminate();                    // Kill and Join the TcpSession thread
         delete iSessions[i];
     }
 
+    if (iPoller != kHandleNull) {
+        for (ParkedList::iterator it = iParked.begin(); it != iParked.end(); ++it) {
+            CloseParkedLocked(it->iHandle);
+        }
+        for (ParkedList::iterator it = iResumable.begin(); it != iResumable.end(); ++it) {
+            (void)OpenHome::Os::NetworkClose(it->iHandle);
+        }
+        (void)OpenHome::Os::NetworkPollerRemove(iPoller, iHandle);
+        OpenHome::Os::NetworkPollerDestroy(iPoller);
+    }
     Close();
     LOG_TRACE(kNetwork, "<SocketTcpServer::~SocketTcpServer\n");
 }
 
+
+// SocketTcpServer::ParkedConnection
+
+SocketTcpServer::ParkedConnection::ParkedConnection(TUint aId, THandle aHandle, const Endpoint& aClientEndpoint, TUint aState, TUint aExpiryMs)
+    : iId(aId)
+    , iHandle(aHandle)
+    , iClientEndpoint(aClientEndpoint)
+    , iState(aState)
+    , iExpiryMs(aExpiryMs)
+{
+}
+
 // Tcp Session
 
 SocketTcpSession::SocketTcpSession()
-    : iMutex("TCPS"), iOpen(false)
+    : iMutex("TCPS"), iOpen(false), iResumed(false), iResumedState(0)
 {
 }
 
@@ -709,7 +910,7 @@ void SocketTcpSession::Start()
     LOG_TRACE(kNetwork, ">SocketTcpSession::Start()\n");
     for (;;) {
         try {
-            Open(iServer->Accept(iClientEndpoint));            // accept a connection for this session
+            Open(iServer->Accept(iClientEndpoint, iResumed, iResumedState));  // accept a new or resumed connection for this session
         } catch (NetworkError&) { 
             // server is being destoryed OR there was an underlying issue with the socket operations.
             LOG_ERROR(kNetwork, "-SocketTcpSession::Start() Network Accept Exception\n");
@@ -752,6 +953,28 @@ Endpoint SocketTcpSession::ClientEndpoint() const
     return iClientEndpoint;
 }
 
+TBool SocketTcpSession::Park(TUint aState)
+{
+    LOG_TRACE(kNetwork, "SocketTcpSession::Park %d\n", iHandle);
+    AutoMutex a(iMutex);
+    if (!iOpen || !iServer->Park(iHandle, iClientEndpoint, aState)) {
+        return false;
+    }
+    iHandle = kHandleNull;  // the server now owns the connection
+    iOpen = false;
+    return true;
+}
+
+TBool SocketTcpSession::Resumed() const
+{
+    return iResumed;
+}
+
+TUint SocketTcpSession::ResumedState() const
+{
+    return iResumedState;
+}
+
 void SocketTcpSession::Close()
 {
     LOG_TRACE(kNetwork, "SocketTcpSession::Close %d\n", iHandle);
@@ -823,6 +1046,12 @@ void SocketUdpBase::Send(const Brx& aBuffer, const Endpoint& aEndpoint)
     SendTo(aBuffer, aEndpoint);
 }
 
+void SocketUdpBase::SendMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint)
+{
+    LOG_TRACE(kNetwork, "> SocketUdpBase::SendMany\n");
+    SendToMany(aBuffer, aBytes, aCount, aEndpoint);
+}
+
 Endpoint SocketUdpBase::Receive(Bwx& aBuffer)
 {
     LOG_TRACE(kNetwork, "> SocketUdpBase::Receive\n");
@@ -832,6 +1061,12 @@ Endpoint SocketUdpBase::Receive(Bwx& aBuffer)
     return endpoint;
 }
 
+TUint SocketUdpBase::ReceiveMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts)
+{
+    LOG_TRACE(kNetwork, "> SocketUdpBase::ReceiveMany\n");
+    return ReceiveFromMany(aBuffer, aSlotBytes, aCount, aBytes, aAddresses, aPorts);
+}
+
 void SocketUdpBase::ReCreate()
 {
     Close();
@@ -1044,3 +1279,120 @@ void UdpWriter::WriteFlush()
 {
     iOpen = true;
 }
+
+
+// UdpBatchReader
+
+UdpBatchReader::UdpBatchReader(SocketUdpBase& aSocket, TUint aSlots, TUint aSlotBytes)
+    : iSocket(aSocket)
+    , iBuffer(aSlots * aSlotBytes)
+    , iSlots(aSlots)
+    , iSlotBytes(aSlotBytes)
+    , iBytes(aSlots)
+    , iAddresses(aSlots)
+    , iPorts(aSlots)
+    , iCount(0)
+    , iNext(0)
+    , iReceives(0)
+{
+    ASSERT(aSlots > 0);
+}
+
+Brn UdpBatchReader::Read()
+{
+    if (iNext == iCount) {
+        iCount = iNext = 0;
+        try {
+            iCount = iSocket.ReceiveMany(const_cast<TByte*>(iBuffer.Ptr()), iSlotBytes, iSlots, &iBytes[0], &iAddresses[0], &iPorts[0]);
+        }
+        catch (NetworkError&) {
+            THROW(ReaderError);
+        }
+        iReceives++;
+    }
+    const TUint index = iNext++;
+    iSender.SetAddress(iAddresses[index]);
+    iSender.SetPort(iPorts[index]);
+    return Brn(iBuffer.Ptr() + (index * iSlotBytes), iBytes[index]);
+}
+
+Endpoint UdpBatchReader::Sender() const
+{
+    return iSender;
+}
+
+void UdpBatchReader::Discard()
+{
+    iCount = iNext = 0;
+}
+
+void UdpBatchReader::ReadInterrupt()
+{
+    iSocket.Interrupt(true);
+}
+
+TUint UdpBatchReader::Receives() const
+{
+    return iReceives;
+}
+
+
+// UdpBatchWriter
+
+UdpBatchWriter::UdpBatchWriter(TUint aMaxDatagrams, TUint aMaxDatagramBytes)
+    : iBuffer(aMaxDatagrams * aMaxDatagramBytes)
+    , iPendingBytes(0)
+    , iMaxDatagrams(aMaxDatagrams)
+{
+    iBytes.reserve(aMaxDatagrams);
+}
+
+TUint UdpBatchWriter::Count() const
+{
+    return (TUint)iBytes.size();
+}
+
+void UdpBatchWriter::Clear()
+{
+    iBuffer.SetBytes(0);
+    iBytes.clear();
+    iPendingBytes = 0;
+}
+
+void UdpBatchWriter::Send(SocketUdpBase& aSocket, const Endpoint& aEndpoint)
+{
+    if (iBytes.size() == 0) {
+        return;
+    }
+    const Brn datagrams(iBuffer.Ptr(), iBuffer.Bytes() - iPendingBytes);
+    try {
+        aSocket.SendMany(datagrams, &iBytes[0], (TUint)iBytes.size(), aEndpoint);
+    }
+    catch (NetworkError&) {
+        Clear();
+        throw;
+    }
+    Clear();
+}
+
+void UdpBatchWriter::Write(TByte /*aValue*/)
+{
+    ASSERTS();
+}
+
+void UdpBatchWriter::Write(const Brx& aBuffer)
+{
+    if (iBytes.size() == iMaxDatagrams || iBuffer.Bytes() + aBuffer.Bytes() > iBuffer.MaxBytes()) {
+        THROW(WriterError);
+    }
+    iBuffer.Append(aBuffer);
+    iPendingBytes += aBuffer.Bytes();
+}
+
+void UdpBatchWriter::WriteFlush()
+{
+    if (iPendingBytes > 0) {
+        iBytes.push_back(iPendingBytes);
+        iPendingBytes = 0;
+    }
+}
@@ -11,6 +11,8 @@
 #include <OpenHome/Private/TIpAddressUtils.h>
 
 #include <vector>
+#include <list>
+#include <map>
 
 EXCEPTION(NetworkError)
 EXCEPTION(NetworkAddressInUse)
@@ -94,15 +96,24 @@ public:
     void SetRecvBufBytes(TUint aBytes);
     void SetRecvTimeout(TUint aMs);
     void LogVerbose(TBool aLog, TBool aHex = false);
+    /**
+     * Watch for this socket becoming readable using a poller from Os::NetworkPollerCreate().
+     * Polling is one-shot; call AddToPoller() again to re-arm.
+     * Returns false if the socket couldn't be added.
+     */
+    TBool AddToPoller(THandle aPoller, TUint aId);
+    void RemoveFromPoller(THandle aPoller);
 protected:
     Socket();
     virtual ~Socket() {}
     void Create(Environment& aEnv, ESocketType aSocketType, ESocketFamily aSocketFamily);
     void Send(const Brx& aBuffer);
     void SendTo(const Brx& aBuffer, const Endpoint& aEndpoint);
+    void SendToMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint);
     void Receive(Bwx& aBuffer);
     void Receive(Bwx& aBuffer, TUint aBytes);
     void ReceiveFrom(Bwx& aBuffer, Endpoint& aEndpoint);
+    TUint ReceiveFromMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts);
     void Bind(const Endpoint& aEndpoint);
     void GetPort(TUint& aPort);
     void Listen(TUint aSlots);
@@ -209,6 +220,16 @@ protected:
     virtual void Run() = 0;
     virtual ~SocketTcpSession();
     Endpoint ClientEndpoint() const;
+    /**
+     * Hand an idle connection back to the server, which will pass it to the next free session
+     * once more data arrives.  Only valid from Run(), when no data has been read but not consumed.
+     * Returns false if the server doesn't support parking; otherwise Run() must return without
+     * further use of the socket.
+     * aState is kept with the connection and passed to whichever session resumes it.
+     */
+    TBool Park(TUint aState = 0);
+    TBool Resumed() const;  /// true if the current connection was previously Park()ed
+    TUint ResumedState() const; /// aState passed to Park() for a resumed connection, 0 for a new one
 private:
     void Add(SocketTcpServer& aServer, const TChar* aName, TUint aPriority, TUint aStackBytes);
     void Start();
@@ -221,6 +242,8 @@ private:
     SocketTcpServer* iServer;
     ThreadFunctor* iThread;
     Endpoint iClientEndpoint;
+    TBool iResumed;
+    TUint iResumedState;
 };
 
 // Tcp Server
@@ -234,13 +257,43 @@ public:
                     TUint aSlots = 128);
     // Add is not thread safe, but why would you want that?
     void Add(const TChar* aName, SocketTcpSession* aSession, TInt aPriorityOffset = 0);
+    /**
+     * Allow sessions to Park() idle connections.  Parked connections are watched by whichever
+     * session thread is accepting, so don't need a thread each.  Must be called before Add().
+     * Returns false (leaving parking disabled) if the platform can't poll many sockets.
+     *
+     * @param[in] aMaxParked       Maximum number of parked connections.  The oldest is closed
+     *                             to make room for another.
+     * @param[in] aIdleTimeoutMs   Parked connections are closed after being idle for
+     *                             between this and twice this time.
+     */
+    TBool EnableParking(TUint aMaxParked, TUint aIdleTimeoutMs);
     TUint Port() const { return iPort; }
     const TIpAddress& Interface() const { return iInterface; }
     ~SocketTcpServer(); // Closes the server
 private:
     TBool Terminating();            // indicates server is in process of being destroyed
-    THandle Accept(Endpoint& aClientEndpoint); // accept a connection and return the session handle
+    THandle Accept(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState); // accept a connection and return the session handle
+    THandle Poll(Endpoint& aClientEndpoint, TBool& aResumed, TUint& aState);
+    TBool Park(THandle aHandle, const Endpoint& aClientEndpoint, TUint aState);
+    void CloseParkedLocked(THandle aHandle);
 private:
+    class ParkedConnection
+    {
+    public:
+        ParkedConnection(TUint aId, THandle aHandle, const Endpoint& aClientEndpoint, TUint aState, TUint aExpiryMs);
+    public:
+        TUint iId;
+        THandle iHandle;
+        Endpoint iClientEndpoint;
+        TUint iState;
+        TUint iExpiryMs;
+    };
+    typedef std::list<ParkedConnection> ParkedList;
+    static const TUint kPollIdListener = 0;
+    static const TUint kMaxPollIds = 32;
+private:
+    Environment& iEnv;
     Mutex iMutex;                   // allows one thread to accept at a time
     TUint iSessionPriority;         // priority given to all session threads
     TUint iSessionStackBytes;       // stack bytes given to all session threads
@@ -248,6 +301,14 @@ private:
     std::vector<SocketTcpSession*> iSessions;
     TUint iPort;
     TIpAddress iInterface;
+    Mutex iLockParked;
+    THandle iPoller;                // kHandleNull unless parking is enabled
+    TUint iMaxParked;
+    TUint iIdleTimeoutMs;
+    TUint iNextParkId;
+    ParkedList iParked;             // oldest first
+    std::map<TUint, ParkedList::iterator> iParkedById;
+    ParkedList iResumable;          // parked connections with data to read
 };
 
 // general udp socket;
@@ -257,7 +318,9 @@ class SocketUdpBase : public Socket
 public:
     void SetTtl(TUint aTtl);
     void Send(const Brx& aBuffer, const Endpoint& aEndpoint);
+    void SendMany(const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint);
     Endpoint Receive(Bwx& aBuffer);
+    TUint ReceiveMany(TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts);
     TUint Port() const;
     ~SocketUdpBase();
     void ReCreate();
@@ -320,6 +383,38 @@ private:
     TBool iOpen;
 };
 
+/**
+ * Utility class which receives datagrams a batch at a time into a ring of fixed size
+ * slots then returns each in turn without copying it
+ */
+class UdpBatchReader : public INonCopyable
+{
+public:
+    UdpBatchReader(SocketUdpBase& aSocket, TUint aSlots, TUint aSlotBytes);
+    /**
+     * Return the next datagram, blocking until one arrives if none are buffered.
+     * The returned buffer is valid until the following call to Read() or Discard().
+     * Throws ReaderError if the socket is interrupted or fails.
+     */
+    Brn Read();
+    Endpoint Sender() const; // sender of datagram last returned by Read()
+    void Discard();          // drop any buffered datagrams
+    void ReadInterrupt();
+    TUint Receives() const;  // number of batches read from the socket
+private:
+    SocketUdpBase& iSocket;
+    Bwh iBuffer;
+    const TUint iSlots;
+    const TUint iSlotBytes;
+    std::vector<TUint32> iBytes;
+    std::vector<TIpAddress> iAddresses;
+    std::vector<TUint16> iPorts;
+    TUint iCount; // datagrams in the current batch
+    TUint iNext;  // index of next datagram to return
+    Endpoint iSender;
+    TUint iReceives;
+};
+
 /**
  * Utility class which enforces the Write() - WriteFlush() useage pattern
  * This class may be useful to subclasses of SocketUdp or SocketUdpMulticast
@@ -337,6 +432,28 @@ private:
     TBool iOpen;
 };
 
+/**
+ * Utility class which collects a series of datagrams, each terminated by WriteFlush(),
+ * into a single buffer so that they can later be sent to one endpoint together
+ */
+class UdpBatchWriter : public IWriter, public INonCopyable
+{
+public:
+    UdpBatchWriter(TUint aMaxDatagrams, TUint aMaxDatagramBytes);
+    TUint Count() const;
+    void Clear();
+    void Send(SocketUdpBase& aSocket, const Endpoint& aEndpoint);
+public: // from IWriter
+    void Write(TByte aValue);
+    void Write(const Brx& aBuffer);
+    void WriteFlush();
+private:
+    Bwh iBuffer;
+    std::vector<TUint32> iBytes; // size of each completed datagram
+    TUint iPendingBytes;         // size of the datagram currently being written
+    TUint iMaxDatagrams;
+};
+
 } // namespace OpenHome
 
 #endif // HEADER_NETWORK
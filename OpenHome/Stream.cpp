@@ -50,6 +50,11 @@ Brn Srx::Read(TUint aBytes)
     return buf;
 }
 
+TUint Srx::BytesBuffered() const
+{
+    return iBytes - iOffset;
+}
+
 void Srx::ReadFlush()
 {
     iBytes = 0;
@@ -165,6 +170,11 @@ Brn ReaderUntil::ReadProtocol(TUint aBytes)
     return Brn(start, (TUint)(p - start));
 }
 
+TUint ReaderUntil::BytesBuffered() const
+{
+    return iBytes - iOffset;
+}
+
 Brn ReaderUntil::Read(TUint aBytes)
 {
     if (iBytes > 0) {
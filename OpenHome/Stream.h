@@ -52,6 +52,8 @@ protected:
 
 class Srx : public Sxx, public IReader
 {
+public:
+    TUint BytesBuffered() const; // bytes read from the source but not yet returned by Read()
 public: // from IReader
     Brn Read(TUint aBytes);
     void ReadFlush();
@@ -90,6 +92,7 @@ class ReaderUntil : public IReader, private INonCopyable
 public:
     Brn ReadUntil(TByte aSeparator);
     Brn ReadProtocol(TUint aBytes); // reads exactly aBytes or throws
+    TUint BytesBuffered() const;    // bytes read from iReader but not yet returned
 public: // from IReader
     Brn Read(TUint aBytes);
     void ReadFlush();
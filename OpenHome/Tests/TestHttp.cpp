@@ -0,0 +1,226 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Net/Private/Globals.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+// HeaderNamed
+
+class HeaderNamed : public HttpHeader
+{
+public:
+    HeaderNamed(const TChar* aName);
+    const Brx& Value() const;
+private: // from HttpHeader
+    TBool Recognise(const Brx& aHeader);
+    void Process(const Brx& aValue);
+private:
+    Brn iName;
+    Brh iValue;
+};
+
+HeaderNamed::HeaderNamed(const TChar* aName)
+    : iName(aName)
+{
+}
+
+const Brx& HeaderNamed::Value() const
+{
+    return iValue;
+}
+
+TBool HeaderNamed::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, iName);
+}
+
+void HeaderNamed::Process(const Brx& aValue)
+{
+    iValue.Set(aValue);
+    SetReceived();
+}
+
+// SuiteReaderHttpRequest
+
+class SuiteReaderHttpRequest : public Suite
+{
+public:
+    SuiteReaderHttpRequest(Environment& aEnv);
+    ~SuiteReaderHttpRequest();
+    void Test();
+private:
+    void Read(const Brx& aRequest);
+private:
+    ReaderBuffer iReaderBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    ReaderHttpRequest iReaderRequest;
+    HttpHeaderContentLength iHeaderContentLength;
+    HeaderNamed iHeaderSoapAction;
+    HeaderNamed iHeaderUserAgent;
+    HeaderNamed iHeaderSid;
+};
+
+SuiteReaderHttpRequest::SuiteReaderHttpRequest(Environment& aEnv)
+    : Suite("ReaderHttpRequest")
+    , iReaderUntil(iReaderBuffer)
+    , iReaderRequest(aEnv, iReaderUntil)
+    , iHeaderSoapAction("SOAPACTION")
+    , iHeaderUserAgent("User-Agent")
+    , iHeaderSid("SID")
+{
+    iReaderRequest.AddMethod(Http::kMethodPost);
+    iReaderRequest.AddHeader(iHeaderContentLength);
+    iReaderRequest.AddHeader(iHeaderSoapAction);
+    iReaderRequest.AddHeader(iHeaderUserAgent);
+}
+
+SuiteReaderHttpRequest::~SuiteReaderHttpRequest()
+{
+}
+
+void SuiteReaderHttpRequest::Read(const Brx& aRequest)
+{
+    iReaderBuffer.Set(aRequest);
+    iReaderUntil.ReadFlush();
+    iReaderRequest.Read();
+}
+
+void SuiteReaderHttpRequest::Test()
+{
+    Brn request("POST /control HTTP/1.1\r\n"
+                "content-length: 123\r\n"
+                "Soapaction: \"urn:test#Action\"\r\n"
+                "X-Unknown: ignored\r\n"
+                "SID: uuid:1234\r\n"
+                "\r\n");
+    Read(request);
+    TEST(!iReaderRequest.MethodNotAllowed());
+    TEST(iReaderRequest.Method() == Http::kMethodPost);
+    TEST(iReaderRequest.Uri() == Brn("/control"));
+    TEST(iHeaderContentLength.Received());
+    TEST(iHeaderContentLength.ContentLength() == 123);
+    TEST(iHeaderSoapAction.Received());
+    TEST(iHeaderSoapAction.Value() == Brn("\"urn:test#Action\""));
+    TEST(!iHeaderUserAgent.Received());
+    TEST(!iHeaderSid.Received());
+
+    // headers are only reported as received for the request they appear in
+    Brn request2("POST /control HTTP/1.1\r\n"
+                 "USER-AGENT: test\r\n"
+                 "SOAPACTION: \"urn:test#Other\"\r\n"
+                 "\r\n");
+    Read(request2);
+    TEST(!iHeaderContentLength.Received());
+    TEST(iHeaderUserAgent.Received());
+    TEST(iHeaderUserAgent.Value() == Brn("test"));
+    TEST(iHeaderSoapAction.Value() == Brn("\"urn:test#Other\""));
+
+    // a header added later is offered fields the reader has already seen
+    iReaderRequest.AddHeader(iHeaderSid);
+    Read(request);
+    TEST(iHeaderSid.Received());
+    TEST(iHeaderSid.Value() == Brn("uuid:1234"));
+
+    // a request with many distinct unrecognised fields is still parsed correctly
+    Bws<4096> many("POST /control HTTP/1.1\r\n");
+    for (TUint i=0; i<100; i++) {
+        many.AppendPrintf("X-Field-%u: %u\r\n", i, i);
+    }
+    many.Append("User-Agent: many\r\n\r\n");
+    Read(many);
+    TEST(iHeaderUserAgent.Received());
+    TEST(iHeaderUserAgent.Value() == Brn("many"));
+    TEST(!iHeaderSid.Received());
+}
+
+// SuiteReaderHttpRequestBenchmark
+
+class SuiteReaderHttpRequestBenchmark : public Suite
+{
+    static const TUint kIterations = 20000;
+public:
+    SuiteReaderHttpRequestBenchmark(Environment& aEnv);
+    ~SuiteReaderHttpRequestBenchmark();
+    void Test();
+private:
+    Environment& iEnv;
+    ReaderBuffer iReaderBuffer;
+    ReaderUntilS<1024> iReaderUntil;
+    ReaderHttpRequest iReaderRequest;
+    std::vector<HeaderNamed*> iHeaders;
+    HttpHeaderContentLength iHeaderContentLength;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    HttpHeaderConnection iHeaderConnection;
+    HttpHeaderExpect iHeaderExpect;
+};
+
+SuiteReaderHttpRequestBenchmark::SuiteReaderHttpRequestBenchmark(Environment& aEnv)
+    : Suite("ReaderHttpRequest benchmark")
+    , iEnv(aEnv)
+    , iReaderUntil(iReaderBuffer)
+    , iReaderRequest(aEnv, iReaderUntil)
+{
+    // similar set of headers to those a device's http server registers
+    const TChar* names[] = { "Host", "SOAPACTION", "Callback", "Timeout", "SID", "NT", "Accept-Language", "User-Agent" };
+    for (TUint i=0; i<sizeof(names)/sizeof(names[0]); i++) {
+        HeaderNamed* header = new HeaderNamed(names[i]);
+        iHeaders.push_back(header);
+        iReaderRequest.AddHeader(*header);
+    }
+    iReaderRequest.AddHeader(iHeaderContentLength);
+    iReaderRequest.AddHeader(iHeaderTransferEncoding);
+    iReaderRequest.AddHeader(iHeaderConnection);
+    iReaderRequest.AddHeader(iHeaderExpect);
+    iReaderRequest.AddMethod(Http::kMethodPost);
+}
+
+SuiteReaderHttpRequestBenchmark::~SuiteReaderHttpRequestBenchmark()
+{
+    for (TUint i=0; i<(TUint)iHeaders.size(); i++) {
+        delete iHeaders[i];
+    }
+}
+
+void SuiteReaderHttpRequestBenchmark::Test()
+{
+    Brn request("POST /dev/service/control HTTP/1.1\r\n"
+                "HOST: 192.168.0.2:55178\r\n"
+                "CONTENT-LENGTH: 311\r\n"
+                "CONTENT-TYPE: text/xml; charset=\"utf-8\"\r\n"
+                "SOAPACTION: \"urn:av-openhome-org:service:Playlist:1#Read\"\r\n"
+                "USER-AGENT: Linux/1.0 UPnP/1.1 ohNet/1.0\r\n"
+                "Connection: keep-alive\r\n"
+                "Accept-Encoding: gzip\r\n"
+                "\r\n");
+    TUint recognised = 0;
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        iReaderBuffer.Set(request);
+        iReaderUntil.ReadFlush();
+        iReaderRequest.Read();
+        if (iHeaderContentLength.Received()) {
+            recognised++;
+        }
+    }
+    const TUint64 totalUs = Os::TimeInUs(iEnv.OsCtx()) - start;
+    TEST(recognised == kIterations);
+    TEST(iHeaderContentLength.ContentLength() == 311);
+    TEST(iHeaders[1]->Value() == Brn("\"urn:av-openhome-org:service:Playlist:1#Read\""));
+    Print("    %u requests in %ums (%uns/request)\n", kIterations, (TUint)(totalUs / 1000), (TUint)((totalUs * 1000) / kIterations));
+}
+
+
+void TestHttp()
+{
+    Runner runner("HTTP reader tests\n");
+    runner.Add(new SuiteReaderHttpRequest(*gEnv));
+    runner.Add(new SuiteReaderHttpRequestBenchmark(*gEnv));
+    runner.Run();
+}
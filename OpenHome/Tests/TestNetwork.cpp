@@ -461,6 +461,84 @@ void SuiteTcpServerShutdown::Test()
 }
 
 
+// TcpServerParking
+
+class TcpSessionEchoParked : public SocketTcpSession
+{
+private:
+    virtual void Run();
+};
+
+void TcpSessionEchoParked::Run()
+{
+    Bws<64> message;
+    do {
+        Read(message);
+        Write(message);
+    } while (!Park());
+}
+
+class SuiteTcpServerParking : public Suite, public INonCopyable
+{
+public:
+    SuiteTcpServerParking(TIpAddress aInterface) : Suite("TCP Server connection parking"), iInterface(aInterface) {}
+    void Test();
+private:
+    static const TUint kNumClients = 20;
+    static const TUint kIdleTimeoutMs = 200;
+    TIpAddress iInterface;
+};
+
+void SuiteTcpServerParking::Test()
+{
+    SocketTcpServer server(*gEnv, "TSSP", 0, iInterface);
+    if (!server.EnableParking(kNumClients, kIdleTimeoutMs)) {
+        Print("Parking not supported on this platform, skipping tests\n");
+        return;
+    }
+    server.Add("TSP1", new TcpSessionEchoParked());
+    Endpoint endpoint(server.Port(), iInterface);
+    Bws<26> tx("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+    Bws<26> rx;
+
+    // more open connections than session threads, each served several times
+    SocketTcpClient clients[kNumClients];
+    for (TUint i=0; i<kNumClients; i++) {
+        clients[i].Open(*gEnv);
+        clients[i].Connect(endpoint, 1000);
+    }
+    for (TUint j=0; j<3; j++) {
+        for (TUint i=0; i<kNumClients; i++) {
+            clients[i].Write(tx);
+            clients[i].Read(rx);
+            TEST(rx == tx);
+        }
+    }
+
+    // oldest parked connection is closed to make room for another
+    SocketTcpClient extra;
+    extra.Open(*gEnv);
+    extra.Connect(endpoint, 1000);
+    extra.Write(tx);
+    extra.Read(rx);
+    TEST(rx == tx);
+    TEST_THROWS(clients[0].Read(rx), ReaderError);
+    clients[1].Write(tx);
+    clients[1].Read(rx);
+    TEST(rx == tx);
+
+    // idle connections are closed
+    Thread::Sleep(3 * kIdleTimeoutMs);
+    TEST_THROWS(clients[1].Read(rx), ReaderError);
+    TEST_THROWS(extra.Read(rx), ReaderError);
+
+    extra.Close();
+    for (TUint i=0; i<kNumClients; i++) {
+        clients[i].Close();
+    }
+}
+
+
 class SuiteEndpoint : public Suite
 {
 public:
@@ -722,6 +800,7 @@ void MainNetworkTestThread::Run()
     runner.Add(new SuiteTcpClient(iInterface));
     runner.Add(new SuiteSocketServer(iInterface));
     runner.Add(new SuiteTcpServerShutdown(iInterface));
+    runner.Add(new SuiteTcpServerParking(iInterface));
     runner.Add(new SuiteEndpoint());
     //runner.Add(new SuiteUnicast(iInterface));
     // SuiteMulticast disabled because Linn network setup means that each multicast message is duplicated when
@@ -1,6 +1,9 @@
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Private/Timer.h>
 #include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -232,6 +235,81 @@ void SuiteTimerThrash::Test()
     }
 }
 
+class SuiteTimerScale : public Suite, private INonCopyable
+{
+    static const TUint kNumTimers = 100000;
+    static const TUint kNumProbes = 10000;
+public:
+    SuiteTimerScale(Environment& aEnv) : Suite("Timer latency with many live timers"), iEnv(aEnv) {}
+    void Test();
+private:
+    void Fire() { iCount++; }
+    TUint64 NowUs() { return Os::TimeInUs(iEnv.OsCtx()); }
+    void Report(const TChar* aOp, TUint64 aTotalUs, TUint aCount);
+private:
+    Environment& iEnv;
+    TUint iCount;
+};
+
+void SuiteTimerScale::Report(const TChar* aOp, TUint64 aTotalUs, TUint aCount)
+{
+    const TUint nsPerOp = (TUint)((aTotalUs * 1000) / aCount);
+    Print("    %s: %u ops in %ums (%uns/op)\n", aOp, aCount, (TUint)(aTotalUs / 1000), nsPerOp);
+}
+
+void SuiteTimerScale::Test()
+{
+    // All timers are set at least an hour in the future so none should fire
+    // during the test; we're only interested in the cost of FireAt/Cancel.
+    static const TUint kMinDelayMs = 60 * 60 * 1000;
+    Functor f = MakeFunctor(*this, &SuiteTimerScale::Fire);
+    iCount = 0;
+    std::vector<Timer*> timers;
+    timers.reserve(kNumTimers);
+    for (TUint i = 0; i < kNumTimers; i++) {
+        timers.push_back(new Timer(iEnv, f, "SuiteTimerScale"));
+    }
+
+    TUint64 start = NowUs();
+    for (TUint i = 0; i < kNumTimers; i++) {
+        timers[i]->FireIn(kMinDelayMs + iEnv.Random(kMinDelayMs));
+    }
+    Report("FireIn (growing to 100k live)", NowUs() - start, kNumTimers);
+
+    start = NowUs();
+    for (TUint i = 0; i < kNumTimers; i++) {
+        timers[iEnv.Random(kNumTimers)]->FireIn(kMinDelayMs + iEnv.Random(kMinDelayMs));
+    }
+    Report("FireIn (re-arm, 100k live)", NowUs() - start, kNumTimers);
+
+    Timer probe(iEnv, f, "SuiteTimerScaleProbe");
+    TUint64 maxUs = 0;
+    TUint64 total = 0;
+    for (TUint i = 0; i < kNumProbes; i++) {
+        start = NowUs();
+        probe.FireIn(kMinDelayMs + iEnv.Random(kMinDelayMs));
+        probe.Cancel();
+        const TUint64 elapsed = NowUs() - start;
+        total += elapsed;
+        if (elapsed > maxUs) {
+            maxUs = elapsed;
+        }
+    }
+    Report("FireIn+Cancel (100k live)", total, kNumProbes);
+    Print("    FireIn+Cancel worst case: %uus\n", (TUint)maxUs);
+
+    start = NowUs();
+    for (TUint i = 0; i < kNumTimers; i++) {
+        timers[(i * 7919) % kNumTimers]->Cancel(); // cancel from all over the heap, not just its tail
+    }
+    Report("Cancel (shrinking from 100k live)", NowUs() - start, kNumTimers);
+
+    TEST(iCount == 0);
+    for (TUint i = 0; i < kNumTimers; i++) {
+        delete timers[i];
+    }
+}
+
 class TimerTestThread : public Thread
 {
 public:
@@ -252,6 +330,7 @@ void TimerTestThread::Run()
     //Debug::SetLevel(Debug::kTimer);
     Runner runner("Timer testing\n");
     runner.Add(new SuiteTimerBasic(iEnv));
+    runner.Add(new SuiteTimerScale(iEnv));
     runner.Add(new SuiteTimerThrash(iEnv));
     runner.Run();
     Signal();
@@ -46,6 +46,9 @@ Timer::Timer(Environment& aEnv, Functor aFunctor, const TChar* aId)
     : iMgr(aEnv.TimerManager())
     , iFunctor(aFunctor)
     , iId(aId)
+    , iTime(0)
+    , iSequence(0)
+    , iHeapIndex(TimerManager::kNotQueued)
 {
 }
 
@@ -97,12 +100,9 @@ Timer::~Timer()
 
 TimerManager::TimerManager(Environment& aEnv, TUint aThreadPriority)
     : iEnv(aEnv)
-    , iMutexNow("TIM1")
-    , iRemoving(false)
     , iSemaphore("TIMM", 0)
     , iMutex("TIM2")
-    , iMutexTimer("TIM3")
-    , iNextTimer(0)
+    , iNextSequence(0)
     , iStop(false)
     , iStopped("MTS2", 0)
     , iCallbackMutex("TMCB")
@@ -146,42 +146,12 @@ void TimerManager::CallbackUnlock()
     iCallbackMutex.Signal();
 }
 
-// Called when the head item in the base timer queue changes
-// Prime the master timer accordingly, unless this change in the head item
-// is due to us removing already expired items
-
-void TimerManager::HeadChanged(QueueSortedEntry& aEntry)
-{
-    if(IsTail(aEntry)) {
-        return;
-    }
-
-    iMutexNow.Wait();
-
-    if (!iRemoving) {
-        iMutexNow.Signal();
-        iMutex.Wait();
-        iNextTimer = Entry(aEntry).iTime;
-        iMutex.Signal();
-        iSemaphore.Signal();
-        return;
-    }
-
-    if (&aEntry == &iNow) {
-        iRemoving = false;
-    }
-
-    iMutexNow.Signal();
-}
-
 // Fire expired timers
 //
-// This is achieved by inserting a dummy entry that represents 'now' into the sorted timer queue,
-// then removing head items until we reach this 'now' item. All queue entries removed during this process
-// represent expired timers.
-//
-// Note that during this process any change to the head item in the queue does does not cause the master timer
-// to be retriggered. (See HeadChanged) 
+// Expired timers are popped from the head of the heap one at a time.  iMutex is
+// released while each callback runs so that callbacks are free to re-arm or
+// cancel any timer (including their own).  A timer re-armed for a time at or
+// before 'now' from inside a callback will be run by this same pass.
 
 void TimerManager::Fire()
 {
@@ -204,29 +174,19 @@ void TimerManager::Fire()
         ASSERTS();
     }
     iLastRunTimeMs = now;
-    iMutexNow.Wait();
-    iRemoving = true;
-    iNow.iTime = now + 1; // will go after all the entries before or at now
-    iMutexNow.Signal();
-
-    // Add an entry for now, then ...
-
-    DoAdd(iNow);
-    
-    //LOG(kTimer, "TimerManager::Fire() - TimerExpired, removing entries before %u\n", iNow.iTime);
 
-    // remove all the entries before now
-    // See HeadChanged() for how iRemoving gets turned off
-    // Note that it has to be done this way so that the first
-    // item to become the head after the dummy now entry has
-    // been removed gets to prime the timer driver
+    //LOG(kTimer, "TimerManager::Fire() - TimerExpired, removing entries at or before %u\n", now);
 
     CallbackLock();
     for (;;) {
-        Timer& head = RemoveHead();
-        if(&head == &iNow) {
+        iMutex.Wait();
+        if (iHeap.size() == 0 || Time::IsAfter(iHeap[0]->iTime, now)) {
+            iMutex.Signal();
             break;
         }
+        Timer& head = *iHeap[0];
+        HeapRemove(0);
+        iMutex.Signal();
         iCallbackList.Add(head);
         if (++iCallbacksPerTick > kMaxCallbacksPerTick) {
             iCallbackList.Log();
@@ -240,39 +200,132 @@ void TimerManager::Fire()
 
 void TimerManager::FireAt(Timer& aTimer, TUint aTime)
 {
-    AutoMutex mutex(iMutexTimer);
-    Remove(aTimer);
+    iMutex.Wait();
+    const Timer* head = (iHeap.size() == 0? NULL : iHeap[0]);
+    const TUint headTime = (head == NULL? 0 : head->iTime);
     aTimer.iTime = aTime;
-    Add(aTimer);
+    aTimer.iSequence = iNextSequence++;
+    if (aTimer.iHeapIndex == kNotQueued) {
+        iHeap.push_back(&aTimer);
+        HeapSet((TUint)iHeap.size() - 1, &aTimer);
+        HeapSiftUp(aTimer.iHeapIndex);
+    }
+    else {
+        // re-armed for an earlier or later time; only one of these will move it
+        HeapSiftUp(aTimer.iHeapIndex);
+        HeapSiftDown(aTimer.iHeapIndex);
+    }
+    const TBool headChanged = (iHeap[0] != head || iHeap[0]->iTime != headTime);
+    iMutex.Signal();
+    if (headChanged) {
+        iSemaphore.Signal();
+    }
 }
 
-Thread* TimerManager::MgrThread() const
+void TimerManager::Remove(Timer& aTimer)
 {
-    return iThreadHandle;
+    // No need to wake the manager thread if the head is removed; it will
+    // wake at the old expiry time, find nothing to run, then wait for the
+    // new head.
+    AutoMutex _(iMutex);
+    if (aTimer.iHeapIndex != kNotQueued) {
+        HeapRemove(aTimer.iHeapIndex);
+    }
 }
 
-TInt TimerManager::Compare(QueueSortedEntry& aEntry1, QueueSortedEntry& aEntry2)
+void TimerManager::HeapRemove(TUint aIndex)
 {
-    return (Entry(aEntry1).iTime - Entry(aEntry2).iTime);
+    Timer* removed = iHeap[aIndex];
+    const TUint last = (TUint)iHeap.size() - 1;
+    if (aIndex != last) {
+        HeapSet(aIndex, iHeap[last]);
+        iHeap.pop_back();
+        HeapSiftUp(aIndex);
+        HeapSiftDown(aIndex);
+    }
+    else {
+        iHeap.pop_back();
+    }
+    removed->iHeapIndex = kNotQueued;
+}
+
+void TimerManager::HeapSiftUp(TUint aIndex)
+{
+    Timer* timer = iHeap[aIndex];
+    while (aIndex > 0) {
+        const TUint parent = (aIndex - 1) / 2;
+        if (!IsEarlier(*timer, *iHeap[parent])) {
+            break;
+        }
+        HeapSet(aIndex, iHeap[parent]);
+        aIndex = parent;
+    }
+    HeapSet(aIndex, timer);
+}
+
+void TimerManager::HeapSiftDown(TUint aIndex)
+{
+    const TUint count = (TUint)iHeap.size();
+    Timer* timer = iHeap[aIndex];
+    for (;;) {
+        TUint child = 2 * aIndex + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && IsEarlier(*iHeap[child + 1], *iHeap[child])) {
+            child++;
+        }
+        if (!IsEarlier(*iHeap[child], *timer)) {
+            break;
+        }
+        HeapSet(aIndex, iHeap[child]);
+        aIndex = child;
+    }
+    HeapSet(aIndex, timer);
+}
+
+void TimerManager::HeapSet(TUint aIndex, Timer* aTimer)
+{
+    iHeap[aIndex] = aTimer;
+    aTimer->iHeapIndex = aIndex;
+}
+
+TBool TimerManager::IsEarlier(const Timer& aTimer1, const Timer& aTimer2)
+{ // static
+    // signed differences so that ordering survives the millisecond clock wrapping
+    const TInt diff = (TInt)(aTimer1.iTime - aTimer2.iTime);
+    if (diff != 0) {
+        return (diff < 0);
+    }
+    return ((TInt)(aTimer1.iSequence - aTimer2.iSequence) < 0);
+}
+
+Thread* TimerManager::MgrThread() const
+{
+    return iThreadHandle;
 }
 
 void TimerManager::Run()
 {
     iThreadHandle = Thread::Current();
-    iSemaphore.Wait();
     iMutex.Wait();
     while (!iStop) {
-        TInt delay = Time::TimeToWaitFor(iEnv, iNextTimer);
-        iMutex.Signal();
-        if (delay <= 0) { // in the past or now
-            Fire();
+        if (iHeap.size() == 0) {
+            iMutex.Signal();
             iSemaphore.Wait();
         }
-        else { // in the future
-            try {
-                iSemaphore.Wait(delay);
+        else {
+            TInt delay = Time::TimeToWaitFor(iEnv, iHeap[0]->iTime);
+            iMutex.Signal();
+            if (delay <= 0) { // in the past or now
+                Fire();
             }
-            catch (Timeout&) {
+            else { // in the future
+                try {
+                    iSemaphore.Wait(delay);
+                }
+                catch (Timeout&) {
+                }
             }
         }
         iMutex.Wait();
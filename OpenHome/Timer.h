@@ -3,10 +3,11 @@
 
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Types.h>
-#include <OpenHome/Private/Queue.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Functor.h>
 
+#include <vector>
+
 namespace OpenHome {
 
 class Environment;
@@ -22,13 +23,6 @@ public:
     static TInt TimeToWaitFor(Environment& aEnv, TUint aTime);
 };
 
-class QueueSortedEntryTimer : public QueueSortedEntry
-{
-    friend class TimerManager;
-protected:
-    TUint iTime;  // Absolute (milliseconds from startup)
-};
-
 class TimerManager;
 
 class ITimer
@@ -56,7 +50,7 @@ private:
     Environment& iEnv;
 };
 
-class Timer : public QueueSortedEntryTimer, public ITimer
+class Timer : public ITimer, private INonCopyable
 {
     friend class TimerManager;
 public:
@@ -73,9 +67,17 @@ private:
     TimerManager& iMgr;
     Functor iFunctor;
     const TChar* iId;
+    TUint iTime;        // Absolute (milliseconds from startup)
+    TUint iSequence;    // Orders timers due at the same time by when they were set
+    TUint iHeapIndex;   // Position in TimerManager's heap; kNotQueued if not pending
 };
 
-class TimerManager : public QueueSorted<Timer>
+/*
+ * Pending timers are held in an indexed binary min-heap ordered on expiry time.
+ * Each Timer records its own position in the heap so FireAt and Cancel are
+ * O(log n) regardless of the number of live timers.
+ */
+class TimerManager : private INonCopyable
 {
     friend class Timer;
 public:
@@ -114,19 +116,22 @@ private:
     void Run();
     void Fire();
     void FireAt(Timer& aTimer, TUint aTime);
+    void Remove(Timer& aTimer);
     Thread* MgrThread() const;
-    virtual void HeadChanged(QueueSortedEntry& aEntry);
-    virtual TInt Compare(QueueSortedEntry& aEntry1, QueueSortedEntry& aEntry2);
+    // heap helpers; all require iMutex to be held
+    void HeapRemove(TUint aIndex);
+    void HeapSiftUp(TUint aIndex);
+    void HeapSiftDown(TUint aIndex);
+    void HeapSet(TUint aIndex, Timer* aTimer);
+    static TBool IsEarlier(const Timer& aTimer1, const Timer& aTimer2);
 private:
+    static const TUint kNotQueued = 0xffffffff;
     Environment& iEnv;
-    QueueSortedEntryTimer iNow;
-    Mutex iMutexNow;
-    TBool iRemoving;
     ThreadFunctor* iThread;
     Semaphore iSemaphore;
     Mutex iMutex;
-    Mutex iMutexTimer;
-    TUint iNextTimer;
+    std::vector<Timer*> iHeap;
+    TUint iNextSequence;
     TBool iStop;
     Semaphore iStopped;
     Mutex iCallbackMutex;
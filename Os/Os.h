@@ -493,6 +493,24 @@ int32_t OsNetworkSend(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes);
  */
 int32_t OsNetworkSendTo(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes, TIpAddress aAddress, uint16_t aPort);
 
+/**
+ * Send a series of datagrams to the specified endpoint
+ *
+ * Equivalent to calling OsNetworkSendTo() once per datagram.  Platforms which support
+ * it (e.g. Linux's sendmmsg()) may send several datagrams per system call.
+ *
+ * @param[in] aHandle      Socket handle returned from OsNetworkCreate()
+ * @param[in] aBuffer      Datagrams to send, stored contiguously
+ * @param[in] aBytes       Array of 'aCount' datagram sizes.  Datagram n starts at
+ *                         the sum of aBytes[0..n-1] bytes into 'aBuffer'
+ * @param[in] aCount       Number of datagrams to send
+ * @param[in] aAddress     IpV4 address (in network byte order) to send to
+ * @param[in] aPort        Port [0..65535] to send to
+ *
+ * @return  number of datagrams sent (>=0) on success; -1 on failure
+ */
+int32_t OsNetworkSendToMany(THandle aHandle, const uint8_t* aBuffer, const uint32_t* aBytes, uint32_t aCount, TIpAddress aAddress, uint16_t aPort);
+
 /**
  * Receive 0..aBytes of data from the endpoint we're OsNetworkConnect()ed to
  *
@@ -521,6 +539,27 @@ int32_t OsNetworkReceive(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes);
  */
 int32_t OsNetworkReceiveFrom(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes, TIpAddress* aAddress, uint16_t* aPort);
 
+/**
+ * Receive 1..aCount datagrams, setting the sender's endpoint for each
+ *
+ * Blocks until at least one datagram is available then returns as many more as can be
+ * read without blocking.  Platforms which support it (e.g. Linux's recvmmsg()) may
+ * read several datagrams per system call.
+ *
+ * @param[in]  aHandle     Socket handle returned from OsNetworkCreate()
+ * @param[out] aBuffer     Buffer of aCount slots, each of aSlotBytes.  Datagram n is
+ *                         received into the slot starting at n*aSlotBytes
+ * @param[in]  aSlotBytes  Maximum number of bytes of each datagram
+ * @param[in]  aCount      Maximum number of datagrams to receive
+ * @param[out] aBytes      Array of aCount values, set to the size of each datagram received
+ * @param[out] aAddresses  Array of aCount values, set to the IpV4 address (in network
+ *                         byte order) each datagram was received from
+ * @param[out] aPorts      Array of aCount values, set to the port each datagram was received from
+ *
+ * @return  number of datagrams received (1..aCount) on success; -1 on failure
+ */
+int32_t OsNetworkReceiveFromMany(THandle aHandle, uint8_t* aBuffer, uint32_t aSlotBytes, uint32_t aCount, uint32_t* aBytes, TIpAddress* aAddresses, uint16_t* aPorts);
+
 /**
  * Stop a socket's send/receive operations, interrupting any pending request.
  *
@@ -574,6 +613,74 @@ int32_t OsNetworkListen(THandle aHandle, uint32_t aSlots);
  */
 THandle OsNetworkAccept(THandle aHandle, TIpAddress* aClientAddress, uint32_t* aClientPort);
 
+/**
+ * Create a poller, capable of waiting for any one of a large number of sockets
+ * to become readable.
+ *
+ * Implementations are optional.  This is equivalent to Linux's epoll_create().
+ *
+ * @param[in] aContext     Returned from OsCreate().
+ *
+ * @return  a valid handle on success; kHandleNull if polling isn't supported
+ */
+THandle OsNetworkPollerCreate(OsContext* aContext);
+
+/**
+ * Destroy a poller.  Sockets added to it are not closed.
+ *
+ * @param[in] aPoller      Handle returned from OsNetworkPollerCreate()
+ */
+void OsNetworkPollerDestroy(THandle aPoller);
+
+/**
+ * Add a socket to a poller, or re-arm a socket that has already been reported
+ * as readable.
+ *
+ * Each socket is reported at most once per call to this function.
+ *
+ * @param[in] aPoller      Handle returned from OsNetworkPollerCreate()
+ * @param[in] aHandle      Socket handle returned from OsNetworkCreate() or OsNetworkAccept()
+ * @param[in] aId          Identifier reported by OsNetworkPollerWait() when the socket
+ *                         is readable, has been closed by its peer or is in error
+ *
+ * @return  0 on success; -1 on failure
+ */
+int32_t OsNetworkPollerAdd(THandle aPoller, THandle aHandle, uint32_t aId);
+
+/**
+ * Remove a socket from a poller.  Must be called before the socket is closed.
+ *
+ * @param[in] aPoller      Handle returned from OsNetworkPollerCreate()
+ * @param[in] aHandle      Socket handle previously passed to OsNetworkPollerAdd()
+ *
+ * @return  0 on success; -1 on failure
+ */
+int32_t OsNetworkPollerRemove(THandle aPoller, THandle aHandle);
+
+/**
+ * Block until at least one socket added to a poller is ready, a timeout expires
+ * or the poller is interrupted.
+ *
+ * @param[in]  aPoller     Handle returned from OsNetworkPollerCreate()
+ * @param[out] aIds        Identifiers of ready sockets
+ * @param[in]  aMaxIds     Maximum number of identifiers to write to aIds
+ * @param[in]  aTimeoutMs  Maximum time to wait.  0 means wait indefinitely
+ *
+ * @return  number of identifiers written to aIds (0 if the timeout expired);
+ *          -1 if the poller was interrupted or on failure.  Sockets which became
+ *          ready as the poller was interrupted are reported before -1 is returned.
+ */
+int32_t OsNetworkPollerWait(THandle aPoller, uint32_t* aIds, uint32_t aMaxIds, uint32_t aTimeoutMs);
+
+/**
+ * Interrupt a poller.  Pending and subsequent calls to OsNetworkPollerWait() fail
+ * until this is called with aInterrupt set to 0.
+ *
+ * @param[in] aPoller      Handle returned from OsNetworkPollerCreate()
+ * @param[in] aInterrupt   1 to interrupt; 0 to resume normal behaviour
+ */
+void OsNetworkPollerInterrupt(THandle aPoller, int32_t aInterrupt);
+
 /**
  * Convert a string into a IpV4 address
  *
@@ -56,12 +56,20 @@ public:
     static void NetworkConnect(THandle aHandle, const Endpoint& aEndpoint, TUint aTimeoutMs);
     inline static TInt NetworkSend(THandle aHandle, const Brx& aBuffer);
     inline static TInt NetworkSendTo(THandle aHandle, const Brx& aBuffer, const Endpoint& aEndpoint);
+    inline static TInt NetworkSendToMany(THandle aHandle, const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint);
     inline static TInt NetworkReceive(THandle aHandle, Bwx& aBuffer);
     static TInt NetworkReceiveFrom(THandle aHandle, Bwx& aBuffer, Endpoint& aEndpoint);
+    inline static TInt NetworkReceiveFromMany(THandle aHandle, TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts);
     inline static TInt NetworkInterrupt(THandle aHandle, TBool aInterrupt);
     inline static TInt NetworkClose(THandle aHandle);
     inline static TInt NetworkListen(THandle aHandle, TUint aSlots);
     static THandle NetworkAccept(THandle aHandle, Endpoint& aClient);
+    inline static THandle NetworkPollerCreate(OsContext* aContext);
+    inline static void NetworkPollerDestroy(THandle aPoller);
+    inline static TInt NetworkPollerAdd(THandle aPoller, THandle aHandle, TUint aId);
+    inline static TInt NetworkPollerRemove(THandle aPoller, THandle aHandle);
+    inline static TInt NetworkPollerWait(THandle aPoller, TUint32* aIds, TUint aMaxIds, TUint aTimeoutMs);
+    inline static void NetworkPollerInterrupt(THandle aPoller, TBool aInterrupt);
     static TIpAddress NetworkGetHostByName(const Brx& aAddress);
     static void NetworkSocketSetSendBufBytes(THandle aHandle, TUint aBytes);
     static void NetworkSocketSetRecvBufBytes(THandle aHandle, TUint aBytes);
@@ -78,14 +78,30 @@ inline TInt Os::NetworkSend(THandle aHandle, const Brx& aBuffer)
 { return OsNetworkSend(aHandle, aBuffer.Ptr(), aBuffer.Bytes()); }
 inline TInt Os::NetworkSendTo(THandle aHandle, const Brx& aBuffer, const Endpoint& aEndpoint)
 { return OsNetworkSendTo(aHandle, aBuffer.Ptr(), aBuffer.Bytes(), aEndpoint.Address(), aEndpoint.Port()); }
+inline TInt Os::NetworkSendToMany(THandle aHandle, const Brx& aBuffer, const TUint32* aBytes, TUint aCount, const Endpoint& aEndpoint)
+{ return OsNetworkSendToMany(aHandle, aBuffer.Ptr(), aBytes, aCount, aEndpoint.Address(), aEndpoint.Port()); }
 inline TInt Os::NetworkReceive(THandle aHandle, Bwx& aBuffer)
 { return OsNetworkReceive(aHandle, (uint8_t*)aBuffer.Ptr(), aBuffer.MaxBytes()); }
+inline TInt Os::NetworkReceiveFromMany(THandle aHandle, TByte* aBuffer, TUint aSlotBytes, TUint aCount, TUint32* aBytes, TIpAddress* aAddresses, TUint16* aPorts)
+{ return OsNetworkReceiveFromMany(aHandle, aBuffer, aSlotBytes, aCount, aBytes, aAddresses, aPorts); }
 inline TInt Os::NetworkInterrupt(THandle aHandle, TBool aInterrupt)
 { return OsNetworkInterrupt(aHandle, (aInterrupt? 1:0)); }
 inline TInt Os::NetworkClose(THandle aHandle)
 { return OsNetworkClose(aHandle); }
 inline TInt Os::NetworkListen(THandle aHandle, TUint aSlots)
 { return OsNetworkListen(aHandle, aSlots); }
+inline THandle Os::NetworkPollerCreate(OsContext* aContext)
+{ return OsNetworkPollerCreate(aContext); }
+inline void Os::NetworkPollerDestroy(THandle aPoller)
+{ OsNetworkPollerDestroy(aPoller); }
+inline TInt Os::NetworkPollerAdd(THandle aPoller, THandle aHandle, TUint aId)
+{ return OsNetworkPollerAdd(aPoller, aHandle, aId); }
+inline TInt Os::NetworkPollerRemove(THandle aPoller, THandle aHandle)
+{ return OsNetworkPollerRemove(aPoller, aHandle); }
+inline TInt Os::NetworkPollerWait(THandle aPoller, TUint32* aIds, TUint aMaxIds, TUint aTimeoutMs)
+{ return OsNetworkPollerWait(aPoller, aIds, aMaxIds, aTimeoutMs); }
+inline void Os::NetworkPollerInterrupt(THandle aPoller, TBool aInterrupt)
+{ OsNetworkPollerInterrupt(aPoller, (aInterrupt? 1:0)); }
 void Os::NetworkSetInterfaceChangedObserver(OsContext* aContext, InterfaceListChanged aCallback, void* aArg)
 { OsNetworkSetInterfaceChangedObserver(aContext, aCallback, aArg); }
 inline void Os::NetworkSetDnsChangedObserver(OsContext* aContext, DnsChanged aCallback, void* aArg)
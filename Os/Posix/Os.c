@@ -19,6 +19,7 @@
 #if !defined(PLATFORM_MACOSX_GNU) && !defined(PLATFORM_FREEBSD)
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <sys/epoll.h>
 #endif /* !PLATFORM_MACOSX_GNU && !PLATFORM_FREEBSD */
 #if defined(PLATFORM_MACOSX_GNU) || defined(PLATFORM_FREEBSD) || defined(PLATFORM_QNAP)
 #include <net/if.h>
@@ -1127,6 +1128,65 @@ int32_t OsNetworkSendTo(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes
     return sent;
 }
 
+#define kMaxBatchDatagrams 16
+
+int32_t OsNetworkSendToMany(THandle aHandle, const uint8_t* aBuffer, const uint32_t* aBytes, uint32_t aCount, TIpAddress aAddress, uint16_t aPort)
+{
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    if (SocketInterrupted(handle)) {
+        return -1;
+    }
+    struct sockaddr_in6 addr;
+    uint32_t len = sockaddrFromEndpoint((struct sockaddr*)&addr, &aAddress, aPort);
+
+    uint32_t sent = 0;
+    uint32_t offset = 0;
+#if !defined(PLATFORM_MACOSX_GNU) && !defined(PLATFORM_FREEBSD)
+    while (sent < aCount) {
+        struct mmsghdr msgs[kMaxBatchDatagrams];
+        struct iovec iov[kMaxBatchDatagrams];
+        uint32_t count = aCount - sent;
+        uint32_t msgOffset = offset;
+        uint32_t i;
+        int32_t batchSent;
+        if (count > kMaxBatchDatagrams) {
+            count = kMaxBatchDatagrams;
+        }
+        memset(msgs, 0, sizeof(msgs));
+        for (i=0; i<count; i++) {
+            iov[i].iov_base = (void*)&aBuffer[msgOffset];
+            iov[i].iov_len = aBytes[sent+i];
+            msgOffset += aBytes[sent+i];
+            msgs[i].msg_hdr.msg_name = &addr;
+            msgs[i].msg_hdr.msg_namelen = len;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        batchSent = TEMP_FAILURE_RETRY_2(sendmmsg(handle->iSocket, msgs, count, MSG_NOSIGNAL), handle);
+        if (batchSent <= 0) {
+            break;
+        }
+        for (i=0; i<(uint32_t)batchSent; i++) {
+            offset += aBytes[sent+i];
+        }
+        sent += batchSent;
+    }
+#else
+    while (sent < aCount) {
+        int32_t bytes = TEMP_FAILURE_RETRY_2(sendto(handle->iSocket, &aBuffer[offset], aBytes[sent], MSG_NOSIGNAL, (struct sockaddr*)&addr, len), handle);
+        if (bytes != (int32_t)aBytes[sent]) {
+            break;
+        }
+        offset += aBytes[sent];
+        sent++;
+    }
+#endif /* !PLATFORM_MACOSX_GNU && !PLATFORM_FREEBSD */
+    if (sent == 0 && aCount > 0) {
+        return -1;
+    }
+    return (int32_t)sent;
+}
+
 int32_t OsNetworkReceive(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes)
 {
     OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
@@ -1222,6 +1282,87 @@ int32_t OsNetworkReceiveFrom(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes,
     return received;
 }
 
+int32_t OsNetworkReceiveFromMany(THandle aHandle, uint8_t* aBuffer, uint32_t aSlotBytes, uint32_t aCount, uint32_t* aBytes, TIpAddress* aAddresses, uint16_t* aPorts)
+{
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    if (SocketInterrupted(handle)) {
+        return -1;
+    }
+    if (aCount > kMaxBatchDatagrams) {
+        aCount = kMaxBatchDatagrams;
+    }
+
+    fd_set read;
+    fd_set error;
+    int32_t selectErr;
+    int32_t received = -1;
+
+    for (;;) {
+        FD_ZERO(&read);
+        FD_SET(handle->iPipe[0], &read);
+        FD_SET(handle->iSocket, &read);
+        FD_ZERO(&error);
+        FD_SET(handle->iSocket, &error);
+
+        selectErr = (long int) select(nfds(handle), &read, NULL, &error, NULL);
+        if (selectErr < 0) {
+            if (errno != EINTR || SocketInterrupted(handle)) {
+                break;
+            }
+            continue;
+        }
+        if (!FD_ISSET(handle->iSocket, &read)) {
+            break; // Assuming it was the pipe or an error
+        }
+
+#if !defined(PLATFORM_MACOSX_GNU) && !defined(PLATFORM_FREEBSD)
+        struct mmsghdr msgs[kMaxBatchDatagrams];
+        struct iovec iov[kMaxBatchDatagrams];
+        struct sockaddr_in6 addrs[kMaxBatchDatagrams];
+        uint32_t i;
+        memset(msgs, 0, sizeof(msgs));
+        for (i=0; i<aCount; i++) {
+            iov[i].iov_base = &aBuffer[i * aSlotBytes];
+            iov[i].iov_len = aSlotBytes;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        received = TEMP_FAILURE_RETRY_2(recvmmsg(handle->iSocket, msgs, aCount, MSG_DONTWAIT | MSG_NOSIGNAL, NULL), handle);
+        if (received > 0) { /* -1 on error (including EAGAIN, handled below) */
+            for (i=0; i<(uint32_t)received; i++) {
+                aBytes[i] = msgs[i].msg_len;
+                aAddresses[i] = TIpAddressFromSockAddr((struct sockaddr*)&addrs[i]);
+                aPorts[i] = PortFromSockAddr((struct sockaddr*)&addrs[i]);
+            }
+        }
+#else
+        received = 0;
+        while ((uint32_t)received < aCount) {
+            struct sockaddr_in6 addr;
+            socklen_t addrLen = sizeof(addr);
+            int32_t bytes = TEMP_FAILURE_RETRY_2(recvfrom(handle->iSocket, &aBuffer[received * aSlotBytes], aSlotBytes, MSG_DONTWAIT | MSG_NOSIGNAL, (struct sockaddr*)&addr, &addrLen), handle);
+            if (bytes < 0) {
+                break;
+            }
+            aBytes[received] = bytes;
+            aAddresses[received] = TIpAddressFromSockAddr((struct sockaddr*)&addr);
+            aPorts[received] = PortFromSockAddr((struct sockaddr*)&addr);
+            received++;
+        }
+        if (received == 0) {
+            received = -1;
+        }
+#endif /* !PLATFORM_MACOSX_GNU && !PLATFORM_FREEBSD */
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !SocketInterrupted(handle)) {
+            continue; // select() can report a datagram that is then discarded (e.g. bad checksum) - wait again
+        }
+        break;
+    }
+    return received;
+}
+
 int32_t OsNetworkInterrupt(THandle aHandle, int32_t aInterrupt)
 {
     int32_t err = 0;
@@ -1348,6 +1489,188 @@ THandle OsNetworkAccept(THandle aHandle, TIpAddress* aClientAddress, uint32_t* a
     return (THandle)newHandle;
 }
 
+#if !defined(PLATFORM_MACOSX_GNU) && !defined(PLATFORM_FREEBSD)
+
+typedef struct OsNetworkPoller
+{
+    int32_t    iEpoll;
+    int32_t    iPipe[2];
+    int32_t    iInterrupted;
+    OsContext* iCtx;
+} OsNetworkPoller;
+
+#define kPollerIdInterrupt 0xffffffffffffffffULL /* socket ids are only 32 bits so can't clash with this */
+#define kPollerMaxEvents 64
+
+static int32_t PollerInterrupted(const OsNetworkPoller* aPoller)
+{
+    int32_t interrupted;
+    OsMutexLock(aPoller->iCtx->iMutex);
+    interrupted = aPoller->iInterrupted;
+    OsMutexUnlock(aPoller->iCtx->iMutex);
+    return interrupted;
+}
+
+THandle OsNetworkPollerCreate(OsContext* aContext)
+{
+    struct epoll_event ev;
+    OsNetworkPoller* poller = (OsNetworkPoller*)malloc(sizeof(OsNetworkPoller));
+    if (poller == NULL) {
+        return kHandleNull;
+    }
+    poller->iEpoll = epoll_create(kPollerMaxEvents); /* size is only a hint */
+    if (poller->iEpoll == -1) {
+        free(poller);
+        return kHandleNull;
+    }
+    if (pipe(poller->iPipe) == -1) {
+        close(poller->iEpoll);
+        free(poller);
+        return kHandleNull;
+    }
+    SetFdNonBlocking(poller->iPipe[0]);
+    poller->iInterrupted = 0;
+    poller->iCtx = aContext;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = kPollerIdInterrupt;
+    if (epoll_ctl(poller->iEpoll, EPOLL_CTL_ADD, poller->iPipe[0], &ev) == -1) {
+        OsNetworkPollerDestroy((THandle)poller);
+        return kHandleNull;
+    }
+    return (THandle)poller;
+}
+
+void OsNetworkPollerDestroy(THandle aPoller)
+{
+    OsNetworkPoller* poller = (OsNetworkPoller*)aPoller;
+    if (poller != NULL) {
+        close(poller->iEpoll);
+        close(poller->iPipe[0]);
+        close(poller->iPipe[1]);
+        free(poller);
+    }
+}
+
+int32_t OsNetworkPollerAdd(THandle aPoller, THandle aHandle, uint32_t aId)
+{
+    OsNetworkPoller* poller = (OsNetworkPoller*)aPoller;
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.u64 = aId;
+    if (epoll_ctl(poller->iEpoll, EPOLL_CTL_MOD, handle->iSocket, &ev) == 0) {
+        return 0; /* re-armed a socket that was already known to the poller */
+    }
+    return (epoll_ctl(poller->iEpoll, EPOLL_CTL_ADD, handle->iSocket, &ev) == 0? 0 : -1);
+}
+
+int32_t OsNetworkPollerRemove(THandle aPoller, THandle aHandle)
+{
+    OsNetworkPoller* poller = (OsNetworkPoller*)aPoller;
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    struct epoll_event ev; /* ignored but must be non-NULL for kernels before 2.6.9 */
+    return (epoll_ctl(poller->iEpoll, EPOLL_CTL_DEL, handle->iSocket, &ev) == 0? 0 : -1);
+}
+
+int32_t OsNetworkPollerWait(THandle aPoller, uint32_t* aIds, uint32_t aMaxIds, uint32_t aTimeoutMs)
+{
+    OsNetworkPoller* poller = (OsNetworkPoller*)aPoller;
+    struct epoll_event events[kPollerMaxEvents];
+    const int timeout = (aTimeoutMs == 0? -1 : (int)aTimeoutMs);
+    int maxEvents = (aMaxIds < kPollerMaxEvents? (int)aMaxIds : kPollerMaxEvents);
+    int32_t count = 0;
+    int32_t interrupted = 0;
+    int ret;
+    int i;
+
+    if (PollerInterrupted(poller)) {
+        return -1;
+    }
+    do {
+        ret = epoll_wait(poller->iEpoll, events, maxEvents, timeout);
+    } while (ret == -1 && errno == EINTR && !PollerInterrupted(poller));
+    if (ret == -1) {
+        return -1;
+    }
+    for (i=0; i<ret; i++) {
+        if (events[i].data.u64 == kPollerIdInterrupt) {
+            interrupted = 1;
+            continue;
+        }
+        aIds[count++] = (uint32_t)events[i].data.u64;
+    }
+    /* one-shot sockets reported alongside an interrupt won't be reported again so must be
+       returned; the interrupt stays pending and is reported by the next call */
+    if (interrupted && count == 0) {
+        return -1;
+    }
+    return count;
+}
+
+void OsNetworkPollerInterrupt(THandle aPoller, int32_t aInterrupt)
+{
+    OsNetworkPoller* poller = (OsNetworkPoller*)aPoller;
+    int32_t val = 1;
+    OsMutexLock(poller->iCtx->iMutex);
+    poller->iInterrupted = aInterrupt;
+    if (aInterrupt != 0) {
+        (void)TEMP_FAILURE_RETRY(write(poller->iPipe[1], &val, sizeof(val)));
+    }
+    else {
+        while (TEMP_FAILURE_RETRY(read(poller->iPipe[0], &val, sizeof(val))) > 0) {
+            ;
+        }
+    }
+    OsMutexUnlock(poller->iCtx->iMutex);
+}
+
+#else /* PLATFORM_MACOSX_GNU || PLATFORM_FREEBSD */
+
+THandle OsNetworkPollerCreate(OsContext* aContext)
+{
+    (void)aContext;
+    return kHandleNull;
+}
+
+void OsNetworkPollerDestroy(THandle aPoller)
+{
+    (void)aPoller;
+}
+
+int32_t OsNetworkPollerAdd(THandle aPoller, THandle aHandle, uint32_t aId)
+{
+    (void)aPoller;
+    (void)aHandle;
+    (void)aId;
+    return -1;
+}
+
+int32_t OsNetworkPollerRemove(THandle aPoller, THandle aHandle)
+{
+    (void)aPoller;
+    (void)aHandle;
+    return -1;
+}
+
+int32_t OsNetworkPollerWait(THandle aPoller, uint32_t* aIds, uint32_t aMaxIds, uint32_t aTimeoutMs)
+{
+    (void)aPoller;
+    (void)aIds;
+    (void)aMaxIds;
+    (void)aTimeoutMs;
+    return -1;
+}
+
+void OsNetworkPollerInterrupt(THandle aPoller, int32_t aInterrupt)
+{
+    (void)aPoller;
+    (void)aInterrupt;
+}
+
+#endif /* !PLATFORM_MACOSX_GNU && !PLATFORM_FREEBSD */
+
 int32_t OsNetworkGetHostByName(const char* aAddress, TIpAddress* aHost)
 {
     struct addrinfo *res;
@@ -602,6 +602,25 @@ static void sockaddrFromEndpoint(struct sockaddr_in* aAddr, const TIpAddress* aA
     aAddr->sin_addr.s_addr = aAddress->iV4;
 }
 
+static void endpointFromSockaddr(const struct sockaddr_storage* aAddr, TIpAddress* aAddress, uint16_t* aPort)
+{
+    if (aAddr->ss_family == AF_INET6) {
+        const struct sockaddr_in6* addr6 = (const struct sockaddr_in6*)aAddr;
+        uint8_t i;
+        aAddress->iFamily = kFamilyV6;
+        for (i = 0; i < 16; i++) {
+            aAddress->iV6[i] = addr6->sin6_addr.s6_addr[i];
+        }
+        *aPort = SwapEndian16(addr6->sin6_port);
+    }
+    else {
+        const struct sockaddr_in* addr4 = (const struct sockaddr_in*)aAddr;
+        aAddress->iFamily = kFamilyV4;
+        aAddress->iV4 = addr4->sin_addr.s_addr;
+        *aPort = SwapEndian16(addr4->sin_port);
+    }
+}
+
 static OsNetworkHandle* CreateHandle(OsContext* aContext, SOCKET aSocket)
 {
     OsNetworkHandle* handle = (OsNetworkHandle*)malloc(sizeof(OsNetworkHandle));
@@ -788,6 +807,23 @@ int32_t OsNetworkSendTo(THandle aHandle, const uint8_t* aBuffer, uint32_t aBytes
     return sent;
 }
 
+int32_t OsNetworkSendToMany(THandle aHandle, const uint8_t* aBuffer, const uint32_t* aBytes, uint32_t aCount, TIpAddress aAddress, uint16_t aPort)
+{
+    uint32_t sent = 0;
+    uint32_t offset = 0;
+    while (sent < aCount) {
+        if (OsNetworkSendTo(aHandle, &aBuffer[offset], aBytes[sent], aAddress, aPort) != (int32_t)aBytes[sent]) {
+            break;
+        }
+        offset += aBytes[sent];
+        sent++;
+    }
+    if (sent == 0 && aCount > 0) {
+        return -1;
+    }
+    return (int32_t)sent;
+}
+
 int32_t OsNetworkReceive(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes)
 {
     int32_t received;
@@ -819,7 +855,7 @@ int32_t OsNetworkReceiveFrom(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes,
 {
     int32_t received;
     OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
-    struct sockaddr_in addr;
+    struct sockaddr_storage addr;
     int len = sizeof(addr);
     HANDLE handles[2];
     DWORD ret = 0;
@@ -828,7 +864,7 @@ int32_t OsNetworkReceiveFrom(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes,
         return -1;
     }
 
-    sockaddrFromEndpoint(&addr, &kIpAddressV4AllAdapters, 0);
+    sockaddrFromEndpoint((struct sockaddr_in*)&addr, &kIpAddressV4AllAdapters, 0);
 
     handles[0] = handle->iEventSocket;
     handles[1] = handle->iEventInterrupt;
@@ -847,9 +883,36 @@ int32_t OsNetworkReceiveFrom(THandle aHandle, uint8_t* aBuffer, uint32_t aBytes,
         received = recvfrom(handle->iSocket, (char*)aBuffer, aBytes, 0, (struct sockaddr*)&addr, &len);
     }
 
-    aAddress->iFamily = kFamilyV4;
-    aAddress->iV4 = addr.sin_addr.s_addr;
-    *aPort = SwapEndian16(addr.sin_port);
+    endpointFromSockaddr(&addr, aAddress, aPort);
+    return received;
+}
+
+int32_t OsNetworkReceiveFromMany(THandle aHandle, uint8_t* aBuffer, uint32_t aSlotBytes, uint32_t aCount, uint32_t* aBytes, TIpAddress* aAddresses, uint16_t* aPorts)
+{
+    int32_t received;
+    int32_t bytes;
+    OsNetworkHandle* handle = (OsNetworkHandle*)aHandle;
+    struct sockaddr_storage addr;
+    int len;
+
+    if (aCount == 0) {
+        return -1;
+    }
+    bytes = OsNetworkReceiveFrom(aHandle, aBuffer, aSlotBytes, &aAddresses[0], &aPorts[0]);
+    if (bytes < 0) {
+        return -1;
+    }
+    aBytes[0] = bytes;
+    /* the socket is non-blocking so subsequent reads fail with WSAEWOULDBLOCK once no more data is queued */
+    for (received = 1; (uint32_t)received < aCount; received++) {
+        len = sizeof(addr);
+        bytes = recvfrom(handle->iSocket, (char*)&aBuffer[received * aSlotBytes], aSlotBytes, 0, (struct sockaddr*)&addr, &len);
+        if (bytes == SOCKET_ERROR) {
+            break;
+        }
+        aBytes[received] = bytes;
+        endpointFromSockaddr(&addr, &aAddresses[received], &aPorts[received]);
+    }
     return received;
 }
 
@@ -935,6 +998,49 @@ THandle OsNetworkAccept(THandle aHandle, TIpAddress* aClientAddress, uint32_t* a
     return (THandle)newHandle;
 }
 
+/* Polling many sockets isn't supported.  Servers fall back to blocking a thread per connection. */
+
+THandle OsNetworkPollerCreate(OsContext* aContext)
+{
+    aContext = aContext;
+    return kHandleNull;
+}
+
+void OsNetworkPollerDestroy(THandle aPoller)
+{
+    aPoller = aPoller;
+}
+
+int32_t OsNetworkPollerAdd(THandle aPoller, THandle aHandle, uint32_t aId)
+{
+    aPoller = aPoller;
+    aHandle = aHandle;
+    aId = aId;
+    return -1;
+}
+
+int32_t OsNetworkPollerRemove(THandle aPoller, THandle aHandle)
+{
+    aPoller = aPoller;
+    aHandle = aHandle;
+    return -1;
+}
+
+int32_t OsNetworkPollerWait(THandle aPoller, uint32_t* aIds, uint32_t aMaxIds, uint32_t aTimeoutMs)
+{
+    aPoller = aPoller;
+    aIds = aIds;
+    aMaxIds = aMaxIds;
+    aTimeoutMs = aTimeoutMs;
+    return -1;
+}
+
+void OsNetworkPollerInterrupt(THandle aPoller, int32_t aInterrupt)
+{
+    aPoller = aPoller;
+    aInterrupt = aInterrupt;
+}
+
 int32_t OsNetworkGetHostByName(const char* aAddress, TIpAddress* aHost)
 {
     int32_t ret = -1;